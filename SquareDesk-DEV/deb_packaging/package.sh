@@ -21,8 +21,12 @@ cp ../test123/SquareDeskPlayer SquareDeskPlayer/usr/bin
 
 pushd ../sdlib
 ./mkcalls
+# the getout tables, for resolving without a search (hours, the first time; after
+#   that, only when sd_calls.dat changes)
+make -f makefile.linux64 getouts || exit 1
 popd
 cp ../sdlib/sd_calls.dat SquareDeskPlayer/usr/share/SquareDeskPlayer
+cp ../sdlib/sd_getouts_*.dat SquareDeskPlayer/usr/share/SquareDeskPlayer
 cp ../sdlib/sd_calls.dat SquareDeskPlayer/usr/share/SquareDeskPlayer
 cp ../test123/{cuesheet2.css,patter.template.html,lyrics.template.html} \
    SquareDeskPlayer/usr/share/SquareDeskPlayer
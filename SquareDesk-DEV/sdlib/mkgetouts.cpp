@@ -0,0 +1,342 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:3; fill-column:88 -*-
+
+// SD -- square dance caller's helper.
+//
+//    Copyright (C) 1990-2015  William B. Ackerman.
+//
+//    This file is part of "Sd".
+//
+//    Sd is free software; you can redistribute it and/or modify it
+//    under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    Sd is distributed in the hope that it will be useful, but WITHOUT
+//    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+//    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+//    License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Sd; if not, write to the Free Software Foundation, Inc.,
+//    59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    This is for version 38.
+
+// This program finds getouts ahead of time, so that Sd and Sdtty can often
+// resolve without searching.  It is used like Sdtty, with the level and any
+// of the usual switches, for example
+//
+//       mkgetouts -db sd_calls.dat -formations 50 c1
+//
+// It does random calls from the starting setups to find lines, waves, columns,
+// and tidal setups that come up in real sequences.  For each of those, it tries
+// every way of putting the people in the spots that keeps the boys on boy spots
+// and the girls on girl spots, and has the resolver look for getouts from each.
+// What it finds goes into the file "sd_getouts_<level>.dat" next to the database,
+// where the program looks for it when it starts up.  If the calls database changes,
+// the program ignores the old file, and this must be run again.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sd.h"
+#include "sdui.h"
+#include "paths.h"
+
+
+static int formations_wanted = 20;    // Different arrangements of directions and sexes.
+static int resolves_wanted = 3;       // Getouts to keep from each setup.
+static int relabelings_wanted = 576;  // All of them.
+static int walk_length = 6;           // Random calls before we start again.
+static char table_filename[MAX_FILENAME_LENGTH];
+
+
+// We don't talk to anyone.  Everything that would ask a question
+// just gives up.
+
+class iogetouts : public iobase {
+ public:
+   int do_abort_popup() { return POPUP_ACCEPT; }
+   void prepare_for_listing() {}
+   uims_reply_thing get_startup_command();
+   void set_window_title(char /*s*/[]) {}
+   void add_new_line(const char /*the_line*/[], uint32 /*drawing_picture*/) {}
+   void no_erase_before_n(int /*n*/) {}
+   void reduce_line_count(int /*n*/) {}
+   void update_resolve_menu(command_kind /*goal*/, int /*cur*/, int /*max*/,
+                            resolver_display_state /*state*/) {}
+   void show_match(int /*frequency_to_show*/) {}
+   const char *version_string() { return "getouts"; }
+   uims_reply_thing get_resolve_command() { return uims_reply_thing(ui_resolve_select, resolve_command_abort); }
+   bool choose_font() { return false; }
+   bool print_this() { return false; }
+   bool print_any() { return false; }
+   bool help_manual() { return false; }
+   bool help_faq() { return false; }
+   popup_return get_popup_string(Cstring /*prompt1*/, Cstring /*prompt2*/, Cstring /*final_inline_prompt*/,
+                                 Cstring /*seed*/, char *dest) { dest[0] = 0; return POPUP_DECLINE; }
+   void fatal_error_exit(int code, Cstring s1=0, Cstring s2=0);
+   void serious_error_print(Cstring s1) { fprintf(stderr, "%s\n", s1); }
+   void create_menu(call_list_kind /*cl*/) {}
+   selector_kind do_selector_popup(matcher_class & /*matcher*/) { return selector_uninitialized; }
+   direction_kind do_direction_popup(matcher_class & /*matcher*/) { return direction_uninitialized; }
+   int do_circcer_popup() { return 0; }
+   int do_tagger_popup(int /*tagger_class*/) { return 0; }
+   int yesnoconfirm(Cstring /*title*/, Cstring /*line1*/, Cstring /*line2*/, bool /*excl*/, bool /*info*/)
+      { return POPUP_DECLINE; }
+   uint32 get_one_number(matcher_class & /*matcher*/) { return ~0U; }
+   uims_reply_thing get_call_command() { return uims_reply_thing(ui_command_select, command_quit); }
+   void dispose_of_abbreviation(const char * /*linebuff*/) {}
+   void set_pick_string(Cstring /*string*/) {}
+   void display_help();
+   void terminate(int code) { exit(code); }
+   void process_command_line(int *argcp, char ***argvp);
+   void bad_argument(Cstring s1, Cstring s2, Cstring s3);
+   void final_initialize() {}
+   bool init_step(init_callback_state s, int n);
+   void set_utils_ptr(ui_utils *utils_ptr) { m_ui_utils_ptr = utils_ptr; }
+   ui_utils *get_utils_ptr() { return m_ui_utils_ptr; }
+
+   ui_utils *m_ui_utils_ptr;
+};
+
+
+void iogetouts::display_help()
+{
+   printf("In addition, mkgetouts takes these:\n");
+   printf("-formations <n>             how many formations to find getouts from (def 20)\n");
+   printf("-resolves <n>               getouts to keep from each setup (def 3)\n");
+   printf("-relabelings <n>            how many ways to put people in each formation (def all 576)\n");
+   printf("-walk <n>                   random calls before starting over (def 6)\n");
+   printf("-o <filename>               where to write the table (def \"" GETOUTS_FILENAME "_<level>.dat\"\n");
+   printf("                            in the database's directory)\n");
+}
+
+
+void iogetouts::process_command_line(int *argcp, char ***argvp)
+{
+   int argno = 1;
+   char **argv = *argvp;
+
+   while (argno+1 < (*argcp)) {
+      int i;
+
+      if (strcmp(argv[argno], "-formations") == 0)
+         formations_wanted = atoi(argv[argno+1]);
+      else if (strcmp(argv[argno], "-resolves") == 0)
+         resolves_wanted = atoi(argv[argno+1]);
+      else if (strcmp(argv[argno], "-relabelings") == 0)
+         relabelings_wanted = atoi(argv[argno+1]);
+      else if (strcmp(argv[argno], "-walk") == 0)
+         walk_length = atoi(argv[argno+1]);
+      else if (strcmp(argv[argno], "-o") == 0) {
+         strncpy(table_filename, argv[argno+1], MAX_FILENAME_LENGTH-1);
+         table_filename[MAX_FILENAME_LENGTH-1] = 0;
+      }
+      else {
+         argno++;
+         continue;
+      }
+
+      (*argcp) -= 2;   // Remove two arguments from the list.
+      for (i=argno+1; i<=(*argcp); i++) argv[i-1] = argv[i+1];
+   }
+}
+
+
+void iogetouts::bad_argument(Cstring s1, Cstring s2, Cstring s3)
+{
+   if (s2 && s2[0])
+      fprintf(stderr, "%s: %s\n", s1, s2);
+   else
+      fprintf(stderr, "%s\n", s1);
+
+   if (s3) fprintf(stderr, "%s\n", s3);
+   fprintf(stderr, "%s", "Use the -help flag for help.\n");
+   general_final_exit(1);
+}
+
+
+void iogetouts::fatal_error_exit(int code, Cstring s1, Cstring s2)
+{
+   if (s2 && s2[0])
+      fprintf(stderr, "%s: %s\n", s1, s2);
+   else
+      fprintf(stderr, "%s\n", s1);
+
+   session_index = 0;  // Prevent attempts to update session file.
+   general_final_exit(code);
+}
+
+
+bool iogetouts::init_step(init_callback_state s, int /*n*/)
+{
+   switch (s) {
+   case get_session_info:
+      return false;     // We never use the session file.
+   case final_level_query:
+      fatal_error_exit(1, "The level must be given on the command line");
+      break;
+   case calibrate_tick:
+      printf("mkgetouts: reading database...");
+      fflush(stdout);
+      break;
+   case tick_end:
+      printf("done\n");
+      break;
+   }
+
+   return false;
+}
+
+
+// A formation is where the people are and which way they face, and whether a boy or
+// a girl is in each spot, but not which boy or girl.
+
+static uint64_t formation_key(const setup *ss)
+{
+   uint64_t h = hash_step(ss->kind, ((uint64_t) ss->rotation << 8) | ss->eighth_rotation);
+
+   for (int i=0; i<8; i++)
+      h = hash_step(h, ss->people[i].id1 & (0100|d_mask));
+
+   return h;
+}
+
+
+static bool usable_formation(const setup *ss)
+{
+   if (ss->kind != s2x4 && ss->kind != s1x8) return false;
+
+   for (int i=0; i<8; i++) {
+      if (!(ss->people[i].id1 & BIT_PERSON)) return false;
+   }
+
+   return true;
+}
+
+
+// Put the boys on the boy spots in the order given by "boys", and the same for the girls.
+// The person ID bits and the permanent ID3 bits go with the person.
+
+static void relabel(const setup *ss, const int boys[4], const int girls[4], setup *result)
+{
+   static const uint32 id3_for_person[8] = {
+      ID3_B1, ID3_G1, ID3_B2, ID3_G2, ID3_B3, ID3_G3, ID3_B4, ID3_G4};
+
+   *result = *ss;
+
+   for (int i=0; i<8; i++) {
+      personrec & p = result->people[i];
+      int old_person = (p.id1 & PID_MASK) >> 6;
+      int new_person = (old_person & 1) ? (girls[old_person >> 1] << 1) | 1 : (boys[old_person >> 1] << 1);
+      p.id1 = (p.id1 & ~PID_MASK) | (new_person << 6);
+      p.id3 = (p.id3 & ~ID3_PERM_ALLBITS) | id3_for_person[new_person];
+   }
+}
+
+
+// The 24 ways of ordering 4 people.
+
+static int orderings[24][4];
+
+static void make_orderings()
+{
+   int n = 0;
+
+   for (int a=0; a<4; a++) {
+      for (int b=0; b<4; b++) {
+         if (b == a) continue;
+         for (int c=0; c<4; c++) {
+            if (c == a || c == b) continue;
+            orderings[n][0] = a;
+            orderings[n][1] = b;
+            orderings[n][2] = c;
+            orderings[n][3] = 6-a-b-c;
+            n++;
+         }
+      }
+   }
+}
+
+
+static void make_getout_table()
+{
+   setup *formations = new setup[formations_wanted];
+   uint64_t *keys = new uint64_t[formations_wanted];
+   int formation_count = 0;
+   int tries = 0;
+   int i, j;
+
+   begin_getout_table();
+
+   // Walk around with random calls, from heads 1P2P and sides 1P2P in turn, and take
+   // the formations that we haven't seen yet.  Give up if we keep seeing the same ones.
+
+   while (formation_count < formations_wanted && tries < formations_wanted*50) {
+      setup s = *configuration::startinfolist[(tries & 1) ? start_select_s1p2p : start_select_h1p2p].the_setup_p;
+      tries++;
+
+      for (i=0; i<walk_length && formation_count < formations_wanted; i++) {
+         if (!random_call_from_setup(&s)) break;
+         if (!usable_formation(&s)) continue;
+
+         uint64_t key = formation_key(&s);
+         for (j=0; j<formation_count; j++) {
+            if (keys[j] == key) break;
+         }
+
+         if (j < formation_count) continue;
+
+         keys[formation_count] = key;
+         formations[formation_count++] = s;
+      }
+   }
+
+   int setups_done = 0;
+   int getouts_found = 0;
+
+   make_orderings();
+
+   for (i=0; i<formation_count; i++) {
+      for (j=0; j<24*24 && j<relabelings_wanted; j++) {
+         setup s;
+         relabel(&formations[i], orderings[j/24], orderings[j%24], &s);
+         getouts_found += add_getouts_from_setup(&s, resolves_wanted);
+         setups_done++;
+      }
+
+      printf("Formation %d of %d: %d setups, %d getouts so far\n",
+             i+1, formation_count, setups_done, getouts_found);
+      fflush(stdout);
+   }
+
+   if (!table_filename[0]) getout_table_filename(table_filename);
+
+   if (!write_getout_table(table_filename))
+      current_engine->m_gg77->iob88.fatal_error_exit(1, "Can't write getout table", table_filename);
+
+   printf("Wrote %d getouts from %d setups to \"%s\"\n", getouts_found, setups_done, table_filename);
+
+   delete [] formations;
+   delete [] keys;
+}
+
+
+// Sdmain calls this when it is ready for a sequence, with the database all set up.
+// We do the whole job right then, and tell it to quit.
+
+uims_reply_thing iogetouts::get_startup_command()
+{
+   make_getout_table();
+   return uims_reply_thing(ui_command_select, command_quit);
+}
+
+
+int main(int argc, char *argv[])
+{
+   iogetouts ggg;
+
+   return sdmain(argc, argv, ggg);
+}
@@ -30,6 +30,12 @@
 #define CALLS_FILENAME "sd_calls.txt"
 #endif
 
+/* The getouts that the mkgetouts program finds ahead of time.  "_level.dat" is
+   added to the name, and the file goes in the same directory as the database. */
+#ifndef GETOUTS_FILENAME
+#define GETOUTS_FILENAME "sd_getouts"
+#endif
+
 /* The output filename prefix.  ".level" is added to the name. */
 #ifndef SEQUENCE_FILENAME
 #define SEQUENCE_FILENAME "sequence"
@@ -43,6 +43,7 @@
 // another file for that, and bring it, but not database, in here.
 #include "database.h"
 #include "sdbase.h"
+#include "sdui.h"
 
 class saved_error_info {
 
@@ -350,14 +351,28 @@ public:
    // In case someone runs a some kind of global memory leak detector, this releases all blocks.
    static void final_cleanup();
 
-   static parse_block *parse_active_list;
-
    // Being "old school", and not fully trusting the de-fragmentation mechanism,
-   // we try to do our own memory management.  So we keep an "inactive list".
+   // we try to do our own memory management.  So each engine keeps an "active list"
+   // and an "inactive list" (see engine_context).
 
    parse_block *gc_ptr;           // used for reclaiming dead blocks
+};
+
+
+// One parse block, as copy_parse_tree sees it.  flatten_parse_tree turns a tree
+// into a list of these, so that a search can keep a tree around and compare it
+// with another one, field by field.
+
+struct parse_tree_item {
+   enum { plain_block, subsidiary_follows, end_of_list };
 
-   static parse_block *parse_inactive_list;
+   int kind;
+   const concept_descriptor *concept;
+   call_with_name *call;
+   call_with_name *call_to_print;
+   call_conc_option_state options;
+   short int replacement_key;
+   bool no_check_call_level;
 };
 
 
@@ -2034,8 +2049,8 @@ enum distort_key {
 
 
 // A "configuration" is a state in the evolving sequence.
-// There is a global array of these, making up the sequence itself.
-// It is in the static array "history", running from 1 or 2 up to "config_history_ptr".
+// There is an array of these in each engine, making up the sequence itself.
+// It is in the array "history", running from 1 or 2 up to "config_history_ptr".
 
 class configuration {
  public:
@@ -2094,22 +2109,23 @@ class configuration {
    //   and receives the result formation, the warnings that the call may have
    //   raised, and the resolve for that result.
 
-   static configuration *history;                     // in SDTOP
-   static int whole_sequence_low_lim;                 // in SDTOP
+   // Both of these are in the current engine (see engine_context in sdui.h).
+   inline static configuration *& history() { return current_engine->m_history; }
+   inline static int & whole_sequence_low_lim() { return current_engine->m_whole_sequence_low_lim; }
 
-   inline static configuration & current_config() { return history[config_history_ptr]; }
-   inline static configuration & next_config() { return history[config_history_ptr+1]; }
+   inline static configuration & current_config() { return history()[current_engine->m_config_history_ptr]; }
+   inline static configuration & next_config() { return history()[current_engine->m_config_history_ptr+1]; }
 
    inline static int concepts_in_place()
       { return next_config().command_root != 0; }
 
    inline void init_centersp_specific() { startinfoindex = 0; }
    inline static void initialize_history(int c) {
-      config_history_ptr = 1;
-      history[1].startinfoindex = c;
-      history[1].draw_pic = false;
-      history[1].state_is_valid = false;
-      whole_sequence_low_lim = (startinfolist[c].into_the_middle) ? 2 : 1;
+      current_engine->m_config_history_ptr = 1;
+      history()[1].startinfoindex = c;
+      history()[1].draw_pic = false;
+      history()[1].state_is_valid = false;
+      whole_sequence_low_lim() = (startinfolist[c].into_the_middle) ? 2 : 1;
    }
    inline bool nontrivial_startinfo_specific() { return startinfoindex != 0; }
    inline startinfo *get_startinfo_specific() { return &startinfolist[startinfoindex]; }
@@ -2781,34 +2797,17 @@ enum split_command_kind {
 /* VARIABLES */
 
 
-extern SDLIB_API char error_message1[MAX_ERR_LENGTH];               /* in SDTOP */
-extern SDLIB_API char error_message2[MAX_ERR_LENGTH];               /* in SDTOP */
-extern SDLIB_API bool enforce_overcast_warning;                     /* in SDTOP */
-extern SDLIB_API uint32 collision_person1;                          /* in SDTOP */
-extern SDLIB_API uint32 collision_person2;                          /* in SDTOP */
-extern SDLIB_API int history_allocation;                            /* in SDTOP */
-extern SDLIB_API int written_history_items;                         /* in SDTOP */
-
 extern SDLIB_API call_with_name **base_calls;                       /* in SDTOP */
 extern SDLIB_API dance_level level_threshholds_for_pick[];          /* in SDTOP */
-extern SDLIB_API int hashed_randoms;                                /* in SDTOP */
 
-extern SDLIB_API error_flag_type global_error_flag;                 /* in SDUTIL */
 extern SDLIB_API bool global_cache_failed_flag;                     /* in SDUTIL */
 extern SDLIB_API int global_cache_miss_reason[3];                   /* in SDUTIL */
-extern SDLIB_API uims_reply_thing global_reply;                     /* in SDUTIL */
 extern configuration *clipboard;                                    /* in SDUTIL */
 extern int clipboard_size;                                          /* in SDUTIL */
-extern bool retain_after_error;                                     /* in SDUTIL */
 extern SDLIB_API const Cstring concept_key_table[];                 /* in SDUTIL */
 
 extern SDLIB_API const concept_table_item concept_table[];          /* in SDCONCPT */
-extern uint32 global_tbonetest;                                     /* in SDCONCPT */
-extern uint32 global_livemask;                                      /* in SDCONCPT */
-extern uint32 global_selectmask;                                    /* in SDCONCPT */
-extern uint32 global_tboneselect;                                   /* in SDCONCPT */
 
-extern parse_block *last_magic_diamond;                             /* in SDTOP */
 extern warning_info no_search_warnings;                             /* in SDTOP */
 extern warning_info conc_elong_warnings;                            /* in SDTOP */
 extern warning_info dyp_each_warnings;                              /* in SDTOP */
@@ -3239,6 +3238,7 @@ extern int concepts_in_place();
 extern int resolve_command_ok();
 extern int nice_setup_command_ok();
 void initialize_getout_tables();
+void load_getout_table();
 
 
 /* In SDTOP */
@@ -3248,6 +3248,12 @@ extern void clear_bits_for_update(setup *ss);
 extern void clear_absolute_proximity_bits(setup *ss);
 extern void clear_absolute_proximity_and_facing_bits(setup *ss);
 
+// A hash of everything about a setup that doing a call from it depends on:
+// the kind, the rotation, the people, and the result flags.  The "cmd" part,
+// which toplevelmove fills in fresh, is left out.
+extern uint64_t hash_setup(const setup *ss);
+extern bool same_setup_for_call(const setup *a, const setup *b);
+
 // This gets a ===> BIG-ENDIAN <=== mask of people's facing directions.
 // Each person occupies 2 bits in the resultant masks.  The "livemask"
 // bits are both on if the person is live.
@@ -3323,6 +3329,11 @@ inline uint32 rotccw(uint32 n)
 { if (n == 0) return 0; else return (n + 033) & ~064; }
 
 
+// One step of hash_setup and hash_parse_tree.
+inline uint64_t hash_step(uint64_t h, uint64_t x)
+{ h = (h ^ x) * 0x9E3779B97F4A7C15ULL; return h ^ (h >> 29); }
+
+
 inline uint32 little_endian_live_mask(const setup *ss)
 {
    int i;
@@ -3987,6 +3998,9 @@ extern void FuckingThingToTryToKeepTheFuckingStupidMicrosoftCompilerFromScrewing
 
 SDLIB_API extern parse_block *copy_parse_tree(parse_block *original_tree);
 SDLIB_API extern void reset_parse_tree(parse_block *original_tree, parse_block *final_head);
+extern uint64_t hash_parse_tree(const parse_block *tree);
+extern int flatten_parse_tree(const parse_block *tree, parse_tree_item *items, int room);
+extern bool same_parse_tree(const parse_tree_item *a, int a_count, const parse_tree_item *b, int b_count);
 SDLIB_API void randomize_couple_colors();
 SDLIB_API void string_copy(char **dest, Cstring src);
 SDLIB_API extern void initialize_parse();
@@ -3996,6 +4010,7 @@ SDLIB_API extern bool fix_up_call_for_fidelity_test(const setup *old, const setu
 /* In SDPICK */
 
 bool in_exhaustive_search();
+bool in_random_search();
 void reset_internal_iterators();
 selector_kind do_selector_iteration(bool allow_iteration);
 direction_kind do_direction_iteration();
@@ -4013,6 +4028,7 @@ call_with_name *do_pick();
 resolve_goodness_test get_resolve_goodness_info();
 bool pick_allow_multiple_items();
 void start_pick();
+void start_random_pick();
 void end_pick();
 bool forbid_call_with_mandatory_subcall();
 bool allow_random_subcall_pick();
@@ -962,12 +962,6 @@ struct call_conc_option_state {
 parse_block *get_parse_block_mark();
 parse_block *get_parse_block();
 
-/* in SDPREDS */
-extern bool selector_used;
-extern bool direction_used;
-extern bool number_used;
-extern bool mandatory_call_used;
-
 extern SDLIB_API int useful_concept_indices[UC_extent];             /* in SDINIT */
 
 
@@ -1654,11 +1648,7 @@ extern SDLIB_API call_with_name **main_call_lists[call_list_extent];
 extern SDLIB_API int number_of_calls[call_list_extent];
 
 
-extern SDLIB_API bool using_active_phantoms;                        /* in SDTOP */
-extern SDLIB_API int allowing_modifications;                        /* in SDTOP */
 extern SDLIB_API const call_conc_option_state null_options;         /* in SDTOP */
-extern SDLIB_API int config_history_ptr;                            /* in SDTOP */
-extern SDLIB_API bool allowing_all_concepts;                        /* in SDTOP */
 extern SDLIB_API int abs_max_calls;                                 /* in SDTOP */
 extern SDLIB_API int max_base_calls;                                /* in SDTOP */
 extern SDLIB_API Cstring *tagger_menu_list[NUM_TAGGER_CLASSES];     /* in SDTOP */
@@ -1667,7 +1657,6 @@ extern SDLIB_API Cstring *direction_menu_list;                      /* in SDTOP
 extern SDLIB_API Cstring *circcer_menu_list;                        /* in SDTOP */
 extern SDLIB_API int num_command_commands;                          /* in SDTOP */
 extern SDLIB_API Cstring *command_commands;                         /* in SDTOP */
-extern SDLIB_API ui_utils *gg77;                                    /* in SDTOP */
 
 
 extern SDLIB_API call_with_name **tagger_calls[NUM_TAGGER_CLASSES]; /* in SDTOP */
@@ -1676,6 +1665,5 @@ extern SDLIB_API uint32 number_of_taggers[NUM_TAGGER_CLASSES];      /* in SDTOP
 extern SDLIB_API uint32 number_of_taggers_allocated[NUM_TAGGER_CLASSES]; /* in SDTOP */
 extern SDLIB_API uint32 number_of_circcers;                         /* in SDTOP */
 extern SDLIB_API uint32 number_of_circcers_allocated;               /* in SDTOP */
-extern SDLIB_API call_conc_option_state current_options;            /* in SDTOP */
 
 #endif   /* SDBASE_H */
@@ -570,6 +570,7 @@ void collision_collector::install_with_collision(
    const setup *sourcepeople, int sourceplace,
    int rot) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (resultplace < 0) fail("This would go into an excessively large matrix.");
    m_result_mask |= 1<<resultplace;
    int destination = resultplace;
@@ -578,10 +579,10 @@ void collision_collector::install_with_collision(
       // We have a collision.
       destination += 12;
       // Prepare the error message, in case it is needed.
-      collision_person1 = result->people[resultplace].id1;
-      collision_person2 = sourcepeople->people[sourceplace].id1;
-      error_message1[0] = '\0';
-      error_message2[0] = '\0';
+      e.m_collision_person1 = result->people[resultplace].id1;
+      e.m_collision_person2 = sourcepeople->people[sourceplace].id1;
+      e.m_error_message1[0] = '\0';
+      e.m_error_message2[0] = '\0';
 
       // ****** but if m_allow_collisions is "collision_severity_controversial", we want to give a fairly serious warning.
 
@@ -1262,7 +1263,7 @@ extern bool check_restriction(
          }
       }
    case restriction_bad_level:
-      if (allowing_all_concepts) {
+      if (current_engine->m_allowing_all_concepts) {
          warn(warn__bad_call_level);
          goto getout;
       }
@@ -5921,7 +5922,7 @@ static uint32 do_actual_array_call(
 
                         if (((p ^ ss->people[f2].id1) & ROLL_DIRMASK) == 0) {
                            // My roll dir now is same as it was.
-                           if (enforce_overcast_warning &&
+                           if (current_engine->m_enforce_overcast_warning &&
                                ((result->people[place].id1 ^ ss->people[f8].id1) & ROLL_DIRMASK) == 0) {
                               // Other person -- same.  Check whether the call prevents this.
                               if (!ss->cmd.callspec ||
@@ -6264,7 +6265,7 @@ foobar:
    calldeflist = qq->callarray_list;
    if (qq->modifier_level > calling_level &&
        !(ss->cmd.cmd_misc_flags & CMD_MISC__NO_CHECK_MOD_LEVEL)) {
-      if (allowing_all_concepts)
+      if (current_engine->m_allowing_all_concepts)
          warn(warn__bad_modifier_level);
       else
          fail("Use of this modifier on this call is not allowed at this level.");
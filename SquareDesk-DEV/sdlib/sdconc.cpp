@@ -115,6 +115,7 @@ select::fixer *select::fixer_ptr_table[fx_ENUM_EXTENT];
 
 void select::initialize()
 {
+   engine_context & e = *current_engine;
    sel_item *selp;
    int i;
 
@@ -132,13 +133,13 @@ void select::initialize()
 
    for (fixp = fixer_init_table ; fixp->mykey != fx0 ; fixp++) {
       if (fixer_ptr_table[fixp->mykey])
-         gg77->iob88.fatal_error_exit(1, "Fixer table initialization failed", "dup");
+         e.m_gg77->iob88.fatal_error_exit(1, "Fixer table initialization failed", "dup");
       fixer_ptr_table[fixp->mykey] = fixp;
    }
 
    for (i=fx0+1 ; i<fx_ENUM_EXTENT ; i++) {
       if (!fixer_ptr_table[i])
-         gg77->iob88.fatal_error_exit(1, "Fixer table initialization failed", "undef");
+         e.m_gg77->iob88.fatal_error_exit(1, "Fixer table initialization failed", "undef");
    }
 }
 
@@ -3030,6 +3031,7 @@ extern void concentric_move(
    uint32 specialoffsetmapcode,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (ss->cmd.cmd_misc2_flags & CMD_MISC2__DO_NOT_EXECUTE) {
       clear_result_flags(result);
       result->kind = nothing;
@@ -3074,7 +3076,7 @@ extern void concentric_move(
    uint32 final_outers_finish_directions[32];
    uint32 ccmask, eemask;
 
-   const call_conc_option_state save_state = current_options;
+   const call_conc_option_state save_state = e.m_current_options;
    uint32 save_cmd_misc2_flags = ss->cmd.cmd_misc2_flags;
 
    parse_block *save_skippable_concept = ss->cmd.skippable_concept;
@@ -3120,8 +3122,8 @@ extern void concentric_move(
          if ((ss->cmd.restrained_selector_decoder[0] | ss->cmd.restrained_selector_decoder[1]) != 0)
             fail("Concept nesting is too complicated.");    // Really shouldn't happen.
 
-         selector_kind little_saved_selector = current_options.who;
-         current_options.who = sel;
+         selector_kind little_saved_selector = e.m_current_options.who;
+         e.m_current_options.who = sel;
 
          int nump = 0;
          for (i=0; i<=attr::slimit(ss); i++) {
@@ -3139,7 +3141,7 @@ extern void concentric_move(
             }
          }
 
-         current_options.who = little_saved_selector;
+         e.m_current_options.who = little_saved_selector;
       }
    }
 
@@ -3347,7 +3349,7 @@ extern void concentric_move(
       if (doing_ends ^ (((save_cmd_misc2_flags & CMD_MISC2__ANY_WORK_CALL_CROSSED) != 0) ? 1 : 0))
          ctr_use_flag |= CMD_MISC2__ANY_WORK_INVERT;
 
-      current_options = save_state;
+      e.m_current_options = save_state;
 
       // We allow "quick so-and-so shove off"!
 
@@ -3522,7 +3524,7 @@ extern void concentric_move(
 
          process_number_insertion(modifiers1);
          // Save the numbers, in case we have to figure out whether "cast off N/4" changed shape.
-         *option_ptr = current_options;
+         *option_ptr = e.m_current_options;
 
          if (recompute_id &&
              !(save_cmd_misc2_flags & CMD_MISC2__CTR_END_KMASK) &&
@@ -3801,7 +3803,7 @@ extern void concentric_move(
          if (we_are_mirroring)
             mirror_this(result_ptr);
 
-         current_options = save_state;
+         e.m_current_options = save_state;
 
          if (doing_ends)
             saved_end_warnings.setmultiple(configuration::save_warnings());
@@ -5513,6 +5515,7 @@ extern void inner_selective_move(
    uint32 modsb1,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    int i, k;
    int setupcount;
    bool crossconc;
@@ -5589,8 +5592,8 @@ extern void inner_selective_move(
       }
    }
 
-   selector_kind saved_selector = current_options.who;
-   current_options.who = selector_to_use;
+   selector_kind saved_selector = e.m_current_options.who;
+   e.m_current_options.who = selector_to_use;
 
    // Nonzero means we are not using the given selector, but are overriding it
    // with specific "decoder" information.
@@ -5638,10 +5641,10 @@ extern void inner_selective_move(
                t0 >>= 8;
             }
          }
-         else if (ss->kind == s1x8 && current_options.who == selector_centers) {
+         else if (ss->kind == s1x8 && e.m_current_options.who == selector_centers) {
             if (i&2) q = 1;
          }
-         else if (ss->kind == s1x8 && current_options.who == selector_ends) {
+         else if (ss->kind == s1x8 && e.m_current_options.who == selector_ends) {
             if (!(i&2)) q = 1;
          }
          else if (override_selector) {
@@ -5667,7 +5670,7 @@ extern void inner_selective_move(
       }
    }
 
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 
    // If we are doing the special stuff instead of an actual selector,
    // turn off the given selector to prevent the code below from being led astray.
@@ -6062,8 +6065,8 @@ extern void inner_selective_move(
                local_setup.cmd.cmd_final_flags = local_flags;
 
                if (whattodo->compressor_backout) expand::compress_setup(*whattodo->compressor_backout, &local_setup);
-               call_conc_option_state saved_options = current_options;
-               current_options = parseptrcopy->options;
+               call_conc_option_state saved_options = e.m_current_options;
+               e.m_current_options = parseptrcopy->options;
 
                uint32 override =
                   (callspec->stuff.conc.outerdef.call_id == base_call_plainprom ||
@@ -6073,22 +6076,22 @@ extern void inner_selective_move(
                really_inner_move(&local_setup, false, callspec, whattodo->schema1,
                                  callspec->callflags1, callspec->callflagsf,
                                  override, false, 0, false, result);
-               current_options = saved_options;
+               e.m_current_options = saved_options;
                return;
             }
          }
          else if (callspec->schema == schema_cross_concentric_specialpromenade) {
             if (whattodo) {
                if (whattodo->compressor_backout) expand::compress_setup(*whattodo->compressor_backout, ss);
-               call_conc_option_state saved_options = current_options;
-               current_options = parseptrcopy->options;
+               call_conc_option_state saved_options = e.m_current_options;
+               e.m_current_options = parseptrcopy->options;
                // Be sure people don't come in to the middle while others are in the way.
-               if ((1 << (current_options.number_fields & 1)) & whattodo->rotation_forbid)
+               if ((1 << (e.m_current_options.number_fields & 1)) & whattodo->rotation_forbid)
                   fail("These people can't come into the middle gracefully.");
 
                really_inner_move(ss, false, callspec, whattodo->xschema, callspec->callflags1, callspec->callflagsf,
                                  DFM1_CONC_FORCE_OTHERWAY, false, 0, false, result);
-               current_options = saved_options;
+               e.m_current_options = saved_options;
                return;
             }
          }
@@ -6418,8 +6421,8 @@ extern void inner_selective_move(
    for (setupcount=0; ; setupcount++) {
 
       // Not clear that this is really right.
-      uint32 svd_number_fields = current_options.number_fields;
-      int svd_num_numbers = current_options.howmanynumbers;
+      uint32 svd_number_fields = e.m_current_options.number_fields;
+      int svd_num_numbers = e.m_current_options.howmanynumbers;
       uint32 thislivemask = livemask[setupcount];
       uint32 otherlivemask = livemask[setupcount^1];
       setup *this_one = &the_setups[setupcount];
@@ -7023,8 +7026,8 @@ extern void inner_selective_move(
 
    done_with_this_one:
 
-      current_options.number_fields = svd_number_fields;
-      current_options.howmanynumbers = svd_num_numbers;
+      e.m_current_options.number_fields = svd_number_fields;
+      e.m_current_options.howmanynumbers = svd_num_numbers;
 
       if (setupcount >= others) break;
    }
@@ -40,11 +40,7 @@
    nose_move
    stable_move
 
-and the following external variables:
-   global_tbonetest
-   global_livemask
-   global_selectmask
-   global_tboneselect
+and the following external variable:
    concept_table
 */
 
@@ -53,12 +49,6 @@ and the following external variables:
 
 #include "sd.h"
 
-static uint32 orig_tbonetest;
-uint32 global_tbonetest;
-uint32 global_livemask;
-uint32 global_selectmask;
-uint32 global_tboneselect;
-
 
 
 static void do_concept_expand_some_matrix(
@@ -235,6 +225,7 @@ static void do_c1_phantom_move(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    // If arg2 is nonzero, this is actually the "diagonal box" concept.
 
    parse_block *next_parseptr;
@@ -335,7 +326,7 @@ static void do_c1_phantom_move(
       goto use_map;
    }
 
-   if (ss->kind == s4x4 && global_livemask == 0x6666) {
+   if (ss->kind == s4x4 && e.m_global_livemask == 0x6666) {
       // First, check for everyone on "O" spots.  If so, treat them as though
       // in equivalent C1 phantom spots.
       map_ptr = &map_o_spots;
@@ -350,9 +341,9 @@ static void do_c1_phantom_move(
 
       // Check for a 3x4 occupied as a distorted "pinwheel", and treat it as phantoms.
 
-      if (global_livemask == 04747)
+      if (e.m_global_livemask == 04747)
          map_ptr = &map_pinwheel7;
-      else if (global_livemask == 05656)
+      else if (e.m_global_livemask == 05656)
          map_ptr = &map_pinwheel8;
    }
    else if (ss->kind == s4x4) {
@@ -360,43 +351,43 @@ static void do_c1_phantom_move(
 
       // Check for a 4x4 occupied as a "pinwheel" or "tophat", and treat it as phantoms.
 
-      if (global_livemask == 0xCCCC) {
+      if (e.m_global_livemask == 0xCCCC) {
          map_ptr = &map_pinwheel1;
          goto use_map;
       }
-      else if (global_livemask == 0xAAAA) {
+      else if (e.m_global_livemask == 0xAAAA) {
          map_ptr = &map_pinwheel2;
          goto use_map;
       }
-      else if (global_livemask == 0x7878) {
+      else if (e.m_global_livemask == 0x7878) {
          map_ptr = &map_pinwheel3;
          goto use_map;
       }
-      else if (global_livemask == 0xE1E1) {
+      else if (e.m_global_livemask == 0xE1E1) {
          map_ptr = &map_pinwheel4;
          goto use_map;
       }
-      else if (global_livemask == 0x8787) {
+      else if (e.m_global_livemask == 0x8787) {
          map_ptr = &map_pinwheel5;
          goto use_map;
       }
-      else if (global_livemask == 0x1E1E) {
+      else if (e.m_global_livemask == 0x1E1E) {
          map_ptr = &map_pinwheel6;
          goto use_map;
       }
-      else if (global_livemask == 0xA8CE) {
+      else if (e.m_global_livemask == 0xA8CE) {
          map_ptr = &map_tophat1;
          goto use_map;
       }
-      else if (global_livemask == 0x8CEA) {
+      else if (e.m_global_livemask == 0x8CEA) {
          map_ptr = &map_tophat2;
          goto use_map;
       }
-      else if (global_livemask == 0xCEA8) {
+      else if (e.m_global_livemask == 0xCEA8) {
          map_ptr = &map_tophat3;
          goto use_map;
       }
-      else if (global_livemask == 0xEA8C) {
+      else if (e.m_global_livemask == 0xEA8C) {
          map_ptr = &map_tophat4;
          goto use_map;
       }
@@ -404,7 +395,7 @@ static void do_c1_phantom_move(
       // Next, check for a "phantom turn and deal" sort of thing from stairsteps.
       // Do the call in each line, them remove resulting phantoms carefully.
 
-      if (global_livemask == 0x5C5C || global_livemask == 0xA3A3) {
+      if (e.m_global_livemask == 0x5C5C || e.m_global_livemask == 0xA3A3) {
          // Split into 4 vertical strips.  Flip the setup around.
          ss->rotation++;
          canonicalize_rotation(ss);
@@ -412,7 +403,7 @@ static void do_c1_phantom_move(
          result->rotation--;
          canonicalize_rotation(ss);
       }
-      else if (global_livemask == 0xC5C5 || global_livemask == 0x3A3A) {
+      else if (e.m_global_livemask == 0xC5C5 || e.m_global_livemask == 0x3A3A) {
          // Split into 4 horizontal strips.
          divided_setup_move(ss, MAPCODE(s1x4,4,MPKIND__SPLIT,1), phantest_ok, true, result);
       }
@@ -570,14 +561,15 @@ static void do_concept_single_diagonal(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (ss->kind != s4x4) fail("Need a 4x4 for this.");
 
-   if (global_livemask != 0x2D2D && global_livemask != 0xD2D2)
+   if (e.m_global_livemask != 0x2D2D && e.m_global_livemask != 0xD2D2)
       fail("People must be in blocks -- try specifying the people who should do the call.");
 
    selective_move(ss, parseptr, selective_key_disc_dist, 0,
                   parseptr->concept->arg1,
-                  global_livemask & 0x9999, selector_uninitialized, false, result);
+                  e.m_global_livemask & 0x9999, selector_uninitialized, false, result);
 }
 
 
@@ -600,10 +592,10 @@ static void do_concept_double_diagonal(
 
       setup ssave = *ss;
 
-      if (ss->kind != sbighrgl) global_livemask = 0;   // Force error.
+      if (ss->kind != sbighrgl) current_engine->m_global_livemask = 0;   // Force error.
 
-      if (global_livemask == 0x3CF) { map_code = spcmap_dhrgl1; }
-      else if (global_livemask == 0xF3C) { map_code = spcmap_dhrgl2; }
+      if (current_engine->m_global_livemask == 0x3CF) { map_code = spcmap_dhrgl1; }
+      else if (current_engine->m_global_livemask == 0xF3C) { map_code = spcmap_dhrgl2; }
       else fail("Can't find distorted 1x6.");
 
       if (parseptr->concept->arg1 == 3)
@@ -627,13 +619,13 @@ static void do_concept_double_diagonal(
       // This is "diagonal CLW's of 3".
 
       setup ssave = *ss;
-      int switcher = (parseptr->concept->arg1 ^ global_tbonetest) & 1;
+      int switcher = (parseptr->concept->arg1 ^ current_engine->m_global_tbonetest) & 1;
 
-      if (ss->kind != s4x4 || (global_tbonetest & 011) == 011) global_livemask = 0;   // Force error.
+      if (ss->kind != s4x4 || (current_engine->m_global_tbonetest & 011) == 011) current_engine->m_global_livemask = 0;   // Force error.
 
-      if (     global_livemask == 0x2D2D)
+      if (     current_engine->m_global_livemask == 0x2D2D)
          map_code = switcher ? spcmap_diag23a : spcmap_diag23b;
-      else if (global_livemask == 0xD2D2)
+      else if (current_engine->m_global_livemask == 0xD2D2)
          map_code = switcher ? spcmap_diag23c : spcmap_diag23d;
       else
          fail("There are no diagonal lines or columns of 3 here.");
@@ -653,10 +645,10 @@ static void do_concept_double_diagonal(
       copy_person(result, 12, &ssave, 12);
    }
    else {
-      tbonetest = global_tbonetest;
+      tbonetest = current_engine->m_global_tbonetest;
 
       if (ss->kind == s4x4) {
-         if (global_livemask == 0x9999) {
+         if (current_engine->m_global_livemask == 0x9999) {
             if ((parseptr->concept->arg1 ^ tbonetest) & 1) {
                map_code = MAPCODE(s1x4,2,MPKIND__NS_CROSS_IN_4X4,0);
                tbonetest = ~tbonetest;  // Trick the line/column test below, so it does the right thing.
@@ -668,8 +660,8 @@ static void do_concept_double_diagonal(
             tbonetest = ~0U;   // Force error.
       }
       else if (ss->kind == s4x6) {
-         if (     global_livemask == 0x2A82A8) map_code = spcmap_diag2a;
-         else if (global_livemask == 0x505505) map_code = spcmap_diag2b;
+         if (     current_engine->m_global_livemask == 0x2A82A8) map_code = spcmap_diag2a;
+         else if (current_engine->m_global_livemask == 0x505505) map_code = spcmap_diag2b;
          else
             tbonetest = ~0U;   // Force error.
       }
@@ -696,19 +688,20 @@ static void do_concept_double_offset(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (ss->kind != s2x4) fail("Must have a 2x4 setup to do this concept.");
 
    uint32 topmask, botmask, ctrmask;
    uint32 directions, livemask, map_code;
    big_endian_get_directions(ss, directions, livemask);  // Get big-endian bit-pair masks.
 
-   if (global_selectmask == (global_livemask & 0xCC)) {
+   if (e.m_global_selectmask == (e.m_global_livemask & 0xCC)) {
       topmask = 0xF000 & livemask;
       botmask = 0x00F0 & livemask;
       ctrmask = 0x0F0F & livemask;
       map_code = spcmap_dbloff1;
    }
-   else if (global_selectmask == (global_livemask & 0x33)) {
+   else if (e.m_global_selectmask == (e.m_global_livemask & 0x33)) {
       topmask = 0x0F00 & livemask;
       botmask = 0x000F & livemask;
       ctrmask = 0xF0F0 & livemask;
@@ -819,6 +812,7 @@ static void do_concept_multiple_lines_tog(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    // This can only be standard for
    // together/apart/clockwise/counterclockwise/toward-the-center,
    // not for forward/back/left/right, because we look at
@@ -863,13 +857,13 @@ static void do_concept_multiple_lines_tog(
       if (cstuff >= 10) {
          if (ss->kind != s1x12) fail("Must have a 1x12 setup for this concept.");
 
-         if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+         if ((e.m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
          if (linesp & 1) {
-            if (global_tbonetest & 1) fail("There are no lines of 4 here.");
+            if (e.m_global_tbonetest & 1) fail("There are no lines of 4 here.");
          }
          else {
-            if (!(global_tbonetest & 1)) fail("There are no columns of 4 here.");
+            if (!(e.m_global_tbonetest & 1)) fail("There are no columns of 4 here.");
          }
 
          if (cstuff == 10) {     // Working together.
@@ -885,7 +879,7 @@ static void do_concept_multiple_lines_tog(
       else {
          if (ss->kind != s3x4) fail("Must have a 3x4 setup for this concept.");
 
-         uint32 tbonetest = (cstuff < 8) ? or_all_people(ss) : global_tbonetest;
+         uint32 tbonetest = (cstuff < 8) ? or_all_people(ss) : e.m_global_tbonetest;
 
          if ((tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
@@ -920,8 +914,8 @@ static void do_concept_multiple_lines_tog(
 
       if (ss->kind != s4x4) fail("Must have a 4x4 setup for this concept.");
 
-      uint32 livemask = (cstuff < 8) ? little_endian_live_mask(ss) : global_livemask;
-      uint32 tbonetest = (cstuff < 8) ? or_all_people(ss) : global_tbonetest;
+      uint32 livemask = (cstuff < 8) ? little_endian_live_mask(ss) : e.m_global_livemask;
+      uint32 tbonetest = (cstuff < 8) ? or_all_people(ss) : e.m_global_tbonetest;
       int map_table_key = 0;
 
       if ((tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
@@ -977,8 +971,8 @@ static void do_concept_multiple_lines_tog(
       if (cstuff >= 12) {
          if (ss->kind != s4x4) fail("Must have a 4x4 setup to do this concept.");
 
-         if ((global_tbonetest & 011) == 011) fail("Sorry, can't do this from T-bone setup.");
-         rotfix = (global_tbonetest ^ linesp ^ 1) & 1;
+         if ((e.m_global_tbonetest & 011) == 011) fail("Sorry, can't do this from T-bone setup.");
+         rotfix = (e.m_global_tbonetest ^ linesp ^ 1) & 1;
          ss->rotation += rotfix;   // Just flip the setup around and recanonicalize.
          canonicalize_rotation(ss);
 
@@ -987,13 +981,13 @@ static void do_concept_multiple_lines_tog(
       else if (cstuff >= 10) {
          if (ss->kind != s1x16) fail("Must have a 1x16 setup for this concept.");
 
-         if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+         if ((e.m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
          if (linesp & 1) {
-            if (global_tbonetest & 1) fail("There are no lines of 4 here.");
+            if (e.m_global_tbonetest & 1) fail("There are no lines of 4 here.");
          }
          else {
-            if (!(global_tbonetest & 1)) fail("There are no columns of 4 here.");
+            if (!(e.m_global_tbonetest & 1)) fail("There are no columns of 4 here.");
          }
 
          if (cstuff == 10) {    // Working together end-to-end.
@@ -1015,7 +1009,7 @@ static void do_concept_multiple_lines_tog(
 
          if (cstuff >= 8) {
             // Clockwise/counterclockwise can use "standard".
-            tbonetest = global_tbonetest;
+            tbonetest = e.m_global_tbonetest;
             if ((tbonetest & 011) == 011)  // But we can't have the standard people inconsistent.
                fail("Standard people are inconsistent.");
          }
@@ -1067,7 +1061,7 @@ static void do_concept_multiple_lines_tog(
 
       if (ss->kind != s4x5) fail("Must have a 4x5 setup for this concept.");
 
-      uint32 tbonetest = (cstuff < 8) ? or_all_people(ss) : global_tbonetest;
+      uint32 tbonetest = (cstuff < 8) ? or_all_people(ss) : e.m_global_tbonetest;
 
       if ((tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
@@ -1112,7 +1106,7 @@ static void do_concept_multiple_lines_tog(
       // Expanding to a 4x6 is tricky.  See the extensive comments in the
       // function "triple_twin_move" in sdistort.c .
 
-      uint32 tbonetest = (cstuff < 8) ? or_all_people(ss) : global_tbonetest;
+      uint32 tbonetest = (cstuff < 8) ? or_all_people(ss) : e.m_global_tbonetest;
 
       if ((tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
@@ -1180,13 +1174,14 @@ static void do_concept_multiple_lines_tog(
 static uint32 get_standard_people(setup *ss, selector_kind who,
                                   uint32 & tbonetest, uint32 & stdtest)
 {
+   engine_context & e = *current_engine;
    int i, j;
    tbonetest = 0;
    stdtest = 0;
    uint32 livemask = 0;
-   selector_kind saved_selector = current_options.who;
+   selector_kind saved_selector = e.m_current_options.who;
 
-   current_options.who = who;
+   e.m_current_options.who = who;
 
    for (i=0, j=1; i<=attr::slimit(ss); i++, j<<=1) {
       int p = ss->people[i].id1;
@@ -1197,7 +1192,7 @@ static uint32 get_standard_people(setup *ss, selector_kind who,
       }
    }
 
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
    return livemask;
 }
 
@@ -1207,6 +1202,7 @@ static void do_concept_parallelogram(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    ss->cmd.cmd_misc_flags |= CMD_MISC__SAID_PG_OFFSET;
 
    // First, deal with "parallelogram diamonds".
@@ -1267,36 +1263,36 @@ static void do_concept_parallelogram(
    mpkind mk;
 
    if (ss->kind == s2x6) {
-      if (global_livemask == 07474) {
+      if (e.m_global_livemask == 07474) {
          mk = MPKIND__OFFS_R_HALF; }
-      else if (global_livemask == 01717) {
+      else if (e.m_global_livemask == 01717) {
          mk = MPKIND__OFFS_L_HALF; }
       else fail("Can't find a parallelogram.");
       is_pgram = true;
    }
    else if (ss->kind == s2x5) {
       warn(warn__1_4_pgram);
-      if (global_livemask == 0x3DE) {
+      if (e.m_global_livemask == 0x3DE) {
          mk = MPKIND__OFFS_R_ONEQ; }
-      else if (global_livemask == 0x1EF) {
+      else if (e.m_global_livemask == 0x1EF) {
          mk = MPKIND__OFFS_L_ONEQ; }
       else fail("Can't find a parallelogram.");
       is_pgram = true;
    }
    else if (ss->kind == s2x7) {
       warn(warn__3_4_pgram);
-      if (global_livemask == 0x3C78) {
+      if (e.m_global_livemask == 0x3C78) {
          mk = MPKIND__OFFS_R_THRQ; }
-      else if (global_livemask == 0x078F) {
+      else if (e.m_global_livemask == 0x078F) {
          mk = MPKIND__OFFS_L_THRQ; }
       else fail("Can't find a parallelogram.");
       is_pgram = true;
    }
    else if (ss->kind == s2x8) {
       warn(warn__full_pgram);
-      if (global_livemask == 0xF0F0) {
+      if (e.m_global_livemask == 0xF0F0) {
          mk = MPKIND__OFFS_R_FULL; }
-      else if (global_livemask == 0x0F0F) {
+      else if (e.m_global_livemask == 0x0F0F) {
          mk = MPKIND__OFFS_L_FULL; }
       else fail("Can't find a parallelogram.");
       is_pgram = true;
@@ -1321,9 +1317,9 @@ static void do_concept_parallelogram(
    else if (ss->kind == s4x6 && kk == concept_do_phantom_2x4) {
       // See whether people fit unambiguously
       // into one parallelogram or the other.
-      if ((global_livemask & 003600360) == 0 && (global_livemask & 060036003) != 0)
+      if ((e.m_global_livemask & 003600360) == 0 && (e.m_global_livemask & 060036003) != 0)
          mk = MPKIND__OFFS_L_HALF;
-      else if ((global_livemask & 060036003) == 0 && (global_livemask & 003600360) != 0)
+      else if ((e.m_global_livemask & 060036003) == 0 && (e.m_global_livemask & 003600360) != 0)
          mk = MPKIND__OFFS_R_HALF;
       else fail("Can't find a parallelogram.");
       warn(warn__pg_hard_to_see);
@@ -1332,9 +1328,9 @@ static void do_concept_parallelogram(
    else if (ss->kind == s4x5 && kk == concept_do_phantom_2x4) {
       // See whether people fit unambiguously
       // into one parallelogram or the other.
-      if ((global_livemask & 0x0C030) == 0 && (global_livemask & 0x80601) != 0)
+      if ((e.m_global_livemask & 0x0C030) == 0 && (e.m_global_livemask & 0x80601) != 0)
          mk = MPKIND__OFFS_L_ONEQ;
-      else if ((global_livemask & 0x80601) == 0 && (global_livemask & 0x0C030) != 0)
+      else if ((e.m_global_livemask & 0x80601) == 0 && (e.m_global_livemask & 0x0C030) != 0)
          mk = MPKIND__OFFS_R_ONEQ;
       else fail("Can't find a parallelogram.");
       warn(warn__1_4_pgram);
@@ -1365,8 +1361,8 @@ static void do_concept_parallelogram(
       if (standard_concept) {
          ss->cmd.cmd_misc_flags |= CMD_MISC__NO_STEP_TO_WAVE;
          uint32 tbonetest;
-         global_livemask = get_standard_people(ss, standard_concept->options.who,
-                                               tbonetest, global_tbonetest);
+         e.m_global_livemask = get_standard_people(ss, standard_concept->options.who,
+                                               tbonetest, e.m_global_tbonetest);
 
          if (!tbonetest) {
             result->kind = nothing;
@@ -1377,17 +1373,17 @@ static void do_concept_parallelogram(
          if ((tbonetest & 011) != 011)
             fail("People are not T-boned -- 'standard' is meaningless.");
 
-         if (!global_tbonetest)
+         if (!e.m_global_tbonetest)
             fail("No one is standard.");
-         if ((global_tbonetest & 011) == 011)
+         if ((e.m_global_tbonetest & 011) == 011)
             fail("The standard people are not facing consistently.");
       }
 
       if (linesp & 1) {
-         if (global_tbonetest & 1) fail("There are no lines of 4 here.");
+         if (e.m_global_tbonetest & 1) fail("There are no lines of 4 here.");
       }
       else {
-         if (global_tbonetest & 010) fail("There are no columns of 4 here.");
+         if (e.m_global_tbonetest & 010) fail("There are no columns of 4 here.");
       }
 
       if (linesp == 3)
@@ -1855,10 +1851,10 @@ static void do_concept_multiple_lines(
    if (parseptr->concept->arg4 == 4) {
       if (parseptr->concept->arg3) {
          // This is "quadruple C/L/W OF 3".
-         if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+         if ((current_engine->m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
          if (ss->kind == s3x4) {
-            if ((clw_indicator ^ global_tbonetest) & 1) {
+            if ((clw_indicator ^ current_engine->m_global_tbonetest) & 1) {
                if (clw_indicator & 1) fail("There are no lines of 3 here.");
                else                   fail("There are no columns of 3 here.");
             }
@@ -1866,7 +1862,7 @@ static void do_concept_multiple_lines(
             code = MAPCODE(s1x3,4,MPKIND__SPLIT,1);
          }
          else if (ss->kind == s1x12) {
-            if (!((clw_indicator ^ global_tbonetest) & 1)) {
+            if (!((clw_indicator ^ current_engine->m_global_tbonetest) & 1)) {
                if (clw_indicator & 1) fail("There are no lines of 3 here.");
                else                   fail("There are no columns of 3 here.");
             }
@@ -1880,17 +1876,17 @@ static void do_concept_multiple_lines(
          // This is plain "quadruple C/L/W" (of 4).
 
          if (ss->kind == s4x4) {
-            rot = (global_tbonetest ^ clw_indicator ^ 1) & 1;
-            if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+            rot = (current_engine->m_global_tbonetest ^ clw_indicator ^ 1) & 1;
+            if ((current_engine->m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
             ss->rotation += rot;   // Just flip the setup around and recanonicalize.
             canonicalize_rotation(ss);
             code = MAPCODE(s1x4,4,MPKIND__SPLIT,1);
          }
          else if (ss->kind == s1x16) {
-            if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+            if ((current_engine->m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
-            if (!((clw_indicator ^ global_tbonetest) & 1)) {
+            if (!((clw_indicator ^ current_engine->m_global_tbonetest) & 1)) {
                if (clw_indicator & 1) fail("There are no lines of 4 here.");
                else                   fail("There are no columns of 4 here.");
             }
@@ -1919,9 +1915,9 @@ static void do_concept_multiple_lines(
 
       // Clw_indicator = 2 is the special case of "triple 1x4's".
       if (clw_indicator != 2 && ss->kind != sbigh && ss->kind != sbigx) {
-         if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+         if ((current_engine->m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
-         if (!((clw_indicator ^ global_tbonetest) & 1)) {
+         if (!((clw_indicator ^ current_engine->m_global_tbonetest) & 1)) {
             if (clw_indicator & 1) fail("There are no lines of 4 here.");
             else                   fail("There are no columns of 4 here.");
          }
@@ -1943,9 +1939,9 @@ static void do_concept_multiple_lines(
 
       // Clw_indicator = 2 is the special case of "quintuple 1x4's".
       if (clw_indicator != 2) {
-         if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+         if ((current_engine->m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
-         if ((clw_indicator ^ global_tbonetest) & 1) {
+         if ((clw_indicator ^ current_engine->m_global_tbonetest) & 1) {
             if (clw_indicator & 1) fail("There are no lines of 4 here.");
             else                   fail("There are no columns of 4 here.");
          }
@@ -2047,19 +2043,19 @@ static void do_concept_triple_diag(
 
    if (ss->kind != s_bigblob) fail("Must have a rather large setup for this concept.");
 
-   if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+   if ((current_engine->m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
    if (cstuff == 3)
       ss->cmd.cmd_misc_flags |= CMD_MISC__VERIFY_WAVES;
 
-   if ((global_livemask & ~0x56A56A) == 0) q = 0;
-   else if ((global_livemask & ~0xA95A95) == 0) q = 2;
+   if ((current_engine->m_global_livemask & ~0x56A56A) == 0) q = 0;
+   else if ((current_engine->m_global_livemask & ~0xA95A95) == 0) q = 2;
    else fail("Can't identify triple diagonal setup.");
 
    static specmapkind maps_3diag[4]   = {spcmap_blob_1x4c, spcmap_blob_1x4a,
                                          spcmap_blob_1x4d, spcmap_blob_1x4b};
 
-   divided_setup_move(ss, maps_3diag[q + ((cstuff ^ global_tbonetest) & 1)],
+   divided_setup_move(ss, maps_3diag[q + ((cstuff ^ current_engine->m_global_tbonetest) & 1)],
                       phantest_ok, true, result);
 }
 
@@ -2069,6 +2065,7 @@ static void do_concept_triple_diag_tog(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    int q;
    uint32 m1, m2;
    uint32 masks[2];
@@ -2084,7 +2081,7 @@ static void do_concept_triple_diag_tog(
 
    if (ss->kind != s_bigblob) fail("Must have a rather large setup for this concept.");
 
-   if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+   if ((e.m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
    if (parseptr->concept->arg2 == 3)
       ss->cmd.cmd_misc_flags |= CMD_MISC__VERIFY_WAVES;
@@ -2092,8 +2089,8 @@ static void do_concept_triple_diag_tog(
    /* Initially assign the centers to the right or upper (m2) group. */
    m1 = 0xF0; m2 = 0xFF;
 
-   if ((global_livemask & ~0x56A56A) == 0) q = 0;
-   else if ((global_livemask & ~0xA95A95) == 0) q = 2;
+   if ((e.m_global_livemask & ~0x56A56A) == 0) q = 0;
+   else if ((e.m_global_livemask & ~0xA95A95) == 0) q = 2;
    else fail("Can't identify triple diagonal setup.");
 
    // Look at the center line/column people and put each one in the correct group.
@@ -2101,7 +2098,7 @@ static void do_concept_triple_diag_tog(
    static specmapkind maps_3diagwk[4] = {spcmap_wblob_1x4a, spcmap_wblob_1x4c,
                                          spcmap_wblob_1x4b, spcmap_wblob_1x4d};
 
-   uint32 map_code = maps_3diagwk[q+((cstuff ^ global_tbonetest) & 1)];
+   uint32 map_code = maps_3diagwk[q+((cstuff ^ e.m_global_tbonetest) & 1)];
    const map::map_thing *map_ptr = map::get_map_from_code(map_code);
 
    if ((cstuff + 1 - ss->people[map_ptr->maps[0]].id1) & 2) { m2 &= ~0x80 ; m1 |= 0x1; };
@@ -2432,6 +2429,7 @@ static void do_concept_do_triangular_boxes(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    uint32 division_map_code = ~0U;
    phantest_kind phant = (phantest_kind) parseptr->concept->arg1;
 
@@ -2439,30 +2437,30 @@ static void do_concept_do_triangular_boxes(
       do_matrix_expansion(ss, CONCPROP__NEEDK_4X5, true);
       // Need to compute the livemask again.
       int i, j;
-      global_livemask = 0;
+      e.m_global_livemask = 0;
       for (i=0, j=1; i<=attr::slimit(ss); i++, j<<=1) {
          if (ss->people[i].id1) {
-            global_livemask |= j;
+            e.m_global_livemask |= j;
          }
       }
    }
 
    // We only allow it in a 3x4 if it was real, not phantom.  Arg1 tells which.
    if (ss->kind == s3x4 && phant == phantest_2x2_only_two) {
-      if (global_livemask == 04747)
+      if (e.m_global_livemask == 04747)
          division_map_code = spcmap_trglbox3x4a;
-      else if (global_livemask == 05656)
+      else if (e.m_global_livemask == 05656)
          division_map_code = spcmap_trglbox3x4b;
-      else if (global_livemask == 05353)
+      else if (e.m_global_livemask == 05353)
          division_map_code = spcmap_trglbox3x4c;
-      else if (global_livemask == 05555)
+      else if (e.m_global_livemask == 05555)
          division_map_code = spcmap_trglbox3x4d;
       phant = phantest_ok;
    }
    else if (ss->kind == s4x5 && phant == phantest_2x2_only_two) {
-      if (global_livemask == 0xB12C4)
+      if (e.m_global_livemask == 0xB12C4)
          division_map_code = spcmap_trglbox4x5a;
-      if (global_livemask == 0x691A4)
+      if (e.m_global_livemask == 0x691A4)
          division_map_code = spcmap_trglbox4x5b;
       phant = phantest_ok;
    }
@@ -2530,7 +2528,7 @@ static void do_concept_do_twinphantom_diamonds(
 {
    // See "do_triple_formation" for meaning of arg3.
 
-   if (ss->kind != s4x6 || (global_livemask & 0x02D02D) != 0)
+   if (ss->kind != s4x6 || (current_engine->m_global_livemask & 0x02D02D) != 0)
       fail("Must have twin phantom diamond or 1/4 tag setup for this concept.");
 
    ss->cmd.cmd_misc_flags |= parseptr->concept->arg3;
@@ -2593,6 +2591,7 @@ static void do_concept_dblbent(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
 
 /*
    Args from the concept are as follows:
@@ -2613,97 +2612,97 @@ static void do_concept_dblbent(
    if (arg1 & 16) {
       //Bent boxes.
       if (ss->kind == s3x6) {
-         if (global_livemask == 0x2170B)
+         if (e.m_global_livemask == 0x2170B)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT0CW,0);
-         else if (global_livemask == 0x26934)
+         else if (e.m_global_livemask == 0x26934)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT0CCW,0);
-         else if (global_livemask == 0x0B259)
+         else if (e.m_global_livemask == 0x0B259)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT1CW,0);
-         else if (global_livemask == 0x0CC66)
+         else if (e.m_global_livemask == 0x0CC66)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT1CCW,0);
       }
       else if (ss->kind == s4x6) {
-         if (global_livemask == 0x981981)
+         if (e.m_global_livemask == 0x981981)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT2CW,0);
-         else if (global_livemask == 0x660660)
+         else if (e.m_global_livemask == 0x660660)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT2CCW,0);
-         else if (global_livemask == 0xD08D08)
+         else if (e.m_global_livemask == 0xD08D08)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT3CW,0);
-         else if (global_livemask == 0x2C42C4)
+         else if (e.m_global_livemask == 0x2C42C4)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT3CCW,0);
-         else if (global_livemask == 0x303303)
+         else if (e.m_global_livemask == 0x303303)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT4CW,0);
-         else if (global_livemask == 0x330330)
+         else if (e.m_global_livemask == 0x330330)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT4CCW,0);
-         else if (global_livemask == 0x858858)
+         else if (e.m_global_livemask == 0x858858)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT5CW,0);
-         else if (global_livemask == 0x846846)
+         else if (e.m_global_livemask == 0x846846)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT5CCW,0);
       }
       else if (ss->kind == sbigh) {
-         if (global_livemask == 0xCF3)
+         if (e.m_global_livemask == 0xCF3)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT6CW,0);
-         else if (global_livemask == 0xF3C)
+         else if (e.m_global_livemask == 0xF3C)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT6CCW,0);
       }
       else if (ss->kind == sdeepxwv) {
-         if (global_livemask == 0xCF3)
+         if (e.m_global_livemask == 0xCF3)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT7CW,0);
-         else if (global_livemask == 0x3CF)
+         else if (e.m_global_livemask == 0x3CF)
             map_code = MAPCODE(s2x2,2,MPKIND__BENT7CCW,0);
       }
    }
    else if (!(arg1 & 8)) {
       //Bent C/L/W's.
       if (ss->kind == s3x6) {
-         if (global_livemask == 0x2170B)
+         if (e.m_global_livemask == 0x2170B)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT2CW,0);
-         else if (global_livemask == 0x26934)
+         else if (e.m_global_livemask == 0x26934)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT2CCW,0);
-         else if (global_livemask == 0x0B259)
+         else if (e.m_global_livemask == 0x0B259)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT3CW,0);
-         else if (global_livemask == 0x0CC66)
+         else if (e.m_global_livemask == 0x0CC66)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT3CCW,0);
       }
       else if (ss->kind == s4x6) {
-         if (global_livemask == 0x981981)
+         if (e.m_global_livemask == 0x981981)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT0CW,0);
-         else if (global_livemask == 0x660660)
+         else if (e.m_global_livemask == 0x660660)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT0CCW,0);
-         else if (global_livemask == 0xD08D08)
+         else if (e.m_global_livemask == 0xD08D08)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT1CW,0);
-         else if (global_livemask == 0x2C42C4)
+         else if (e.m_global_livemask == 0x2C42C4)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT1CCW,0);
-         else if (global_livemask == 0x303303)
+         else if (e.m_global_livemask == 0x303303)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT6CW,0);
-         else if (global_livemask == 0x330330)
+         else if (e.m_global_livemask == 0x330330)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT6CCW,0);
-         else if (global_livemask == 0x858858)
+         else if (e.m_global_livemask == 0x858858)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT7CW,0);
-         else if (global_livemask == 0x846846)
+         else if (e.m_global_livemask == 0x846846)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT7CCW,0);
       }
       else if (ss->kind == sbigh) {
-         if (global_livemask == 0xCF3)
+         if (e.m_global_livemask == 0xCF3)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT4CW,0);
-         else if (global_livemask == 0xF3C)
+         else if (e.m_global_livemask == 0xF3C)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT4CCW,0);
       }
       else if (ss->kind == sdeepxwv) {
-         if (global_livemask == 0xCF3)
+         if (e.m_global_livemask == 0xCF3)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT5CW,0);
-         else if (global_livemask == 0x3CF)
+         else if (e.m_global_livemask == 0x3CF)
             map_code = MAPCODE(s1x4,2,MPKIND__BENT5CCW,0);
       }
       else if (ss->kind == s4x4) {
-         if (global_livemask == 0x4B4B) {
+         if (e.m_global_livemask == 0x4B4B) {
             if (!((ss->people[0].id1 ^ ss->people[8].id1) & 1))
                fail("Setup must be unsymmetrical for this concept.");
             map_code = ((ss->people[0].id1 ^ arg1) & 1) ?
                MAPCODE(s2x4,1,MPKIND__BENT8NE,0) :
                MAPCODE(s2x4,1,MPKIND__BENT8SW,0);
          }
-         else if (global_livemask == 0xB4B4) {
+         else if (e.m_global_livemask == 0xB4B4) {
             if (!((ss->people[4].id1 ^ ss->people[12].id1) & 1))
                fail("Setup must be unsymmetrical for this concept.");
             map_code = ((ss->people[4].id1 ^ arg1) & 1) ?
@@ -2715,9 +2714,9 @@ static void do_concept_dblbent(
    else {
       // Double bent tidal C/L/W.
       if (ss->kind == sbigh) {
-         if (global_livemask == 0xCF3)
+         if (e.m_global_livemask == 0xCF3)
             map_code = MAPCODE(s1x8,1,MPKIND__BENT4CW,0);
-         else if (global_livemask == 0xF3C)
+         else if (e.m_global_livemask == 0xF3C)
             map_code = MAPCODE(s1x8,1,MPKIND__BENT4CCW,0);
       }
       else if (ss->kind == sbigptpd) {
@@ -2725,9 +2724,9 @@ static void do_concept_dblbent(
          // mechanism, with "override_selector", would be a better way.
          otherfolksptr = &otherfolks;
 
-         if (global_livemask == 0xF3C)
+         if (e.m_global_livemask == 0xF3C)
             map_code = MAPCODE(s1x6,1,MPKIND__BENT0CW,0);
-         else if (global_livemask == 0x3CF)
+         else if (e.m_global_livemask == 0x3CF)
             map_code = MAPCODE(s1x6,1,MPKIND__BENT0CCW,0);
       }
    }
@@ -3116,6 +3115,7 @@ static void do_concept_new_stretch(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    ss->clear_all_overcasts();
    uint32 maps;
    setup tempsetup = *ss;
@@ -3137,10 +3137,10 @@ static void do_concept_new_stretch(
 
    if (!(linesp & 16)) {
       if (linesp & 1) {
-         if (global_tbonetest & 1) fail("There is no line of 8 here.");
+         if (e.m_global_tbonetest & 1) fail("There is no line of 8 here.");
       }
       else {
-         if (global_tbonetest & 010) fail("There is no column of 8 here.");
+         if (e.m_global_tbonetest & 010) fail("There is no column of 8 here.");
       }
    }
 
@@ -3178,8 +3178,8 @@ static void do_concept_new_stretch(
       else if (next_parseptr->concept->kind == concept_do_phantom_2x4 &&
                next_parseptr->concept->arg3 == MPKIND__SPLIT &&
                !junk_concepts.test_for_any_herit_or_final_bit()) {
-         if (tempsetup.kind == s4x4 && ((global_tbonetest & 011) != 011)) {
-            if ((global_tbonetest ^ next_parseptr->concept->arg2) & 1) {
+         if (tempsetup.kind == s4x4 && ((e.m_global_tbonetest & 011) != 011)) {
+            if ((e.m_global_tbonetest ^ next_parseptr->concept->arg2) & 1) {
                tempsetup.swap_people(1, 2);
                tempsetup.swap_people(3, 7);
                tempsetup.swap_people(15, 11);
@@ -3810,6 +3810,7 @@ static void do_concept_phan_crazy(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (process_brute_force_mxn(ss, parseptr, do_concept_phan_crazy, result)) return;
 
    int i;
@@ -3864,10 +3865,10 @@ static void do_concept_phan_crazy(
    if ((parseptr->concept->arg1 & 7) < 4) {
       // This is {crazy phantom / crazy offset} C/L/W.  64 bit tells which.
 
-      if ((global_tbonetest & 011) == 011) fail("People are T-boned -- try using 'standard'.");
+      if ((e.m_global_tbonetest & 011) == 011) fail("People are T-boned -- try using 'standard'.");
 
       if (tempsetup.kind == s4x4) {
-         rot = (global_tbonetest ^ parseptr->concept->arg1) & 1;
+         rot = (e.m_global_tbonetest ^ parseptr->concept->arg1) & 1;
       }
       else
          kk = s2x8;
@@ -3877,7 +3878,7 @@ static void do_concept_phan_crazy(
       // divided setup -- that test would fail.  Also, we do not allow "waves"; only "lines" or
       // "columns".
 
-      if ((orig_tbonetest & 011) == 011) {
+      if ((e.m_orig_tbonetest & 011) == 011) {
          tempsetup.cmd.cmd_misc_flags &= ~CMD_MISC__VERIFY_MASK;
          if ((parseptr->concept->arg1 & 7) == 3)
             fail("Don't use 'crazy waves' with standard; use 'crazy lines'.");
@@ -3914,7 +3915,7 @@ static void do_concept_phan_crazy(
          else {
             // We do an incredibly simple test of which way the 4x4 is oriented.
             // A rigorous test of the exact occupation will be made later.
-            rot = ((global_livemask == 0x3A3A) || (global_livemask == 0xC5C5)) ?
+            rot = ((e.m_global_livemask == 0x3A3A) || (e.m_global_livemask == 0xC5C5)) ?
                1 : 0;
             offsetmapcode = MAPCODE(s2x2,4,MPKIND__OFFS_BOTH_SINGLEV,0);
          }
@@ -4045,8 +4046,9 @@ void nose_move(
    direction_kind where,
    setup *result) THROW_DECL
 {
-   selector_kind saved_selector = current_options.who;
-   current_options.who = who;
+   engine_context & e = *current_engine;
+   selector_kind saved_selector = e.m_current_options.who;
+   e.m_current_options.who = who;
 
    int n = attr::slimit(ss);
    if (n < 0) fail("Sorry, can't do nose starting in this setup.");
@@ -4089,7 +4091,7 @@ void nose_move(
       }
    }
 
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 
    update_id_bits(ss);
    move(ss, false, result);
@@ -4118,6 +4120,7 @@ void stable_move(
    selector_kind who,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (ss->kind == nothing) {   // Dust to dust.
       clear_result_flags(result);
       result->kind = nothing;
@@ -4129,8 +4132,8 @@ void stable_move(
 
    howfar <<= 1;    // Calibrated in eighths.
 
-   selector_kind saved_selector = current_options.who;
-   current_options.who = who;
+   selector_kind saved_selector = e.m_current_options.who;
+   e.m_current_options.who = who;
 
    int n = attr::slimit(ss);
    if (n < 0) fail("Sorry, can't do stable starting in this setup.");
@@ -4152,7 +4155,7 @@ void stable_move(
       }
    }
 
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 
    int orig_rotation = ss->rotation;
    move(ss, false, result);
@@ -4208,6 +4211,7 @@ static void do_concept_paranoid(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (process_brute_force_mxn(ss, parseptr, do_concept_paranoid, result)) return;
 
    if (ss->cmd.cmd_final_flags.test_for_any_herit_or_final_bit())
@@ -4220,8 +4224,8 @@ static void do_concept_paranoid(
    update_id_bits(result);
    int sizem1 = attr::slimit(result);
 
-   selector_kind saved_selector = current_options.who;
-   current_options.who = parseptr->options.who;
+   selector_kind saved_selector = e.m_current_options.who;
+   e.m_current_options.who = parseptr->options.who;
 
    for (int i=0; i<=sizem1; i++) {
       if (result->people[i].id1) {
@@ -4230,7 +4234,7 @@ static void do_concept_paranoid(
       }
    }
 
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 }
 
 
@@ -4321,6 +4325,7 @@ static void do_concept_checkerboard(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    // arg1 = setup (1x4/2x2/dmd)
    // arg2 = 0 : checkersetup
    //        1 : shadow setup
@@ -4413,15 +4418,15 @@ static void do_concept_checkerboard(
       // This is "so-and-so preferred for the trade, checkerboard".
       if (ss->kind != s2x4) fail("Must have a 2x4 setup for 'checker' concept.");
 
-      if      (global_selectmask == 0x55)
+      if      (e.m_global_selectmask == 0x55)
          offset = 0;
-      else if (global_selectmask == 0xAA)
+      else if (e.m_global_selectmask == 0xAA)
          offset = 1;
-      else if (global_selectmask == 0x33)
+      else if (e.m_global_selectmask == 0x33)
          offset = 2;
-      else if (global_selectmask == 0xCC)
+      else if (e.m_global_selectmask == 0xCC)
          offset = 3;
-      else if (global_selectmask == 0x99)
+      else if (e.m_global_selectmask == 0x99)
          offset = 4;
       else fail("Can't select these people.");
    }
@@ -5350,12 +5355,13 @@ static void do_concept_move_in_and(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    int rotfix = 0;
    int eighthrot = 0;
    calldef_schema the_schema = schema_concentric;
 
-   if (ss->kind == s_alamo && global_livemask == 0xFF) {
-      switch (global_selectmask) {
+   if (ss->kind == s_alamo && e.m_global_livemask == 0xFF) {
+      switch (e.m_global_selectmask) {
       case 0x99:
          rotfix--;
          ss->rotation++;
@@ -5395,8 +5401,8 @@ static void do_concept_move_in_and(
       ss->swap_people(0, 1);
       ss->kind = s2x4;
    }
-   else if (ss->kind == s4x4 && global_livemask == 0x6666) {
-      switch (global_selectmask) {
+   else if (ss->kind == s4x4 && e.m_global_livemask == 0x6666) {
+      switch (e.m_global_selectmask) {
       case 0x2424:
          rotfix--;
          ss->rotation++;
@@ -5435,7 +5441,7 @@ static void do_concept_move_in_and(
       ss->swap_people(2, 14);
       ss->kind = s2x4;
    }
-   else if (ss->kind == s_spindle && global_livemask == 0xFF && global_selectmask == 0x88) {
+   else if (ss->kind == s_spindle && e.m_global_livemask == 0xFF && e.m_global_selectmask == 0x88) {
       ss->kind = s_323;   // That's all!
       the_schema = schema_concentric_2_6;
    }
@@ -5532,6 +5538,7 @@ static void do_concept_inner_outer(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    uint32 livemask;
    calldef_schema sch;
    int rot = 0;
@@ -5559,10 +5566,10 @@ static void do_concept_inner_outer(
       // Center triple line/wave/column.
       switch (ss->kind) {
       case s3x4: case s1x12:
-         if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+         if ((e.m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
-         if (!((arg1 ^ global_tbonetest) & 1)) {
-            if (global_tbonetest & 1) fail("There are no triple lines here.");
+         if (!((arg1 ^ e.m_global_tbonetest) & 1)) {
+            if (e.m_global_tbonetest & 1) fail("There are no triple lines here.");
             else                      fail("There are no triple columns here.");
          }
          goto ready;
@@ -5575,10 +5582,10 @@ static void do_concept_inner_outer(
       // Outside triple lines/waves/columns.
       switch (ss->kind) {
       case s3x4: case s1x12:
-         if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+         if ((e.m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
-         if (!((arg1 ^ global_tbonetest) & 1)) {
-            if (global_tbonetest & 1) fail("There are no triple lines here.");
+         if (!((arg1 ^ e.m_global_tbonetest) & 1)) {
+            if (e.m_global_tbonetest & 1) fail("There are no triple lines here.");
             else                      fail("There are no triple columns here.");
          }
          goto ready;
@@ -5592,10 +5599,10 @@ static void do_concept_inner_outer(
       // Center/outside triple twin lines/waves/columns.
       if (ss->kind != s4x6) fail("Need a 4x6 setup for this.");
 
-      if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+      if ((e.m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
-      if ((arg1 ^ global_tbonetest) & 1) {
-         if (global_tbonetest & 1) fail("There are no triple twin lines here.");
+      if ((arg1 ^ e.m_global_tbonetest) & 1) {
+         if (e.m_global_tbonetest & 1) fail("There are no triple twin lines here.");
          else                      fail("There are no triple twin columns here.");
       }
 
@@ -5614,10 +5621,10 @@ static void do_concept_inner_outer(
       // Center/outside triple twin lines/waves/columns of 3.
       if (ss->kind != s3x6) fail("Need a 3x6 setup for this.");
 
-      if ((global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
+      if ((e.m_global_tbonetest & 011) == 011) fail("Can't do this from T-bone setup.");
 
-      if ((arg1 ^ global_tbonetest) & 1) {
-         if (global_tbonetest & 1) fail("There are no triple twin lines of 3 here.");
+      if ((arg1 ^ e.m_global_tbonetest) & 1) {
+         if (e.m_global_tbonetest & 1) fail("There are no triple twin lines of 3 here.");
          else                      fail("There are no triple twin columns of 3here.");
       }
 
@@ -5627,7 +5634,7 @@ static void do_concept_inner_outer(
       // Center or outside phantom lines/waves/columns.
 
       if (ss->kind == s4x4) {
-         uint32 tbone = global_tbonetest;
+         uint32 tbone = e.m_global_tbonetest;
          // If everyone is consistent (or "standard" was used
          // to make it appear so), it's easy.
          if ((tbone & 011) == 011) {
@@ -5904,6 +5911,7 @@ static void do_concept_do_each_1x4(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    uint32 map_code;
    uint32 tbonetest_fixer = 0;
    int rot = 0;
@@ -5920,22 +5928,22 @@ static void do_concept_do_each_1x4(
       switch (ss->kind) {
          case s2x4: break;
          case s3x4:
-            if (global_livemask == 0xCF3) {
+            if (e.m_global_livemask == 0xCF3) {
                map_code = MAPCODE(s2x2,2,MPKIND__OFFS_R_HALF, 0);
                goto split_big;
             }
-            else if (global_livemask == 0xF3C) {
+            else if (e.m_global_livemask == 0xF3C) {
                map_code = MAPCODE(s2x2,2,MPKIND__OFFS_L_HALF, 0);
                goto split_big;
             }
             fail("Need boxes for this concept.");
             break;
          case s4x4:
-            if (global_livemask == 0xB4B4) {
+            if (e.m_global_livemask == 0xB4B4) {
                map_code = MAPCODE(s2x2,2,MPKIND__OFFS_R_FULL, 1);
                goto split_big;
             }
-            else if (global_livemask == 0x4B4B) {
+            else if (e.m_global_livemask == 0x4B4B) {
                map_code = MAPCODE(s2x2,2,MPKIND__OFFS_L_FULL, 1);
                goto split_big;
             }
@@ -5951,12 +5959,12 @@ static void do_concept_do_each_1x4(
       case s2x4: case s1x8:
          goto split_small;
       case s4x4:
-         if (global_livemask == 0x857A || global_livemask == 0x7A85 || global_livemask == 0x7171) {
+         if (e.m_global_livemask == 0x857A || e.m_global_livemask == 0x7A85 || e.m_global_livemask == 0x7171) {
             map_code = MAPCODE(s1x4,4,MPKIND__SPLIT,1);
             goto split_big;
          }
 
-         else if (global_livemask == 0xA857 || global_livemask == 0x57A8 || global_livemask == 0x1717) {
+         else if (e.m_global_livemask == 0xA857 || e.m_global_livemask == 0x57A8 || e.m_global_livemask == 0x1717) {
             map_code = MAPCODE(s1x4,4,MPKIND__SPLIT,1);
             rot = 1;
             tbonetest_fixer = 0xFFFF;
@@ -5970,33 +5978,33 @@ static void do_concept_do_each_1x4(
          tbonetest_fixer = 0xF;
          goto split_big;
       case s3x4:
-         if (global_livemask == 01717) {
+         if (e.m_global_livemask == 01717) {
             map_code = MAPCODE(s1x4,3,MPKIND__SPLIT,1);
             goto split_big;
          }
          break;
       case s2x6:
-         if (global_livemask == 07474) {
+         if (e.m_global_livemask == 07474) {
             map_code = MAPCODE(s1x4,2,MPKIND__OFFS_R_HALF,1);
             goto split_big;
          }
-         else if (global_livemask == 01717) {
+         else if (e.m_global_livemask == 01717) {
             map_code = MAPCODE(s1x4,2,MPKIND__OFFS_L_HALF,1);
             goto split_big;
          }
          break;
       case s2x8:
-         if (global_livemask == 0xF0F0) {
+         if (e.m_global_livemask == 0xF0F0) {
             map_code = MAPCODE(s1x4,2,MPKIND__OFFS_R_FULL,1);
             goto split_big;
          }
-         else if (global_livemask == 0x0F0F) {
+         else if (e.m_global_livemask == 0x0F0F) {
             map_code = MAPCODE(s1x4,2,MPKIND__OFFS_L_FULL,1);
             goto split_big;
          }
          break;
       case s1x10:
-         if (global_livemask == 0x1EF) {
+         if (e.m_global_livemask == 0x1EF) {
             map_code = spcmap_d1x10;
             goto split_big;
          }
@@ -6008,7 +6016,7 @@ static void do_concept_do_each_1x4(
 
    split_small:
 
-   if (arg2 == 0 && arg1 != 0 && ((arg1 ^ global_tbonetest) & 1) == 0)
+   if (arg2 == 0 && arg1 != 0 && ((arg1 ^ e.m_global_tbonetest) & 1) == 0)
       fail("People are not in the required line, column or wave.");
 
    do_simple_split(ss, (arg2 != 2) ? split_command_1x4 : split_command_none, result);
@@ -6018,15 +6026,15 @@ static void do_concept_do_each_1x4(
 
    // May need to fudge the global_tbonetest value to deal with non-straightforward setups.
    if (tbonetest_fixer != 0) {
-      global_tbonetest = 0;
+      e.m_global_tbonetest = 0;
       for (int i=0; i<=attr::slimit(ss); i++, tbonetest_fixer>>=1) {
          uint32 p = ss->people[i].id1;
          if (p)
-            global_tbonetest |= p ^ tbonetest_fixer;
+            e.m_global_tbonetest |= p ^ tbonetest_fixer;
       }
    }
 
-   if (arg2 == 0 && arg1 != 0 && ((arg1 ^ global_tbonetest) & 1) == 0)
+   if (arg2 == 0 && arg1 != 0 && ((arg1 ^ e.m_global_tbonetest) & 1) == 0)
       fail("People are not in the required line, column or wave.");
 
    ss->rotation += rot;   // Just flip the setup around and recanonicalize.
@@ -6302,7 +6310,7 @@ static void do_concept_ferris(
       static const expand::thing mapf1 = {{0, 1, 5, 4, 6, 7, 11, 10}, s2x4, s3x4, 0};
       static const expand::thing mapf2 = {{10, 11, 2, 3, 4, 5, 8, 9}, s2x4, s3x4, 0};
 
-      if ((ss->kind != s2x4) || ((global_tbonetest & 1) != 0))
+      if ((ss->kind != s2x4) || ((current_engine->m_global_tbonetest & 1) != 0))
          fail("Must have lines to do this concept.");
 
       bool retvaljunk;
@@ -8579,6 +8587,7 @@ static void do_concept_so_and_so_begin(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    selector_kind saved_selector;
    int i;
    setup setup1, setup2;
@@ -8605,8 +8614,8 @@ static void do_concept_so_and_so_begin(
    // At this point we know that we will do stuff including the first part,
    // which is the part that requires special action.
 
-   saved_selector = current_options.who;
-   current_options.who = parseptr->options.who;
+   saved_selector = e.m_current_options.who;
+   e.m_current_options.who = parseptr->options.who;
 
    setup1 = *ss;              /* designees */
    setup2 = *ss;              /* non-designees */
@@ -8621,7 +8630,7 @@ static void do_concept_so_and_so_begin(
       }
    }
 
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 
    normalize_setup(&setup1, plain_normalize, false);
    normalize_setup(&setup2, plain_normalize, false);
@@ -8918,6 +8927,7 @@ extern bool do_big_concept(
    bool handle_concept_details,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    remove_z_distortion(ss);
 
    void (*concept_func)(setup *, parse_block *, setup *);
@@ -9116,9 +9126,9 @@ extern bool do_big_concept(
       if (!stdtest) fail("No one is standard.");
       if ((stdtest & 011) == 011) fail("The standard people are not facing consistently.");
 
-      global_tbonetest = stdtest;
-      global_livemask = livemask;
-      orig_tbonetest = tbonetest;
+      e.m_global_tbonetest = stdtest;
+      e.m_global_livemask = livemask;
+      e.m_orig_tbonetest = tbonetest;
 
       ss->cmd.parseptr = substandard_concptptr->next;
       (sub_table_item->concept_action) (ss, substandard_concptptr, result);
@@ -9176,36 +9186,36 @@ extern bool do_big_concept(
       int i;
       uint32 j;
       bool doing_select;
-      selector_kind saved_selector = current_options.who;
+      selector_kind saved_selector = e.m_current_options.who;
 
       if (attr::slimit(ss) < 0) fail("Can't do this concept in this setup.");
 
-      global_tbonetest = 0;
-      global_livemask = 0;
-      global_selectmask = 0;
-      global_tboneselect = 0;
+      e.m_global_tbonetest = 0;
+      e.m_global_livemask = 0;
+      e.m_global_selectmask = 0;
+      e.m_global_tboneselect = 0;
       doing_select = (prop_bits & CONCPROP__USE_SELECTOR) != 0;
 
       if (doing_select) {
-         current_options.who = this_concept_parse_block->options.who;
+         e.m_current_options.who = this_concept_parse_block->options.who;
       }
 
       for (i=0, j=1; i<=attr::slimit(ss); i++, j<<=1) {
          uint32 p = ss->people[i].id1;
-         global_tbonetest |= p;
+         e.m_global_tbonetest |= p;
          if (p) {
-            global_livemask |= j;
+            e.m_global_livemask |= j;
             if (doing_select && selectp(ss, i)) {
-               global_selectmask |= j; global_tboneselect |= p;
+               e.m_global_selectmask |= j; e.m_global_tboneselect |= p;
             }
          }
       }
 
-      current_options.who = saved_selector;
+      e.m_current_options.who = saved_selector;
 
-      orig_tbonetest = global_tbonetest;
+      e.m_orig_tbonetest = e.m_global_tbonetest;
 
-      if (!global_tbonetest) {
+      if (!e.m_global_tbonetest) {
          result->kind = nothing;
          clear_result_flags(result);
          return true;
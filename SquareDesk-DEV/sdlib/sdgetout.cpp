@@ -46,13 +46,26 @@
    nice_setup_command_ok
    create_resolve_menu_title
    initialize_getout_tables
+   delete_resolver_state
+   getout_table_filename
+   load_getout_table
+   begin_getout_table
+   random_call_from_setup
+   add_getouts_from_setup
+   write_getout_table
 */
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include "sdui.h"
 #include "sd.h"
+#include "paths.h"
+#include "sort.h"
 
 
 struct resolve_rec {
@@ -62,6 +75,7 @@ struct resolve_rec {
    int insertion_width;
    personrec permutepersoninfo[8];
    int rotchange;
+   int hash;                  // The "hashed_randoms" of the search that found it.
 };
 
 
@@ -84,21 +98,140 @@ static const reconcile_descriptor crossplus = {{5, 4, 3, 2, 1, 0, 7, 6}, false};
 static const reconcile_descriptor laperm =    {{1, 7, 6, 4, 5, 3, 2, 0}, false};
 
 
-static configuration *huge_history_save = (configuration *) 0;
-static int huge_history_allocation = 0;
-static int huge_history_ptr;
+// A search spread over several worker engines, each on a thread of its own (see
+// parallel_search below).  The workers don't change anything else that they share.
 
-static resolve_rec *all_resolves = (resolve_rec *) 0;
-static int resolve_allocation = 0;
+struct shared_search {
+   // Where the workers start.  This is the master engine's resolver state, which
+   // doesn't change while they run.
+   const configuration *start_history;
+   int start_history_allocation;
+   int start_history_ptr;
+   const int *start_avoid_list;
+   int start_avoid_list_size;
+   const uint32 *start_perm_array;
+   const reconcile_descriptor *start_reconciler;
+
+   std::atomic<bool> stop;    // Set when the search is over, one way or another.
+   std::chrono::steady_clock::time_point deadline;
+
+   std::mutex lock;           // For the rest of this.
+   resolve_rec *found;        // Room for one from each worker.
+   int found_count;
+
+   bool offer(const resolve_rec & r);
+};
+
+
+enum {
+   TRANSPOSITION_SETS = 1024,   // A setup and call can go into any of the TRANSPOSITION_WAYS
+   TRANSPOSITION_WAYS = 4,      // slots of one set.  The least recently used one gets replaced.
+   TRANSPOSITION_TREE_ROOM = 12 // Calls with bigger parse trees than this aren't remembered.
+};
+
+
+// One entry in the transposition table.  A search does the same call from the same
+// setup over and over, so we remember what happened.  See cached_toplevelmove.
+
+struct transposition {
+   uint64_t setup_key;          // hash_setup of the starting setup.
+   setup start;                 // The starting setup itself, to check a hit against.
+   uint64_t call_key;           // The parse tree, and the search mode.
+   parse_tree_item call[TRANSPOSITION_TREE_ROOM];  // The parse tree itself, to check a hit against.
+   int call_size;
+   warning_info prior_warnings; // Warnings that were already there, from choosing the call.
+   uint64_t last_use;           // Zero if the slot is empty.
+   bool failed;
+   error_flag_type error;       // What it threw, if it failed.
+   configuration result;        // What it left in next_config, if it didn't.
+
+   // What it left behind outside of next_config, either way.
+   call_conc_option_state options_after;  // current_options
+   uint32 topcallflags_after;             // parse_state.topcallflags1
+   call_list_kind call_list_after;        // parse_state.call_list_to_use
+};
+
+
+// The resolver's working storage.  Each engine has its own, made the first
+// time that engine resolves.
+
+struct resolver_state {
+   configuration *huge_history_save;
+   int huge_history_allocation;
+   int huge_history_ptr;
+
+   resolve_rec *all_resolves;
+   int resolve_allocation;
+
+   int *avoid_list;
+   int avoid_list_size;
+   int avoid_list_allocation;
+   uint32 perm_array[8];
+   setup_kind goal_kind;
+   int goal_rotation;
+   uint32 goal_directions[8];
+   const reconcile_descriptor *current_reconciler;
+
+   // These are actually local to inner_search, but they are
+   // expected to be preserved across the throw.
+
+   int perm_indices[8];
+   int hashed_random_list[5];
+   parse_block *inner_parse_mark, *outer_parse_mark;
+   int history_insertion_point;    // Where our resolve should lie in the history.
+                                   // This is normally the end of the history, but
+                                   // may be earlier if doing a reconcile.  We clobber
+                                   // everything in the given history past this point.
+   int history_save;               // Where we are inserting calls now.  This moves
+                                   // forward as we build multiple-call resolves.
+
+#ifdef EXCESSIVE_RECONCILE_FIXUP
+   uint32 global_status;    // Yeah, it's sleazy keeping this here.
+#endif
+
+   // Resolves that the workers in a parallel search found beyond the one that was
+   // asked for.  "Find another" takes them from here before searching again.
+   resolve_rec *banked_resolves;
+   int banked_count;
+   int banked_allocation;
+
+   // Nonzero if this engine is a worker in a parallel search.
+   shared_search *sharing;
+
+   // Made the first time it is needed, and emptied at the start of each resolve.
+   transposition *transpositions;
+   uint64_t transposition_clock;
+
+   // For "-resolve_statistics".  These cover all the searches since the resolve began.
+   uint64_t tries;
+   uint64_t lookups;
+   uint64_t hits;
+   double seconds;
+};
+
+
+extern void delete_resolver_state(resolver_state *rs)
+{
+   if (!rs) return;
+   delete [] rs->huge_history_save;
+   delete [] rs->all_resolves;
+   delete [] rs->avoid_list;
+   delete [] rs->banked_resolves;
+   delete [] rs->transpositions;
+   delete rs;
+}
+
+
+static inline resolver_state & the_resolver()
+{
+   engine_context *e = current_engine;
+
+   if (!e->m_resolver)
+      e->m_resolver = new resolver_state();   // All zero.
+
+   return *e->m_resolver;
+}
 
-static int *avoid_list = (int *) 0;
-static int avoid_list_size;
-static int avoid_list_allocation = 0;
-static uint32 perm_array[8];
-static setup_kind goal_kind;
-static int goal_rotation;
-static uint32 goal_directions[8];
-static const reconcile_descriptor *current_reconciler;
 
 // BEWARE!!  This must be keyed to the enumeration "command_kind" in sd.h .
 static Cstring title_string[] = {
@@ -782,12 +915,13 @@ static const resolve_tester test_hrgl_stuff[] = {
 
 void configuration::calculate_resolve()
 {
+   engine_context & e = *current_engine;
    const resolve_tester *testptr;
    int i;
    uint32 singer_offset = 0;
 
-   if (ui_options.singing_call_mode == 1) singer_offset = 0600;
-   else if (ui_options.singing_call_mode == 2) singer_offset = 0200;
+   if (e.m_ui_options.singing_call_mode == 1) singer_offset = 0600;
+   else if (e.m_ui_options.singing_call_mode == 2) singer_offset = 0200;
 
    switch (state.kind) {
    case s2x4:
@@ -859,7 +993,7 @@ void configuration::calculate_resolve()
       }
 
       if (calling_level < (dance_level) testptr->level_needed ||
-          (testptr->k == resolve_minigrand && !allowing_minigrand)) goto not_this_one;
+          (testptr->k == resolve_minigrand && !e.m_allowing_minigrand)) goto not_this_one;
 
       resolve_flag.the_item = testptr;
       resolve_flag.distance =
@@ -873,7 +1007,7 @@ void configuration::calculate_resolve()
           !((++testptr)->distance & 0x10) ||
           // Even if it has the mark, do it if this is a singer
           // and it isn't really the end of the table.
-          (ui_options.singing_call_mode != 0 && testptr->k != resolve_none));
+          (e.m_ui_options.singing_call_mode != 0 && testptr->k != resolve_none));
 
    // Too bad.
 
@@ -895,6 +1029,7 @@ void ui_utils::write_aproximately()
 // This assumes that "sequence_is_resolved" passes.
 void ui_utils::write_resolve_text(bool doing_file)
 {
+   engine_context & e = *current_engine;
    resolve_indicator & r = configuration::current_resolve();
    int distance = r.distance;
    resolve_kind index = r.the_item->k;
@@ -904,7 +1039,7 @@ void ui_utils::write_resolve_text(bool doing_file)
 
    distance &= 7;
 
-   if (doing_file && !ui_options.singlespace_mode) doublespace_file();
+   if (doing_file && !e.m_ui_options.singlespace_mode) doublespace_file();
 
    if (index == resolve_circle || index == resolve_circle_from_facing_lines) {
       if (distance == 0) {
@@ -934,7 +1069,7 @@ void ui_utils::write_resolve_text(bool doing_file)
       // In a singer, "pass thru, allemande left", "trade by, allemande left", or
       // "cross by, allemande left" can be just "swing and promenade".
 
-      if (ui_options.singing_call_mode != 0) {
+      if (e.m_ui_options.singing_call_mode != 0) {
          if (index == resolve_pth_la ||
              index == resolve_tby_la ||
              index == resolve_xby_la) {
@@ -951,13 +1086,13 @@ void ui_utils::write_resolve_text(bool doing_file)
          writestuff(resolve_first_parts[first]);
          if (doing_file) {
             newline();
-            if (!ui_options.singlespace_mode) doublespace_file();
+            if (!e.m_ui_options.singlespace_mode) doublespace_file();
          }
          else
             writestuff(", ");
       }
 
-      if (ui_options.singing_call_mode != 0 && mainpart == main_part_rlg) {
+      if (e.m_ui_options.singing_call_mode != 0 && mainpart == main_part_rlg) {
          mainpart = main_part_swing;
          distance ^= 4;
       }
@@ -977,7 +1112,7 @@ void ui_utils::write_resolve_text(bool doing_file)
          writestuff(" promenade");
       }
 
-      if (allow_bend_home_getout) {
+      if (e.m_allow_bend_home_getout) {
          if ((mainpart == main_part_prom || mainpart == main_part_revprom) &&
              (configuration::current_config().state.kind == s2x4 || distance == 0) &&
              !(configuration::current_config().state.result_flags.misc & RESULTFLAG__IMPRECISE_ROT)) {
@@ -993,64 +1128,895 @@ void ui_utils::write_resolve_text(bool doing_file)
 
 
 
-// These variables are actually local to inner_search, but they are
-// expected to be preserved across the throw, so they must be static.
+// Remember that we have shown this resolve, so we won't come up with it again.
 
-static int perm_indices[8];
-static int hashed_random_list[5];
-static parse_block *inner_parse_mark, *outer_parse_mark;
-static int history_insertion_point;    // Where our resolve should lie in the history.
-                                       // This is normally the end of the history, but
-                                       // may be earlier if doing a reconcile.  We clobber
-                                       // everything in the given history past this point.
-static int history_save;               // Where we are inserting calls now.  This moves
-                                       // forward as we build multiple-call resolves.
+static void avoid_in_future(int hash)
+{
+   resolver_state & rs = the_resolver();
+   // Grow the "avoid_list" array as needed.
+
+   if (rs.avoid_list_allocation <= rs.avoid_list_size) {
+      int new_allocation = rs.avoid_list_size*2+5;
+      int *new_list = new int[new_allocation];
+      memcpy(new_list, rs.avoid_list, rs.avoid_list_allocation * sizeof(int));
+      delete [] rs.avoid_list;
+      rs.avoid_list = new_list;
+      rs.avoid_list_allocation = new_allocation;
+   }
+
+   rs.avoid_list[rs.avoid_list_size++] = hash;
+}
+
+
+static void bank_resolve(const resolve_rec & r)
+{
+   resolver_state & rs = the_resolver();
+   if (rs.banked_allocation <= rs.banked_count) {
+      int new_allocation = rs.banked_count*2+5;
+      resolve_rec *new_list = new resolve_rec[new_allocation];
+      memcpy(new_list, rs.banked_resolves, rs.banked_allocation * sizeof(resolve_rec));
+      delete [] rs.banked_resolves;
+      rs.banked_resolves = new_list;
+      rs.banked_allocation = new_allocation;
+   }
+
+   rs.banked_resolves[rs.banked_count++] = r;
+}
+
+
+// Get a resolve that a parallel search found earlier, if there is one that we
+// haven't shown and that goes at the place we are now reconciling at.
+
+static bool take_banked_resolve(resolve_rec *new_resolve,
+                                int insertion_depth,
+                                int insertion_width)
+{
+   resolver_state & rs = the_resolver();
+   while (rs.banked_count > 0) {
+      const resolve_rec & r = rs.banked_resolves[--rs.banked_count];
+
+      if (r.insertion_point != insertion_depth || r.insertion_width != insertion_width)
+         continue;
+
+      int i;
+      for (i=0; i<rs.avoid_list_size; i++) {
+         if (r.hash == rs.avoid_list[i]) break;
+      }
+
+      if (i < rs.avoid_list_size) continue;
+
+      *new_resolve = r;
+      avoid_in_future(r.hash);
+      return true;
+   }
+
+   return false;
+}
+
+
+// The getout table that mkgetouts makes for each level.  It lists a few getouts,
+// shortest first, from each of a great many setups, so that a plain "resolve" can
+// often find something without searching at all.  Each level's table is read the first
+// time a session opens at that level, and all the engines share it, since it never
+// changes after that.  The file is little-endian, whatever machine made it.
+
+enum {
+   GETOUT_TABLE_MAGIC = 0x54474453,      // "SDGT" in the file.
+   GETOUT_TABLE_VERSION = 1,
+   GETOUT_HEADER_WORDS = 8,
+   GETOUT_CODE_NONE = 0xFFFFFFFFU,       // A null concept or call.
+   GETOUT_CODE_SPECIAL = 0x80000000U,    // A concept in special_getout_concepts.
+   GETOUT_WORDS_PER_BLOCK = 12           // See encode_parse_tree.
+};
+
+struct getout_entry {
+   uint64_t key;      // getout_key of the setup.
+   uint32 first;      // Its getouts in "offsets".
+   uint32 count;
+};
+
+struct getout_table_type {
+   getout_entry *entries;    // In order of key.
+   uint32 entry_count;
+   uint32 entry_allocation;
+   uint32 *offsets;          // Where each getout starts in "codes".  There is one
+   uint32 getout_count;      // more of these than there are getouts, to show
+   uint32 getout_allocation; // where the last one ends.
+   uint32 *codes;            // The number of calls, and then their parse trees.
+   uint32 code_count;
+   uint32 code_allocation;
+};
+
+static getout_table_type getout_table;   // All zero.
+
+
+// The tables of the other levels that we have loaded, so that going back to one of
+// them doesn't read the file again.  The current level's table is in getout_table.
+
+struct loaded_getout_table {
+   bool tried;               // We looked for the file, whether or not it was there.
+   uint64_t checksum;        // The getout_table_checksum that it was loaded with.
+   getout_table_type table;
+};
+
+static loaded_getout_table loaded_getout_tables[l_nonexistent_concept];   // All zero.
+static int getout_table_level = -1;      // Whose table is in getout_table.
+
+
+class GETOUT_ENTRY_COMPARE {
+ public:
+   // Entries for the same setup go in the order they were added ("first" only
+   // ever grows), so that heapsort, which isn't stable, always keeps the same one.
+   static bool inorder(const getout_entry & a, const getout_entry & b)
+      { return a.key < b.key || (a.key == b.key && a.first < b.first); }
+};
+
+
+// Concepts that parse trees point to, but that aren't in concept_descriptor_table.
+
+static const concept_descriptor *const special_getout_concepts[] = {
+   &concept_mark_end_of_list,
+   &concept_marker_decline,
+   &concept_marker_concept_mod,
+   &concept_marker_concept_supercall,
+   &concept_centers_concept,
+   &concept_heads_concept,
+   &concept_sides_concept,
+   &concept_special_magic,
+   &concept_special_interlocked,
+   &concept_special_piecewise,
+   &concept_special_z};
+
+
+template <class T> static void grow_getout_array(T *& array, uint32 & allocation, uint32 needed)
+{
+   if (allocation >= needed) return;
+
+   uint32 new_allocation = needed*2+5;
+   T *new_array = new T[new_allocation];
+   if (array) memcpy(new_array, array, allocation * sizeof(T));
+   delete [] array;
+   array = new_array;
+   allocation = new_allocation;
+}
+
+
+static uint32 getout_concept_count()
+{
+   uint32 i;
+   for (i=0; concept_descriptor_table[i].kind != marker_end_of_list; i++);
+   return i;
+}
+
+
+// Calls in a parse tree are written as a list number and an index in that list.
+// List 0 is the "any" menu, 1 is base_calls, 2 through 5 are the tagger classes,
+// and 6 is the circcers.
+
+enum { GETOUT_CALL_LISTS = 3+NUM_TAGGER_CLASSES };
+
+static call_with_name **getout_call_list(uint32 list, uint32 & size)
+{
+   if (list == 0) {
+      size = number_of_calls[call_list_any];
+      return main_call_lists[call_list_any];
+   }
+   else if (list == 1) {
+      size = max_base_calls;
+      return base_calls;
+   }
+   else if (list < 2+NUM_TAGGER_CLASSES) {
+      size = number_of_taggers[list-2];
+      return tagger_calls[list-2];
+   }
+   else {
+      size = number_of_circcers;
+      return circcer_calls;
+   }
+}
+
+
+// If the calls or concepts have changed since the table was made, its
+// indices don't mean anything.
+
+static uint64_t getout_table_checksum()
+{
+   uint64_t h = hash_step(getout_concept_count(), max_base_calls);
+
+   for (int i=0; i<number_of_calls[call_list_any]; i++) {
+      for (Cstring p = main_call_lists[call_list_any][i]->menu_name; *p; p++)
+         h = hash_step(h, (unsigned char) *p);
+      h = hash_step(h, 0);
+   }
+
+   for (int j=0; j<NUM_TAGGER_CLASSES; j++)
+      h = hash_step(h, number_of_taggers[j]);
+
+   return hash_step(h, number_of_circcers);
+}
+
+
+// What the table is looked up by: where everyone is, and which way they face.  Things
+// like roll direction aren't in it, but we do the calls again before we accept a getout
+// from the table, so a getout that doesn't work from this setup just gets passed over.
+
+static uint64_t getout_key(const setup *ss)
+{
+   uint64_t h = hash_step(ss->kind, ((uint64_t) ss->rotation << 8) | ss->eighth_rotation);
+
+   for (int i=0; i<=attr::slimit(ss); i++)
+      h = hash_step(h, ss->people[i].id1 & (PID_MASK|d_mask));
+
+   return h;
+}
+
+
+// Parse trees are written in preorder, GETOUT_WORDS_PER_BLOCK words for each block.
+// Returns false if the tree has something we can't write, in which case the caller
+// forgets about this getout.
+
+static bool encode_parse_tree(const parse_block *tree)
+{
+   for ( ; tree ; tree = tree->next) {
+      grow_getout_array(getout_table.codes, getout_table.code_allocation,
+                        getout_table.code_count+GETOUT_WORDS_PER_BLOCK);
+      uint32 *code = &getout_table.codes[getout_table.code_count];
+      uint32 i, size;
+
+      if (!tree->concept)
+         code[0] = GETOUT_CODE_NONE;
+      else if (tree->concept >= concept_descriptor_table &&
+               tree->concept < concept_descriptor_table + getout_concept_count())
+         code[0] = tree->concept - concept_descriptor_table;
+      else {
+         for (i=0; i<sizeof(special_getout_concepts)/sizeof(special_getout_concepts[0]); i++) {
+            if (tree->concept == special_getout_concepts[i]) break;
+         }
+
+         if (i == sizeof(special_getout_concepts)/sizeof(special_getout_concepts[0])) return false;
+         code[0] = GETOUT_CODE_SPECIAL | i;
+      }
+
+      // When these are different, something was in the middle of changing the tree.
+      if (tree->call_to_print != tree->call) return false;
+
+      code[1] = (tree->subsidiary_root ? 1 : 0) | (tree->next ? 2 : 0) | (tree->no_check_call_level ? 4 : 0);
+      code[2] = GETOUT_CODE_NONE;
+      code[3] = GETOUT_CODE_NONE;
+
+      if (tree->call) {
+         for (uint32 list=0; list<GETOUT_CALL_LISTS && code[2] == GETOUT_CODE_NONE; list++) {
+            call_with_name **calls = getout_call_list(list, size);
+
+            for (i=0; i<size; i++) {
+               if (calls[i] == tree->call) {
+                  code[2] = list;
+                  code[3] = i;
+                  break;
+               }
+            }
+         }
+
+         if (code[2] == GETOUT_CODE_NONE) return false;
+      }
+
+      code[4] = tree->options.who;
+      code[5] = tree->options.where;
+      code[6] = tree->options.tagger;
+      code[7] = tree->options.circcer;
+      code[8] = tree->options.number_fields;
+      code[9] = tree->options.howmanynumbers;
+      code[10] = tree->options.star_turn_option;
+      code[11] = (uint32) tree->replacement_key;
+      getout_table.code_count += GETOUT_WORDS_PER_BLOCK;
+
+      if (tree->subsidiary_root && !encode_parse_tree(tree->subsidiary_root)) return false;
+   }
+
+   return true;
+}
+
+
+// The reverse of the above.  The blocks come from get_parse_block.  Returns null if
+// the codes don't make sense; the caller releases whatever blocks we got.
+
+static parse_block *decode_parse_tree(const uint32 *& code, const uint32 *limit)
+{
+   parse_block *root = (parse_block *) 0;
+   parse_block **tail = &root;
+
+   for (;;) {
+      if (code+GETOUT_WORDS_PER_BLOCK > limit) return (parse_block *) 0;
+
+      parse_block *item = get_parse_block();
+      *tail = item;
+      uint32 size;
+
+      if (code[0] == GETOUT_CODE_NONE)
+         item->concept = (const concept_descriptor *) 0;
+      else if (code[0] & GETOUT_CODE_SPECIAL) {
+         if ((code[0] & ~GETOUT_CODE_SPECIAL) >= sizeof(special_getout_concepts)/sizeof(special_getout_concepts[0]))
+            return (parse_block *) 0;
+         item->concept = special_getout_concepts[code[0] & ~GETOUT_CODE_SPECIAL];
+      }
+      else if (code[0] < getout_concept_count())
+         item->concept = &concept_descriptor_table[code[0]];
+      else
+         return (parse_block *) 0;
+
+      if (code[2] != GETOUT_CODE_NONE) {
+         if (code[2] >= GETOUT_CALL_LISTS) return (parse_block *) 0;
+         call_with_name **calls = getout_call_list(code[2], size);
+         if (code[3] >= size || !calls[code[3]]) return (parse_block *) 0;
+         item->call = calls[code[3]];
+         item->call_to_print = item->call;
+      }
+
+      item->no_check_call_level = (code[1] & 4) != 0;
+      item->options.who = (selector_kind) code[4];
+      item->options.where = (direction_kind) code[5];
+      item->options.tagger = code[6];
+      item->options.circcer = code[7];
+      item->options.number_fields = code[8];
+      item->options.howmanynumbers = (int) code[9];
+      item->options.star_turn_option = (int) code[10];
+      item->replacement_key = (short int) code[11];
+
+      uint32 flags = code[1];
+      code += GETOUT_WORDS_PER_BLOCK;
+
+      if (flags & 1) {
+         item->subsidiary_root = decode_parse_tree(code, limit);
+         if (!item->subsidiary_root) return (parse_block *) 0;
+      }
+
+      if (!(flags & 2)) return root;
+      tail = &item->next;
+   }
+}
+
+
+static void clear_getout_table()
+{
+   delete [] getout_table.entries;
+   delete [] getout_table.offsets;
+   delete [] getout_table.codes;
+   memset(&getout_table, 0, sizeof(getout_table));
+}
+
+
+// The file is written a word at a time, low byte first.
+
+static bool write_getout_words(FILE *fp, const uint32 *words, uint32 count)
+{
+   unsigned char buffer[4096];
+   uint32 i = 0;
+
+   while (i < count) {
+      size_t n;
+
+      for (n=0; i<count && n<sizeof(buffer); i++, n+=4) {
+         buffer[n] = (unsigned char) words[i];
+         buffer[n+1] = (unsigned char) (words[i] >> 8);
+         buffer[n+2] = (unsigned char) (words[i] >> 16);
+         buffer[n+3] = (unsigned char) (words[i] >> 24);
+      }
+
+      if (fwrite(buffer, 1, n, fp) != n) return false;
+   }
+
+   return true;
+}
+
+
+static bool read_getout_words(FILE *fp, uint32 *words, uint32 count)
+{
+   if (fread(words, sizeof(uint32), count, fp) != count) return false;
+
+   for (uint32 i=0; i<count; i++) {
+      const unsigned char *b = (const unsigned char *) &words[i];
+      words[i] = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32) b[3] << 24);
+   }
+
+   return true;
+}
+
+
+// An entry is 4 words: the key, low half first, then "first" and "count".
+
+static bool write_getout_entries(FILE *fp, const getout_entry *entries, uint32 count)
+{
+   for (uint32 i=0; i<count; i++) {
+      uint32 words[4];
+      words[0] = (uint32) entries[i].key;
+      words[1] = (uint32) (entries[i].key >> 32);
+      words[2] = entries[i].first;
+      words[3] = entries[i].count;
+      if (!write_getout_words(fp, words, 4)) return false;
+   }
+
+   return true;
+}
+
+
+static bool read_getout_entries(FILE *fp, getout_entry *entries, uint32 count)
+{
+   for (uint32 i=0; i<count; i++) {
+      uint32 words[4];
+      if (!read_getout_words(fp, words, 4)) return false;
+      entries[i].key = words[0] | ((uint64_t) words[1] << 32);
+      entries[i].first = words[2];
+      entries[i].count = words[3];
+   }
+
+   return true;
+}
+
+
+extern void getout_table_filename(char *dest)
+{
+   // It goes in the same directory as the database.
+   const char *name_start = database_filename;
+
+   for (const char *p = database_filename; *p; p++) {
+      if (*p == '/' || *p == '\\' || *p == ':') name_start = p+1;
+   }
+
+   snprintf(dest, MAX_FILENAME_LENGTH, "%.*s%s_%s.dat",
+            (int) (name_start - database_filename), database_filename,
+            GETOUTS_FILENAME, getout_strings[calling_level]);
+}
+
+
+// Called from open_session, after the calls and menus are all set up.  If there is
+// no table for this level, or it was made for a different database, we just search.
+// A level whose file we have already read (or found missing) isn't read again.
+
+extern void load_getout_table()
+{
+   char filename[MAX_FILENAME_LENGTH];
+   uint32 header[GETOUT_HEADER_WORDS];
+   uint64_t checksum = getout_table_checksum();
+
+   // Put the table we have back where it belongs.
+
+   if (getout_table_level >= 0) {
+      loaded_getout_tables[getout_table_level].table = getout_table;
+      memset(&getout_table, 0, sizeof(getout_table));
+   }
+   else
+      clear_getout_table();   // A table that mkgetouts was making.
+
+   getout_table_level = calling_level;
+   loaded_getout_table & loaded = loaded_getout_tables[calling_level];
+
+   if (loaded.tried && loaded.checksum == checksum) {
+      getout_table = loaded.table;
+      memset(&loaded.table, 0, sizeof(loaded.table));
+      return;
+   }
+
+   // Never tried, or it was for another database.
+
+   getout_table = loaded.table;
+   memset(&loaded.table, 0, sizeof(loaded.table));
+   clear_getout_table();
+   loaded.tried = true;
+   loaded.checksum = checksum;
+
+   getout_table_filename(filename);
+
+   FILE *fp = fopen(filename, "rb");
+   if (!fp) return;
+
+   if (read_getout_words(fp, header, GETOUT_HEADER_WORDS) &&
+       header[0] == GETOUT_TABLE_MAGIC &&
+       header[1] == GETOUT_TABLE_VERSION &&
+       header[2] == (uint32) calling_level &&
+       header[3] == (uint32) checksum &&
+       header[4] == (uint32) (checksum >> 32)) {
+      grow_getout_array(getout_table.entries, getout_table.entry_allocation, header[5]);
+      grow_getout_array(getout_table.offsets, getout_table.getout_allocation, header[6]+1);
+      grow_getout_array(getout_table.codes, getout_table.code_allocation, header[7]);
+
+      if (read_getout_entries(fp, getout_table.entries, header[5]) &&
+          read_getout_words(fp, getout_table.offsets, header[6]+1) &&
+          read_getout_words(fp, getout_table.codes, header[7]) &&
+          getout_table.offsets[header[6]] == header[7]) {
+         getout_table.entry_count = header[5];
+         getout_table.getout_count = header[6];
+         getout_table.code_count = header[7];
+      }
+      else
+         clear_getout_table();
+   }
+
+   fclose(fp);
+}
+
+
+// Do the calls of one getout from the table, from the setup at huge_history_ptr, and
+// make it into a resolve if everything works and the square is resolved at the end.
+
+static bool replay_table_getout(uint32 index, resolve_rec *new_resolve)
+{
+   engine_context & e = *current_engine;
+   resolver_state & rs = the_resolver();
+   const uint32 *code = &getout_table.codes[getout_table.offsets[index]];
+   const uint32 *limit = &getout_table.codes[getout_table.offsets[index+1]];
+   parse_block *mark = get_parse_block_mark();
+   int j;
+
+   if (code >= limit || *code == 0 || *code > MAX_RESOLVE_SIZE) return false;
+   int size = *code++;
+
+   try {
+      e.m_testing_fidelity = false;
+
+      for (j=0; j<size; j++) {
+         e.m_config_history_ptr = rs.huge_history_ptr + j;
+         initialize_parse();
+         configuration::next_config().command_root = decode_parse_tree(code, limit);
+         if (!configuration::next_config().command_root) goto failed;
+
+         toplevelmove();
+         finish_toplevelmove();
+         check_concept_parse_tree(configuration::next_config().command_root, true);
+         if (warnings_are_unacceptable(true)) goto failed;
+      }
+   }
+   catch(error_flag_type) {
+      goto failed;
+   }
+
+   {
+      // The same things inner_search asks of a resolve, except for the random ones.
+      const setup *ns = &configuration::next_config().state;
+      resolve_indicator & r = configuration::next_resolve();
+
+      if (r.the_item->k == resolve_none || (r.the_item->distance & 0x40))
+         goto failed;
+
+      if ((r.the_item->distance & 0x20) &&
+          (((ns->rotation << 1) +
+            ((ns->people[r.the_item->locations[0]].id1 & 0700) >> 6) +
+            r.the_item->distance) & 7) == 0)
+         goto failed;
+   }
+
+   e.m_config_history_ptr++;
+   new_resolve->size = size;
+   new_resolve->insertion_point = 0;
+   new_resolve->insertion_width = 0;
+
+   for (j=0; j<MAX_RESOLVE_SIZE; j++)
+      new_resolve->stuph[j] = configuration::history()[j+rs.huge_history_ptr+1];
+
+   e.m_config_history_ptr = rs.huge_history_ptr;
+   return true;
+
+ failed:
+
+   e.m_config_history_ptr = rs.huge_history_ptr;
+   release_parse_blocks_to_mark(mark);
+   return false;
+}
+
+
+// Take the next getout from the table for the current setup, if there is one that we
+// haven't shown and that still works.  This is only for a plain resolve with nothing
+// typed in front of it, since that is all the table is made for.
+
+static bool take_table_getout(command_kind goal, resolve_rec *new_resolve)
+{
+   engine_context & engine = *current_engine;
+   resolver_state & rs = the_resolver();
+   if (getout_table.entry_count == 0 ||
+       goal != command_resolve ||
+       engine.m_ui_options.resolve_test_minutes != 0 ||
+       engine.m_saved_parse_state.parse_stack_index != 0 ||
+       engine.m_saved_command_root)
+      return false;
+
+   uint64_t key = getout_key(&configuration::history()[rs.huge_history_ptr].state);
+   uint32 low = 0;
+   uint32 high = getout_table.entry_count;
+
+   while (low < high) {
+      uint32 mid = (low + high) >> 1;
+      if (getout_table.entries[mid].key < key) low = mid+1;
+      else high = mid;
+   }
+
+   if (low == getout_table.entry_count || getout_table.entries[low].key != key)
+      return false;
+
+   const getout_entry & e = getout_table.entries[low];
+
+   for (uint32 i=0; i<e.count; i++) {
+      int hash = (int) hash_step(key, i+1);
+      int k;
+
+      for (k=0; k<rs.avoid_list_size; k++) {
+         if (hash == rs.avoid_list[k]) break;
+      }
+
+      if (k < rs.avoid_list_size) continue;
+      if (e.first+i >= getout_table.getout_count) break;
+
+      // Whether or not it works, don't try it again.
+      avoid_in_future(hash);
+
+      if (replay_table_getout(e.first+i, new_resolve)) {
+         new_resolve->hash = hash;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+
+// How many threads to spread a search over, once it gets to the random part.
+
+static int search_thread_count()
+{
+   engine_context & e = *current_engine;
+   // Keep the search deterministic if the operator asked for that.
+   if (e.m_ui_options.resolve_test_minutes != 0 || e.m_ui_options.diagnostic_mode)
+      return 1;
+
+   if (e.m_ui_options.resolve_threads > 0)
+      return e.m_ui_options.resolve_threads;
+
+   int n = (int) std::thread::hardware_concurrency();   // Zero if it doesn't know.
+   return (n > 0) ? n : 1;
+}
+
+
+// A worker offers a resolve that it found.  Returns false if another worker
+// already found the same one, in which case the worker should keep looking.
+
+bool shared_search::offer(const resolve_rec & r)
+{
+   std::lock_guard<std::mutex> hold(lock);
+
+   for (int i=0; i<found_count; i++) {
+      if (found[i].hash == r.hash) return false;
+   }
+
+   found[found_count++] = r;
+   stop = true;
+   return true;
+}
+
+
+// Start a resolve with an empty transposition table, since the operator may have
+// changed things like "allow modifications" since the last one.
+
+static void clear_transpositions()
+{
+   resolver_state & rs = the_resolver();
+   if (rs.transpositions) {
+      for (int i=0; i<TRANSPOSITION_SETS*TRANSPOSITION_WAYS; i++)
+         rs.transpositions[i].last_use = 0;
+   }
+
+   rs.transposition_clock = 0;
+   rs.tries = 0;
+   rs.lookups = 0;
+   rs.hits = 0;
+   rs.seconds = 0.0;
+}
+
+
+// Whether the call left the parse tree the way it was before.
+
+static bool parse_tree_unchanged(const parse_block *root, const parse_tree_item *before, int before_size)
+{
+   parse_tree_item after[TRANSPOSITION_TREE_ROOM];
+   int after_size = flatten_parse_tree(root, after, TRANSPOSITION_TREE_ROOM);
+   return after_size >= 0 && same_parse_tree(before, before_size, after, after_size);
+}
+
+
+// Fill in everything but the outcome.  That includes what toplevelmove left in
+// current_options and parse_state, which a hit puts back.
+
+static void remember_transposition(transposition & t,
+                                   uint64_t setup_key,
+                                   const setup & start,
+                                   uint64_t call_key,
+                                   const parse_tree_item *tree,
+                                   int tree_size,
+                                   const warning_info & prior_warnings)
+{
+   engine_context & e = *current_engine;
+   t.setup_key = setup_key;
+   t.start = start;
+   t.call_key = call_key;
+   for (int i=0; i<tree_size; i++) t.call[i] = tree[i];
+   t.call_size = tree_size;
+   t.prior_warnings = prior_warnings;
+   t.last_use = the_resolver().transposition_clock;
+   t.options_after = e.m_current_options;
+   t.topcallflags_after = e.m_parse_state.topcallflags1;
+   t.call_list_after = e.m_parse_state.call_list_to_use;
+}
+
+
+// Do the call in next_config from the setup in current_config, as toplevelmove and
+// finish_toplevelmove would, but look in the transposition table first.
+//
+// We only remember what happened if it depended on nothing but the setup, the parse
+// tree, and the search mode.  When a call picks a subcall or a selector at random as
+// it goes, the parse tree grows or the random numbers get hashed, and we can't use
+// the result again.  Neither can we at the start of the sequence, where toplevelmove
+// writes "heads" or "sides" into the tree.  Nor if it started asking about a subcall,
+// which leaves parse_state pointing into the tree.
+//
+// Other than next_config, the only things toplevelmove leaves behind are in
+// current_options and parse_state, and those are saved with the result.
+
+static void cached_toplevelmove()
+{
+   engine_context & engine = *current_engine;
+   resolver_state & rs = the_resolver();
+   configuration & newhist = configuration::next_config();
+   parse_tree_item tree[TRANSPOSITION_TREE_ROOM];
+   int tree_size = flatten_parse_tree(newhist.command_root, tree, TRANSPOSITION_TREE_ROOM);
+
+   if (engine.m_config_history_ptr <= 1 || configuration::current_config().nontrivial_startinfo_specific() ||
+       tree_size < 0) {
+      toplevelmove();
+      finish_toplevelmove();
+      return;
+   }
+
+   if (!rs.transpositions) {
+      rs.transpositions = new transposition[TRANSPOSITION_SETS*TRANSPOSITION_WAYS];
+      for (int i=0; i<TRANSPOSITION_SETS*TRANSPOSITION_WAYS; i++)
+         rs.transpositions[i].last_use = 0;
+   }
+
+   // A copy of the starting setup, since toplevelmove may change the history.
+   setup start = configuration::current_config().state;
+   uint64_t setup_key = hash_setup(&start);
+
+   // The mode bits are the things that tell do_subcall_query what to do.
+   uint64_t tree_key = hash_parse_tree(newhist.command_root);
+   uint64_t call_key = hash_step(tree_key,
+                                 (engine.m_testing_fidelity ? 1 : 0) |
+                                 (forbid_call_with_mandatory_subcall() ? 2 : 0) |
+                                 (allow_random_subcall_pick() ? 4 : 0) |
+                                 (engine.m_allowing_modifications << 3));
+   warning_info prior_warnings = configuration::save_warnings();
+   transposition *set = &rs.transpositions[((setup_key ^ call_key) % TRANSPOSITION_SETS) * TRANSPOSITION_WAYS];
+   transposition *victim = set;
+   int i;
+
+   rs.lookups++;
+   rs.transposition_clock++;
+
+   for (i=0; i<TRANSPOSITION_WAYS; i++) {
+      transposition & t = set[i];
+
+      if (t.last_use != 0 && t.setup_key == setup_key && t.call_key == call_key &&
+          t.prior_warnings == prior_warnings && same_setup_for_call(&t.start, &start) &&
+          same_parse_tree(t.call, t.call_size, tree, tree_size)) {
+         t.last_use = rs.transposition_clock;
+         rs.hits++;
+
+         // The little bit of bookkeeping that toplevelmove does.
+         if (engine.m_written_history_items > engine.m_config_history_ptr)
+            engine.m_written_history_items = engine.m_config_history_ptr;
+
+         engine.m_current_options = t.options_after;
+         engine.m_parse_state.topcallflags1 = t.topcallflags_after;
+         engine.m_parse_state.call_list_to_use = t.call_list_after;
+
+         if (t.failed) throw t.error;
+
+         parse_block *root = newhist.command_root;
+         newhist = t.result;
+         newhist.command_root = root;
+         return;
+      }
+
+      if (t.last_use < victim->last_use) victim = &t;
+   }
+
+   parse_block *mark = get_parse_block_mark();
+   uint32 count_before = engine.m_hashed_count;
+   parse_block **write_ptr_before = engine.m_parse_state.concept_write_ptr;
+   int stack_index_before = engine.m_parse_state.parse_stack_index;
+
+   try {
+      toplevelmove();
+      finish_toplevelmove();
+   }
+   catch(error_flag_type e) {
+      if (get_parse_block_mark() == mark && engine.m_hashed_count == count_before &&
+          engine.m_parse_state.concept_write_ptr == write_ptr_before &&
+          engine.m_parse_state.parse_stack_index == stack_index_before &&
+          parse_tree_unchanged(newhist.command_root, tree, tree_size)) {
+         remember_transposition(*victim, setup_key, start, call_key, tree, tree_size, prior_warnings);
+         victim->failed = true;
+         victim->error = e;
+      }
+
+      throw;
+   }
+
+   if (get_parse_block_mark() == mark && engine.m_hashed_count == count_before &&
+       engine.m_parse_state.concept_write_ptr == write_ptr_before &&
+       engine.m_parse_state.parse_stack_index == stack_index_before &&
+       parse_tree_unchanged(newhist.command_root, tree, tree_size)) {
+      remember_transposition(*victim, setup_key, start, call_key, tree, tree_size, prior_warnings);
+      victim->failed = false;
+      victim->result = newhist;
+   }
+}
+
+
+static bool parallel_search(command_kind goal,
+                            resolve_rec *new_resolve,
+                            int insertion_depth,
+                            int insertion_width,
+                            double seconds_to_resolve);
 
-#ifdef EXCESSIVE_RECONCILE_FIXUP
-static uint32 global_status;    // Yeah, it's sleazy making this static.
-#endif
 
 static bool inner_search(command_kind goal,
                          resolve_rec *new_resolve,
                          int insertion_depth,
                          int insertion_width)
 {
+   engine_context & e = *current_engine;
+   resolver_state & rs = the_resolver();
    int i, j;
    uint32 directions, p, q;
    double CLOCKS_TO_RESOLVE;
 
-   if (ui_options.resolve_test_minutes > 0)
-      CLOCKS_TO_RESOLVE = (double) ui_options.resolve_test_minutes * 60.0 * ((double) CLOCKS_PER_SEC);
+   // If a parallel search found more than we asked for last time, we may already have one.
+   if (!rs.sharing && take_banked_resolve(new_resolve, insertion_depth, insertion_width))
+      return true;
+
+   // Or mkgetouts may have found some from this very setup.
+   if (!rs.sharing && take_table_getout(goal, new_resolve))
+      return true;
+
+   if (e.m_ui_options.resolve_test_minutes > 0)
+      CLOCKS_TO_RESOLVE = (double) e.m_ui_options.resolve_test_minutes * 60.0 * ((double) CLOCKS_PER_SEC);
    else
       CLOCKS_TO_RESOLVE = 5.0 * ((double) CLOCKS_PER_SEC);
 
-   history_insertion_point = huge_history_ptr;
+   rs.history_insertion_point = rs.huge_history_ptr;
 
    if (goal == command_reconcile) {
-      history_insertion_point -= insertion_depth;    // This now points to the end of the insertion region.
+      rs.history_insertion_point -= insertion_depth;    // This now points to the end of the insertion region.
 
-      const setup & insertion_start_setup = configuration::history[history_insertion_point].state;
+      const setup & insertion_start_setup = configuration::history()[rs.history_insertion_point].state;
 
-      goal_rotation = insertion_start_setup.rotation;
-      goal_kind = insertion_start_setup.kind;
-      if (attr::klimit(goal_kind) != 7) return false;
+      rs.goal_rotation = insertion_start_setup.rotation;
+      rs.goal_kind = insertion_start_setup.kind;
+      if (attr::klimit(rs.goal_kind) != 7) return false;
       for (j=0; j<8; j++)
-         goal_directions[j] = insertion_start_setup.people[j].id1 & d_mask;
+         rs.goal_directions[j] = insertion_start_setup.people[j].id1 & d_mask;
 
       for (j=0; j<8; j++) {
-         perm_indices[j] = -1;
+         rs.perm_indices[j] = -1;
          for (i=0; i<8; i++)
             if ((insertion_start_setup.people[i].id1 &
                  PID_MASK) ==
-                perm_array[j])
-               perm_indices[j] = i;
-         if (perm_indices[j] < 0) return false;      // Didn't find the person????
+                rs.perm_array[j])
+               rs.perm_indices[j] = i;
+         if (rs.perm_indices[j] < 0) return false;      // Didn't find the person????
       }
 
-      history_insertion_point -= insertion_width;    // Now it points to the beginning of the insertion region.
+      rs.history_insertion_point -= insertion_width;    // Now it points to the beginning of the insertion region.
    }
 
-   history_save = history_insertion_point;
+   rs.history_save = rs.history_insertion_point;
 
    // Since these variables are expected to be preserved
    // across the throw, they must be volatile.
@@ -1059,10 +2025,10 @@ static bool inner_search(command_kind goal,
 
    int32 air_start_time = clock();
    double big_resolve_time = 0.0;
-   hashed_random_list[0] = 0;
+   rs.hashed_random_list[0] = 0;
 
    // Mark the parse block allocation, so that we throw away the garbage created by failing attempts.
-   inner_parse_mark = outer_parse_mark = get_parse_block_mark();
+   rs.inner_parse_mark = rs.outer_parse_mark = get_parse_block_mark();
 
    // This loop searches through a group of twenty single-call resolves, then a group
    // of twenty two-call resolves, then a group of twenty three-call resolves,
@@ -1083,10 +2049,26 @@ static bool inner_search(command_kind goal,
 
    try {
       // Throw away garbage from last attempt.
-      release_parse_blocks_to_mark(inner_parse_mark);
-      testing_fidelity = false;
-      config_history_ptr = history_save;
+      release_parse_blocks_to_mark(rs.inner_parse_mark);
+      e.m_testing_fidelity = false;
+      e.m_config_history_ptr = rs.history_save;
       attempt_count++;
+      rs.tries++;
+
+      // Once the exhaustive scans are over and we are just trying random things, other
+      // threads can try them too.  But only if nothing has been typed in yet, since the
+      // other engines start with an empty parse.
+
+      if (!rs.sharing &&
+          rs.history_save == rs.history_insertion_point &&
+          in_random_search() &&
+          search_thread_count() > 1 &&
+          e.m_saved_parse_state.parse_stack_index == 0 &&
+          !e.m_saved_command_root) {
+         e.m_config_history_ptr = rs.huge_history_ptr;
+         return parallel_search(goal, new_resolve, insertion_depth, insertion_width,
+                                (CLOCKS_TO_RESOLVE - big_resolve_time) / ((double) CLOCKS_PER_SEC));
+      }
 
       // Check whether we have been trying too long.  If so, give up and report failure.
       // The user can try again by giving the "find another" command.  We use the actual
@@ -1100,6 +2082,10 @@ static bool inner_search(command_kind goal,
       // This also has the nice property that, when debugging, clock expirations won't
       // interfere until 4095 things have been tried.
       //
+      // A worker in a parallel search can't use "clock", which counts the processor time
+      // of all the threads together.  It goes by the real time, and also stops as soon
+      // as any worker finds something.
+      //
       // But there is a much more serious problem that needs to be addressed.  On
       // Windows, CLOCKS_PER_SEC is 1000, that is, the clock ticks count milliseconds.
       // But on Linux, CLOCKS_PER_SEC is 1000000, that is, the clock ticks count
@@ -1111,7 +2097,15 @@ static bool inner_search(command_kind goal,
       // air--10 times per second.  That's still very accurate on Windows, a resolution
       // of 1 percent.
 
-      if (!(attempt_count & 4095)) {
+      if (rs.sharing) {
+         if (rs.sharing->stop ||
+             (!(attempt_count & 4095) && std::chrono::steady_clock::now() >= rs.sharing->deadline)) {
+            rs.sharing->stop = true;
+            e.m_config_history_ptr = rs.huge_history_ptr;
+            return false;
+         }
+      }
+      else if (!(attempt_count & 4095)) {
          // Come up for air; see how much clock time has elapsed.  It will be about 100
          // ticks on Windows, and 100,000 ticks on Linux.  Tally that in a
          // doubleprecision floating variable.  36 billion is trivial for such a thing.
@@ -1128,7 +2122,7 @@ static bool inner_search(command_kind goal,
 
          if (big_resolve_time > CLOCKS_TO_RESOLVE) {
             // Too many tries -- too bad.
-            config_history_ptr = huge_history_ptr;
+            e.m_config_history_ptr = rs.huge_history_ptr;
 
             // We shouldn't have to do the following stuff.  The searcher should be written
             // such that it doesn't get stuck on a call with any iterator nonzero, because,
@@ -1147,14 +2141,14 @@ static bool inner_search(command_kind goal,
 
       // Now clear any concepts if we are not on the first call of the series.
 
-      if (config_history_ptr != history_insertion_point || goal == command_reconcile)
+      if (e.m_config_history_ptr != rs.history_insertion_point || goal == command_reconcile)
          initialize_parse();
       else
          restore_parse_state();
 
       // Generate the concepts and call.
 
-      hashed_randoms = hashed_random_list[config_history_ptr - history_insertion_point];
+      e.m_hashed_randoms = rs.hashed_random_list[e.m_config_history_ptr - rs.history_insertion_point];
 
       // Put in a special initial concept if needed to normalize.
 
@@ -1198,8 +2192,7 @@ static bool inner_search(command_kind goal,
 
       // Do the call.  An error will signal and go to cant_consider_this_call.
 
-      toplevelmove();
-      finish_toplevelmove();
+      cached_toplevelmove();
 
       // Check that there are no unfilled parts of the parse tree, as in
       // "detract [ignore everyone line to line but [***]]".
@@ -1214,8 +2207,8 @@ static bool inner_search(command_kind goal,
 
       // See if we have already seen this sequence.
 
-      for (i=0; i<avoid_list_size; i++) {
-         if (hashed_randoms == avoid_list[i]) goto cant_consider_this_call;
+      for (i=0; i<rs.avoid_list_size; i++) {
+         if (e.m_hashed_randoms == rs.avoid_list[i]) goto cant_consider_this_call;
       }
 
       // The call was legal, see if it satisfies our criterion.
@@ -1225,7 +2218,7 @@ static bool inner_search(command_kind goal,
       // But if we are doing a resolve test, make everything fail, so that the test
       // will run forever (well, until the specified time limit), just looking for crashes.
 
-      if (ui_options.resolve_test_minutes > 0) goto not_a_solution_but_maybe_can_build_on_it;
+      if (e.m_ui_options.resolve_test_minutes > 0) goto not_a_solution_but_maybe_can_build_on_it;
 
       // We used to use an "if" statement here instead of a "switch", because
       // of a compiler bug.  We no longer take pity on buggy compilers.
@@ -1326,24 +2319,24 @@ static bool inner_search(command_kind goal,
 
       case command_reconcile:
          {
-            if (ns->kind != goal_kind) goto not_a_solution_but_maybe_can_build_on_it;
+            if (ns->kind != rs.goal_kind) goto not_a_solution_but_maybe_can_build_on_it;
 #ifndef EXCESSIVE_RECONCILE_FIXUP
             for (j=0; j<8; j++) {
-               if ((ns->people[j].id1 & d_mask) != goal_directions[j]) goto not_a_solution_but_maybe_can_build_on_it; }
+               if ((ns->people[j].id1 & d_mask) != rs.goal_directions[j]) goto not_a_solution_but_maybe_can_build_on_it; }
 #endif
 
-            int p0 = ns->people[perm_indices[0]].id1 & PID_MASK;
-            int p1 = ns->people[perm_indices[1]].id1 & PID_MASK;
-            int p2 = ns->people[perm_indices[2]].id1 & PID_MASK;
-            int p3 = ns->people[perm_indices[3]].id1 & PID_MASK;
-            int p4 = ns->people[perm_indices[4]].id1 & PID_MASK;
-            int p5 = ns->people[perm_indices[5]].id1 & PID_MASK;
-            int p6 = ns->people[perm_indices[6]].id1 & PID_MASK;
-            int p7 = ns->people[perm_indices[7]].id1 & PID_MASK;
+            int p0 = ns->people[rs.perm_indices[0]].id1 & PID_MASK;
+            int p1 = ns->people[rs.perm_indices[1]].id1 & PID_MASK;
+            int p2 = ns->people[rs.perm_indices[2]].id1 & PID_MASK;
+            int p3 = ns->people[rs.perm_indices[3]].id1 & PID_MASK;
+            int p4 = ns->people[rs.perm_indices[4]].id1 & PID_MASK;
+            int p5 = ns->people[rs.perm_indices[5]].id1 & PID_MASK;
+            int p6 = ns->people[rs.perm_indices[6]].id1 & PID_MASK;
+            int p7 = ns->people[rs.perm_indices[7]].id1 & PID_MASK;
 
             // Test for absolute sex correctness if required.
 #ifndef EXCESSIVE_RECONCILE_FIXUP
-            if (!current_reconciler->allow_eighth_rotation && (p0 & 0100)) goto not_a_solution_but_maybe_can_build_on_it;
+            if (!rs.current_reconciler->allow_eighth_rotation && (p0 & 0100)) goto not_a_solution_but_maybe_can_build_on_it;
 #endif
 
             p7 = (p7 - p6) & PID_MASK;
@@ -1497,23 +2490,23 @@ static bool inner_search(command_kind goal,
       // protect it.
 
 #ifdef EXCESSIVE_RECONCILE_FIXUP
-      configuration::history[config_history_ptr+1].command_root =
-         copy_parse_tree(configuration::history[config_history_ptr+1].command_root);
+      configuration::history()[e.m_config_history_ptr+1].command_root =
+         copy_parse_tree(configuration::history()[e.m_config_history_ptr+1].command_root);
 #else
-      configuration::history[huge_history_ptr+1].command_root =
-         copy_parse_tree(configuration::history[huge_history_ptr+1].command_root);
+      configuration::history()[rs.huge_history_ptr+1].command_root =
+         copy_parse_tree(configuration::history()[rs.huge_history_ptr+1].command_root);
 #endif
 
       // Save the entire resolve, that is, the calls we inserted, and where we inserted them.
 
-      config_history_ptr++;
-      new_resolve->size = config_history_ptr - history_insertion_point;
+      e.m_config_history_ptr++;
+      new_resolve->size = e.m_config_history_ptr - rs.history_insertion_point;
 
       if (goal == command_reconcile) {
          for (j=0; j<8; j++)
-            new_resolve->permutepersoninfo[perm_array[j] >> 6] = ns->people[perm_indices[j]];
+            new_resolve->permutepersoninfo[rs.perm_array[j] >> 6] = ns->people[rs.perm_indices[j]];
 
-         new_resolve->rotchange = ns->rotation - goal_rotation;
+         new_resolve->rotchange = ns->rotation - rs.goal_rotation;
          new_resolve->insertion_point = insertion_depth;
          new_resolve->insertion_width = insertion_width;
       }
@@ -1528,16 +2521,16 @@ static bool inner_search(command_kind goal,
       // like "heads" or "boys" it will likely fail this test until we get around to
       // doing something clever.  Oh well.)
 
-      testing_fidelity = true;
+      e.m_testing_fidelity = true;
 #ifdef EXCESSIVE_RECONCILE_FIXUP
-      global_status = 0;
+      rs.global_status = 0;
 #endif
 
       for (j=0; j<new_resolve->insertion_point; j++) {
          // Copy the whole thing into the history, chiefly to get the call and concepts.
-         written_history_items = -1;
+         e.m_written_history_items = -1;
 
-         configuration::next_config() = huge_history_save[j+huge_history_ptr+1-new_resolve->insertion_point];
+         configuration::next_config() = rs.huge_history_save[j+rs.huge_history_ptr+1-new_resolve->insertion_point];
 
 #ifdef EXCESSIVE_RECONCILE_FIXUP
          // The call to fix_up_call_for_fidelity_test will alter the parse tree in
@@ -1550,8 +2543,8 @@ static bool inner_search(command_kind goal,
          // Which means that the "stuph" array is unbounded.
 
          if (fix_up_call_for_fidelity_test(&configuration::current_config().state,
-                                           &huge_history_save[j+huge_history_ptr-new_resolve->insertion_point].state,
-                                           global_status) || (global_status & 2)) {
+                                           &rs.huge_history_save[j+rs.huge_history_ptr-new_resolve->insertion_point].state,
+                                           rs.global_status) || (rs.global_status & 2)) {
             goto not_a_solution_but_maybe_can_build_on_it;
          }
 
@@ -1567,8 +2560,7 @@ static bool inner_search(command_kind goal,
 #else
          // Now execute the call again, from the new starting configuration.
          // This might signal and go to cant_consider_this_call.
-         toplevelmove();
-         finish_toplevelmove();
+         cached_toplevelmove();
 #endif
 
          configuration this_state = configuration::next_config();
@@ -1577,14 +2569,14 @@ static bool inner_search(command_kind goal,
 
 #ifndef EXCESSIVE_RECONCILE_FIXUP
          if (this_state.state.rotation !=
-             huge_history_save[j+huge_history_ptr+1-new_resolve->insertion_point].state.rotation)
+             rs.huge_history_save[j+rs.huge_history_ptr+1-new_resolve->insertion_point].state.rotation)
             goto cant_consider_this_call;
 
-         if (this_state.warnings_are_different(huge_history_save[j+huge_history_ptr+1-new_resolve->insertion_point]))
+         if (this_state.warnings_are_different(rs.huge_history_save[j+rs.huge_history_ptr+1-new_resolve->insertion_point]))
             goto cant_consider_this_call;
 
          for (int k=0; k<=attr::klimit(this_state.state.kind); k++) {
-            personrec t = huge_history_save[j+huge_history_ptr+1-new_resolve->insertion_point].state.people[k];
+            personrec t = rs.huge_history_save[j+rs.huge_history_ptr+1-new_resolve->insertion_point].state.people[k];
 
             if (t.id1) {
                const personrec & thispermuteperson = new_resolve->permutepersoninfo[(t.id1 & PID_MASK) >> 6];
@@ -1604,10 +2596,10 @@ static bool inner_search(command_kind goal,
          }
 #endif
 
-         config_history_ptr++;
+         e.m_config_history_ptr++;
       }
 
-      testing_fidelity = false;
+      e.m_testing_fidelity = false;
 
       // One more check.  If this was a "reconcile", demand that we
       // have an acceptable resolve.  Specifically, we reject anything
@@ -1629,29 +2621,25 @@ static bool inner_search(command_kind goal,
 
       // We win.  Really save it and exit.  History_ptr has been clobbered.
 
+      new_resolve->hash = e.m_hashed_randoms;
+
       for (j=0; j<MAX_RESOLVE_SIZE; j++) {
-         new_resolve->stuph[j] = configuration::history[j+history_insertion_point+1];
+         new_resolve->stuph[j] = configuration::history()[j+rs.history_insertion_point+1];
          if (j < new_resolve->size) {
             if (new_resolve->stuph[j].command_root == 0 || new_resolve->stuph[j].command_root->concept == 0) {
-               gg77->iob88.serious_error_print("BUG IN RESOLVER!\n");
+               e.m_gg77->iob88.serious_error_print("BUG IN RESOLVER!\n");
                goto cant_consider_this_call;   // What????  Some kind of bug, apparently.
             }
          }
       }
 
-      // Grow the "avoid_list" array as needed.
-
-      if (avoid_list_allocation <= avoid_list_size) {
-         int new_allocation = avoid_list_size*2+5;
-         int *new_list = new int[new_allocation];
-         memcpy(new_list, avoid_list, avoid_list_allocation * sizeof(int));
-         delete [] avoid_list;
-         avoid_list = new_list;
-         avoid_list_allocation = new_allocation;
+      // A worker hands it over, unless another worker found the same thing first.
+      if (rs.sharing) {
+         if (!rs.sharing->offer(*new_resolve)) goto cant_consider_this_call;
+         return true;
       }
 
-      avoid_list[avoid_list_size++] = hashed_randoms;   // It's now safe to do this.
-
+      avoid_in_future(e.m_hashed_randoms);   // It's now safe to do this.
       return true;
 
    not_a_solution_but_maybe_can_build_on_it:
@@ -1660,8 +2648,8 @@ static bool inner_search(command_kind goal,
 
       if (++little_count == 60) {
          // Revert back to beginning.
-         history_save = history_insertion_point;
-         inner_parse_mark = outer_parse_mark;
+         rs.history_save = rs.history_insertion_point;
+         rs.inner_parse_mark = rs.outer_parse_mark;
          little_count = 0;
       }
       else if (little_count == 20 || little_count == 40) {
@@ -1688,9 +2676,9 @@ static bool inner_search(command_kind goal,
          ok_to_save_this: ;
          }
 
-         history_save = config_history_ptr + 1;
-         inner_parse_mark = get_parse_block_mark();
-         hashed_random_list[history_save - history_insertion_point] = hashed_randoms;
+         rs.history_save = e.m_config_history_ptr + 1;
+         rs.inner_parse_mark = get_parse_block_mark();
+         rs.hashed_random_list[rs.history_save - rs.history_insertion_point] = e.m_hashed_randoms;
       }
    }
    catch(error_flag_type) {
@@ -1700,17 +2688,176 @@ static bool inner_search(command_kind goal,
 }
 
 
+// This runs on a worker's thread.  The worker starts from the sequence as it was when the
+// search began, which the master engine keeps in huge_history_save, and does the random
+// search on its own until some worker finds something or time runs out.  The master just
+// waits, so we can read its state.
+
+static void run_search_worker(const engine_context *master,
+                              engine_context *worker,
+                              shared_search *ss,
+                              command_kind goal,
+                              int insertion_depth,
+                              int insertion_width)
+{
+   engine_context::scope bind(*worker);
+   int j;
+
+   // The options and modes that decide what we accept.
+   current_engine->m_gg77 = master->m_gg77;       // Only for crash reports.  A worker never talks to the user.
+   current_engine->m_ui_options = master->m_ui_options;
+   current_engine->m_allowing_modifications = master->m_allowing_modifications;
+   current_engine->m_allowing_all_concepts = master->m_allowing_all_concepts;
+   current_engine->m_allowing_minigrand = master->m_allowing_minigrand;
+   current_engine->m_allow_bend_home_getout = master->m_allow_bend_home_getout;
+   current_engine->m_using_active_phantoms = master->m_using_active_phantoms;
+   current_engine->m_enforce_overcast_warning = master->m_enforce_overcast_warning;
+   current_engine->m_search_goal = master->m_search_goal;
+   configuration::whole_sequence_low_lim() = master->m_whole_sequence_low_lim;
+
+   // Our own copy of the sequence, with our own copies of the parse trees, since doing
+   // a call can write into its parse tree.
+
+   current_engine->m_history_allocation = master->m_history_allocation;
+   configuration::history() = new configuration[current_engine->m_history_allocation];
+   the_resolver().huge_history_allocation = ss->start_history_allocation;
+   the_resolver().huge_history_save = new configuration[the_resolver().huge_history_allocation];
+   the_resolver().huge_history_ptr = ss->start_history_ptr;
+
+   for (j=0; j<=the_resolver().huge_history_ptr+1; j++) {
+      the_resolver().huge_history_save[j] = ss->start_history[j];
+      the_resolver().huge_history_save[j].command_root = copy_parse_tree(ss->start_history[j].command_root);
+      configuration::history()[j] = the_resolver().huge_history_save[j];
+   }
+
+   for (j=0; j<MAX_RESOLVE_SIZE; j++) {
+      configuration::history()[the_resolver().huge_history_ptr+j+2].command_root = (parse_block *) 0;
+      configuration::history()[the_resolver().huge_history_ptr+j+2].init_centersp_specific();
+   }
+
+   the_resolver().avoid_list_allocation = ss->start_avoid_list_size+5;
+   the_resolver().avoid_list = new int[the_resolver().avoid_list_allocation];
+   memcpy(the_resolver().avoid_list, ss->start_avoid_list, ss->start_avoid_list_size * sizeof(int));
+   the_resolver().avoid_list_size = ss->start_avoid_list_size;
+   memcpy(the_resolver().perm_array, ss->start_perm_array, sizeof(the_resolver().perm_array));
+   the_resolver().current_reconciler = ss->start_reconciler;
+   the_resolver().sharing = ss;
+
+   // Nothing has been typed in, so the parse state is the same as a fresh one.
+   current_engine->m_config_history_ptr = the_resolver().huge_history_ptr;
+   current_engine->m_written_history_items = -1;
+   initialize_parse();
+   current_engine->m_parse_state.base_call_list_to_use = master->m_saved_parse_state.base_call_list_to_use;
+   current_engine->m_parse_state.call_list_to_use = master->m_saved_parse_state.call_list_to_use;
+   save_parse_state();
+   start_random_pick();
+
+   resolve_rec *scratch = new resolve_rec;
+   inner_search(goal, scratch, insertion_depth, insertion_width);
+   delete scratch;
+}
+
+
+// Spread the random search over several threads, each running an engine of its own
+// with its own random numbers.  The first resolve that any of them finds is the
+// result.  If others turn up at the same time, we keep them for "find another".
+// The caller must have saved the sequence in huge_history_save.
+
+static bool parallel_search(command_kind goal,
+                            resolve_rec *new_resolve,
+                            int insertion_depth,
+                            int insertion_width,
+                            double seconds_to_resolve)
+{
+   resolver_state & rs = the_resolver();
+   int i, j;
+   int nthreads = search_thread_count();
+   engine_context *master = current_engine;
+   shared_search ss;
+
+   ss.start_history = rs.huge_history_save;
+   ss.start_history_allocation = rs.huge_history_allocation;
+   ss.start_history_ptr = rs.huge_history_ptr;
+   ss.start_avoid_list = rs.avoid_list;
+   ss.start_avoid_list_size = rs.avoid_list_size;
+   ss.start_perm_array = rs.perm_array;
+   ss.start_reconciler = rs.current_reconciler;
+   ss.stop = false;
+   ss.deadline = std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+         std::chrono::duration<double>(seconds_to_resolve));
+   ss.found = new resolve_rec[nthreads];
+   ss.found_count = 0;
+
+   engine_context **workers = new engine_context *[nthreads];
+   std::thread *threads = new std::thread[nthreads];
+
+   for (i=0; i<nthreads; i++) {
+      workers[i] = new engine_context;
+      // Seed each one from our own generator, so they all go different ways.
+      workers[i]->m_random_state =
+         ((uint64_t) generate_random_number(0x40000000) << 32) |
+         ((uint64_t) generate_random_number(0x40000000) << 1) | 1;   // Never zero.
+      threads[i] = std::thread(run_search_worker, master, workers[i], &ss,
+                               goal, insertion_depth, insertion_width);
+   }
+
+   for (i=0; i<nthreads; i++)
+      threads[i].join();
+
+   // What they found is in their parse blocks, which go away with them.
+   // Copy it into ours.
+
+   for (i=0; i<ss.found_count; i++) {
+      resolve_rec & r = ss.found[i];
+
+      for (j=0; j<MAX_RESOLVE_SIZE; j++)
+         r.stuph[j].command_root = (j < r.size) ?
+            copy_parse_tree(r.stuph[j].command_root) : (parse_block *) 0;
+
+      if (i == 0) {
+         *new_resolve = r;
+         avoid_in_future(r.hash);
+      }
+      else
+         bank_resolve(r);
+   }
+
+   for (i=0; i<nthreads; i++) {
+      const resolver_state *wr = workers[i]->m_resolver;
+
+      if (wr) {
+         rs.tries += wr->tries;
+         rs.lookups += wr->lookups;
+         rs.hits += wr->hits;
+      }
+
+      delete workers[i];
+   }
+
+   delete [] threads;
+   delete [] workers;
+   delete [] ss.found;
+
+   // Like the single-threaded search, if time ran out.
+   if (ss.found_count == 0) reset_internal_iterators();
+
+   return ss.found_count != 0;
+}
+
+
 static bool reconcile_command_ok()
 {
+   resolver_state & rs = the_resolver();
    int k;
    int dirmask = 0;
    personrec *current_people = configuration::current_config().state.people;
    setup_kind current_kind = configuration::current_config().state.kind;
-   current_reconciler = (reconcile_descriptor *) 0;
+   rs.current_reconciler = (reconcile_descriptor *) 0;
 
    // Since we are going to go back 1 call, demand we have at least 3. *****
    // Also, demand no concepts already in place.
-   if ((config_history_ptr < 3) || configuration::concepts_in_place()) return false;
+   if ((current_engine->m_config_history_ptr < 3) || configuration::concepts_in_place()) return false;
 
    for (k=0; k<8; k++)
       dirmask = (dirmask << 2) | (current_people[k].id1 & 3);
@@ -1718,41 +2865,41 @@ static bool reconcile_command_ok()
    switch (current_kind) {
    case s2x4:
       if (dirmask == 0xA00A)
-         current_reconciler = &promperm;   // L2FL, looking for promenade.
+         rs.current_reconciler = &promperm;   // L2FL, looking for promenade.
       else if (dirmask == 0x0AA0)
-         current_reconciler = &rpromperm;  // R2FL, looking for reverse promenade.
+         rs.current_reconciler = &rpromperm;  // R2FL, looking for reverse promenade.
       else if (dirmask == 0x6BC1)
-         current_reconciler = &homeperm;   // pseudo-squared-set, looking for circle left/right.
+         rs.current_reconciler = &homeperm;   // pseudo-squared-set, looking for circle left/right.
       else if (dirmask == 0xFF55)
-         current_reconciler = &sglperm;    // Lcol, looking for single file promenade.
+         rs.current_reconciler = &sglperm;    // Lcol, looking for single file promenade.
       else if (dirmask == 0x55FF)
-         current_reconciler = &sglperm;    // Rcol, looking for reverse single file promenade.
+         rs.current_reconciler = &sglperm;    // Rcol, looking for reverse single file promenade.
       else if (dirmask == 0xBC16)
-         current_reconciler = &sglperm;    // L Tbone, looking for single file promenade.
+         rs.current_reconciler = &sglperm;    // L Tbone, looking for single file promenade.
       else if (dirmask == 0x16BC)
-         current_reconciler = &sglperm;    // R Tbone, looking for reverse single file promenade.
+         rs.current_reconciler = &sglperm;    // R Tbone, looking for reverse single file promenade.
       else if (dirmask == 0x2288)
-         current_reconciler = &rlgperm;    // Rwave, looking for RLG.
+         rs.current_reconciler = &rlgperm;    // Rwave, looking for RLG.
       else if (dirmask == 0x8822)
-         current_reconciler = &laperm;     // Lwave, looking for LA.
+         rs.current_reconciler = &laperm;     // Lwave, looking for LA.
       break;
    case s_qtag:
       if (dirmask == 0x08A2)
-         current_reconciler = &qtagperm;   // Rqtag, looking for RLG.
+         rs.current_reconciler = &qtagperm;   // Rqtag, looking for RLG.
       else if (dirmask == 0x78D2)
-         current_reconciler = &qtagperm;   // diamonds with points facing, looking for RLG.
+         rs.current_reconciler = &qtagperm;   // diamonds with points facing, looking for RLG.
       break;
    case s_crosswave: case s_thar:
       if (dirmask == 0x278D)
-         current_reconciler = &crossplus;  // crossed waves or thar, looking for RLG, allow slip the clutch.
+         rs.current_reconciler = &crossplus;  // crossed waves or thar, looking for RLG, allow slip the clutch.
       else if (dirmask == 0x8D27)
-         current_reconciler = &crossplus;  // crossed waves or thar, looking for LA, allow slip the clutch.
+         rs.current_reconciler = &crossplus;  // crossed waves or thar, looking for LA, allow slip the clutch.
       else if (dirmask == 0xAF05)
-         current_reconciler = &crossperm;  // crossed waves or thar, looking for promenade.
+         rs.current_reconciler = &crossperm;  // crossed waves or thar, looking for promenade.
       break;
    }
 
-   return (current_reconciler != 0);
+   return (rs.current_reconciler != 0);
 }
 
 extern int resolve_command_ok(void)
@@ -1773,7 +2920,7 @@ extern int nice_setup_command_ok(void)
    for (k=0 ; k < NUM_NICE_START_KINDS ; k++) {
       // Select the correct concept array.
       nice_setup_info[k].array_to_use_now =
-         (allowing_all_concepts) ? nice_setup_info[k].thing->zzzfull_list : nice_setup_info[k].thing->zzzon_level_list;
+         (current_engine->m_allowing_all_concepts) ? nice_setup_info[k].thing->zzzfull_list : nice_setup_info[k].thing->zzzon_level_list;
 
       // Note how many concepts are in it.  If there are zero in some of them,
       // we may still be able to proceed, but we must have concepts available
@@ -1792,47 +2939,61 @@ extern int nice_setup_command_ok(void)
 }
 
 
-uims_reply_thing ui_utils::full_resolve()
+// Get the resolver's arrays ready for a search from the current sequence.
+
+static void prepare_search()
 {
-   int j, k;
-   uims_reply_thing reply(ui_user_cancel, 99);
-   int current_resolve_index, max_resolve_index;
-   bool show_resolve;
-   int current_depth = 0;
-   int current_width = 0;
-   bool find_another_resolve = true;
-   resolver_display_state big_state; // for display to the user.
+   engine_context & e = *current_engine;
+   resolver_state & rs = the_resolver();
+   int j;
 
    // Allocate or reallocate the huge_history_save save array if needed.
 
-   if (huge_history_allocation < config_history_ptr+MAX_RESOLVE_SIZE+2) {
-      int new_history_allocation = config_history_ptr+MAX_RESOLVE_SIZE+2;
+   if (rs.huge_history_allocation < e.m_config_history_ptr+MAX_RESOLVE_SIZE+2) {
+      int new_history_allocation = e.m_config_history_ptr+MAX_RESOLVE_SIZE+2;
       // Increase by 50% beyond what we have now.
       new_history_allocation += new_history_allocation >> 1;
       configuration *new_history_save = new configuration[new_history_allocation];
-      memcpy(new_history_save, huge_history_save, huge_history_allocation);
-      delete [] huge_history_save;
-      huge_history_save = new_history_save;
-      huge_history_allocation = new_history_allocation;
+      memcpy(new_history_save, rs.huge_history_save, rs.huge_history_allocation);
+      delete [] rs.huge_history_save;
+      rs.huge_history_save = new_history_save;
+      rs.huge_history_allocation = new_history_allocation;
    }
 
    // Do the resolve array.
 
-   if (all_resolves == 0) {
-      resolve_allocation = 10;
-      all_resolves = new resolve_rec[resolve_allocation];
+   if (rs.all_resolves == 0) {
+      rs.resolve_allocation = 10;
+      rs.all_resolves = new resolve_rec[rs.resolve_allocation];
    }
 
    // Be sure the extra 5 slots in the history array are clean.
 
    for (j=0; j<MAX_RESOLVE_SIZE; j++) {
-      configuration::history[config_history_ptr+j+2].command_root = (parse_block *) 0;
-      configuration::history[config_history_ptr+j+2].init_centersp_specific();
+      configuration::history()[e.m_config_history_ptr+j+2].command_root = (parse_block *) 0;
+      configuration::history()[e.m_config_history_ptr+j+2].init_centersp_specific();
    }
+}
+
+
+uims_reply_thing ui_utils::full_resolve()
+{
+   engine_context & e = *current_engine;
+   resolver_state & rs = the_resolver();
+   int j, k;
+   uims_reply_thing reply(ui_user_cancel, 99);
+   int current_resolve_index, max_resolve_index;
+   bool show_resolve;
+   int current_depth = 0;
+   int current_width = 0;
+   bool find_another_resolve = true;
+   resolver_display_state big_state; // for display to the user.
+
+   prepare_search();
 
    // See if we are in a reasonable position to do the search.
 
-   switch (search_goal) {
+   switch (e.m_search_goal) {
       case command_resolve:
          if (!resolve_command_ok())
             specialfail("Not in acceptable setup for resolve.");
@@ -1849,7 +3010,7 @@ uims_reply_thing ui_utils::full_resolve()
             personrec *current_people = configuration::current_config().state.people;
 
             for (j=0; j<8; j++)
-               perm_array[j] = current_people[current_reconciler->perm[j]].id1 & PID_MASK;
+               rs.perm_array[j] = current_people[rs.current_reconciler->perm[j]].id1 & PID_MASK;
          }
 
          current_depth = 1;
@@ -1863,19 +3024,21 @@ uims_reply_thing ui_utils::full_resolve()
          break;
    }
 
-   for (j=0; j<=config_history_ptr+1; j++)
-      huge_history_save[j] = configuration::history[j];
+   for (j=0; j<=e.m_config_history_ptr+1; j++)
+      rs.huge_history_save[j] = configuration::history()[j];
 
-   huge_history_ptr = config_history_ptr;
+   rs.huge_history_ptr = e.m_config_history_ptr;
    save_parse_state();
 
    restore_parse_state();
    current_resolve_index = 0;
    show_resolve = true;
    max_resolve_index = 0;
-   avoid_list_size = 0;
+   rs.avoid_list_size = 0;
+   rs.banked_count = 0;
+   clear_transpositions();
 
-   if (search_goal == command_reconcile) show_resolve = false;
+   if (e.m_search_goal == command_reconcile) show_resolve = false;
 
    start_pick();   // This sets interactivity, among other stuff.
 
@@ -1884,11 +3047,15 @@ uims_reply_thing ui_utils::full_resolve()
       if (find_another_resolve) {
          // Put up the resolve title showing that we are searching.
 
-         gg77->iob88.update_resolve_menu(search_goal, current_resolve_index, max_resolve_index, resolver_display_searching);
+         e.m_gg77->iob88.update_resolve_menu(e.m_search_goal, current_resolve_index, max_resolve_index, resolver_display_searching);
 
          restore_parse_state();
 
-         if (inner_search(search_goal, &all_resolves[max_resolve_index], current_depth, current_width)) {
+         std::chrono::steady_clock::time_point search_start = std::chrono::steady_clock::now();
+         bool search_won = inner_search(e.m_search_goal, &rs.all_resolves[max_resolve_index], current_depth, current_width);
+         rs.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - search_start).count();
+
+         if (search_won) {
             // Search succeeded, save it.
             max_resolve_index++;
             // Make it the current one.
@@ -1903,11 +3070,11 @@ uims_reply_thing ui_utils::full_resolve()
             big_state = resolver_display_failed;
          }
 
-         written_history_items = -1;
-         config_history_ptr = huge_history_ptr;
+         e.m_written_history_items = -1;
+         e.m_config_history_ptr = rs.huge_history_ptr;
 
-         for (j=0; j<=config_history_ptr+1; j++)
-            configuration::history[j] = huge_history_save[j];
+         for (j=0; j<=e.m_config_history_ptr+1; j++)
+            configuration::history()[j] = rs.huge_history_save[j];
 
          find_another_resolve = false;
       }
@@ -1922,20 +3089,20 @@ uims_reply_thing ui_utils::full_resolve()
 
       if ((current_resolve_index != 0) && show_resolve) {
          // Display the current resolve.
-         resolve_rec *this_resolve = &all_resolves[current_resolve_index-1];
+         resolve_rec *this_resolve = &rs.all_resolves[current_resolve_index-1];
 
          // Copy the inserted calls.
-         written_history_items = -1;
+         e.m_written_history_items = -1;
          for (j=0; j<this_resolve->size; j++)
-            configuration::history[j+huge_history_ptr+1-this_resolve->insertion_point-this_resolve->insertion_width] =
+            configuration::history()[j+rs.huge_history_ptr+1-this_resolve->insertion_point-this_resolve->insertion_width] =
                this_resolve->stuph[j];
 
          // Copy and repair the calls after the insertion.
          for (j=0; j<this_resolve->insertion_point; j++) {
             configuration *this_state =
-               &configuration::history[j+huge_history_ptr+1-
+               &configuration::history()[j+rs.huge_history_ptr+1-
                                       this_resolve->insertion_point-this_resolve->insertion_width+this_resolve->size];
-            *this_state = huge_history_save[j+huge_history_ptr+1-this_resolve->insertion_point];
+            *this_state = rs.huge_history_save[j+rs.huge_history_ptr+1-this_resolve->insertion_point];
             this_state->state.rotation += this_resolve->rotchange;
             canonicalize_rotation(&this_state->state);
 
@@ -1954,44 +3121,44 @@ uims_reply_thing ui_utils::full_resolve()
             this_state->calculate_resolve();
          }
 
-         config_history_ptr = huge_history_ptr + this_resolve->size - this_resolve->insertion_width;
+         e.m_config_history_ptr = rs.huge_history_ptr + this_resolve->size - this_resolve->insertion_width;
 
          // Show the history up to the start of the resolve, forcing a picture on the last item (unless reconciling).
 
-         display_initial_history(huge_history_ptr-this_resolve->insertion_point-this_resolve->insertion_width,
-                                 search_goal != command_reconcile);
+         display_initial_history(rs.huge_history_ptr-this_resolve->insertion_point-this_resolve->insertion_width,
+                                 e.m_search_goal != command_reconcile);
 
          // If doing a reconcile, show the begin mark.
-         if (search_goal == command_reconcile) {
+         if (e.m_search_goal == command_reconcile) {
             writestuff("------------------------------------");
             newline();
          }
 
          // Show the resolve itself, without its last item.
 
-         for (j=huge_history_ptr-this_resolve->insertion_point-this_resolve->insertion_width+1;
-              j<config_history_ptr-this_resolve->insertion_point;
+         for (j=rs.huge_history_ptr-this_resolve->insertion_point-this_resolve->insertion_width+1;
+              j<e.m_config_history_ptr-this_resolve->insertion_point;
               j++)
             write_history_line(j, false, false, file_write_no);
 
          // Show the last item of the resolve, with a forced picture.
-         write_history_line(config_history_ptr-this_resolve->insertion_point,
-                            search_goal != command_reconcile,
+         write_history_line(e.m_config_history_ptr-this_resolve->insertion_point,
+                            e.m_search_goal != command_reconcile,
                             false,
                             file_write_no);
 
          // If doing a reconcile, show the end mark.
-         if (search_goal == command_reconcile) {
+         if (e.m_search_goal == command_reconcile) {
             writestuff("------------------------------------");
             newline();
 
 #ifdef EXCESSIVE_RECONCILE_FIXUP
             // And the warnings if something significant changed.
-            if (global_status & 4) {
+            if (rs.global_status & 4) {
                writestuff("Warning -- the formation has changed.");
                newline();
             }
-            else if (global_status & 1) {
+            else if (rs.global_status & 1) {
                writestuff("Warning -- person identifiers were changed.");
                newline();
             }
@@ -1999,29 +3166,29 @@ uims_reply_thing ui_utils::full_resolve()
          }
 
          // Show whatever comes after the resolve.
-         for (j=config_history_ptr-this_resolve->insertion_point+1; j<=config_history_ptr; j++)
-            write_history_line(j, j==config_history_ptr-this_resolve->insertion_point,
+         for (j=e.m_config_history_ptr-this_resolve->insertion_point+1; j<=e.m_config_history_ptr; j++)
+            write_history_line(j, j==e.m_config_history_ptr-this_resolve->insertion_point,
                                false, file_write_no);
       }
       else if (show_resolve) {
          // We don't have any resolve to show.  Just draw the usual picture.
-         display_initial_history(huge_history_ptr, 2);
+         display_initial_history(rs.huge_history_ptr, 2);
       }
       else {
          // Don't show any resolve, because we want to display the current insertion point.
-         display_initial_history(huge_history_ptr-current_depth-current_width, 0);
+         display_initial_history(rs.huge_history_ptr-current_depth-current_width, 0);
          if (current_depth+current_width > 0) {
             writestuff("------------------------------------");
             newline();
 
             if (current_width > 0) {
-                for (j=huge_history_ptr-current_depth-current_width+1; j<=huge_history_ptr-current_depth; j++)
+                for (j=rs.huge_history_ptr-current_depth-current_width+1; j<=rs.huge_history_ptr-current_depth; j++)
                   write_history_line(j, false, false, file_write_no);
                 writestuff("------------------------------------");
                 newline();
             }
 
-            for (j=huge_history_ptr-current_depth+1; j<=huge_history_ptr; j++)
+            for (j=rs.huge_history_ptr-current_depth+1; j<=rs.huge_history_ptr; j++)
                write_history_line(j, false, false, file_write_no);
          }
 
@@ -2037,12 +3204,12 @@ uims_reply_thing ui_utils::full_resolve()
          newline();
       }
 
-      gg77->iob88.update_resolve_menu(search_goal, current_resolve_index, max_resolve_index, big_state);
+      e.m_gg77->iob88.update_resolve_menu(e.m_search_goal, current_resolve_index, max_resolve_index, big_state);
 
       show_resolve = true;
 
       for (;;) {          // We ignore any "undo" or "erase" clicks.
-         reply = gg77->iob88.get_resolve_command();
+         reply = e.m_gg77->iob88.get_resolve_command();
          if (reply.majorpart != ui_command_select ||
              (reply.minorpart != command_undo && reply.minorpart != command_erase))
             break;
@@ -2052,13 +3219,13 @@ uims_reply_thing ui_utils::full_resolve()
          switch ((resolve_command_kind) reply.minorpart) {
          case resolve_command_find_another:
             // Increase allocation if necessary.
-            if (max_resolve_index >= resolve_allocation) {
-               int new_allocation = resolve_allocation*2+5;
+            if (max_resolve_index >= rs.resolve_allocation) {
+               int new_allocation = rs.resolve_allocation*2+5;
                resolve_rec *new_list = new resolve_rec[new_allocation];
-               memcpy(new_list, all_resolves, resolve_allocation * sizeof(resolve_rec));
-               delete [] all_resolves;
-               all_resolves = new_list;
-               resolve_allocation = new_allocation;
+               memcpy(new_list, rs.all_resolves, rs.resolve_allocation * sizeof(resolve_rec));
+               delete [] rs.all_resolves;
+               rs.all_resolves = new_list;
+               rs.resolve_allocation = new_allocation;
             }
 
             find_another_resolve = true;             // Will get it next time around.
@@ -2072,7 +3239,7 @@ uims_reply_thing ui_utils::full_resolve()
                current_resolve_index--;
             break;
          case resolve_command_raise_rec_point:
-            if (current_depth+current_width < huge_history_ptr-2)
+            if (current_depth+current_width < rs.huge_history_ptr-2)
                current_depth++;
             show_resolve = false;
             break;
@@ -2082,7 +3249,7 @@ uims_reply_thing ui_utils::full_resolve()
             show_resolve = false;
             break;
          case resolve_command_grow_rec_region:
-            if (current_depth+current_width < huge_history_ptr-2)
+            if (current_depth+current_width < rs.huge_history_ptr-2)
                current_width++;
             show_resolve = false;
             break;
@@ -2092,11 +3259,11 @@ uims_reply_thing ui_utils::full_resolve()
             show_resolve = false;
             break;
          case resolve_command_abort:
-            written_history_items = -1;
-            config_history_ptr = huge_history_ptr;
+            e.m_written_history_items = -1;
+            e.m_config_history_ptr = rs.huge_history_ptr;
 
-            for (j=0; j<=config_history_ptr+1; j++)
-               configuration::history[j] = huge_history_save[j];
+            for (j=0; j<=e.m_config_history_ptr+1; j++)
+               configuration::history()[j] = rs.huge_history_save[j];
 
             goto getout;
          case resolve_command_write_this:
@@ -2118,22 +3285,209 @@ uims_reply_thing ui_utils::full_resolve()
       }
 
       // Restore history for next cycle.
-      written_history_items = -1;
-      config_history_ptr = huge_history_ptr;
+      e.m_written_history_items = -1;
+      e.m_config_history_ptr = rs.huge_history_ptr;
 
-      for (j=0; j<=config_history_ptr+1; j++)
-         configuration::history[j] = huge_history_save[j];
+      for (j=0; j<=e.m_config_history_ptr+1; j++)
+         configuration::history()[j] = rs.huge_history_save[j];
    }
 
    getout:
 
-   interactivity = interactivity_normal;
+   e.m_interactivity = interactivity_normal;
    end_pick();
    return reply;
 }
 
 
 
+// The searches that mkgetouts does.  The given setup is the whole sequence (twice,
+// so that the calls see it as the middle of one), and no one is watching.  Returns
+// how many searches worked; what they found is in all_resolves.
+
+static int unattended_search(const setup *ss, command_kind goal, int how_many)
+{
+   engine_context & e = *current_engine;
+   resolver_state & rs = the_resolver();
+   int j;
+   int count = 0;
+
+   configuration::initialize_history(start_select_exit);
+
+   for (j=1; j<=2; j++) {
+      configuration & c = configuration::history()[j];
+      c.command_root = (parse_block *) 0;
+      c.init_warnings_specific();
+      c.init_resolve();
+      c.init_centersp_specific();
+      c.state = *ss;
+      c.state_is_valid = true;
+      c.draw_pic = false;
+   }
+
+   e.m_config_history_ptr = 2;
+   e.m_written_history_items = -1;
+   e.m_search_goal = goal;
+   initialize_parse();
+   prepare_search();
+
+   if (rs.resolve_allocation < how_many) {
+      delete [] rs.all_resolves;
+      rs.resolve_allocation = how_many;
+      rs.all_resolves = new resolve_rec[rs.resolve_allocation];
+   }
+
+   for (j=0; j<=e.m_config_history_ptr+1; j++)
+      rs.huge_history_save[j] = configuration::history()[j];
+
+   rs.huge_history_ptr = e.m_config_history_ptr;
+   save_parse_state();
+   rs.avoid_list_size = 0;
+   rs.banked_count = 0;
+   clear_transpositions();
+
+   start_pick();
+
+   while (count < how_many) {
+      restore_parse_state();
+      bool search_won = inner_search(goal, &rs.all_resolves[count], 0, 0);
+
+      e.m_written_history_items = -1;
+      e.m_config_history_ptr = rs.huge_history_ptr;
+
+      for (j=0; j<=e.m_config_history_ptr+1; j++)
+         configuration::history()[j] = rs.huge_history_save[j];
+
+      if (!search_won) break;
+      count++;
+   }
+
+   e.m_interactivity = interactivity_normal;
+   end_pick();
+   return count;
+}
+
+
+// Start making a new table.  This forgets the one we loaded, so that the searches
+// don't just give back what is already there.
+
+extern void begin_getout_table()
+{
+   // What we loaded is gone, so read the file again if this level comes back.
+   if (getout_table_level >= 0) loaded_getout_tables[getout_table_level].tried = false;
+
+   clear_getout_table();
+   getout_table_level = -1;
+}
+
+
+// Replace the setup with what some random call does to it.  Returns false if we
+// couldn't find one in the usual time.
+
+extern bool random_call_from_setup(setup *ss)
+{
+   resolver_state & rs = the_resolver();
+   parse_block *mark = get_parse_block_mark();
+   bool won = unattended_search(ss, command_random_call, 1) == 1;
+
+   if (won) *ss = rs.all_resolves[0].stuph[rs.all_resolves[0].size-1].state;
+
+   release_parse_blocks_to_mark(mark);
+   return won;
+}
+
+
+// Search for getouts from the setup, and put them in the table under its key,
+// shortest first.  Returns how many went in.
+
+extern int add_getouts_from_setup(const setup *ss, int how_many)
+{
+   parse_block *mark = get_parse_block_mark();
+   int found = unattended_search(ss, command_resolve, how_many);
+   int i, j;
+
+   grow_getout_array(getout_table.entries, getout_table.entry_allocation, getout_table.entry_count+1);
+   getout_entry & e = getout_table.entries[getout_table.entry_count];
+   e.key = getout_key(ss);
+   e.first = getout_table.getout_count;
+
+   for (int size=1; size<=MAX_RESOLVE_SIZE; size++) {
+      for (i=0; i<found; i++) {
+         const resolve_rec & r = the_resolver().all_resolves[i];
+         if (r.size != size) continue;
+
+         uint32 start = getout_table.code_count;
+         grow_getout_array(getout_table.codes, getout_table.code_allocation, start+1);
+         getout_table.codes[getout_table.code_count++] = size;
+
+         for (j=0; j<size; j++) {
+            if (!encode_parse_tree(r.stuph[j].command_root)) break;
+         }
+
+         if (j < size) {
+            getout_table.code_count = start;
+            continue;
+         }
+
+         grow_getout_array(getout_table.offsets, getout_table.getout_allocation, getout_table.getout_count+2);
+         getout_table.offsets[getout_table.getout_count++] = start;
+         getout_table.offsets[getout_table.getout_count] = getout_table.code_count;
+      }
+   }
+
+   e.count = getout_table.getout_count - e.first;
+   if (e.count != 0) getout_table.entry_count++;
+
+   release_parse_blocks_to_mark(mark);
+   return e.count;
+}
+
+
+extern bool write_getout_table(const char *filename)
+{
+   uint32 i, j;
+
+   // Sort by key, and keep only the first entry that was added for each setup,
+   // in case the same one came up twice.
+
+   SORT<getout_entry, GETOUT_ENTRY_COMPARE>::heapsort(getout_table.entries, getout_table.entry_count);
+
+   for (i=0, j=0; i<getout_table.entry_count; i++) {
+      if (j == 0 || getout_table.entries[i].key != getout_table.entries[j-1].key)
+         getout_table.entries[j++] = getout_table.entries[i];
+   }
+
+   getout_table.entry_count = j;
+
+   FILE *fp = fopen(filename, "wb");
+   if (!fp) return false;
+
+   uint64_t checksum = getout_table_checksum();
+   uint32 header[GETOUT_HEADER_WORDS];
+   header[0] = GETOUT_TABLE_MAGIC;
+   header[1] = GETOUT_TABLE_VERSION;
+   header[2] = (uint32) calling_level;
+   header[3] = (uint32) checksum;
+   header[4] = (uint32) (checksum >> 32);
+   header[5] = getout_table.entry_count;
+   header[6] = getout_table.getout_count;
+   header[7] = getout_table.code_count;
+
+   // So that the last getout has an end, even if there are none.
+   grow_getout_array(getout_table.offsets, getout_table.getout_allocation, getout_table.getout_count+1);
+   getout_table.offsets[getout_table.getout_count] = getout_table.code_count;
+
+   bool ok =
+      write_getout_words(fp, header, GETOUT_HEADER_WORDS) &&
+      write_getout_entries(fp, getout_table.entries, getout_table.entry_count) &&
+      write_getout_words(fp, getout_table.offsets, getout_table.getout_count+1) &&
+      write_getout_words(fp, getout_table.codes, getout_table.code_count);
+
+   if (fclose(fp)) ok = false;
+   return ok;
+}
+
+
 // Create a string representing the search state.  Search_goal indicates which user command
 // is being performed.  If there is no current solution,
 // then M and N are both 0.  If there is a current
@@ -2147,6 +3501,7 @@ void create_resolve_menu_title(
    resolver_display_state state,
    char *title)
 {
+   resolver_state & rs = the_resolver();
    char junk[MAX_TEXT_LINE_LENGTH];
    char *titleptr = title;
    if (goal > command_create_any_lines) goal = command_create_any_lines;
@@ -2169,6 +3524,13 @@ void create_resolve_menu_title(
          string_copy(&titleptr, "failed");
          break;
    }
+
+   if (current_engine->m_ui_options.resolve_statistics && rs.seconds > 0.0 && rs.tries != 0) {
+      sprintf(junk, "  [%.0f tries/sec, %d%% from table]",
+              (double) rs.tries / rs.seconds,
+              rs.lookups ? (int) (rs.hits * 100 / rs.lookups) : 0);
+      string_copy(&titleptr, junk);
+   }
 }
 
 
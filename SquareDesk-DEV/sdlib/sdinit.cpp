@@ -143,9 +143,10 @@ bool iterate_over_sel_dir_num(
    bool enable_direction_iteration,
    bool enable_number_iteration)
 {
+   engine_context & e = *current_engine;
    // Try different selectors first.
 
-   if (selector_used && enable_selector_iteration) {
+   if (e.m_selector_used && enable_selector_iteration) {
       // This call used a selector and didn't like it.  Try again with
       // a different selector, until we run out of ideas.
       switch (selector_for_initialize) {
@@ -181,7 +182,7 @@ bool iterate_over_sel_dir_num(
 
    // Now try a different direction.
 
-   if (direction_used && enable_direction_iteration) {
+   if (e.m_direction_used && enable_direction_iteration) {
       // This call used a direction and didn't like it.  Try again with
       // a different direction, until we run out of ideas.
       switch (direction_for_initialize) {
@@ -197,7 +198,7 @@ bool iterate_over_sel_dir_num(
    // consumes numbers, and the wildcard matching has not filled in all
    // required numbers.
 
-   if (number_used && enable_number_iteration) {
+   if (e.m_number_used && enable_number_iteration) {
 
       /* Try again with a different number, until we run out of ideas. */
 
@@ -223,7 +224,8 @@ bool iterate_over_sel_dir_num(
 
 static void test_starting_setup(call_list_kind cl, const setup & test_setup)
 {
-   gg77->iob88.init_step(do_tick, 2);
+   engine_context & e = *current_engine;
+   e.m_gg77->iob88.init_step(do_tick, 2);
 
    call_index = -1;
    global_callcount = 0;
@@ -254,12 +256,12 @@ static void test_starting_setup(call_list_kind cl, const setup & test_setup)
    start_sel_dir_num_iterator();
  try_another_selector:
 
-   selector_used = false;
-   direction_used = false;
-   number_used = false;
-   mandatory_call_used = false;
+   e.m_selector_used = false;
+   e.m_direction_used = false;
+   e.m_number_used = false;
+   e.m_mandatory_call_used = false;
 
-   config_history_ptr = 1;
+   e.m_config_history_ptr = 1;
 
    configuration::current_config().init_centersp_specific();
    configuration::current_config().state = test_setup;
@@ -306,7 +308,7 @@ static void test_starting_setup(call_list_kind cl, const setup & test_setup)
       if (deposit_call(test_call, &null_options)) {
          // The problem may be just that the current number is
          // inconsistent with the call's "odd number only" requirement.
-         number_used = true;
+         e.m_number_used = true;
          if (iterate_over_sel_dir_num(true, true, true)) goto try_another_selector;
          goto try_again;
       }
@@ -316,7 +318,7 @@ static void test_starting_setup(call_list_kind cl, const setup & test_setup)
 
       // A call failed.  If the call had some mandatory substitution, pass it anyway.
 
-      if (mandatory_call_used) goto accept;
+      if (e.m_mandatory_call_used) goto accept;
 
       // Or a bad choice of selector or number may be the cause.
       // Try different selectors first.
@@ -616,10 +618,11 @@ static void read_fullword()
 
 static void database_error_exit(const char *message)
 {
+   engine_context & e = *current_engine;
    if (call_root)
-      gg77->iob88.fatal_error_exit(1, message, call_root->name);
+      e.m_gg77->iob88.fatal_error_exit(1, message, call_root->name);
    else
-      gg77->iob88.fatal_error_exit(1, message);
+      e.m_gg77->iob88.fatal_error_exit(1, message);
 }
 
 
@@ -1153,7 +1156,7 @@ extern bool get_first_session_line()
       return true;
 
    // Or if the file didn't exist, or we are in diagnostic mode.
-   if (!init_file || ui_options.diagnostic_mode) return true;
+   if (!init_file || current_engine->m_ui_options.diagnostic_mode) return true;
 
    // Search for the "[Sessions]" indicator.
 
@@ -1193,6 +1196,7 @@ extern bool get_next_session_line(char *dest)
 
 extern void prepare_to_read_menus()
 {
+   engine_context & e = *current_engine;
    // These "ifs" should never get executed.  Compilers will probably optimize
    // them away.
 
@@ -1203,23 +1207,23 @@ extern void prepare_to_read_menus()
    // align stuff from the binary database into the person record.
 
    if ((int) NROLL_BIT < (int) DBSLIDEROLL_BIT)
-      gg77->iob88.fatal_error_exit(1, "Constants not consistent", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Constants not consistent", "program has been compiled incorrectly.");
    else if ((UINT32_C(508205) << 12) != UINT32_C(2081607680))
-      gg77->iob88.fatal_error_exit(1, "Arithmetic is less than 32 bits", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Arithmetic is less than 32 bits", "program has been compiled incorrectly.");
    else if (l_nonexistent_concept > 15)
-      gg77->iob88.fatal_error_exit(1, "Too many levels", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Too many levels", "program has been compiled incorrectly.");
    else if (NUM_QUALIFIERS > 253)
-      gg77->iob88.fatal_error_exit(1, "Insufficient qualifier space", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Insufficient qualifier space", "program has been compiled incorrectly.");
    else if (NUM_SETUP_KINDS > 254)  // Need to pack setups in the MAPCODE and HETERO_MAPCODE mechanism.
-      gg77->iob88.fatal_error_exit(1, "Insufficient setupkind space", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Insufficient setupkind space", "program has been compiled incorrectly.");
    else if (NUM_PLAINMAP_KINDS > 252)
-      gg77->iob88.fatal_error_exit(1, "Insufficient mapkind space", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Insufficient mapkind space", "program has been compiled incorrectly.");
    else if (sizeof(uint32) > sizeof(void *)) // Need this because of horrible cheating we do with main_call_lists.
-      gg77->iob88.fatal_error_exit(1, "Incorrect pointer size", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Incorrect pointer size", "program has been compiled incorrectly.");
    else if (UINT16_C(0xFFFFFFFF) != 0xFFFF)  // Must have UINT16_C convert to uint16_t, chopping bits as needed.
-      gg77->iob88.fatal_error_exit(1, "Incorrect type coercion 1", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Incorrect type coercion 1", "program has been compiled incorrectly.");
    else if (UINT16_C(~0) != 0xFFFF)          // Do it this way also.
-      gg77->iob88.fatal_error_exit(1, "Incorrect type coercion 2", "program has been compiled incorrectly.");
+      e.m_gg77->iob88.fatal_error_exit(1, "Incorrect type coercion 2", "program has been compiled incorrectly.");
 
    // We need to take away the "zig-zag" directions if the level is below A2, and "the music" if below C3A.
 
@@ -1442,6 +1446,7 @@ static int write_back_session_line(FILE *wfile)
 
 static void rewrite_init_file()
 {
+   engine_context & e = *current_engine;
    if (session_index != 0 || rewrite_with_new_style_filename) {
       char line[MAX_FILENAME_LENGTH];
       char errmsg[MAX_TEXT_LINE_LENGTH];
@@ -1457,19 +1462,19 @@ static void rewrite_init_file()
                  MAX_TEXT_LINE_LENGTH);
          strncat(errmsg, get_errstring(), MAX_FILENAME_LENGTH-141);
          strncat(errmsg, ".", MAX_FILENAME_LENGTH);
-         gg77->iob88.serious_error_print(errmsg);
+         e.m_gg77->iob88.serious_error_print(errmsg);
       }
       else {
          if (!(rfile = fopen(SESSION2_FILENAME, "r"))) {
             strncpy(errmsg, "Failed to open '" SESSION2_FILENAME "'.",
                     MAX_TEXT_LINE_LENGTH);
-            gg77->iob88.serious_error_print(errmsg);
+            e.m_gg77->iob88.serious_error_print(errmsg);
          }
          else {
             if (!(wfile = fopen(SESSION_FILENAME, "w"))) {
                strncpy(errmsg, "Failed to open '" SESSION_FILENAME "'.",
                        MAX_TEXT_LINE_LENGTH);
-               gg77->iob88.serious_error_print(errmsg);
+               e.m_gg77->iob88.serious_error_print(errmsg);
             }
             else {
                bool more_stuff = false;
@@ -1561,7 +1566,7 @@ static void rewrite_init_file()
 
                strncpy(errmsg, "Failed to write to '" SESSION_FILENAME "'.",
                        MAX_TEXT_LINE_LENGTH);
-               gg77->iob88.serious_error_print(errmsg);
+               e.m_gg77->iob88.serious_error_print(errmsg);
 
             copy_done:
 
@@ -1618,7 +1623,7 @@ extern void general_final_exit(int code)
    // If we had just been printing command-line help, "ttu_initialize"
    // will not have happened.
 
-   gg77->iob88.terminate(code);
+   current_engine->m_gg77->iob88.terminate(code);
 }
 
 
@@ -1655,6 +1660,7 @@ static void create_new_tagger(int tagclass, call_with_name *new_tagger)
 
 static void build_database_1(abridge_mode_t abridge_mode)
 {
+   engine_context & e = *current_engine;
    int i, char_count;
 
    for (i=0 ; i<NUM_TAGGER_CLASSES ; i++) {
@@ -1748,7 +1754,7 @@ static void build_database_1(abridge_mode_t abridge_mode)
       //     even if the indicated level is higher than that.
 
       if (this_calls_level <= calling_level &&
-          (!ui_options.no_c3x || this_calls_level != l_c3x) &&
+          (!e.m_ui_options.no_c3x || this_calls_level != l_c3x) &&
           (abridge_mode != abridge_mode_writing_only || this_calls_level == calling_level)) {
 
          // Process tag base calls specially.
@@ -1795,7 +1801,7 @@ static void build_database_1(abridge_mode_t abridge_mode)
       if (!base_calls[i]) {
          char msg [50];
          sprintf(msg, "%d", i);
-         gg77->iob88.fatal_error_exit(1, "Call didn't identify self", msg);
+         e.m_gg77->iob88.fatal_error_exit(1, "Call didn't identify self", msg);
       }
    }
 
@@ -1993,6 +1999,7 @@ void start_stats_file_from_GLOB_stats_filename()
 
 bool open_session(int argc, char **argv)
 {
+   engine_context & e = *current_engine;
    int i, j;
    uint32 uj;
    int argno;
@@ -2063,7 +2070,7 @@ bool open_session(int argc, char **argv)
    }
 
    // This lets the user interface intercept command line arguments that it is interested in.
-   gg77->iob88.process_command_line(&nargs, &args);
+   e.m_gg77->iob88.process_command_line(&nargs, &args);
 
    glob_abridge_mode = abridge_mode_none;
    calling_level = l_nonexistent_concept;    /* Mark it uninitialized. */
@@ -2103,104 +2110,113 @@ bool open_session(int argc, char **argv)
          }
          else if (strcmp(&args[argno][1], "sequence_num") == 0) {
             if (argno+1 < nargs) {
-               if (sscanf(args[argno+1], "%d", &ui_options.sequence_num_override) != 1)
-                  gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
+               if (sscanf(args[argno+1], "%d", &e.m_ui_options.sequence_num_override) != 1)
+                  e.m_gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
             }
          }
          else if (strcmp(&args[argno][1], "session") == 0) {
             if (argno+1 < nargs) {
-               if (sscanf(args[argno+1], "%d", &ui_options.force_session) != 1)
-                  gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
+               if (sscanf(args[argno+1], "%d", &e.m_ui_options.force_session) != 1)
+                  e.m_gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
             }
          }
          else if (strcmp(&args[argno][1], "resolve_test") == 0) {
             if (argno+1 < nargs) {
-               if (sscanf(args[argno+1], "%d", &ui_options.resolve_test_minutes) != 1)
-                  gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
+               if (sscanf(args[argno+1], "%d", &e.m_ui_options.resolve_test_minutes) != 1)
+                  e.m_gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
+            }
+         }
+         else if (strcmp(&args[argno][1], "resolve_threads") == 0) {
+            if (argno+1 < nargs) {
+               if (sscanf(args[argno+1], "%d", &e.m_ui_options.resolve_threads) != 1 ||
+                   e.m_ui_options.resolve_threads < 0)
+                  e.m_gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
             }
          }
          else if (strcmp(&args[argno][1], "print_length") == 0) {
             if (argno+1 < nargs) {
-               if (sscanf(args[argno+1], "%d", &ui_options.max_print_length) != 1)
-                  gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
+               if (sscanf(args[argno+1], "%d", &e.m_ui_options.max_print_length) != 1)
+                  e.m_gg77->iob88.bad_argument("Bad number", args[argno+1], 0);
             }
          }
          else if (strcmp(&args[argno][1], "delete_abridge") == 0)
             { glob_abridge_mode = abridge_mode_deleting_abridge; continue; }
          else if (strcmp(&args[argno][1], "no_c3x") == 0)
-            { ui_options.no_c3x = true; continue; }
+            { e.m_ui_options.no_c3x = true; continue; }
          else if (strcmp(&args[argno][1], "no_intensify") == 0)
-            { ui_options.no_intensify = true; continue; }
+            { e.m_ui_options.no_intensify = true; continue; }
          else if (strcmp(&args[argno][1], "reverse_video") == 0)
-            { ui_options.reverse_video = true; continue; }
+            { e.m_ui_options.reverse_video = true; continue; }
          else if (strcmp(&args[argno][1], "normal_video") == 0)
-            { ui_options.reverse_video = false; continue; }
+            { e.m_ui_options.reverse_video = false; continue; }
          else if (strcmp(&args[argno][1], "pastel_color") == 0)
-            { ui_options.pastel_color = true; continue; }
+            { e.m_ui_options.pastel_color = true; continue; }
          else if (strcmp(&args[argno][1], "bold_color") == 0)
-            { ui_options.pastel_color = false; continue; }
+            { e.m_ui_options.pastel_color = false; continue; }
          else if (strcmp(&args[argno][1], "no_color") == 0)
-            { ui_options.color_scheme = no_color; continue; }
+            { e.m_ui_options.color_scheme = no_color; continue; }
          else if (strcmp(&args[argno][1], "use_magenta") == 0)
-            { ui_options.use_magenta = true; continue; }
+            { e.m_ui_options.use_magenta = true; continue; }
          else if (strcmp(&args[argno][1], "use_cyan") == 0)
-            { ui_options.use_cyan = true; continue; }
+            { e.m_ui_options.use_cyan = true; continue; }
          else if (strcmp(&args[argno][1], "hide_couple_numbers") == 0)
-            { ui_options.hide_glyph_numbers = true; ui_options.color_scheme = color_by_couple_random; continue; }
+            { e.m_ui_options.hide_glyph_numbers = true; e.m_ui_options.color_scheme = color_by_couple_random; continue; }
          else if (strcmp(&args[argno][1], "color_by_couple") == 0)
-            { ui_options.color_scheme = color_by_couple; continue; }
+            { e.m_ui_options.color_scheme = color_by_couple; continue; }
          else if (strcmp(&args[argno][1], "color_by_couple_rgyb") == 0)
-            { ui_options.color_scheme = color_by_couple_rgyb; continue; }
+            { e.m_ui_options.color_scheme = color_by_couple_rgyb; continue; }
          else if (strcmp(&args[argno][1], "color_by_couple_ygrb") == 0)
-            { ui_options.color_scheme = color_by_couple_ygrb; continue; }
+            { e.m_ui_options.color_scheme = color_by_couple_ygrb; continue; }
          else if (strcmp(&args[argno][1], "color_by_corner") == 0)
-            { ui_options.color_scheme = color_by_corner; continue; }
+            { e.m_ui_options.color_scheme = color_by_corner; continue; }
          else if (strcmp(&args[argno][1], "no_sound") == 0)
-            { ui_options.no_sound = true; continue; }
+            { e.m_ui_options.no_sound = true; continue; }
          else if (strcmp(&args[argno][1], "tab_changes_focus") == 0)
-            { ui_options.tab_changes_focus = true; continue; }
+            { e.m_ui_options.tab_changes_focus = true; continue; }
          else if (strcmp(&args[argno][1], "keep_all_pictures") == 0)
-            { ui_options.keep_all_pictures = true; continue; }
+            { e.m_ui_options.keep_all_pictures = true; continue; }
          else if (strcmp(&args[argno][1], "single_click") == 0)
-            { ui_options.accept_single_click = true; continue; }
+            { e.m_ui_options.accept_single_click = true; continue; }
          else if (strcmp(&args[argno][1], "no_checkers") == 0)
-            { if (ui_options.no_graphics != 2) ui_options.no_graphics = 1; continue; }
+            { if (e.m_ui_options.no_graphics != 2) e.m_ui_options.no_graphics = 1; continue; }
          else if (strcmp(&args[argno][1], "no_graphics") == 0)
-            { ui_options.no_graphics = 2; continue; }
+            { e.m_ui_options.no_graphics = 2; continue; }
          else if (strcmp(&args[argno][1], "diagnostic") == 0)
-            { ui_options.diagnostic_mode = true; continue; }
+            { e.m_ui_options.diagnostic_mode = true; continue; }
+         else if (strcmp(&args[argno][1], "resolve_statistics") == 0)
+            { e.m_ui_options.resolve_statistics = true; continue; }
          else if (strcmp(&args[argno][1], "singlespace") == 0)
-            { ui_options.singlespace_mode = true; continue; }
+            { e.m_ui_options.singlespace_mode = true; continue; }
          else if (strcmp(&args[argno][1], "no_warnings") == 0)
-            { ui_options.nowarn_mode = true; continue; }
+            { e.m_ui_options.nowarn_mode = true; continue; }
          else if (strcmp(&args[argno][1], "concept_levels") == 0)
-            { allowing_all_concepts = true; continue; }
+            { e.m_allowing_all_concepts = true; continue; }
          else if (strcmp(&args[argno][1], "minigrand_getouts") == 0)
-            { allowing_minigrand = true; continue; }
+            { e.m_allowing_minigrand = true; continue; }
          else if (strcmp(&args[argno][1], "bend_line_home_getouts") == 0)
-            { allow_bend_home_getout = true; continue; }
+            { e.m_allow_bend_home_getout = true; continue; }
          else if (strcmp(&args[argno][1], "warn_on_overflow") == 0)
-            { enforce_overcast_warning = true; continue; }
+            { e.m_enforce_overcast_warning = true; continue; }
          else if (strcmp(&args[argno][1], "active_phantoms") == 0)
-            { using_active_phantoms = true; continue; }
+            { e.m_using_active_phantoms = true; continue; }
          else if (strcmp(&args[argno][1], "discard_after_error") == 0)
-            { retain_after_error = false; continue; }
+            { e.m_retain_after_error = false; continue; }
          else if (strcmp(&args[argno][1], "retain_after_error") == 0)
-            { retain_after_error = true; continue; }
+            { e.m_retain_after_error = true; continue; }
          else if (strcmp(&args[argno][1], "new_style_filename") == 0)
             { filename_strings = new_filename_strings; continue; }
          else if (strcmp(&args[argno][1], "old_style_filename") == 0)
             { filename_strings = old_filename_strings; continue; }
          else
-            gg77->iob88.bad_argument("Unknown flag", args[argno], 0);
+            e.m_gg77->iob88.bad_argument("Unknown flag", args[argno], 0);
 
          argno++;
          if (argno >= nargs)
-            gg77->iob88.bad_argument("This flag must be followed by a number or file name",
+            e.m_gg77->iob88.bad_argument("This flag must be followed by a number or file name",
                              args[argno-1], 0);
       }
       else if (!parse_level(args[argno])) {
-         gg77->iob88.bad_argument("Unknown calling level argument", args[argno],
+         e.m_gg77->iob88.bad_argument("Unknown calling level argument", args[argno],
             "Known calling levels: m, p, a1, a2, c1, c2, c3a, c3, c3x, c4a, c4, or c4x.");
       }
    }
@@ -2232,7 +2248,7 @@ bool open_session(int argc, char **argv)
 
    // This could return true, either with session_index<0 for deletion,
    // or because of error, to get immediate exit.
-   if (gg77->iob88.init_step(get_session_info, 0)) {
+   if (e.m_gg77->iob88.init_step(get_session_info, 0)) {
       close_init_file();
       return true;
    }
@@ -2241,7 +2257,7 @@ bool open_session(int argc, char **argv)
 
    color_index_list = couple_colors_rgby;   // Default = color_by_couple.
 
-   switch (ui_options.color_scheme) {
+   switch (e.m_ui_options.color_scheme) {
    case color_by_gender: case no_color:
       // It doesn't really matter if "no_color" is selected,
       // as long as we put in something.  The Windows interface
@@ -2266,7 +2282,7 @@ bool open_session(int argc, char **argv)
    // If the background is white, bright yellow won't be visible.  Change it to
    // dark yellow.  (If reverse_video or no_intensify, the background is black
    // or grey, and bright yellow is OK.)
-   if (!ui_options.reverse_video && !ui_options.no_intensify) {
+   if (!e.m_ui_options.reverse_video && !e.m_ui_options.no_intensify) {
       for (i=0 ; i<8 ; i++) {
          if (color_index_list[i] == 4) color_index_list[i] = 1;
       }
@@ -2275,25 +2291,25 @@ bool open_session(int argc, char **argv)
    // If color_by_gender, pastel applies to both red and blue.
    // Otherwise, we need the flags "use_cyan" or "use_magenta".
 
-   if (ui_options.use_cyan ||
-       (ui_options.pastel_color && ui_options.color_scheme == color_by_gender)) {
+   if (e.m_ui_options.use_cyan ||
+       (e.m_ui_options.pastel_color && e.m_ui_options.color_scheme == color_by_gender)) {
       for (i=0 ; i<8 ; i++) {
          if (color_index_list[i] == 5) color_index_list[i] = 7;
       }
    }
 
-   if (ui_options.use_magenta ||
-       (ui_options.pastel_color && ui_options.color_scheme == color_by_gender)) {
+   if (e.m_ui_options.use_magenta ||
+       (e.m_ui_options.pastel_color && e.m_ui_options.color_scheme == color_by_gender)) {
       for (i=0 ; i<8 ; i++) {
          if (color_index_list[i] == 2) color_index_list[i] = 6;
       }
    }
 
-   if (ui_options.sequence_num_override > 0)
-      sequence_number = ui_options.sequence_num_override;
+   if (e.m_ui_options.sequence_num_override > 0)
+      sequence_number = e.m_ui_options.sequence_num_override;
 
    if (calling_level == l_nonexistent_concept)
-      gg77->iob88.init_step(final_level_query, 0);
+      e.m_gg77->iob88.init_step(final_level_query, 0);
 
    if (new_outfile_string)
       install_outfile_string(new_outfile_string);
@@ -2311,7 +2327,7 @@ bool open_session(int argc, char **argv)
    for (i=0; concept_descriptor_table[i].kind != marker_end_of_list; i++) {
       if (concept_descriptor_table[i].useful != UC_none) {
          if (useful_concept_indices[concept_descriptor_table[i].useful] >= 0)
-            gg77->iob88.fatal_error_exit(1, "Concept registered twice.");
+            e.m_gg77->iob88.fatal_error_exit(1, "Concept registered twice.");
 
          useful_concept_indices[concept_descriptor_table[i].useful] = i;
       }
@@ -2319,12 +2335,12 @@ bool open_session(int argc, char **argv)
 
    for (i = 1 ; i < UC_extent ; i++) {
      if (useful_concept_indices[i] < 0)
-        gg77->iob88.fatal_error_exit(1, "Concept failed to register.");
+        e.m_gg77->iob88.fatal_error_exit(1, "Concept failed to register.");
    }
 
    starting_sequence_number = sequence_number;
 
-   gg77->iob88.init_step(init_database1, 0);
+   e.m_gg77->iob88.init_step(init_database1, 0);
 
    prepare_to_read_menus();
 
@@ -2343,7 +2359,7 @@ bool open_session(int argc, char **argv)
       database_input_files[1] = fopen(abridge_filename, "w");
 
       if (!database_input_files[1])
-         gg77->iob88.fatal_error_exit(1, "Can't open abridgement file", abridge_filename);
+         e.m_gg77->iob88.fatal_error_exit(1, "Can't open abridgement file", abridge_filename);
    }
 
    {
@@ -2361,17 +2377,17 @@ bool open_session(int argc, char **argv)
       abridge_file = database_input_files[1];
 
       if (!database_file)
-         gg77->iob88.fatal_error_exit(1, "Can't open database file.");
+         e.m_gg77->iob88.fatal_error_exit(1, "Can't open database file.");
 
       if (glob_abridge_mode == abridge_mode_abridging && !abridge_file)
-         gg77->iob88.fatal_error_exit(1, "Can't open abridgement file", abridge_filename);
+         e.m_gg77->iob88.fatal_error_exit(1, "Can't open abridgement file", abridge_filename);
 
       char session_error_msg1[200], session_error_msg2[200];
       session_error_msg1[0] = 0;
       session_error_msg2[0] = 0;
 
       if (read_database_header(session_error_msg1, session_error_msg2))
-         gg77->iob88.fatal_error_exit(1, session_error_msg1, session_error_msg2);
+         e.m_gg77->iob88.fatal_error_exit(1, session_error_msg1, session_error_msg2);
 
       // This actually reads the calls database file and creates the
       // "any" menu.  It calls init_step(init_calibrate_tick), which calibrates
@@ -2511,9 +2527,9 @@ bool open_session(int argc, char **argv)
 
       initialize_sdlib();
 
-      gg77->iob88.init_step(init_database2, 0);
-      gg77->iob88.init_step(calibrate_tick, TICK_TOTAL);
-      gg77->iob88.init_step(do_tick, 2);
+      e.m_gg77->iob88.init_step(init_database2, 0);
+      e.m_gg77->iob88.init_step(calibrate_tick, TICK_TOTAL);
+      e.m_gg77->iob88.init_step(do_tick, 2);
 
       SORT<call_with_name *, DBCOMPARE>::heapsort(main_call_lists[call_list_any], local_callcount);
 
@@ -2525,7 +2541,7 @@ bool open_session(int argc, char **argv)
       //    display in the menus (no "@" signs) and initialize the menus with the
       //    cleaned-up and subsetted text.
 
-      gg77->iob88.init_step(do_tick, 1);
+      e.m_gg77->iob88.init_step(do_tick, 1);
 
       // Do special stuff if we are reading or writing an abridgement file.
 
@@ -2557,7 +2573,7 @@ bool open_session(int argc, char **argv)
             }
 
             if (fclose(abridge_file))
-               gg77->iob88.fatal_error_exit(1, "Can't close abridgement file");
+               e.m_gg77->iob88.fatal_error_exit(1, "Can't close abridgement file");
          }
          else {      // Writing a list of some kind.
             for (i=0; i<number_of_calls[call_list_any]; i++) {
@@ -2566,9 +2582,9 @@ bool open_session(int argc, char **argv)
             }
 
             if (fclose(abridge_file))
-               gg77->iob88.fatal_error_exit(1, "Can't close abridgement file");
+               e.m_gg77->iob88.fatal_error_exit(1, "Can't close abridgement file");
 
-            gg77->iob88.init_step(tick_end, 0);
+            e.m_gg77->iob88.init_step(tick_end, 0);
 
             // That's all!
             close_init_file();
@@ -2583,8 +2599,8 @@ bool open_session(int argc, char **argv)
       //    subsetted text.
 
       // This is the universal menu.
-      gg77->iob88.create_menu(call_list_any);
-      gg77->iob88.init_step(do_tick, 1);
+      e.m_gg77->iob88.create_menu(call_list_any);
+      e.m_gg77->iob88.init_step(do_tick, 1);
 
       // We are going to try to use the cache file, if we have one.
       // The cache file mechanism will check file sizes and creation
@@ -2815,7 +2831,7 @@ bool open_session(int argc, char **argv)
          // We have to do this downward, in case the pointers are bigger than uint32.
          for (i=number_of_calls[cl]-1; i >= 0 ; i--)
             main_call_lists[cl][i] = main_call_lists[call_list_any][((uint32 *) main_call_lists[cl])[i]];
-         gg77->iob88.create_menu(cl);
+         e.m_gg77->iob88.create_menu(cl);
       }
    }
 
@@ -2828,9 +2844,12 @@ bool open_session(int argc, char **argv)
    main_call_lists[call_list_empty] = empty_menu;
    number_of_calls[call_list_empty] = 0;
 
-   gg77->iob88.init_step(tick_end, 0);
+   e.m_gg77->iob88.init_step(tick_end, 0);
    matcher_initialize();
 
+   // Get the getouts that mkgetouts found ahead of time, if it has been run for this level.
+   load_getout_table();
+
    // Read in the "stats" file.
    // If the fopen fails, leave it at zero.  We won't read, but we will write it back with fresh data.
    // If the given name doesn't have a suffix, use ".txt".
@@ -2878,27 +2897,27 @@ bool open_session(int argc, char **argv)
       }
 
       if (fclose(stats_file))
-         gg77->iob88.fatal_error_exit(1, "Can't close stats file");
+         e.m_gg77->iob88.fatal_error_exit(1, "Can't close stats file");
    }
 
    // Make the status bar show that we are processing accelerators.
-   gg77->iob88.init_step(do_accelerator, 0);
+   e.m_gg77->iob88.init_step(do_accelerator, 0);
 
    {
-      bool save_allow = allowing_all_concepts;
-      allowing_all_concepts = true;
+      bool save_allow = e.m_allowing_all_concepts;
+      e.m_allowing_all_concepts = true;
 
       // Process the keybindings for user-definable calls, concepts, and commands.
 
       if (find_init_file_region("[Accelerators]", 14)) {
          char q[MAX_FILENAME_LENGTH];
          while (get_accelerator_line(q))
-            gg77->matcher_p->do_accelerator_spec(q, true);
+            e.m_gg77->matcher_p->do_accelerator_spec(q, true);
       }
       else {
          const Cstring *q;
          for (q = concept_key_table ; *q ; q++)
-            gg77->matcher_p->do_accelerator_spec(*q, true);
+            e.m_gg77->matcher_p->do_accelerator_spec(*q, true);
       }
 
       // Now do the abbreviations.
@@ -2906,14 +2925,14 @@ bool open_session(int argc, char **argv)
       if (find_init_file_region("[Abbreviations]", 15)) {
          char q[MAX_FILENAME_LENGTH];
          while (get_accelerator_line(q))
-            gg77->matcher_p->do_accelerator_spec(q, false);
+            e.m_gg77->matcher_p->do_accelerator_spec(q, false);
       }
 
-      allowing_all_concepts = save_allow;
+      e.m_allowing_all_concepts = save_allow;
    }
 
    close_init_file();
-   gg77->iob88.final_initialize();
+   e.m_gg77->iob88.final_initialize();
    return false;
 }
 
@@ -64,6 +64,7 @@ const tglmap::map *tglmap::ptrtable[tgl_ENUM_EXTENT];
 
 void tglmap::initialize()
 {
+   engine_context & e = *current_engine;
    int i;
    const map *tabp;
 
@@ -71,13 +72,13 @@ void tglmap::initialize()
 
    for (tabp = init_table ; tabp->mykey != tgl0 ; tabp++) {
       if (ptrtable[tabp->mykey])
-         gg77->iob88.fatal_error_exit(1, "Tgl_map table initialization failed", "dup");
+         e.m_gg77->iob88.fatal_error_exit(1, "Tgl_map table initialization failed", "dup");
       ptrtable[tabp->mykey] = tabp;
    }
 
    for (i=tgl0+1 ; i<tgl_ENUM_EXTENT ; i++) {
       if (!ptrtable[i])
-         gg77->iob88.fatal_error_exit(1, "Tgl_map table initialization failed", "undef");
+         e.m_gg77->iob88.fatal_error_exit(1, "Tgl_map table initialization failed", "undef");
    }
 }
 
@@ -114,7 +115,7 @@ void map::initialize()
 
    for (unsigned int tab1i = 0 ; tab1i < NUM_SPECMAP_KINDS ; tab1i++) {
       if (spec_map_table[tab1i].code != tab1i)
-         gg77->iob88.fatal_error_exit(1, "Special map table initialization failed");
+         current_engine->m_gg77->iob88.fatal_error_exit(1, "Special map table initialization failed");
    }
 
    for (map_thing *tab2p = map_init_table ; tab2p->inner_kind != nothing ; tab2p++) {
@@ -1879,6 +1880,7 @@ extern void do_phantom_2x4_concept(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    ss->clear_all_overcasts();
 
    // This concept is "standard", which means that it can look at global_tbonetest
@@ -1887,7 +1889,7 @@ extern void do_phantom_2x4_concept(
 
    int clw = parseptr->concept->arg2 & 3;
    int linesp = clw & 1;
-   int rot = (global_tbonetest ^ linesp ^ 1) & 1;
+   int rot = (e.m_global_tbonetest ^ linesp ^ 1) & 1;
    uint32 map_code;
 
    if ((ss->cmd.cmd_misc2_flags & CMD_MISC2__MYSTIFY_SPLIT) &&
@@ -1909,14 +1911,14 @@ extern void do_phantom_2x4_concept(
 
    switch (ss->kind) {
    case s1x16:
-      if ((global_tbonetest & 011) == 011)
+      if ((e.m_global_tbonetest & 011) == 011)
          fail("Can't do this from T-bone setup, try using \"standard\".");
 
       if (linesp) {
-         if (global_tbonetest & 1) fail("There are no lines of 4 here.");
+         if (e.m_global_tbonetest & 1) fail("There are no lines of 4 here.");
       }
       else {
-         if (global_tbonetest & 010) fail("There are no columns of 4 here.");
+         if (e.m_global_tbonetest & 010) fail("There are no columns of 4 here.");
       }
 
       rot = 0;
@@ -1936,7 +1938,7 @@ extern void do_phantom_2x4_concept(
 
       if (parseptr->concept->arg3 == MPKIND__STAG &&
           parseptr->concept->arg1 == phantest_only_one) {
-         if (global_livemask != 0x2D2D && global_livemask != 0xD2D2) {
+         if (e.m_global_livemask != 0x2D2D && e.m_global_livemask != 0xD2D2) {
             warn(warn__not_on_block_spots);
             distorted_move(ss, parseptr, disttest_any, parseptr->concept->arg2, result);
             result->clear_all_overcasts();
@@ -1944,7 +1946,7 @@ extern void do_phantom_2x4_concept(
          }
       }
 
-      if ((global_tbonetest & 011) == 011) {
+      if ((e.m_global_tbonetest & 011) == 011) {
          // People are T-boned!  This is messy.
          phantom_2x4_move(ss,
                           linesp,
@@ -1964,13 +1966,13 @@ extern void do_phantom_2x4_concept(
 
       if (parseptr->concept->arg3 == MPKIND__SPLIT) {
          if (rot) {
-            if (global_tbonetest & 1) fail("There are no split phantom lines here.");
+            if (e.m_global_tbonetest & 1) fail("There are no split phantom lines here.");
             else                      fail("There are no split phantom columns here.");
          }
 
-         if      (global_livemask == 07474)
+         if      (e.m_global_livemask == 07474)
             map_code = MAPCODE(s2x4,2,MPKIND__OFFS_R_HALF,1);
-         else if (global_livemask == 01717)
+         else if (e.m_global_livemask == 01717)
             map_code = MAPCODE(s2x4,2,MPKIND__OFFS_L_HALF,1);
          else fail("Must have a parallelogram for this.");
 
@@ -2860,6 +2862,7 @@ extern void distorted_move(
    uint32 keys,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    ss->clear_all_overcasts();
 
    // Incoming args are as follows:
@@ -2898,7 +2901,7 @@ extern void distorted_move(
    mpkind mk;
    uint32 map_code = ~0U;
    int rotate_back = 0;
-   uint32 livemask = global_livemask;
+   uint32 livemask = e.m_global_livemask;
    uint32 linesp = keys & 7;
    distort_key distkey = (distort_key) (keys / 16);
    bool zlines = true;
@@ -2914,10 +2917,10 @@ extern void distorted_move(
           ss->kind == s2x4 &&
           distkey == DISTORTKEY_OFFSCLW_SINGULAR) {
          if (linesp & 1) {
-            if (global_tbonetest & 1) fail("There is no offset line here.");
+            if (e.m_global_tbonetest & 1) fail("There is no offset line here.");
          }
          else {
-            if (global_tbonetest & 010) fail("There is no offset column here.");
+            if (e.m_global_tbonetest & 010) fail("There is no offset column here.");
          }
 
          if (livemask == 0x33)
@@ -2943,7 +2946,7 @@ extern void distorted_move(
          /* If any people are T-boned, we must invoke the other method and hope for the best.
             ***** We will someday do it right. */
 
-         if ((global_tbonetest & 011) == 011) {
+         if ((e.m_global_tbonetest & 011) == 011) {
             if (disttest != disttest_offset)
                fail("Sorry, can't apply this concept when people are T-boned.");
 
@@ -2957,7 +2960,7 @@ extern void distorted_move(
          // Look for butterfly or "O" spots occupied.
 
          if (livemask == 0x6666 || livemask == 0x9999) {
-            if (!((linesp ^ global_tbonetest) & 1)) {
+            if (!((linesp ^ e.m_global_tbonetest) & 1)) {
                rotate_back = 1;
                ss->rotation++;
                canonicalize_rotation(ss);
@@ -2970,7 +2973,7 @@ extern void distorted_move(
             goto do_divided_call;
          }
 
-         if ((linesp ^ global_tbonetest) & 1) {
+         if ((linesp ^ e.m_global_tbonetest) & 1) {
             rotate_back = 1;
             ss->rotation++;
             canonicalize_rotation(ss);
@@ -3003,10 +3006,10 @@ extern void distorted_move(
          // All the remaining cases make the same test for lines vs. columns.
 
          if (linesp & 1) {
-            if (global_tbonetest & 1) fail("There are no lines of 4 here.");
+            if (e.m_global_tbonetest & 1) fail("There are no lines of 4 here.");
          }
          else {
-            if (global_tbonetest & 010) fail("There are no columns of 4 here.");
+            if (e.m_global_tbonetest & 010) fail("There are no columns of 4 here.");
          }
 
          rot = 0;
@@ -3072,17 +3075,17 @@ extern void distorted_move(
       break;
    case DISTORTKEY_TIDALCLW:
       if (linesp & 1) {
-         if (global_tbonetest & 1) fail("There is no tidal line here.");
+         if (e.m_global_tbonetest & 1) fail("There is no tidal line here.");
       }
       else {
-         if (global_tbonetest & 010) fail("There is no tidal column here.");
+         if (e.m_global_tbonetest & 010) fail("There is no tidal column here.");
       }
 
       if (disttest == disttest_offset) {
          // Offset tidal C/L/W.
          if (ss->kind == s2x8) {
-            if (global_livemask == 0xF0F0) { map_code = MAPCODE(s1x8,1,MPKIND__OFFS_L_FULL,0); }
-            else if (global_livemask == 0x0F0F) { map_code = MAPCODE(s1x8,1,MPKIND__OFFS_R_FULL,0); }
+            if (e.m_global_livemask == 0xF0F0) { map_code = MAPCODE(s1x8,1,MPKIND__OFFS_L_FULL,0); }
+            else if (e.m_global_livemask == 0x0F0F) { map_code = MAPCODE(s1x8,1,MPKIND__OFFS_R_FULL,0); }
             else fail("Can't find offset 1x8.");
 
             goto do_divided_call;
@@ -3093,8 +3096,8 @@ extern void distorted_move(
       else {
          // Distorted tidal C/L/W.
          if (ss->kind == sbigbone) {
-            if (global_livemask == 01717) { map_code = spcmap_dbgbn1; }
-            else if (global_livemask == 07474) { map_code = spcmap_dbgbn2; }
+            if (e.m_global_livemask == 01717) { map_code = spcmap_dbgbn1; }
+            else if (e.m_global_livemask == 07474) { map_code = spcmap_dbgbn2; }
             else fail("Can't find distorted 1x8.");
 
             // We know what we are doing -- shut off the error message.
@@ -3121,24 +3124,24 @@ extern void distorted_move(
 
       switch (ss->kind) {
       case s3dmd:
-         if (global_livemask == 06363) { map_code = spcmap_dqtag1; }
-         else if (global_livemask == 06666) { map_code = spcmap_dqtag2; }
+         if (e.m_global_livemask == 06363) { map_code = spcmap_dqtag1; }
+         else if (e.m_global_livemask == 06666) { map_code = spcmap_dqtag2; }
          break;
       case s4x4:
-         if (global_livemask == 0x6C6C) { map_code = spcmap_dqtag3; }
-         else if (global_livemask == 0xE2E2) { map_code = spcmap_dqtag4; }
+         if (e.m_global_livemask == 0x6C6C) { map_code = spcmap_dqtag3; }
+         else if (e.m_global_livemask == 0xE2E2) { map_code = spcmap_dqtag4; }
          else {
             rotate_back = 1;   // It must be rotated.
             ss->rotation++;
             canonicalize_rotation(ss);
 
-            if (global_livemask == 0xC6C6) { map_code = spcmap_dqtag3; }
-            else if (global_livemask == 0x2E2E) { map_code = spcmap_dqtag4; }
+            if (e.m_global_livemask == 0xC6C6) { map_code = spcmap_dqtag3; }
+            else if (e.m_global_livemask == 0x2E2E) { map_code = spcmap_dqtag4; }
          }
          break;
       case s4x6:
-         if (global_livemask == 0xA88A88) { map_code = spcmap_dqtag5; }
-         else if (global_livemask == 0x544544) { map_code = spcmap_dqtag6; }
+         if (e.m_global_livemask == 0xA88A88) { map_code = spcmap_dqtag5; }
+         else if (e.m_global_livemask == 0x544544) { map_code = spcmap_dqtag6; }
          break;
       }
 
@@ -3156,11 +3159,11 @@ extern void distorted_move(
 
          for (const clw3_thing *gptr=clw3_table ; gptr->mask ; gptr++) {
             if (gptr->k == ss->kind &&
-                (global_livemask & gptr->mask) == gptr->test) {
+                (e.m_global_livemask & gptr->mask) == gptr->test) {
 
                const map::map_thing *map_ptr = map::get_map_from_code(gptr->map_code);
 
-               uint32 tberrtest = global_tbonetest;
+               uint32 tberrtest = e.m_global_tbonetest;
                uint32 mytbone = 0;
                for (int k=0 ; k < 3*map_ptr->arity ; k++)
                   mytbone |= ss->people[map_ptr->maps[k]].id1;
@@ -3216,7 +3219,7 @@ extern void distorted_move(
       // There is no general way to scan the columns unambiguously.
 
       if (ss->kind == s4x4) {
-         if (!((linesp ^ global_tbonetest) & 1)) {
+         if (!((linesp ^ e.m_global_tbonetest) & 1)) {
             // What a crock -- this is all backwards.
             rotate_back = 1;     // (Well, actually everything else is backwards.)
             ss->rotation++;
@@ -3243,8 +3246,8 @@ extern void distorted_move(
       // Offset split phantom boxes.
       if (ss->kind != s3x8) fail("Can't do this concept in this setup.");
 
-      if ((global_livemask & 0x00F00F) == 0) map_table_key |= 1;
-      if ((global_livemask & 0x0F00F0) == 0) map_table_key |= 2;
+      if ((e.m_global_livemask & 0x00F00F) == 0) map_table_key |= 1;
+      if ((e.m_global_livemask & 0x0F00F0) == 0) map_table_key |= 2;
 
       map_code = offs_boxes_map_code_table[map_table_key];
       if (map_code == ~0U) fail("Can't find offset 2x4's.");
@@ -3253,15 +3256,15 @@ extern void distorted_move(
    case DISTORTKEY_OFFS_QTAG:
       if (ss->kind != spgdmdcw && ss->kind != spgdmdccw) {
          // Try to fudge a 4x4 into the setup we want.
-         if (global_tbonetest & 1) {
+         if (e.m_global_tbonetest & 1) {
             rotate_back = 1;
-            global_tbonetest >>= 3;
+            e.m_global_tbonetest >>= 3;
             livemask = ((livemask << 4) & 0xFFFF) | (livemask >> 12);
             ss->rotation++;
             canonicalize_rotation(ss);
          }
 
-         if (ss->kind != s4x4 || (global_tbonetest & 1)) fail("Can't find distorted 1/4 tag.");
+         if (ss->kind != s4x4 || (e.m_global_tbonetest & 1)) fail("Can't find distorted 1/4 tag.");
          const expand::thing *p;
          static const expand::thing foo1 = {{-1, 2, -1, 3, -1, -1, 5, 4, -1, 6, -1, 7, -1, -1, 1, 0},
                                             s4x4, spgdmdccw, 0, 0U, 0U, false,
@@ -3299,7 +3302,7 @@ extern void distorted_move(
       // Offset triple C/L/W.
       if (ss->kind != s4x4) fail("Can't do this concept in this setup.");
 
-      if (!((linesp ^ global_tbonetest) & 1)) {
+      if (!((linesp ^ e.m_global_tbonetest) & 1)) {
          rotate_back = 1;
          ss->rotation++;
          canonicalize_rotation(ss);
@@ -3317,8 +3320,8 @@ extern void distorted_move(
       // Offset triple boxes.
       if (ss->kind != s2x8) fail("Must have a 2x8 setup to do this concept.");
 
-      if ((global_livemask & 0xC0C0) == 0) map_table_key |= 1;
-      if ((global_livemask & 0x0303) == 0) map_table_key |= 2;
+      if ((e.m_global_livemask & 0xC0C0) == 0) map_table_key |= 1;
+      if ((e.m_global_livemask & 0x0303) == 0) map_table_key |= 2;
 
       map_code = offs_triple_boxes_map_code_table[map_table_key];
       if (map_code == ~0U) fail("Can't find offset triple boxes.");
@@ -3478,7 +3481,7 @@ extern void triple_twin_move(
    setup *result) THROW_DECL
 {
    ss->clear_all_overcasts();
-   uint32 tbonetest = global_tbonetest;
+   uint32 tbonetest = current_engine->m_global_tbonetest;
    uint32 mapcode;
    phantest_kind phan = (phantest_kind) parseptr->concept->arg4;
 
@@ -3784,6 +3787,7 @@ void do_concept_wing(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    ss->clear_all_overcasts();
    int rstuff = parseptr->concept->arg1;
 
@@ -3827,7 +3831,7 @@ void do_concept_wing(
       selector_mysticbeaus,
       selector_all};
 
-   selector_kind saved_selector = current_options.who;
+   selector_kind saved_selector = e.m_current_options.who;
 
    // We scan twice -- the first time we put the normal and winged people
    // into the setup in which they belong.  The second time, we try to
@@ -3840,12 +3844,12 @@ void do_concept_wing(
          uint32 this_id1 = ss->people[i].id1;
          if (this_id1) {
             if (!pass2) all_people++;
-            current_options.who = wing_sel_table[rstuff];
+            e.m_current_options.who = wing_sel_table[rstuff];
             if (selectp(ss, i)) {
                int x = coordptr->xca[i];
                int y = coordptr->yca[i];
 
-               current_options.who = selector_belles;
+               e.m_current_options.who = selector_belles;
                int shift = selectp(ss, i) ? -4 : 4;
 
                switch (this_id1 & 3) {
@@ -3888,7 +3892,7 @@ void do_concept_wing(
       if (pass2) break;
    }
 
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 
    setup the_results[2];
    bool normal_was_ok = false;
@@ -4904,6 +4908,7 @@ static void wv_tand_base_move(
    int indicator,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    uint32 tbonetest;
    int t;
    calldef_schema schema;
@@ -4913,7 +4918,7 @@ static void wv_tand_base_move(
    case s_bone:
    case s_rigger:
       if ((indicator & 076) == 20) {
-         if (global_selectmask != (global_livemask & 0x33))
+         if (e.m_global_selectmask != (e.m_global_livemask & 0x33))
             goto losing;
       }
       else {
@@ -4944,7 +4949,7 @@ static void wv_tand_base_move(
       break;
    case s_bone6:
       if (indicator == 20) {
-         if (global_selectmask != (global_livemask & 033))
+         if (e.m_global_selectmask != (e.m_global_livemask & 033))
             goto losing;
       }
       else {
@@ -4959,7 +4964,7 @@ static void wv_tand_base_move(
       return;
    case s_short6:
       if (indicator == 20) {
-         if (global_selectmask != (global_livemask & 055))
+         if (e.m_global_selectmask != (e.m_global_livemask & 055))
             goto losing;
       }
       else {
@@ -5002,7 +5007,7 @@ static void wv_tand_base_move(
    case s_ntrglcw:
    case s_nptrglcw:
       if (indicator == 20) {
-         if (global_selectmask != (global_livemask & 0xCC))
+         if (e.m_global_selectmask != (e.m_global_livemask & 0xCC))
             goto losing;
       }
       else {
@@ -5018,7 +5023,7 @@ static void wv_tand_base_move(
    case s_ntrglccw:
    case s_nptrglccw:
       if (indicator == 20) {
-         if (global_selectmask != (global_livemask & 0x33))
+         if (e.m_global_selectmask != (e.m_global_livemask & 0x33))
             goto losing;
       }
       else {
@@ -5033,7 +5038,7 @@ static void wv_tand_base_move(
       return;
    case s_nxtrglcw:
       if (indicator == 20) {
-         if (global_selectmask != (global_livemask & 0x66))
+         if (e.m_global_selectmask != (e.m_global_livemask & 0x66))
             goto losing;
       }
       else {
@@ -5048,7 +5053,7 @@ static void wv_tand_base_move(
       return;
    case s_nxtrglccw:
       if (indicator == 20) {
-         if (global_selectmask != (global_livemask & 0x33))
+         if (e.m_global_selectmask != (e.m_global_livemask & 0x33))
             goto losing;
       }
       else {
@@ -5063,7 +5068,7 @@ static void wv_tand_base_move(
       return;
    case s_ntrgl6cw:
       if (indicator == 20) {
-         if (global_selectmask != (global_livemask & 066))
+         if (e.m_global_selectmask != (e.m_global_livemask & 066))
             goto losing;
       }
       else {
@@ -5078,7 +5083,7 @@ static void wv_tand_base_move(
       return;
    case s_ntrgl6ccw:
       if (indicator == 20) {
-         if (global_selectmask != (global_livemask & 033))
+         if (e.m_global_selectmask != (e.m_global_livemask & 033))
             goto losing;
       }
       else {
@@ -5094,9 +5099,9 @@ static void wv_tand_base_move(
    case s_323:
       if (indicator != 20)
          goto losing;
-      if (global_selectmask == (global_livemask & 0x33))
+      if (e.m_global_selectmask == (e.m_global_livemask & 0x33))
          tglmap::do_glorious_triangles(s, tglmap::s323map33, indicator, result);
-      else if (global_selectmask == (global_livemask & 0x66))
+      else if (e.m_global_selectmask == (e.m_global_livemask & 0x66))
          tglmap::do_glorious_triangles(s, tglmap::s323map66, indicator, result);
       else
          goto losing;
@@ -5106,15 +5111,15 @@ static void wv_tand_base_move(
    case s_c1phan:
       if ((indicator & 077) == 20) {
          t = 0;
-         if (global_selectmask == (global_livemask & 0x5A5A))
+         if (e.m_global_selectmask == (e.m_global_livemask & 0x5A5A))
             t = 1;
-         else if (global_selectmask != (global_livemask & 0xA5A5))
+         else if (e.m_global_selectmask != (e.m_global_livemask & 0xA5A5))
             goto losing;
       }
       else {
          t = indicator & 1;
-         if ((global_tbonetest & 010) == 0) t ^= 1;
-         else if ((global_tbonetest & 1) != 0)
+         if ((e.m_global_tbonetest & 010) == 0) t ^= 1;
+         else if ((e.m_global_tbonetest & 1) != 0)
             goto losing;
       }
 
@@ -5124,9 +5129,9 @@ static void wv_tand_base_move(
       s->rotation += t;   // Just flip the setup around and recanonicalize.
       canonicalize_rotation(s);
 
-      if ((global_livemask & 0xAAAA) == 0)
+      if ((e.m_global_livemask & 0xAAAA) == 0)
          map_key_table = tglmap::c1tglmap1;
-      else if ((global_livemask & 0x5555) == 0)
+      else if ((e.m_global_livemask & 0x5555) == 0)
          map_key_table = tglmap::c1tglmap2;
       else
          goto losing;
@@ -5137,17 +5142,17 @@ static void wv_tand_base_move(
       return;
    case sdeepbigqtg:
       if ((indicator & 077) == 20) {
-         if (global_selectmask != (global_livemask & 0xF0F0))
+         if (e.m_global_selectmask != (e.m_global_livemask & 0xF0F0))
             goto losing;
       }
       else {
-         if (global_tbonetest & ((indicator & 1) ? 010 : 1))
+         if (e.m_global_tbonetest & ((indicator & 1) ? 010 : 1))
             goto losing;
       }
 
-      if ((global_livemask & 0x3A3A) == 0)
+      if ((e.m_global_livemask & 0x3A3A) == 0)
          map_key_table = tglmap::dbqtglmap1;
-      else if ((global_livemask & 0xC5C5) == 0)
+      else if ((e.m_global_livemask & 0xC5C5) == 0)
          map_key_table = tglmap::dbqtglmap2;
       else
          goto losing;
@@ -5172,6 +5177,7 @@ extern void triangle_move(
    parse_block *parseptr,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    ss->clear_all_overcasts();
    calldef_schema schema;
    int indicator = parseptr->concept->arg1;
@@ -5276,9 +5282,9 @@ extern void triangle_move(
          // Indicator = 2 for inside, 3 for outside.
 
          if (indicator_base == 2 && ss->kind == sbigdmd) {
-            if (global_livemask == 07474)
+            if (e.m_global_livemask == 07474)
                map_key_table = tglmap::bdtglmap1;
-            else if (global_livemask == 01717)
+            else if (e.m_global_livemask == 01717)
                map_key_table = tglmap::bdtglmap2;
             else
                fail("Can't find the indicated triangles.");
@@ -5335,9 +5341,9 @@ extern void triangle_move(
             case sd2x7:
                if (indicator & 0300) fail("Can't find the indicated triangles.");
 
-               if (global_livemask == 0x3C78U)
+               if (e.m_global_livemask == 0x3C78U)
                   map_key_table = tglmap::d7tglmap1;
-               else if (global_livemask == 0x078FU)
+               else if (e.m_global_livemask == 0x078FU)
                   map_key_table = tglmap::d7tglmap2;
                else
                   fail("Can't find the triangle.");
@@ -288,25 +288,26 @@ int last_file_position = -1;
 /* Returns TRUE if it fails, meaning that the user waved the mouse away. */
 static bool find_tagger(uint32 tagclass, uint32 *tagg, call_with_name **tagger_call)
 {
+   engine_context & e = *current_engine;
    uint32 numtaggers = number_of_taggers[tagclass];
    call_with_name **tagtable = tagger_calls[tagclass];
 
    if (numtaggers == 0) return true;   /* We can't possibly do this. */
 
-   if (interactivity == interactivity_normal) {
-      if (gg77->matcher_p->m_final_result.valid &&
-          (gg77->matcher_p->m_final_result.match.call_conc_options.tagger != 0)) {
-         *tagg = gg77->matcher_p->m_final_result.match.call_conc_options.tagger;
-         gg77->matcher_p->m_final_result.match.call_conc_options.tagger = 0;
+   if (e.m_interactivity == interactivity_normal) {
+      if (e.m_gg77->matcher_p->m_final_result.valid &&
+          (e.m_gg77->matcher_p->m_final_result.match.call_conc_options.tagger != 0)) {
+         *tagg = e.m_gg77->matcher_p->m_final_result.match.call_conc_options.tagger;
+         e.m_gg77->matcher_p->m_final_result.match.call_conc_options.tagger = 0;
       }
-      else if ((*tagg = gg77->iob88.do_tagger_popup(tagclass)) == 0) return true;
+      else if ((*tagg = e.m_gg77->iob88.do_tagger_popup(tagclass)) == 0) return true;
 
       if ((*tagg >> 5) != tagclass) fail("bad tagger class???");
       if ((*tagg & 0x1F) > numtaggers) fail("bad tagger index???");
    }
-   else if (interactivity == interactivity_verify) {
-      if (verify_options.tagger != 0) {
-         *tagg = verify_options.tagger;
+   else if (e.m_interactivity == interactivity_verify) {
+      if (e.m_verify_options.tagger != 0) {
+         *tagg = e.m_verify_options.tagger;
          if ((*tagg >> 5) != tagclass) fail("bad tagger class???");
       }
       else {
@@ -314,9 +315,9 @@ static bool find_tagger(uint32 tagclass, uint32 *tagg, call_with_name **tagger_c
       }
 
       if ((*tagg & 0x1F) > numtaggers) fail("bad tagger index???");
-      verify_options.tagger = 0;
+      e.m_verify_options.tagger = 0;
    }
-   else if (interactivity == interactivity_database_init) {
+   else if (e.m_interactivity == interactivity_database_init) {
       /* We don't generate "dont_use_in_resolve" taggers in any random search. */
       /* Using zero as the tag call index might not be right. */
       if (tagtable[0]->the_defn.callflags1 & CFLAG1_DONT_USE_IN_RESOLVE)
@@ -343,13 +344,14 @@ static bool find_tagger(uint32 tagclass, uint32 *tagg, call_with_name **tagger_c
 /* Returns true if it fails, meaning that the user waved the mouse away. */
 static bool find_circcer(uint32 *circcp)
 {
+   engine_context & e = *current_engine;
    if (number_of_circcers == 0) return true;   // We can't possibly do this.
 
-   if (interactivity == interactivity_normal || interactivity == interactivity_verify) {
-      if ((*circcp = gg77->iob88.do_circcer_popup()) == 0)
+   if (e.m_interactivity == interactivity_normal || e.m_interactivity == interactivity_verify) {
+      if ((*circcp = e.m_gg77->iob88.do_circcer_popup()) == 0)
          return true;
    }
-   else if (interactivity == interactivity_database_init) {
+   else if (e.m_interactivity == interactivity_database_init) {
       *circcp = 1;   // This may not be right.
    }
    else {
@@ -365,8 +367,9 @@ static bool find_circcer(uint32 *circcp)
 /* Returns true if it fails, meaning that the user waved the mouse away. */
 static bool find_selector(selector_kind *sel_p, bool is_for_call)
 {
-   if (interactivity == interactivity_normal) {
-      matcher_class &matcher = *gg77->matcher_p;
+   engine_context & e = *current_engine;
+   if (e.m_interactivity == interactivity_normal) {
+      matcher_class &matcher = *e.m_gg77->matcher_p;
       selector_kind sel;
 
       if (matcher.m_final_result.valid &&
@@ -374,7 +377,7 @@ static bool find_selector(selector_kind *sel_p, bool is_for_call)
          sel = matcher.m_final_result.match.call_conc_options.who;
          matcher.m_final_result.match.call_conc_options.who = selector_uninitialized;
       }
-      else if ((sel = gg77->iob88.do_selector_popup(matcher)) == selector_uninitialized)
+      else if ((sel = e.m_gg77->iob88.do_selector_popup(matcher)) == selector_uninitialized)
          return true;
 
       *sel_p = sel;
@@ -389,8 +392,9 @@ static bool find_selector(selector_kind *sel_p, bool is_for_call)
 /* Returns true if it fails, meaning that the user waved the mouse away. */
 static bool find_direction(direction_kind *dir_p)
 {
-   if (interactivity == interactivity_normal) {
-      matcher_class &matcher = *gg77->matcher_p;
+   engine_context & e = *current_engine;
+   if (e.m_interactivity == interactivity_normal) {
+      matcher_class &matcher = *e.m_gg77->matcher_p;
       direction_kind dir;
 
       if (matcher.m_final_result.valid &&
@@ -398,7 +402,7 @@ static bool find_direction(direction_kind *dir_p)
          dir = matcher.m_final_result.match.call_conc_options.where;
          matcher.m_final_result.match.call_conc_options.where = direction_uninitialized;
       }
-      else if ((dir = gg77->iob88.do_direction_popup(matcher)) == direction_uninitialized)
+      else if ((dir = e.m_gg77->iob88.do_direction_popup(matcher)) == direction_uninitialized)
          return true;
 
       *dir_p = dir;
@@ -415,8 +419,9 @@ static bool find_direction(direction_kind *dir_p)
 static bool find_numbers(int howmanynumbers, bool forbid_zero,
    uint32 odd_number_only, bool allow_iteration, uint32 *number_list)
 {
-   if (interactivity == interactivity_normal)
-      *number_list = gg77->get_number_fields(howmanynumbers, odd_number_only != 0, forbid_zero);
+   engine_context & e = *current_engine;
+   if (e.m_interactivity == interactivity_normal)
+      *number_list = e.m_gg77->get_number_fields(howmanynumbers, odd_number_only != 0, forbid_zero);
    else
       do_number_iteration(howmanynumbers, odd_number_only, allow_iteration, number_list);
 
@@ -438,6 +443,7 @@ static bool find_numbers(int howmanynumbers, bool forbid_zero,
 
 extern bool deposit_call(call_with_name *call, const call_conc_option_state *options)
 {
+   engine_context & e = *current_engine;
    parse_block *new_block;
    call_with_name *tagger_call;
    uint32 tagg = 0;
@@ -454,9 +460,9 @@ extern bool deposit_call(call_with_name *call, const call_conc_option_state *opt
 
    if ((call->the_defn.callflagsf & (CFLAGH__CIRC_CALL_RQ_BIT|CFLAGH__REQUIRES_SELECTOR)) ==
        (CFLAGH__CIRC_CALL_RQ_BIT|CFLAGH__REQUIRES_SELECTOR) &&
-       interactivity != interactivity_normal &&
-       interactivity != interactivity_verify &&
-       interactivity != interactivity_database_init) {
+       e.m_interactivity != interactivity_normal &&
+       e.m_interactivity != interactivity_verify &&
+       e.m_interactivity != interactivity_database_init) {
       if (in_exhaustive_search()) {
          return true;
       }
@@ -508,7 +514,7 @@ extern bool deposit_call(call_with_name *call, const call_conc_option_state *opt
    // Filling in the tagger requires recursion!
 
    if (tagg != 0) {
-      parse_block **savecwp = parse_state.concept_write_ptr;
+      parse_block **savecwp = e.m_parse_state.concept_write_ptr;
 
       new_block->options.tagger = tagg;
       new_block->concept = &concept_marker_concept_mod;
@@ -520,16 +526,16 @@ extern bool deposit_call(call_with_name *call, const call_conc_option_state *opt
       new_block->next->call = base_calls[base_call_tagger0];
       new_block->next->call_to_print = base_calls[base_call_tagger0];
 
-      parse_state.concept_write_ptr = &new_block->next->subsidiary_root;
+      e.m_parse_state.concept_write_ptr = &new_block->next->subsidiary_root;
       if (deposit_call(tagger_call, &null_options))
          throw error_flag_type(error_flag_wrong_command);     // User waved the mouse away while getting subcall.
-      parse_state.concept_write_ptr = savecwp;
+      e.m_parse_state.concept_write_ptr = savecwp;
    }
 
    // Filling in the circcer does too, but it isn't serious.
 
    if (circc != 0) {
-      parse_block **savecwp = parse_state.concept_write_ptr;
+      parse_block **savecwp = e.m_parse_state.concept_write_ptr;
 
       new_block->options.circcer = circc;
       new_block->concept = &concept_marker_concept_mod;
@@ -543,14 +549,14 @@ extern bool deposit_call(call_with_name *call, const call_conc_option_state *opt
 
       if (circc > number_of_circcers) fail_no_retry("bad circcer index???");
 
-      parse_state.concept_write_ptr = &new_block->next->subsidiary_root;
+      e.m_parse_state.concept_write_ptr = &new_block->next->subsidiary_root;
       if (deposit_call(circcer_calls[circc-1], &null_options))
          throw error_flag_type(error_flag_wrong_command);     // User waved the mouse away while getting subcall.
-      parse_state.concept_write_ptr = savecwp;
+      e.m_parse_state.concept_write_ptr = savecwp;
    }
 
-   parse_state.topcallflags1 = call->the_defn.callflags1;
-   *parse_state.concept_write_ptr = new_block;
+   e.m_parse_state.topcallflags1 = call->the_defn.callflags1;
+   *e.m_parse_state.concept_write_ptr = new_block;
 
    return false;
 }
@@ -566,6 +572,7 @@ extern bool deposit_call(call_with_name *call, const call_conc_option_state *opt
 
 extern bool deposit_concept(const concept_descriptor *conc)
 {
+   engine_context & e = *current_engine;
    parse_block *new_block;
    selector_kind sel = selector_uninitialized;
    direction_kind dir = direction_uninitialized;
@@ -599,24 +606,24 @@ extern bool deposit_concept(const concept_descriptor *conc)
    new_block->options.number_fields = number_list;
    new_block->options.howmanynumbers = howmanynumbers;
 
-   *parse_state.concept_write_ptr = new_block;
+   *e.m_parse_state.concept_write_ptr = new_block;
 
    /* See if we need to parse a second call for this concept. */
 
    if (concept_table[conc->kind].concept_prop & CONCPROP__SECOND_CALL) {
       /* Set up recursion, reading the first call and its concepts into the same parse block. */
 
-      if (parse_state.parse_stack_index == 39) specialfail("Excessive number of concepts.");
-      parse_state.parse_stack[parse_state.parse_stack_index].save_concept_kind = conc->kind;
-      parse_state.parse_stack[parse_state.parse_stack_index++].concept_write_save_ptr = parse_state.concept_write_ptr;
-      parse_state.specialprompt[0] = '\0';
-      parse_state.topcallflags1 = 0;          /* Erase anything we had -- it is meaningless now. */
+      if (e.m_parse_state.parse_stack_index == 39) specialfail("Excessive number of concepts.");
+      e.m_parse_state.parse_stack[e.m_parse_state.parse_stack_index].save_concept_kind = conc->kind;
+      e.m_parse_state.parse_stack[e.m_parse_state.parse_stack_index++].concept_write_save_ptr = e.m_parse_state.concept_write_ptr;
+      e.m_parse_state.specialprompt[0] = '\0';
+      e.m_parse_state.topcallflags1 = 0;          /* Erase anything we had -- it is meaningless now. */
    }
 
-   parse_state.call_list_to_use = call_list_any;
+   e.m_parse_state.call_list_to_use = call_list_any;
 
    // Advance the write pointer.
-   parse_state.concept_write_ptr = &(new_block->next);
+   e.m_parse_state.concept_write_ptr = &(new_block->next);
 
    return false;
 }
@@ -648,7 +655,8 @@ void ui_utils::print_error_person(unsigned int person, bool example)
 
 extern bool query_for_call()
 {
-   uims_reply_thing global_reply_save = global_reply;
+   engine_context & e = *current_engine;
+   uims_reply_thing global_reply_save = e.m_global_reply;
 
    error_flag_type old_error_flag;
    bool refresh_override = false;
@@ -657,14 +665,14 @@ extern bool query_for_call()
  recurse_entry:
 
    // We should actually re-use anything there.
-   *parse_state.concept_write_ptr = (parse_block *) 0;
+   *e.m_parse_state.concept_write_ptr = (parse_block *) 0;
 
-   if (allowing_modifications)
-      parse_state.call_list_to_use = call_list_any;
+   if (e.m_allowing_modifications)
+      e.m_parse_state.call_list_to_use = call_list_any;
 
    redisplay:
 
-   if (interactivity == interactivity_normal) {
+   if (e.m_interactivity == interactivity_normal) {
       // We are operating in interactive mode.  Update the display and query the user.
       // First, update the output area to the current state, with error messages, etc.
       // We draw a picture for the last two calls.
@@ -674,93 +682,93 @@ extern bool query_for_call()
       // But if we are doing a "refresh display", do it anyway.
 
       if (refresh_override ||
-          global_error_flag < error_flag_wrong_command ||
-          global_error_flag == error_flag_selector_changed ||
-          global_error_flag == error_flag_formation_changed) {
-         gg77->display_initial_history(config_history_ptr, (ui_options.diagnostic_mode ? 1 : 2));
+          e.m_global_error_flag < error_flag_wrong_command ||
+          e.m_global_error_flag == error_flag_selector_changed ||
+          e.m_global_error_flag == error_flag_formation_changed) {
+         e.m_gg77->display_initial_history(e.m_config_history_ptr, (e.m_ui_options.diagnostic_mode ? 1 : 2));
 
          if (configuration::sequence_is_resolved()) {
-            gg77->newline();
-            gg77->writestuff("     resolve is:");
-            gg77->newline();
-            gg77->write_resolve_text(false);
-            gg77->newline();
+            e.m_gg77->newline();
+            e.m_gg77->writestuff("     resolve is:");
+            e.m_gg77->newline();
+            e.m_gg77->write_resolve_text(false);
+            e.m_gg77->newline();
          }
       }
 
-      if (global_error_flag && global_error_flag < error_flag_wrong_command) {
-         gg77->writestuff("Can't do this call:");
-         gg77->newline();
-         gg77->write_history_line(0, false, false, file_write_no);
+      if (e.m_global_error_flag && e.m_global_error_flag < error_flag_wrong_command) {
+         e.m_gg77->writestuff("Can't do this call:");
+         e.m_gg77->newline();
+         e.m_gg77->write_history_line(0, false, false, file_write_no);
       }
 
-      if (global_error_flag) {
-         switch (global_error_flag) {
+      if (e.m_global_error_flag) {
+         switch (e.m_global_error_flag) {
          case error_flag_wrong_resolve_command:
          case error_flag_1_line:
          case error_flag_no_retry:
             // Commonplace error message.
-            gg77->writestuff(error_message1);
+            e.m_gg77->writestuff(e.m_error_message1);
             break;
          case error_flag_2_line:
-            gg77->writestuff(error_message1);
-            gg77->newline();
-            gg77->writestuff("   ");
-            gg77->writestuff(error_message2);
+            e.m_gg77->writestuff(e.m_error_message1);
+            e.m_gg77->newline();
+            e.m_gg77->writestuff("   ");
+            e.m_gg77->writestuff(e.m_error_message2);
             break;
          case error_flag_collision:
             // Very special message -- no text here, two people collided
             // and they are stored in collision_person1 and collision_person2.
-            gg77->writestuff("Some people (");
-            gg77->print_error_person(collision_person1, false);
-            gg77->writestuff(" and ");
-            gg77->print_error_person(collision_person2, true);
-            gg77->writestuff(") on same spot.");
+            e.m_gg77->writestuff("Some people (");
+            e.m_gg77->print_error_person(e.m_collision_person1, false);
+            e.m_gg77->writestuff(" and ");
+            e.m_gg77->print_error_person(e.m_collision_person2, true);
+            e.m_gg77->writestuff(") on same spot.");
             break;
          case error_flag_cant_execute:
             // Very special message -- given text is to be prefixed with description
             // of the perpetrator, who is stored in collision_person1.
-            gg77->writestuff("Some person (");
-            gg77->print_error_person(collision_person1, true);
-            gg77->writestuff(") ");
-            gg77->writestuff(error_message1);
+            e.m_gg77->writestuff("Some person (");
+            e.m_gg77->print_error_person(e.m_collision_person1, true);
+            e.m_gg77->writestuff(") ");
+            e.m_gg77->writestuff(e.m_error_message1);
             break;
          case error_flag_selector_changed:
-            gg77->writestuff("Warning -- person identifiers were changed.");
+            e.m_gg77->writestuff("Warning -- person identifiers were changed.");
             break;
          case error_flag_formation_changed:
-            gg77->writestuff("Warning -- the formation has changed.");
+            e.m_gg77->writestuff("Warning -- the formation has changed.");
             break;
          case error_flag_wrong_command:
-            gg77->writestuff("You can't select that here.");
+            e.m_gg77->writestuff("You can't select that here.");
             break;
          case error_flag_OK_but_dont_erase:
-            global_error_flag = error_flag_none;
+            e.m_global_error_flag = error_flag_none;
             break;
          }
 
-         gg77->newline();
-         gg77->newline();
+         e.m_gg77->newline();
+         e.m_gg77->newline();
       }
 
-      old_error_flag = global_error_flag; /* save for refresh command */
-      global_error_flag = error_flag_none;
+      old_error_flag = e.m_global_error_flag; /* save for refresh command */
+      e.m_global_error_flag = error_flag_none;
 
       if (clipboard_size != 0) {
          int j;
 
-         gg77->writestuff("............................");
-         gg77->newline();
+         e.m_gg77->writestuff("............................");
+         e.m_gg77->newline();
 
          /* Display at most 3 lines. */
          for (j = clipboard_size-1 ; j >= 0 && j >= clipboard_size-3 ; j--) {
-            gg77->writestuff("      ");
-            gg77->print_recurse(clipboard[j].command_root, 0);
-            gg77->newline();
+            e.m_gg77->writestuff("      ");
+            e.m_gg77->print_recurse(clipboard[j].command_root, 0);
+            e.m_gg77->newline();
          }
 
-         gg77->writestuff("............................");
-         gg77->newline();
+         e.m_gg77->writestuff("............................");
+         e.m_gg77->newline();
       }
 
       // Display the call index number, and the partially entered call and/or
@@ -769,7 +777,7 @@ extern bool query_for_call()
       // See if there are partially entered concepts.  If so, print the index
       // number and those concepts on a separate line.
 
-      if (parse_state.concept_write_ptr != &configuration::next_config().command_root) {
+      if (e.m_parse_state.concept_write_ptr != &configuration::next_config().command_root) {
 
          // This prints the concepts entered so far, with a "header"
          // consisting of the index number.  This partial concept tree
@@ -785,23 +793,23 @@ extern bool query_for_call()
          // the final result will show the missing subcall as
          // "no one do your part, tally ho but [???]"
 
-         gg77->write_history_line(config_history_ptr+1, false, true, file_write_no);
+         e.m_gg77->write_history_line(e.m_config_history_ptr+1, false, true, file_write_no);
       }
       else {
          // No partially entered concepts.  Just do the sequence number.
 
-         if (!ui_options.diagnostic_mode) {
+         if (!e.m_ui_options.diagnostic_mode) {
             char indexbuf[200];
             sprintf (indexbuf, "%2d:",
-                     config_history_ptr-configuration::whole_sequence_low_lim+2);
-            gg77->writestuff(indexbuf);
-            gg77->newline();
+                     e.m_config_history_ptr-configuration::whole_sequence_low_lim()+2);
+            e.m_gg77->writestuff(indexbuf);
+            e.m_gg77->newline();
          }
       }
 
-      if (parse_state.specialprompt[0] != '\0') {
-         gg77->writestuff(parse_state.specialprompt);
-         gg77->newline();
+      if (e.m_parse_state.specialprompt[0] != '\0') {
+         e.m_gg77->writestuff(e.m_parse_state.specialprompt);
+         e.m_gg77->newline();
       }
 
    check_menu:
@@ -812,81 +820,81 @@ extern bool query_for_call()
       // the concepts and call have been deposited with calls to "deposit_call" and
       // "deposit_concept".
 
-      global_reply = gg77->iob88.get_call_command();
-      if (global_reply.majorpart == ui_user_cancel) goto recurse_entry;
-      if (global_reply.majorpart == ui_command_select) {
-         switch ((command_kind) global_reply.minorpart) {
+      e.m_global_reply = e.m_gg77->iob88.get_call_command();
+      if (e.m_global_reply.majorpart == ui_user_cancel) goto recurse_entry;
+      if (e.m_global_reply.majorpart == ui_command_select) {
+         switch ((command_kind) e.m_global_reply.minorpart) {
             char comment[MAX_TEXT_LINE_LENGTH];
          case command_create_comment:
             {
-               if (gg77->iob88.get_popup_string("*Enter comment:", "", "Enter comment:", "", comment) ==
+               if (e.m_gg77->iob88.get_popup_string("*Enter comment:", "", "Enter comment:", "", comment) ==
                    POPUP_ACCEPT_WITH_STRING) {
                   comment_block *new_comment_block = new comment_block;
                   char *temp_text_ptr = new_comment_block->txt;
                   string_copy(&temp_text_ptr, comment);
 
-                  *parse_state.concept_write_ptr = get_parse_block();
-                  (*parse_state.concept_write_ptr)->concept = &concept_marker_concept_comment;
+                  *e.m_parse_state.concept_write_ptr = get_parse_block();
+                  (*e.m_parse_state.concept_write_ptr)->concept = &concept_marker_concept_comment;
 
-                  (*parse_state.concept_write_ptr)->call = (call_with_name *) new_comment_block;
-                  (*parse_state.concept_write_ptr)->call_to_print =
+                  (*e.m_parse_state.concept_write_ptr)->call = (call_with_name *) new_comment_block;
+                  (*e.m_parse_state.concept_write_ptr)->call_to_print =
                      (call_with_name *) new_comment_block;
                   // Advance the write pointer.
-                  parse_state.concept_write_ptr = &((*parse_state.concept_write_ptr)->next);
+                  e.m_parse_state.concept_write_ptr = &((*e.m_parse_state.concept_write_ptr)->next);
                }
             }
 
             goto recurse_entry;
          case command_simple_mods:
             /* Increment "allowing_modifications" up to a maximum of 2. */
-            if (allowing_modifications != 2) allowing_modifications++;
+            if (e.m_allowing_modifications != 2) e.m_allowing_modifications++;
             goto check_menu;
          case command_all_mods:
-            allowing_modifications = 2;
+            e.m_allowing_modifications = 2;
             goto check_menu;
          case command_toggle_conc_levels:
-            allowing_all_concepts = !allowing_all_concepts;
+            e.m_allowing_all_concepts = !e.m_allowing_all_concepts;
             goto check_menu;
          case command_toggle_minigrand:
-            allowing_minigrand = !allowing_minigrand;
+            e.m_allowing_minigrand = !e.m_allowing_minigrand;
             goto check_menu;
          case command_toggle_bend_home:
-            allow_bend_home_getout = !allow_bend_home_getout;
+            e.m_allow_bend_home_getout = !e.m_allow_bend_home_getout;
             goto check_menu;
          case command_toggle_overflow_warn:
-            enforce_overcast_warning = !enforce_overcast_warning;
+            e.m_enforce_overcast_warning = !e.m_enforce_overcast_warning;
             goto check_menu;
          case command_toggle_act_phan:
-            using_active_phantoms = !using_active_phantoms;
+            e.m_using_active_phantoms = !e.m_using_active_phantoms;
             goto check_menu;
          case command_toggle_retain_after_error:
-            retain_after_error = !retain_after_error;
+            e.m_retain_after_error = !e.m_retain_after_error;
             goto check_menu;
          case command_toggle_nowarn_mode:
-            ui_options.nowarn_mode = !ui_options.nowarn_mode;
+            e.m_ui_options.nowarn_mode = !e.m_ui_options.nowarn_mode;
             goto check_menu;
          case command_toggle_keepallpic_mode:
-            ui_options.keep_all_pictures = !ui_options.keep_all_pictures;
+            e.m_ui_options.keep_all_pictures = !e.m_ui_options.keep_all_pictures;
             goto check_menu;
          case command_toggle_singleclick_mode:
-            ui_options.accept_single_click = !ui_options.accept_single_click;
+            e.m_ui_options.accept_single_click = !e.m_ui_options.accept_single_click;
             goto check_menu;
          case command_toggle_singer:
-            if (ui_options.singing_call_mode != 0)
-               ui_options.singing_call_mode = 0;    // Turn it off.
+            if (e.m_ui_options.singing_call_mode != 0)
+               e.m_ui_options.singing_call_mode = 0;    // Turn it off.
             else
-               ui_options.singing_call_mode = 1;    // 1 for forward progression,
+               e.m_ui_options.singing_call_mode = 1;    // 1 for forward progression,
                                                     // 2 for backward.
             goto check_menu;
          case command_toggle_singer_backward:
-            if (ui_options.singing_call_mode != 0)
-               ui_options.singing_call_mode = 0;    // Turn it off.
+            if (e.m_ui_options.singing_call_mode != 0)
+               e.m_ui_options.singing_call_mode = 0;    // Turn it off.
             else
-               ui_options.singing_call_mode = 2;
+               e.m_ui_options.singing_call_mode = 2;
             goto check_menu;
          case command_refresh:
-            written_history_items = -1;         // Suppress optimized display update.
-            global_error_flag = old_error_flag; // Want to see error messages, too.
+            e.m_written_history_items = -1;         // Suppress optimized display update.
+            e.m_global_error_flag = old_error_flag; // Want to see error messages, too.
             refresh_override = true;
             goto redisplay;
          default:
@@ -906,67 +914,67 @@ extern bool query_for_call()
          // perhaps not the best way.
          deposit_concept(concept_to_use);
          concepts_deposited++;
-         global_reply.majorpart = ui_concept_select;
+         e.m_global_reply.majorpart = ui_concept_select;
       }
       else {
-         global_reply.majorpart = ui_call_select;
+         e.m_global_reply.majorpart = ui_call_select;
       }
    }
 
-   if (global_reply.majorpart == ui_concept_select) {
+   if (e.m_global_reply.majorpart == ui_concept_select) {
       goto recurse_entry;
    }
-   else if (global_reply.majorpart != ui_call_select) {
+   else if (e.m_global_reply.majorpart != ui_call_select) {
       return true;
    }
 
    /* We have a call.  Get the actual call and deposit it into the parse tree,
       if we haven't already. */
 
-   global_reply = global_reply_save;
+   e.m_global_reply = global_reply_save;
 
-   if (interactivity == interactivity_database_init || interactivity == interactivity_verify)
+   if (e.m_interactivity == interactivity_database_init || e.m_interactivity == interactivity_verify)
       fail_no_retry("This shouldn't get printed.");
-   else if (interactivity != interactivity_normal) {
+   else if (e.m_interactivity != interactivity_normal) {
       if (deposit_call(do_pick(), &null_options))
          fail_no_retry("This shouldn't get printed.");
    }
 
    /* Check our "stack" and see if we have recursive invocations to clean up. */
 
-   if (parse_state.parse_stack_index != 0) {
+   if (e.m_parse_state.parse_stack_index != 0) {
       /* Set stuff up for reading second call and its concepts. */
 
       /* Create a new parse block, point concept_write_ptr at its contents. */
       /* Fill in the pointer to the second parse block. */
 
-      parse_state.concept_write_ptr = parse_state.parse_stack[--parse_state.parse_stack_index].concept_write_save_ptr;
+      e.m_parse_state.concept_write_ptr = e.m_parse_state.parse_stack[--e.m_parse_state.parse_stack_index].concept_write_save_ptr;
 
-      (*parse_state.concept_write_ptr)->subsidiary_root = (parse_block *) 0;
-      parse_state.concept_write_base = &(*parse_state.concept_write_ptr)->subsidiary_root;
-      parse_state.concept_write_ptr = parse_state.concept_write_base;
-      *parse_state.concept_write_ptr = (parse_block *) 0;
+      (*e.m_parse_state.concept_write_ptr)->subsidiary_root = (parse_block *) 0;
+      e.m_parse_state.concept_write_base = &(*e.m_parse_state.concept_write_ptr)->subsidiary_root;
+      e.m_parse_state.concept_write_ptr = e.m_parse_state.concept_write_base;
+      *e.m_parse_state.concept_write_ptr = (parse_block *) 0;
 
-      parse_state.call_list_to_use = call_list_any;
+      e.m_parse_state.call_list_to_use = call_list_any;
 
-      switch (parse_state.parse_stack[parse_state.parse_stack_index].save_concept_kind) {
+      switch (e.m_parse_state.parse_stack[e.m_parse_state.parse_stack_index].save_concept_kind) {
       case concept_centers_and_ends:
-         strncpy(parse_state.specialprompt, "ENTER CALL FOR OUTSIDES", MAX_TEXT_LINE_LENGTH);
+         strncpy(e.m_parse_state.specialprompt, "ENTER CALL FOR OUTSIDES", MAX_TEXT_LINE_LENGTH);
          break;
       case concept_on_your_own:
-         strncpy(parse_state.specialprompt, "ENTER SECOND (CENTERS) CALL", MAX_TEXT_LINE_LENGTH);
+         strncpy(e.m_parse_state.specialprompt, "ENTER SECOND (CENTERS) CALL", MAX_TEXT_LINE_LENGTH);
          break;
       default:
-         strncpy(parse_state.specialprompt, "ENTER SECOND CALL", MAX_TEXT_LINE_LENGTH);
+         strncpy(e.m_parse_state.specialprompt, "ENTER SECOND CALL", MAX_TEXT_LINE_LENGTH);
          break;
       }
 
-      parse_state.topcallflags1 = 0;          /* Erase anything we had -- it is meaningless now. */
+      e.m_parse_state.topcallflags1 = 0;          /* Erase anything we had -- it is meaningless now. */
       goto recurse_entry;
    }
 
    /* Advance the write pointer. */
-   parse_state.concept_write_ptr = &((*parse_state.concept_write_ptr)->next);
+   e.m_parse_state.concept_write_ptr = &((*e.m_parse_state.concept_write_ptr)->next);
 
    return false;
 }
@@ -993,6 +1001,8 @@ ui_option_type::ui_option_type() :
    tab_changes_focus(false),
    max_print_length(59),
    resolve_test_minutes(0),
+   resolve_threads(0),
+   resolve_statistics(false),
    singing_call_mode(0),
    use_escapes_for_drawing_people(0),
    pn1("11223344"),
@@ -1004,8 +1014,19 @@ ui_option_type::ui_option_type() :
 {}
 
 
+// Run Sd in the given engine.  The caller owns the engine; a UI that runs several
+// sessions at once gives each its own.
+
+extern int sdmain(int argc, char *argv[], iobase & ggg, engine_context & engine)
+{
+   engine_context::scope bind(engine);
+   return sdmain(argc, argv, ggg);
+}
+
+
 extern int sdmain(int argc, char *argv[], iobase & ggg)
 {
+   engine_context & e = *current_engine;
 //    printf("sdmain: argc=%d\n", argc);
 //    fflush(stdout);
    bool just_get_out_of_here = false;
@@ -1055,22 +1076,24 @@ extern int sdmain(int argc, char *argv[], iobase & ggg)
       printf("-new_style_filename         use long file name, as in \"" SEQUENCE_FILENAME "_MS.txt\"\n");
       printf("-db <filename>              calls database file (def \"" DATABASE_FILENAME "\")\n");
       printf("-sequence_num <n>           use this initial sequence number\n");
+      printf("-resolve_threads <n>        search with this many threads (def one per processor)\n");
+      printf("-resolve_statistics         show search speed and transposition table hits in resolve title\n");
 
       ggg.display_help(); // Get any others that the UI wants to tell us about.
       just_get_out_of_here = true;
    }
 
    enable_file_writing = false;
-   interactivity = interactivity_database_init;
-   testing_fidelity = false;
+   e.m_interactivity = interactivity_database_init;
+   e.m_testing_fidelity = false;
    header_comment[0] = 0;
    abridge_filename[0] = 0;
-   verify_options.who = selector_uninitialized;
-   verify_options.number_fields = 0;
-   verify_options.howmanynumbers = 0;
+   e.m_verify_options.who = selector_uninitialized;
+   e.m_verify_options.number_fields = 0;
+   e.m_verify_options.howmanynumbers = 0;
    GLOB_doing_frequency = false;
-   history_allocation = 15;
-   configuration::history = new configuration[history_allocation];
+   e.m_history_allocation = 15;
+   configuration::history() = new configuration[e.m_history_allocation];
 
    // Read the command line arguments and process the initialization file.
    // This will return TRUE if we are to cease execution immediately.
@@ -1083,8 +1106,8 @@ extern int sdmain(int argc, char *argv[], iobase & ggg)
 
    global_cache_failed_flag = false;
 
-   // The "ui_utils" object is a singleton.  It will be accessed by the global static variable "gg77".
-   // (Declared in sdbase.h, proclaimed in sdtop.cpp.)
+   // The "ui_utils" object is a singleton for this engine.  It will be accessed by "gg77",
+   // which is kept in the engine_context that this thread is running.  (Declared in sdui.h.)
    //
    // There are two other important global singleton objects inside the "ui_utils" object:
    //    The "matcher_p" field is a pointer to the matcher, which is in sdmatch.cpp.  We instantiate
@@ -1093,17 +1116,18 @@ extern int sdmain(int argc, char *argv[], iobase & ggg)
    //       This is the base interface class that distinguishes between Sd and Sdtty.
    //       It is instantiated in the top-level Sd/Sdtty file and passed to us as incoming argument ggg.
    //
-   // These are all declared in sdbase.h.
+   // These are all declared in sdbase.h.  The first two belong to this engine; the
+   // user interface is whatever the caller gave us.
 
    matcher_class global_matcher;
    ui_utils thingy(&global_matcher, ggg);
-   gg77 = &thingy;
+   e.m_gg77 = &thingy;
 
    if (just_get_out_of_here) general_final_exit(0);  // general_final_exit requires gg77, even if just doing "-help".
 
    // In addition to the "ui_utils" object having a reference ("iob88") to the user interface,
    // the user interface needs a pointer back to the "ui_utils" object.  This is set with "set_utils_ptr".
-   ggg.set_utils_ptr(gg77);
+   ggg.set_utils_ptr(e.m_gg77);
 
    if (!open_session(argc, argv)) {
       thingy.run_program(ggg);
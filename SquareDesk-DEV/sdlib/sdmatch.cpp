@@ -26,6 +26,7 @@
 /* This file defines the following functions:
    matcher_initialize
    all methods of matcher_class
+   all methods of name_trie
 */
 
 #include <string.h> /* for strcpy */
@@ -226,44 +227,45 @@ int translate_keybind_spec(char key_name[])
 
 
 
-// This returns zero if the name was clearly not able to be hashed
-// (contains NUL, comma, atsign, or single quote).  It returns 1
-// if it could clearly be hashed (no blanks).  It returns 2 if it
-// had blanks, and might be questionable.  Patterns to match
-// (call or concept names, etc. can have blanks in them and still
-// be hashed.  Strings the user types can't be hashed if they have blanks.
-int get_hash(Cstring string, int *bucket_p)
+// Put a call or concept name into a name trie.  A name that starts with a wildcard
+// goes on the typed edge for the words that can be there.  A few escapes at the start
+// of a name just get dropped, like "@2" in "@2scoot and plenty".
+void add_name(name_trie & trie, Cstring name, int item)
 {
-   char c1 = string[0];
-   char c2 = string[1];
-   char c3 = string[2];
-   int bucket;
-
-   if (c1 == '<' && ((int) c2 & ~32) == 'A' && ((int) c3 & ~32) == 'N') {
-      *bucket_p = matcher_class::BRACKET_HASH;
-      return 1;
-   }
-   else if ((c1 && c1 != ',' && c1 != '@' && c1 != '\'') &&
-            (c2 && c2 != ',' && c2 != '@' && c2 != '\'') &&
-            (c3 && c3 != ',' && c3 != '@' && c3 != '\'')) {
-      // We use a hash function that ignores the "32" bit, so it is insensitive to case.
-      bucket = (((((int) c1 & ~32) << 3) + ((int) c2 & ~32)) << 3) + ((int) c3 & ~32);
-      bucket += bucket * 20;
-      bucket += bucket >> 7;
-      bucket &= (matcher_class::NUM_NAME_HASH_BUCKETS-1);
-      *bucket_p = bucket;
-
-      if (c1 != ' ' && c2 != ' ' && c3 != ' ') return 1;
-      else return 2;
-   }
-   else
-      return 0;
-}
+   matcher_class *m = current_engine->m_gg77->matcher_p;
 
+   while (name[0] == '@') {
+      switch (name[1]) {
+      case '6': case 'k': case 'K': case 'V':
+         // This is a call like "<anyone> run".
+         trie.add_after(&m->m_selector_words, item);
+         return;
+      case 'v': case 'w': case 'x': case 'y':
+         // This is a call like "<atc> your neighbor".
+         trie.add_after(&m->m_tagger_words, item);
+         return;
+      case '0': case 'T': case 'm':
+         // This is a call like "[anything] and roll".
+         trie.add_after(&m->m_anything_words, item);
+         return;
+      case 'e':
+         // "@eright@f anchor 1/4" can also be "left anchor 1/4".  The rest of
+         // the name is past an escape as far as the trie is concerned.
+         trie.add("left@", item);
+         name += 2;
+         continue;
+      default:
+         if (!get_escape_string(name[1])) {
+            name += 2;
+            continue;
+         }
+         break;
+      }
 
-void hash_me(int bucket, int i)
-{
-   gg77->matcher_p->call_hashers[bucket].add_one(i);
+      break;
+   }
+
+   trie.add(name, item);
 }
 
 
@@ -282,6 +284,301 @@ bool foobar(const char *user)
 
 }   // namespace
 
+name_trie::name_trie() : m_nodes(new node[16]),
+                         m_node_count(1),
+                         m_node_allocation(16),
+                         m_edge_count(0),
+                         m_path_size(0)
+{
+   // Node zero is the root.
+   m_nodes[0].letter = 0;
+   m_nodes[0].first_child = -1;
+   m_nodes[0].next_sibling = -1;
+   m_nodes[0].spelling_size = 0;
+   m_nodes[0].spelling_common = 0;
+   m_nodes[0].name_ends = false;
+}
+
+// The index lists don't free themselves, so we do it here.
+name_trie::~name_trie()
+{
+   int i;
+
+   for (i=0 ; i<m_node_count ; i++) {
+      delete [] m_nodes[i].items.the_list;
+      delete [] m_nodes[i].open_items.the_list;
+   }
+
+   for (i=0 ; i<m_edge_count ; i++)
+      delete [] m_edge_items[i].the_list;
+
+   delete [] m_nodes;
+}
+
+// Returns the character as the matcher compares it, or zero if it can be left out.
+char name_trie::fold(char c)
+{
+   if (c >= 'A' && c <= 'Z') return c+'a'-'A';
+   else if (c == '-') return ' ';
+   else if (c == ',' || c == '\'') return 0;
+   else return c;
+}
+
+// Items come in increasing order, and a name can go through the same node
+// twice, so we only have to look at the end of the list for duplicates.
+void name_trie::add_item(index_list & list, int item)
+{
+   if (list.the_list_size == 0 || list.the_list[list.the_list_size-1] != item)
+      list.add_one(item);
+}
+
+int name_trie::make_child(int parent, char letter)
+{
+   int child;
+
+   for (child = m_nodes[parent].first_child ; child >= 0 ; child = m_nodes[child].next_sibling) {
+      if (m_nodes[child].letter == letter) return child;
+   }
+
+   if (m_node_count >= m_node_allocation) {
+      m_node_allocation = m_node_allocation*2;
+      node *new_nodes = new node[m_node_allocation];
+      for (int i=0 ; i<m_node_count ; i++) new_nodes[i] = m_nodes[i];
+      delete [] m_nodes;
+      m_nodes = new_nodes;
+   }
+
+   child = m_node_count++;
+   m_nodes[child].letter = letter;
+   m_nodes[child].first_child = -1;
+   m_nodes[child].next_sibling = m_nodes[parent].first_child;
+   m_nodes[child].spelling_size = 0;
+   m_nodes[child].spelling_common = 0;
+   m_nodes[child].name_ends = false;
+   m_nodes[parent].first_child = child;
+   return child;
+}
+
+void name_trie::add(Cstring name, int item)
+{
+   int n = 0;
+   int depth = 0;
+   char spelling[MAX_SPELLING];
+   int spelling_size = 0;     // Or -1 if it didn't fit.
+
+   add_item(m_nodes[0].items, item);
+
+   for ( ; *name && *name != '@' && depth < MAX_DEPTH ; name++) {
+      if (spelling_size >= MAX_SPELLING) spelling_size = -1;
+      if (spelling_size >= 0) spelling[spelling_size++] = tolower(*name);
+
+      char c = fold(*name);
+      if (!c) continue;
+      n = make_child(n, c);
+      depth++;
+
+      node & here = m_nodes[n];
+
+      if (here.items.the_list_size == 0) {
+         // This is the first name through here.
+         if (spelling_size >= 0) {
+            ::memcpy(here.spelling, spelling, spelling_size);
+            here.spelling_size = spelling_size;
+         }
+         here.spelling_common = spelling_size;
+      }
+      else if (here.spelling_common >= 0) {
+         if (spelling_size < 0)
+            here.spelling_common = -1;
+         else {
+            int i;
+            for (i=0 ; i<here.spelling_common && i<spelling_size && spelling[i] == here.spelling[i] ; i++) ;
+            here.spelling_common = i;
+         }
+      }
+
+      add_item(here.items, item);
+      spelling_size = 0;
+   }
+
+   if (*name != '@') m_nodes[n].name_ends = true;
+   add_item(m_nodes[n].open_items, item);
+}
+
+void name_trie::add_after(const name_trie *words, int item)
+{
+   int i;
+
+   for (i=0 ; i<m_edge_count ; i++) {
+      if (m_edge_words[i] == words) break;
+   }
+
+   if (i == m_edge_count) {
+      if (m_edge_count >= MAX_EDGES)
+         current_engine->m_gg77->iob88.fatal_error_exit(2, "Too many wildcards in name trie");
+      m_edge_words[m_edge_count++] = words;
+   }
+
+   add_item(m_edge_items[i], item);
+}
+
+// Follow the text down the tree, collecting the open lists of the nodes we pass.
+// Returns the node where the text ran out, or -1 if the tree ran out first.
+// As long as the text agrees with the last one, we just retrace that path.
+int name_trie::walk(Cstring text, const index_list **open_lists, int *open_count) const
+{
+   int n = 0;
+   int depth = 0;
+
+   *open_count = 0;
+
+   for (;;) {
+      if (m_nodes[n].open_items.the_list_size != 0)
+         open_lists[(*open_count)++] = &m_nodes[n].open_items;
+
+      char c = 0;
+      while (*text && !(c = fold(*text))) text++;
+      if (!*text++) return n;
+
+      if (depth < m_path_size && m_path_letters[depth] == c) {
+         n = m_path_nodes[depth];
+      }
+      else {
+         for (n = m_nodes[n].first_child ; n >= 0 ; n = m_nodes[n].next_sibling) {
+            if (m_nodes[n].letter == c) break;
+         }
+
+         if (n < 0) {
+            m_path_size = depth;
+            return -1;
+         }
+
+         m_path_letters[depth] = c;
+         m_path_nodes[depth] = n;
+         m_path_size = depth+1;
+      }
+
+      depth++;
+   }
+}
+
+// Tells whether the text could begin with one of the words, or be the
+// beginning of one.
+bool name_trie::accepts(Cstring text) const
+{
+   const index_list *open_lists[MAX_DEPTH+1];
+   int open_count;
+   int n = walk(text, open_lists, &open_count);
+
+   if (open_count != 0 || (n >= 0 && m_nodes[n].items.the_list_size != 0))
+      return true;
+
+   for (int i=0 ; i<m_edge_count ; i++) {
+      if (m_edge_words[i]->accepts(text)) return true;
+   }
+
+   return false;
+}
+
+bool name_trie::complete(Cstring text, char *extension, bool *space_ok) const
+{
+   const index_list *open_lists[MAX_DEPTH+1];
+   int open_count;
+   int size = 0;
+   int child;
+
+   *space_ok = false;
+
+   // The matcher is fussier than the trie about these.
+   for (Cstring p = text ; *p ; p++) {
+      if (fold(*p) != *p) return false;
+   }
+
+   int n = walk(text, open_lists, &open_count);
+
+   if (n <= 0) return false;
+
+   // The names on the open lists and the typed edges have escapes, and the
+   // matcher goes through those itself.  But it would take a name that ended
+   // on the way here on to whatever follows it in the pattern.
+   if (m_nodes[0].name_ends) return false;
+
+   for (int i=0 ; text[i] ; i++) {
+      if (m_nodes[m_path_nodes[i]].name_ends) return false;
+   }
+
+   for (child = m_nodes[n].first_child ; child >= 0 ; child = m_nodes[child].next_sibling) {
+      if (m_nodes[child].letter == ' ') *space_ok = true;
+   }
+
+   for (;;) {
+      const node & here = m_nodes[n];
+
+      // If a name ends or has an escape here, we don't know what comes next.
+      if (here.open_items.the_list_size != 0 || here.first_child < 0) return false;
+
+      const node & next = m_nodes[here.first_child];
+      int common = next.spelling_common;
+
+      if (common < 0) return false;
+
+      for (child = next.next_sibling ; child >= 0 ; child = m_nodes[child].next_sibling) {
+         const node & other = m_nodes[child];
+         int i;
+
+         if (other.spelling_common < 0) return false;
+
+         for (i=0 ; i<common && i<other.spelling_common && other.spelling[i] == next.spelling[i] ; i++) ;
+         common = i;
+      }
+
+      ::memcpy(&extension[size], next.spelling, common);
+      size += common;
+
+      // Stop where the names go different ways, or just spell the next letter differently.
+      if (next.next_sibling >= 0 || common < next.spelling_size) break;
+
+      n = here.first_child;
+   }
+
+   extension[size] = 0;
+   return true;
+}
+
+name_trie::finder::finder(const name_trie & trie, Cstring text) : m_last(-1)
+{
+   int n = trie.walk(text, m_lists, &m_count);
+
+   if (n >= 0) m_lists[m_count++] = &trie.m_nodes[n].items;
+
+   for (int i=0 ; i<trie.m_edge_count ; i++) {
+      if (trie.m_edge_words[i]->accepts(text))
+         m_lists[m_count++] = &trie.m_edge_items[i];
+   }
+
+   for (int i=0 ; i<m_count ; i++) m_positions[i] = 0;
+}
+
+// Merge the lists, leaving out duplicates.
+int name_trie::finder::next()
+{
+   int best = -1;
+
+   for (int i=0 ; i<m_count ; i++) {
+      const index_list *list = m_lists[i];
+      int & pos = m_positions[i];
+
+      while (pos < list->the_list_size && list->the_list[pos] <= m_last) pos++;
+
+      if (pos < list->the_list_size && (best < 0 || list->the_list[pos] < best))
+         best = list->the_list[pos];
+   }
+
+   if (best >= 0) m_last = best;
+   return best;
+}
+
+
 void matcher_class::copy_sublist(const match_result *outbar, modifier_block *tails)
 {
    if (outbar->real_next_subcall) {
@@ -365,6 +662,7 @@ int matcher_class::delete_matcher_word()
 // Returns true if it processed the thing.
 bool matcher_class::process_accel_or_abbrev(modifier_block & mb, char linebuff[])
 {
+   engine_context & e = *current_engine;
    m_active_result.match = mb;
    m_active_result.indent = false;
    m_active_result.real_next_subcall = (match_result *) 0;
@@ -384,18 +682,18 @@ bool matcher_class::process_accel_or_abbrev(modifier_block & mb, char linebuff[]
       strcpy(linebuff, startup_commands[m_final_result.match.index]);
       break;
    case ui_concept_select:
-      gg77->unparse_call_name(get_concept_name(m_final_result.match.concept_ptr),
+      e.m_gg77->unparse_call_name(get_concept_name(m_final_result.match.concept_ptr),
                               linebuff,
                               &m_final_result.match.call_conc_options);
       // Reject off-level concept accelerator key presses.
-      if (!allowing_all_concepts &&
+      if (!e.m_allowing_all_concepts &&
           get_concept_level(m_final_result.match.concept_ptr) > calling_level)
          return false;
 
       m_final_result.match.index = 0;
       break;
    case ui_call_select:
-      gg77->unparse_call_name(get_call_name(m_final_result.match.call_ptr),
+      e.m_gg77->unparse_call_name(get_call_name(m_final_result.match.call_ptr),
                               linebuff,
                               &m_final_result.match.call_conc_options);
       m_final_result.match.index = 0;
@@ -413,6 +711,7 @@ bool matcher_class::process_accel_or_abbrev(modifier_block & mb, char linebuff[]
 
 void matcher_class::do_accelerator_spec(Cstring inputline, bool is_accelerator)
 {
+   engine_context & e = *current_engine;
    if (!inputline[0] || inputline[0] == '\r' || inputline[0] == '\n' || inputline[0] == '#') return;   // This is a blank line or a comment.
 
    char key_name[MAX_FILENAME_LENGTH];
@@ -441,7 +740,7 @@ void matcher_class::do_accelerator_spec(Cstring inputline, bool is_accelerator)
    }
 
    if (keybindcode < 0)
-      gg77->iob88.fatal_error_exit(1, "Bad format in key binding", inputline);
+      e.m_gg77->iob88.fatal_error_exit(1, "Bad format in key binding", inputline);
 
    m_active_result.match.kind = ui_call_select;
 
@@ -478,7 +777,7 @@ void matcher_class::do_accelerator_spec(Cstring inputline, bool is_accelerator)
          // something could just mean that it was a call off the list.  At C4X, we
          // take it seriously.  So the initialization file should always be tested at C4X.
          if (calling_level >= l_c4x)
-            gg77->iob88.fatal_error_exit(1, "Didn't find target of accelerator or abbreviation", inputline);
+            e.m_gg77->iob88.fatal_error_exit(1, "Didn't find target of accelerator or abbreviation", inputline);
 
          return;
       }
@@ -486,7 +785,7 @@ void matcher_class::do_accelerator_spec(Cstring inputline, bool is_accelerator)
       if (m_active_result.match.packed_next_conc_or_subcall ||
           m_active_result.match.packed_secondary_subcall) {
          if (calling_level >= l_c4x)
-            gg77->iob88.fatal_error_exit(1, "Target of accelerator or abbreviation is too complicated", inputline);
+            e.m_gg77->iob88.fatal_error_exit(1, "Target of accelerator or abbreviation is too complicated", inputline);
 
          return;
       }
@@ -507,13 +806,13 @@ void matcher_class::do_accelerator_spec(Cstring inputline, bool is_accelerator)
          table_thing = &m_fcn_key_table_normal[keybindcode-FCN_KEY_TAB_LOW];
       }
       else
-         gg77->iob88.fatal_error_exit(1, "Anomalous accelerator", inputline);
+         e.m_gg77->iob88.fatal_error_exit(1, "Anomalous accelerator", inputline);
 
       modifier_block *newthing = new modifier_block;
       *newthing = m_active_result.match;
 
       if (*table_thing)
-         gg77->iob88.fatal_error_exit(1, "Redundant accelerator", inputline);
+         e.m_gg77->iob88.fatal_error_exit(1, "Redundant accelerator", inputline);
 
       *table_thing = newthing;
    }
@@ -532,7 +831,7 @@ void matcher_class::do_accelerator_spec(Cstring inputline, bool is_accelerator)
          table_thing = &m_abbrev_table_normal;
       }
       else
-         gg77->iob88.fatal_error_exit(1, "Anomalous abbreviation", inputline);
+         e.m_gg77->iob88.fatal_error_exit(1, "Anomalous abbreviation", inputline);
 
       abbrev_block *newthing = new abbrev_block;
       newthing->key = new char[::strlen(key_org)+1];
@@ -553,13 +852,14 @@ void matcher_class::do_accelerator_spec(Cstring inputline, bool is_accelerator)
 */
 void matcher_initialize()
 {
-   int i, j;
+   engine_context & e = *current_engine;
+   int i;
    int concept_number;
    const concept_descriptor *p;
 
    // Decide whether we allow the "diagnose" concept, by deciding
    // when we will stop the concept list scan.
-   concept_kind end_marker = (ui_options.diagnostic_mode) ?
+   concept_kind end_marker = (e.m_ui_options.diagnostic_mode) ?
       constant_with_marker_end_of_list :
       constant_with_concept_diagnose;
 
@@ -568,201 +868,46 @@ void matcher_initialize()
    for (concept_number=0 ; ; concept_number++) {
       p = access_concept_descriptor_table(concept_number);
       if (get_concept_kind(p) == end_marker) break;
-      gg77->matcher_p->m_concept_list.add_one(concept_number);
+      e.m_gg77->matcher_p->m_concept_list.add_one(concept_number);
       if (get_concept_level(p) <= calling_level)
-         gg77->matcher_p->m_level_concept_list.add_one(concept_number);
+         e.m_gg77->matcher_p->m_level_concept_list.add_one(concept_number);
    }
 
-   // Initialize the hash buckets for call names.
-
-   int bucket;
-   uint32 ku;
-
-   // First, do the selectors.  Before that, be sure "<anyone>" is hashed.
-   // These list all the buckets that selectors can go to.
+   // Build the name tries.  First, the words that the wildcards can stand for.
+   // A tagger can start with a selector, so the selectors come first.
 
-   if (!get_hash("<an", &bucket))
-      gg77->iob88.fatal_error_exit(2, "Can't hash selector base");
+   matcher_class *m = e.m_gg77->matcher_p;
 
-   index_list selector_hasher;
-   selector_hasher.add_one(bucket);
+   m->m_selector_words.add("<anyone>", 0);
 
    for (i=1; i<selector_INVISIBLE_START; i++) {
-      if (!get_hash(selector_list[i].name, &bucket)) {
-         char errbuf[255];
-         sprintf(errbuf, "Can't hash selector %d - 1!", i);
-         gg77->iob88.fatal_error_exit(2, errbuf);
-      }
-
-      /* See if this bucket is already accounted for. */
-
-      for (j=0; j<selector_hasher.the_list_size; j++) {
-         if (selector_hasher.the_list[j] == bucket) goto already_in1;
-      }
-
-      selector_hasher.add_one(bucket);
-
-      // Now do it again for the singular names.
-
-   already_in1:
-
-      if (!get_hash(selector_list[i].sing_name, &bucket)) {
-         char errbuf[255];
-         sprintf(errbuf, "Can't hash selector %d - 2!", i);
-         gg77->iob88.fatal_error_exit(2, errbuf);
-      }
-
-      for (j=0; j<selector_hasher.the_list_size; j++) {
-         if (selector_hasher.the_list[j] == bucket) goto already_in2;
-      }
-
-      selector_hasher.add_one(bucket);
-
-   already_in2: ;
+      m->m_selector_words.add(selector_list[i].name, 0);
+      m->m_selector_words.add(selector_list[i].sing_name, 0);
    }
 
-   // Next, do the taggers.  Before that, be sure "<atc>" is hashed.
-   // These list all the buckets that taggers can go to.
-
-   if (!get_hash("<at", &bucket))
-      gg77->iob88.fatal_error_exit(2, "Can't hash tagger base!");
-
-   index_list tagger_hasher;
-   tagger_hasher.add_one(bucket);
+   m->m_tagger_words.add("<atc>", 0);
 
    for (i=0; i<NUM_TAGGER_CLASSES; i++) {
-      for (ku=0; ku<number_of_taggers[i]; ku++) {
-         // Some taggers ("@6 start vertical tag") can't be hashed because
-         // of the at sign.  That's OK.
-         if (get_call_name(tagger_calls[i][ku])[0] != '@') {
-            if (!get_hash(get_call_name(tagger_calls[i][ku]), &bucket)) {
-               char errbuf[255];
-               sprintf(errbuf, "Can't hash tagger %d %d!", i, (int) ku);
-               gg77->iob88.fatal_error_exit(2, errbuf);
-            }
-         }
-
-         for (j=0; j<tagger_hasher.the_list_size; j++) {
-            if (tagger_hasher.the_list[j] == bucket) goto already_in3;
-         }
-
-         tagger_hasher.add_one(bucket);
-
-      already_in3: ;
-      }
-   }
-
-   /* Now do the calls. */
-
-   for (i=0; i<number_of_calls[call_list_any]; i++) {
-      Cstring name = get_call_name(main_call_lists[call_list_any][i]);
-
-   doitagain:
-
-      if (name[0] == '@') {
-         switch (name[1]) {
-         case '6': case 'k': case 'K': case 'V':
-            // This is a call like "<anyone> run".  Put it into every bucket
-            // that could match a selector.
-
-            for (j=0 ; j<selector_hasher.the_list_size ; j++)
-               hash_me(selector_hasher.the_list[j], i);
-
-            continue;
-         case 'v': case 'w': case 'x': case 'y':
-            // This is a call like "<atc> your neighbor".
-            // Put it into every bucket that could match a tagger.
-
-            for (j=0 ; j<tagger_hasher.the_list_size ; j++)
-               hash_me(tagger_hasher.the_list[j], i);
-
-            continue;
-         case '0': case 'T': case 'm':
-            // We act as though any string starting with "[" hashes to BRACKET_HASH.
-            hash_me(matcher_class::BRACKET_HASH, i);
-            continue;
-         case 'e':
-            // If this is "@e", hash it to both "left" and to whatever naturally follows.
-            (void) get_hash("left", &bucket);
-            hash_me(bucket, i);
-            name += 2;
-            goto doitagain;
-         default:
-            if (!get_escape_string(name[1])) {
-               // If this escape is something like "@2", as in "@2scoot and plenty",
-               // ignore it.  Hash it under "scoot and plenty".
-               name += 2;
-               goto doitagain;
-            }
-            break;
-         }
-      }
-
-      if (get_hash(name, &bucket)) {
-         hash_me(bucket, i);
-         continue;
-      }
-
-      // If we get here, this call needs to be put into the extra bucket at the end,
-      // and also into EVERY OTHER BUCKET!!!!
-      for (bucket=0 ; bucket < matcher_class::NUM_NAME_HASH_BUCKETS+1 ; bucket++)
-         hash_me(bucket, i);
+      for (uint32 ku=0; ku<number_of_taggers[i]; ku++)
+         add_name(m->m_tagger_words, get_call_name(tagger_calls[i][ku]), 0);
    }
 
-   // Now do the concepts from the full concept list.
+   m->m_anything_words.add("[", 0);
+   m->m_anything_words.add("<anything>", 0);
 
-   for (i=0; i<gg77->matcher_p->m_concept_list.the_list_size; i++) {
-      int the_item = gg77->matcher_p->m_concept_list.the_list[i];
-      Cstring name = get_concept_name(access_concept_descriptor_table(the_item));
+   // Now the calls and concepts.
 
-      if (name[0] == '@' && (name[1] == '6' || name[1] == 'k' || name[1] == 'K' || name[1] == 'V')) {
-         // This is a call like "<anyone> run".  Put it into every bucket
-         // that could match a selector.
-
-         for (j=0 ; j<selector_hasher.the_list_size ; j++) {
-            bucket = selector_hasher.the_list[j];
-            gg77->matcher_p->conc_hashers[bucket].add_one(the_item);
-         }
-         continue;
-      }
-      else if (get_hash(name, &bucket)) {
-         gg77->matcher_p->conc_hashers[bucket].add_one(the_item);
-         continue;
-      }
+   for (i=0; i<number_of_calls[call_list_any]; i++)
+      add_name(m->m_call_trie, get_call_name(main_call_lists[call_list_any][i]), i);
 
-      // If we get here, this concept needs to be put into the extra bucket at the end,
-      // and also into EVERY OTHER BUCKET!!!!
-      for (bucket=0 ; bucket < matcher_class::NUM_NAME_HASH_BUCKETS+1 ; bucket++) {
-         gg77->matcher_p->conc_hashers[bucket].add_one(the_item);
-      }
+   for (i=0; i<m->m_concept_list.the_list_size; i++) {
+      int the_item = m->m_concept_list.the_list[i];
+      add_name(m->m_concept_trie, get_concept_name(access_concept_descriptor_table(the_item)), the_item);
    }
 
-   // Now do the "level concepts".
-
-   for (i=0; i<gg77->matcher_p->m_level_concept_list.the_list_size; i++) {
-      int the_item = gg77->matcher_p->m_level_concept_list.the_list[i];
-      Cstring name = get_concept_name(access_concept_descriptor_table(the_item));
-
-      if (name[0] == '@' && (name[1] == '6' || name[1] == 'k' || name[1] == 'K' || name[1] == 'V')) {
-         // This is a call like "<anyone> run".  Put it into every bucket
-         // that could match a selector.
-
-         for (j=0 ; j<selector_hasher.the_list_size ; j++) {
-            bucket = selector_hasher.the_list[j];
-            gg77->matcher_p->conclvl_hashers[bucket].add_one(the_item);
-         }
-         continue;
-      }
-      else if (get_hash(name, &bucket)) {
-         gg77->matcher_p->conclvl_hashers[bucket].add_one(the_item);
-         continue;
-      }
-
-      // If we get here, this concept needs to be put into the extra bucket at the end,
-      // and also into EVERY OTHER BUCKET!!!!
-      for (bucket=0 ; bucket < matcher_class::NUM_NAME_HASH_BUCKETS+1 ; bucket++) {
-         gg77->matcher_p->conclvl_hashers[bucket].add_one(the_item);
-      }
+   for (i=0; i<m->m_level_concept_list.the_list_size; i++) {
+      int the_item = m->m_level_concept_list.the_list[i];
+      add_name(m->m_level_concept_trie, get_concept_name(access_concept_descriptor_table(the_item)), the_item);
    }
 }
 
@@ -773,11 +918,6 @@ void matcher_initialize()
 
 
 
-/* These variables are actually local to verify_call, but they are
-   expected to be preserved across the throw, so they must be static. */
-static parse_block *parse_mark;
-static call_list_kind savecl;
-
 /*
  * Return TRUE if the specified call appears to be legal in the
  * current context.
@@ -785,30 +925,31 @@ static call_list_kind savecl;
 
 bool matcher_class::verify_call()
 {
+   engine_context & e = *current_engine;
    // If we are not verifying, we return TRUE immediately,
    // thereby causing the item to be listed.
    if (!m_verify) return true;
 
    bool resultval = true;
-   interactivity = interactivity_verify;   // So deposit_call doesn't ask user for info.
+   e.m_interactivity = interactivity_verify;   // So deposit_call doesn't ask user for info.
    warning_info saved_warnings = config_save_warnings();
-   int old_history_ptr = config_history_ptr;
+   int old_history_ptr = e.m_config_history_ptr;
 
-   parse_mark = get_parse_block_mark();
+   e.m_matcher_parse_mark = get_parse_block_mark();
    save_parse_state();
-   savecl = parse_state.call_list_to_use;
+   e.m_matcher_savecl = e.m_parse_state.call_list_to_use;
 
    start_sel_dir_num_iterator();
 
  try_another_selector:
 
-   selector_used = false;
-   direction_used = false;
-   number_used = false;
-   mandatory_call_used = false;
-   verify_used_number = false;
-   verify_used_selector = false;
-   verify_used_direction = false;
+   e.m_selector_used = false;
+   e.m_direction_used = false;
+   e.m_number_used = false;
+   e.m_mandatory_call_used = false;
+   e.m_verify_used_number = false;
+   e.m_verify_used_selector = false;
+   e.m_verify_used_direction = false;
 
    // Do the call.  An error will signal and go to failed.
 
@@ -835,30 +976,30 @@ bool matcher_class::verify_call()
             set_parse_block_call(tt, access_base_calls(base_call_null));
             set_parse_block_call_to_print(tt, access_base_calls(base_call_null));
             set_parse_block_replacement_key(tt, DFM1_CALL_MOD_MAND_ANYCALL/DFM1_CALL_MOD_BIT);
-            parse_state.concept_write_ptr = get_parse_block_subsidiary_root_addr(tt);
+            e.m_parse_state.concept_write_ptr = get_parse_block_subsidiary_root_addr(tt);
             save1 = (parse_block *) 0;
          }
 
          m_final_result.match.call_conc_options = anythings->call_conc_options;
 
          if (anythings->kind == ui_call_select) {
-            verify_options = anythings->call_conc_options;
+            e.m_verify_options = anythings->call_conc_options;
             if (deposit_call(anythings->call_ptr, &anythings->call_conc_options)) {
                // The problem may be just that the current number is
                // inconsistent with the call's "odd number only" requirement.
-               number_used = true;
-               if (iterate_over_sel_dir_num(verify_used_selector,
-                                            verify_used_direction,
-                                            verify_used_number))
+               e.m_number_used = true;
+               if (iterate_over_sel_dir_num(e.m_verify_used_selector,
+                                            e.m_verify_used_direction,
+                                            e.m_verify_used_number))
                   goto try_another_selector;
 
                goto failed;
             }
-            save1 = *parse_state.concept_write_ptr;
+            save1 = *e.m_parse_state.concept_write_ptr;
             theres_a_call_in_here = true;
          }
          else if (anythings->kind == ui_concept_select) {
-            verify_options = anythings->call_conc_options;
+            e.m_verify_options = anythings->call_conc_options;
             if (deposit_concept(anythings->concept_ptr)) goto failed;
          }
          else break;   /* Huh? */
@@ -867,7 +1008,7 @@ bool matcher_class::verify_call()
          anythings = anythings->packed_next_conc_or_subcall;
       }
 
-      parse_state.call_list_to_use = savecl;         /* deposit_concept screwed it up */
+      e.m_parse_state.call_list_to_use = e.m_matcher_savecl;         /* deposit_concept screwed it up */
 
          /* If we didn't see a call, the user is just verifying
             a string of concepts. Accept it. */
@@ -878,7 +1019,7 @@ bool matcher_class::verify_call()
             Therefore, the parse tree is incomplete.  We can print such parse trees, but we
             can't execute them.  So we just assume the call works. */
 
-      if (parse_state.parse_stack_index != 0) goto accept;
+      if (e.m_parse_state.parse_stack_index != 0) goto accept;
 
       toplevelmove();   // This might throw an error.
       goto accept;
@@ -886,14 +1027,14 @@ bool matcher_class::verify_call()
    catch(error_flag_type) {
       // A call failed.  If the call had some mandatory substitution, pass it anyway.
 
-      if (mandatory_call_used) goto accept;
+      if (e.m_mandatory_call_used) goto accept;
 
       // Or a bad choice of selector or number may be the cause.
       // Try again with a different selector, until we run out of ideas.
 
-      if (iterate_over_sel_dir_num(verify_used_selector,
-                                   verify_used_direction,
-                                   verify_used_number))
+      if (iterate_over_sel_dir_num(e.m_verify_used_selector,
+                                   e.m_verify_used_direction,
+                                   e.m_verify_used_number))
          goto try_another_selector;
 
       goto failed;
@@ -905,11 +1046,11 @@ bool matcher_class::verify_call()
    accept:
 
    restore_parse_state();
-   release_parse_blocks_to_mark(parse_mark);
+   release_parse_blocks_to_mark(e.m_matcher_parse_mark);
 
-   config_history_ptr = old_history_ptr;
+   e.m_config_history_ptr = old_history_ptr;
    config_restore_warnings(saved_warnings);
-   interactivity = interactivity_normal;
+   e.m_interactivity = interactivity_normal;
 
    return resultval;
 }
@@ -989,10 +1130,64 @@ void matcher_class::record_a_match()
       m_yielding_matches++;
 
    if (m_showing) {
-      if (verify_call()) gg77->iob88.show_match(-1);
+      if (verify_call()) current_engine->m_gg77->iob88.show_match(-1);
    }
 }
 
+// This is what record_a_match would do for a match that isn't the first
+// one and isn't exact, when we aren't showing or verifying.  The name trie
+// has already given us what all such matches have in common.
+void matcher_class::record_a_completion(Cstring extension, bool space_ok, int yield_depth)
+{
+   char *s1 = m_echo_stuff;
+   const char *s2 = extension;
+
+   if (space_ok) m_space_ok = true;
+   m_extended_bracket_depth = 0;
+
+   // Shorten m_echo_stuff to the maximal common prefix.
+   // Count brackets.
+   for ( ; ; s1++,s2++) {
+      if (!*s1) break;
+      else if (*s1 != *s2) {
+         *s1 = 0;
+         break;
+      }
+      else if (*s1 == '[') m_extended_bracket_depth++;
+      else if (*s1 == ']') m_extended_bracket_depth--;
+   }
+
+   m_match_count++;
+
+   if (yield_depth > m_lowest_yield_depth)
+      m_yielding_matches++;
+}
+
+// Tells whether match_suffix_2, after the user input has run out at the end
+// of a name, would go through the rest of the pattern and record exactly one
+// match, with no wildcards to expand.  Propagates the yield depth back the
+// way it does, if "yield_depth" isn't negative.
+bool matcher_class::pattern_tail_is_plain(pat2_block *pat2, uims_reply_kind kind, int yield_depth)
+{
+   for ( ; pat2 ; pat2 = pat2->cdr) {
+      if (kind != ui_call_select && pat2->demand_a_call)
+         return false;
+
+      if (pat2->folks_to_restore) {
+         if (yield_depth >= 0) pat2->folks_to_restore->yield_depth = yield_depth;
+         kind = pat2->folks_to_restore->match.kind;
+      }
+
+      if (!pat2->anythingers && ::strchr(pat2->car, '@'))
+         return false;
+
+      // A concept that gets parsed directly drops the rest of the pattern.
+      if (pat2->special_concept) break;
+   }
+
+   return true;
+}
+
 /* ************************************************************************
 
 This procedure must obey certain properties.  Be sure that no modifications
@@ -1342,9 +1537,7 @@ void matcher_class::scan_concepts_and_calls(
    *fixme = &local_result;
 
    int i;
-   int bucket;
    int new_depth;
-   bool using_hash = false;
 
    /* We force any call invoked under a concept to yield if it is ambiguous.  This way,
       if the user types "cross roll", preference will be given to the call "cross roll",
@@ -1367,9 +1560,8 @@ void matcher_class::scan_concepts_and_calls(
 
                   OR
 
-      (call_or_concept_name has 1st 3 chars with no comma, quote, atsign, or NUL)
-         AND
-      (user[1,2,3] are not NUL or blank and don't match call_or_concept_name)
+      (user[1...] goes off the end of the name trie before call_or_concept_name
+       gets to a wildcard or runs out)
 
       */
 
@@ -1380,6 +1572,17 @@ void matcher_class::scan_concepts_and_calls(
 
    int matches_as_seen_by_me = m_match_count;
 
+   // The name tries give us everything if the user hasn't typed anything
+   // after the blank or bracket.
+   Cstring user_text = user[0] ? &user[1] : "";
+
+   // Once we have a first match, a name that the user's text ends in the middle of,
+   // with nothing but plain text after it in the pattern, just shortens m_echo_stuff,
+   // and the name trie can tell us to what.  Match_suffix_2 does everything else.
+   char extension[INPUT_TEXTLINE_SIZE+1];
+   bool space_ok;
+   bool completing = !m_showing && !m_verify && user[0] && patxi == 0;
+
    if (user[0] && user[0] != firstchar[0])
       goto getout;
 
@@ -1388,74 +1591,57 @@ void matcher_class::scan_concepts_and_calls(
       save_stuff2 = m_current_result->real_secondary_subcall;
    }
 
-   // See if we can use the hash mechanism.
-
-   if (user[0] || !m_showing) {
-      // We now know that it will do nothing if:
-      // (call_or_concept_name has 1st 3 chars with no comma, quote, atsign, or NUL)
-      //                         AND
-      // (user[1,2,3] are not NUL or blank and don't match call_or_concept_name)
+   // Only look at the concepts whose names could go with what the user typed.
 
-      if (user[1] == '[' || get_hash(&user[1], &bucket) == 1) {
-         if (user[1] == '[') bucket = BRACKET_HASH;
-
-         /* Therefore, we should only search for those calls that either
-            (1) have comma/quote/atsign/NULL in 1st 3 characters, OR
-            (2) match user, that is, match the hash number we just computed.
-         */
-
-         using_hash = true;
-      }
-   }
-
-   // Now figure out how to scan the concepts.
+   local_result.match.kind = ui_concept_select;
 
-   index_list *list_to_use;
+   {
+      const name_trie & trie = current_engine->m_allowing_all_concepts ? m_concept_trie : m_level_concept_trie;
+      name_trie::finder concepts(trie, user_text);
+      // The concepts that aren't parsed directly go on with the rest of the pattern.
+      bool from_trie = completing && pattern_tail_is_plain(pat2, ui_concept_select, -1) &&
+         trie.complete(user_text, extension, &space_ok);
 
-   if (using_hash)
-      list_to_use = allowing_all_concepts ? &conc_hashers[bucket] : &conclvl_hashers[bucket];
-   else
-      list_to_use = allowing_all_concepts ? &m_concept_list : &m_level_concept_list;
+      while ((i = concepts.next()) >= 0) {
+         // Don't waste time after user stops us.
+         if (m_showing && m_showing_has_stopped) break;
 
-   local_result.match.kind = ui_concept_select;
+         const concept_descriptor *this_concept = access_concept_descriptor_table(i);
+         local_result.match.concept_ptr = this_concept;
+         p2b.special_concept = this_concept;
+         p2b.car = get_concept_name(this_concept);
+         m_current_result = &local_result;
+         m_current_result->yield_depth = new_depth;
+         local_result.match.call_conc_options = null_options;
 
-   for (i = 0; i < list_to_use->the_list_size; i++) {
-      // Don't waste time after user stops us.
-      if (m_showing && m_showing_has_stopped) break;
-
-      const concept_descriptor *this_concept = access_concept_descriptor_table(list_to_use->the_list[i]);
-      local_result.match.concept_ptr = this_concept;
-      p2b.special_concept = this_concept;
-      p2b.car = get_concept_name(this_concept);
-      m_current_result = &local_result;
-      m_current_result->yield_depth = new_depth;
-      local_result.match.call_conc_options = null_options;
-      match_suffix_2(user, firstchar, &p2b, patxi);
+         if (from_trie && m_match_count != 0 && !::strchr(p2b.car, '@')) {
+            if (!(get_concparseflags(this_concept) & CONCPARSE_PARSE_DIRECT))
+               pattern_tail_is_plain(pat2, ui_concept_select, new_depth);
+            record_a_completion(extension, space_ok, new_depth);
+         }
+         else
+            match_suffix_2(user, firstchar, &p2b, patxi);
+      }
    }
 
    // And the calls.
 
-   int menu_length;
-
-   if (using_hash)
-      menu_length = call_hashers[bucket].the_list_size;
-   else
-      menu_length = number_of_calls[call_list_any];
-
    p2b.special_concept = (concept_descriptor *) 0;
    local_result.match.kind = ui_call_select;
 
    {
+      name_trie::finder calls(m_call_trie, user_text);
+      bool from_trie = completing && pattern_tail_is_plain(pat2, ui_call_select, -1) &&
+         m_call_trie.complete(user_text, extension, &space_ok);
       bool got_aborted_subcall = false;
       modifier_block *got_matched_subcall = (modifier_block *) 0;
       int my_patxi = 0;
 
-      for (i = 0; i < menu_length; i++) {
+      while ((i = calls.next()) >= 0) {
          // Don't waste time after user stops us.
          if (m_showing && m_showing_has_stopped) break;
 
-         call_with_name *this_call =
-            main_call_lists[call_list_any][using_hash ? call_hashers[bucket].the_list[i] : i];
+         call_with_name *this_call = main_call_lists[call_list_any][i];
          m_current_result = &local_result;
          m_current_result->match.call_ptr = this_call;
          matches_as_seen_by_me = m_match_count;
@@ -1484,6 +1670,10 @@ void matcher_class::scan_concepts_and_calls(
                match_suffix_2(user, firstchar, &p2b, patxi);
             }
          }
+         else if (from_trie && m_match_count != 0 && !::strchr(p2b.car, '@')) {
+            pattern_tail_is_plain(pat2, ui_call_select, m_current_result->yield_depth);
+            record_a_completion(extension, space_ok, m_current_result->yield_depth);
+         }
          else {
             match_suffix_2(user, firstchar, &p2b, patxi);
          }
@@ -1899,6 +2089,7 @@ void matcher_class::match_pattern(Cstring pattern)
 
 void matcher_class::search_menu(uims_reply_kind kind)
 {
+   engine_context & e = *current_engine;
    unsigned int i, menu_length;
    Cstring *menu;
    char uch = m_user_input[0];
@@ -1936,15 +2127,15 @@ void matcher_class::search_menu(uims_reply_kind kind)
             // Do a quick check for mismatch on first character.
             // Q: Why do we do it just at the top level?  Shouldn't
             //    we do it at all levels?
-            // A: At deeper levels, the hashing mechanism has cut the
+            // A: At deeper levels, the name trie has cut the
             //    list way down, so we don't need it.  But here we don't
-            //    have hashing.
+            //    have a name trie.
             // Q: Why not?
             // A: At the top level, we have many different menus to deal
-            //    with, one for each possible starting setup.  Making a hash
-            //    table for each of them is unwieldy.  At deeper levels,
+            //    with, one for each possible starting setup.  Making a name
+            //    trie for each of them is unwieldy.  At deeper levels,
             //    there is just the "call_list_any" menu to deal with, and
-            //    that one is hashed.
+            //    that one has a name trie.
             char pch = get_call_name(this_call)[0];
 
             if (!m_showing &&
@@ -1954,7 +2145,7 @@ void matcher_class::search_menu(uims_reply_kind kind)
                  ((get_call_name(this_call)[1] == '0' || get_call_name(this_call)[1] == 'T') && uch != '[' && uch != '<')))
                continue;
 
-            parse_state.call_list_to_use = (call_list_kind) m_call_menu;
+            e.m_parse_state.call_list_to_use = (call_list_kind) m_call_menu;
             m_active_result.match.call_ptr = this_call;
             m_active_result.yield_depth = (get_yield_if_ambiguous_flag(this_call)) ? 1 : 0;
             matches_as_seen_by_me = m_match_count;
@@ -2029,37 +2220,37 @@ void matcher_class::search_menu(uims_reply_kind kind)
       }
    }
    else if (kind == ui_concept_select) {
-      index_list *list_to_use = allowing_all_concepts ? &m_concept_list : &m_level_concept_list;
-      menu_length = list_to_use->the_list_size;
-      short int *item = list_to_use->the_list;
-
       if (input_is_null)
-         m_match_count += menu_length;
+         m_match_count += (e.m_allowing_all_concepts ? m_concept_list : m_level_concept_list).the_list_size;
       else {
-         for (i = 0; i < menu_length; i++) {
+         // There are hundreds of concepts, but all in one list, so the name trie
+         // can tell us which ones could possibly match.
+         const name_trie & trie = e.m_allowing_all_concepts ? m_concept_trie : m_level_concept_trie;
+         name_trie::finder concepts(trie, m_user_input);
+         // As in scan_concepts_and_calls, the trie can finish the matches after the first.
+         char extension[INPUT_TEXTLINE_SIZE+1];
+         bool space_ok;
+         bool from_trie = !m_showing && !m_verify && trie.complete(m_user_input, extension, &space_ok);
+         int item;
+
+         while ((item = concepts.next()) >= 0) {
             // Don't waste time after user stops us.
             if (m_showing && m_showing_has_stopped) break;
 
-            const concept_descriptor *this_concept = access_concept_descriptor_table(item[i]);
-
-            // Another quick check -- there are hundreds of concepts.
-            char pch = get_concept_name(this_concept)[0];
+            const concept_descriptor *this_concept = access_concept_descriptor_table(item);
 
-            if (!m_showing &&
-                uch != pch &&
-                (pch > 'Z' || pch < 'A' || uch != pch+'a'-'A') &&
-                ((pch != '@') ||
-                 (get_concept_name(this_concept)[1] == '0' && uch != '[' && uch != '<')))
-               continue;
-
-            parse_state.call_list_to_use = (call_list_kind) m_call_menu;
+            e.m_parse_state.call_list_to_use = (call_list_kind) m_call_menu;
             m_active_result.match.concept_ptr = this_concept;
             m_active_result.yield_depth =
                (get_concparseflags(this_concept) & CONCPARSE_YIELD_IF_AMB) ? 1 : 0;
 
             pat2_block p2b(get_concept_name(this_concept));
             p2b.special_concept = this_concept;
-            match_suffix_2(m_user_input, "", &p2b, 0);
+
+            if (from_trie && m_match_count != 0 && !::strchr(p2b.car, '@'))
+               record_a_completion(extension, space_ok, m_active_result.yield_depth);
+            else
+               match_suffix_2(m_user_input, "", &p2b, 0);
          }
       }
    }
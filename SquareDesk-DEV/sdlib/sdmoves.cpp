@@ -2410,7 +2410,7 @@ void initialize_matrix_position_tables()
       ypar |= (xmax << 20) | (xpar << 16) | (ymax << 4);
 
       if (p->ypar != ypar || p->sigcheck != signature)
-         gg77->iob88.fatal_error_exit(1, "Matrix position table initialization failed");
+         current_engine->m_gg77->iob88.fatal_error_exit(1, "Matrix position table initialization failed");
    }
 #endif
 }
@@ -2609,6 +2609,7 @@ static int matrixmove(
    const uint32 *callstuff,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    setup people;
    matrix_rec matrix_info[matrix_info_capacity+1];
    int i, nump;
@@ -2649,12 +2650,12 @@ static int matrixmove(
          }
 
          if (flags & MTX_USE_NUMBER) {
-            int count = current_options.number_fields & NUMBER_FIELD_MASK;
+            int count = e.m_current_options.number_fields & NUMBER_FIELD_MASK;
             thisrec->deltax *= count;
             thisrec->deltay *= count;
          }
          else if (flags & MTX_ADD_2N) {
-            int count = current_options.number_fields & NUMBER_FIELD_MASK;
+            int count = e.m_current_options.number_fields & NUMBER_FIELD_MASK;
             if (thisrec->deltax < 0)
                thisrec->deltax -= (count << 2);
             else
@@ -3361,14 +3362,15 @@ extern void brute_force_merge(const setup *res1, const setup *res2,
 extern void drag_someone_and_move(setup *ss, parse_block *parseptr, setup *result)
    THROW_DECL
 {
+   engine_context & e = *current_engine;
    setup people, second_people;
    matrix_rec matrix_info[matrix_info_capacity+1];
    matrix_rec second_matrix_info[matrix_info_capacity+1];
    int i;
    bool fudged_start = false;
    uint32 flags = MTX_STOP_AND_WARN_ON_TBONE | MTX_IGNORE_NONSELECTEES;
-   selector_kind saved_selector = current_options.who;
-   current_options.who = parseptr->options.who;
+   selector_kind saved_selector = e.m_current_options.who;
+   e.m_current_options.who = parseptr->options.who;
 
    setup scopy = *ss;      // Will save rotation of this to the very end.
    scopy.rotation = 0;
@@ -3381,7 +3383,7 @@ extern void drag_someone_and_move(setup *ss, parse_block *parseptr, setup *resul
 
    int nump = start_matrix_call(&scopy, matrix_info, 0,
       MTX_USE_SELECTOR | MTX_STOP_AND_WARN_ON_TBONE, &people);
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 
    // Make the lateral chains first.
 
@@ -3488,19 +3490,20 @@ extern void anchor_someone_and_move(
    parse_block *parseptr,
    setup *result)  THROW_DECL
 {
+   engine_context & e = *current_engine;
    enum { MAX_GROUPS = 12 };
    setup people;
    matrix_rec before_matrix_info[matrix_info_capacity+1];
    matrix_rec after_matrix_info[matrix_info_capacity+1];
    int i, j, k, nump;
    int deltax[MAX_GROUPS], deltay[MAX_GROUPS];
-   selector_kind saved_selector = current_options.who;
+   selector_kind saved_selector = e.m_current_options.who;
    setup saved_start_people = *ss;
    int Bindex[MAX_GROUPS];
    int Aindex[MAX_GROUPS];
    int Eindex[MAX_GROUPS];
 
-   current_options.who = parseptr->options.who;
+   e.m_current_options.who = parseptr->options.who;
 
    if (ss->cmd.cmd_misc_flags & CMD_MISC__MUST_SPLIT_MASK)
       fail("Can't split the setup.");
@@ -3529,7 +3532,7 @@ extern void anchor_someone_and_move(
 
    nump = start_matrix_call(&saved_start_people, before_matrix_info, 0,
                             MTX_USE_SELECTOR, &people);
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 
    int numgroups = 0;
    uint32 splitting_indicator = (result->result_flags.split_info[1] << 4) | result->result_flags.split_info[0];
@@ -3829,20 +3832,21 @@ static void do_inheritance(setup_command *cmd,
 
 extern void process_number_insertion(uint32 mod_word)
 {
+   engine_context & e = *current_engine;
    if (mod_word & DFM1_NUM_INSERT_MASK) {
       uint32 insertion_num = (mod_word & DFM1_NUM_INSERT_MASK) / DFM1_NUM_INSERT_BIT;
 
       if ((mod_word & DFM1_FRACTAL_INSERT) && (insertion_num & ~2) == 1)
          insertion_num ^= 2;
 
-      current_options.number_fields <<= BITS_PER_NUMBER_FIELD;
-      current_options.number_fields += insertion_num;
-      current_options.howmanynumbers++;
+      e.m_current_options.number_fields <<= BITS_PER_NUMBER_FIELD;
+      e.m_current_options.number_fields += insertion_num;
+      e.m_current_options.howmanynumbers++;
    }
 
-   current_options.number_fields >>=
+   e.m_current_options.number_fields >>=
       ((DFM1_NUM_SHIFT_MASK & mod_word) / DFM1_NUM_SHIFT_BIT) * BITS_PER_NUMBER_FIELD;
-   current_options.howmanynumbers -= ((DFM1_NUM_SHIFT_MASK & mod_word) / DFM1_NUM_SHIFT_BIT);
+   e.m_current_options.howmanynumbers -= ((DFM1_NUM_SHIFT_MASK & mod_word) / DFM1_NUM_SHIFT_BIT);
 }
 
 
@@ -3856,6 +3860,7 @@ extern bool get_real_subcall(
    uint32 extra_heritmask_bits,
    setup_command *cmd_out) THROW_DECL   // We fill in just the parseptr, callspec, cmd_final_flags fields.
 {
+   engine_context & e = *current_engine;
    parse_block *search;
    parse_block **newsearch;
    int snumber;
@@ -3868,7 +3873,7 @@ extern bool get_real_subcall(
    bool this_is_tagger =
       item_id >= base_call_tagger0 && item_id < base_call_tagger0+NUM_TAGGER_CLASSES;
    bool this_is_tagger_circcer = this_is_tagger || item_id == base_call_circcer;
-   call_conc_option_state save_state = current_options;
+   call_conc_option_state save_state = e.m_current_options;
 
    if (!(new_final_concepts.test_heritbit(INHERITFLAG_FRACTAL)))
       mods1 &= ~DFM1_FRACTAL_INSERT;
@@ -3887,11 +3892,11 @@ extern bool get_real_subcall(
 
    // Do the substitutions called for by star turn replacements (from "@S" escape codes.)
 
-   if (current_options.star_turn_option != 0 &&
+   if (e.m_current_options.star_turn_option != 0 &&
        (orig_call->the_defn.callflagsf & CFLAG2_IS_STAR_CALL)) {
       parse_block *xx = get_parse_block();
       xx->concept = &concept_marker_concept_mod;
-      xx->options = current_options;
+      xx->options = e.m_current_options;
       xx->options.star_turn_option = 0;
       xx->replacement_key = 0;
       xx->call = orig_call;
@@ -3899,8 +3904,8 @@ extern bool get_real_subcall(
       xx->no_check_call_level = true;
       xx->call_to_print = xx->call;
 
-      if (current_options.star_turn_option >= 0)
-         xx->options.number_fields += current_options.star_turn_option;
+      if (e.m_current_options.star_turn_option >= 0)
+         xx->options.number_fields += e.m_current_options.star_turn_option;
 
       cmd_out->parseptr = xx;
       cmd_out->callspec = (call_with_name *) 0;
@@ -4018,12 +4023,12 @@ extern bool get_real_subcall(
    cmd_out->cmd_final_flags.clear_all_herit_and_final_bits();
 
  ret_true:
-   current_options = save_state;
+   e.m_current_options = save_state;
    return true;
 
  ret_false:
 
-   current_options = save_state;
+   e.m_current_options = save_state;
    return false;
 }
 
@@ -4912,7 +4917,7 @@ bool fill_active_phantoms_and_move(setup *ss, setup *result, bool suppress_fudgy
 
 void move_perhaps_with_active_phantoms(setup *ss, setup *result, bool suppress_fudgy_2x3_2x6_fixup) THROW_DECL
 {
-   if (using_active_phantoms) {
+   if (current_engine->m_using_active_phantoms) {
       if (fill_active_phantoms_and_move(ss, result, suppress_fudgy_2x3_2x6_fixup)) {
          // Active phantoms couldn't be used.  Just do the call the way it is.
          // This does not count as a use of active phantoms, so don't set the flag.
@@ -5325,6 +5330,7 @@ static void do_sequential_call(
    uint32 extra_heritmask_bits,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    // We prefer fraction information in the fraction field rather than the herit bits.
    // (Under certain circumstances if might get changed back later.)
    if (ss->cmd.cmd_fraction.is_null() && ss->cmd.cmd_final_flags.test_heritbit(INHERITFLAG_HALF)) {
@@ -5388,7 +5394,7 @@ static void do_sequential_call(
          uint32 this_mod1 = this_item->modifiers1;
 
          if (this_mod1 & (DFM1_SEQ_REPEAT_N | DFM1_SEQ_REPEAT_NM1)) {
-            uint32 this_count = current_options.number_fields & NUMBER_FIELD_MASK;
+            uint32 this_count = e.m_current_options.number_fields & NUMBER_FIELD_MASK;
 
             delta += this_count-1;  // Why -1?  Because we're counting *extra* parts.
 
@@ -5417,17 +5423,17 @@ static void do_sequential_call(
       if (ss->cmd.cmd_fraction.fraction != FRAC_FRAC_NULL_VALUE)
          fail("Fractions have been specified in two places.");
 
-      if (current_options.number_fields == 0 || current_options.number_fields > 4)
+      if (e.m_current_options.number_fields == 0 || e.m_current_options.number_fields > 4)
          fail("Illegal fraction.");
 
       if (ss->cmd.cmd_fraction.flags & CMD_FRAC_REVERSE) {
          ss->cmd.cmd_fraction.fraction =
             NUMBER_FIELDS_4_0_1_1 |
-            ((4-current_options.number_fields) << (BITS_PER_NUMBER_FIELD*2));
+            ((4-e.m_current_options.number_fields) << (BITS_PER_NUMBER_FIELD*2));
       }
       else {
          ss->cmd.cmd_fraction.fraction =
-            NUMBER_FIELDS_1_0_4_0 | current_options.number_fields;
+            NUMBER_FIELDS_1_0_4_0 | e.m_current_options.number_fields;
       }
    }
 
@@ -5467,8 +5473,8 @@ static void do_sequential_call(
           (revertflags == INHERITFLAGRVRTK_REVERT ||
            revertflags == INHERITFLAGRVRTK_REFLECT) &&
           (callflags1 & CFLAG1_NUMBER_MASK) == CFLAG1_NUMBER_BIT &&
-          current_options.howmanynumbers == 1 &&
-          current_options.number_fields == 2 &&
+          e.m_current_options.howmanynumbers == 1 &&
+          e.m_current_options.number_fields == 2 &&
           visibility_info == 0 &&
           callspec->stuff.seq.defarray[1].call_id == base_call_revert_if_needed &&
           callspec->stuff.seq.defarray[2].call_id == base_call_extend_n) {
@@ -5599,8 +5605,8 @@ static void do_sequential_call(
       uint32 this_mod1 = this_item->modifiers1;
       by_def_item *alt_item = this_item;
       bool recompute_id = false;
-      uint32 saved_number_fields = current_options.number_fields;
-      int saved_num_numbers = current_options.howmanynumbers;
+      uint32 saved_number_fields = e.m_current_options.number_fields;
+      int saved_num_numbers = e.m_current_options.howmanynumbers;
       uint32 herit_bits_to_clear = 0;
 
       /* Now the "index" values (zzz.m_fetch_index and zzz.m_client_index) contain the
@@ -5725,9 +5731,9 @@ static void do_sequential_call(
 
       // Check for special repetition stuff.
       if (this_schema_is_rem_or_alt || (this_mod1 & (DFM1_SEQ_REPEAT_N | DFM1_SEQ_REPEAT_NM1))) {
-         int count_to_use = current_options.number_fields & NUMBER_FIELD_MASK;
+         int count_to_use = e.m_current_options.number_fields & NUMBER_FIELD_MASK;
 
-         number_used = true;
+         e.m_number_used = true;
          if (this_mod1 & DFM1_SEQ_DO_HALF_MORE) count_to_use++;
          if (this_schema != schema_sequential_remainder && (this_mod1 & DFM1_SEQ_REPEAT_NM1)) count_to_use--;
          if (count_to_use < 0) fail("Can't give number zero.");
@@ -5872,8 +5878,8 @@ static void do_sequential_call(
       if (DFM1_SEQ_REENABLE_ELONG_CHK & this_mod1)
          ss->cmd.cmd_misc_flags &= ~CMD_MISC__NO_CHK_ELONG;
 
-      current_options.number_fields = saved_number_fields;
-      current_options.howmanynumbers = saved_num_numbers;
+      e.m_current_options.number_fields = saved_number_fields;
+      e.m_current_options.howmanynumbers = saved_num_numbers;
 
       qtfudged = false;
 
@@ -6531,6 +6537,7 @@ void really_inner_move(
    bool mirror,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (callflagsf & CFLAG2_NO_RAISE_OVERCAST)
       ss->clear_all_overcasts();
 
@@ -6672,8 +6679,8 @@ void really_inner_move(
             fail("Illegal concept for this call.");
 
          uint32 flags = callspec->stuff.matrix.matrix_flags;
-         if ((flags & MTX_ONLY_IN) && current_options.where != direction_in) fail("Can't use this selector.");
-         if ((flags & MTX_ONLY_OUT) && current_options.where != direction_out) fail("Can't use this selector.");
+         if ((flags & MTX_ONLY_IN) && e.m_current_options.where != direction_in) fail("Can't use this selector.");
+         if ((flags & MTX_ONLY_OUT) && e.m_current_options.where != direction_out) fail("Can't use this selector.");
          matrix_def_block *base_block = callspec->stuff.matrix.matrix_def_list;
 
          for ( ;; ) {
@@ -7103,6 +7110,7 @@ static void move_with_real_call(
    bool did_4x4_expansion,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    // We have a genuine call.  Presumably all serious concepts have been disposed of
    // (that is, nothing interesting will be found in parseptr -- it might be
    // useful to check that someday) and we just have the callspec and the final
@@ -7127,7 +7135,7 @@ static void move_with_real_call(
    calldefn *this_defn = &ss->cmd.callspec->the_defn;
    calldefn *deferred_array_defn = (calldefn *) 0;
    warning_info saved_warnings = configuration::save_warnings();
-   call_conc_option_state saved_options = current_options;
+   call_conc_option_state saved_options = e.m_current_options;
    setup saved_ss = *ss;
 
  try_next_callspec:
@@ -7137,7 +7145,7 @@ static void move_with_real_call(
    try {
       // Previous attempts may have messed things up.
       configuration::restore_warnings(saved_warnings);
-      current_options = saved_options;
+      e.m_current_options = saved_options;
       *ss = saved_ss;
       result->clear_people();
       clear_result_flags(result, RESULTFLAG__REALLY_NO_REEVALUATE);   // In case we bail out.
@@ -7155,7 +7163,7 @@ static void move_with_real_call(
       // If allowing modifications, the array version isn't what we want.
       if (the_schema == schema_by_array &&
           this_defn->compound_part &&
-          allowing_modifications &&
+          e.m_allowing_modifications &&
           !deferred_array_defn) {
          deferred_array_defn = this_defn;     // Save the array definition for later.
          this_defn = this_defn->compound_part;
@@ -7164,22 +7172,22 @@ static void move_with_real_call(
 
       if ((callflags1 & CFLAG1_YOYO_FRACTAL_NUM)) {
          if (ss->cmd.cmd_final_flags.test_heritbit(INHERITFLAG_FRACTAL)) {
-            if ((current_options.number_fields & (NUMBER_FIELD_MASK ^ 2)) == 1)
-               current_options.number_fields ^= 2;
+            if ((e.m_current_options.number_fields & (NUMBER_FIELD_MASK ^ 2)) == 1)
+               e.m_current_options.number_fields ^= 2;
             ss->cmd.cmd_final_flags.clear_heritbit(INHERITFLAG_FRACTAL);
          }
          else if ((ss->cmd.cmd_final_flags.test_heritbit(INHERITFLAG_YOYOETCMASK)) == INHERITFLAG_YOYOETCK_YOYO) {
-            if ((current_options.number_fields & NUMBER_FIELD_MASK) == 2)
-               current_options.number_fields++;
+            if ((e.m_current_options.number_fields & NUMBER_FIELD_MASK) == 2)
+               e.m_current_options.number_fields++;
             ss->cmd.cmd_final_flags.clear_heritbits(INHERITFLAG_YOYOETCMASK);
          }
          else if ((ss->cmd.cmd_final_flags.test_heritbit(INHERITFLAG_YOYOETCMASK)) == INHERITFLAG_YOYOETCK_GENEROUS) {
-            current_options.number_fields++;
+            e.m_current_options.number_fields++;
             ss->cmd.cmd_final_flags.clear_heritbits(INHERITFLAG_YOYOETCMASK);
          }
          else if ((ss->cmd.cmd_final_flags.test_heritbit(INHERITFLAG_YOYOETCMASK)) == INHERITFLAG_YOYOETCK_STINGY &&
-                  current_options.number_fields > 0) {
-            current_options.number_fields--;
+                  e.m_current_options.number_fields > 0) {
+            e.m_current_options.number_fields--;
             ss->cmd.cmd_final_flags.clear_heritbits(INHERITFLAG_YOYOETCMASK);
          }
       }
@@ -7336,8 +7344,8 @@ static void move_with_real_call(
 
                if ((callflagsf & CFLAG2_FRACTIONAL_NUMBERS) &&
                    (ss->cmd.cmd_fraction.flags & ~CMD_FRAC_BREAKING_UP) == 0 &&
-                   current_options.howmanynumbers == 1) {
-                  fraction_info zzz(current_options.number_fields & NUMBER_FIELD_MASK);
+                   e.m_current_options.howmanynumbers == 1) {
+                  fraction_info zzz(e.m_current_options.number_fields & NUMBER_FIELD_MASK);
 
                   zzz.get_fraction_info(ss->cmd.cmd_fraction,
                                         CFLAG1_VISIBLE_FRACTION_MASK / CFLAG1_VISIBLE_FRACTION_BIT,
@@ -7346,7 +7354,7 @@ static void move_with_real_call(
                   if ((zzz.m_do_half_of_last_part |
                        zzz.m_do_last_half_of_first_part |
                        zzz.m_fetch_index) == 0) {
-                     current_options.number_fields = zzz.m_highlimit;
+                     e.m_current_options.number_fields = zzz.m_highlimit;
                      goto done;
                   }
                }
@@ -7367,8 +7375,8 @@ static void move_with_real_call(
 
                   int n = ss->cmd.cmd_fraction.fraction - NUMBER_FIELDS_1_0_4_0;
                   if (n >= 0 && n <= 3) {
-                     current_options.howmanynumbers = 1;
-                     current_options.number_fields = n;
+                     e.m_current_options.howmanynumbers = 1;
+                     e.m_current_options.number_fields = n;
                      ss->cmd.cmd_misc3_flags |= CMD_MISC3__SPECIAL_NUMBER_INVOKE;
                      goto done;
                   }
@@ -7536,7 +7544,7 @@ static void move_with_real_call(
 
       if ((ss->cmd.cmd_final_flags.test_heritbits(~callflagsh)) == 0) {
          // Some schemata change if the given number is odd.  For touch by N x <call>.
-         if (current_options.howmanynumbers != 0 && (current_options.number_fields & 1)) {
+         if (e.m_current_options.howmanynumbers != 0 && (e.m_current_options.number_fields & 1)) {
             if (the_schema == schema_single_concentric_together_if_odd)
                the_schema = schema_single_concentric_together;
             else if (the_schema == schema_single_cross_concentric_together_if_odd)
@@ -7710,8 +7718,8 @@ static void move_with_real_call(
             if (starting) ss->cmd.cmd_final_flags.set_finalbit(FINAL__SPLIT_SQUARE_APPROVED);
             ss->cmd.cmd_final_flags.clear_finalbit(FINAL__SPLIT);
 
-            if (current_options.howmanynumbers != 0 &&
-                (current_options.number_fields & NUMBER_FIELD_MASK) <= 1)
+            if (e.m_current_options.howmanynumbers != 0 &&
+                (e.m_current_options.number_fields & NUMBER_FIELD_MASK) <= 1)
                fail("Can't split square thru 1.");
          }
          else if (callflags1 & CFLAG1_SPLIT_LIKE_DIXIE_STYLE) {
@@ -7825,7 +7833,7 @@ static void move_with_real_call(
       // A "sequence_starter_promenade" call is only legal if really_inner_move is invoked
       // from the other place, in inner_selective_move, or at the start of a sequence.
       // Otherwise, there seem to be too many dangling loose ends in the logic.
-      if ((callflags1 & CFLAG1_SEQUENCE_STARTER_PROM) != 0 && config_history_ptr != 1)
+      if ((callflags1 & CFLAG1_SEQUENCE_STARTER_PROM) != 0 && e.m_config_history_ptr != 1)
          fail("You must specify who is to do it.");
 
       really_inner_move(ss, qtfudged, this_defn, the_schema, callflags1, callflagsf,
@@ -7858,7 +7866,7 @@ static void move_with_real_call(
       throw foo;
    }
 
-   current_options = saved_options;
+   e.m_current_options = saved_options;
 }
 
 
@@ -7938,8 +7946,9 @@ void move(
    setup *result,
    bool suppress_fudgy_2x3_2x6_fixup /*= false*/) THROW_DECL
 {
+   engine_context & e = *current_engine;
    // Need this to check for dixie tag 1/4.
-   if (current_options.number_fields == 1)
+   if (e.m_current_options.number_fields == 1)
       ss->cmd.cmd_misc3_flags |= CMD_MISC3__PARENT_COUNT_IS_ONE;
 
    result->result_flags.res_heritflags_to_save_from_mxn_expansion = 0;
@@ -8000,7 +8009,7 @@ void move(
          }
 
          p3.no_check_call_level = true;
-         p3.options = current_options;
+         p3.options = e.m_current_options;
          ss->cmd.parseptr = &p1;
          ss->cmd.callspec = (call_with_name *) 0;
          ss->cmd.restrained_super8flags = ss->cmd.cmd_final_flags.herit;
@@ -8058,7 +8067,7 @@ void move(
 
          if (ss->cmd.callspec) {
             z0->call = ss->cmd.callspec;
-            z0->options = current_options;
+            z0->options = e.m_current_options;
          }
 
          ss->cmd.callspec = 0;
@@ -8130,7 +8139,7 @@ void move(
    }
 
    // Scan the "final" concepts, remembering them and their end point.
-   last_magic_diamond = 0;
+   e.m_last_magic_diamond = 0;
 
    // But if we have a pending "centers/ends work <concept>" concept, don't.
 
@@ -8157,7 +8166,7 @@ void move(
 
    save_incoming_final = ss->cmd.cmd_final_flags;   // In case we need to punt.
    parseptrcopy = process_final_concepts(parseptrcopy, true, &ss->cmd.cmd_final_flags, true, false);
-   saved_magic_diamond = last_magic_diamond;
+   saved_magic_diamond = e.m_last_magic_diamond;
 
    // Handle expired concepts.
    handle_expiration(ss, &resultflags_to_put_inmisc);
@@ -8170,7 +8179,7 @@ void move(
    }
 
    if (parseptrcopy->concept->kind <= marker_end_of_list) {
-      call_conc_option_state saved_options = current_options;
+      call_conc_option_state saved_options = e.m_current_options;
       call_with_name *this_call = parseptrcopy->call;
 
       // There are no "big" concepts.  The only concepts are the "little" ones
@@ -8275,7 +8284,7 @@ void move(
 
       ss->cmd.parseptr = parseptrcopy;
       ss->cmd.callspec = this_call;
-      current_options = parseptrcopy->options;
+      e.m_current_options = parseptrcopy->options;
 
       if (((dance_level) this_call->the_defn.level) > calling_level &&
           !parseptrcopy->no_check_call_level)
@@ -8302,7 +8311,7 @@ void move(
       move_with_real_call(ss, qtfudged, false, result);
       remove_mxn_spreading(result);
       remove_tgl_distortion(result);
-      current_options = saved_options;
+      e.m_current_options = saved_options;
    }
    else {
       /* We now know that there are "non-final" (virtual setup) concepts present. */
@@ -24,6 +24,7 @@
 
 /* This defines the following functions:
    in_exhaustive_search
+   in_random_search
    reset_internal_iterators
    do_selector_iteration
    do_direction_iteration
@@ -35,12 +36,11 @@
    get_resolve_goodness_info
    pick_allow_multiple_items
    start_pick
+   start_random_pick
    end_pick
    forbid_call_with_mandatory_subcall
    allow_random_subcall_pick
-
-and the following external variables:
-   search_goal
+   delete_picker_state
 */
 
 #include "sd.h"
@@ -77,49 +77,80 @@ pick_type_descriptor pick_type_table[] = {
    { false, false, false, "pick random search"},     // pick_in_random_search
    { false, false, false, 0}};                       // pick_not_in_any_pick_at_all
 
-command_kind search_goal;
+// Where the picker is in its scans.  Each engine has its own, made the first
+// time that engine picks anything.
+
+struct picker_state {
+   /* The "pick_concept_***" passes are actually several scans over several
+      concepts.  This counter counts them. */
+   int concept_scan_index;
+   int concept_scan_limit;
+   short int *concept_scan_table;
+
+   uint32 selector_iterator;
+   uint32 direction_iterator;
+   uint32 number_iterator;
+   uint32 tagger_iterator;
+   uint32 circcer_iterator;
+   int resolve_scan_start_point;
+   int resolve_scan_current_point;
+   // This is only meaningful if interactivity = interactivity_picking.
+   pick_type current_pick_type;
+};
+
+
+extern void delete_picker_state(picker_state *ps)
+{
+   delete ps;
+}
+
 
-/* The "pick_concept_***" passes are actually several scans over several
-   concepts.  This counter counts them. */
-static int concept_scan_index;
-static int concept_scan_limit;
-static short int *concept_scan_table;
+static inline picker_state & the_picker()
+{
+   engine_context *e = current_engine;
 
-static uint32 selector_iterator = 0;
-static uint32 direction_iterator = 0;
-static uint32 number_iterator = 0;
-static uint32 tagger_iterator = 0;
-static uint32 circcer_iterator = 0;
-static int resolve_scan_start_point;
-static int resolve_scan_current_point;
-// This is only meaningful if interactivity = interactivity_picking.
-static pick_type current_pick_type = pick_not_in_any_pick_at_all;
+   if (!e->m_picker) {
+      e->m_picker = new picker_state();   // All zero, except:
+      e->m_picker->current_pick_type = pick_not_in_any_pick_at_all;
+   }
+
+   return *e->m_picker;
+}
 
 
 static void display_pick()
 {
-   gg77->iob88.set_pick_string(pick_type_table[current_pick_type].display_string);
+   current_engine->m_gg77->iob88.set_pick_string(pick_type_table[the_picker().current_pick_type].display_string);
 }
 
 
 
 bool in_exhaustive_search()
 {
-   return pick_type_table[current_pick_type].exhaustive_search;
+   return pick_type_table[the_picker().current_pick_type].exhaustive_search;
+}
+
+
+bool in_random_search()
+{
+   return the_picker().current_pick_type == pick_in_random_search;
 }
 
 
 void reset_internal_iterators()
 {
-   selector_iterator = 0;
-   direction_iterator = 0;
-   number_iterator = 0;
-   tagger_iterator = 0;
-   circcer_iterator = 0;
+   picker_state & ps = the_picker();
+   ps.selector_iterator = 0;
+   ps.direction_iterator = 0;
+   ps.number_iterator = 0;
+   ps.tagger_iterator = 0;
+   ps.circcer_iterator = 0;
 }
 
 selector_kind do_selector_iteration(bool allow_iteration)
 {
+   engine_context & e = *current_engine;
+   picker_state & ps = the_picker();
    static selector_kind selector_iterator_table[] = {
       selector_boys,
       selector_girls,
@@ -131,34 +162,34 @@ selector_kind do_selector_iteration(bool allow_iteration)
       selector_belles,
       selector_uninitialized};
 
-   if (interactivity == interactivity_database_init ||
-       interactivity == interactivity_verify) {
-      if (verify_options.who == selector_uninitialized) {
-         verify_used_selector = true;
+   if (e.m_interactivity == interactivity_database_init ||
+       e.m_interactivity == interactivity_verify) {
+      if (e.m_verify_options.who == selector_uninitialized) {
+         e.m_verify_used_selector = true;
          return selector_for_initialize;
       }
       else
-         return verify_options.who;
+         return e.m_verify_options.who;
    }
 
    int j;
 
-   if (pick_type_table[current_pick_type].exhaustive_search && allow_iteration) {
-      j = (int) selector_iterator_table[selector_iterator];
+   if (pick_type_table[ps.current_pick_type].exhaustive_search && allow_iteration) {
+      j = (int) selector_iterator_table[ps.selector_iterator];
 
-      selector_iterator++;
+      ps.selector_iterator++;
 
       /* See if we have exhausted all possible selectors.
          We only look for "boys", "girls", "centers", and "ends" in the first scan. */
-      if (selector_iterator_table[selector_iterator] ==
-          ((current_pick_type == pick_plain_nice_only) ?
+      if (selector_iterator_table[ps.selector_iterator] ==
+          ((ps.current_pick_type == pick_plain_nice_only) ?
            selector_leads :
            ((calling_level < beau_belle_level) ?
             selector_beaus :
             selector_uninitialized)))
-         selector_iterator = 0;
+         ps.selector_iterator = 0;
    }
-   else if (pick_type_table[current_pick_type].exhaustive_search) {
+   else if (pick_type_table[ps.current_pick_type].exhaustive_search) {
       /* In a concept during exhaustive search.  That means we are doing
          the "<anyone> are tandem" stuff. */
       j = (int) selector_centers;
@@ -176,19 +207,21 @@ selector_kind do_selector_iteration(bool allow_iteration)
 
 direction_kind do_direction_iteration()
 {
-   if (interactivity == interactivity_database_init ||
-       interactivity == interactivity_verify) {
-      if (verify_options.where == direction_uninitialized) {
-         verify_used_direction = true;
+   engine_context & e = *current_engine;
+   picker_state & ps = the_picker();
+   if (e.m_interactivity == interactivity_database_init ||
+       e.m_interactivity == interactivity_verify) {
+      if (e.m_verify_options.where == direction_uninitialized) {
+         e.m_verify_used_direction = true;
          return direction_for_initialize;
       }
       else
-         return verify_options.where;
+         return e.m_verify_options.where;
    }
 
    int j;
 
-   if (pick_type_table[current_pick_type].exhaustive_search) {
+   if (pick_type_table[ps.current_pick_type].exhaustive_search) {
       static direction_kind direction_iterator_table[] = {
          direction_left,
          direction_right,
@@ -196,18 +229,18 @@ direction_kind do_direction_iteration()
          direction_out,
          direction_uninitialized};
 
-      j = (int) direction_iterator_table[direction_iterator];
+      j = (int) direction_iterator_table[ps.direction_iterator];
 
-      if (selector_iterator == 0) {
-         direction_iterator++;
+      if (ps.selector_iterator == 0) {
+         ps.direction_iterator++;
 
          /* See if we have exhausted all possible directions.
             We only look for "left" and "right" in the first scan. */
-         if (direction_iterator_table[direction_iterator] ==
-             ((current_pick_type == pick_plain_nice_only) ?
+         if (direction_iterator_table[ps.direction_iterator] ==
+             ((ps.current_pick_type == pick_plain_nice_only) ?
               direction_in :
               direction_uninitialized))
-            direction_iterator = 0;
+            ps.direction_iterator = 0;
       }
    }
    else {
@@ -224,26 +257,28 @@ void do_number_iteration(int howmanynumbers,
                          bool allow_iteration,
                          uint32 *number_list)
 {
+   engine_context & e = *current_engine;
+   picker_state & ps = the_picker();
    int i;
 
    *number_list = 0;
 
-   if (interactivity == interactivity_database_init ||
-       interactivity == interactivity_verify) {
+   if (e.m_interactivity == interactivity_database_init ||
+       e.m_interactivity == interactivity_verify) {
       for (i=0 ; i<howmanynumbers ; i++) {
          uint32 this_num;
 
-         if (verify_options.howmanynumbers == 0) {
+         if (e.m_verify_options.howmanynumbers == 0) {
             // The second number in the series is always 1.
             // This makes "N-N-N-N change the web" and "N-N-N-N
             // relay the top" work.
             this_num = (i==1) ? 1 : number_for_initialize;
-            verify_used_number = true;
+            e.m_verify_used_number = true;
          }
          else {
-            this_num = verify_options.number_fields & NUMBER_FIELD_MASK;
-            verify_options.number_fields >>= BITS_PER_NUMBER_FIELD;
-            verify_options.howmanynumbers--;
+            this_num = e.m_verify_options.number_fields & NUMBER_FIELD_MASK;
+            e.m_verify_options.number_fields >>= BITS_PER_NUMBER_FIELD;
+            e.m_verify_options.howmanynumbers--;
          }
 
          *number_list |= (this_num << (i*BITS_PER_NUMBER_FIELD));
@@ -259,8 +294,8 @@ void do_number_iteration(int howmanynumbers,
       uint32 this_num;
 
       if (allow_iteration &&
-          pick_type_table[current_pick_type].exhaustive_search) {
-         this_num = ((number_iterator >> (i*2)) & 3) + 1;
+          pick_type_table[ps.current_pick_type].exhaustive_search) {
+         this_num = ((ps.number_iterator >> (i*2)) & 3) + 1;
       }
       else if (odd_number_only)
          this_num = (generate_random_number(2)<<1)+1;
@@ -272,14 +307,14 @@ void do_number_iteration(int howmanynumbers,
       *number_list |= (this_num << (i*BITS_PER_NUMBER_FIELD));
    }
 
-   if (pick_type_table[current_pick_type].exhaustive_search &&
-       (selector_iterator | direction_iterator) == 0) {
-      number_iterator++;
+   if (pick_type_table[ps.current_pick_type].exhaustive_search &&
+       (ps.selector_iterator | ps.direction_iterator) == 0) {
+      ps.number_iterator++;
 
       // If the call requires it, iterate over odd numbers only.
       if (odd_number_only) {
-         while (number_iterator & 0x55555555)
-            number_iterator += number_iterator & ~(number_iterator-1);
+         while (ps.number_iterator & 0x55555555)
+            ps.number_iterator += ps.number_iterator & ~(ps.number_iterator-1);
       }
 
       // If the call takes 3 or more numbers, we don't iterate in the
@@ -289,11 +324,11 @@ void do_number_iteration(int howmanynumbers,
       // case.
 
       if (howmanynumbers >= 3) {
-         number_iterator = 0;
+         ps.number_iterator = 0;
       }
 
       // See if we have exhausted all possible numbers.
-      if (number_iterator >> (howmanynumbers*2)) number_iterator = 0;
+      if (ps.number_iterator >> (howmanynumbers*2)) ps.number_iterator = 0;
    }
 }
 
@@ -303,10 +338,11 @@ bool do_tagger_iteration(uint32 tagclass,
                          uint32 numtaggers,
                          call_with_name **tagtable)
 {
+   picker_state & ps = the_picker();
    uint32 tag;
 
-   if (pick_type_table[current_pick_type].exhaustive_search) {
-      tag = tagger_iterator;
+   if (pick_type_table[ps.current_pick_type].exhaustive_search) {
+      tag = ps.tagger_iterator;
 
          /* But we don't allow any call that takes a another tag call (e.g. "revert"),
             or any other iteratable modifier.  It's just too complicated to iterate
@@ -324,26 +360,26 @@ bool do_tagger_iteration(uint32 tagclass,
                 CFLAGH__REQUIRES_DIRECTION))))
          tag++;
 
-      if (tag == numtaggers && tagger_iterator == 0)
+      if (tag == numtaggers && ps.tagger_iterator == 0)
          return true;  /* There simply are no acceptable taggers. */
 
-      if ((selector_iterator | direction_iterator | number_iterator) == 0) {
-         tagger_iterator = tag+1;
+      if ((ps.selector_iterator | ps.direction_iterator | ps.number_iterator) == 0) {
+         ps.tagger_iterator = tag+1;
 
-         while (tagger_iterator < numtaggers &&
-                ((tagtable[tagger_iterator]->the_defn.callflags1 &
+         while (ps.tagger_iterator < numtaggers &&
+                ((tagtable[ps.tagger_iterator]->the_defn.callflags1 &
                   (CFLAG1_DONT_USE_IN_RESOLVE|
                    CFLAG1_NUMBER_MASK)) ||
-                 (tagtable[tagger_iterator]->the_defn.callflagsf &
+                 (tagtable[ps.tagger_iterator]->the_defn.callflagsf &
                   (CFLAGH__TAG_CALL_RQ_MASK|
                    CFLAGH__CIRC_CALL_RQ_BIT|
                    CFLAGH__REQUIRES_SELECTOR|
                    CFLAGH__REQUIRES_DIRECTION))))
-            tagger_iterator++;
+            ps.tagger_iterator++;
 
          /* See if we have exhausted all possible taggers. */
-         if (tagger_iterator == numtaggers)
-            tagger_iterator = 0;
+         if (ps.tagger_iterator == numtaggers)
+            ps.tagger_iterator = 0;
       }
    }
    else {
@@ -363,15 +399,16 @@ bool do_tagger_iteration(uint32 tagclass,
 
 void do_circcer_iteration(uint32 *circcp)
 {
-   if (pick_type_table[current_pick_type].exhaustive_search) {
-      *circcp = circcer_iterator+1;
+   picker_state & ps = the_picker();
+   if (pick_type_table[ps.current_pick_type].exhaustive_search) {
+      *circcp = ps.circcer_iterator+1;
 
-      if ((selector_iterator | direction_iterator | number_iterator | tagger_iterator) == 0) {
-         circcer_iterator++;
+      if ((ps.selector_iterator | ps.direction_iterator | ps.number_iterator | ps.tagger_iterator) == 0) {
+         ps.circcer_iterator++;
 
          /* See if we have exhausted all possible circcers. */
-         if (circcer_iterator == number_of_circcers)
-            circcer_iterator = 0;
+         if (ps.circcer_iterator == number_of_circcers)
+            ps.circcer_iterator = 0;
       }
    }
    else
@@ -388,12 +425,14 @@ void do_circcer_iteration(uint32 *circcp)
 
 const concept_descriptor *pick_concept(bool already_have_concept_in_place)
 {
+   engine_context & e = *current_engine;
+   picker_state & ps = the_picker();
    bool do_concept = false;
 
-   if (interactivity != interactivity_picking)
+   if (e.m_interactivity != interactivity_picking)
       return (concept_descriptor *) 0;
 
-   if (current_pick_type == pick_starting_first_scan) {
+   if (ps.current_pick_type == pick_starting_first_scan) {
 
       // Generate the random starting point for the scan, so it won't be identical
       // each time we resolve from this position.  This is the only time that we use
@@ -405,30 +444,30 @@ const concept_descriptor *pick_concept(bool already_have_concept_in_place)
       // across the available calls for "any" setup, because we will be
       // doing concepts.  But "any" setup always allows more calls, so we are safe.
 
-      resolve_scan_start_point =
-         (ui_options.diagnostic_mode) ?
+      ps.resolve_scan_start_point =
+         (e.m_ui_options.diagnostic_mode) ?
          0 :
-         generate_random_number(number_of_calls[parse_state.call_list_to_use]);
-      resolve_scan_current_point = resolve_scan_start_point-1;
-      current_pick_type = pick_plain_nice_only;
+         generate_random_number(number_of_calls[e.m_parse_state.call_list_to_use]);
+      ps.resolve_scan_current_point = ps.resolve_scan_start_point-1;
+      ps.current_pick_type = pick_plain_nice_only;
       display_pick();
       reset_internal_iterators();
    }
-   else if (pick_type_table[current_pick_type].exhaustive_search) {
+   else if (pick_type_table[ps.current_pick_type].exhaustive_search) {
       if (already_have_concept_in_place)
          return (concept_descriptor *) 0;
 
-      if ((selector_iterator | direction_iterator | number_iterator |
-           tagger_iterator | circcer_iterator) == 0) {
-         if (resolve_scan_current_point == resolve_scan_start_point) {
+      if ((ps.selector_iterator | ps.direction_iterator | ps.number_iterator |
+           ps.tagger_iterator | ps.circcer_iterator) == 0) {
+         if (ps.resolve_scan_current_point == ps.resolve_scan_start_point) {
 
             // Done with this scan.  Advance to the next thing to do.
 
-            if (pick_type_table[current_pick_type].with_concept) {
+            if (pick_type_table[ps.current_pick_type].with_concept) {
                // Currently doing a scan with concepts.  Go to the next
                // concept.  If run out, go to next scan.
-               concept_scan_index++;
-               if (concept_scan_index < concept_scan_limit)
+               ps.concept_scan_index++;
+               if (ps.concept_scan_index < ps.concept_scan_limit)
                   goto foobar;
             }
 
@@ -440,28 +479,28 @@ const concept_descriptor *pick_concept(bool already_have_concept_in_place)
             // to be nothing but a funny form for an integer.  Shame on us.
             // So we use a type cast.  Shame on us.
 
-            current_pick_type = (pick_type) (current_pick_type+1);
+            ps.current_pick_type = (pick_type) (ps.current_pick_type+1);
             display_pick();
 
-            concept_scan_index = 0;  // If this is a concept scan, we will need these.
-            concept_scan_limit = good_concept_sublist_sizes[parse_state.call_list_to_use];
-            concept_scan_table = good_concept_sublists[parse_state.call_list_to_use];
+            ps.concept_scan_index = 0;  // If this is a concept scan, we will need these.
+            ps.concept_scan_limit = good_concept_sublist_sizes[e.m_parse_state.call_list_to_use];
+            ps.concept_scan_table = good_concept_sublists[e.m_parse_state.call_list_to_use];
 
             // Now, if we are in a scan that involves concepts, check whether
             // there are any concepts to use.  (There might not be --
             // we severely restrict the number of available concepts in these scans.)
 
-            if (search_goal != command_resolve ||
+            if (e.m_search_goal != command_resolve ||
 
                 // Well, we *always* skip this stuff now.
                 // It's just bad.
 
                 true ||
 
-                concept_scan_limit == 0) {
+                ps.concept_scan_limit == 0) {
                // Can't go into concept scans, so skip over any of same.
-               while (pick_type_table[current_pick_type].with_concept)
-                  current_pick_type = (pick_type) (current_pick_type+1);
+               while (pick_type_table[ps.current_pick_type].with_concept)
+                  ps.current_pick_type = (pick_type) (ps.current_pick_type+1);
                display_pick();
             }
 
@@ -469,11 +508,11 @@ const concept_descriptor *pick_concept(bool already_have_concept_in_place)
          foobar: ;
          }
 
-         resolve_scan_current_point--;   /* Might go to -1.  Do_pick will fix same. */
+         ps.resolve_scan_current_point--;   /* Might go to -1.  Do_pick will fix same. */
       }
    }
-   else if (current_pick_type == pick_in_random_search) {
-      switch (search_goal) {
+   else if (ps.current_pick_type == pick_in_random_search) {
+      switch (e.m_search_goal) {
       case command_concept_call:
          if (!already_have_concept_in_place)
             { do_concept = true; break; }
@@ -482,7 +521,7 @@ const concept_descriptor *pick_concept(bool already_have_concept_in_place)
       case command_random_call:
       case command_standardize:
          do_concept = generate_random_number(8) <
-            ((search_goal == command_standardize) ?
+            ((e.m_search_goal == command_standardize) ?
              STANDARDIZE_CONCEPT_PROBABILITY : CONCEPT_PROBABILITY);
 
          /* Since we are not going to use the random number in a one-to-one way,
@@ -496,21 +535,21 @@ const concept_descriptor *pick_concept(bool already_have_concept_in_place)
    }
 
    if (do_concept) {
-      int j = concept_sublist_sizes[parse_state.call_list_to_use];
+      int j = concept_sublist_sizes[e.m_parse_state.call_list_to_use];
 
       if (j != 0) {    /* If no concepts are available (perhaps some clown has
                           selected "pick concept call" at mainstream) we don't
                           insert a concept. */
          j = generate_random_number(j);
 
-         global_reply.minorpart = concept_sublists[parse_state.call_list_to_use][j];
-         return &concept_descriptor_table[global_reply.minorpart];
+         e.m_global_reply.minorpart = concept_sublists[e.m_parse_state.call_list_to_use][j];
+         return &concept_descriptor_table[e.m_global_reply.minorpart];
       }
    }
-   else if (pick_type_table[current_pick_type].with_concept &&
+   else if (pick_type_table[ps.current_pick_type].with_concept &&
             !already_have_concept_in_place) {
-      global_reply.minorpart = concept_scan_table[concept_scan_index];
-      return &concept_descriptor_table[global_reply.minorpart];
+      e.m_global_reply.minorpart = ps.concept_scan_table[ps.concept_scan_index];
+      return &concept_descriptor_table[e.m_global_reply.minorpart];
    }
 
    return (concept_descriptor *) 0;
@@ -519,23 +558,25 @@ const concept_descriptor *pick_concept(bool already_have_concept_in_place)
 
 call_with_name *do_pick()
 {
+   engine_context & e = *current_engine;
+   picker_state & ps = the_picker();
    int i;
    uint32 rejectflag;
    call_with_name *result;
 
-   if (pick_type_table[current_pick_type].exhaustive_search) {
-      if (resolve_scan_current_point < 0)
-         resolve_scan_current_point = number_of_calls[parse_state.call_list_to_use]-1;
-      i = resolve_scan_current_point;
+   if (pick_type_table[ps.current_pick_type].exhaustive_search) {
+      if (ps.resolve_scan_current_point < 0)
+         ps.resolve_scan_current_point = number_of_calls[e.m_parse_state.call_list_to_use]-1;
+      i = ps.resolve_scan_current_point;
    }
    else        /* In random search. */
-      i = generate_random_number(number_of_calls[parse_state.call_list_to_use]);
+      i = generate_random_number(number_of_calls[e.m_parse_state.call_list_to_use]);
 
    /* Fix up the "hashed randoms" stuff as though we had generated this number
          through the random number generator. */
 
    hash_nonrandom_number(i);
-   result = main_call_lists[parse_state.call_list_to_use][i];
+   result = main_call_lists[e.m_parse_state.call_list_to_use][i];
 
    // Why don't we just call the random number generator again if the call is inappropriate?
    // Wouldn't that be much faster?  There are two reasons:  First, we would need to take
@@ -543,11 +584,11 @@ call_with_name *do_pick()
    // just called the random number generator again, it would screw up the hash numbers,
    // which would make the uniquefication fail, so we could see the same thing twice.
 
-   if ((search_goal == command_level_call || search_goal == command_8person_level_call) &&
+   if ((e.m_search_goal == command_level_call || e.m_search_goal == command_8person_level_call) &&
        ((dance_level) result->the_defn.level) < level_threshholds_for_pick[calling_level])
       fail_no_retry("Level reject.");
 
-   rejectflag = pick_type_table[current_pick_type].exhaustive_search ?
+   rejectflag = pick_type_table[ps.current_pick_type].exhaustive_search ?
       (CFLAG1_DONT_USE_IN_RESOLVE|CFLAG1_DONT_USE_IN_NICE_RESOLVE) :
       CFLAG1_DONT_USE_IN_RESOLVE;
 
@@ -558,13 +599,14 @@ call_with_name *do_pick()
 
 resolve_goodness_test get_resolve_goodness_info()
 {
-   if (interactivity == interactivity_picking) {
-      if (pick_type_table[current_pick_type].accept_nice_only)
+   picker_state & ps = the_picker();
+   if (current_engine->m_interactivity == interactivity_picking) {
+      if (pick_type_table[ps.current_pick_type].accept_nice_only)
          /* "Nice" exhaustive scans:  Only accept things with "how_bad" = 0,
             that is, RLG, LA, and prom.  And only if the promenade is short
             (if at C2 or above).  And only if one call long. */
          return resolve_goodness_only_nice;
-      else if (current_pick_type != pick_in_random_search)
+      else if (ps.current_pick_type != pick_in_random_search)
          /* Other exhaustive scans: accept any one-call resolve. */
          return resolve_goodness_always;
    }
@@ -577,12 +619,14 @@ resolve_goodness_test get_resolve_goodness_info()
 
 bool pick_allow_multiple_items()
 {
-   return !pick_type_table[current_pick_type].exhaustive_search;
+   return !pick_type_table[the_picker().current_pick_type].exhaustive_search;
 }
 
 
 void start_pick()
 {
+   engine_context & e = *current_engine;
+   picker_state & ps = the_picker();
    /* Following a suggestion of Eric Brosius, we initially scan the entire database once,
       looking for one-call resolves, before we start the complex search.  This way, we
       will never show a multiple-call resolve if a single-call one exists.  Of course,
@@ -590,24 +634,35 @@ void start_pick()
       we will only use one canned value for it, so we could miss a single call resolve
       on this first pass if that call involves an interesting number, etc. */
 
-   interactivity = interactivity_picking;
+   e.m_interactivity = interactivity_picking;
 
-   if (search_goal == command_resolve ||
-       search_goal == command_reconcile ||
-       search_goal == command_normalize ||
-       search_goal == command_standardize ||
-       search_goal >= command_create_any_lines)
-      current_pick_type = pick_starting_first_scan;
+   if (e.m_search_goal == command_resolve ||
+       e.m_search_goal == command_reconcile ||
+       e.m_search_goal == command_normalize ||
+       e.m_search_goal == command_standardize ||
+       e.m_search_goal >= command_create_any_lines)
+      ps.current_pick_type = pick_starting_first_scan;
    else
-      current_pick_type = pick_in_random_search;
+      ps.current_pick_type = pick_in_random_search;
 
    display_pick();
 }
 
 
+// An engine that joins a search that is already past the exhaustive scans (see
+// parallel_search in sdgetout.cpp) starts right in the random search.  It has no
+// display, so we don't call display_pick.
+void start_random_pick()
+{
+   current_engine->m_interactivity = interactivity_picking;
+   the_picker().current_pick_type = pick_in_random_search;
+   reset_internal_iterators();
+}
+
+
 void end_pick()
 {
-   current_pick_type = pick_not_in_any_pick_at_all;
+   the_picker().current_pick_type = pick_not_in_any_pick_at_all;
    display_pick();
 }
 
@@ -616,7 +671,7 @@ void end_pick()
 // mandatory subcall is simply rejected.
 bool forbid_call_with_mandatory_subcall()
 {
-   return pick_type_table[current_pick_type].exhaustive_search;
+   return pick_type_table[the_picker().current_pick_type].exhaustive_search;
 }
 
 // When we are doing the special scans in the resolver, we don't geneerate
@@ -624,5 +679,5 @@ bool forbid_call_with_mandatory_subcall()
 // Only when in the random search do we generate random subcalls.
 bool allow_random_subcall_pick()
 {
-   return current_pick_type == pick_in_random_search;
+   return the_picker().current_pick_type == pick_in_random_search;
 }
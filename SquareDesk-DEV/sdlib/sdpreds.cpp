@@ -27,10 +27,6 @@
    selectp
 
 and the following external variables:
-   selector_used
-   direction_used
-   number_used
-   mandatory_call_used
    pred_table     which is filled with pointers to the predicate functions
    selector_preds
 */
@@ -38,16 +34,9 @@ and the following external variables:
 #include "sd.h"
 
 
-// These variables are external.
-
-bool selector_used;
-bool direction_used;
-bool number_used;
-bool mandatory_call_used;
-
-
 extern bool selectp(const setup *ss, int place, int allow_some /*= 0*/) THROW_DECL
 {
+   engine_context & e = *current_engine;
    uint32 p1, p2, p3;
    selector_kind s;
    int thing_to_test;
@@ -57,11 +46,11 @@ extern bool selectp(const setup *ss, int place, int allow_some /*= 0*/) THROW_DE
    uint32 livemask;
    big_endian_get_directions(ss, directions, livemask);
 
-   selector_used = true;
+   e.m_selector_used = true;
 
    // Pull out the cases that do not require the person to be real.
 
-   switch (current_options.who) {
+   switch (e.m_current_options.who) {
       case selector_all:
       case selector_everyone:
          return true;
@@ -91,7 +80,7 @@ extern bool selectp(const setup *ss, int place, int allow_some /*= 0*/) THROW_DE
          const id_bit_table *ptr = setup_attrs[ss->kind].id_bit_table_ptr;
 
          if (ptr) {
-            switch (current_options.who) {
+            switch (e.m_current_options.who) {
             case selector_centers:
             case selector_ends:
             case selector_center2:
@@ -124,7 +113,7 @@ extern bool selectp(const setup *ss, int place, int allow_some /*= 0*/) THROW_DE
 
  do_switch:
 
-   switch (current_options.who) {
+   switch (e.m_current_options.who) {
    case selector_boys:
       if      ((pid3 & (ID3_PERM_BOY|ID3_PERM_GIRL)) == ID3_PERM_BOY) return true;
       else if ((pid3 & (ID3_PERM_BOY|ID3_PERM_GIRL)) == ID3_PERM_GIRL) return false;
@@ -242,7 +231,7 @@ extern bool selectp(const setup *ss, int place, int allow_some /*= 0*/) THROW_DE
       goto eq_return;
    case selector_center2:
    case selector_outer6:
-      if (ss->kind == s3x4 && current_options.who == selector_center2) {
+      if (ss->kind == s3x4 && e.m_current_options.who == selector_center2) {
          return (pid2 & ID2_CTR2) != 0;  // This one is always valid, even if we don't know who the "outer 6" are.
       }
       else if (ss->kind == s1x6) {
@@ -252,7 +241,7 @@ extern bool selectp(const setup *ss, int place, int allow_some /*= 0*/) THROW_DE
          else break;
       }
       else if (ss->kind == s2x7 || ss->kind == s_23232 || ss->kind == sdblspindle) {
-         if (current_options.who == selector_center2)
+         if (e.m_current_options.who == selector_center2)
             return (pid2 & ID2_CTR2) != 0;
          else break;
       }
@@ -831,10 +820,10 @@ extern bool selectp(const setup *ss, int place, int allow_some /*= 0*/) THROW_DE
    fail("Can't decide who are selected.");
 
  eq_return:
-   return (current_options.who == s);
+   return (e.m_current_options.who == s);
 
  first_last_test:
-   switch (current_options.who) {
+   switch (e.m_current_options.who) {
    case selector_firstone: case selector_rightmostone:
       return thing_to_test >= 3;
    case selector_firsttwo: case selector_rightmosttwo:
@@ -980,8 +969,9 @@ static bool unselect(setup *real_people, int real_index,
 static bool select_near_select(setup *real_people, int real_index,
    int real_direction, int northified_index, const int32 *extra_stuff) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (!selectp(real_people, real_index)) return false;
-   if (current_options.who == selector_all || current_options.who == selector_everyone)
+   if (e.m_current_options.who == selector_all || e.m_current_options.who == selector_everyone)
       return true;
 
    // We generally try to make "near" mean lateral; we usually get it right with no extra
@@ -999,11 +989,12 @@ static int base_table[12] = {0, 0, 0, 3, 3, 3, 6, 6, 6, 9, 9, 9};
 static bool select_near_select_or_phantom(setup *real_people, int real_index,
    int real_direction, int northified_index, const int32 *extra_stuff) THROW_DECL
 {
+   engine_context & e = *current_engine;
    int lim, base_person;
 
    if (!selectp(real_people, real_index))
       return false;
-   else if (current_options.who == selector_all || current_options.who == selector_everyone)
+   else if (e.m_current_options.who == selector_all || e.m_current_options.who == selector_everyone)
       return true;
 
    if (attr::slimit(real_people) == 11) {
@@ -1033,8 +1024,9 @@ static bool select_near_select_or_phantom(setup *real_people, int real_index,
 static bool select_near_unselect(setup *real_people, int real_index,
    int real_direction, int northified_index, const int32 *extra_stuff) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (!selectp(real_people, real_index)) return false;
-   if (current_options.who == selector_all || current_options.who == selector_everyone)
+   if (e.m_current_options.who == selector_all || e.m_current_options.who == selector_everyone)
       return false;
 
    return !(real_people->people[real_index ^ 1].id1 & BIT_PERSON) ||
@@ -1046,7 +1038,7 @@ static bool unselect_near_select(setup *real_people, int real_index,
    int real_direction, int northified_index, const int32 *extra_stuff) THROW_DECL
 {
    if (selectp(real_people, real_index)) return false;
-   if (current_options.who == selector_none) return false;
+   if (current_engine->m_current_options.who == selector_none) return false;
 
    return      (real_people->people[real_index ^ 1].id1 & BIT_PERSON) &&
                selectp(real_people, real_index ^ 1);
@@ -1059,7 +1051,7 @@ static bool unselect_near_unselect(setup *real_people, int real_index,
    int lim, base_person;
 
    if (selectp(real_people, real_index)) return false;
-   else if (current_options.who == selector_none) return true;
+   else if (current_engine->m_current_options.who == selector_none) return true;
 
    if (attr::slimit(real_people) == 11) {
       base_person = base_table[real_index];
@@ -1088,8 +1080,9 @@ static bool unselect_near_unselect(setup *real_people, int real_index,
 static bool select_once_rem_from_select(setup *real_people, int real_index,
    int real_direction, int northified_index, const int32 *extra_stuff) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (!selectp(real_people, real_index)) return false;
-   if (current_options.who == selector_all || current_options.who == selector_everyone)
+   if (e.m_current_options.who == selector_all || e.m_current_options.who == selector_everyone)
       return true;
 
    if (real_people->kind == s2x4)
@@ -1104,8 +1097,9 @@ static bool select_once_rem_from_select(setup *real_people, int real_index,
 static bool select_once_rem_from_unselect(setup *real_people, int real_index,
    int real_direction, int northified_index, const int32 *extra_stuff) THROW_DECL
 {
+   engine_context & e = *current_engine;
    if (!selectp(real_people, real_index)) return false;
-   if (current_options.who == selector_all || current_options.who == selector_everyone)
+   if (e.m_current_options.who == selector_all || e.m_current_options.who == selector_everyone)
       return false;
 
    int other_index;
@@ -1135,7 +1129,7 @@ static bool unselect_once_rem_from_select(setup *real_people, int real_index,
    int real_direction, int northified_index, const int32 *extra_stuff) THROW_DECL
 {
    if (selectp(real_people, real_index)) return false;
-   if (current_options.who == selector_none) return false;
+   if (current_engine->m_current_options.who == selector_none) return false;
 
    if (real_people->kind == s2x4)
       return   (real_people->people[real_index ^ 2].id1 & BIT_PERSON) &&
@@ -1193,7 +1187,7 @@ static bool whos_on_base(setup *real_people, int real_index,
    if (real_people->kind == s_alamo)
       real_index = 12+(real_index<<1);
 
-   uint32 N = current_options.number_fields & NUMBER_FIELD_MASK;
+   uint32 N = current_engine->m_current_options.number_fields & NUMBER_FIELD_MASK;
    if (N < 1 || N > 4) fail("Number must be between 1 and 4.");
    return ((((real_index + *extra_stuff) >> 2) + N) & 3) == 0;
 }
@@ -2623,10 +2617,11 @@ static bool lateral_to_sex(setup *real_people, int real_index,
 static bool directionp(setup *real_people, int real_index,
    int real_direction, int northified_index, const int32 *extra_stuff)
 {
-   direction_used = true;
+   engine_context & e = *current_engine;
+   e.m_direction_used = true;
    direction_kind d = (direction_kind) extra_stuff[0];
 
-   if (current_options.where == direction_the_music) {
+   if (e.m_current_options.where == direction_the_music) {
       uint32 r = 0;
       switch (d) {
       case direction_no_direction: r = ID2_FACEFRONT; break;
@@ -2638,7 +2633,7 @@ static bool directionp(setup *real_people, int real_index,
       return (real_people->people[real_index].id2 & r) != 0;
    }
 
-   return current_options.where == d;
+   return e.m_current_options.where == d;
 }
 
 
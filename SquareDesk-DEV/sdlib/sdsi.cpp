@@ -52,7 +52,6 @@ and the following external variables:
 
    session_index
    rewrite_with_new_style_filename
-   random_number
    database_filename
    new_outfile_string
    abridge_filename
@@ -126,7 +125,6 @@ bool rewrite_with_new_style_filename = false;   // User gave "change to new file
    e14 = delete */
 
 
-int random_number;
 const char *database_filename = DATABASE_FILENAME;
 const char *new_outfile_string = (char *) 0;
 char abridge_filename[MAX_TEXT_LINE_LENGTH];
@@ -140,27 +138,40 @@ static char fail_message[MAX_ERR_LENGTH];
 
 extern void general_initialize()
 {
+   engine_context & e = *current_engine;
    // If doing a resolve test, use a deterministic seed.
    // But make it depend on something the operator said.
    // That way, one can run two usefully independent tests
    // on a multiprocessor, by giving them slightly
    // different timeouts.
-   unsigned int seed = (ui_options.resolve_test_minutes != 0) ?
-      ui_options.resolve_test_minutes : time((time_t *)0);
+   unsigned int seed = (e.m_ui_options.resolve_test_minutes != 0) ?
+      e.m_ui_options.resolve_test_minutes : time((time_t *)0);
    srand(seed);
 }
 
 
 extern int generate_random_number(int modulus)
 {
-   random_number = (int) rand();
-   return random_number % modulus;
+   engine_context & e = *current_engine;
+   // An engine that is one of several running a search at once has a generator
+   // of its own, since "rand" has just one for the whole program.  This is Knuth's
+   // MMIX generator; we take the high 31 bits, which are the good ones.
+   if (e.m_random_state) {
+      e.m_random_state = e.m_random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+      e.m_random_number = (int) (e.m_random_state >> 33);
+   }
+   else
+      e.m_random_number = (int) rand();
+
+   return e.m_random_number % modulus;
 }
 
 
 extern void hash_nonrandom_number(int number)
 {
-   hashed_randoms = hashed_randoms*1049633+number;
+   engine_context & e = *current_engine;
+   e.m_hashed_randoms = e.m_hashed_randoms*1049633+number;
+   e.m_hashed_count++;
 }
 
 
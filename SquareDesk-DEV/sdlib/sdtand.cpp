@@ -754,6 +754,7 @@ const siamese_item siamese_table_of_4[] = {
 
 static void initialize_one_table(tm_thing *map_start, int m_people_per_group)
 {
+   engine_context & e = *current_engine;
    tm_thing *map_search;
 
    for (map_search = map_start; map_search->outsetup != nothing; map_search++) {
@@ -819,11 +820,11 @@ static void initialize_one_table(tm_thing *map_start, int m_people_per_group)
       osidemask ^= very_special;
 
       if (map_search->limit != attr::klimit(map_search->insetup)+1)
-         gg77->iob88.fatal_error_exit(1, "Tandem table initialization failed", "limit wrong");
+         e.m_gg77->iob88.fatal_error_exit(1, "Tandem table initialization failed", "limit wrong");
 
       if (!map_search->map_is_eighth_twosome) {
          if (map_search->olatmask != osidemask)
-            gg77->iob88.fatal_error_exit(1, "Tandem table initialization failed", "smask");
+            e.m_gg77->iob88.fatal_error_exit(1, "Tandem table initialization failed", "smask");
       }
    }
 }
@@ -1322,6 +1323,7 @@ extern void tandem_couples_move(
    bool phantom_pairing_ok,
    setup *result) THROW_DECL
 {
+   engine_context & e = *current_engine;
    ss->clear_all_overcasts();
    uint32 dynamic = twosome >> 2;
    twosome &= 3;
@@ -1731,10 +1733,10 @@ extern void tandem_couples_move(
       fail("Can't specify phantom tandem/couples in virtual or distorted setup.");
 
    // Find out who is selected, if this is a "so-and-so are tandem".
-   saved_selector = current_options.who;
+   saved_selector = e.m_current_options.who;
 
    if (selector != selector_uninitialized)
-      current_options.who = selector;
+      e.m_current_options.who = selector;
 
    for (i=0, jbit=1; i<=attr::slimit(ss); i++, jbit<<=1) {
       uint32 p = ss->people[i].id1;
@@ -1754,7 +1756,7 @@ extern void tandem_couples_move(
       }
    }
 
-   current_options.who = saved_selector;
+   e.m_current_options.who = saved_selector;
 
    if (!allmask) {
       result->kind = nothing;
@@ -30,6 +30,8 @@
    clear_bits_for_update
    clear_absolute_proximity_bits
    clear_absolute_proximity_and_facing_bits
+   hash_setup
+   same_setup_for_call
    expand::initialize
    full_expand::initialize_touch_tables
    full_expand::search_table_1
@@ -80,24 +82,14 @@
    deposit_call_tree
    do_subcall_query
    find_proper_call_list
+   engine_context::engine_context
+   engine_context::~engine_context
+   engine_context::scope::scope
+   engine_context::scope::~scope
 and the following external variables:
-   text_line_count
-   error_message1
-   error_message2
-   collision_person1
-   collision_person2
-   last_magic_diamond
-   configuration::history
-   config_history_ptr
-   configuration::whole_sequence_low_lim
-   history_allocation
-   written_history_items
-   no_erase_before_this
-   written_history_nopic
-   the_topcallflags
-   there_is_a_call
+   default_engine
+   current_engine
    base_calls
-   ui_options
    enable_file_writing
    cardinals
    ordinals
@@ -125,33 +117,18 @@ and the following external variables:
    number_of_taggers_allocated
    number_of_circcers
    number_of_circcers_allocated
-   parse_state
-   current_options
    no_search_warnings
    conc_elong_warnings
    dyp_each_warnings
    useless_phan_clw_warnings
-   allowing_all_concepts
-   allowing_minigrand
-   allow_bend_home_getout
-   enforce_overcast_warning
-   using_active_phantoms
    last_direction_kind
-   interactivity
    database_version
-   testing_fidelity
    level_threshholds_for_pick
-   allowing_modifications
-   hashed_randoms
    concept_sublist_sizes
    concept_sublists
    good_concept_sublist_sizes
    good_concept_sublists
    null_options
-   verify_options
-   verify_used_number
-   verify_used_direction
-   verify_used_selector
 */
 
 
@@ -162,38 +139,97 @@ and the following external variables:
 #include "sdui.h"
 
 
-// *** There are more globals proclaimed at line 235.
-ui_utils *gg77 = 0;
-int text_line_count = 0;
-char error_message1[MAX_ERR_LENGTH];
-char error_message2[MAX_ERR_LENGTH];
-uint32 collision_person1;
-uint32 collision_person2;
-int config_history_ptr;
-parse_block *last_magic_diamond;
-int history_allocation;
-
-/* This tells how much of the history text written to the UI is "safe".  If this
-   is positive, the history items up to that number, inclusive, have valid
-   "text_line" fields, and have had their text written to the UI.  Furthermore,
-   the local variable "text_line_count" is >= any of those "text_line" fields,
-   and each "text_line" field shows the number of lines of text that were
-   written to the UI when that history item was written.  This variable is
-   -1 when none of the history is safe or the state of the text in the UI
-   is unknown. */
-int written_history_items;
-
-// Normally zero.  When this becomes nonzero, the next clear_screen will
-// consider the "screen" to go back only that many lines, so that anything
-// before that will never be subject to being erased.
-int no_erase_before_this;
-
-// When written_history_items is positive, this tells how many of the initial lines
-// did not have pictures forced on (other than having been drawn as a natural consequence
-// of the "draw_pic" flag being on.)  If this number ever becomes greater than
-// written_history_items, that's OK.  It just means that none of the lines had
-// forced pictures.
-int written_history_nopic;
+// *** There are more globals proclaimed at line 268.
+engine_context default_engine;
+thread_local engine_context *current_engine = &default_engine;
+
+engine_context::engine_context() :
+   m_history((configuration *) 0),     // Will be allocated in sdmain.
+   m_history_allocation(0),
+   m_config_history_ptr(0),
+   m_whole_sequence_low_lim(0),
+   m_text_line_count(0),
+   m_written_history_items(0),
+   m_written_history_nopic(0),
+   m_no_erase_before_this(0),
+   m_parse_active_list((parse_block *) 0),
+   m_parse_inactive_list((parse_block *) 0),
+   m_parse_state(),
+   m_saved_parse_state(),
+   m_saved_command_root((parse_block *) 0),
+   m_matcher_parse_mark((parse_block *) 0),
+   m_matcher_savecl(call_list_none),
+   m_the_topcallflags(0),
+   m_there_is_a_call(false),
+   m_current_options(),
+   m_verify_options(),
+   m_verify_used_number(false),
+   m_verify_used_direction(false),
+   m_verify_used_selector(false),
+   m_selector_used(false),
+   m_direction_used(false),
+   m_number_used(false),
+   m_mandatory_call_used(false),
+   m_last_magic_diamond((parse_block *) 0),
+   m_gg77((ui_utils *) 0),
+   m_interactivity(interactivity_normal),
+   m_allowing_modifications(0),
+   m_allowing_all_concepts(false),
+   m_allowing_minigrand(false),
+   m_allow_bend_home_getout(false),
+   m_using_active_phantoms(false),
+   m_enforce_overcast_warning(false),
+   m_retain_after_error(false),
+   m_testing_fidelity(false),
+   m_current_line(),
+   m_global_error_flag((error_flag_type) 0),
+   m_global_reply(ui_user_cancel, 99),
+   m_error_message1(),
+   m_error_message2(),
+   m_collision_person1(0),
+   m_collision_person2(0),
+   m_global_tbonetest(0),
+   m_global_livemask(0),
+   m_global_selectmask(0),
+   m_global_tboneselect(0),
+   m_orig_tbonetest(0),
+   m_search_goal((command_kind) 0),
+   m_random_number(0),
+   m_hashed_randoms(0),
+   m_hashed_count(0),
+   m_random_state(0),
+   m_resolver((resolver_state *) 0),
+   m_picker((picker_state *) 0)
+{}
+
+engine_context::~engine_context()
+{
+   delete_resolver_state(m_resolver);
+   delete_picker_state(m_picker);
+   delete [] m_history;
+
+   parse_block *item;
+
+   while ((item = m_parse_active_list)) {
+      m_parse_active_list = item->gc_ptr;
+      delete item;
+   }
+
+   while ((item = m_parse_inactive_list)) {
+      m_parse_inactive_list = item->gc_ptr;
+      delete item;
+   }
+}
+
+engine_context::scope::scope(engine_context & e) : m_saved(current_engine)
+{
+   current_engine = &e;
+}
+
+engine_context::scope::~scope()
+{
+   current_engine = m_saved;
+}
 
 // This list tells what level calls will be accepted for the "pick level call"
 // operation.  When doing a "pick level call, we don't actually require calls
@@ -233,13 +269,9 @@ Cstring getout_strings[] = {
    "all",
    ""};
 
-// *** There are more globals proclaimed at line 164.
-uint32 the_topcallflags;
-bool there_is_a_call;
+// *** There are more globals proclaimed at line 140.
 call_with_name **base_calls;        // Gets allocated as array of pointers in sdinit.
 
-int configuration::whole_sequence_low_lim;
-configuration *configuration::history = (configuration *) 0; // Will be allocated in sdmain.
 bool enable_file_writing;
 
 
@@ -267,24 +299,12 @@ uint32 number_of_taggers[NUM_TAGGER_CLASSES];
 uint32 number_of_taggers_allocated[NUM_TAGGER_CLASSES];
 uint32 number_of_circcers;
 uint32 number_of_circcers_allocated;
-parse_state_type parse_state;
-call_conc_option_state current_options;
 warning_info no_search_warnings;
 warning_info conc_elong_warnings;
 warning_info dyp_each_warnings;
 warning_info useless_phan_clw_warnings;
-bool allowing_all_concepts = false;
-bool allowing_minigrand = false;
-bool allow_bend_home_getout = false;
-bool enforce_overcast_warning = false;
-bool using_active_phantoms = false;
 int last_direction_kind = direction_ENUM_EXTENT-1;
-interactivity_state interactivity = interactivity_normal;
 char database_version[81];
-bool testing_fidelity = false;
-
-int allowing_modifications = 0;
-int hashed_randoms;
 
 
 /* These two direct the generation of random concepts when we are searching.
@@ -305,10 +325,6 @@ const call_conc_option_state null_options = {
    selector_uninitialized,
    direction_uninitialized,
    0, 0, 0, 0, 0};
-call_conc_option_state verify_options;
-bool verify_used_number;
-bool verify_used_direction;
-bool verify_used_selector;
 
 
 // A few accessors to let the UI stuff survive.
@@ -334,21 +350,22 @@ const concept_kind constant_with_concept_diagnose = concept_diagnose;
 const concept_kind constant_with_marker_end_of_list = marker_end_of_list;
 
 
-parse_block *get_parse_block_mark() { return parse_block::parse_active_list; }
+parse_block *get_parse_block_mark() { return current_engine->m_parse_active_list; }
 parse_block *get_parse_block()
 {
+   engine_context & e = *current_engine;
    parse_block *item;
 
-   if (parse_block::parse_inactive_list) {
-      item = parse_block::parse_inactive_list;
-      parse_block::parse_inactive_list = item->gc_ptr;
+   if (e.m_parse_inactive_list) {
+      item = e.m_parse_inactive_list;
+      e.m_parse_inactive_list = item->gc_ptr;
    }
    else {
       item = new parse_block;
    }
 
-   item->gc_ptr = parse_block::parse_active_list;
-   parse_block::parse_active_list = item;
+   item->gc_ptr = e.m_parse_active_list;
+   e.m_parse_active_list = item;
    item->initialize((concept_descriptor *) 0);
    return item;
 }
@@ -860,6 +877,70 @@ extern void clear_absolute_proximity_bits(setup *ss)
    }
 }
 
+
+extern uint64_t hash_setup(const setup *ss)
+{
+   uint64_t h = hash_step(0, ss->kind);
+   h = hash_step(h, ((uint64_t) ss->rotation << 16) | ss->eighth_rotation);
+   h = hash_step(h, ((uint64_t) ss->result_flags.split_info[0] << 16) | ss->result_flags.split_info[1]);
+   h = hash_step(h, ((uint64_t) ss->result_flags.misc << 32) |
+                 ss->result_flags.res_heritflags_to_save_from_mxn_expansion);
+
+   int limit = attr::slimit(ss);
+
+   // A concentric setup doesn't say how many people it has; take them all.
+   if (limit < 0) {
+      limit = MAX_PEOPLE-1;
+      h = hash_step(h, ((uint64_t) ss->inner.skind << 32) | (uint32) ss->inner.srotation);
+      h = hash_step(h, ((uint64_t) ss->outer.skind << 32) | (uint32) ss->outer.srotation);
+      h = hash_step(h, (uint32) ss->concsetup_outer_elongation);
+   }
+
+   for (int i=0; i<=limit; i++) {
+      h = hash_step(h, ((uint64_t) ss->people[i].id1 << 32) | ss->people[i].id2);
+      h = hash_step(h, ss->people[i].id3);
+   }
+
+   return h;
+}
+
+
+// True if the two setups are the same in everything that hash_setup looks at.
+// The transposition table uses this to make sure that a hit isn't just a collision.
+extern bool same_setup_for_call(const setup *a, const setup *b)
+{
+   if (a->kind != b->kind ||
+       a->rotation != b->rotation ||
+       a->eighth_rotation != b->eighth_rotation ||
+       a->result_flags.split_info[0] != b->result_flags.split_info[0] ||
+       a->result_flags.split_info[1] != b->result_flags.split_info[1] ||
+       a->result_flags.misc != b->result_flags.misc ||
+       a->result_flags.res_heritflags_to_save_from_mxn_expansion !=
+       b->result_flags.res_heritflags_to_save_from_mxn_expansion)
+      return false;
+
+   int limit = attr::slimit(a);
+
+   if (limit < 0) {
+      limit = MAX_PEOPLE-1;
+      if (a->inner.skind != b->inner.skind ||
+          a->inner.srotation != b->inner.srotation ||
+          a->outer.skind != b->outer.skind ||
+          a->outer.srotation != b->outer.srotation ||
+          a->concsetup_outer_elongation != b->concsetup_outer_elongation)
+         return false;
+   }
+
+   for (int i=0; i<=limit; i++) {
+      if (a->people[i].id1 != b->people[i].id1 ||
+          a->people[i].id2 != b->people[i].id2 ||
+          a->people[i].id3 != b->people[i].id3)
+         return false;
+   }
+
+   return true;
+}
+
 extern void clear_absolute_proximity_and_facing_bits(setup *ss)
 {
    for (int i=0; i<MAX_PEOPLE; i++) {
@@ -3162,7 +3243,7 @@ static void initialize_concept_sublists()
 
    // Decide whether we allow the "diagnose" concept, by deciding
    // when we will stop the concept list scan.
-   concept_kind end_marker = ui_options.diagnostic_mode ?
+   concept_kind end_marker = current_engine->m_ui_options.diagnostic_mode ?
       marker_end_of_list : concept_diagnose;
 
    // First, just count up all the available concepts.
@@ -3596,6 +3677,7 @@ static void debug_print_parse_block(int level, const parse_block *p, char *temps
 
 extern void crash_print(const char *filename, int linenum, int newtb, setup *ss) THROW_DECL
 {
+   engine_context & e = *current_engine;
    char tempstring_text[10000];  // If this isn't big enough, I guess we lose.
 
    int n = sprintf(tempstring_text, "++++++++ CRASH - PLEASE REPORT THIS ++++++++\n");
@@ -3608,12 +3690,12 @@ extern void crash_print(const char *filename, int linenum, int newtb, setup *ss)
       }
    }
 
-   int hsize = config_history_ptr+1;
+   int hsize = e.m_config_history_ptr+1;
    for (int jjj = 2 ; jjj <= hsize ; jjj++) {
-      debug_print_parse_block(0, configuration::history[jjj].command_root, tempstring_text, n);
+      debug_print_parse_block(0, configuration::history()[jjj].command_root, tempstring_text, n);
    }
 
-   gg77->iob88.serious_error_print(tempstring_text);
+   e.m_gg77->iob88.serious_error_print(tempstring_text);
    fail("Crash.");
 }
 
@@ -3623,65 +3705,72 @@ extern void crash_print(const char *filename, int linenum, int newtb, setup *ss)
 
 extern void fail(const char s[]) THROW_DECL
 {
-   strncpy(error_message1, s, MAX_ERR_LENGTH);
-   error_message1[MAX_ERR_LENGTH-1] = '\0';
-   error_message2[0] = '\0';
+   engine_context & e = *current_engine;
+   strncpy(e.m_error_message1, s, MAX_ERR_LENGTH);
+   e.m_error_message1[MAX_ERR_LENGTH-1] = '\0';
+   e.m_error_message2[0] = '\0';
    throw error_flag_type(error_flag_1_line);
 }
 
 
 extern void fail_no_retry(const char s[]) THROW_DECL
 {
-   strncpy(error_message1, s, MAX_ERR_LENGTH);
-   error_message1[MAX_ERR_LENGTH-1] = '\0';
-   error_message2[0] = '\0';
+   engine_context & e = *current_engine;
+   strncpy(e.m_error_message1, s, MAX_ERR_LENGTH);
+   e.m_error_message1[MAX_ERR_LENGTH-1] = '\0';
+   e.m_error_message2[0] = '\0';
    throw error_flag_type(error_flag_no_retry);
 }
 
 
 extern void fail2(const char s1[], const char s2[]) THROW_DECL
 {
-   strncpy(error_message1, s1, MAX_ERR_LENGTH);
-   error_message1[MAX_ERR_LENGTH-1] = '\0';
-   strncpy(error_message2, s2, MAX_ERR_LENGTH);
-   error_message2[MAX_ERR_LENGTH-1] = '\0';
+   engine_context & e = *current_engine;
+   strncpy(e.m_error_message1, s1, MAX_ERR_LENGTH);
+   e.m_error_message1[MAX_ERR_LENGTH-1] = '\0';
+   strncpy(e.m_error_message2, s2, MAX_ERR_LENGTH);
+   e.m_error_message2[MAX_ERR_LENGTH-1] = '\0';
    throw error_flag_type(error_flag_2_line);
 }
 
 
 extern void failp(uint32 id1, const char s[]) THROW_DECL
 {
-   collision_person1 = id1;
-   strncpy(error_message1, s, MAX_ERR_LENGTH);
-   error_message1[MAX_ERR_LENGTH-1] = '\0';
+   engine_context & e = *current_engine;
+   e.m_collision_person1 = id1;
+   strncpy(e.m_error_message1, s, MAX_ERR_LENGTH);
+   e.m_error_message1[MAX_ERR_LENGTH-1] = '\0';
    throw error_flag_type(error_flag_cant_execute);
 }
 
 
 extern void specialfail(const char s[]) THROW_DECL
 {
-   strncpy(error_message1, s, MAX_ERR_LENGTH);
-   error_message1[MAX_ERR_LENGTH-1] = '\0';
-   error_message2[0] = '\0';
+   engine_context & e = *current_engine;
+   strncpy(e.m_error_message1, s, MAX_ERR_LENGTH);
+   e.m_error_message1[MAX_ERR_LENGTH-1] = '\0';
+   e.m_error_message2[0] = '\0';
    throw error_flag_type(error_flag_wrong_resolve_command);
 }
 
 
 void saved_error_info::collect(error_flag_type flag)
 {
+   engine_context & e = *current_engine;
    save_error_flag = flag;
-   strncpy((char *) save_error_message1, error_message1, MAX_ERR_LENGTH);
-   strncpy((char *) save_error_message2, error_message2, MAX_ERR_LENGTH);
-   save_collision_person1 = collision_person1;
-   save_collision_person2 = collision_person2;
+   strncpy((char *) save_error_message1, e.m_error_message1, MAX_ERR_LENGTH);
+   strncpy((char *) save_error_message2, e.m_error_message2, MAX_ERR_LENGTH);
+   save_collision_person1 = e.m_collision_person1;
+   save_collision_person2 = e.m_collision_person2;
 }
 
 void saved_error_info::throw_saved_error() THROW_DECL
 {
-   strncpy(error_message1, (char *) save_error_message1, MAX_ERR_LENGTH);
-   strncpy(error_message2, (char *) save_error_message2, MAX_ERR_LENGTH);
-   collision_person1 = save_collision_person1;
-   collision_person2 = save_collision_person2;
+   engine_context & e = *current_engine;
+   strncpy(e.m_error_message1, (char *) save_error_message1, MAX_ERR_LENGTH);
+   strncpy(e.m_error_message2, (char *) save_error_message2, MAX_ERR_LENGTH);
+   e.m_collision_person1 = save_collision_person1;
+   e.m_collision_person2 = save_collision_person2;
    throw save_error_flag;
 }
 
@@ -3706,6 +3795,7 @@ extern callarray *assoc(
    callarray *spec,
    bool *specialpass /* = (bool *) 0 */) THROW_DECL
 {
+   engine_context & e = *current_engine;
    for (callarray *p = spec ; p ; p = p->next) {
       uint32 k, t, u, w, mask;
       assumption_thing tt;
@@ -3772,20 +3862,20 @@ extern callarray *assoc(
             // and check the number only if CMD_MISC3__SPECIAL_NUMBER_INVOKE is on.  If
             // CMD_MISC3__SPECIAL_NUMBER_INVOKE is off, dismiss it immediately.
             if (!(ss->cmd.cmd_misc3_flags & CMD_MISC3__SPECIAL_NUMBER_INVOKE) ||
-                current_options.howmanynumbers != 1)
+                e.m_current_options.howmanynumbers != 1)
                continue;
          }
          else {
             // Qualifier wants a number, call is not special.  Demand that number be
             // present, and check same.
-            number_used = true;   // Turn this on whether the number matched or not.
-            if (current_options.howmanynumbers == 0)
+            e.m_number_used = true;   // Turn this on whether the number matched or not.
+            if (e.m_current_options.howmanynumbers == 0)
                continue;
          }
 
          // Either way, demand that it be the correct number.
          if (((unsigned int) (p->qualifierstuff & QUALBIT__NUM_MASK) / QUALBIT__NUM_BIT) !=
-             (current_options.number_fields & NUMBER_FIELD_MASK)+1)
+             (e.m_current_options.number_fields & NUMBER_FIELD_MASK)+1)
             continue;
       }
       else {
@@ -4745,15 +4835,16 @@ extern uint32 copy_rot(setup *resultpeople, int resultplace, const setup *source
 
 extern void install_person(setup *resultpeople, int resultplace, const setup *sourcepeople, int sourceplace)
 {
+   engine_context & e = *current_engine;
    uint32 newperson = sourcepeople->people[sourceplace].id1;
 
    if (resultpeople->people[resultplace].id1 == 0)
       resultpeople->people[resultplace] = sourcepeople->people[sourceplace];
    else if (newperson) {
-      collision_person1 = resultpeople->people[resultplace].id1;
-      collision_person2 = newperson;
-      error_message1[0] = '\0';
-      error_message2[0] = '\0';
+      e.m_collision_person1 = resultpeople->people[resultplace].id1;
+      e.m_collision_person2 = newperson;
+      e.m_error_message1[0] = '\0';
+      e.m_error_message2[0] = '\0';
       throw error_flag_type(error_flag_collision);
    }
 }
@@ -4761,6 +4852,7 @@ extern void install_person(setup *resultpeople, int resultplace, const setup *so
 
 extern void install_rot(setup *resultpeople, int resultplace, const setup *sourcepeople, int sourceplace, int rotamount) THROW_DECL
 {
+   engine_context & e = *current_engine;
    uint32 newperson = sourcepeople->people[sourceplace].id1;
 
    if (newperson) {
@@ -4774,10 +4866,10 @@ extern void install_rot(setup *resultpeople, int resultplace, const setup *sourc
          resultpeople->people[resultplace].id3 = sourcepeople->people[sourceplace].id3;
       }
       else {
-         collision_person1 = resultpeople->people[resultplace].id1;
-         collision_person2 = newperson;
-         error_message1[0] = '\0';
-         error_message2[0] = '\0';
+         e.m_collision_person1 = resultpeople->people[resultplace].id1;
+         e.m_collision_person2 = newperson;
+         e.m_error_message1[0] = '\0';
+         e.m_error_message2[0] = '\0';
          throw error_flag_type(error_flag_collision);
       }
    }
@@ -4824,7 +4916,7 @@ extern void install_scatter(setup *resultpeople, int num, const veryshort *place
 
 void warn_about_concept_level()
 {
-   if (allowing_all_concepts)
+   if (current_engine->m_allowing_all_concepts)
       warn(warn__bad_concept_level);
    else
       fail("This concept is not allowed at this level.");
@@ -4932,6 +5024,7 @@ parse_block *process_final_concepts(
    bool forbid_unfinished_parse,
    bool only_one) THROW_DECL
 {
+   engine_context & e = *current_engine;
    for ( ; cptr ; cptr=cptr->next) {
       finalflags the_final_bit = (finalflags) 0;
       uint32 forbidfinalbit = 0;
@@ -4950,12 +5043,12 @@ parse_block *process_final_concepts(
          forbidfinalbit = FINAL__TRIANGLE;
          goto new_final;
       case concept_magic:
-         last_magic_diamond = cptr;
+         e.m_last_magic_diamond = cptr;
          heritsetbit = INHERITFLAG_MAGIC;
          forbidheritbit = INHERITFLAG_SINGLE | INHERITFLAG_DIAMOND;
          break;
       case concept_interlocked:
-         last_magic_diamond = cptr;
+         e.m_last_magic_diamond = cptr;
          heritsetbit = INHERITFLAG_INTLK;
          forbidheritbit = INHERITFLAG_SINGLE | INHERITFLAG_DIAMOND;
          break;
@@ -5658,7 +5751,7 @@ bool warnings_are_unacceptable(bool strict)
    if (!configuration::test_multiple_warnings(no_search_warnings)) return false;
 
    // If the "allow all concepts" switch isn't on, we lose.
-   if (!allowing_all_concepts) return true;
+   if (!current_engine->m_allowing_all_concepts) return true;
 
    // But if "allow all concepts" was given, and the only bad warning is
    // "bad_concept_level", we let it pass.
@@ -6115,6 +6208,7 @@ bool check_for_centers_concept(uint32 & callflags1_to_examine,     // We rewrite
 
 void toplevelmove() THROW_DECL
 {
+   engine_context & e = *current_engine;
    int i;
 
    // Must copy this out of the history; it may be modified.
@@ -6130,8 +6224,8 @@ void toplevelmove() THROW_DECL
 
    /* Be sure that the amount of written history that we consider to be safely
       written is less than the item we are about to change. */
-   if (written_history_items > config_history_ptr)
-      written_history_items = config_history_ptr;
+   if (e.m_written_history_items > e.m_config_history_ptr)
+      e.m_written_history_items = e.m_config_history_ptr;
 
    starting_setup.cmd.cmd_misc_flags = 0;
    starting_setup.cmd.cmd_misc2_flags = 0;
@@ -6166,10 +6260,10 @@ void toplevelmove() THROW_DECL
 
       // claim that config_history_ptr == 1
 
-      parse_state.topcallflags1 = 0;
+      e.m_parse_state.topcallflags1 = 0;
       parse_block *cnext = conceptptr->next;
 
-      if (!check_for_centers_concept(parse_state.topcallflags1, cnext, &starting_setup.cmd)) {
+      if (!check_for_centers_concept(e.m_parse_state.topcallflags1, cnext, &starting_setup.cmd)) {
          if (cnext->call &&
              (cnext->call->the_defn.schema == schema_concentric_specialpromenade ||
               cnext->call->the_defn.schema == schema_cross_concentric_specialpromenade)) {
@@ -6198,7 +6292,7 @@ void toplevelmove() THROW_DECL
    newhist.draw_pic = false;
    newhist.state_is_valid = false;
    newhist.init_resolve();
-   current_options = null_options;
+   e.m_current_options = null_options;
 
    // Put in identification bits for global/unsymmetrical stuff, if possible.
    clear_absolute_proximity_and_facing_bits(&starting_setup);
@@ -6818,6 +6912,7 @@ void finish_toplevelmove() THROW_DECL
 // This stuff is duplicated in verify_call in sdmatch.c .
 bool deposit_call_tree(modifier_block *anythings, parse_block *save1, int key)
 {
+   engine_context & e = *current_engine;
    // First, if we have already deposited a call, and we see more stuff, it must be
    // concepts or calls for an "anything" subcall.
 
@@ -6833,17 +6928,17 @@ bool deposit_call_tree(modifier_block *anythings, parse_block *save1, int key)
                            base_call_null_second: base_call_null];
       tt->call_to_print = tt->call;
       tt->replacement_key = key;
-      parse_state.concept_write_ptr = &tt->subsidiary_root;
+      e.m_parse_state.concept_write_ptr = &tt->subsidiary_root;
    }
 
    save1 = (parse_block *) 0;
-   gg77->matcher_p->m_final_result.match.call_conc_options = anythings->call_conc_options;
+   e.m_gg77->matcher_p->m_final_result.match.call_conc_options = anythings->call_conc_options;
 
    if (anythings->kind == ui_call_select) {
       if (deposit_call(anythings->call_ptr, &anythings->call_conc_options)) return true;
-      save1 = *parse_state.concept_write_ptr;
-      if (!there_is_a_call) the_topcallflags = parse_state.topcallflags1;
-      there_is_a_call = true;
+      save1 = *e.m_parse_state.concept_write_ptr;
+      if (!e.m_there_is_a_call) e.m_the_topcallflags = e.m_parse_state.topcallflags1;
+      e.m_there_is_a_call = true;
    }
    else if (anythings->kind == ui_concept_select) {
       if (deposit_concept(anythings->concept_ptr)) return true;
@@ -6875,6 +6970,7 @@ bool do_subcall_query(
    bool this_is_tagger_circcer,
    call_with_name *orig_call)
 {
+   engine_context & e = *current_engine;
    char tempstring_text[MAX_TEXT_LINE_LENGTH];
 
    // Note whether we are using any mandatory substitutions, so that the menu
@@ -6887,7 +6983,7 @@ bool do_subcall_query(
       // mandatory subcall (e.g. "wheel and <anything>") is simply rejected.
       if (forbid_call_with_mandatory_subcall())
          fail_no_retry("Mandatory subcall fail.");
-      mandatory_call_used = true;
+      e.m_mandatory_call_used = true;
    }
 
    // Now we know that the list doesn't say anything about this call.  Perhaps we should
@@ -6910,9 +7006,9 @@ bool do_subcall_query(
    // interactive) for the calls that we randomly choose, but not for the later calls
    // that we test for fidelity.
 
-   if (!(interactivity == interactivity_normal ||
+   if (!(e.m_interactivity == interactivity_normal ||
          allow_random_subcall_pick()) ||
-       testing_fidelity)
+       e.m_testing_fidelity)
       return true;
 
    // When we are searching for resolves and the like, the situation
@@ -6931,10 +7027,10 @@ bool do_subcall_query(
    case DFM1_CALL_MOD_ANYCALL/DFM1_CALL_MOD_BIT:
    case DFM1_CALL_MOD_ALLOW_PLAIN_MOD/DFM1_CALL_MOD_BIT:
    case DFM1_CALL_MOD_OR_SECONDARY/DFM1_CALL_MOD_BIT:
-      if (!allowing_modifications) return true;
+      if (!e.m_allowing_modifications) return true;
       break;
    case DFM1_CALL_MOD_ALLOW_FORCED_MOD/DFM1_CALL_MOD_BIT:
-      if (allowing_modifications <= 1) return true;
+      if (e.m_allowing_modifications <= 1) return true;
       break;
    }
 
@@ -6958,7 +7054,7 @@ bool do_subcall_query(
    // If the replacement is mandatory, or we are not interactive,
    // don't present the popup.  Just get the replacement call.
 
-   else if (interactivity != interactivity_normal)
+   else if (e.m_interactivity != interactivity_normal)
       ;
    else if (snumber == (DFM1_CALL_MOD_MAND_ANYCALL/DFM1_CALL_MOD_BIT))
       sprintf(tempstring_text, "SUBSIDIARY CALL");
@@ -6973,10 +7069,10 @@ bool do_subcall_query(
 
       // Star turn calls can have funny names like "nobox".
 
-      gg77->unparse_call_name(
+      e.m_gg77->unparse_call_name(
          (orig_call->the_defn.callflagsf & CFLAG2_IS_STAR_CALL) ?
          "turn the star @b" : orig_call->name,
-         pretty_call_name, &current_options);
+         pretty_call_name, &e.m_current_options);
 
       const char *line_format;
 
@@ -6989,7 +7085,7 @@ bool do_subcall_query(
 
       char tempstuff[200];
       sprintf(tempstuff, line_format, pretty_call_name);
-      if (gg77->iob88.yesnoconfirm("Replacement", tempstuff, "Do you want to replace it?", false, false)) {
+      if (e.m_gg77->iob88.yesnoconfirm("Replacement", tempstuff, "Do you want to replace it?", false, false)) {
          // User accepted the modification.
          // Set up the prompt and get the concepts and call.
          sprintf(tempstring_text, "REPLACEMENT FOR THE %s", pretty_call_name);
@@ -6999,7 +7095,7 @@ bool do_subcall_query(
          // so that we don't query again.
          *newsearch = get_parse_block();
          (*newsearch)->concept = &concept_marker_concept_mod;
-         (*newsearch)->options = current_options;
+         (*newsearch)->options = e.m_current_options;
          (*newsearch)->replacement_key = snumber;
          (*newsearch)->call = orig_call;
          (*newsearch)->call_to_print = orig_call;
@@ -7009,7 +7105,7 @@ bool do_subcall_query(
 
    *newsearch = get_parse_block();
    (*newsearch)->concept = &concept_marker_concept_mod;
-   (*newsearch)->options = current_options;
+   (*newsearch)->options = e.m_current_options;
    (*newsearch)->replacement_key = snumber;
    (*newsearch)->call = orig_call;
    (*newsearch)->call_to_print = orig_call;
@@ -7019,12 +7115,12 @@ bool do_subcall_query(
    /* Create a new parse block, point concept_write_ptr at its contents. */
    /* Create the new root at the start of the subsidiary list. */
 
-   parse_state.concept_write_base = &(*newsearch)->subsidiary_root;
-   parse_state.concept_write_ptr = parse_state.concept_write_base;
+   e.m_parse_state.concept_write_base = &(*newsearch)->subsidiary_root;
+   e.m_parse_state.concept_write_ptr = e.m_parse_state.concept_write_base;
 
-   parse_state.parse_stack_index = 0;
-   parse_state.call_list_to_use = call_list_any;
-   strncpy(parse_state.specialprompt, tempstring_text, MAX_TEXT_LINE_LENGTH);
+   e.m_parse_state.parse_stack_index = 0;
+   e.m_parse_state.call_list_to_use = call_list_any;
+   strncpy(e.m_parse_state.specialprompt, tempstring_text, MAX_TEXT_LINE_LENGTH);
 
    // Search for special case of "must_be_tag_call" with no other modification bits.
    // That means it is a new-style tagging call.
@@ -7037,8 +7133,8 @@ bool do_subcall_query(
          // User clicked on something unusual like "exit" or "undo".
          // These are generally not allowed.
          // But it might be "pick random call", which we can handle.
-         if (global_reply.majorpart == ui_command_select &&
-             ((command_kind) global_reply.minorpart) == command_random_call)
+         if (e.m_global_reply.majorpart == ui_command_select &&
+             ((command_kind) e.m_global_reply.minorpart) == command_random_call)
             throw error_flag_type(error_flag_user_wants_to_resolve);
 
          throw error_flag_type(error_flag_wrong_command);
@@ -174,6 +174,7 @@ extern void erase_last_n(int n)
 
 extern void put_line(const char the_line[])
 {
+   engine_context & e = *current_engine;
    if (sdtty_no_console) {
       // No funny stuff at all.
       // By leaving "use_escapes_for_drawing_people" at zero, we know
@@ -192,32 +193,32 @@ extern void put_line(const char the_line[])
 
             int randomized_person_color = personidx;
 
-            if (ui_options.color_scheme == color_by_couple_random && ui_options.hide_glyph_numbers) {
+            if (e.m_ui_options.color_scheme == color_by_couple_random && e.m_ui_options.hide_glyph_numbers) {
                randomized_person_color = (color_randomizer[personidx>>1] << 1) | (personidx & 1);
             }
 
             put_char(' ');
 
-            if (ui_options.color_scheme != no_color) {
+            if (e.m_ui_options.color_scheme != no_color) {
                fputs("\033[1;", stdout);
                fputs(color_translations[color_index_list[randomized_person_color]].vt100_string, stdout);
 
-               if (ui_options.reverse_video)
+               if (e.m_ui_options.reverse_video)
                   fputs(";40m", stdout);
                else
                   fputs(";47m", stdout);
             }
 
-            if (ui_options.hide_glyph_numbers)
+            if (e.m_ui_options.hide_glyph_numbers)
                put_char(' ');
             else
-               put_char(ui_options.pn1[personidx]);
+               put_char(e.m_ui_options.pn1[personidx]);
 
-            put_char(ui_options.pn2[personidx]);
-            put_char(ui_options.direc[persondir]);
+            put_char(e.m_ui_options.pn2[personidx]);
+            put_char(e.m_ui_options.direc[persondir]);
 
-            if (ui_options.color_scheme != no_color) {
-               if (ui_options.reverse_video)
+            if (e.m_ui_options.color_scheme != no_color) {
+               if (e.m_ui_options.reverse_video)
                   (void) fputs("\033[0;37;40m", stdout);
                else
                   (void) fputs("\033[0;30;47m", stdout);
@@ -394,7 +395,7 @@ void initialize_signal_handlers()
 void iofull::final_initialize()
 {
    if (!sdtty_no_console)
-      ui_options.use_escapes_for_drawing_people = 1;
+      current_engine->m_ui_options.use_escapes_for_drawing_people = 1;
 
    initialize_signal_handlers();
 }
@@ -127,10 +127,11 @@ static resolver_display_state resolver_happiness = resolver_display_failed;
 
 int main(int argc, char *argv[])
 {
+   engine_context & e = *current_engine;
    // In Sdtty, the defaults are reverse video (white-on-black) and pastel colors.
 
-   ui_options.reverse_video = true;
-   ui_options.pastel_color = true;
+   e.m_ui_options.reverse_video = true;
+   e.m_ui_options.pastel_color = true;
 
    // Initialize all the callbacks that sdlib will need.
    iofull ggg;
@@ -148,7 +149,7 @@ static const char *function_key_expansion;
 
 void refresh_input()
 {
-   gg77->matcher_p->erase_matcher_input();
+   current_engine->m_gg77->matcher_p->erase_matcher_input();
    user_input[0] = '\0';
    function_key_expansion = (const char *) 0;
    clear_line();
@@ -196,6 +197,7 @@ static char alt1_names2[] = "1P2R3O4C";
 
 void iofull::process_command_line(int *argcp, char ***argvp)
 {
+   engine_context & e = *current_engine;
    int argno = 1;
    char **argv = *argvp;
    journal_name[0] = '\0';
@@ -210,8 +212,8 @@ void iofull::process_command_line(int *argcp, char ***argvp)
       else if (strcmp(argv[argno], "-no_console") == 0)
          sdtty_no_console = true;
       else if (strcmp(argv[argno], "-alternate_glyphs_1") == 0) {
-         ui_options.pn1 = alt1_names1;
-         ui_options.pn2 = alt1_names2;
+         e.m_ui_options.pn1 = alt1_names1;
+         e.m_ui_options.pn2 = alt1_names2;
       }
       else if (strcmp(argv[argno], "-lines") == 0 && argno+1 < (*argcp)) {
          sdtty_screen_height = atoi(argv[argno+1]);
@@ -261,6 +263,7 @@ void iofull::process_command_line(int *argcp, char ***argvp)
 
 static bool really_open_session()
 {
+   engine_context & e = *current_engine;
    Cstring session_error_msg;
 
    // Process the session list.  If user has specified a
@@ -273,7 +276,7 @@ static bool really_open_session()
    // If user gave a session specification
    // in the command line, we don't query about the session.
 
-   if (ui_options.force_session == -1000000) {
+   if (e.m_ui_options.force_session == -1000000) {
       char line[MAX_FILENAME_LENGTH];
 
       put_line("Do you want to use one of the following sessions?\n\n");
@@ -297,7 +300,7 @@ static bool really_open_session()
    }
    else {
       while (get_next_session_line((char *) 0));   // Need to scan the file anyway.
-      session_index = ui_options.force_session;
+      session_index = e.m_ui_options.force_session;
    }
 
    if (session_index < 0)
@@ -470,7 +473,7 @@ void iofull::set_window_title(char s[])
 
 static void uims_bell()
 {
-   if (!ui_options.no_sound) ttu_bell();
+   if (!current_engine->m_ui_options.no_sound) ttu_bell();
 }
 
 
@@ -479,7 +482,7 @@ static void pack_and_echo_character(char c)
    // Really should handle error better -- ring the bell,
    // but this is called inside a loop.
 
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
 
    if (matcher.m_user_input_size < INPUT_TEXTLINE_SIZE) {
       user_input[matcher.m_user_input_size] = c;
@@ -531,7 +534,7 @@ static bool prompt_for_more_output()
       switch (c) {
       case '\r':
       case '\n':
-         match_counter = text_line_count+1; // Show one more line,
+         match_counter = current_engine->m_text_line_count+1; // Show one more line,
          return true;       // but otherwise keep going.
       case '\b':
       case DEL:
@@ -549,12 +552,13 @@ static bool prompt_for_more_output()
 
 void iofull::show_match(int frequency_to_show)
 {
+   engine_context & e = *current_engine;
    if (get_utils_ptr()->matcher_p->m_showing_has_stopped) return;  // Showing has been turned off.
 
-   if (match_counter <= text_line_count) {
-      match_counter = text_line_count+match_lines-2;
+   if (match_counter <= e.m_text_line_count) {
+      match_counter = e.m_text_line_count+match_lines-2;
       if (!prompt_for_more_output()) {
-         match_counter = text_line_count-1;   // Turn it off.
+         match_counter = e.m_text_line_count-1;   // Turn it off.
          get_utils_ptr()->matcher_p->m_showing_has_stopped = true;
          return;
       }
@@ -566,21 +570,23 @@ void iofull::show_match(int frequency_to_show)
 
 void iofull::prepare_for_listing()
 {
+   engine_context & e = *current_engine;
    match_lines = get_lines_for_more();
    if (match_lines < 2) match_lines = 25;  // The system is screwed up.
-   if (ui_options.diagnostic_mode) match_lines = 1000000;
-   match_counter = text_line_count+match_lines-2;   // Count for for "--More--" prompt.
+   if (e.m_ui_options.diagnostic_mode) match_lines = 1000000;
+   match_counter = e.m_text_line_count+match_lines-2;   // Count for for "--More--" prompt.
    get_utils_ptr()->matcher_p->m_showing_has_stopped = false;
 }
 
 
 static bool get_user_input(const char *prompt, int which)
 {
+   engine_context & e = *current_engine;
    char *p;
    char c;
    int nc;
    int matches;
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *e.m_gg77->matcher_p;
 
    matcher.m_active_result.valid = false;
    user_input_prompt = prompt;
@@ -617,7 +623,7 @@ static bool get_user_input(const char *prompt, int which)
             // User clicked the "X" in the upper-right corner, or used the system menu
             // to close the program, or perhaps used the task manager.  In any case,
             // don't close without querying the user.
-            if (which_target == matcher_class::e_match_startup_commands || gg77->iob88.do_abort_popup() == POPUP_ACCEPT)
+            if (which_target == matcher_class::e_match_startup_commands || e.m_gg77->iob88.do_abort_popup() == POPUP_ACCEPT)
                general_final_exit(0);
          }
 
@@ -664,7 +670,7 @@ static bool get_user_input(const char *prompt, int which)
             // the usual way anyway.  This makes the behavior similar to Sd, where
             // the system automatically provides that action.
             if (nc == AFKEY+4) {
-               if (which_target == matcher_class::e_match_startup_commands || gg77->iob88.do_abort_popup() == POPUP_ACCEPT)
+               if (which_target == matcher_class::e_match_startup_commands || e.m_gg77->iob88.do_abort_popup() == POPUP_ACCEPT)
                   general_final_exit(0);
             }
 
@@ -713,7 +719,7 @@ static bool get_user_input(const char *prompt, int which)
          put_char(c);
          put_line("\n");
          current_text_line++;
-         gg77->iob88.prepare_for_listing();
+         e.m_gg77->iob88.prepare_for_listing();
          matcher.match_user_input(which, true, c == '?', false);
          put_line("\n");     // Write a blank line.
          current_text_line++;
@@ -741,7 +747,7 @@ static bool get_user_input(const char *prompt, int which)
          }
          else if (matcher.m_space_ok && matches > 1)
             pack_and_echo_character(c);
-         else if (ui_options.diagnostic_mode)
+         else if (e.m_ui_options.diagnostic_mode)
             goto diagnostic_error;
          else
             uims_bell();
@@ -750,7 +756,7 @@ static bool get_user_input(const char *prompt, int which)
 
          // Look for abbreviations.
 
-         if (gg77->look_up_abbreviations(which))
+         if (e.m_gg77->look_up_abbreviations(which))
             return false;
 
          matches = matcher.match_user_input(which, false, false, true);
@@ -788,7 +794,7 @@ static bool get_user_input(const char *prompt, int which)
             return false;
          }
 
-         if (ui_options.diagnostic_mode)
+         if (e.m_ui_options.diagnostic_mode)
             goto diagnostic_error;
 
          /* Tell how bad it is, then redisplay current line. */
@@ -813,14 +819,14 @@ static bool get_user_input(const char *prompt, int which)
             while (*p)
                pack_and_echo_character(*p++);
          }
-         else if (ui_options.diagnostic_mode)
+         else if (e.m_ui_options.diagnostic_mode)
             goto diagnostic_error;
          else
             uims_bell();
       }
       else if (isprint(c))
          pack_and_echo_character(c);
-      else if (ui_options.diagnostic_mode)
+      else if (e.m_ui_options.diagnostic_mode)
          goto diagnostic_error;
       else
          uims_bell();
@@ -872,7 +878,7 @@ static const char *banner_prompts4[] = {
 
 uims_reply_thing iofull::get_startup_command()
 {
-   modifier_block &matchmatch = (*gg77->matcher_p).m_final_result.match;
+   modifier_block &matchmatch = (*current_engine->m_gg77->matcher_p).m_final_result.match;
 
    for (;;) {
       if (!get_user_input("Enter startup command> ", (int) matcher_class::e_match_startup_commands))
@@ -899,12 +905,13 @@ uims_reply_thing iofull::get_startup_command()
 // This returns ui_user_cancel if it fails, e.g. the user waves the mouse away.
 uims_reply_thing iofull::get_call_command()
 {
+   engine_context & e = *current_engine;
    char prompt_buffer[200];
    const char *prompt_ptr;
-   modifier_block &matchmatch = (*gg77->matcher_p).m_final_result.match;
+   modifier_block &matchmatch = (*e.m_gg77->matcher_p).m_final_result.match;
 
-   if (allowing_modifications != 0)
-      parse_state.call_list_to_use = call_list_any;
+   if (e.m_allowing_modifications != 0)
+      e.m_parse_state.call_list_to_use = call_list_any;
 
    prompt_ptr = prompt_buffer;
    prompt_buffer[0] = '\0';
@@ -912,11 +919,11 @@ uims_reply_thing iofull::get_call_command()
    // Put any necessary special things into the prompt.
 
    int banner_mode =
-      (allowing_minigrand ? 256 : 0) |
-      (ui_options.singing_call_mode << 6) |
-      (using_active_phantoms ? 16 : 0) |
-      (allowing_all_concepts ? 4 : 0) |
-      (allowing_modifications);
+      (e.m_allowing_minigrand ? 256 : 0) |
+      (e.m_ui_options.singing_call_mode << 6) |
+      (e.m_using_active_phantoms ? 16 : 0) |
+      (e.m_allowing_all_concepts ? 4 : 0) |
+      (e.m_allowing_modifications);
 
    if (banner_mode != 0) {
       int i;
@@ -949,12 +956,12 @@ uims_reply_thing iofull::get_call_command()
       }
 
       strcat(prompt_buffer, "] ");
-      strcat(prompt_buffer, call_menu_prompts[parse_state.call_list_to_use]);
+      strcat(prompt_buffer, call_menu_prompts[e.m_parse_state.call_list_to_use]);
    }
    else
-      prompt_ptr = call_menu_prompts[parse_state.call_list_to_use];
+      prompt_ptr = call_menu_prompts[e.m_parse_state.call_list_to_use];
 
-   if (get_user_input(prompt_ptr, (int) parse_state.call_list_to_use)) {
+   if (get_user_input(prompt_ptr, (int) e.m_parse_state.call_list_to_use)) {
       // User typed "help".
       return uims_reply_thing(ui_command_select, command_help);
    }
@@ -971,12 +978,12 @@ uims_reply_thing iofull::get_call_command()
    }
    else {
       call_conc_option_state save_stuff = matchmatch.call_conc_options;
-      there_is_a_call = false;
+      e.m_there_is_a_call = false;
       uims_reply_kind my_reply = matchmatch.kind;
       bool retval = deposit_call_tree(&matchmatch, (parse_block *) 0, DFM1_CALL_MOD_MAND_ANYCALL/DFM1_CALL_MOD_BIT);
       matchmatch.call_conc_options = save_stuff;
-      if (there_is_a_call) {
-         parse_state.topcallflags1 = the_topcallflags;
+      if (e.m_there_is_a_call) {
+         e.m_parse_state.topcallflags1 = e.m_the_topcallflags;
          my_reply = ui_call_select;
       }
 
@@ -1002,7 +1009,7 @@ void iofull::dispose_of_abbreviation(const char *linebuff)
 
 uims_reply_thing iofull::get_resolve_command()
 {
-   modifier_block &matchmatch = (*gg77->matcher_p).m_final_result.match;
+   modifier_block &matchmatch = (*current_engine->m_gg77->matcher_p).m_final_result.match;
 
    for (;;) {
       if (!get_user_input("Enter search command> ", (int) matcher_class::e_match_resolve_commands))
@@ -1078,7 +1085,7 @@ static int confirm(Cstring question)
 
       if (c >= 0) put_char(c);
 
-      if (ui_options.diagnostic_mode) {
+      if (current_engine->m_ui_options.diagnostic_mode) {
          fputs("\nParsing error during diagnostic.\n", stdout);
          fputs("\nParsing error during diagnostic.\n", stderr);
          general_final_exit(1);
@@ -1159,7 +1166,7 @@ direction_kind iofull::do_direction_popup(matcher_class &matcher)
 
 int iofull::do_tagger_popup(int tagger_class)
 {
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
    match_result saved_match = matcher.m_final_result;
 
    for (;;) {
@@ -1181,11 +1188,12 @@ int iofull::do_tagger_popup(int tagger_class)
 
 int iofull::do_circcer_popup()
 {
+   engine_context & e = *current_engine;
    uint32 retval;
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *e.m_gg77->matcher_p;
 
-   if (interactivity == interactivity_verify) {
-      retval = verify_options.circcer;
+   if (e.m_interactivity == interactivity_verify) {
+      retval = e.m_verify_options.circcer;
       if (retval == 0) retval = 1;
    }
    else if (!matcher.m_final_result.valid || (matcher.m_final_result.match.call_conc_options.circcer == 0)) {
@@ -214,7 +214,7 @@ static char szMainTitle[MAX_TEXT_LINE_LENGTH];
 
 static void uims_bell()
 {
-   if (!ui_options.no_sound) MessageBeep(MB_ICONEXCLAMATION);
+   if (!current_engine->m_ui_options.no_sound) MessageBeep(MB_ICONEXCLAMATION);
 }
 
 
@@ -233,30 +233,30 @@ static void UpdateStatusBar(Cstring szFirstPane)
    StatusBarDimensions[5] = (115*GLOBStatusBarLength)>>7;
    StatusBarDimensions[6] = -1;
 
-   if (allowing_modifications || allowing_all_concepts ||
-       using_active_phantoms || allowing_minigrand ||
-       ui_options.singing_call_mode || ui_options.nowarn_mode) {
+   if (current_engine->m_allowing_modifications || current_engine->m_allowing_all_concepts ||
+       current_engine->m_using_active_phantoms || current_engine->m_allowing_minigrand ||
+       current_engine->m_ui_options.singing_call_mode || current_engine->m_ui_options.nowarn_mode) {
       SendMessage(hwndStatusBar, SB_SETPARTS, 7, (LPARAM) StatusBarDimensions);
 
       SendMessage(hwndStatusBar, SB_SETTEXT, 1,
-                  (LPARAM) ((allowing_modifications == 2) ? "all mods" :
-                            (allowing_modifications ? "simple mods" : "")));
+                  (LPARAM) ((current_engine->m_allowing_modifications == 2) ? "all mods" :
+                            (current_engine->m_allowing_modifications ? "simple mods" : "")));
 
       SendMessage(hwndStatusBar, SB_SETTEXT, 2,
-                  (LPARAM) (allowing_all_concepts ? "all concepts" : ""));
+                  (LPARAM) (current_engine->m_allowing_all_concepts ? "all concepts" : ""));
 
       SendMessage(hwndStatusBar, SB_SETTEXT, 3,
-                  (LPARAM) (using_active_phantoms ? "act phan" : ""));
+                  (LPARAM) (current_engine->m_using_active_phantoms ? "act phan" : ""));
 
       SendMessage(hwndStatusBar, SB_SETTEXT, 4,
-                  (LPARAM) ((ui_options.singing_call_mode == 2) ? "rev singer" :
-                            (ui_options.singing_call_mode ? "singer" : "")));
+                  (LPARAM) ((current_engine->m_ui_options.singing_call_mode == 2) ? "rev singer" :
+                            (current_engine->m_ui_options.singing_call_mode ? "singer" : "")));
 
       SendMessage(hwndStatusBar, SB_SETTEXT, 5,
-                  (LPARAM) (ui_options.nowarn_mode ? "no warn" : ""));
+                  (LPARAM) (current_engine->m_ui_options.nowarn_mode ? "no warn" : ""));
 
       SendMessage(hwndStatusBar, SB_SETTEXT, 6,
-                  (LPARAM) (allowing_minigrand ? "minigrand" : ""));
+                  (LPARAM) (current_engine->m_allowing_minigrand ? "minigrand" : ""));
    }
    else {
       SendMessage(hwndStatusBar, SB_SETPARTS, 1, (LPARAM) StatusBarDimensions);
@@ -338,7 +338,7 @@ static void check_text_change(bool doing_escape)
    char *p;
    int matches;
    bool changed_editbox = false;
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
 
    // Find out what the text input box contains now.
 
@@ -502,7 +502,7 @@ static int LookupKeystrokeBinding(
    int nc;
    uint32 ctlbits;
    int newparm = -99;
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
 
    switch (iMsg) {
    case WM_KEYDOWN:
@@ -540,7 +540,7 @@ static int LookupKeystrokeBinding(
          // Windows is used in this paragraph as a reference to a registered
          // trademark of Microsoft, a notorious software / virus propagation
          // company.
-         if (ui_options.tab_changes_focus || (ctlbits & 2)) {
+         if (current_engine->m_ui_options.tab_changes_focus || (ctlbits & 2)) {
             ButtonFocusIndex += 1 - (ctlbits & 2);   // Yeah, sleazy.
             if (ButtonFocusIndex > ButtonFocusHigh) ButtonFocusIndex = 0;
             else if (ButtonFocusIndex < 0) ButtonFocusIndex = ButtonFocusHigh;
@@ -898,13 +898,13 @@ static void Transcript_OnPaint(HWND hwnd)
 
                int randomized_person_color = personidx;
 
-               if (ui_options.color_scheme == color_by_couple_random && ui_options.hide_glyph_numbers) {
+               if (current_engine->m_ui_options.color_scheme == color_by_couple_random && current_engine->m_ui_options.hide_glyph_numbers) {
                   randomized_person_color = (color_randomizer[personidx>>1] << 1) | (personidx & 1);
                }
 
-               if (ui_options.no_graphics == 0) {
+               if (current_engine->m_ui_options.no_graphics == 0) {
                   xgoodies = randomized_person_color*BMP_PERSON_SIZE;
-                  ygoodies = BMP_PERSON_SIZE*((persondir & 3)+(ui_options.hide_glyph_numbers ? 4 : 0));
+                  ygoodies = BMP_PERSON_SIZE*((persondir & 3)+(current_engine->m_ui_options.hide_glyph_numbers ? 4 : 0));
                   goto do_DIB_thing;
                }
                else {
@@ -913,18 +913,18 @@ static void Transcript_OnPaint(HWND hwnd)
 
                   ExtTextOut(PaintDC, x, Y, ETO_CLIPPED, &PaintStruct.rcPaint, cc, 1, 0);
 
-                  if (ui_options.color_scheme != no_color)
+                  if (current_engine->m_ui_options.color_scheme != no_color)
                      SetTextColor(PaintDC, text_color_translate[color_index_list[randomized_person_color]]);
 
-                  cc[0] = ui_options.pn1[personidx];
-                  cc[1] = ui_options.pn2[personidx];
-                  cc[2] = ui_options.direc[persondir];
+                  cc[0] = current_engine->m_ui_options.pn1[personidx];
+                  cc[1] = current_engine->m_ui_options.pn2[personidx];
+                  cc[2] = current_engine->m_ui_options.direc[persondir];
 
                   ExtTextOut(PaintDC, x, Y, ETO_CLIPPED, &PaintStruct.rcPaint, cc, 3, 0);
 
                   // Set back to plain "white".
 
-                  if (ui_options.color_scheme != no_color)
+                  if (current_engine->m_ui_options.color_scheme != no_color)
                      SetTextColor(PaintDC, plaintext_fg);
 
                   xdelta = TranscriptTextWidth*4;
@@ -933,7 +933,7 @@ static void Transcript_OnPaint(HWND hwnd)
             }
             else if (*cp == '\014') {
                // Display a dot for a phantom.
-               if (ui_options.no_graphics == 0) {
+               if (current_engine->m_ui_options.no_graphics == 0) {
                   xgoodies = 0;
                   ygoodies = BMP_PERSON_SIZE*8;
                   goto do_DIB_thing;
@@ -945,32 +945,32 @@ static void Transcript_OnPaint(HWND hwnd)
             }
             else if (*cp == '6') {
                // 6 means space equivalent to one person size.
-               xdelta = (ui_options.no_graphics == 0) ?
+               xdelta = (current_engine->m_ui_options.no_graphics == 0) ?
                   (BMP_PERSON_SIZE) : (TranscriptTextWidth*4);
                continue;
             }
             else if (*cp == '5') {
                // 5 means space equivalent to half of a person size.
-               xdelta = (ui_options.no_graphics == 0) ?
+               xdelta = (current_engine->m_ui_options.no_graphics == 0) ?
                   (BMP_PERSON_SIZE/2) : (TranscriptTextWidth*2);
                continue;
             }
             else if (*cp == '9') {
                // 9 means space equivalent to 3/4 of a person size.
-               xdelta = (ui_options.no_graphics == 0) ?
+               xdelta = (current_engine->m_ui_options.no_graphics == 0) ?
                   (3*BMP_PERSON_SIZE/4) : (TranscriptTextWidth*3);
                continue;
             }
             else if (*cp == '8') {
                // 8 means space equivalent to half of a person size
                // if doing checkers, but only one space if in ASCII.
-               xdelta = (ui_options.no_graphics == 0) ?
+               xdelta = (current_engine->m_ui_options.no_graphics == 0) ?
                   (BMP_PERSON_SIZE/2) : (TranscriptTextWidth);
                continue;
             }
             else if (*cp == ' ') {
                // The tables generally use two blanks as the inter-person spacing.
-               xdelta = (ui_options.no_graphics == 0) ?
+               xdelta = (current_engine->m_ui_options.no_graphics == 0) ?
                   (BMP_PERSON_SPACE/2) : (TranscriptTextWidth);
                continue;
             }
@@ -1176,8 +1176,8 @@ int WINAPI WinMain(
 
    // Set the UI options for Sd.
 
-   ui_options.reverse_video = false;
-   ui_options.pastel_color = false;
+   current_engine->m_ui_options.reverse_video = false;
+   current_engine->m_ui_options.pastel_color = false;
 
    // Initialize all the callbacks that sdlib will need.
    iofull ggg;
@@ -1278,7 +1278,7 @@ BOOL MainWindow_OnCreate(HWND hwnd, LPCREATESTRUCT lpCreateStruct)
 
    if (!hwndProgress||!hwndAcceptButton||!hwndCancelButton||!hwndCallMenu||
        !hwndTextInputArea||!hwndTranscriptArea||!hwndStatusBar) {
-      gg77->iob88.fatal_error_exit(1, "Can't create windows", 0);
+      current_engine->m_gg77->iob88.fatal_error_exit(1, "Can't create windows", 0);
    }
 
    return TRUE;
@@ -1405,7 +1405,7 @@ void MainWindow_OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
    int i;
    int matches;
    int nMenuIndex;
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
 
    switch (id) {
    case ID_HELP_ABOUTSD:
@@ -1415,11 +1415,11 @@ void MainWindow_OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
       // The claim is that we can take this clause out, and the normal
       // program mechanism will do the same thing.  That claim isn't yet
       // completely true, so we leave this in for now.
-      gg77->iob88.help_manual();
+      current_engine->m_gg77->iob88.help_manual();
       break;
    case ID_HELP_FAQ:
       // Ditto.
-      gg77->iob88.help_faq();
+      current_engine->m_gg77->iob88.help_faq();
       break;
    case ID_FILE_EXIT:
       SendMessage(hwndMain, WM_CLOSE, 0, 0L);
@@ -1437,7 +1437,7 @@ void MainWindow_OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
       break;
    case CALL_MENU_INDEX:
       // See whether this an appropriate single-click or double-click.
-      if (codeNotify != (ui_options.accept_single_click ?
+      if (codeNotify != (current_engine->m_ui_options.accept_single_click ?
                          (UINT) LBN_SELCHANGE : (UINT) LBN_DBLCLK))
          break;
       // !!!! FALL THROUGH !!!!
@@ -1465,7 +1465,7 @@ void MainWindow_OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
       }
 
       // Look for abbreviations.
-      if (gg77->look_up_abbreviations(nLastOne))
+      if (current_engine->m_gg77->look_up_abbreviations(nLastOne))
          return;
 
       matches = matcher.match_user_input(nLastOne, false, false, false);
@@ -1541,7 +1541,7 @@ void MainWindow_OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
          }
          else if (matcher.m_final_result.match.kind == ui_call_select) {
             matcher.m_final_result.match.call_ptr =
-               main_call_lists[parse_state.call_list_to_use][matcher.m_final_result.match.index];
+               main_call_lists[current_engine->m_parse_state.call_list_to_use][matcher.m_final_result.match.index];
          }
       }
 
@@ -1797,7 +1797,7 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam)
       // We get here if the user presses alt-F4 and we haven't bound it to anything,
       // or if the user selects "exit" from the "file" menu.
 
-      if (MenuKind != ui_start_select && gg77->iob88.do_abort_popup() != POPUP_ACCEPT)
+      if (MenuKind != ui_start_select && current_engine->m_gg77->iob88.do_abort_popup() != POPUP_ACCEPT)
          return 0;  // Queried user; user said no; so we don't shut down.
 
       // Close journal and session files; call general_final_exit,
@@ -1969,7 +1969,7 @@ static void Startup_OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
          }
 
          if (session_info & 2)
-            gg77->iob88.serious_error_print(session_error_msg);
+            current_engine->m_gg77->iob88.serious_error_print(session_error_msg);
 
          // If the level never got specified, either from a command line
          // argument or from the session file, put up the level selection
@@ -2050,7 +2050,7 @@ static void Startup_OnCommand(HWND hwnd, int id, HWND hwndCtl, UINT codeNotify)
          database_filename = szDatabaseFilename;
       }
 
-      ui_options.sequence_num_override =
+      current_engine->m_ui_options.sequence_num_override =
          SendMessage(GetDlgItem(hwnd, IDC_SEQ_NUM_OVERRIDE_SPIN), UDM_GETPOS, 0, 0L);
 
    getoutahere:
@@ -2070,8 +2070,8 @@ static BOOL Startup_OnInitDialog(HWND hwnd, HWND hwndFocus, LPARAM lParam)
    HWND hb = GetDlgItem(hwnd, IDC_SEQ_NUM_OVERRIDE_SPIN);
    SendMessage(hb, UDM_SETRANGE, 0, (LPARAM) MAKELONG(32000, 0));
 
-   if (ui_options.sequence_num_override > 0)
-      SendMessage(hb, UDM_SETPOS, 0, (LPARAM) MAKELONG(ui_options.sequence_num_override, 0));
+   if (current_engine->m_ui_options.sequence_num_override > 0)
+      SendMessage(hb, UDM_SETPOS, 0, (LPARAM) MAKELONG(current_engine->m_ui_options.sequence_num_override, 0));
 
    // Select the default radio buttons.
 
@@ -2112,7 +2112,7 @@ static BOOL Startup_OnInitDialog(HWND hwnd, HWND hwndFocus, LPARAM lParam)
    // If user specified session number on the command line, we must
    // just be looking for a level.  So skip the session part.
 
-   if (ui_options.force_session == -1000000 && !get_first_session_line()) {
+   if (current_engine->m_ui_options.force_session == -1000000 && !get_first_session_line()) {
       char line[MAX_FILENAME_LENGTH];
 
       SetDlgItemText(hwnd, IDC_START_CAPTION, "Choose a session");
@@ -2289,9 +2289,9 @@ bool iofull::init_step(init_callback_state s, int n)
       wndclass.hIcon = NULL;
       wndclass.hCursor = NULL;
       wndclass.hbrBackground =
-         GetStockBrush(ui_options.reverse_video ?
+         GetStockBrush(current_engine->m_ui_options.reverse_video ?
                        BLACK_BRUSH :
-                       (ui_options.no_intensify ? LTGRAY_BRUSH : WHITE_BRUSH));
+                       (current_engine->m_ui_options.no_intensify ? LTGRAY_BRUSH : WHITE_BRUSH));
       wndclass.lpszMenuName = NULL;
       wndclass.lpszClassName = szTranscriptWindowName;
       wndclass.hIconSm = wndclass.hIcon;
@@ -2316,11 +2316,11 @@ bool iofull::init_step(init_callback_state s, int n)
       // If the user specified a specific session, do that session.
       // If we succeed at it, we won't put up the dialog box at all.
 
-      if (ui_options.force_session != -1000000 &&
-          ui_options.force_session != 0 &&
+      if (current_engine->m_ui_options.force_session != -1000000 &&
+          current_engine->m_ui_options.force_session != 0 &&
           !get_first_session_line()) {
          while (get_next_session_line((char *) 0));   // Need to scan the file anyway.
-         session_index = ui_options.force_session;
+         session_index = current_engine->m_ui_options.force_session;
          if (session_index < 0) {
             request_deletion = true;
          }
@@ -2350,7 +2350,7 @@ bool iofull::init_step(init_callback_state s, int n)
       // from command-line arguments, and doesn't need any of the
       // info that the dialog would give.
 
-      if (ui_options.force_session == -1000000) {
+      if (current_engine->m_ui_options.force_session == -1000000) {
          DialogBox(GLOBhInstance, MAKEINTRESOURCE(IDD_START_DIALOG),
                    hwndMain, (DLGPROC) Startup_Dialog_WndProc);
       }
@@ -2404,12 +2404,12 @@ bool iofull::init_step(init_callback_state s, int n)
 
 void iofull::final_initialize()
 {
-   ui_options.use_escapes_for_drawing_people = 2;
+   current_engine->m_ui_options.use_escapes_for_drawing_people = 2;
 
    // Install the pointy triangles.
 
-   if (ui_options.no_graphics < 2)
-      ui_options.direc = "?\020?\021????\036?\037?????";
+   if (current_engine->m_ui_options.no_graphics < 2)
+      current_engine->m_ui_options.direc = "?\020?\021????\036?\037?????";
 
    HANDLE hRes = LoadResource(GLOBhInstance,
                               FindResource(GLOBhInstance,
@@ -2469,8 +2469,8 @@ void iofull::final_initialize()
 
    RGBQUAD glyphtext_fg, glyphtext_bg;
 
-   if (ui_options.reverse_video) {
-      if (ui_options.no_intensify) {
+   if (current_engine->m_ui_options.reverse_video) {
+      if (current_engine->m_ui_options.no_intensify) {
          glyphtext_fg = lpBitsTemp->bmiColors[7];
          plaintext_fg = RGB(192, 192, 192);
          glyphtext_bg = lpBitsTemp->bmiColors[0];
@@ -2484,7 +2484,7 @@ void iofull::final_initialize()
       }
    }
    else {
-      if (ui_options.no_intensify) {
+      if (current_engine->m_ui_options.no_intensify) {
          glyphtext_fg = lpBitsTemp->bmiColors[0];
          plaintext_fg = RGB(0, 0, 0);
          glyphtext_bg = lpBitsTemp->bmiColors[7];
@@ -2498,7 +2498,7 @@ void iofull::final_initialize()
       }
    }
 
-   if (ui_options.color_scheme == no_color) {
+   if (current_engine->m_ui_options.color_scheme == no_color) {
       icon_color_translate[1] = glyphtext_fg;
       icon_color_translate[2] = glyphtext_fg;
       icon_color_translate[3] = glyphtext_fg;
@@ -2570,8 +2570,8 @@ void EnterMessageLoop()
 {
    MSG Msg;
 
-   gg77->matcher_p->m_active_result.valid = false;
-   gg77->matcher_p->erase_matcher_input();
+   current_engine->m_gg77->matcher_p->m_active_result.valid = false;
+   current_engine->m_gg77->matcher_p->erase_matcher_input();
    WaitingForCommand = true;
 
    while (GetMessage(&Msg, NULL, 0, 0) && WaitingForCommand) {
@@ -2752,9 +2752,9 @@ void ShowListBox(int nWhichOne)
          short int *item;
          int menu_length;
 
-         index_list *list_to_use = allowing_all_concepts ?
-            &gg77->matcher_p->m_concept_list :
-            &gg77->matcher_p->m_level_concept_list;
+         index_list *list_to_use = current_engine->m_allowing_all_concepts ?
+            &current_engine->m_gg77->matcher_p->m_concept_list :
+            &current_engine->m_gg77->matcher_p->m_level_concept_list;
          item = list_to_use->the_list;
          menu_length = list_to_use->the_list_size;
 
@@ -2789,7 +2789,7 @@ void iofull::create_menu(call_list_kind cl) {}
 
 uims_reply_thing iofull::get_startup_command()
 {
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
    nLastOne = ui_undefined;
    MenuKind = ui_start_select;
    ShowListBox(matcher_class::e_match_startup_commands);
@@ -2817,17 +2817,17 @@ uims_reply_thing iofull::get_startup_command()
 // This returns ui_user_cancel if it fails, e.g. the user waves the mouse away.
 uims_reply_thing iofull::get_call_command()
 {
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
 
  startover:
-   if (allowing_modifications)
-      parse_state.call_list_to_use = call_list_any;
+   if (current_engine->m_allowing_modifications)
+      current_engine->m_parse_state.call_list_to_use = call_list_any;
 
    SetTitle();
    nLastOne = ui_undefined;    /* Make sure we get a new menu,
                                   in case concept levels were toggled. */
    MenuKind = ui_call_select;
-   ShowListBox(parse_state.call_list_to_use);
+   ShowListBox(current_engine->m_parse_state.call_list_to_use);
    EnterMessageLoop();
 
    int index = matcher.m_final_result.match.index;
@@ -2845,17 +2845,17 @@ uims_reply_thing iofull::get_call_command()
    }
    else {
       // Reject off-level concept accelerator key presses.
-      if (!allowing_all_concepts && matcher.m_final_result.match.kind == ui_concept_select &&
+      if (!current_engine->m_allowing_all_concepts && matcher.m_final_result.match.kind == ui_concept_select &&
           get_concept_level(matcher.m_final_result.match.concept_ptr) > calling_level)
          goto startover;
 
       call_conc_option_state save_stuff = matcher.m_final_result.match.call_conc_options;
-      there_is_a_call = false;
+      current_engine->m_there_is_a_call = false;
       uims_reply_kind my_reply = matcher.m_final_result.match.kind;
       bool retval = deposit_call_tree(&matcher.m_final_result.match, (parse_block *) 0, 2);
       matcher.m_final_result.match.call_conc_options = save_stuff;
-      if (there_is_a_call) {
-         parse_state.topcallflags1 = the_topcallflags;
+      if (current_engine->m_there_is_a_call) {
+         current_engine->m_parse_state.topcallflags1 = current_engine->m_the_topcallflags;
          my_reply = ui_call_select;
       }
 
@@ -2873,7 +2873,7 @@ void iofull::dispose_of_abbreviation(const char *linebuff)
 
 uims_reply_thing iofull::get_resolve_command()
 {
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
    UpdateStatusBar(szResolveWndTitle);
 
    nLastOne = ui_undefined;
@@ -2940,7 +2940,7 @@ static bool do_popup(int nWhichOne)
    ShowWindow(hwndCancelButton, SW_HIDE);
    MenuKind = SavedMenuKind;
    // A value of -1 means that the user hit the "cancel" button.
-   return (gg77->matcher_p->m_final_result.match.index >= 0);
+   return (current_engine->m_gg77->matcher_p->m_final_result.match.index >= 0);
 }
 
 
@@ -2971,11 +2971,11 @@ direction_kind iofull::do_direction_popup(matcher_class &matcher)
 
 int iofull::do_circcer_popup()
 {
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
    uint32 retval = 0;
 
-   if (interactivity == interactivity_verify) {
-      retval = verify_options.circcer;
+   if (current_engine->m_interactivity == interactivity_verify) {
+      retval = current_engine->m_verify_options.circcer;
       if (retval == 0) retval = 1;
    }
    else if (!matcher.m_final_result.valid || (matcher.m_final_result.match.call_conc_options.circcer == 0)) {
@@ -2996,7 +2996,7 @@ int iofull::do_circcer_popup()
 
 int iofull::do_tagger_popup(int tagger_class)
 {
-   matcher_class &matcher = *gg77->matcher_p;
+   matcher_class &matcher = *current_engine->m_gg77->matcher_p;
    match_result saved_match = matcher.m_final_result;
    saved_match.match.call_conc_options.tagger = 0;
 
@@ -3027,7 +3027,7 @@ void iofull::add_new_line(const char the_line[], uint32 drawing_picture)
    CurDisplay->Line[DISPLAY_LINE_LENGTH-1] = 0;
    CurDisplay->in_picture = drawing_picture;
 
-   if ((CurDisplay->in_picture & 1) && ui_options.no_graphics == 0) {
+   if ((CurDisplay->in_picture & 1) && current_engine->m_ui_options.no_graphics == 0) {
       if ((CurDisplay->in_picture & 2)) {
          CurDisplay->Height = BMP_PERSON_SIZE+BMP_PERSON_SPACE;
          CurDisplay->DeltaToNext = (BMP_PERSON_SIZE+BMP_PERSON_SPACE)/2;
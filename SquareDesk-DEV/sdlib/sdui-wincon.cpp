@@ -82,17 +82,17 @@ static const char *my_directions;
 
 void iofull::final_initialize()
 {
-   my_pn1 = ui_options.pn1;
-   my_pn2 = ui_options.pn2;
+   my_pn1 = current_engine->m_ui_options.pn1;
+   my_pn2 = current_engine->m_ui_options.pn2;
 
    // Install the pointy triangles.
 
-   if (ui_options.no_graphics < 2)
-      ui_options.direc = "?\020?\021????\036?\037?????";
+   if (current_engine->m_ui_options.no_graphics < 2)
+      current_engine->m_ui_options.direc = "?\020?\021????\036?\037?????";
 
-   my_directions = ui_options.direc;
+   my_directions = current_engine->m_ui_options.direc;
 
-   if (!sdtty_no_console) ui_options.use_escapes_for_drawing_people = 1;
+   if (!sdtty_no_console) current_engine->m_ui_options.use_escapes_for_drawing_people = 1;
 }
 
 
@@ -271,8 +271,8 @@ extern void ttu_initialize()
    if (using_default_screen_size)
       sdtty_screen_height = globalconsoleInfo.srWindow.Bottom-globalconsoleInfo.srWindow.Top+1;
 
-   if (ui_options.no_intensify) {
-      if (ui_options.reverse_video) {
+   if (current_engine->m_ui_options.no_intensify) {
+      if (current_engine->m_ui_options.reverse_video) {
          text_color = fgGRY;
          color_translate = color_translate_reverse_video_nointen;
       }
@@ -282,7 +282,7 @@ extern void ttu_initialize()
       }
    }
    else {
-      if (ui_options.reverse_video) {
+      if (current_engine->m_ui_options.reverse_video) {
          text_color = fgWHT;
          color_translate = color_translate_reverse_video;
       }
@@ -425,17 +425,17 @@ extern void put_line(const char the_line[])
 
             int randomized_person_color = personidx;
 
-            if (ui_options.color_scheme == color_by_couple_random && ui_options.hide_glyph_numbers) {
+            if (current_engine->m_ui_options.color_scheme == color_by_couple_random && current_engine->m_ui_options.hide_glyph_numbers) {
                randomized_person_color = (color_randomizer[personidx>>1] << 1) | (personidx & 1);
             }
 
             put_char(' ');
 
-            if (ui_options.color_scheme != no_color)
+            if (current_engine->m_ui_options.color_scheme != no_color)
                SetConsoleTextAttribute(consoleStdout,
                                        color_translate[color_index_list[randomized_person_color]]);
 
-            if (ui_options.hide_glyph_numbers)
+            if (current_engine->m_ui_options.hide_glyph_numbers)
                put_char(' ');
             else
                put_char(my_pn1[personidx]);
@@ -445,7 +445,7 @@ extern void put_line(const char the_line[])
 
             // Set back to plain "white".
 
-            if (ui_options.color_scheme != no_color)
+            if (current_engine->m_ui_options.color_scheme != no_color)
                SetConsoleTextAttribute(consoleStdout, text_color);
          }
          else
@@ -227,6 +227,97 @@ public:
 };
 
 
+// A prefix tree of call or concept names, spelled the way the matcher compares them
+// with what the user typed: lower case, hyphens as blanks, and commas and apostrophes
+// left out.  Each node lists the items whose names go through it.  A name stops going
+// down the tree at an escape like "@2", since we can't tell what will be typed there,
+// and the item goes on the "open" list of that node.  Names that start with a wildcard
+// like "<anyone>" hang from typed edges at the root, each of which names another tree
+// of the words that the wildcard can be.
+//
+// This is only a filter.  Everything that can match what the user typed gets found,
+// along with some things that can't.  Items must be added in increasing order.
+//
+// The user's text usually grows (or shrinks) one character at a time, so the trie
+// remembers the path it took for the last text, and starts from the deepest node
+// that the new text shares with it.
+
+class SDLIB_API name_trie {
+public:
+   enum {
+      MAX_DEPTH = 24,        // Names aren't followed any deeper than this.
+      MAX_EDGES = 4,
+      MAX_SPELLING = 8
+   };
+
+   name_trie();
+   ~name_trie();
+
+   void add(Cstring name, int item);
+   void add_after(const name_trie *words, int item);
+   bool accepts(Cstring text) const;
+
+   // When the text ends inside the names below some node, this gives what the matcher
+   // would echo for all of them: the characters they share from there on, spelled the
+   // way the names have them, up to where they differ.  "Space_ok" tells whether any of
+   // them goes on with a blank or hyphen.  Returns false if the trie can't tell, e.g. a
+   // name ends on the way there, or ends or has an escape before they differ, or the
+   // text has characters that the trie folds.  Names that match the text through an
+   // escape or a wildcard aren't covered; the matcher has to look at those itself.
+   bool complete(Cstring text, char *extension, bool *space_ok) const;
+
+   // This goes through the items that might match the text, in increasing order.
+
+   class finder {
+   public:
+      finder(const name_trie & trie, Cstring text);
+      int next();    // Returns -1 when there are no more.
+   private:
+      enum { MAX_LISTS = MAX_DEPTH+MAX_EDGES+2 };
+      const index_list *m_lists[MAX_LISTS];
+      int m_positions[MAX_LISTS];
+      int m_count;
+      int m_last;
+   };
+
+private:
+   struct node {
+      char letter;
+      int first_child;
+      int next_sibling;
+      index_list items;         // Items whose names go through here.
+      index_list open_items;    // Items whose names stop here.
+      // The letter, and the characters that fold to nothing just before it, as the
+      // first name through here spells them, in lower case.  The other names share
+      // "spelling_common" of them, or -1 if we couldn't tell.
+      char spelling[MAX_SPELLING];
+      int spelling_size;
+      int spelling_common;
+      bool name_ends;           // Some name ends here, or goes too deep, rather than at an escape.
+   };
+
+   int walk(Cstring text, const index_list **open_lists, int *open_count) const;
+   int make_child(int parent, char letter);
+   static char fold(char c);
+   static void add_item(index_list & list, int item);
+
+   node *m_nodes;
+   int m_node_count;
+   int m_node_allocation;
+   const name_trie *m_edge_words[MAX_EDGES];
+   index_list m_edge_items[MAX_EDGES];
+   int m_edge_count;
+
+   // The path that walk took last time: the folded characters, and the node after each.
+   mutable char m_path_letters[MAX_DEPTH+1];
+   mutable int m_path_nodes[MAX_DEPTH+1];
+   mutable int m_path_size;
+
+   name_trie(const name_trie &);             // Not copyable.
+   name_trie & operator=(const name_trie &);
+};
+
+
 
 enum color_scheme_type {
    color_by_gender,
@@ -283,6 +374,16 @@ class ui_option_type {
    // deterministic tests on each processor.
    int resolve_test_minutes;
 
+   // How many threads a search ("resolve", "pick random call", etc.) may use once it
+   // gets past the initial exhaustive scans.  Zero means one for each processor; one
+   // means just search in the engine itself.  Searches are never spread over threads
+   // when "resolve_test" is in effect, so that they stay deterministic.
+   int resolve_threads;
+
+   // If true, the title of the resolve menu tells how many attempts per second the
+   // search is making, and how many of the calls it got from its transposition table.
+   bool resolve_statistics;
+
    int singing_call_mode;
 
    // This gets set if a user interface (e.g. sdui-tty/sdui-win) wants escape sequences
@@ -357,12 +458,6 @@ struct pat2_block {
 class SDLIB_API matcher_class {
 public:
 
-   // Must be a power of 2.
-   enum {
-      NUM_NAME_HASH_BUCKETS = 128,
-      BRACKET_HASH = (NUM_NAME_HASH_BUCKETS+1)
-   };
-
    // These negative values to the call menu type, which tells what menu we are to pick from.
    enum {
       e_match_startup_commands = -1,
@@ -384,15 +479,6 @@ public:
                      m_abbrev_table_start((abbrev_block *) 0),
                      m_abbrev_table_resolve((abbrev_block *) 0)
    {
-      // These lists are allocated to size NUM_NAME_HASH_BUCKETS+2.
-      // So they will have two extra items at the end:
-      //   The first is for calls whose names can't be hashed.
-      //   The second is the bucket that any string starting with left bracket hashes to.
-
-      call_hashers = new index_list[NUM_NAME_HASH_BUCKETS+2];
-      conc_hashers = new index_list[NUM_NAME_HASH_BUCKETS+2];
-      conclvl_hashers = new index_list[NUM_NAME_HASH_BUCKETS+2];
-
       ::memset(m_fcn_key_table_normal, 0,
                sizeof(modifier_block *) * (FCN_KEY_TAB_LAST-FCN_KEY_TAB_LOW+1));
       ::memset(m_fcn_key_table_start, 0,
@@ -419,6 +505,10 @@ public:
 
    void record_a_match();
 
+   void record_a_completion(Cstring extension, bool space_ok, int yield_depth);
+
+   bool pattern_tail_is_plain(pat2_block *pat2, uims_reply_kind kind, int yield_depth);
+
    void match_pattern(Cstring pattern);
 
    void match_suffix_2(Cstring user, Cstring pat1, pat2_block *pat2, int patxi);
@@ -489,9 +579,14 @@ public:
    index_list m_concept_list;        // indices of all concepts
    index_list m_level_concept_list;  // indices of concepts valid at current level
 
-   index_list *call_hashers;
-   index_list *conc_hashers;
-   index_list *conclvl_hashers;
+   // The words that "<anyone>", "<atc>", and "<anything>" can stand for.
+   name_trie m_selector_words;
+   name_trie m_tagger_words;
+   name_trie m_anything_words;
+
+   name_trie m_call_trie;            // indices into main_call_lists[call_list_any]
+   name_trie m_concept_trie;         // indices of all concepts
+   name_trie m_level_concept_trie;   // indices of concepts valid at current level
 
    modifier_block *m_fcn_key_table_normal[FCN_KEY_TAB_LAST-FCN_KEY_TAB_LOW+1];
    modifier_block *m_fcn_key_table_start[FCN_KEY_TAB_LAST-FCN_KEY_TAB_LOW+1];
@@ -503,8 +598,117 @@ public:
 };
 
 
-extern SDLIB_API parse_state_type parse_state;                      /* in SDTOP */
-extern SDLIB_API ui_option_type ui_options;                         /* in SDTOP */
+class configuration;       // in sd.h
+struct resolver_state;     // in SDGETOUT
+struct picker_state;       // in SDPICK
+extern void delete_resolver_state(resolver_state *rs);    /* in SDGETOUT */
+extern void delete_picker_state(picker_state *ps);        /* in SDPICK */
+
+
+// Everything that a running instance of the engine changes as it goes: the sequence being
+// written, the parser, the options the user has chosen, the state of a call being executed,
+// and the searches.  Each thread runs the engine in one of these at a time, so several
+// independent engines can run side by side.
+// The call database, the menus, and the session/output files are loaded once and shared.
+//
+// Most of these used to be globals.  They are reached through current_engine, the engine
+// that the calling thread is running; that is a thread-local lookup, so a function that
+// uses several of them gets it once ("engine_context & e = *current_engine;").  Entry
+// points (sdmain, or a UI thread calling into the matcher) bind an engine with
+// engine_context::scope.
+
+class SDLIB_API engine_context {
+ public:
+   engine_context();      // Constructor and destructor are in SDTOP.
+   ~engine_context();
+
+   // The sequence.  "history" is the array of configurations described in sd.h .
+   configuration *m_history;
+   int m_history_allocation;
+   int m_config_history_ptr;
+   int m_whole_sequence_low_lim;
+   int m_text_line_count;
+   int m_written_history_items;
+   int m_written_history_nopic;
+   int m_no_erase_before_this;
+
+   // The parser.
+   parse_block *m_parse_active_list;
+   parse_block *m_parse_inactive_list;
+   parse_state_type m_parse_state;
+   parse_state_type m_saved_parse_state;
+   parse_block *m_saved_command_root;
+   parse_block *m_matcher_parse_mark;   // These two are local to verify_call, but they
+   call_list_kind m_matcher_savecl;     // have to be preserved across the throw.
+   uint32 m_the_topcallflags;
+   bool m_there_is_a_call;
+   call_conc_option_state m_current_options;
+   call_conc_option_state m_verify_options;
+   bool m_verify_used_number;
+   bool m_verify_used_direction;
+   bool m_verify_used_selector;
+   bool m_selector_used;
+   bool m_direction_used;
+   bool m_number_used;
+   bool m_mandatory_call_used;
+   parse_block *m_last_magic_diamond;
+
+   // The user interface, and what the user has asked for.
+   ui_utils *m_gg77;
+   ui_option_type m_ui_options;
+   interactivity_state m_interactivity;
+   int m_allowing_modifications;
+   bool m_allowing_all_concepts;
+   bool m_allowing_minigrand;
+   bool m_allow_bend_home_getout;
+   bool m_using_active_phantoms;
+   bool m_enforce_overcast_warning;
+   bool m_retain_after_error;
+   bool m_testing_fidelity;
+   char m_current_line[MAX_TEXT_LINE_LENGTH];
+
+   // The outcome of the call being executed.
+   error_flag_type m_global_error_flag;
+   uims_reply_thing m_global_reply;
+   char m_error_message1[MAX_ERR_LENGTH];
+   char m_error_message2[MAX_ERR_LENGTH];
+   uint32 m_collision_person1;
+   uint32 m_collision_person2;
+   uint32 m_global_tbonetest;
+   uint32 m_global_livemask;
+   uint32 m_global_selectmask;
+   uint32 m_global_tboneselect;
+   uint32 m_orig_tbonetest;
+
+   // Searching (resolve, pick random call, etc.)
+   command_kind m_search_goal;
+   int m_random_number;
+   int m_hashed_randoms;
+   uint32 m_hashed_count;      // How many numbers have gone into m_hashed_randoms.
+   uint64_t m_random_state;    // If nonzero, this engine has its own random numbers, and
+                               // doesn't use "rand".  See generate_random_number in SDSI.
+   resolver_state *m_resolver;
+   picker_state *m_picker;
+
+   // This makes "e" the engine that the calling thread runs, until the end of the scope.
+   class scope {
+    public:
+      scope(engine_context & e);
+      ~scope();
+    private:
+      engine_context *m_saved;
+   };
+
+ private:
+   engine_context(const engine_context &);             // Not copyable.
+   engine_context & operator=(const engine_context &);
+};
+
+// The engine that the calling thread is running.  Threads that never bind one run
+// "default_engine", which is what Sd and Sdtty use.
+extern SDLIB_API thread_local engine_context *current_engine;       /* in SDTOP */
+extern SDLIB_API engine_context default_engine;                     /* in SDTOP */
+
 
 extern SDLIB_API int *color_index_list;                             /* in SDINIT */
 extern SDLIB_API int color_randomizer[4];                           /* in SDINIT */
@@ -513,13 +717,6 @@ extern SDLIB_API const concept_kind constant_with_concept_diagnose; /* in SDTOP
 extern SDLIB_API const concept_kind constant_with_marker_end_of_list;/* in SDTOP */
 extern SDLIB_API int last_direction_kind;                           /* in SDTOP */
 extern SDLIB_API char database_version[81];                         /* in SDTOP */
-extern SDLIB_API bool testing_fidelity;                             /* in SDTOP */
-extern SDLIB_API bool allowing_minigrand;                           /* in SDTOP */
-extern SDLIB_API bool allow_bend_home_getout;                       /* in SDTOP */
-extern SDLIB_API call_conc_option_state verify_options;             /* in SDTOP */
-extern SDLIB_API bool verify_used_number;                           /* in SDTOP */
-extern SDLIB_API bool verify_used_direction;                        /* in SDTOP */
-extern SDLIB_API bool verify_used_selector;                         /* in SDTOP */
 
 
 struct comment_block {
@@ -578,8 +775,6 @@ extern SDLIB_API abbrev_block *abbrev_table_normal;
 extern SDLIB_API abbrev_block *abbrev_table_start;
 extern SDLIB_API abbrev_block *abbrev_table_resolve;
 
-extern SDLIB_API command_kind search_goal;                          /* in SDPICK */
-
 extern SDLIB_API Cstring menu_names[];                              /* in SDMAIN */
 extern SDLIB_API command_list_menu_item command_menu[];             /* in SDMAIN */
 extern SDLIB_API resolve_list_menu_item resolve_menu[];             /* in SDMAIN */
@@ -600,7 +795,6 @@ extern SDLIB_API char GLOB_decorated_stats_filename[MAX_TEXT_LINE_LENGTH];   //
 
 extern SDLIB_API int session_index;                           // in SDSI
 extern SDLIB_API bool rewrite_with_new_style_filename;        // in SDSI
-extern SDLIB_API int random_number;                           // in SDSI
 extern SDLIB_API const char *database_filename;               // in SDSI
 extern SDLIB_API const char *new_outfile_string;              // in SDSI
 extern SDLIB_API char abridge_filename[MAX_TEXT_LINE_LENGTH]; // in SDSI
@@ -616,11 +810,6 @@ extern SDLIB_API char outfile_prefix[MAX_FILENAME_LENGTH];          /* in SDUTIL
 extern SDLIB_API char header_comment[MAX_TEXT_LINE_LENGTH];         /* in SDUTIL */
 extern SDLIB_API bool creating_new_session;                         /* in SDUTIL */
 
-extern SDLIB_API int text_line_count;                               /* in SDTOP */
-extern SDLIB_API bool there_is_a_call;                              /* in SDTOP */
-extern SDLIB_API int no_erase_before_this;                          /* in SDTOP */
-extern SDLIB_API int written_history_nopic;                         /* in SDTOP */
-extern SDLIB_API uint32 the_topcallflags;                           /* in SDTOP */
 
 /* In SDTOP */
 
@@ -634,6 +823,13 @@ SDLIB_API void create_resolve_menu_title(
    resolver_display_state state,
    char *title);
 
+// For the mkgetouts program.
+SDLIB_API void getout_table_filename(char *dest);
+SDLIB_API void begin_getout_table();
+SDLIB_API bool random_call_from_setup(setup *ss);
+SDLIB_API int add_getouts_from_setup(const setup *ss, int how_many);
+SDLIB_API bool write_getout_table(const char *filename);
+
 
 /* In SDMATCH */
 
@@ -643,7 +839,6 @@ SDLIB_API int delete_matcher_word();
 void matcher_initialize();
 SDLIB_API void matcher_setup_call_menu(call_list_kind cl);
 
-extern SDLIB_API interactivity_state interactivity;                 /* in SDTOP */
 extern SDLIB_API bool enable_file_writing;                          /* in SDTOP */
 extern SDLIB_API Cstring cardinals[NUM_CARDINALS+1];                /* in SDTOP */
 extern SDLIB_API Cstring ordinals[NUM_CARDINALS+1];                 /* in SDTOP */
@@ -753,5 +948,6 @@ extern char *get_errstring();
 
 /* in SDMAIN */
 SDLIB_API int sdmain(int argc, char *argv[], iobase & ggg);
+SDLIB_API int sdmain(int argc, char *argv[], iobase & ggg, engine_context & engine);
 
 #endif   /* SDUI_H */
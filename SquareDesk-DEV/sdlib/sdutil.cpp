@@ -52,6 +52,9 @@
    parse_block::final_cleanup
    copy_parse_tree
    reset_parse_tree
+   hash_parse_tree
+   flatten_parse_tree
+   same_parse_tree
    save_parse_state
    restore_parse_state
    randomize_couple_colors
@@ -63,14 +66,11 @@ and the following external variables:
    GLOB_doing_frequency
    GLOB_stats_filename
    GLOB_decorated_stats_filename
-   global_error_flag
    global_cache_failed_flag
    global_cache_miss_reason
-   global_reply
    clipboard
    clipboard_size
    wrote_a_sequence
-   retain_after_error
    outfile_string
    outfile_prefix
    header_comment
@@ -93,25 +93,21 @@ and the following external variables:
 
 
 // External variables.
-ui_option_type ui_options;
 Cstring cardinals[NUM_CARDINALS+1];
 Cstring ordinals[NUM_CARDINALS+1];
 abridge_mode_t glob_abridge_mode;
 bool GLOB_doing_frequency;
 char GLOB_stats_filename[MAX_TEXT_LINE_LENGTH];
 char GLOB_decorated_stats_filename[MAX_TEXT_LINE_LENGTH];
-error_flag_type global_error_flag;
 bool global_cache_failed_flag;
 // Word 0 is the error code
 //   (Zero if hit, missing index+1 if miss, 9 if couldn't open the cache file.)
 // Word 1 is what we wanted at the index.
 // Word 2 is what we got.
 int global_cache_miss_reason[3];
-uims_reply_thing global_reply(ui_user_cancel, 99);
 configuration *clipboard = (configuration *) 0;
 int clipboard_size = 0;
 bool wrote_a_sequence = false;
-bool retain_after_error = false;
 char outfile_string[MAX_FILENAME_LENGTH] = SEQUENCE_FILENAME;
 char outfile_prefix[MAX_FILENAME_LENGTH] = "";
 char header_comment[MAX_TEXT_LINE_LENGTH];
@@ -394,16 +390,17 @@ void ui_utils::writestuff_with_decorations(const call_conc_option_state *cptr, C
 
 void ui_utils::printperson(uint32 x)
 {
+   engine_context & e = *current_engine;
    if (x & BIT_PERSON) {
-      if (enable_file_writing || ui_options.use_escapes_for_drawing_people == 0) {
+      if (enable_file_writing || e.m_ui_options.use_escapes_for_drawing_people == 0) {
          /* We never write anything other than standard ASCII to the transcript file. */
          writechar(' ');
-         writechar(ui_options.pn1[(x >> 6) & 7]);
-         writechar(ui_options.pn2[(x >> 6) & 7]);
+         writechar(e.m_ui_options.pn1[(x >> 6) & 7]);
+         writechar(e.m_ui_options.pn2[(x >> 6) & 7]);
          if (enable_file_writing)
-            writechar(ui_options.stddirec[x & 017]);
+            writechar(e.m_ui_options.stddirec[x & 017]);
          else
-            writechar(ui_options.direc[x & 017]);
+            writechar(e.m_ui_options.direc[x & 017]);
       }
       else {
          /* Write an escape sequence, so that the user interface can display
@@ -414,7 +411,7 @@ void ui_utils::printperson(uint32 x)
       }
    }
    else {
-      if (enable_file_writing || ui_options.use_escapes_for_drawing_people <= 1)
+      if (enable_file_writing || e.m_ui_options.use_escapes_for_drawing_people <= 1)
          writestuff("  . ");
       else
          writechar('\014');  /* If we have full ("checker") escape sequences, use this. */
@@ -424,6 +421,7 @@ void ui_utils::printperson(uint32 x)
 
 void ui_utils::do_write(Cstring s)
 {
+   engine_context & e = *current_engine;
    char c;
 
    int ri = roti * 011;
@@ -433,9 +431,9 @@ void ui_utils::do_write(Cstring s)
       else if (c == '@') {
          if (*s == '7') {
             s++;
-            ui_options.squeeze_this_newline = 1;
+            e.m_ui_options.squeeze_this_newline = 1;
             newline();
-            ui_options.squeeze_this_newline = 0;
+            e.m_ui_options.squeeze_this_newline = 0;
          }
          else
             newline();
@@ -446,8 +444,8 @@ void ui_utils::do_write(Cstring s)
          // We need to do the mundane translation of "5" and "6" if the result
          // isn't going to be used by something that uses same.
          if (enable_file_writing ||
-             ui_options.use_escapes_for_drawing_people <= 1 ||
-             ui_options.no_graphics != 0) {
+             e.m_ui_options.use_escapes_for_drawing_people <= 1 ||
+             e.m_ui_options.no_graphics != 0) {
             if (c == '6')
                writestuff("    ");    /* space equivalent to 1 full glyph. */
             else if (c == '9')
@@ -505,9 +503,10 @@ void ui_utils::print_4_person_setup(int ps, small_setup *s, int elong)
 
 void ui_utils::printsetup(setup *x)
 {
+   engine_context & e = *current_engine;
    Cstring str;
 
-   ui_options.drawing_picture = 1;
+   e.m_ui_options.drawing_picture = 1;
    printarg = x;
    modulus = attr::slimit(x)+1;
    roti = x->rotation & 3;
@@ -914,34 +913,34 @@ void ui_utils::printsetup(setup *x)
          do_write(str);
          break;
       case s_dead_concentric:
-         ui_options.drawing_picture = 0;
+         e.m_ui_options.drawing_picture = 0;
          writestuff(" centers only:");
          newline();
-         ui_options.drawing_picture = 1;
+         e.m_ui_options.drawing_picture = 1;
          print_4_person_setup(0, &(x->inner), -1);
          break;
       case s_normal_concentric:
-         ui_options.drawing_picture = 0;
+         e.m_ui_options.drawing_picture = 0;
          writestuff(" centers:");
          newline();
-         ui_options.drawing_picture = 1;
+         e.m_ui_options.drawing_picture = 1;
          print_4_person_setup(0, &(x->inner), -1);
-         ui_options.drawing_picture = 0;
+         e.m_ui_options.drawing_picture = 0;
          writestuff(" ends:");
          newline();
-         ui_options.drawing_picture = 1;
+         e.m_ui_options.drawing_picture = 1;
          print_4_person_setup(12, &(x->outer), x->concsetup_outer_elongation);
          break;
       default:
-         ui_options.drawing_picture = 0;
+         e.m_ui_options.drawing_picture = 0;
          writestuff("???? UNKNOWN SETUP ????");
          newline();
-         ui_options.drawing_picture = 1;
+         e.m_ui_options.drawing_picture = 1;
       }
    }
 
    newline();
-   ui_options.drawing_picture = 0;
+   e.m_ui_options.drawing_picture = 0;
    newline();
 }
 
@@ -951,19 +950,20 @@ void ui_utils::write_history_line(int history_index,
                                  bool leave_missing_calls_blank,
                                  file_write_flag write_to_file)
 {
+   engine_context & e = *current_engine;
    m_leave_missing_calls_blank = leave_missing_calls_blank;
 
    int w, i;
    parse_block *thing;
-   configuration *this_item = &configuration::history[history_index];
+   configuration *this_item = &configuration::history()[history_index];
 
-   if (write_to_file == file_write_double && !ui_options.singlespace_mode)
+   if (write_to_file == file_write_double && !e.m_ui_options.singlespace_mode)
       doublespace_file();
 
    // Do not put index numbers into output file -- user may edit it later.
 
-   if (!enable_file_writing && !ui_options.diagnostic_mode) {
-      i = history_index-configuration::whole_sequence_low_lim+1;
+   if (!enable_file_writing && !e.m_ui_options.diagnostic_mode) {
+      i = history_index-configuration::whole_sequence_low_lim()+1;
       if (i > 0) {
          char indexbuf[10];
          sprintf(indexbuf, "%2d:   ", i);
@@ -986,8 +986,8 @@ void ui_utils::write_history_line(int history_index,
    if (history_index == 2 &&
        thing->concept->kind == concept_centers_or_ends &&
        thing->concept->arg1 == selector_centers) {
-      if (configuration::history[1].get_startinfo_specific()->into_the_middle) {
-         writestuff(configuration::history[1].get_startinfo_specific()->name);
+      if (configuration::history()[1].get_startinfo_specific()->into_the_middle) {
+         writestuff(configuration::history()[1].get_startinfo_specific()->name);
          writestuff(" ");
          thing = thing->next;
       }
@@ -1033,7 +1033,7 @@ void ui_utils::write_history_line(int history_index,
    if (this_item->test_one_warning_specific(warn__two_faced))
       this_item->clear_one_warning_specific(warn__unusual_or_2faced);
 
-   if (!ui_options.nowarn_mode) {
+   if (!e.m_ui_options.nowarn_mode) {
       for (w=0 ; w<warn__NUM_WARNINGS ; w++) {
          if (this_item->test_one_warning_specific((warning_index) w)) {
             writestuff("  Warning:  ");
@@ -1051,19 +1051,19 @@ void ui_utils::write_history_line(int history_index,
    // picture.
 
    if (this_item->state_is_valid &&
-       (picture || this_item->draw_pic || ui_options.keep_all_pictures)) {
+       (picture || this_item->draw_pic || e.m_ui_options.keep_all_pictures)) {
       printsetup(&this_item->state);
 
       if (this_item->state.eighth_rotation != 0) {
          writestuff("  Note:  Actual setup is 45 degrees clockwise from diagram above.");
          newline();
-         if (write_to_file == file_write_double && ui_options.singlespace_mode)
+         if (write_to_file == file_write_double && e.m_ui_options.singlespace_mode)
             doublespace_file();
       }
    }
 
    // Record that this history item has been written to the UI.
-   this_item->text_line = text_line_count;
+   this_item->text_line = e.m_text_line_count;
 }
 
 
@@ -2041,11 +2041,9 @@ void ui_utils::print_recurse(parse_block *thing, int print_recurse_arg)
    return;
 }
 
-static char current_line[MAX_TEXT_LINE_LENGTH];
-
 void ui_utils::open_text_line()
 {
-   m_writechar_block.destcurr = current_line;
+   m_writechar_block.destcurr = current_engine->m_current_line;
    m_writechar_block.lastchar = ' ';
    m_writechar_block.lastlastchar = ' ';
    m_writechar_block.lastblank = (char *) 0;
@@ -2053,8 +2051,9 @@ void ui_utils::open_text_line()
 
 void ui_utils::clear_screen()
 {
-   written_history_items = -1;
-   text_line_count = 0;
+   engine_context & e = *current_engine;
+   e.m_written_history_items = -1;
+   e.m_text_line_count = 0;
 
    iob88.reduce_line_count(0);
    open_text_line();
@@ -2062,7 +2061,7 @@ void ui_utils::clear_screen()
 
 void ui_utils::write_header_stuff(bool with_ui_version, uint32 act_phan_flags)
 {
-   if (!ui_options.diagnostic_mode) {
+   if (!current_engine->m_ui_options.diagnostic_mode) {
       // Log creation version info.
       if (with_ui_version) {     // This is the "pretty" form that we display while running.
          writestuff("Sd ");
@@ -2099,20 +2098,21 @@ void ui_utils::write_header_stuff(bool with_ui_version, uint32 act_phan_flags)
 
 void ui_utils::writechar(char src)
 {
+   engine_context & e = *current_engine;
    // Don't write two consecutive commas.
    if (src == ',' && src == m_writechar_block.lastchar) return;
 
    m_writechar_block.lastlastchar = m_writechar_block.lastchar;
 
    *m_writechar_block.destcurr = m_writechar_block.lastchar = src;
-   if (src == ' ' && m_writechar_block.destcurr != current_line)
+   if (src == ' ' && m_writechar_block.destcurr != e.m_current_line)
       m_writechar_block.lastblank = m_writechar_block.destcurr;
 
    // If drawing a picture, don't do automatic line breaks.
 
-   if (m_writechar_block.destcurr < &current_line[ui_options.max_print_length] ||
+   if (m_writechar_block.destcurr < &e.m_current_line[e.m_ui_options.max_print_length] ||
        m_writechar_block.usurping_writechar ||
-       ui_options.drawing_picture)
+       e.m_ui_options.drawing_picture)
       m_writechar_block.destcurr++;
    else {
       // Line overflow.  Try to write everything up to the last
@@ -2125,14 +2125,14 @@ void ui_utils::writechar(char src)
       // If we are after a blank, see if we are after a whole bunch of blanks; delete same.
       // This could happen if the only blanks are the indentation at the start of the line.
       // In that case, strip it all away.
-      while (m_writechar_block.lastblank && m_writechar_block.lastblank > current_line && m_writechar_block.lastblank[-1] == ' ')
+      while (m_writechar_block.lastblank && m_writechar_block.lastblank > e.m_current_line && m_writechar_block.lastblank[-1] == ' ')
          m_writechar_block.lastblank--;
 
       // If there is nonblank text before the last blank, write it out and save
       // whatever comes next for the next round.  But if the only blanks are those
       // at the beginning of the line, treat is as though there weren't any blanks
       // at all--break a word.
-      if (m_writechar_block.lastblank && m_writechar_block.lastblank > current_line) {
+      if (m_writechar_block.lastblank && m_writechar_block.lastblank > e.m_current_line) {
          while (p <= m_writechar_block.destcurr) *q++ = *p++;
          m_writechar_block.destcurr = m_writechar_block.lastblank;
       }
@@ -2151,6 +2151,7 @@ void ui_utils::writechar(char src)
 
 void ui_utils::newline()
 {
+   engine_context & e = *current_engine;
    /* Erase any trailing blanks.  Failure to do so can lead to some
       incredibly obscure bugs when some editors on PC's try to "fix"
       the file, ultimately leading to apparent loss of entire sequences.
@@ -2163,7 +2164,7 @@ void ui_utils::newline()
       is very hard.)  It turns out that some printing software stops,
       as though it reached the end of the file, when it encounters a
       ^Z, so the appended sequences were effectively lost. */
-   while (m_writechar_block.destcurr != current_line && m_writechar_block.destcurr[-1] == ' ')
+   while (m_writechar_block.destcurr != e.m_current_line && m_writechar_block.destcurr[-1] == ' ')
       m_writechar_block.destcurr--;
 
    *m_writechar_block.destcurr = '\0';
@@ -2181,13 +2182,13 @@ void ui_utils::newline()
    // No_graphics != 0 (so we only do it if showing full checkers in Sd).
 
    if (enable_file_writing)
-      write_file(current_line);
+      write_file(e.m_current_line);
 
-   text_line_count++;
-   iob88.add_new_line(current_line,
+   e.m_text_line_count++;
+   iob88.add_new_line(e.m_current_line,
       enable_file_writing ?
                     0 :
-                    (ui_options.drawing_picture | (ui_options.squeeze_this_newline << 1)));
+                    (e.m_ui_options.drawing_picture | (e.m_ui_options.squeeze_this_newline << 1)));
    open_text_line();
 }
 
@@ -2221,9 +2222,6 @@ void ui_utils::show_match_item(int frequency_to_show)
 }
 
 
-parse_block *parse_block::parse_active_list = (parse_block *) 0;
-parse_block *parse_block::parse_inactive_list = (parse_block *) 0;
-
 void parse_block::initialize(const concept_descriptor *cc)
 {
    more_finalherit_flags.clear_all_herit_and_final_bits();
@@ -2242,12 +2240,14 @@ void parse_block::initialize(const concept_descriptor *cc)
 
 void release_parse_blocks_to_mark(parse_block *mark_point)
 {
-   while (parse_block::parse_active_list && parse_block::parse_active_list != mark_point) {
-      parse_block *item = parse_block::parse_active_list;
+   engine_context & e = *current_engine;
+
+   while (e.m_parse_active_list && e.m_parse_active_list != mark_point) {
+      parse_block *item = e.m_parse_active_list;
 
-      parse_block::parse_active_list = item->gc_ptr;
-      item->gc_ptr = parse_block::parse_inactive_list;
-      parse_block::parse_inactive_list = item;
+      e.m_parse_active_list = item->gc_ptr;
+      item->gc_ptr = e.m_parse_inactive_list;
+      e.m_parse_inactive_list = item;
 
       // Clear pointers so we will notice if it gets erroneously re-used.
       item->initialize((concept_descriptor *) 0);
@@ -2257,15 +2257,16 @@ void release_parse_blocks_to_mark(parse_block *mark_point)
 
 void parse_block::final_cleanup()
 {
+   engine_context & e = *current_engine;
    parse_block *item;
 
-   while ((item = parse_active_list)) {
-      parse_active_list = item->gc_ptr;
+   while ((item = e.m_parse_active_list)) {
+      e.m_parse_active_list = item->gc_ptr;
       delete item;
    }
 
-   while ((item = parse_inactive_list)) {
-      parse_inactive_list = item->gc_ptr;
+   while ((item = e.m_parse_inactive_list)) {
+      e.m_parse_inactive_list = item->gc_ptr;
       delete item;
    }
 }
@@ -2302,10 +2303,95 @@ extern parse_block *copy_parse_tree(parse_block *original_tree)
 }
 
 
+// A hash of the same things that copy_parse_tree copies, so that two trees that
+// would copy to the same thing hash the same.
+extern uint64_t hash_parse_tree(const parse_block *tree)
+{
+   uint64_t h = 0;
+
+   for ( ; tree ; tree = tree->next) {
+      h = hash_step(h, (uint64_t) (size_t) tree->concept);
+      h = hash_step(h, (uint64_t) (size_t) tree->call);
+      h = hash_step(h, (uint64_t) (size_t) tree->call_to_print);
+      h = hash_step(h, ((uint64_t) tree->options.who << 32) | (uint32) tree->options.where);
+      h = hash_step(h, ((uint64_t) tree->options.tagger << 32) | tree->options.circcer);
+      h = hash_step(h, ((uint64_t) tree->options.number_fields << 32) | (uint32) tree->options.howmanynumbers);
+      h = hash_step(h, ((uint64_t) (uint32) tree->options.star_turn_option << 32) |
+                    ((uint32) (uint16) tree->replacement_key << 1) | (tree->no_check_call_level ? 1 : 0));
+
+      // Mark where a subsidiary tree begins and ends.
+      if (tree->subsidiary_root)
+         h = hash_step(h, hash_parse_tree(tree->subsidiary_root) + 1);
+      else
+         h = hash_step(h, 0);
+   }
+
+   return h;
+}
+
+
+// Write the tree into "items", a block at a time, with the subsidiary tree of a
+// block right after it.  Each list ends with an end_of_list item.  Returns the
+// number of items, or -1 if they won't fit in "room".
+extern int flatten_parse_tree(const parse_block *tree, parse_tree_item *items, int room)
+{
+   int count = 0;
+
+   for ( ; tree ; tree = tree->next) {
+      if (count >= room) return -1;
+
+      parse_tree_item & item = items[count++];
+      item.kind = tree->subsidiary_root ? parse_tree_item::subsidiary_follows : parse_tree_item::plain_block;
+      item.concept = tree->concept;
+      item.call = tree->call;
+      item.call_to_print = tree->call_to_print;
+      item.options = tree->options;
+      item.replacement_key = tree->replacement_key;
+      item.no_check_call_level = tree->no_check_call_level;
+
+      if (tree->subsidiary_root) {
+         int sub_count = flatten_parse_tree(tree->subsidiary_root, &items[count], room-count);
+         if (sub_count < 0) return -1;
+         count += sub_count;
+      }
+   }
+
+   if (count >= room) return -1;
+   items[count].kind = parse_tree_item::end_of_list;
+   return count+1;
+}
+
+
+// True if two flattened trees would copy to the same thing.
+extern bool same_parse_tree(const parse_tree_item *a, int a_count, const parse_tree_item *b, int b_count)
+{
+   if (a_count != b_count) return false;
+
+   for (int i=0; i<a_count; i++) {
+      if (a[i].kind != b[i].kind) return false;
+      if (a[i].kind == parse_tree_item::end_of_list) continue;
+
+      if (a[i].concept != b[i].concept ||
+          a[i].call != b[i].call ||
+          a[i].call_to_print != b[i].call_to_print ||
+          a[i].options.who != b[i].options.who ||
+          a[i].options.where != b[i].options.where ||
+          a[i].options.tagger != b[i].options.tagger ||
+          a[i].options.circcer != b[i].options.circcer ||
+          a[i].options.number_fields != b[i].options.number_fields ||
+          a[i].options.howmanynumbers != b[i].options.howmanynumbers ||
+          a[i].options.star_turn_option != b[i].options.star_turn_option ||
+          a[i].replacement_key != b[i].replacement_key ||
+          a[i].no_check_call_level != b[i].no_check_call_level)
+         return false;
+   }
+
+   return true;
+}
+
+
 /* Stuff for saving parse state while we resolve. */
 
-static parse_state_type saved_parse_state;
-static parse_block *saved_command_root;
 
 
 // SDLIB_API
@@ -2343,8 +2429,9 @@ extern void reset_parse_tree(parse_block *original_tree, parse_block *final_head
    comprise the parse state. */
 extern void save_parse_state()
 {
-   saved_parse_state = parse_state;
-   saved_command_root = copy_parse_tree(configuration::next_config().command_root);
+   engine_context & e = *current_engine;
+   e.m_saved_parse_state = e.m_parse_state;
+   e.m_saved_command_root = copy_parse_tree(configuration::next_config().command_root);
 }
 
 
@@ -2355,10 +2442,11 @@ extern void save_parse_state()
    locations, so that the pointers in the parse stack will still be valid. */
 extern void restore_parse_state()
 {
-   parse_state = saved_parse_state;
+   engine_context & e = *current_engine;
+   e.m_parse_state = e.m_saved_parse_state;
 
-   if (saved_command_root)
-      reset_parse_tree(saved_command_root, configuration::next_config().command_root);
+   if (e.m_saved_command_root)
+      reset_parse_tree(e.m_saved_command_root, configuration::next_config().command_root);
    else
       configuration::next_config().command_root = 0;
 }
@@ -2406,13 +2494,14 @@ void string_copy(char **dest, Cstring src)
    have pictures. */
 void ui_utils::display_initial_history(int upper_limit, int num_pics)
 {
+   engine_context & e = *current_engine;
    int j, startpoint;
 
    // See if we can re-use some of the safely written history.
    // First, cut down overly optimistic estimates.
-   if (written_history_items > upper_limit) written_history_items = upper_limit;
+   if (e.m_written_history_items > upper_limit) e.m_written_history_items = upper_limit;
    // And normalize the "nopic" number.
-   if (written_history_nopic > written_history_items) written_history_nopic = written_history_items;
+   if (e.m_written_history_nopic > e.m_written_history_items) e.m_written_history_nopic = e.m_written_history_items;
 
    // Check whether pictures are faithful.  If any item in the written history has its
    // "picture forced" property (as determined by written_history_nopic)
@@ -2420,27 +2509,27 @@ void ui_utils::display_initial_history(int upper_limit, int num_pics)
    // and that item didn't have the draw_pic flag on, that item needs to be rewritten.
    // We cut written_history_items down to below that item if such is the case.
 
-   for (j=1; j<=written_history_items; j++) {
-      int t = ((int) ((unsigned int) (written_history_nopic-j)) ^
+   for (j=1; j<=e.m_written_history_items; j++) {
+      int t = ((int) ((unsigned int) (e.m_written_history_nopic-j)) ^
                  ((unsigned int) (upper_limit-num_pics-j)));
-      if (t < 0 && !configuration::history[j].draw_pic) {
-         written_history_items = j-1;
+      if (t < 0 && !configuration::history()[j].draw_pic) {
+         e.m_written_history_items = j-1;
          break;
       }
    }
 
-   if (written_history_items > 0) {
+   if (e.m_written_history_items > 0) {
       // We win.  Back up the text line count to the right place, and rewrite the rest.
 
-      text_line_count = configuration::history[written_history_items].text_line;
-      iob88.reduce_line_count(text_line_count);
+      e.m_text_line_count = configuration::history()[e.m_written_history_items].text_line;
+      iob88.reduce_line_count(e.m_text_line_count);
       open_text_line();
-      startpoint = written_history_items+1;
+      startpoint = e.m_written_history_items+1;
    }
    else {
       // We lose, there is nothing we can use.
-      if (no_erase_before_this != 0)
-         iob88.no_erase_before_n(no_erase_before_this);
+      if (e.m_no_erase_before_this != 0)
+         iob88.no_erase_before_n(e.m_no_erase_before_this);
 
       clear_screen();
       write_header_stuff(true, 0);
@@ -2458,31 +2547,32 @@ void ui_utils::display_initial_history(int upper_limit, int num_pics)
       if (j >= startpoint) write_history_line(j, true, false, file_write_no);
    }
 
-   written_history_items = upper_limit;   // This stuff is now safe.
-   written_history_nopic = written_history_items-num_pics;
-   no_erase_before_this = 0;
+   e.m_written_history_items = upper_limit;   // This stuff is now safe.
+   e.m_written_history_nopic = e.m_written_history_items-num_pics;
+   e.m_no_erase_before_this = 0;
 }
 
 
 
 extern void initialize_parse()
 {
-   parse_state.concept_write_base = &configuration::next_config().command_root;
-   parse_state.concept_write_ptr = parse_state.concept_write_base;
-   *(parse_state.concept_write_ptr) = (parse_block *) 0;
-   parse_state.parse_stack_index = 0;
-   parse_state.base_call_list_to_use = find_proper_call_list(&configuration::current_config().state);
-   parse_state.call_list_to_use = parse_state.base_call_list_to_use;
+   engine_context & e = *current_engine;
+   e.m_parse_state.concept_write_base = &configuration::next_config().command_root;
+   e.m_parse_state.concept_write_ptr = e.m_parse_state.concept_write_base;
+   *(e.m_parse_state.concept_write_ptr) = (parse_block *) 0;
+   e.m_parse_state.parse_stack_index = 0;
+   e.m_parse_state.base_call_list_to_use = find_proper_call_list(&configuration::current_config().state);
+   e.m_parse_state.call_list_to_use = e.m_parse_state.base_call_list_to_use;
    configuration::next_config().init_centersp_specific();
    configuration::init_warnings();
    configuration::next_config().draw_pic = false;
    configuration::next_config().state_is_valid = false;
 
-   if (written_history_items > config_history_ptr)
-      written_history_items = config_history_ptr;
+   if (e.m_written_history_items > e.m_config_history_ptr)
+      e.m_written_history_items = e.m_config_history_ptr;
 
-   parse_state.specialprompt[0] = '\0';
-   parse_state.topcallflags1 = 0;
+   e.m_parse_state.specialprompt[0] = '\0';
+   e.m_parse_state.topcallflags1 = 0;
 }
 
 
@@ -2555,14 +2645,15 @@ namespace {
 // Returns TRUE if it successfully backed up one parse block.
 bool backup_one_item()
 {
+   engine_context & e = *current_engine;
 
    // User wants to undo a call.  The concept parse list is not set up
    // for easy backup, so we search forward from the beginning.
 
-   parse_block **this_ptr = parse_state.concept_write_base;
+   parse_block **this_ptr = e.m_parse_state.concept_write_base;
    if (!this_ptr || !*this_ptr) return false;
 
-   if ((config_history_ptr == 1) && configuration::history[1].get_startinfo_specific()->into_the_middle)
+   if ((e.m_config_history_ptr == 1) && configuration::history()[1].get_startinfo_specific()->into_the_middle)
       this_ptr = &((*this_ptr)->next);
 
    for (;;) {
@@ -2572,13 +2663,13 @@ bool backup_one_item()
       last_ptr = this_ptr;
       this_ptr = &((*this_ptr)->next);
 
-      if (this_ptr == parse_state.concept_write_ptr) {
-         parse_state.concept_write_ptr = last_ptr;
+      if (this_ptr == e.m_parse_state.concept_write_ptr) {
+         e.m_parse_state.concept_write_ptr = last_ptr;
 
          // See whether we need to destroy a frame in the parse stack.
-         if (parse_state.parse_stack_index != 0 &&
-               parse_state.parse_stack[parse_state.parse_stack_index-1].concept_write_save_ptr == last_ptr)
-            parse_state.parse_stack_index--;
+         if (e.m_parse_state.parse_stack_index != 0 &&
+               e.m_parse_state.parse_stack[e.m_parse_state.parse_stack_index-1].concept_write_save_ptr == last_ptr)
+            e.m_parse_state.parse_stack_index--;
 
          *last_ptr = (parse_block *) 0;
          return true;
@@ -2597,6 +2688,7 @@ bool backup_one_item()
 // Returns true if sequence was written.
 bool ui_utils::write_sequence_to_file() THROW_DECL
 {
+   engine_context & e = *current_engine;
    char date[MAX_TEXT_LINE_LENGTH];
    char second_header[MAX_TEXT_LINE_LENGTH];
    char seqstring[20];
@@ -2647,9 +2739,9 @@ bool ui_utils::write_sequence_to_file() THROW_DECL
       newline();
    }
 
-   if (ui_options.singing_call_mode != 0) {
+   if (e.m_ui_options.singing_call_mode != 0) {
       writestuff(
-         (ui_options.singing_call_mode == 2) ?
+         (e.m_ui_options.singing_call_mode == 2) ?
          "             Singing call reverse progression" :
          "             Singing call progression");
       newline();
@@ -2681,13 +2773,13 @@ bool ui_utils::write_sequence_to_file() THROW_DECL
 
    if (sequence_number >= 0) sequence_number++;
 
-   for (j=configuration::whole_sequence_low_lim; j<=config_history_ptr; j++)
+   for (j=configuration::whole_sequence_low_lim(); j<=e.m_config_history_ptr; j++)
       write_history_line(j, false, false, file_write_double);
 
    // Echo the concepts entered so far.
 
-   if (parse_state.concept_write_ptr != &configuration::next_config().command_root) {
-      write_history_line(config_history_ptr+1, false, false, file_write_double);
+   if (e.m_parse_state.concept_write_ptr != &configuration::next_config().command_root) {
+      write_history_line(e.m_config_history_ptr+1, false, false, file_write_double);
    }
 
    if (configuration::sequence_is_resolved())
@@ -3050,12 +3142,13 @@ popup_return ui_utils::do_header_popup(char *dest)
 
 void ui_utils::run_program(iobase & ggg)
 {
-   no_erase_before_this = 0;
-   global_error_flag = (error_flag_type) 0;
-   interactivity = interactivity_normal;
+   engine_context & e = *current_engine;
+   e.m_no_erase_before_this = 0;
+   e.m_global_error_flag = (error_flag_type) 0;
+   e.m_interactivity = interactivity_normal;
    clear_screen();
 
-   if (!ui_options.diagnostic_mode) {
+   if (!e.m_ui_options.diagnostic_mode) {
       writestuff("SD -- square dance caller's helper.");
       newline();
       newline();
@@ -3114,7 +3207,7 @@ void ui_utils::run_program(iobase & ggg)
    }
 
    // If in diagnostic mode, we print a detailed reason for any cache miss.
-   if (ui_options.diagnostic_mode && global_cache_miss_reason[0] != 0) {
+   if (e.m_ui_options.diagnostic_mode && global_cache_miss_reason[0] != 0) {
       char reasonstuff[50];
 
       (void) sprintf(reasonstuff, "Cache miss, reloaded: %d %d %d.",
@@ -3127,7 +3220,7 @@ void ui_utils::run_program(iobase & ggg)
       newline();
    }
 
-   if (ui_options.color_scheme == color_by_couple_random)
+   if (e.m_ui_options.color_scheme == color_by_couple_random)
       randomize_couple_colors();
 
    // If anything in the "try" block throws an exception, we will get here
@@ -3139,39 +3232,39 @@ void ui_utils::run_program(iobase & ggg)
 
    try {
 
-      if (global_error_flag == error_flag_user_wants_to_resolve) {
-         global_error_flag = error_flag_none;
+      if (e.m_global_error_flag == error_flag_user_wants_to_resolve) {
+         e.m_global_error_flag = error_flag_none;
          goto do_a_resolve;
       }
 
-      if (global_error_flag) {
+      if (e.m_global_error_flag) {
          // The call we were trying to do has failed.  Abort it and display the error message.
 
-         if (interactivity == interactivity_database_init ||
-             interactivity == interactivity_verify)
-            ggg.fatal_error_exit(1, "Unknown error context", error_message1);
+         if (e.m_interactivity == interactivity_database_init ||
+             e.m_interactivity == interactivity_verify)
+            ggg.fatal_error_exit(1, "Unknown error context", e.m_error_message1);
 
          // If this is a real call execution error, save the call that caused it.
 
-         if (global_error_flag < error_flag_wrong_command) {
-            configuration::history[0] = configuration::next_config();     // So failing call will get printed.
+         if (e.m_global_error_flag < error_flag_wrong_command) {
+            configuration::history()[0] = configuration::next_config();     // So failing call will get printed.
             // But copy the parse tree, since we are going to clip it.
-            configuration::history[0].command_root = copy_parse_tree(configuration::history[0].command_root);
+            configuration::history()[0].command_root = copy_parse_tree(configuration::history()[0].command_root);
             // But without any warnings we may have collected.
-            configuration::history[0].init_warnings_specific();
+            configuration::history()[0].init_warnings_specific();
          }
-         if (global_error_flag == error_flag_wrong_command) {
+         if (e.m_global_error_flag == error_flag_wrong_command) {
             // Special signal -- user clicked on special thing while trying to get subcall.
-            if ((global_reply.majorpart == ui_command_select) &&
-                ((global_reply.minorpart == command_quit) ||
-                 (global_reply.minorpart == command_undo) ||
-                 (global_reply.minorpart == command_cut_to_clipboard) ||
-                 (global_reply.minorpart == command_delete_entire_clipboard) ||
-                 (global_reply.minorpart == command_delete_one_call_from_clipboard) ||
-                 (global_reply.minorpart == command_paste_one_call) ||
-                 (global_reply.minorpart == command_paste_all_calls) ||
-                 (global_reply.minorpart == command_erase) ||
-                 (global_reply.minorpart == command_abort)))
+            if ((e.m_global_reply.majorpart == ui_command_select) &&
+                ((e.m_global_reply.minorpart == command_quit) ||
+                 (e.m_global_reply.minorpart == command_undo) ||
+                 (e.m_global_reply.minorpart == command_cut_to_clipboard) ||
+                 (e.m_global_reply.minorpart == command_delete_entire_clipboard) ||
+                 (e.m_global_reply.minorpart == command_delete_one_call_from_clipboard) ||
+                 (e.m_global_reply.minorpart == command_paste_one_call) ||
+                 (e.m_global_reply.minorpart == command_paste_all_calls) ||
+                 (e.m_global_reply.minorpart == command_erase) ||
+                 (e.m_global_reply.minorpart == command_abort)))
                m_reply_pending = true;
             goto start_with_pending_reply;
          }
@@ -3182,9 +3275,9 @@ void ui_utils::run_program(iobase & ggg)
          // did not specify "retain_after_error", or if the special "heads into the middle and ..."
          // operation is in place.
 
-         if (!ui_options.diagnostic_mode &&
-             retain_after_error &&
-             ((config_history_ptr != 1) || !configuration::history[1].get_startinfo_specific()->into_the_middle) &&
+         if (!e.m_ui_options.diagnostic_mode &&
+             e.m_retain_after_error &&
+             ((e.m_config_history_ptr != 1) || !configuration::history()[1].get_startinfo_specific()->into_the_middle) &&
              backup_one_item()) {
             m_reply_pending = false;
             // Take out warnings that arose from the failed call,
@@ -3246,53 +3339,53 @@ void ui_utils::run_program(iobase & ggg)
 
       // Query for the starting setup.
 
-      global_reply = ggg.get_startup_command();
+      e.m_global_reply = ggg.get_startup_command();
 
-      if (global_reply.majorpart == ui_command_select && global_reply.minorpart == command_quit) goto normal_exit;
-      if (global_reply.majorpart != ui_start_select) goto normal_exit;           // Huh?
+      if (e.m_global_reply.majorpart == ui_command_select && e.m_global_reply.minorpart == command_quit) goto normal_exit;
+      if (e.m_global_reply.majorpart != ui_start_select) goto normal_exit;           // Huh?
 
-      switch (global_reply.minorpart) {
+      switch (e.m_global_reply.minorpart) {
       case start_select_toggle_conc:
-         allowing_all_concepts = !allowing_all_concepts;
+         e.m_allowing_all_concepts = !e.m_allowing_all_concepts;
          goto new_sequence;
       case start_select_toggle_singlespace:
-         ui_options.singlespace_mode = !ui_options.singlespace_mode;
+         e.m_ui_options.singlespace_mode = !e.m_ui_options.singlespace_mode;
          goto new_sequence;
       case start_select_toggle_minigrand:
-         allowing_minigrand = !allowing_minigrand;
+         e.m_allowing_minigrand = !e.m_allowing_minigrand;
          goto new_sequence;
       case start_select_toggle_bend_home:
-         allow_bend_home_getout = !allow_bend_home_getout;
+         e.m_allow_bend_home_getout = !e.m_allow_bend_home_getout;
          goto new_sequence;
       case start_select_toggle_overflow_warn:
-         enforce_overcast_warning = !enforce_overcast_warning;
+         e.m_enforce_overcast_warning = !e.m_enforce_overcast_warning;
          goto new_sequence;
       case start_select_toggle_act:
-         using_active_phantoms = !using_active_phantoms;
+         e.m_using_active_phantoms = !e.m_using_active_phantoms;
          goto new_sequence;
       case start_select_toggle_retain:
-         retain_after_error = !retain_after_error;
+         e.m_retain_after_error = !e.m_retain_after_error;
          goto new_sequence;
       case start_select_toggle_nowarn_mode:
-         ui_options.nowarn_mode = !ui_options.nowarn_mode;
+         e.m_ui_options.nowarn_mode = !e.m_ui_options.nowarn_mode;
          goto new_sequence;
       case start_select_toggle_keepallpic_mode:
-         ui_options.keep_all_pictures = !ui_options.keep_all_pictures;
+         e.m_ui_options.keep_all_pictures = !e.m_ui_options.keep_all_pictures;
          goto new_sequence;
       case start_select_toggle_singleclick_mode:
-         ui_options.accept_single_click = !ui_options.accept_single_click;
+         e.m_ui_options.accept_single_click = !e.m_ui_options.accept_single_click;
          goto new_sequence;
       case start_select_toggle_singer:
-         if (ui_options.singing_call_mode != 0)
-            ui_options.singing_call_mode = 0;    // Turn it off.
+         if (e.m_ui_options.singing_call_mode != 0)
+            e.m_ui_options.singing_call_mode = 0;    // Turn it off.
          else
-            ui_options.singing_call_mode = 1;    // 1 for forward progression, 2 for backward.
+            e.m_ui_options.singing_call_mode = 1;    // 1 for forward progression, 2 for backward.
          goto new_sequence;
       case start_select_toggle_singer_backward:
-         if (ui_options.singing_call_mode != 0)
-            ui_options.singing_call_mode = 0;    // Turn it off.
+         if (e.m_ui_options.singing_call_mode != 0)
+            e.m_ui_options.singing_call_mode = 0;    // Turn it off.
          else
-            ui_options.singing_call_mode = 2;
+            e.m_ui_options.singing_call_mode = 2;
          goto new_sequence;
       case start_select_select_print_font:
          if (!ggg.choose_font()) {
@@ -3438,17 +3531,17 @@ void ui_utils::run_program(iobase & ggg)
       // start_select_h1p2p ... start_select_as_they_are.  We will put
       // that into the startinfo stuff in the history.
 
-      configuration::initialize_history(global_reply.minorpart);   // Clear the position history.
-      configuration::history[1].init_warnings_specific();
-      configuration::history[1].init_resolve();
+      configuration::initialize_history(e.m_global_reply.minorpart);   // Clear the position history.
+      configuration::history()[1].init_warnings_specific();
+      configuration::history()[1].init_resolve();
       // Put the people into their starting position.
-      configuration::history[1].state = *configuration::history[1].get_startinfo_specific()->the_setup_p;
-      configuration::history[1].state_is_valid = true;
+      configuration::history()[1].state = *configuration::history()[1].get_startinfo_specific()->the_setup_p;
+      configuration::history()[1].state_is_valid = true;
 
-      written_history_items = -1;
-      no_erase_before_this = 1;
+      e.m_written_history_items = -1;
+      e.m_no_erase_before_this = 1;
 
-      global_error_flag = (error_flag_type) 0;
+      e.m_global_error_flag = (error_flag_type) 0;
 
       // Come here to read a bunch of concepts and a call and add an item to the history.
 
@@ -3458,7 +3551,7 @@ void ui_utils::run_program(iobase & ggg)
 
    start_with_pending_reply:
 
-      allowing_modifications = 0;
+      e.m_allowing_modifications = 0;
 
       // See if we need to increase the size of the history array.
       // We must have history_allocation at least equal to history_ptr+2,
@@ -3473,20 +3566,20 @@ void ui_utils::run_program(iobase & ggg)
       // and that is right here.  Note that we are about to call "initialize_parse",
       // which destroys any lingering pointers into the history array.
 
-      if (history_allocation < config_history_ptr+MAX_RESOLVE_SIZE+2) {
-         int new_history_allocation = history_allocation * 2 + 5;
+      if (e.m_history_allocation < e.m_config_history_ptr+MAX_RESOLVE_SIZE+2) {
+         int new_history_allocation = e.m_history_allocation * 2 + 5;
          configuration *new_history = new configuration[new_history_allocation];
-         memcpy(new_history, configuration::history, history_allocation * sizeof(configuration));
-         delete [] configuration::history;
-         history_allocation = new_history_allocation;
-         configuration::history = new_history;
+         memcpy(new_history, configuration::history(), e.m_history_allocation * sizeof(configuration));
+         delete [] configuration::history();
+         e.m_history_allocation = new_history_allocation;
+         configuration::history() = new_history;
       }
 
       initialize_parse();
 
       // Check for first call given to heads or sides only.
 
-      if ((config_history_ptr == 1) && configuration::history[1].get_startinfo_specific()->into_the_middle)
+      if ((e.m_config_history_ptr == 1) && configuration::history()[1].get_startinfo_specific()->into_the_middle)
          deposit_concept(&concept_centers_concept);
 
       // Come here to get a concept or call or whatever from the user.
@@ -3504,7 +3597,7 @@ void ui_utils::run_program(iobase & ggg)
 
          toplevelmove();
          finish_toplevelmove();
-         config_history_ptr++;         // Call successfully completed; save it.
+         e.m_config_history_ptr++;         // Call successfully completed; save it.
          goto start_cycle;
       }
 
@@ -3514,8 +3607,8 @@ void ui_utils::run_program(iobase & ggg)
 
       m_reply_pending = false;
 
-      if (global_reply.majorpart == ui_command_select) {
-         switch ((command_kind) global_reply.minorpart) {
+      if (e.m_global_reply.majorpart == ui_command_select) {
+         switch ((command_kind) e.m_global_reply.minorpart) {
          case command_quit:
             if (ggg.do_abort_popup() != POPUP_ACCEPT)
                goto simple_restart;
@@ -3529,8 +3622,8 @@ void ui_utils::run_program(iobase & ggg)
             while (backup_one_item()) ;   // Repeatedly remove any parse blocks that we have.
             initialize_parse();
 
-            if (config_history_ptr <= 1 ||
-                (config_history_ptr == 2 && configuration::history[1].get_startinfo_specific()->into_the_middle))
+            if (e.m_config_history_ptr <= 1 ||
+                (e.m_config_history_ptr == 2 && configuration::history()[1].get_startinfo_specific()->into_the_middle))
                specialfail("Can't cut past this point.");
 
             if (m_clipboard_allocation <= clipboard_size) {
@@ -3544,9 +3637,9 @@ void ui_utils::run_program(iobase & ggg)
                clipboard = new_clipboard;
             }
 
-            clipboard[clipboard_size++] = configuration::history[config_history_ptr-1];
+            clipboard[clipboard_size++] = configuration::history()[e.m_config_history_ptr-1];
             clipboard[clipboard_size-1].command_root = configuration::current_config().command_root;
-            config_history_ptr--;
+            e.m_config_history_ptr--;
             goto start_cycle;
          case command_delete_entire_clipboard:
             if (clipboard_size != 0) {
@@ -3568,8 +3661,8 @@ void ui_utils::run_program(iobase & ggg)
             while (backup_one_item()) ;   // Repeatedly remove any parse blocks that we have.
             initialize_parse();
 
-            if (config_history_ptr >= 1 &&
-                (config_history_ptr >= 2 || !configuration::history[1].get_startinfo_specific()->into_the_middle)) {
+            if (e.m_config_history_ptr >= 1 &&
+                (e.m_config_history_ptr >= 2 || !configuration::history()[1].get_startinfo_specific()->into_the_middle)) {
                uint32 status = 0;
 
                while (clipboard_size != 0) {
@@ -3595,35 +3688,35 @@ void ui_utils::run_program(iobase & ggg)
 
                doitanyway:
 
-                  interactivity = interactivity_no_query_at_all;
-                  testing_fidelity = true;
+                  e.m_interactivity = interactivity_no_query_at_all;
+                  e.m_testing_fidelity = true;
 
                   // Create a temporary error handler.
 
                   try {
                      toplevelmove();
                      finish_toplevelmove();
-                     config_history_ptr++;
+                     e.m_config_history_ptr++;
                   }
                   catch(error_flag_type) {
                      // The call failed.
-                     interactivity = interactivity_normal;
-                     testing_fidelity = false;
+                     e.m_interactivity = interactivity_normal;
+                     e.m_testing_fidelity = false;
                      reset_parse_tree(saved_root, configuration::next_config().command_root);
                      specialfail("The pasted call has failed.  "
                                  "You can give the command 'delete one call from clipboard' "
                                  "to remove it.");
                   }
 
-                  interactivity = interactivity_normal;
-                  testing_fidelity = false;
+                  e.m_interactivity = interactivity_normal;
+                  e.m_testing_fidelity = false;
                   clipboard_size--;
-                  if ((command_kind) global_reply.minorpart == command_paste_one_call) break;
+                  if ((command_kind) e.m_global_reply.minorpart == command_paste_one_call) break;
                }
 
-               if (status & 4) global_error_flag = error_flag_formation_changed;
-               else if (status & 1) global_error_flag = error_flag_selector_changed;
-               else global_error_flag = (error_flag_type) 0;
+               if (status & 4) e.m_global_error_flag = error_flag_formation_changed;
+               else if (status & 1) e.m_global_error_flag = error_flag_selector_changed;
+               else e.m_global_error_flag = (error_flag_type) 0;
             }
 
             goto start_cycle;
@@ -3632,27 +3725,27 @@ void ui_utils::run_program(iobase & ggg)
                // We succeeded in backing up by one concept.  Continue from that point.
                // But if we backed all the way to the beginning, reset the call menu list.
 
-               if (parse_state.concept_write_base == parse_state.concept_write_ptr &&
-                   parse_state.parse_stack_index == 0)
-                  parse_state.call_list_to_use = parse_state.base_call_list_to_use;
+               if (e.m_parse_state.concept_write_base == e.m_parse_state.concept_write_ptr &&
+                   e.m_parse_state.parse_stack_index == 0)
+                  e.m_parse_state.call_list_to_use = e.m_parse_state.base_call_list_to_use;
 
                m_reply_pending = false;
                goto simple_restart;
             }
-            else if (parse_state.concept_write_base != &configuration::next_config().command_root) {
+            else if (e.m_parse_state.concept_write_base != &configuration::next_config().command_root) {
                // Failed to back up, but some concept exists.  This must have been inside
                // a "checkpoint" or similar complex thing.  Just throw it all away,
                // but do not delete any completed calls.
                m_reply_pending = false;
                goto start_cycle;
             }
-            else if (parse_state.concept_write_base != parse_state.concept_write_ptr) {
+            else if (e.m_parse_state.concept_write_base != e.m_parse_state.concept_write_ptr) {
                // Failed to back up, but some concept exists.
                // Check for just one concept, and that concept is in place
                // only because it is the "centers" concept for a "heads/sides start".
-               if (parse_state.concept_write_base &&
-                   &((*parse_state.concept_write_base)->next) == parse_state.concept_write_ptr &&
-                   config_history_ptr == 1 &&
+               if (e.m_parse_state.concept_write_base &&
+                   &((*e.m_parse_state.concept_write_base)->next) == e.m_parse_state.concept_write_ptr &&
+                   e.m_config_history_ptr == 1 &&
                    configuration::current_config().get_startinfo_specific()->into_the_middle) {
                   // User typed "undo" at the start of the sequence.
                   // Just abort the sequence.  Don't even ask for permission --
@@ -3667,10 +3760,10 @@ void ui_utils::run_program(iobase & ggg)
             }
             else {
                // There were no concepts entered.  Throw away the entire preceding line.
-               if (config_history_ptr > 1) {
+               if (e.m_config_history_ptr > 1) {
                   configuration::current_config().draw_pic = false;
                   configuration::current_config().state_is_valid = false;
-                  config_history_ptr--;
+                  e.m_config_history_ptr--;
                   // Going to start_cycle will make sure written_history_items
                   // does not exceed history_ptr.
                   goto start_cycle;
@@ -3687,46 +3780,46 @@ void ui_utils::run_program(iobase & ggg)
          case command_save_pic:
             configuration::current_config().draw_pic = true;
             // We have to back up to BEFORE the item we just changed.
-            if (written_history_items > config_history_ptr-1)
-               written_history_items = config_history_ptr-1;
+            if (e.m_written_history_items > e.m_config_history_ptr-1)
+               e.m_written_history_items = e.m_config_history_ptr-1;
             goto simple_restart;
 
          case command_freq_show:
             do_freq_show(1000);    // Make sure everything gets shown.
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
          case command_freq_show_sort:
             do_freq_show(0x10000 + 1000);    // Make sure everything gets shown.
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
          case command_freq_show_nearlevel:
             do_freq_show(1);
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
          case command_freq_show_sort_nearlevel:
             do_freq_show(0x10000 + 1);
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
          case command_freq_show_level:
             do_freq_show(0);
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
          case command_freq_show_sort_level:
             do_freq_show(0x10000 + 0);
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
 
          case command_freq_reset:
             do_freq_reset();
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
          case command_freq_start:
             do_freq_start();
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
          case command_freq_delete:
             do_freq_delete();
-            global_error_flag = error_flag_OK_but_dont_erase;
+            e.m_global_error_flag = error_flag_OK_but_dont_erase;
             goto simple_restart;
 
          case command_help:
@@ -3735,7 +3828,7 @@ void ui_utils::run_program(iobase & ggg)
                const char *prefix;
                int current_length;
 
-               switch (parse_state.call_list_to_use) {
+               switch (e.m_parse_state.call_list_to_use) {
                case call_list_lin:
                   prefix = "You are in facing lines."
                      "  Try typing something like 'pass thru' and pressing Enter.";
@@ -3862,12 +3955,12 @@ void ui_utils::run_program(iobase & ggg)
          default:     // Should be some kind of search command.
 
             // If it wasn't, we have a serious problem.
-            if (((command_kind) global_reply.minorpart) < command_resolve) goto normal_exit;
+            if (((command_kind) e.m_global_reply.minorpart) < command_resolve) goto normal_exit;
 
          do_a_resolve:
 
-            search_goal = (command_kind) global_reply.minorpart;
-            global_reply = full_resolve();
+            e.m_search_goal = (command_kind) e.m_global_reply.minorpart;
+            e.m_global_reply = full_resolve();
 
             // If full_resolve refused to operate (for example, we clicked on "reconcile"
             // when in an hourglass), it returned "ui_search_accept", which will cause
@@ -3879,23 +3972,23 @@ void ui_utils::run_program(iobase & ggg)
             // So a search command (e.g. "pick random call") will cause the last
             // search result to be accepted, and begin another search on top of that result.
 
-            if (global_reply.majorpart == ui_command_select) {
-               switch ((command_kind) global_reply.minorpart) {
+            if (e.m_global_reply.majorpart == ui_command_select) {
+               switch ((command_kind) e.m_global_reply.minorpart) {
                case command_quit:
                case command_abort:
                case command_getout:
                   break;
                default:
-                  if (((command_kind) global_reply.minorpart) < command_resolve) goto start_cycle;
+                  if (((command_kind) e.m_global_reply.minorpart) < command_resolve) goto start_cycle;
                   break;
                }
 
-               allowing_modifications = 0;
+               e.m_allowing_modifications = 0;
                configuration::next_config().draw_pic = false;
                configuration::next_config().state_is_valid = false;
-               parse_state.concept_write_base = &configuration::next_config().command_root;
-               parse_state.concept_write_ptr = parse_state.concept_write_base;
-               *parse_state.concept_write_ptr = (parse_block *) 0;
+               e.m_parse_state.concept_write_base = &configuration::next_config().command_root;
+               e.m_parse_state.concept_write_ptr = e.m_parse_state.concept_write_base;
+               *e.m_parse_state.concept_write_ptr = (parse_block *) 0;
                m_reply_pending = true;
                // Going to start_with_pending_reply will make sure
                // written_history_items does not exceed history_ptr.
@@ -3909,7 +4002,7 @@ void ui_utils::run_program(iobase & ggg)
       goto normal_exit;
    }
    catch(error_flag_type sss) {
-      global_error_flag = sss;
+      e.m_global_error_flag = sss;
       goto got_an_exception;
    }
 
@@ -0,0 +1,490 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "audiofilewriter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <math.h>
+
+// ------------------------------------------------------------------
+namespace {
+
+// FLAC frame header CRC-8 (polynomial x^8 + x^2 + x + 1), and frame CRC-16
+//   (polynomial x^16 + x^15 + x^2 + 1), both MSB first, starting at zero
+struct CrcTables
+{
+    uint8_t crc8[256];
+    uint16_t crc16[256];
+
+    CrcTables()
+    {
+        for (int i = 0; i < 256; i++) {
+            uint8_t c8 = static_cast<uint8_t>(i);
+            uint16_t c16 = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; bit++) {
+                c8 = static_cast<uint8_t>((c8 & 0x80) ? (c8 << 1) ^ 0x07 : (c8 << 1));
+                c16 = static_cast<uint16_t>((c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : (c16 << 1));
+            }
+            crc8[i] = c8;
+            crc16[i] = c16;
+        }
+    }
+};
+
+const CrcTables &crcTables()
+{
+    static const CrcTables tables;
+    return tables;
+}
+
+uint8_t crc8(const uint8_t *data, size_t length)
+{
+    const CrcTables &t = crcTables();
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc = t.crc8[crc ^ data[i]];
+    }
+    return crc;
+}
+
+uint16_t crc16(const uint8_t *data, size_t length)
+{
+    const CrcTables &t = crcTables();
+    uint16_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc = static_cast<uint16_t>((crc << 8) ^ t.crc16[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+void putLE(std::vector<uint8_t> &out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+} // namespace
+
+// ------------------------------------------------------------------
+AudioFileWriter::AudioFileWriter() :
+    file(nullptr),
+    sampleRate(44100),
+    channels(2),
+    framesWritten(0)
+{
+}
+
+AudioFileWriter::~AudioFileWriter()
+{
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+AudioFileWriter *AudioFileWriter::create(const std::string &path)
+{
+    std::string extension = path.substr(path.find_last_of('.') == std::string::npos ? path.size() : path.find_last_of('.'));
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".flac") {
+        return new FlacWriter();
+    }
+    return new WavWriter();
+}
+
+int16_t AudioFileWriter::toInt16(float sample)
+{
+    long value = lrintf(sample * 32768.0f);
+    return static_cast<int16_t>(value < -32768 ? -32768 : (value > 32767 ? 32767 : value));
+}
+
+// ==================================================================
+WavWriter::WavWriter()
+{
+}
+
+WavWriter::~WavWriter()
+{
+    close();
+}
+
+bool WavWriter::open(const std::string &path, int rate, int chans)
+{
+    sampleRate = rate;
+    channels = chans;
+    framesWritten = 0;
+    file = fopen(path.c_str(), "wb");
+    return (file != nullptr && writeHeader(0));
+}
+
+bool WavWriter::writeHeader(uint32_t dataBytes)
+{
+    std::vector<uint8_t> header;
+    header.insert(header.end(), {'R', 'I', 'F', 'F'});
+    putLE(header, 36 + dataBytes, 4);
+    header.insert(header.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    putLE(header, 16, 4);                                             // fmt chunk size
+    putLE(header, 1, 2);                                              // PCM
+    putLE(header, static_cast<uint32_t>(channels), 2);
+    putLE(header, static_cast<uint32_t>(sampleRate), 4);
+    putLE(header, static_cast<uint32_t>(sampleRate * channels * 2), 4);  // bytes per second
+    putLE(header, static_cast<uint32_t>(channels * 2), 2);            // bytes per frame
+    putLE(header, 16, 2);                                             // bits per sample
+    header.insert(header.end(), {'d', 'a', 't', 'a'});
+    putLE(header, dataBytes, 4);
+
+    return (fseek(file, 0, SEEK_SET) == 0 &&
+            fwrite(header.data(), 1, header.size(), file) == header.size());
+}
+
+bool WavWriter::write(const float *interleaved, int frames)
+{
+    if (file == nullptr) {
+        return false;
+    }
+    size_t count = static_cast<size_t>(frames * channels);
+    pcm.resize(2 * count);
+    for (size_t i = 0; i < count; i++) {
+        uint16_t s = static_cast<uint16_t>(toInt16(interleaved[i]));
+        pcm[2 * i] = static_cast<uint8_t>(s);  // little endian, whatever the host is
+        pcm[2 * i + 1] = static_cast<uint8_t>(s >> 8);
+    }
+    framesWritten += static_cast<uint64_t>(frames);
+    return (fwrite(pcm.data(), 1, pcm.size(), file) == pcm.size());
+}
+
+bool WavWriter::close()
+{
+    if (file == nullptr) {
+        return false;
+    }
+    uint64_t dataBytes = framesWritten * static_cast<uint64_t>(channels) * 2;
+    bool ok = writeHeader(static_cast<uint32_t>(std::min<uint64_t>(dataBytes, 0xffffffffu - 36)));
+    ok = (fclose(file) == 0) && ok;
+    file = nullptr;
+    return ok;
+}
+
+// ==================================================================
+void FlacWriter::BitWriter::put(uint32_t value, int n)
+{
+    if (n == 0) {
+        return;
+    }
+    acc = (acc << n) | (value & ((1ull << n) - 1));
+    count += n;
+    while (count >= 8) {
+        count -= 8;
+        bytes.push_back(static_cast<uint8_t>(acc >> count));
+    }
+}
+
+void FlacWriter::BitWriter::putSigned(int32_t value, int n)
+{
+    put(static_cast<uint32_t>(value), n);  // two's complement, truncated to n bits
+}
+
+// unary quotient (that many 0s, then a 1), then the low k bits
+void FlacWriter::BitWriter::putRice(uint32_t folded, int k)
+{
+    uint32_t q = folded >> k;
+    while (q >= 31) {
+        put(0, 31);
+        q -= 31;
+    }
+    put(1, static_cast<int>(q) + 1);
+    put(folded, k);
+}
+
+void FlacWriter::BitWriter::alignToByte()
+{
+    if (count > 0) {
+        put(0, 8 - count);
+    }
+}
+
+// ------------------------------------------------------------------
+FlacWriter::FlacWriter() :
+    blockFrames(0),
+    frameNumber(0),
+    minFrameBytes(0),
+    maxFrameBytes(0)
+{
+}
+
+FlacWriter::~FlacWriter()
+{
+    close();
+}
+
+bool FlacWriter::open(const std::string &path, int rate, int chans)
+{
+    if (chans < 1 || chans > 8 || rate <= 0 || rate >= (1 << 20)) {
+        return false;  // not representable in FLAC
+    }
+    sampleRate = rate;
+    channels = chans;
+    framesWritten = 0;
+    blockFrames = 0;
+    frameNumber = 0;
+    minFrameBytes = maxFrameBytes = 0;
+    block.assign(static_cast<size_t>(kBlockSize * channels), 0);
+    folded.resize(kBlockSize);
+
+    file = fopen(path.c_str(), "wb");
+    return (file != nullptr &&
+            fwrite("fLaC", 1, 4, file) == 4 &&
+            writeStreamInfo());  // again by close(), with the real total
+}
+
+bool FlacWriter::writeStreamInfo()
+{
+    bits.clear();
+    bits.put(1, 1);    // last metadata block
+    bits.put(0, 7);    // STREAMINFO
+    bits.put(34, 24);  // length
+    bits.put(kBlockSize, 16);
+    bits.put(kBlockSize, 16);
+    bits.put(minFrameBytes, 24);
+    bits.put(maxFrameBytes, 24);
+    bits.put(static_cast<uint32_t>(sampleRate), 20);
+    bits.put(static_cast<uint32_t>(channels - 1), 3);
+    bits.put(16 - 1, 5);
+    bits.put(static_cast<uint32_t>(framesWritten >> 32), 4);  // total samples (per channel), 36 bits
+    bits.put(static_cast<uint32_t>(framesWritten), 32);
+    for (int i = 0; i < 4; i++) {
+        bits.put(0, 32);  // MD5 of the audio: not computed
+    }
+
+    return (fseek(file, 4, SEEK_SET) == 0 &&
+            fwrite(bits.bytes.data(), 1, bits.bytes.size(), file) == bits.bytes.size() &&
+            fseek(file, 0, SEEK_END) == 0);
+}
+
+bool FlacWriter::write(const float *interleaved, int frames)
+{
+    if (file == nullptr) {
+        return false;
+    }
+    for (int f = 0; f < frames; f++) {
+        for (int c = 0; c < channels; c++) {
+            block[static_cast<size_t>(c * kBlockSize + blockFrames)] = toInt16(interleaved[f * channels + c]);
+        }
+        if (++blockFrames == kBlockSize && !encodeFrame(kBlockSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FlacWriter::close()
+{
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = (blockFrames == 0 || encodeFrame(blockFrames));
+    ok = writeStreamInfo() && ok;
+    ok = (fclose(file) == 0) && ok;
+    file = nullptr;
+    return ok;
+}
+
+// ------------------------------------------------------------------
+bool FlacWriter::encodeFrame(int frames)
+{
+    bits.clear();
+
+    // header
+    bits.put(0x3ffe, 14);                          // sync code
+    bits.put(0, 1);                                // reserved
+    bits.put(0, 1);                                // fixed blocksize stream
+    bits.put(frames == kBlockSize ? 12 : 7, 4);    // 4096, or "16 bit blocksize-1 at the end of the header"
+    bits.put(0, 4);                                // sample rate: see STREAMINFO
+    bits.put(static_cast<uint32_t>(channels - 1), 4);  // independent channels
+    bits.put(4, 3);                                // 16 bits per sample
+    bits.put(0, 1);                                // reserved
+
+    // frame number, UTF-8 style
+    if (frameNumber < 0x80) {
+        bits.put(frameNumber, 8);
+    } else {
+        int extra = 1;
+        while (extra < 6 && (frameNumber >> (5 * extra + 6)) != 0) {
+            extra++;
+        }
+        bits.put((1u << (extra + 1)) - 1, extra + 1);      // extra+1 1s...
+        bits.put(0, 1);                                    // ...a 0...
+        bits.put(frameNumber >> (6 * extra), 6 - extra);   // ...and the top bits
+        for (int i = extra - 1; i >= 0; i--) {
+            bits.put(0x80 | ((frameNumber >> (6 * i)) & 0x3f), 8);
+        }
+    }
+    if (frames != kBlockSize) {
+        bits.put(static_cast<uint32_t>(frames - 1), 16);
+    }
+    bits.put(crc8(bits.bytes.data(), bits.bytes.size()), 8);
+
+    for (int c = 0; c < channels; c++) {
+        encodeSubframe(&block[static_cast<size_t>(c * kBlockSize)], frames);
+    }
+
+    bits.alignToByte();
+    bits.put(crc16(bits.bytes.data(), bits.bytes.size()), 16);
+
+    uint32_t size = static_cast<uint32_t>(bits.bytes.size());
+    minFrameBytes = (minFrameBytes == 0 ? size : std::min(minFrameBytes, size));
+    maxFrameBytes = std::max(maxFrameBytes, size);
+
+    framesWritten += static_cast<uint64_t>(frames);
+    frameNumber++;
+    blockFrames = 0;
+    return (fwrite(bits.bytes.data(), 1, size, file) == size);
+}
+
+void FlacWriter::encodeSubframe(const int32_t *x, int frames)
+{
+    // digital silence (and other constant runs) is just one sample
+    if (std::all_of(x + 1, x + frames, [x](int32_t s) { return s == x[0]; })) {
+        bits.put(0, 1);
+        bits.put(0, 6);  // CONSTANT
+        bits.put(0, 1);  // no wasted bits
+        bits.putSigned(x[0], 16);
+        return;
+    }
+
+    // pick the fixed predictor with the smallest total residual
+    const int maxOrder = std::min(4, frames - 1);
+    uint64_t total[5] = {0, 0, 0, 0, 0};
+    for (int i = maxOrder; i < frames; i++) {
+        int32_t e0 = x[i];
+        int32_t e1 = e0 - x[i - 1];
+        total[0] += static_cast<uint64_t>(abs(e0));
+        total[1] += static_cast<uint64_t>(abs(e1));
+        if (maxOrder >= 2) {
+            int32_t e2 = e1 - (x[i - 1] - x[i - 2]);
+            total[2] += static_cast<uint64_t>(abs(e2));
+            if (maxOrder >= 3) {
+                int32_t e3 = e2 - (x[i - 1] - 2 * x[i - 2] + x[i - 3]);
+                total[3] += static_cast<uint64_t>(abs(e3));
+                if (maxOrder >= 4) {
+                    total[4] += static_cast<uint64_t>(abs(e3 - (x[i - 1] - 3 * x[i - 2] + 3 * x[i - 3] - x[i - 4])));
+                }
+            }
+        }
+    }
+    int order = 0;
+    for (int o = 1; o <= maxOrder; o++) {
+        if (total[o] < total[order]) {
+            order = o;
+        }
+    }
+
+    for (int i = order; i < frames; i++) {
+        int32_t e;
+        switch (order) {
+            case 0:  e = x[i]; break;
+            case 1:  e = x[i] - x[i - 1]; break;
+            case 2:  e = x[i] - 2 * x[i - 1] + x[i - 2]; break;
+            case 3:  e = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3]; break;
+            default: e = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4]; break;
+        }
+        folded[static_cast<size_t>(i - order)] = (static_cast<uint32_t>(e) << 1) ^ static_cast<uint32_t>(e >> 31);  // zigzag
+    }
+
+    // pick the Rice partition order (the partitions split the block evenly, and the first one
+    //   is shorter by the warmup samples)
+    int bestPartitionOrder = 0;
+    int bestBits = -1;
+    for (int p = 0; p <= 8; p++) {
+        int partitionSize = frames >> p;
+        if ((frames & ((1 << p) - 1)) != 0 || partitionSize <= order) {
+            break;
+        }
+        int total_bits = 0;
+        int start = 0;
+        for (int part = 0; part < (1 << p); part++) {
+            int count = (part == 0 ? partitionSize - order : partitionSize);
+            int k;
+            total_bits += 4 + residualBits(&folded[static_cast<size_t>(start)], count, &k);
+            start += count;
+        }
+        if (bestBits < 0 || total_bits < bestBits) {
+            bestBits = total_bits;
+            bestPartitionOrder = p;
+        }
+    }
+
+    if (bestBits + 6 + 16 * order >= 16 * frames) {
+        // noise: VERBATIM is smaller
+        bits.put(0, 1);
+        bits.put(1, 6);
+        bits.put(0, 1);
+        for (int i = 0; i < frames; i++) {
+            bits.putSigned(x[i], 16);
+        }
+        return;
+    }
+
+    bits.put(0, 1);
+    bits.put(static_cast<uint32_t>(8 | order), 6);  // FIXED, order 0-4
+    bits.put(0, 1);
+    for (int i = 0; i < order; i++) {
+        bits.putSigned(x[i], 16);  // warmup
+    }
+    bits.put(0, 2);  // Rice coding, 4 bit parameters
+    bits.put(static_cast<uint32_t>(bestPartitionOrder), 4);
+    int partitionSize = frames >> bestPartitionOrder;
+    int start = 0;
+    for (int part = 0; part < (1 << bestPartitionOrder); part++) {
+        int count = (part == 0 ? partitionSize - order : partitionSize);
+        int k;
+        residualBits(&folded[static_cast<size_t>(start)], count, &k);
+        bits.put(static_cast<uint32_t>(k), 4);
+        for (int i = start; i < start + count; i++) {
+            bits.putRice(folded[static_cast<size_t>(i)], k);
+        }
+        start += count;
+    }
+}
+
+// estimated size of count zigzagged residuals, with the best Rice parameter (returned in *k)
+int FlacWriter::residualBits(const uint32_t *u, int count, int *k)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += u[i];
+    }
+    uint64_t best = ~0ull;
+    *k = 0;
+    for (int candidate = 0; candidate <= 14; candidate++) {  // 15 is the escape code
+        uint64_t estimate = static_cast<uint64_t>(count) * static_cast<uint64_t>(candidate + 1) + (sum >> candidate);
+        if (estimate < best) {
+            best = estimate;
+            *k = candidate;
+        }
+    }
+    return static_cast<int>(best);
+}
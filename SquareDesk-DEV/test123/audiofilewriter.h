@@ -0,0 +1,131 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef AUDIOFILEWRITER_H_INCLUDED
+#define AUDIOFILEWRITER_H_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Writes interleaved float audio (e.g. from a BASS decode channel) to a 16-bit file.
+//
+// Samples are rounded to 16 bits and clipped (the StreamDSP limiter keeps them below full scale
+//   anyway).  The header is written by open(), and the sizes in it are filled in by close().
+//
+// Plain C++ (no Qt, no BASS), like StreamDSP.
+class AudioFileWriter
+{
+public:
+    virtual ~AudioFileWriter();
+
+    // picks the format from the file extension (".flac", otherwise WAV); the caller deletes it
+    static AudioFileWriter *create(const std::string &path);
+
+    virtual bool open(const std::string &path, int sampleRate, int channels) = 0;
+    virtual bool write(const float *interleaved, int frames) = 0;
+    virtual bool close() = 0;
+
+protected:
+    AudioFileWriter();
+
+    static int16_t toInt16(float sample);
+
+    FILE *file;
+    int sampleRate;
+    int channels;
+    uint64_t framesWritten;
+};
+
+// ------------------------------------------------------------------
+// RIFF/WAVE, PCM
+class WavWriter : public AudioFileWriter
+{
+public:
+    WavWriter();
+    ~WavWriter();
+
+    bool open(const std::string &path, int sampleRate, int channels);
+    bool write(const float *interleaved, int frames);
+    bool close();
+
+private:
+    bool writeHeader(uint32_t dataBytes);
+
+    std::vector<uint8_t> pcm;
+};
+
+// ------------------------------------------------------------------
+// FLAC, lossless, about half the size of the WAV.
+//
+// A deliberately small encoder: fixed blocksize, each channel coded by itself (no mid/side), the
+//   best of the fixed polynomial predictors (order 0-4) per subframe, and partitioned Rice coding
+//   of the residual.  That gets most of the compression of "flac -2", and easily runs faster than
+//   the decoding and tempo/pitch processing in front of it.  The MD5 in STREAMINFO is left as
+//   zero ("not computed"), which decoders accept.
+class FlacWriter : public AudioFileWriter
+{
+public:
+    static const int kBlockSize = 4096;
+
+    FlacWriter();
+    ~FlacWriter();
+
+    bool open(const std::string &path, int sampleRate, int channels);
+    bool write(const float *interleaved, int frames);
+    bool close();
+
+private:
+    class BitWriter
+    {
+    public:
+        BitWriter() : acc(0), count(0) {}
+        void clear() { bytes.clear(); acc = 0; count = 0; }
+        void put(uint32_t value, int bits);   // bits <= 32
+        void putSigned(int32_t value, int bits);
+        void putRice(uint32_t folded, int k);
+        void alignToByte();
+        std::vector<uint8_t> bytes;
+    private:
+        uint64_t acc;
+        int count;
+    };
+
+    bool writeStreamInfo();
+    bool encodeFrame(int frames);
+    void encodeSubframe(const int32_t *samples, int frames);
+    int  residualBits(const uint32_t *folded, int count, int *k);
+
+    std::vector<int32_t> block;     // kBlockSize frames, one channel after the other (not interleaved)
+    int blockFrames;
+    uint32_t frameNumber;
+    uint32_t minFrameBytes, maxFrameBytes;
+
+    BitWriter bits;
+    std::vector<uint32_t> folded;   // scratch: the zigzagged residual of one subframe
+};
+
+#endif /* ifndef AUDIOFILEWRITER_H_INCLUDED */
@@ -25,70 +25,72 @@
 
 #include "bass_audio.h"
 #include "bass_fx.h"
+#include "streamdsp.h"
 #include <math.h>
 #include <stdio.h>
+#include <vector>
 #include <QDebug>
 //#include <QElapsedTimer>
-#include <QTimer>
-
-// GLOBALS =========
-float  gStream_Pan = 0.0;
-bool gStream_Mono = false;
-HDSP gMono_dsp = 0;  // DSP handle (u32)
+#include <QDateTime>
+#include <QtConcurrent>
 
 // ========================================================================
-// Mix/Pan, then optionally mix down to mono
+// All per-sample processing for the music stream is done here: ducking and fades (GainEnvelope),
+//   then pan/mono, EQ and the limiter in one pass (StreamDSP), and then the result is metered for
+//   the VU meter.  BASS calls this on its mixing thread, so no locks and no allocation in here.
 // http://bass.radio42.com/help/html/b8b8a713-7af4-465e-a612-1acd769d4639.htm
-// http://www.delphipraxis.net/141676-bass-dll-stereo-zu-mono-2.html
-// also see the dsptest.c example (e.g. echo)
-void CALLBACK DSP_Mono(HDSP handle, DWORD channel, void *buffer, DWORD length, void *user)
+void CALLBACK bass_audio::StreamDSPProc(HDSP handle, DWORD channel, void *buffer, DWORD length, void *user)
 {
-    Q_UNUSED(user)
-    Q_UNUSED(channel)
     Q_UNUSED(handle)
 
-    // NOTE: uses globals: gStream_Mono (true|false) and gStream_Pan (-1.0 = all L, 1.0 = all R)
-
+    bass_audio *audio = static_cast<bass_audio *>(user);
+    int channels = audio->streamDSP.channelCount();
+    int frames = static_cast<int>(length / (sizeof(float) * channels));
     float *d = static_cast<float *>(buffer);
-    DWORD a;
-    float outL, outR;
-    float inL,inR;
-    float mono;
-
-    const float PI_OVER_2 = 3.14159265f/2.0f;
-    float theta = PI_OVER_2 * (gStream_Pan + 1.0f)/2.0f;  // convert to 0-PI/2
-    float KL = cos(theta);
-    float KR = sin(theta);
-
-    if (gStream_Mono) {
-        // FORCE MONO mode
-        for (a=0; a<length/4; a+=2)
-        {
-            inL = d[a];
-            inR = d[a+1];
-            outL = KL * inL;
-            outR = KR * inR;             // constant power pan
-            mono = (outL + outR)/2.0f;  // mix down to mono for BOTH output channels
-            d[a] = d[a+1] = mono;
-        }
 
-    } else {
-        // NORMAL STEREO mode
-        for (a=0; a<length/4; a+=2)
-        {
-            inL = d[a];
-            inR = d[a+1];
-            outL = KL * inL;
-            outR = KR * inR;  // constant power pan
-            d[a] = outL;
-            d[a+1] = outR;
-        }
+    int framesAfterFade = audio->envelope.process(d, frames, channels);
+    if (framesAfterFade >= 0) {
+        // remember exactly where the fade ended, so that the pause (which the UI thread does, later)
+        //   can go back there, however late it is
+        QWORD decoded = BASS_ChannelGetPosition(channel, BASS_POS_BYTE | BASS_POS_DECODE);
+        QWORD after = BASS_ChannelSeconds2Bytes(channel, framesAfterFade / static_cast<double>(audio->streamSampleRate));
+        audio->fadeEndPosition = static_cast<long long>(decoded > after ? decoded - after : 0);
     }
+    audio->streamDSP.process(d, frames);
+    audio->meterFeed.publish(d, frames, channels, audio->streamSampleRate);
 }
 
+// the last song, while it fades out under the new one.  It keeps its own copy of the pan/mono,
+//   EQ and limiter settings, so it sounds the same right up to the end of the fade (but it isn't
+//   metered, since the VU meter belongs to the new song now).
+void CALLBACK bass_audio::OutgoingDSPProc(HDSP handle, DWORD channel, void *buffer, DWORD length, void *user)
+{
+    Q_UNUSED(handle)
+    Q_UNUSED(channel)
+
+    bass_audio *audio = static_cast<bass_audio *>(user);
+    int channels = audio->outgoingDSP.channelCount();
+    int frames = static_cast<int>(length / (sizeof(float) * channels));
+    float *d = static_cast<float *>(buffer);
+
+    audio->outgoingEnvelope.process(d, frames, channels);
+    audio->outgoingDSP.process(d, frames);
+}
+
+static const float kDuckAttack_sec = 0.05f;
+static const float kDuckRelease_sec = 0.25f;
+static const float kFadeOut_sec = 6.0f;
+
+// The ducks and fades are done to the music as it's decoded, which is this far ahead of what's
+//   being heard.  BASS's default (500 ms) would make a duck start half a second after its sound
+//   effect does, so keep it short.  The update period has to be well under the buffer length.
+static const DWORD kPlaybackBuffer_ms = 150;
+static const DWORD kUpdatePeriod_ms = 25;
+
 // ------------------------------------------------------------------
 bass_audio::bass_audio(void)
 {
+    outputDevice = kDefaultDevice;
     Stream = (HSTREAM)NULL;
     FXStream = (HSTREAM)NULL;  // also initialize the FX stream
 
@@ -100,7 +102,6 @@ bass_audio::bass_audio(void)
 //    Stream_Pan = 0.0;
 //    Stream_Mono = false; // true, if FORCE MONO mode
 
-    fxEQ = 0;            // equalizer handle
     Stream_Eq[0] = 50.0;  // current EQ (3 bands), 0 = Bass, 1 = Mid, 2 = Treble
     Stream_Eq[1] = 50.0;
     Stream_Eq[2] = 50.0;
@@ -111,26 +112,45 @@ bass_audio::bass_audio(void)
 
     loopFromPoint_sec = -1.0;
     loopToPoint_sec = -1.0;
-    startPoint_bytes = 0;
-    endPoint_bytes = 0;
+
+    streamSampleRate = 44100.0f;
 
     currentSoundEffectID = 0;    // no soundFX playing now
+    streamDSPHandle = 0;
+    outgoingStream = 0;
+    outgoingFreeAt_ms = 0;
+    fadeInNextPlay_sec = 0.0;
+    pauseAt_ms = 0;
+    fadeEndPosition = -1;
+
 
-    syncHandle = 0;  // means "no handle"
+    standbyStream = 0;
+    standbyGeneration = 0;
 }
 
 // ------------------------------------------------------------------
 bass_audio::~bass_audio(void)
 {
+    CancelPrefetch();
 }
 
 // ------------------------------------------------------------------
-void bass_audio::Init(void)
+void bass_audio::Init(int device)
 {
     //-------------------------------------------------------------
-    if (!BASS_Init(-1, 44100, 0, NULL, NULL)) {   // the "default" device
-        qDebug() << "ERROR " << BASS_ErrorGetCode() << " in bass_audio::Init(-1)";
+    if (qEnvironmentVariableIsSet("SQUAREDESK_NO_SOUND")) {
+        device = kNoSoundDevice;
     }
+    BASS_SetConfig(BASS_CONFIG_UPDATEPERIOD, kUpdatePeriod_ms);
+    BASS_SetConfig(BASS_CONFIG_BUFFER, kPlaybackBuffer_ms);  // for all of the streams made from now on
+    if (!BASS_Init(device, 44100, 0, NULL, NULL)) {
+        qDebug() << "ERROR " << BASS_ErrorGetCode() << " in bass_audio::Init(" << device << ")";
+        if (device != kNoSoundDevice && BASS_Init(kNoSoundDevice, 44100, 0, NULL, NULL)) {
+            qDebug() << "    no output device, so continuing without sound";
+            device = kNoSoundDevice;
+        }
+    }
+    outputDevice = device;
     BASS_SetConfig(BASS_CONFIG_GVOL_STREAM, Stream_Volume * 100);
     //-------------------------------------------------------------
 }
@@ -138,9 +158,18 @@ void bass_audio::Init(void)
 // ------------------------------------------------------------------
 void bass_audio::Exit(void)
 {
+    CancelPrefetch();
+    soundFXCache.clear();
     BASS_Free();
 }
 
+// ------------------------------------------------------------------
+void bass_audio::SetPreloadMode(SongPreloader::Mode mode, qint64 budget_bytes)
+{
+    songPreloader.setMode(mode);
+    songPreloader.setBudget(budget_bytes);
+}
+
 // ------------------------------------------------------------------
 void bass_audio::SetVolume(int inVolume)
 {
@@ -168,7 +197,7 @@ void bass_audio::SetPitch(int newPitch)
 // ------------------------------------------------------------------
 void bass_audio::SetPan(double newPan)
 {
-    gStream_Pan = static_cast<float>(newPan);
+    streamDSP.setPan(static_cast<float>(newPan));
 //    BASS_ChannelSetAttribute(Stream, BASS_ATTRIB_PAN, newPan);  // Panning/Mixing now done in MONO routine
 }
 
@@ -178,105 +207,134 @@ void bass_audio::SetEq(int band, double val)
 {
     Stream_Eq[band] = val;
 
-    BASS_BFX_PEAKEQ eq;
-    eq.lBand = band;    // get all values of the selected band
-    BASS_FXGetParameters(fxEQ, &eq);
-
-    eq.fGain = static_cast<float>(val);     // modify just the level of the selected band, and set all
-    BASS_FXSetParameters(fxEQ, &eq);
+    streamDSP.setEqGain(band, static_cast<float>(val));
 }
 
-// *******************
-// http://bass.radio42.com/help/html/ee197eac-8482-1f9a-e0e1-8ec9e4feda9b.htm
-void CALLBACK MyFadeIsDoneProc(HSYNC handle, DWORD channel, DWORD data, void *user)
+// ------------------------------------------------------------------
+// Decodes the whole file exactly once, and returns the detected BPM, where the music
+//   actually starts and ends (i.e. after/before the leading/trailing silence), the
+//   length, and the RMS loudness of the non-silent part.  If asked for, also returns the
+//   peak and RMS envelopes (one value per 100ms block, 0.0 - 1.0).
+// Uses decode-only channels (no output device needed), so it is safe to call from any
+//   thread (see SongAnalyzer).  Returns false, if the file could not be opened.
+bool bass_audio::AnalyzeSong(const char *filepath, double *pBPM, double *pSongStart_sec, double *pSongEnd_sec,
+                             double *pSongLength_sec, double *pLoudness_dB,
+                             std::vector<float> *pPeakEnvelope, std::vector<float> *pRMSEnvelope,
+                             WaveformOverview *pWaveform)
 {
-    Q_UNUSED(handle)
-    Q_UNUSED(data)
-    Q_UNUSED(user)
-//    qDebug() << "FADE IS DONE.";
-    DWORD Stream_State = BASS_ChannelIsActive(channel);
-    if (Stream_State == BASS_ACTIVE_PLAYING) {
-//        qDebug() << "     Pausing playback";
-        // if active, PAUSE the stream
-        BASS_ChannelPause(channel);
-
-        static_cast<bass_audio*>(user)->StreamGetPosition();
-        static_cast<bass_audio*>(user)->bPaused = true;
+    *pBPM = 0.0;
+    *pSongStart_sec = 0.0;
+    *pSongEnd_sec = 0.0;
+    *pSongLength_sec = 0.0;
+    *pLoudness_dB = -96.0;
+
+    HSTREAM chan = BASS_StreamCreateFile(FALSE, filepath, 0, 0, BASS_STREAM_DECODE|BASS_SAMPLE_FLOAT|BASS_STREAM_PRESCAN);
+    if (!chan) {
+        qDebug() << "ERROR " << BASS_ErrorGetCode() << " in bass_audio::AnalyzeSong()";
+        return false;
     }
-}
 
-void bass_audio::songStartDetector(const char *filepath, double  *pSongStart, double  *pSongEnd) {
-    // returns start of non-silence in seconds, max 20 seconds
+    double length_sec = BASS_ChannelBytes2Seconds(chan, BASS_ChannelGetLength(chan, BASS_POS_BYTE));
 
-    int peak = 0;
-    int sampleNum = 0;
+    // BPM DETECTION -------------------------------------------
+    // look at a segment from T=10 to T=30sec (for very short songs, look at the whole song)
+    // NOTE: averaging from multiple places in the song doesn't work well.  It's not any more
+    //   reliable than looking at a section early in the song (which is reliable 98% of the time).
+    double startSec1 = 0.0;
+    double endSec1 = length_sec;
+    if (length_sec > 30.0) {
+        startSec1 = 10.0;
+        endSec1 = 30.0;
+    }
 
-    int *levels = (int *)malloc((int)(FileLength * 10 + 10) * sizeof(int));  // allocate on the heap
-    BASS_Init(0 /* "NO SOUND" device */, 44100, 0, 0, NULL);
+    unsigned int MINBPM = 100;
+    unsigned int MAXBPM = 150;
 
-    HSTREAM chan = BASS_StreamCreateFile(FALSE, filepath, 0, 0, BASS_STREAM_DECODE);
-    if ( chan )
-    {
-        double  block = 20;  // take a 20ms level sample every 20ms
-
-        // BASS_ChannelGetLevel takes 20ms from the channel
-        QWORD len = BASS_ChannelSeconds2Bytes(chan, block/1000.0 - 0.02);  // always takes a 0.02s level sample
-
-        //char data[len];  // data sink
-        char *data = new char[len];
-        DWORD level, left, right;
-
-        int j = 0;
-        int sum = 0;
-        while ( (-1 != (int)(level = BASS_ChannelGetLevel(chan))) && (true || sampleNum < 200) ) // takes 20ms sample every 100ms for 20 sec
-        {
-            left=LOWORD(level); // the left level
-            right=HIWORD(level); // the right level
-            unsigned int avg = (left+right)/2;
-            if (j++ < 4) {
-                sum += avg;
-            } else {
-                levels[sampleNum] = sum/5;  // sum the 20ms contributions every 100ms, result is 100ms samples of energy
-                if (true || sampleNum < 80) {
-//                    printf("%d: %d\n", sampleNum, sum/5);
-                }
-                sampleNum++;
-                peak = (peak < sum/5 ? sum/5 : peak);  // this finds the peak of the 100ms samples
-                sum = 0;
-                j = 0;
-            }
-            BASS_ChannelGetData(chan, data, len); // get data away from the channel
+    float bpmValue1 = BASS_FX_BPM_DecodeGet(chan,
+                                            startSec1, endSec1,
+                                            MAKELONG(MINBPM, MAXBPM),  // min/max BPM
+                                            0,                         // do NOT free the source, we still need it
+                                            nullptr, nullptr);
+    BASS_FX_BPM_Free(chan);
+
+    // SILENCE AND LOUDNESS -----------------------------------
+    // rewind, and take peak/RMS levels of every 100ms block of the whole song
+    BASS_ChannelSetPosition(chan, 0, BASS_POS_BYTE);
+
+    DWORD blockBytes = static_cast<DWORD>(BASS_ChannelSeconds2Bytes(chan, 0.1));
+    std::vector<float> buffer(blockBytes/sizeof(float) + 1);
+    std::vector<float> peaks;  // one per 100ms block, 0.0 - 1.0
+    std::vector<float> rms;
+    peaks.reserve(static_cast<size_t>(length_sec * 10 + 10));
+    rms.reserve(static_cast<size_t>(length_sec * 10 + 10));
+    WaveformOverview waveform;  // min/max/RMS of the same blocks
+
+    DWORD got;
+    while ((got = BASS_ChannelGetData(chan, buffer.data(), blockBytes | BASS_DATA_FLOAT)) != static_cast<DWORD>(-1) && got > 0) {
+        size_t n = got/sizeof(float);
+        float peak = 0.0f;
+        double sumSquares = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            float s = fabsf(buffer[i]);
+            peak = (s > peak ? s : peak);
+            sumSquares += static_cast<double>(buffer[i]) * buffer[i];
         }
-        BASS_StreamFree( chan );
+        peaks.push_back(peak);
+        rms.push_back(static_cast<float>(sqrt(sumSquares/n)));
+        waveform.appendBlock(buffer.data(), static_cast<int>(n));
     }
-
-    BASS_Free();
-
-    // find START of song
-    int k;
-    for (k = 0; k < 200; k++) {
-        if (levels[k] > 2500) {
+    BASS_StreamFree(chan);
+    waveform.finish();
+
+    // find START of song (within the first 20 seconds)
+    //   NOTE: this uses the exact peaks, not the waveform overview's, which are rounded to 1/127
+    const float kStartThreshold = 2500.0f/32768.0f;  // same thresholds that the old BASS_ChannelGetLevel version used
+    const float kEndThreshold = 1000.0f/32768.0f;
+    size_t startBlock;
+    for (startBlock = 0; startBlock < peaks.size() && startBlock < 200; startBlock++) {
+        if (peaks[startBlock] > kStartThreshold) {
             break;  // we've found where the silence ends
         }
     }
-    double startOfSong_sec = k/10.0;
-//    printf("Song start (sec): %f\n", startOfSong_sec);
+    if (startBlock >= peaks.size() || startBlock >= 200) {
+        startBlock = 0;  // no clear start, so don't trim anything
+    }
 
     // find END of song
-    for (k = sampleNum-1; k > 0; k--) {
-        if (levels[k] > 1000) {
+    size_t endBlock;
+    for (endBlock = peaks.size(); endBlock > startBlock; endBlock--) {
+        if (peaks[endBlock-1] > kEndThreshold) {
             break;  // we've found where the silence starts at the end of the song
         }
     }
-    double endOfSong_sec = k/10.0;
-//    printf("Song end (sec): %f\n", endOfSong_sec);
-    fflush(stdout);
 
-    free(levels);  // a tidy heap is a happy heap
+    double sumSquares = 0.0;
+    for (size_t k = startBlock; k < endBlock; k++) {
+        sumSquares += static_cast<double>(rms[k]) * rms[k];
+    }
+    if (endBlock > startBlock && sumSquares > 0.0) {
+        *pLoudness_dB = 10.0 * log10(sumSquares/(endBlock - startBlock));
+    }
+
+    *pBPM = (bpmValue1 > 0.0f ? static_cast<double>(bpmValue1) : 0.0);  // BPM not detectable, if <= 0
+    *pSongStart_sec = startBlock/10.0;
+    *pSongEnd_sec = (endBlock > startBlock ? endBlock/10.0 : length_sec);
+    if (*pSongEnd_sec > length_sec) {
+        *pSongEnd_sec = length_sec;
+    }
+    *pSongLength_sec = length_sec;
 
-    // return values:
-    *pSongStart = startOfSong_sec;
-    *pSongEnd = endOfSong_sec;
+    if (pPeakEnvelope) {
+        pPeakEnvelope->swap(peaks);
+    }
+    if (pRMSEnvelope) {
+        pRMSEnvelope->swap(rms);
+    }
+    if (pWaveform) {
+        *pWaveform = waveform;
+    }
+
+    return true;
 }
 
 // ------------------------------------------------------------------
@@ -287,10 +345,11 @@ void bass_audio::StreamCreate(const char *filepath, double  *pSongStart_sec, dou
     BASS_StreamFree(Stream);
 
     // OPEN THE STREAM FOR PLAYBACK ------------------------
-    Stream = BASS_StreamCreateFile(false, filepath, 0, 0,BASS_SAMPLE_FLOAT|BASS_STREAM_DECODE);
-    Stream = BASS_FX_TempoCreate(Stream, BASS_FX_FREESOURCE);
-    BASS_ChannelSetAttribute(Stream, BASS_ATTRIB_VOL, 100.0f/100.0f);
-    BASS_ChannelSetAttribute(Stream, BASS_ATTRIB_TEMPO, 0.0f);
+    Stream = TakeStandbyStream(filepath);  // already opened by PrefetchStream()?
+    if (Stream == 0) {
+        Stream = OpenStream(filepath, false);
+    }
+    loopEngine.attach(Stream, filepath);
     StreamGetLength(); // sets FileLength
 
     // finds song start and end points ------------
@@ -308,94 +367,144 @@ void bass_audio::StreamCreate(const char *filepath, double  *pSongStart_sec, dou
 //    qDebug() << "t3: " << t3.elapsed();
     // ------------------------------
 
-    BASS_BFX_PEAKEQ eq;
+    bPaused = true;
 
-    // set peaking equalizer effect with no bands
-    fxEQ = BASS_ChannelSetFX(Stream, BASS_FX_BFX_PEAKEQ, 0);
+    ClearLoop();
 
-    float fGain = 0.0f;
-    float fBandwidth = 2.5f;
-    float fQ = 0.0f;
-    float fCenter_Bass = 125.0f;
-    float fCenter_Mid = 1000.0f;
-    float fCenter_Treble = 8000.0f;
+    // BPM is NOT detected here anymore (that took 10-30 seconds of decoding on the UI thread).
+    //   It comes from the songs table, or from a SongAnalyzer job that runs in the background.
+    Stream_BPM = 0.0;
 
-    eq.fGain = fGain;
-    eq.fQ = fQ;
-    eq.fBandwidth = fBandwidth;
-    eq.lChannel = BASS_BFX_CHANALL;
+    // ALWAYS do channel processing (pan/mono, EQ, ducking, limiter)
+    BASS_CHANNELINFO info;
+    if (BASS_ChannelGetInfo(Stream, &info)) {
+        streamSampleRate = static_cast<float>(info.freq);
+        streamDSP.setSampleRate(streamSampleRate);
+        streamDSP.setChannels(static_cast<int>(info.chans));
+    }
+    streamDSP.setGain(1.0f, 0.0f);
+    streamDSP.reset();  // new song, so forget the old filter history
+    envelope.reset(streamSampleRate);
+    pauseAt_ms = 0;
+    fadeEndPosition = -1;
+    meterFeed.flush();
+    streamDSPHandle = BASS_ChannelSetDSP(Stream, &StreamDSPProc, this, 1);
+}
 
-    // create 1st band for bass
-    eq.lBand = 0;
-    eq.fCenter = fCenter_Bass;
-    BASS_FXSetParameters(fxEQ, &eq);
+// ------------------------------------------------------------------
+// Opens the file as a (paused) tempo stream.  If prime is true, the first few seconds are
+//   decoded and thrown away first, so that the start of the file is already read (which is the
+//   slow part on a USB stick or a network share) and the decoder is warmed up.
+HSTREAM bass_audio::OpenStream(const char *filepath, bool prime)
+{
+    // PRESCAN, so that seeking (and so looping) is exact, even in VBR files
+    //   (and from memory, if it's on slow media)
+    HSTREAM decodeStream = songPreloader.createStream(filepath, BASS_SAMPLE_FLOAT|BASS_STREAM_DECODE|BASS_STREAM_PRESCAN);
+    if (decodeStream == 0) {
+        qDebug() << "ERROR " << BASS_ErrorGetCode() << " opening " << filepath;
+        return 0;
+    }
 
-    // create 2nd band for mid
-    eq.lBand = 1;
-    eq.fCenter = fCenter_Mid;
-    BASS_FXSetParameters(fxEQ, &eq);
+    if (prime) {
+        const double kPrimeSeconds = 5.0;
+        std::vector<float> scratch(16384);
+        QWORD bytesToPrime = BASS_ChannelSeconds2Bytes(decodeStream, kPrimeSeconds);
+        QWORD bytesPrimed = 0;
+        while (bytesPrimed < bytesToPrime) {
+            DWORD got = BASS_ChannelGetData(decodeStream, scratch.data(),
+                                            static_cast<DWORD>(scratch.size() * sizeof(float)) | BASS_DATA_FLOAT);
+            if (got == static_cast<DWORD>(-1) || got == 0) {
+                break;  // short file, or error
+            }
+            bytesPrimed += got;
+        }
+        BASS_ChannelSetPosition(decodeStream, 0, BASS_POS_BYTE);
+    }
 
-    // create 3rd band for treble
-    eq.lBand=2;
-    eq.fCenter=fCenter_Treble;
-    BASS_FXSetParameters(fxEQ, &eq);
+    HSTREAM stream = BASS_FX_TempoCreate(decodeStream, BASS_FX_FREESOURCE);
+    BASS_ChannelSetAttribute(stream, BASS_ATTRIB_VOL, 100.0f/100.0f);
+    BASS_ChannelSetAttribute(stream, BASS_ATTRIB_TEMPO, 0.0f);
+    return(stream);
+}
 
-    bPaused = true;
+// ------------------------------------------------------------------
+void bass_audio::PrefetchStream(const char *filepath)
+{
+    unsigned int generation;
+    std::string path(filepath);
+    {
+        QMutexLocker locker(&standbyMutex);
+        if (path == standbyPath) {
+            return;  // already have it (or are getting it)
+        }
+        BASS_StreamFree(standbyStream);
+        standbyStream = 0;
+        standbyPath = path;
+        generation = ++standbyGeneration;
+    }
 
-    ClearLoop();
+    standbyFuture = QtConcurrent::run([this, path, generation] {
+        HSTREAM stream = OpenStream(path.c_str(), true);
+
+        QMutexLocker locker(&standbyMutex);
+        if (generation != standbyGeneration) {
+            BASS_StreamFree(stream);  // superseded by a later PrefetchStream() or CancelPrefetch()
+            return;
+        }
+        standbyStream = stream;
+    });
 
-    // OPEN THE STREAM FOR BPM DETECTION -------------------------------------------
-    double startSec1, endSec1;
+    // the earlier ones may still be opening their files, and CancelPrefetch() has to wait for
+    //   those too, before BASS (or this object) goes away
+    for (int i = prefetchFutures.size() - 1; i >= 0; i--) {
+        if (prefetchFutures.at(i).isFinished()) {
+            prefetchFutures.removeAt(i);
+        }
+    }
+    prefetchFutures.append(standbyFuture);
+}
 
-    // look at a segment from T=10 to T=30sec
-    if (FileLength > 30.0) {
-        startSec1 = 10.0;
-        endSec1 = 30.0;
+// ------------------------------------------------------------------
+void bass_audio::CancelPrefetch()
+{
+    {
+        QMutexLocker locker(&standbyMutex);
+        BASS_StreamFree(standbyStream);
+        standbyStream = 0;
+        standbyPath.clear();
+        ++standbyGeneration;
+    }
+    for (int i = 0; i < prefetchFutures.size(); i++) {
+        prefetchFutures[i].waitForFinished();
     }
-    else {
-        // for very short songs, look at the whole song
-        startSec1 = 0.0;
-        endSec1 = FileLength;
+    prefetchFutures.clear();
+}
+
+// ------------------------------------------------------------------
+// Returns the standby stream if it is for this file (and forgets it), otherwise frees it and
+//   returns 0.  If the prefetch for this file is still running, waits for it, because that is
+//   never slower than starting over.
+HSTREAM bass_audio::TakeStandbyStream(const char *filepath)
+{
+    {
+        QMutexLocker locker(&standbyMutex);
+        if (standbyPath != filepath) {
+            BASS_StreamFree(standbyStream);
+            standbyStream = 0;
+            standbyPath.clear();
+            ++standbyGeneration;
+            return 0;
+        }
     }
 
-    unsigned int MINBPM = 100;
-    unsigned int MAXBPM = 150;
+    standbyFuture.waitForFinished();
 
-    HSTREAM bpmChan;
-
-    double bpmValue1 = 0;
-    bpmChan = BASS_StreamCreateFile(FALSE, filepath, 0, 0, BASS_STREAM_DECODE);
-    // detect bpm in background and return progress in GetBPM_ProgressCallback function
-    if (bpmChan) {
-        bpmValue1 = BASS_FX_BPM_DecodeGet(bpmChan,
-                                          startSec1, endSec1,
-                                          MAKELONG(MINBPM, MAXBPM),  // min/max BPM
-                                          BASS_FX_FREESOURCE, // free handle when done
-                                          0,0);
-//        printf("DETECTED BPM = %5.2f\n", bpmValue1);
-//        fflush(stdout);
-    }
-    else {
-        bpmValue1 = 0.0;  // BPM not detectable
-        printf("ERROR: BASS_StreamCreateFile()\n");
-        fflush(stdout);
-    }
-    // free decode bpm stream and resources
-    BASS_FX_BPM_Free(bpmChan);
-
-    // ----------------------------------------------------------------
-    // Now, make a decision as to whether we really know the BPM or not
-    // NOTE: averaging from multiple places in the song doesn't work well.  It takes a while
-    //   to stream midway into the song, and it's not any more reliable than looking at a section
-    //   early in the song (which is quick, and reliable 98% of the time).
-    Stream_BPM = bpmValue1;  // save original detected BPM
-
-    // ALWAYS do channel processing
-    gMono_dsp = BASS_ChannelSetDSP(Stream, &DSP_Mono, 0, 1);
-
-    // when the fade is done, call a SYNCPROC that pauses playback
-    DWORD handle = BASS_ChannelSetSync(Stream, BASS_SYNC_SLIDE, 0, MyFadeIsDoneProc, this);
-    Q_UNUSED(handle)
+    QMutexLocker locker(&standbyMutex);
+    HSTREAM stream = standbyStream;
+    standbyStream = 0;
+    standbyPath.clear();
+    ++standbyGeneration;
+    return(stream);
 }
 
 // ------------------------------------------------------------------
@@ -408,6 +517,7 @@ bool bass_audio::isPaused(void)
 void bass_audio::StreamSetPosition(double Position_sec)
 {
     BASS_ChannelSetPosition(Stream, BASS_ChannelSeconds2Bytes(Stream, Position_sec), BASS_POS_BYTE);
+    meterFeed.flush();  // the playback buffer starts over
 //    Current_Position = Position_sec; // ??
 }
 
@@ -423,6 +533,8 @@ void bass_audio::StreamGetPosition(void)
 {
     QWORD Position = BASS_ChannelGetPosition(Stream, BASS_POS_BYTE);
     Current_Position = BASS_ChannelBytes2Seconds(Stream, Position);
+
+    ServiceFades();  // (this is called regularly by the UI)
 }
 
 // always asks the engine what the state is (NOT CACHED), then returns one of:
@@ -433,83 +545,61 @@ uint32_t bass_audio::currentStreamState() {
 }
 
 // ------------------------------------------------------------------
-int bass_audio::StreamGetVuMeter(void)
+bool bass_audio::StreamReadMeter(MeterBlock *levels)
 {
-    uint32_t Stream_State = currentStreamState();
-
-    if (Stream_State == BASS_ACTIVE_PLAYING) {
-        int level;          // can return -1 for error
-        DWORD left, right;
-        level = BASS_ChannelGetLevel(Stream);
-        if (level != -1) {
-            left = LOWORD(level);   // the left level
-            right = HIWORD(level);  // the right level
-            return (left+right)/2;
-        }
-        else {
-            // error in getting level
-            return 0;
-        }
-    }
-    else {
-        return 0;
-    }
-}
-
-// *******************
-// http://bass.radio42.com/help/html/ee197eac-8482-1f9a-e0e1-8ec9e4feda9b.htm
-void CALLBACK MySyncProc(HSYNC handle, DWORD channel, DWORD data, void *user)
-{
-    Q_UNUSED(data)
-    Q_UNUSED(handle)
-    QWORD endPoint_bytes = *(static_cast<QWORD *>(user));
-    if (endPoint_bytes > 0) {
-        BASS_ChannelSetPosition(channel, endPoint_bytes, BASS_POS_BYTE);
-    }
+    return(meterFeed.read(levels));  // never blocks, and never calls into BASS
 }
 
 // ------------------------------------------------------------------
-void bass_audio::SetLoop(double fromPoint_sec, double toPoint_sec)
+// The jump itself is done by the LoopEngine, on the decoder (so it's sample accurate, and
+//   doesn't care about the tempo/pitch), with a short crossfade.  If we know the BPM, the
+//   "from" point is nudged so that the beats line up across the jump.  Returns the "from" point
+//   that is actually used, so that the caller can show it.
+double bass_audio::SetLoop(double fromPoint_sec, double toPoint_sec)
 {
     ClearLoop(); // clear the existing loop (if one exists), so we don't end up with more than 1 at a time
 
+    if (Stream_BPM > 0.0) {
+        fromPoint_sec = loopEngine.beatAlignedFrom(fromPoint_sec, toPoint_sec, Stream_BPM);
+    }
+
 //    qDebug() << "Loop from " << fromPoint_sec << " to " << toPoint_sec;
     loopFromPoint_sec = fromPoint_sec;
     loopToPoint_sec = toPoint_sec;
 
-    startPoint_bytes = BASS_ChannelSeconds2Bytes(Stream, fromPoint_sec);
-    endPoint_bytes = BASS_ChannelSeconds2Bytes(Stream, toPoint_sec);
-    // TEST
-    HSYNC handle = BASS_ChannelSetSync(Stream, BASS_SYNC_POS, startPoint_bytes, MySyncProc, &endPoint_bytes);
-    // Q_UNUSED(handle)
-    syncHandle = handle;  // save the handle
+    if (!loopEngine.set(fromPoint_sec, toPoint_sec)) {
+        qDebug() << "ERROR: can't loop from " << fromPoint_sec << " to " << toPoint_sec;
+    }
+    return(fromPoint_sec);
 }
 
 void bass_audio::ClearLoop()
 {
 //    qDebug() << "Loop points cleared";
     loopFromPoint_sec = loopToPoint_sec = 0.0;
-    startPoint_bytes = endPoint_bytes = 0;
 
-    if (syncHandle) {
-        if (!BASS_ChannelRemoveSync(Stream, syncHandle)) {
-            // qDebug() << "ERROR: BASS_ChannelRemoveSync()";  // FIX: revisit this later...
-        }
-        syncHandle = 0; // no sync set right now
-    }
+    loopEngine.clear();
 }
 
 void bass_audio::SetMono(bool on)
 {
-    gStream_Mono = on;
+    streamDSP.setMono(on);
 }
 
 // ------------------------------------------------------------------
 void bass_audio::Play(void)
 {
     bPaused = false;
-    BASS_ChannelSetAttribute(Stream, BASS_ATTRIB_VOL, 1.0);  // ramp quickly to full volume
+    if (fadeInNextPlay_sec > 0.0) {
+        envelope.fade(0.0f, 1.0f, static_cast<float>(fadeInNextPlay_sec));
+        fadeInNextPlay_sec = 0.0;
+    } else {
+        envelope.fade(-1.0f, 1.0f, 0.0f);  // back to full volume, if it was faded out
+    }
+    pauseAt_ms = 0;
+    fadeEndPosition = -1;
     BASS_ChannelPlay(Stream, false);
+    meterFeed.resume();
     StreamGetPosition();  // tell the position bar in main window where we are
 }
 
@@ -517,6 +607,8 @@ void bass_audio::Play(void)
 void bass_audio::Stop(void)
 {
     BASS_ChannelPause(Stream);
+    envelope.unduck(0.0f);  // a duck can't finish while we're not playing, so don't leave one for Play()
+    meterFeed.pause();
     StreamSetPosition(0);
     StreamGetPosition();  // tell the position bar in main window where we are
     bPaused = true;
@@ -526,6 +618,8 @@ void bass_audio::Stop(void)
 void bass_audio::Pause(void)
 {
     BASS_ChannelPause(Stream);
+    envelope.unduck(0.0f);  // a duck can't finish while we're not playing, so don't leave one for Play()
+    meterFeed.pause();
     StreamGetPosition();  // tell the position bar in main window where we are
     bPaused = true;
 }
@@ -537,67 +631,179 @@ void bass_audio::FadeOutAndPause(void) {
     if (Stream_State == BASS_ACTIVE_PLAYING) {
 //        qDebug() << "starting fade...current streamvolume is " << Stream_Volume;
 
-        BASS_ChannelSlideAttribute(Stream, BASS_ATTRIB_VOL, 0.0, 6000);  // fade to 0 in 6s
+        fadeEndPosition = -1;
+        envelope.fade(-1.0f, 0.0f, kFadeOut_sec, true);  // and then ServiceFades() pauses
+    }
+}
+
+void bass_audio::FadeInAndPlay(double seconds) {
+    fadeInNextPlay_sec = seconds;
+    Play();
+}
+
+void bass_audio::StartCrossfade(double seconds) {
+    if (currentStreamState() != BASS_ACTIVE_PLAYING) {
+        return;  // nothing to fade out
+    }
+    if (outgoingStream != 0) {
+        BASS_StreamFree(outgoingStream);  // still fading out from the last crossfade
+    }
+
+    // hand the stream over to the outgoing DSP, and let it play on by itself
+    ClearLoop();
+    loopEngine.detach();
+    BASS_ChannelRemoveDSP(Stream, streamDSPHandle);
+    outgoingDSP = streamDSP;  // same pan/EQ/limiter, and the same filter state, so no click
+    outgoingEnvelope.reset(streamSampleRate);
+    outgoingEnvelope.fade(1.0f, 0.0f, static_cast<float>(seconds), true);
+    BASS_ChannelSetDSP(Stream, &OutgoingDSPProc, this, 1);
+    outgoingStream = Stream;
+    outgoingFreeAt_ms = 0;
+
+    Stream = 0;
+    streamDSPHandle = 0;
+    meterFeed.flush();
+    fadeInNextPlay_sec = seconds;
+}
+
+// The envelopes run ahead of what can be heard, by however much audio is in the playback buffer,
+//   so the end of a fade is acted on when it has actually been heard, and a duck is shortened so
+//   that the music comes back up when the sound effect ends.
+static double bufferedSeconds(HSTREAM stream)
+{
+    DWORD buffered = BASS_ChannelGetData(stream, NULL, BASS_DATA_AVAILABLE);
+    return (buffered == static_cast<DWORD>(-1) ? 0.0 : BASS_ChannelBytes2Seconds(stream, buffered));
+}
+
+static qint64 heardAt_ms(HSTREAM stream)
+{
+    return QDateTime::currentMSecsSinceEpoch() + static_cast<qint64>(1000.0 * bufferedSeconds(stream)) + 1;
+}
+
+void bass_audio::ServiceFades() {
+    qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+
+    if (envelope.takeFadeDone()) {
+        pauseAt_ms = heardAt_ms(Stream);
+    }
+    if (pauseAt_ms != 0 && now_ms >= pauseAt_ms) {
+        pauseAt_ms = 0;
+        if (currentStreamState() == BASS_ACTIVE_PLAYING) {
+            Pause();
+            // go back to where the fade ended (the audio thread noted it), so that Play() picks up
+            //   there, even if the UI was too busy to get here on time and the song went on silently.
+            //   That also throws away the (silent) rest of the playback buffer.
+            long long fadeEnd = fadeEndPosition.exchange(-1);
+            QWORD position = (fadeEnd >= 0 ? static_cast<QWORD>(fadeEnd) : BASS_ChannelGetPosition(Stream, BASS_POS_BYTE));
+            BASS_ChannelSetPosition(Stream, position, BASS_POS_BYTE);
+            meterFeed.flush();
+        }
+    }
+
+    if (outgoingEnvelope.takeFadeDone()) {
+        outgoingFreeAt_ms = heardAt_ms(outgoingStream);
+    }
+    if (outgoingStream != 0 && outgoingFreeAt_ms != 0 && now_ms >= outgoingFreeAt_ms) {
+        BASS_StreamFree(outgoingStream);
+        outgoingStream = 0;
+        outgoingFreeAt_ms = 0;
     }
 }
 
 void bass_audio::StartVolumeDucking(int duckToPercent, double forSeconds) {
 //    qDebug() << "Start volume ducking to: " << duckToPercent << " for " << forSeconds << " seconds...";
 
-    BASS_ChannelSetAttribute(Stream, BASS_ATTRIB_VOL, static_cast<float>(duckToPercent)/100.0f); // drop Stream (main music stream) to a % of current volume
+    // the envelope only runs while the music is playing, so a duck queued now (e.g. "break over"
+    //   while paused) would wait for the next Play(), and then hold the music down for the whole
+    //   length of the sound effect
+    if (currentStreamState() != BASS_ACTIVE_PLAYING) {
+        return;
+    }
 
-    QTimer::singleShot(forSeconds*1000.0, [=] {
-        StopVolumeDucking();
-    });
+    // the duck is heard one playback buffer late (the effect isn't), so take that off of the hold,
+    //   to bring the music back up when the effect ends
+    double hold_sec = forSeconds - bufferedSeconds(Stream);
+    if (hold_sec < 0.0) {
+        hold_sec = 0.0;
+    }
 
+    // sound effects can overlap, so the envelope keeps the music down until the LAST one is done
+    envelope.duck(static_cast<float>(duckToPercent)/100.0f, kDuckAttack_sec, static_cast<float>(hold_sec), kDuckRelease_sec);
 }
 
 void bass_audio::StopVolumeDucking() {
 //    qDebug() << "End volume ducking...";
-    BASS_ChannelSetAttribute(Stream, BASS_ATTRIB_VOL, 1.0); // drop Stream (main music stream) to a % of current volume
+    envelope.unduck(0.05f);  // back to full volume, quickly (but ramped, so no click)
 }
 
-
 // ------------------------------------------------------------------
-void bass_audio::PlayOrStopSoundEffect(int which, const char *filename, int volume) {
-//    printf("SFXID: %d, which: %d\n", currentSoundEffectID, which);
-//    printf("FXStream: %x, Active: %d\n\n", FXStream, BASS_ChannelIsActive(FXStream)==BASS_ACTIVE_PLAYING);
-//    fflush(stdout);
-
-    if (which == currentSoundEffectID &&
-            FXStream != (HSTREAM)NULL &&
-            BASS_ChannelIsActive(FXStream)==BASS_ACTIVE_PLAYING) {
+void bass_audio::PreloadSoundEffects(const QStringList &filenames) {
+    for (const QString &filename : filenames) {
+        soundFXCache.preload(filename);  // no-op, if it's already there
+    }
+}
+
+bool bass_audio::SoundEffectIsPlaying() {
+    QHash<QString, DWORD>::iterator it = soundEffectChannels.begin();
+    while (it != soundEffectChannels.end()) {
+        if (BASS_ChannelIsActive(it.value()) == BASS_ACTIVE_PLAYING) {
+            return(true);
+        }
+        it = soundEffectChannels.erase(it);  // done, so forget it
+    }
+    return(false);
+}
+
+void bass_audio::PlayOrStopSoundEffect(int which, const QString &filename, int volume) {
+    QHash<QString, DWORD>::iterator playing = soundEffectChannels.find(filename);
+    if (playing != soundEffectChannels.end() &&
+            BASS_ChannelIsActive(playing.value()) == BASS_ACTIVE_PLAYING) {
         // if the user pressed the same key again, while playing back...
-        BASS_ChannelStop(FXStream);  // stop the current stream
-        currentSoundEffectID = 0;    // nothing playing now
-        StopVolumeDucking();
+        BASS_ChannelStop(playing.value());  // stop just that one
+        soundEffectChannels.erase(playing);
+        currentSoundEffectID = 0;
+        if (!SoundEffectIsPlaying()) {
+            StopVolumeDucking();
+        }
         return;
     }
 
-    // OPEN THE STREAM FOR PLAYBACK ------------------------
-    if (FXStream != (HSTREAM)NULL) {
-        BASS_StreamFree(FXStream);                                                  // clean up the old stream
-    }
-    FXStream = BASS_StreamCreateFile(false, filename, 0, 0, 0);
-    BASS_ChannelSetAttribute(FXStream, BASS_ATTRIB_VOL, static_cast<float>(volume)/100.0f);  // volume relative to 100% of Music
+    float fxVolume = static_cast<float>(volume)/100.0f;  // volume relative to 100% of Music
+    double FXLength_seconds = 0.0;
 
-    QWORD Length = BASS_ChannelGetLength(FXStream, BASS_POS_BYTE);
-    double FXLength_seconds = BASS_ChannelBytes2Seconds(FXStream, Length);
+    // usually already decoded in memory, so no disk access here
+    DWORD channel = soundFXCache.play(filename, fxVolume, &FXLength_seconds);
+    if (channel == 0) {
+        // too big for the cache, so stream it from the disk (one at a time)
+        if (FXStream != (HSTREAM)NULL) {
+            BASS_StreamFree(FXStream);                                              // clean up the old stream
+        }
+        FXStream = BASS_StreamCreateFile(false, filename.toLocal8Bit().constData(), 0, 0, 0);
+        if (FXStream == (HSTREAM)NULL) {
+            return;  // no such file
+        }
+        BASS_ChannelSetAttribute(FXStream, BASS_ATTRIB_VOL, fxVolume);
 
-    StartVolumeDucking(20, FXLength_seconds);
+        QWORD Length = BASS_ChannelGetLength(FXStream, BASS_POS_BYTE);
+        FXLength_seconds = BASS_ChannelBytes2Seconds(FXStream, Length);
+
+        BASS_ChannelPlay(FXStream, true);                                       // play it all the way through
+        channel = FXStream;
+    }
 
-    BASS_ChannelPlay(FXStream, true);                                           // play it all the way through
+    soundEffectChannels.insert(filename, channel);
+    StartVolumeDucking(20, FXLength_seconds);
     currentSoundEffectID = which;
 }
 
 void bass_audio::StopAllSoundEffects() {
-    if (FXStream != (HSTREAM)NULL &&
-        BASS_ChannelIsActive(FXStream)==BASS_ACTIVE_PLAYING) {
-
+    soundFXCache.stopAll();
+    if (FXStream != (HSTREAM)NULL) {
         BASS_ChannelStop(FXStream);  // stop the current stream
+    }
 
-        StopVolumeDucking();  // stop ducking of music, if it was in effect...
+    StopVolumeDucking();  // stop ducking of music, if it was in effect...
+    soundEffectChannels.clear();
 
-        currentSoundEffectID = 0;    // nothing playing now
-    }
+    currentSoundEffectID = 0;    // nothing playing now
 }
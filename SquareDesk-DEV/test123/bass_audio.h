@@ -25,7 +25,22 @@
 
 #pragma once
 #include "bass.h"
+#include "gainenvelope.h"
+#include "loopengine.h"
+#include "meterfeed.h"
+#include "songpreloader.h"
+#include "soundfxcache.h"
+#include "streamdsp.h"
+#include "waveformoverview.h"
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
 #include <QTimer>
+#include <atomic>
+#include <string>
+#include <vector>
 
 class bass_audio
 {
@@ -47,17 +62,24 @@ public:
     double                  loopFromPoint_sec;
     double                  loopToPoint_sec;
 
-    QWORD                   startPoint_bytes;
-    QWORD                   endPoint_bytes;     // jump to point.  If 0, don't jump at all.
-
 //---------------------------------------------------------
     //constructors
     bass_audio(void);
     ~bass_audio(void);
     //---------------------------------------------------------
     //System
-    void Init(void);
+    // the output device is a BASS device number: kDefaultDevice is the system's current output,
+    //   kNoSoundDevice has no output at all (streams still play, in real time, just silently), so the
+    //   whole audio path also runs on a machine without a sound card (e.g. a build/CI machine).
+    //   SQUAREDESK_NO_SOUND=1 in the environment forces kNoSoundDevice.
+    static const int kDefaultDevice = -1;
+    static const int kNoSoundDevice = 0;
+    void Init(int device = kDefaultDevice);
     void Exit(void);
+    int  OutputDevice() const { return outputDevice; }
+
+    // see SongPreloader
+    void SetPreloadMode(SongPreloader::Mode mode, qint64 budget_bytes = SongPreloader::kDefaultBudget_bytes);
 
     //Settings
     void SetVolume(int inVolume);
@@ -66,15 +88,24 @@ public:
     void SetPitch(int newPitch);  // in semitones, -5 .. 5
     void SetPan(double  newPan);  // -1.0 .. 0.0 .. 1.0
 
-    void SetLoop(double fromPoint_sec, double toPoint_sec);  // if fromPoint < 0, then disabled
+    double SetLoop(double fromPoint_sec, double toPoint_sec);  // if fromPoint < 0, then disabled; returns the (beat aligned) fromPoint
     void ClearLoop();
 
     void SetMono(bool on);
 
     //Stream
-    void songStartDetector(const char *filepath, double  *pSongStart, double  *pSongEnd);
+    static bool AnalyzeSong(const char *filepath, double *pBPM, double *pSongStart_sec, double *pSongEnd_sec,
+                            double *pSongLength_sec, double *pLoudness_dB,
+                            std::vector<float> *pPeakEnvelope = nullptr,
+                            std::vector<float> *pRMSEnvelope = nullptr,
+                            WaveformOverview *pWaveform = nullptr);  // thread-safe, decodes the whole file
     void StreamCreate(const char *filepath, double  *pSongStart, double  *pSongEnd, double i1, double o1);  // returns start of non-silence (seconds)
 
+    // "next song" standby stream: opened and primed on a worker thread, so that StreamCreate()
+    //   on the same file just takes it over, instead of opening the file on the UI thread.
+    void PrefetchStream(const char *filepath);  // replaces any earlier prefetch
+    void CancelPrefetch();
+
     void StreamGetLength(void);
     void StreamSetPosition(double Position);
     void StreamGetPosition(void);
@@ -86,11 +117,17 @@ public:
     void Stop(void);  // forces stream to stop playback, and rewinds to 0
     void Pause(void); // forces stream to stop playback
     void FadeOutAndPause(void);  // 6 second fade, then pause
+    void FadeInAndPlay(double seconds);
 
-    int StreamGetVuMeter(void); // get VU meter level (mono)
+    // the song that is playing now fades out on its own (over seconds), and the next Play() of
+    //   the next StreamCreate() fades in over the same time, i.e. an equal power crossfade
+    void StartCrossfade(double seconds);
+
+    bool StreamReadMeter(MeterBlock *levels); // RMS/peak of what was heard since the last call; false if nothing new
 
     // FX
-    void PlayOrStopSoundEffect(int which, const char *filename, int volume = 100);
+    void PreloadSoundEffects(const QStringList &filenames);  // decode them now, so that playing them is instant
+    void PlayOrStopSoundEffect(int which, const QString &filename, int volume = 100);
     void StopAllSoundEffects();
 
     void StartVolumeDucking(int duckToPercent, double  forSeconds);
@@ -107,10 +144,41 @@ public:
 private:
     //-------------------------------------------------------------
     //-------------------------------------------------------------
+    int                             outputDevice;      // what Init() actually got
     HSTREAM                         Stream;
-    HSTREAM                         FXStream;
-
-    HFX fxEQ;     // dsp peaking eq handle
-
-    HSYNC  syncHandle;
+    HSTREAM                         FXStream;          // only for sound effects too big for soundFXCache
+    SoundFXCache                    soundFXCache;
+    QHash<QString, DWORD>           soundEffectChannels;  // filename -> the channel it was last started on
+    bool SoundEffectIsPlaying();
+
+    StreamDSP streamDSP;  // pan/mono, EQ, limiter (one pass, on the audio thread)
+    GainEnvelope envelope;  // ducking and fades, also on the audio thread
+    HDSP streamDSPHandle;
+    MeterFeed meterFeed;  // levels from the audio thread, for the VU meter
+    float streamSampleRate;
+    static void CALLBACK StreamDSPProc(HDSP handle, DWORD channel, void *buffer, DWORD length, void *user);
+
+    // the last song, fading out under the new one (see StartCrossfade())
+    HSTREAM outgoingStream;
+    StreamDSP outgoingDSP;  // a copy of streamDSP, taken when the crossfade starts
+    GainEnvelope outgoingEnvelope;
+    qint64 outgoingFreeAt_ms;  // when its fade out will have been heard (0 = not done yet)
+    double fadeInNextPlay_sec;
+    qint64 pauseAt_ms;         // when FadeOutAndPause()'s fade will have been heard (0 = not done yet)
+    std::atomic<long long> fadeEndPosition;  // where in the song that fade ended (bytes, -1 = not yet), from the audio thread
+    static void CALLBACK OutgoingDSPProc(HDSP handle, DWORD channel, void *buffer, DWORD length, void *user);
+    void ServiceFades();  // turns finished fades into a pause, or freeing the outgoing stream
+
+    LoopEngine loopEngine;
+
+    SongPreloader songPreloader;  // songs on slow media are read into memory when they're opened
+    HSTREAM OpenStream(const char *filepath, bool prime);  // thread-safe
+    HSTREAM TakeStandbyStream(const char *filepath);
+
+    QMutex                          standbyMutex;      // protects the standby* members
+    HSTREAM                         standbyStream;     // 0 = none (yet)
+    std::string                     standbyPath;       // the file that standbyStream is (or will be) for
+    unsigned int                    standbyGeneration; // bumped by every PrefetchStream()/CancelPrefetch()
+    QFuture<void>                   standbyFuture;     // the newest prefetch
+    QList<QFuture<void> >           prefetchFutures;   // every prefetch that may still be running (UI thread only)
 };
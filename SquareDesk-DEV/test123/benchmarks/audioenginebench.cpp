@@ -0,0 +1,289 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+// Decode/FX throughput of the audio engine, per file, for a corpus of songs:
+//
+//   open      bass_audio::StreamCreate() (the same thing that loading a song does)
+//   decode    the whole file, through a plain decode channel
+//   fx        the whole file, through the playback chain (BASS_FX tempo/pitch, then StreamDSP),
+//             at the tempo and pitch below; "fx cost" is the part of that which isn't decoding
+//   analyze   bass_audio::AnalyzeSong() (BPM, start/end of the music, loudness, waveform)
+//
+// Each one is run several times and the fastest is kept, so that the OS file cache and other
+//   noise don't count.  BASS runs on the "no sound" device, so no sound card is needed.
+//
+// The results are written as JSON, for comparing one release (or machine) with another:
+//
+//   audioenginebench [-r repeats] [-o results.json] <files and/or folders>
+
+#include "bass_audio.h"
+#include "bass_fx.h"
+#include "streamdsp.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QSysInfo>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+static const int kTempoPercent = 95;   // a typical slowed-down singing call...
+static const int kPitchSemitones = 1;  // ...in a different key
+
+static const int kFormatVersion = 1;   // bump if the meaning of a field changes
+
+// ------------------------------------------------------------------
+static double elapsed_ms(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1.0e6;
+}
+
+// decodes the whole channel, returns the number of seconds of audio (0.0 if it failed)
+static double drain(HSTREAM channel, StreamDSP *dsp)
+{
+    BASS_CHANNELINFO info;
+    if (!BASS_ChannelGetInfo(channel, &info)) {
+        return 0.0;
+    }
+    std::vector<float> buffer(16384 * info.chans);
+    quint64 frames = 0;
+    for (;;) {
+        DWORD got = BASS_ChannelGetData(channel, buffer.data(),
+                                        static_cast<DWORD>(buffer.size() * sizeof(float)) | BASS_DATA_FLOAT);
+        if (got == static_cast<DWORD>(-1) || got == 0) {
+            break;
+        }
+        int n = static_cast<int>(got / (sizeof(float) * info.chans));
+        if (dsp != nullptr) {
+            dsp->process(buffer.data(), n);
+        }
+        frames += static_cast<quint64>(n);
+    }
+    return static_cast<double>(frames) / info.freq;
+}
+
+static double timeDecode(const std::string &path, bool fx, double *audio_sec)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    HSTREAM stream = BASS_StreamCreateFile(false, path.c_str(), 0, 0, BASS_SAMPLE_FLOAT|BASS_STREAM_DECODE|BASS_STREAM_PRESCAN);
+    if (stream == 0) {
+        return -1.0;
+    }
+    StreamDSP dsp;
+    if (fx) {
+        // the same chain as playback (bass_audio::StreamCreate()), but decode-only
+        stream = BASS_FX_TempoCreate(stream, BASS_STREAM_DECODE|BASS_FX_FREESOURCE);
+        BASS_ChannelSetAttribute(stream, BASS_ATTRIB_TEMPO, static_cast<float>(kTempoPercent - 100));
+        BASS_ChannelSetAttribute(stream, BASS_ATTRIB_TEMPO_PITCH, static_cast<float>(kPitchSemitones));
+
+        BASS_CHANNELINFO info;
+        BASS_ChannelGetInfo(stream, &info);
+        dsp.setSampleRate(static_cast<float>(info.freq));
+        dsp.setChannels(static_cast<int>(info.chans));
+        dsp.setEqGain(0, 3.0f);  // so that the EQ isn't skipped as flat
+    }
+    *audio_sec = drain(stream, fx ? &dsp : nullptr);
+    BASS_StreamFree(stream);
+
+    return elapsed_ms(timer);
+}
+
+// ------------------------------------------------------------------
+static QJsonObject benchmarkFile(bass_audio &cBass, const QString &filename, int repeats)
+{
+    std::string path = filename.toStdString();
+    double open_ms = -1.0, decode_ms = -1.0, fx_ms = -1.0, analyze_ms = -1.0;
+    double length_sec = 0.0, fx_sec = 0.0, bpm = 0.0;
+
+    for (int i = 0; i < repeats; i++) {
+        QElapsedTimer timer;
+        timer.start();
+        double songStart_sec, songEnd_sec;
+        cBass.StreamCreate(path.c_str(), &songStart_sec, &songEnd_sec, 0.0, 0.0);
+        double t = elapsed_ms(timer);
+        open_ms = (i == 0 ? t : std::min(open_ms, t));
+
+        t = timeDecode(path, false, &length_sec);
+        decode_ms = (i == 0 ? t : std::min(decode_ms, t));
+
+        t = timeDecode(path, true, &fx_sec);
+        fx_ms = (i == 0 ? t : std::min(fx_ms, t));
+
+        timer.restart();
+        double start_sec, end_sec, analyzed_sec, loudness_dB;
+        WaveformOverview waveform;
+        bool ok = bass_audio::AnalyzeSong(path.c_str(), &bpm, &start_sec, &end_sec, &analyzed_sec, &loudness_dB,
+                                          nullptr, nullptr, &waveform);
+        t = (ok ? elapsed_ms(timer) : -1.0);
+        analyze_ms = (i == 0 ? t : std::min(analyze_ms, t));
+    }
+
+    QJsonObject result;
+    result["file"] = filename;
+    result["bytes"] = static_cast<double>(QFileInfo(filename).size());
+    result["ok"] = (decode_ms >= 0.0 && length_sec > 0.0);
+    result["length_sec"] = length_sec;
+    result["open_ms"] = open_ms;
+    result["decode_ms"] = decode_ms;
+    result["decode_x_realtime"] = (decode_ms > 0.0 ? 1000.0 * length_sec / decode_ms : 0.0);
+    result["fx_ms"] = fx_ms;
+    result["fx_x_realtime"] = (fx_ms > 0.0 ? 1000.0 * length_sec / fx_ms : 0.0);
+    result["fx_cost_ms"] = fx_ms - decode_ms;
+    result["fx_output_sec"] = fx_sec;
+    result["analyze_ms"] = analyze_ms;
+    result["bpm"] = bpm;
+    return result;
+}
+
+static QStringList findMusic(const QStringList &arguments)
+{
+    QStringList music;
+    QStringList filters;
+    filters << "*.mp3" << "*.m4a" << "*.wav" << "*.flac";
+    for (const QString &argument : arguments) {
+        if (QFileInfo(argument).isDir()) {
+            QDirIterator it(argument, filters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                music.append(it.next());
+            }
+        } else {
+            music.append(argument);
+        }
+    }
+    music.sort();
+    return music;
+}
+
+static double median(std::vector<double> values)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return (n % 2 == 1 ? values[n/2] : 0.5 * (values[n/2 - 1] + values[n/2]));
+}
+
+// ------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int repeats = 3;
+    QString outputFilename;
+    QStringList inputs;
+    QStringList arguments = app.arguments();
+    for (int i = 1; i < arguments.size(); i++) {
+        if (arguments[i] == "-r" && i + 1 < arguments.size()) {
+            repeats = std::max(1, arguments[++i].toInt());
+        } else if (arguments[i] == "-o" && i + 1 < arguments.size()) {
+            outputFilename = arguments[++i];
+        } else {
+            inputs.append(arguments[i]);
+        }
+    }
+    QStringList music = findMusic(inputs);
+    if (music.isEmpty()) {
+        fprintf(stderr, "usage: audioenginebench [-r repeats] [-o results.json] <files and/or folders>\n");
+        return 1;
+    }
+
+    bass_audio cBass;
+    cBass.Init(bass_audio::kNoSoundDevice);
+
+    QJsonArray files;
+    std::vector<double> open_ms;
+    double length_sec = 0.0, decode_ms = 0.0, fx_ms = 0.0, analyze_ms = 0.0;
+    int failed = 0;
+
+    fprintf(stderr, "%-40s %8s %9s %9s %9s %9s\n", "", "len (s)", "open (ms)", "decode x", "fx x", "analyze x");
+    for (const QString &filename : music) {
+        QJsonObject result = benchmarkFile(cBass, filename, repeats);
+        files.append(result);
+
+        if (!result["ok"].toBool()) {
+            fprintf(stderr, "%-40s FAILED\n", qPrintable(QFileInfo(filename).fileName().left(40)));
+            failed++;
+            continue;
+        }
+        double analyze = result["analyze_ms"].toDouble();
+        fprintf(stderr, "%-40s %8.1f %9.1f %9.0f %9.0f %9.0f\n", qPrintable(QFileInfo(filename).fileName().left(40)),
+                result["length_sec"].toDouble(), result["open_ms"].toDouble(),
+                result["decode_x_realtime"].toDouble(), result["fx_x_realtime"].toDouble(),
+                analyze > 0.0 ? 1000.0 * result["length_sec"].toDouble() / analyze : 0.0);
+
+        open_ms.push_back(result["open_ms"].toDouble());
+        length_sec += result["length_sec"].toDouble();
+        decode_ms += result["decode_ms"].toDouble();
+        fx_ms += result["fx_ms"].toDouble();
+        analyze_ms += analyze;
+    }
+    cBass.Exit();
+
+    QJsonObject summary;
+    summary["files"] = static_cast<int>(open_ms.size());
+    summary["failed"] = failed;
+    summary["audio_sec"] = length_sec;
+    summary["open_ms_median"] = median(open_ms);
+    summary["decode_x_realtime"] = (decode_ms > 0.0 ? 1000.0 * length_sec / decode_ms : 0.0);
+    summary["fx_x_realtime"] = (fx_ms > 0.0 ? 1000.0 * length_sec / fx_ms : 0.0);
+    summary["fx_cost_ms_per_audio_sec"] = (length_sec > 0.0 ? (fx_ms - decode_ms) / length_sec : 0.0);
+    summary["analyze_x_realtime"] = (analyze_ms > 0.0 ? 1000.0 * length_sec / analyze_ms : 0.0);
+
+    QJsonObject root;
+    root["benchmark"] = "audioenginebench";
+    root["format"] = kFormatVersion;
+    root["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["machine"] = QSysInfo::prettyProductName() + " " + QSysInfo::currentCpuArchitecture();
+    root["bass_version"] = QString::number(BASS_GetVersion(), 16);
+    root["bass_fx_version"] = QString::number(BASS_FX_GetVersion(), 16);
+    root["repeats"] = repeats;
+    root["tempo_percent"] = kTempoPercent;
+    root["pitch_semitones"] = kPitchSemitones;
+    root["files"] = files;
+    root["summary"] = summary;
+
+    QByteArray json = QJsonDocument(root).toJson();
+    if (outputFilename.isEmpty()) {
+        fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+    } else {
+        QFile out(outputFilename);
+        if (!out.open(QIODevice::WriteOnly) || out.write(json) != json.size()) {
+            fprintf(stderr, "can't write %s\n", qPrintable(outputFilename));
+            return 1;
+        }
+    }
+    return (failed == 0 ? 0 : 2);
+}
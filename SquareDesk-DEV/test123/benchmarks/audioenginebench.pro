@@ -0,0 +1,43 @@
+# Decode/FX/analysis throughput of bass_audio, per file, over a corpus of songs; writes JSON.
+#
+#   qmake audioenginebench.pro && make
+#   ./audioenginebench -o results.json ~/Music/squareDanceMusic
+#
+# Runs BASS on the "no sound" device, so it works on a build machine without a sound card.
+# Not part of the SquareDesk.pro build.
+
+TEMPLATE = app
+QT += core concurrent
+QT -= gui
+CONFIG += console c++11 release
+CONFIG -= app_bundle
+
+TARGET = audioenginebench
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    audioenginebench.cpp \
+    ../bass_audio.cpp \
+    ../streamdsp.cpp \
+    ../gainenvelope.cpp \
+    ../loopengine.cpp \
+    ../songpreloader.cpp \
+    ../meterfeed.cpp \
+    ../soundfxcache.cpp \
+    ../waveformoverview.cpp
+
+HEADERS += \
+    ../bass_audio.h \
+    ../streamdsp.h \
+    ../gainenvelope.h \
+    ../loopengine.h \
+    ../songpreloader.h \
+    ../meterfeed.h \
+    ../soundfxcache.h \
+    ../waveformoverview.h
+
+# NOTE: there is no debug version of libbass
+win32: LIBS += -L$$PWD/.. -L$$PWD/../../local_win32/lib -lbass -lbass_fx
+else:unix:!macx: LIBS += -L$$PWD/.. -L$$PWD/../../local/lib -lbass -lbass_fx
+macx: LIBS += $$PWD/../libbass.dylib $$PWD/../libbass_fx.dylib
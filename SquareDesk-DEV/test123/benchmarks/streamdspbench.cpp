@@ -0,0 +1,277 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+// Per-buffer cost of the playback DSP, before and after StreamDSP:
+//
+//   before: the old DSP_Mono callback (pan + mono), then a separate peaking EQ pass (what the
+//           BASS_FX PEAKEQ effect did, one band after the other), then a separate gain pass
+//           (BASS_ATTRIB_VOL, for ducking)
+//   after:  StreamDSP::processScalar() and StreamDSP::process() (SSE2), one fused pass
+//
+// The BASS_FX code itself isn't available here, so the "before" EQ is the same RBJ biquad,
+//   run as its own pass over the buffer, the way a separate effect runs.
+
+#include "streamdsp.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+static const int kFrames = 4410;      // 100 ms at 44.1 kHz, about what BASS hands a DSP per update
+static const int kIterations = 2000;
+
+// ------------------------------------------------------------------
+// BEFORE
+static float gStream_Pan = 0.2f;
+static bool gStream_Mono = false;
+
+static void DSP_Mono(float *d, int length)
+{
+    float outL, outR;
+    float inL,inR;
+    float mono;
+
+    const float PI_OVER_2 = 3.14159265f/2.0f;
+    float theta = PI_OVER_2 * (gStream_Pan + 1.0f)/2.0f;  // convert to 0-PI/2
+    float KL = cos(theta);
+    float KR = sin(theta);
+
+    if (gStream_Mono) {
+        for (int a=0; a<length/4; a+=2)
+        {
+            inL = d[a];
+            inR = d[a+1];
+            outL = KL * inL;
+            outR = KR * inR;
+            mono = (outL + outR)/2.0f;
+            d[a] = d[a+1] = mono;
+        }
+    } else {
+        for (int a=0; a<length/4; a+=2)
+        {
+            inL = d[a];
+            inR = d[a+1];
+            outL = KL * inL;
+            outR = KR * inR;
+            d[a] = outL;
+            d[a+1] = outR;
+        }
+    }
+}
+
+class SeparateEqBand
+{
+public:
+    SeparateEqBand(double center, double gain_dB, double fs)
+    {
+        double A = pow(10.0, gain_dB / 40.0);
+        double w0 = 2.0 * 3.14159265358979323846 * center / fs;
+        double alpha = sin(w0) * sinh(log(2.0) / 2.0 * 2.5 * w0 / sin(w0));
+        double a0 = 1.0 + alpha / A;
+        b0 = static_cast<float>((1.0 + alpha * A) / a0);
+        b1 = static_cast<float>((-2.0 * cos(w0)) / a0);
+        b2 = static_cast<float>((1.0 - alpha * A) / a0);
+        a1 = b1;
+        a2 = static_cast<float>((1.0 - alpha / A) / a0);
+        z1[0] = z1[1] = z2[0] = z2[1] = 0.0f;
+    }
+
+    void process(float *d, int frames)
+    {
+        for (int f = 0; f < frames; f++) {
+            for (int c = 0; c < 2; c++) {
+                float x = d[2*f + c];
+                float y = b0 * x + z1[c];
+                z1[c] = b1 * x - a1 * y + z2[c];
+                z2[c] = b2 * x - a2 * y;
+                d[2*f + c] = y;
+            }
+        }
+    }
+
+private:
+    float b0, b1, b2, a1, a2;
+    float z1[2], z2[2];
+};
+
+static void separateGain(float *d, int frames, float gain)
+{
+    for (int i = 0; i < 2*frames; i++) {
+        d[i] *= gain;
+    }
+}
+
+// ------------------------------------------------------------------
+template <typename F>
+static double nsPerBuffer(std::vector<float> &buffer, const std::vector<float> &source, F process)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        buffer = source;
+        process(buffer.data());
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    // subtract the cost of the copy
+    volatile float sink = 0.0f;
+    auto copyStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        buffer = source;
+        sink = sink + buffer[i % buffer.size()];
+    }
+    auto copyStop = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>((stop - start) - (copyStop - copyStart)).count();
+    return ns / kIterations;
+}
+
+static double maxDifference(const std::vector<float> &a, const std::vector<float> &b)
+{
+    double diff = 0.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        diff = std::max(diff, static_cast<double>(fabsf(a[i] - b[i])));
+    }
+    return diff;
+}
+
+// Scalar vs. fused over many calls in a row, with odd lengths, and with the EQ bands, mono, pan
+//   and gain changing between calls (the state that carries over from one call to the next is
+//   where the two can drift apart, e.g. a band that was just turned off).
+static double changingSettingsDifference(const std::vector<float> &source)
+{
+    static const float kGains_dB[] = { 0.0f, 6.0f, -4.5f, 0.0f, 12.0f };
+    static const int kGainCount = sizeof(kGains_dB) / sizeof(kGains_dB[0]);
+
+    StreamDSP a, b;
+    std::vector<float> outA(source), outB(source);
+    int totalFrames = static_cast<int>(source.size() / 2);
+    double diff = 0.0;
+
+    srand(2);
+    int f = 0;
+    for (int call = 0; call < 2000; call++) {
+        int frames = 1 + rand() % 257;  // odd and even, and shorter than the SSE blocks
+        if (f + frames > totalFrames) {
+            f = 0;
+            outA = source;
+            outB = source;
+        }
+        if (call % 3 == 0) {
+            int band = rand() % StreamDSP::kBands;
+            float gain_dB = kGains_dB[rand() % kGainCount];
+            a.setEqGain(band, gain_dB);
+            b.setEqGain(band, gain_dB);
+        }
+        if (call % 17 == 0) {
+            bool mono = (rand() % 2 == 0);
+            a.setMono(mono);
+            b.setMono(mono);
+        }
+        if (call % 11 == 0) {
+            float pan = (rand() % 5 - 2) / 2.0f;
+            a.setPan(pan);
+            b.setPan(pan);
+        }
+        if (call % 7 == 0) {
+            float gain = (rand() % 4 + 1) / 4.0f;
+            a.setGain(gain, 0.001f);
+            b.setGain(gain, 0.001f);
+        }
+
+        a.processScalar(outA.data() + 2*f, frames);
+        b.process(outB.data() + 2*f, frames);
+        for (int i = 2*f; i < 2*(f + frames); i++) {
+            diff = std::max(diff, static_cast<double>(fabsf(outA[i] - outB[i])));
+        }
+        f += frames;
+    }
+    return diff;
+}
+
+int main()
+{
+    std::vector<float> source(2 * kFrames);
+    srand(1);
+    for (int i = 0; i < 2 * kFrames; i++) {
+        source[i] = 0.8f * sinf(i * 0.01f) + 0.1f * (rand() / static_cast<float>(RAND_MAX) - 0.5f);
+    }
+    std::vector<float> buffer;
+
+    printf("%d frames/buffer, %d buffers\n\n", kFrames, kIterations);
+    printf("%-34s %12s %12s\n", "", "flat EQ", "EQ on");
+
+    double before[2], beforePanOnly, scalar[2], fused[2], difference[2];
+    for (int withEq = 0; withEq < 2; withEq++) {
+        float gain_dB = (withEq ? 6.0f : 0.0f);
+
+        SeparateEqBand bass(125.0, gain_dB, 44100.0), mid(1000.0, -gain_dB, 44100.0), treble(8000.0, gain_dB, 44100.0);
+        before[withEq] = nsPerBuffer(buffer, source, [&](float *d) {
+            DSP_Mono(d, kFrames * 8);
+            if (gain_dB != 0.0f) {  // BASS_FX runs the effect regardless, but be generous
+                bass.process(d, kFrames);
+                mid.process(d, kFrames);
+                treble.process(d, kFrames);
+            }
+            separateGain(d, kFrames, 0.5f);
+        });
+
+        StreamDSP dspScalar, dspFused;
+        for (StreamDSP *dsp : { &dspScalar, &dspFused }) {
+            dsp->setPan(gStream_Pan);
+            dsp->setEqGain(0, gain_dB);
+            dsp->setEqGain(1, -gain_dB);
+            dsp->setEqGain(2, gain_dB);
+            dsp->setGain(0.5f, 0.0f);
+        }
+        scalar[withEq] = nsPerBuffer(buffer, source, [&](float *d) { dspScalar.processScalar(d, kFrames); });
+        fused[withEq] = nsPerBuffer(buffer, source, [&](float *d) { dspFused.process(d, kFrames); });
+
+        // same answer, scalar vs. fused
+        StreamDSP a, b;
+        for (StreamDSP *dsp : { &a, &b }) {
+            dsp->setPan(gStream_Pan);
+            dsp->setEqGain(0, gain_dB);
+            dsp->setEqGain(1, -gain_dB);
+            dsp->setEqGain(2, gain_dB);
+            dsp->setGain(0.5f, 0.01f);
+        }
+        std::vector<float> outA(source), outB(source);
+        a.processScalar(outA.data(), kFrames);
+        b.process(outB.data(), kFrames);
+        difference[withEq] = maxDifference(outA, outB);
+    }
+    beforePanOnly = nsPerBuffer(buffer, source, [&](float *d) { DSP_Mono(d, kFrames * 8); });
+
+    printf("%-34s %12.0f %12s  ns/buffer\n", "before: DSP_Mono (pan) only", beforePanOnly, "");
+    printf("%-34s %12.0f %12.0f  ns/buffer\n", "before: DSP_Mono + EQ + gain", before[0], before[1]);
+    printf("%-34s %12.0f %12.0f  ns/buffer\n", "after:  StreamDSP::processScalar", scalar[0], scalar[1]);
+    printf("%-34s %12.0f %12.0f  ns/buffer\n", "after:  StreamDSP::process", fused[0], fused[1]);
+    printf("\nmax |scalar - process|: %g (flat), %g (EQ on), %g (settings changing between calls)\n",
+           difference[0], difference[1], changingSettingsDifference(source));
+    return 0;
+}
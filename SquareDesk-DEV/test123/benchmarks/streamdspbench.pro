@@ -0,0 +1,21 @@
+# Micro-benchmark for the StreamDSP (pan/mono/EQ/gain/limiter) used by bass_audio.
+#
+#   qmake streamdspbench.pro && make && ./streamdspbench
+#
+# Not part of the SquareDesk.pro build.
+
+TEMPLATE = app
+CONFIG += console c++11 release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+TARGET = streamdspbench
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    streamdspbench.cpp \
+    ../streamdsp.cpp
+
+HEADERS += \
+    ../streamdsp.h
@@ -0,0 +1,352 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "cuesheetmatchindex.h"
+
+#include <QSet>
+#include <QRegularExpression>
+#include <algorithm>
+
+// -----------------------------------------------------------------
+QStringList splitIntoWords(const QString &str)
+{
+    // const, since this is called from the QtConcurrent workers in findCuesheetsMatchingMusic()
+    static const QRegularExpression regexNotAlnum("\\W+");
+
+    QStringList words = str.split(regexNotAlnum);
+
+    static const QRegularExpression LetterNumber("[A-Z][0-9]|[0-9][A-Z]"); // do we need to split?  Most of the time, no.
+    QRegularExpressionMatch quickmatch(LetterNumber.match(str));
+
+    if (quickmatch.hasMatch()) {
+        static const QRegularExpression regexLettersAndNumbers("^([A-Z]+)([0-9].*)$");
+        static const QRegularExpression regexNumbersAndLetters("^([0-9]+)([A-Z].*)$");
+//        qDebug() << "quickmatch!";
+        // we gotta split it one word at a time
+//        words = str.split(regexNotAlnum);
+        for (int i = 0; i < words.length(); ++i)
+        {
+            bool splitFurther = true;
+
+            while (splitFurther)
+            {
+                splitFurther = false;
+                QRegularExpressionMatch match(regexLettersAndNumbers.match(words[i]));
+                if (match.hasMatch())
+                {
+                    words.append(match.captured(1));
+                    words[i] = match.captured(2);
+                    splitFurther = true;
+                }
+                match = regexNumbersAndLetters.match(words[i]);
+                if (match.hasMatch())
+                {
+                    splitFurther = true;
+                    words.append(match.captured(1));
+                    words[i] = match.captured(2);
+                }
+            }
+        }
+    }
+    // else no splitting needed (e.g. it's already split, as is the case for most cuesheets)
+    //   so we skip the per-word splitting, and go right to sorting
+    words.sort(Qt::CaseInsensitive);
+    return words;
+}
+
+int compareSortedWordListsForRelevance(const QStringList &l1, const QStringList l2)
+{
+    int i1 = 0, i2 = 0;
+    int score = 0;
+
+    while (i1 < l1.length() &&  i2 < l2.length())
+    {
+        int comp = l1[i1].compare(l2[i2], Qt::CaseInsensitive);
+
+        if (comp == 0)
+        {
+            ++score;
+            ++i1;
+            ++i2;
+        }
+        else if (comp < 0)
+        {
+            ++i1;
+        }
+        else
+        {
+            ++i2;
+        }
+    }
+
+    if (l1.length() >= 2 && l2.length() >= 2 &&
+        (
+            (score > ((l1.length() + l2.length()) / 4))
+            || (score >= l1.length())                       // all of l1 words matched something in l2
+            || (score >= l2.length())                       // all of l2 words matched something in l1
+            || score >= 4)
+        )
+    {
+        QString s1 = l1.join("-");
+        QString s2 = l2.join("-");
+        return score * 500 + 100 * (abs(l1.length()) - l2.length());
+    }
+    else
+        return 0;
+}
+
+// -----------------------------------------------------------------
+CuesheetMatchKeys CuesheetMatchKeys::fromParts(const QString &completeBaseName,
+                                               const QString &label, const QString &labelnum,
+                                               const QString &title, const QString &shortTitle)
+{
+    CuesheetMatchKeys keys;
+    keys.completeBaseName = completeBaseName;
+    keys.label = label;
+    keys.labelnum = labelnum;
+    keys.title = title;
+    keys.shortTitle = shortTitle;
+
+    keys.labelnum_short = labelnum;
+    while (keys.labelnum_short.length() > 0 && keys.labelnum_short[0] == '0')
+    {
+        keys.labelnum_short.remove(0,1);
+    }
+
+    keys.words = splitIntoWords(completeBaseName);
+    keys.emptyWords = keys.words.count(QString());
+    return keys;
+}
+
+bool CuesheetMatchKeys::meetsMinimumCriteria(const CuesheetMatchKeys &song, const CuesheetMatchKeys &cuesheet)
+{
+    return cuesheet.completeBaseName.compare(song.completeBaseName, Qt::CaseInsensitive) == 0   // exact match: entire filename
+        || cuesheet.title.compare(song.title, Qt::CaseInsensitive) == 0                         // exact match: title (without label/labelNum)
+        || (cuesheet.shortTitle.length() > 0                                                    // exact match: shortTitle
+            && cuesheet.shortTitle.compare(song.shortTitle, Qt::CaseInsensitive) == 0)
+        || (cuesheet.labelnum_short.length() > 0 && cuesheet.label.length() > 0                // exact match: shortLabel + shortLabelNumber
+            && cuesheet.labelnum_short.compare(song.labelnum_short, Qt::CaseInsensitive) == 0
+            && cuesheet.label.compare(song.label, Qt::CaseInsensitive) == 0)
+        || (cuesheet.labelnum.length() > 0 && cuesheet.label.length() > 0
+            && song.title.length() > 0
+            && song.title.compare(cuesheet.label + "-" + cuesheet.labelnum, Qt::CaseInsensitive) == 0);
+}
+
+bool CuesheetMatchKeys::matches(const CuesheetMatchKeys &song, const CuesheetMatchKeys &cuesheet)
+{
+    return meetsMinimumCriteria(song, cuesheet)
+        || compareSortedWordListsForRelevance(song.words, cuesheet.words) > 0;
+}
+
+// -----------------------------------------------------------------
+CuesheetMatchIndex::CuesheetMatchIndex()
+{
+}
+
+void CuesheetMatchIndex::clear()
+{
+    slots.clear();
+    freeSlots.clear();
+    slotByPath.clear();
+    byBaseName.clear();
+    byTitle.clear();
+    byShortTitle.clear();
+    byLabelAndNumber.clear();
+    byLabelDashNumber.clear();
+    byWord.clear();
+    manyEmptyWords.clear();
+}
+
+void CuesheetMatchIndex::addPosting(QHash<QString, QVector<int> > &index, const QString &key, int slot)
+{
+    index[key].append(slot);
+}
+
+void CuesheetMatchIndex::removePosting(QHash<QString, QVector<int> > &index, const QString &key, int slot)
+{
+    QHash<QString, QVector<int> >::iterator i = index.find(key);
+    if (i != index.end()) {
+        i.value().removeOne(slot);
+        if (i.value().isEmpty()) {
+            index.erase(i);
+        }
+    }
+}
+
+// the keys here must match the minimum criteria in MainWindow::findPossibleCuesheets()
+void CuesheetMatchIndex::forEachKey(const CuesheetMatchKeys &keys, int slot, bool adding)
+{
+    void (*posting)(QHash<QString, QVector<int> > &, const QString &, int) = adding ? addPosting : removePosting;
+
+    posting(byBaseName, fold(keys.completeBaseName), slot);
+    posting(byTitle, fold(keys.title), slot);
+    if (keys.shortTitle.length() > 0) {
+        posting(byShortTitle, fold(keys.shortTitle), slot);
+    }
+    if (keys.labelnum_short.length() > 0 && keys.label.length() > 0) {
+        posting(byLabelAndNumber, fold(keys.label + "\t" + keys.labelnum_short), slot);
+    }
+    if (keys.labelnum.length() > 0 && keys.label.length() > 0) {
+        posting(byLabelDashNumber, fold(keys.label + "-" + keys.labelnum), slot);
+    }
+
+    // each distinct word once
+    QSet<QString> distinctWords;
+    for (const QString &word : keys.words) {
+        if (!word.isEmpty()) {
+            distinctWords.insert(fold(word));
+        }
+    }
+    for (const QString &word : distinctWords) {
+        posting(byWord, word, slot);
+    }
+
+    if (keys.emptyWords >= 2) {
+        if (adding) {
+            manyEmptyWords.append(slot);
+        } else {
+            manyEmptyWords.removeOne(slot);
+        }
+    }
+}
+
+void CuesheetMatchIndex::add(const LibraryEntry &entry)
+{
+    if (entry.kind != LibraryFileCuesheet || slotByPath.contains(entry.path)) {
+        return;
+    }
+
+    CuesheetMatchKeys keys = CuesheetMatchKeys::fromParts(entry.baseName, entry.label, entry.labelnum,
+                                                          entry.title, entry.shortTitle);
+    keys.path = entry.path;
+    keys.type = entry.type;
+    keys.extensionIndex = entry.cuesheetExtensionIndex;
+    add(keys);
+}
+
+void CuesheetMatchIndex::add(const CuesheetMatchKeys &keys)
+{
+    if (slotByPath.contains(keys.path)) {
+        return;
+    }
+
+    int slot;
+    if (freeSlots.isEmpty()) {
+        slot = slots.size();
+        slots.append(keys);
+    } else {
+        slot = freeSlots.takeLast();
+        slots[slot] = keys;
+    }
+    slotByPath.insert(keys.path, slot);
+    forEachKey(keys, slot, true);
+}
+
+void CuesheetMatchIndex::remove(const QString &path)
+{
+    QHash<QString, int>::iterator i = slotByPath.find(path);
+    if (i == slotByPath.end()) {
+        return;
+    }
+    int slot = i.value();
+    slotByPath.erase(i);
+
+    forEachKey(slots[slot], slot, false);
+    slots[slot] = CuesheetMatchKeys();
+    freeSlots.append(slot);
+}
+
+int CuesheetMatchIndex::update(const MusicLibrary &library)
+{
+    int changes = 0;
+
+    // remove the ones that are gone (or whose type folder changed)...
+    QStringList removed;
+    for (QHash<QString, int>::const_iterator i = slotByPath.constBegin(); i != slotByPath.constEnd(); ++i) {
+        int index = library.indexOfPath(i.key());
+        if (index < 0 || library.at(index).type != slots.at(i.value()).type) {
+            removed.append(i.key());
+        }
+    }
+    for (const QString &path : removed) {
+        remove(path);
+        changes++;
+    }
+
+    // ...and add the new ones
+    for (int i : library.indexesOfKind(LibraryFileCuesheet)) {
+        const LibraryEntry &entry = library.at(i);
+        if (!slotByPath.contains(entry.path)) {
+            add(entry);
+            changes++;
+        }
+    }
+    return changes;
+}
+
+static void insertAll(QSet<int> &found, const QVector<int> &slots)
+{
+    for (int slot : slots) {
+        found.insert(slot);
+    }
+}
+
+QVector<int> CuesheetMatchIndex::candidates(const CuesheetMatchKeys &song) const
+{
+    QSet<int> found;
+
+    insertAll(found, byBaseName.value(fold(song.completeBaseName)));
+    insertAll(found, byTitle.value(fold(song.title)));
+    if (song.shortTitle.length() > 0) {
+        insertAll(found, byShortTitle.value(fold(song.shortTitle)));
+    }
+    if (song.labelnum_short.length() > 0 && song.label.length() > 0) {
+        insertAll(found, byLabelAndNumber.value(fold(song.label + "\t" + song.labelnum_short)));
+    }
+    if (song.title.length() > 0) {
+        insertAll(found, byLabelDashNumber.value(fold(song.title)));
+    }
+
+    // compareSortedWordListsForRelevance() needs at least 2 words in common, so a
+    //   cuesheet that shares no (non-empty) word can only match on 2+ empty words
+    if (song.words.length() >= 2) {
+        for (const QString &word : song.words) {
+            if (!word.isEmpty()) {
+                insertAll(found, byWord.value(fold(word)));
+            }
+        }
+        if (song.emptyWords >= 2) {
+            insertAll(found, manyEmptyWords);
+        }
+    }
+
+    QVector<int> result;
+    result.reserve(found.size());
+    for (int slot : found) {
+        result.append(slot);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
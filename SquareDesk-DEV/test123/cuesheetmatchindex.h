@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef CUESHEETMATCHINDEX_H_INCLUDED
+#define CUESHEETMATCHINDEX_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+#include "libraryentry.h"
+
+QStringList splitIntoWords(const QString &str);
+int compareSortedWordListsForRelevance(const QStringList &l1, const QStringList l2);
+
+// Everything findPossibleCuesheets compares, for one song or one cuesheet, computed once.
+class CuesheetMatchKeys
+{
+public:
+    CuesheetMatchKeys() : extensionIndex(-1), emptyWords(0) {}
+
+    QString path;
+    QString type;
+    int extensionIndex;      // htm = 0, html = 1, txt = 2
+
+    QString completeBaseName;
+    QString label;
+    QString labelnum;
+    QString labelnum_short;  // labelnum without leading zeroes
+    QString title;
+    QString shortTitle;
+    QStringList words;       // splitIntoWords(completeBaseName), sorted
+    int emptyWords;          // number of "" in words (e.g. "(Patter)" at the end of the name)
+
+    static CuesheetMatchKeys fromParts(const QString &completeBaseName,
+                                       const QString &label, const QString &labelnum,
+                                       const QString &title, const QString &shortTitle);
+
+    // same name, title, short title or label + number (or the song is named after the label-number)
+    static bool meetsMinimumCriteria(const CuesheetMatchKeys &song, const CuesheetMatchKeys &cuesheet);
+    // meetsMinimumCriteria() or enough words in common
+    static bool matches(const CuesheetMatchKeys &song, const CuesheetMatchKeys &cuesheet);
+};
+
+// Inverted index over the cuesheets in the MusicLibrary, so that findPossibleCuesheets only
+//   has to score the cuesheets that could possibly match the song (same name, same title,
+//   same label + number, or at least one word in common), rather than every cuesheet.
+//
+// The index is keyed by path, so update() only touches the cuesheets that were added or
+//   removed since the last scan.
+class CuesheetMatchIndex
+{
+public:
+    CuesheetMatchIndex();
+
+    void clear();
+    int update(const MusicLibrary &library);  // returns the number of cuesheets added + removed
+    void add(const LibraryEntry &entry);
+    void add(const CuesheetMatchKeys &keys);  // keys.path must be unique
+    void remove(const QString &path);
+
+    int size() const { return slotByPath.size(); }
+
+    // every cuesheet that meets the minimum criteria, or that shares enough words to be
+    //   scored by compareSortedWordListsForRelevance() (a superset of the ones that will match)
+    QVector<int> candidates(const CuesheetMatchKeys &song) const;
+    const CuesheetMatchKeys &at(int slot) const { return slots.at(slot); }
+
+private:
+    static QString fold(const QString &s) { return s.toCaseFolded(); }
+    static void addPosting(QHash<QString, QVector<int> > &index, const QString &key, int slot);
+    static void removePosting(QHash<QString, QVector<int> > &index, const QString &key, int slot);
+    void forEachKey(const CuesheetMatchKeys &keys, int slot, bool adding);
+
+    QVector<CuesheetMatchKeys> slots;
+    QVector<int> freeSlots;
+    QHash<QString, int> slotByPath;
+
+    QHash<QString, QVector<int> > byBaseName;
+    QHash<QString, QVector<int> > byTitle;
+    QHash<QString, QVector<int> > byShortTitle;
+    QHash<QString, QVector<int> > byLabelAndNumber;     // label + "\t" + labelnum_short
+    QHash<QString, QVector<int> > byLabelDashNumber;    // label + "-" + labelnum (matches a song's title)
+    QHash<QString, QVector<int> > byWord;
+    QVector<int> manyEmptyWords;                        // cuesheets with 2+ empty words
+};
+
+#endif /* ifndef CUESHEETMATCHINDEX_H_INCLUDED */
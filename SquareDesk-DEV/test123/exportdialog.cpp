@@ -70,7 +70,7 @@ static void outputString(QTextStream &stream, const QString &str, bool quote)
     }
 }
 
-void exportSongList(QTextStream &stream, SongSettings &settings, QList<QString> *musicFilenames,
+void exportSongList(QTextStream &stream, SongSettings &settings, const QStringList &musicFilenames,
                     int outputFieldCount, enum ColumnExportData outputFields[],
                     char separator,
                     bool includeHeaderNames,
@@ -87,13 +87,8 @@ void exportSongList(QTextStream &stream, SongSettings &settings, QList<QString>
         stream << endl;
     }
     
-    QListIterator<QString> musicFilenameIter(*musicFilenames);
-    while (musicFilenameIter.hasNext())
+    for (const QString &filename : musicFilenames)
     {
-        QString s(musicFilenameIter.next());
-        QStringList sl1 = s.split("#!#");
-        QString filename = sl1[1];  // everything else
-
         SongSetting setting;
         if (settings.loadSettings(filename, setting))
         {
@@ -172,7 +167,7 @@ void exportSongList(QTextStream &stream, SongSettings &settings, QList<QString>
     } // end of while iterating through filenames
 }
 
-void ExportDialog::exportSongs(SongSettings &settings, QList<QString> *musicFilenames)
+void ExportDialog::exportSongs(SongSettings &settings, const QStringList &musicFilenames)
 {
     QString filename(ui->labelFileName->text());
     QFile file( filename );
@@ -50,7 +50,7 @@ class ExportDialog : public QDialog
 public:
     explicit ExportDialog(QWidget *parent = 0);
     ~ExportDialog();
-    void exportSongs(SongSettings &settings, QList<QString> *musicFilenames);
+    void exportSongs(SongSettings &settings, const QStringList &musicFilenames);
 
 private slots:
     void on_pushButtonChooseFile_clicked();
@@ -60,7 +60,7 @@ private:
     Ui::ExportDialog *ui;
 };
 
-void exportSongList(QTextStream &stream, SongSettings &settings, QList<QString> *musicFilenames,
+void exportSongList(QTextStream &stream, SongSettings &settings, const QStringList &musicFilenames,
                     int outputFieldCount, enum ColumnExportData outputFields[],
                     char separator,
                     bool includeHeaderNames,
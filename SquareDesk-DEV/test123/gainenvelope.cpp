@@ -0,0 +1,190 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "gainenvelope.h"
+#include <math.h>
+
+static const float kHalfPi = 1.57079632679f;
+
+// ------------------------------------------------------------------
+GainEnvelope::GainEnvelope() :
+    fadeDone(false)
+{
+    reset(44100.0f);
+}
+
+void GainEnvelope::reset(float hz)
+{
+    commands.clear();
+    fadeDone = false;
+
+    sampleRate = hz;
+    now = 0;
+    duckStage = kIdle;
+    duckGain = duckDepth = 1.0f;
+    duckStep = 0.0f;
+    holdUntil = 0;
+    releaseSeconds = 0.0f;
+    fadeGain = fadeFrom = fadeTo = 1.0f;
+    fadeFrames = fadePos = 0;
+    fadeNotify = false;
+}
+
+// ------------------------------------------------------------------
+void GainEnvelope::duck(float depth, float attack_sec, float hold_sec, float release_sec)
+{
+    Command command = { Command::kDuck, depth, attack_sec, hold_sec, release_sec, false };
+    commands.push(command);
+}
+
+void GainEnvelope::unduck(float release_sec)
+{
+    Command command = { Command::kUnduck, release_sec, 0.0f, 0.0f, 0.0f, false };
+    commands.push(command);
+}
+
+void GainEnvelope::fade(float from, float to, float seconds, bool notifyWhenDone)
+{
+    Command command = { Command::kFade, from, to, seconds, 0.0f, notifyWhenDone };
+    commands.push(command);
+}
+
+bool GainEnvelope::takeFadeDone()
+{
+    return fadeDone.exchange(false);
+}
+
+// ------------------------------------------------------------------
+// audio thread
+void GainEnvelope::apply(const Command &command)
+{
+    switch (command.type) {
+        case Command::kDuck: {
+            long long attack = static_cast<long long>(command.b * sampleRate);
+            long long hold = static_cast<long long>(command.c * sampleRate);
+            bool ducking = (duckStage == kAttack || duckStage == kHold);
+            duckDepth = (ducking && duckDepth < command.a ? duckDepth : command.a);  // the deepest one...
+            long long end = now + attack + hold;
+            holdUntil = (ducking && holdUntil > end ? holdUntil : end);             // ...until the last one is done
+            releaseSeconds = command.d;
+            if (duckGain > duckDepth) {
+                duckStage = kAttack;
+                duckStep = (duckDepth - duckGain) / static_cast<float>(attack > 0 ? attack : 1);
+            } else {
+                duckStage = kHold;  // already that far down (e.g. part way through a release)
+            }
+            break;
+        }
+        case Command::kUnduck:
+            if (duckStage != kIdle) {
+                startRelease(command.a);
+            }
+            break;
+        case Command::kFade:
+            fadeFrom = (command.a < 0.0f ? fadeGain : command.a);
+            fadeTo = command.b;
+            fadeFrames = static_cast<long long>(command.c * sampleRate);
+            fadePos = 0;
+            fadeNotify = command.notify;
+            fadeGain = fadeFrom;
+            if (fadeFrames <= 0) {
+                fadeGain = fadeTo;
+                if (fadeNotify) {
+                    fadeDone = true;
+                }
+            }
+            break;
+    }
+}
+
+void GainEnvelope::startRelease(float release_sec)
+{
+    long long release = static_cast<long long>(release_sec * sampleRate);
+    duckStage = kRelease;
+    duckStep = (1.0f - duckGain) / static_cast<float>(release > 0 ? release : 1);
+}
+
+int GainEnvelope::process(float *buffer, int frames, int channels)
+{
+    int framesAfterFade = -1;
+
+    for (const Command *command = commands.front(); command != nullptr; command = commands.front()) {
+        apply(*command);
+        if (command->type == Command::kFade && fadeNotify && fadeFrames <= 0) {
+            framesAfterFade = frames;  // a fade of length 0 is done before this buffer even starts
+        }
+        commands.pop();
+    }
+
+    if (duckStage == kIdle && fadePos >= fadeFrames && fadeGain == 1.0f) {
+        now += frames;
+        return framesAfterFade;  // nothing to do (almost always)
+    }
+
+    for (int f = 0; f < frames; f++, now++) {
+        switch (duckStage) {
+            case kAttack:
+                duckGain += duckStep;
+                if (duckGain <= duckDepth) {
+                    duckGain = duckDepth;
+                    duckStage = kHold;
+                }
+                break;
+            case kHold:
+                if (now >= holdUntil) {
+                    startRelease(releaseSeconds);
+                }
+                break;
+            case kRelease:
+                duckGain += duckStep;
+                if (duckGain >= 1.0f) {
+                    duckGain = 1.0f;
+                    duckStage = kIdle;
+                }
+                break;
+            case kIdle:
+                break;
+        }
+
+        if (fadePos < fadeFrames) {
+            float p = kHalfPi * static_cast<float>(++fadePos) / static_cast<float>(fadeFrames);
+            float shape = (fadeTo > fadeFrom ? sinf(p) : 1.0f - cosf(p));  // both go 0 -> 1
+            fadeGain = fadeFrom + (fadeTo - fadeFrom) * shape;
+            if (fadePos == fadeFrames) {
+                fadeGain = fadeTo;
+                if (fadeNotify) {
+                    fadeDone = true;
+                    framesAfterFade = frames - f - 1;
+                }
+            }
+        }
+
+        float gain = duckGain * fadeGain;
+        for (int c = 0; c < channels; c++) {
+            buffer[f * channels + c] *= gain;
+        }
+    }
+    return framesAfterFade;
+}
@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef GAINENVELOPE_H_INCLUDED
+#define GAINENVELOPE_H_INCLUDED
+
+#include "meterfeed.h"  // SpscRing
+#include <atomic>
+
+// Volume automation for one stream, run by the audio thread: ducking (under sound effects), and
+//   fades (fade out, fade in, and the two halves of a crossfade between songs).
+//
+// The UI thread just queues a command; the audio thread picks it up at the start of its next
+//   buffer, and from then on, everything is counted in samples.  So a duck's attack, hold and
+//   release, and the length of a fade, are exact, however late the UI thread is (e.g. while
+//   loadMusicList() has it busy).
+//
+// Ducks are linear ramps.  Fades are quarter sine/cosine curves, so that a fade out of one song
+//   and a fade in of the next one, at the same time, are an equal power crossfade.
+//
+// Plain C++ (no Qt, no BASS), like StreamDSP.
+class GainEnvelope
+{
+public:
+    GainEnvelope();
+
+    // only while no audio thread is using it (e.g. before the DSP is set on a new stream)
+    void reset(float sampleRate);
+
+    // -- one control thread (the UI thread) --
+    // down to depth (0.0 .. 1.0) over attack_sec, stay there for hold_sec, then back up over
+    //   release_sec.  Overlapping ducks are merged: the deepest depth, and the latest end of hold.
+    void duck(float depth, float attack_sec, float hold_sec, float release_sec);
+    void unduck(float release_sec);  // start the release now
+
+    // from (or from wherever it is now, if from < 0) to to, over seconds
+    void fade(float from, float to, float seconds, bool notifyWhenDone = false);
+    bool takeFadeDone();  // true (once) when a notifyWhenDone fade has finished
+
+    // -- audio thread --
+    // returns how many frames of this buffer come after the end of a notifyWhenDone fade, or -1
+    //   if none ended in this buffer
+    int process(float *buffer, int frames, int channels);
+
+private:
+    class Command
+    {
+    public:
+        enum Type { kDuck, kUnduck, kFade } type;
+        float a, b, c, d;
+        bool notify;
+    };
+    void apply(const Command &command);
+    void startRelease(float release_sec);
+
+    SpscRing<Command, 32> commands;
+    std::atomic<bool> fadeDone;
+
+    // audio thread only
+    enum DuckStage { kIdle, kAttack, kHold, kRelease };
+    float sampleRate;
+    long long now;           // samples processed so far (the envelope's clock)
+
+    DuckStage duckStage;
+    float duckGain, duckDepth, duckStep;
+    long long holdUntil;     // on the clock above
+    float releaseSeconds;
+
+    float fadeGain, fadeFrom, fadeTo;
+    long long fadeFrames, fadePos;  // fadePos == fadeFrames: not fading
+    bool fadeNotify;
+};
+
+#endif /* ifndef GAINENVELOPE_H_INCLUDED */
@@ -287,7 +287,7 @@ void ImportDialog::readImportFile(SongSettings &settings,
 }
 
 
-void ImportDialog::importSongs(SongSettings &settings, QList<QString>* musicFilenames)
+void ImportDialog::importSongs(SongSettings &settings, const QStringList &musicFilenames)
 {
     QString filename(ui->labelFileName->text());
 
@@ -311,12 +311,8 @@ void ImportDialog::importSongs(SongSettings &settings, QList<QString>* musicFile
     QMap<QString, SongSetting> songSettingsByFilename;
     readImportFile(settings, file, songSettingsByFilename);
 
-    QListIterator<QString> iter(*musicFilenames);
-    while (iter.hasNext())
+    for (const QString &filename_with_path : musicFilenames)
     {
-        QString s(iter.next());
-        QStringList sl1 = s.split("#!#");
-        QString filename_with_path(sl1[1]);
         QString altfilename(settings.removeRootDirs(filename_with_path));
         QFileInfo fi(filename_with_path);
         QString basename = fi.completeBaseName();
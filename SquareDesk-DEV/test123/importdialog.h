@@ -50,7 +50,7 @@ class ImportDialog : public QDialog
 public:
     explicit ImportDialog(QWidget *parent = 0);
     ~ImportDialog();
-    void importSongs(SongSettings &settings, QList<QString>* musicFilenames);
+    void importSongs(SongSettings &settings, const QStringList &musicFilenames);
 private:
     void readImportFile(SongSettings &settings, QFile &file,
                         QMap<QString, SongSetting> &songSettingsByFilename);
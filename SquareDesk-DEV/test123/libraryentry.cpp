@@ -0,0 +1,133 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "libraryentry.h"
+
+#include <QFileInfo>
+
+MusicLibrary::MusicLibrary()
+    : entries(), byType(), byPath()
+{
+}
+
+void MusicLibrary::clear()
+{
+    entries.clear();
+    for (int kind = 0; kind < LibraryFileKindCount; kind++) {
+        byKind[kind].clear();
+    }
+    byType.clear();
+    byPath.clear();
+    previousEntries.clear();
+}
+
+void MusicLibrary::beginRescan()
+{
+    QHash<QString, LibraryEntry> previous;
+    for (const LibraryEntry &entry : entries) {
+        if (entry.parsed) {
+            previous.insert(entry.path, entry);
+        }
+    }
+    clear();
+    previousEntries.swap(previous);
+}
+
+void MusicLibrary::endRescan()
+{
+    previousEntries.clear();
+}
+
+// true if path ends with "." + extension
+static bool hasExtension(const QString &path, const char *extension)
+{
+    int length = static_cast<int>(qstrlen(extension));
+    return path.length() > length &&
+           path.at(path.length() - length - 1) == QLatin1Char('.') &&
+           path.endsWith(QLatin1String(extension), Qt::CaseInsensitive);
+}
+
+LibraryFileKind MusicLibrary::kindForPath(const QString &path, int *cuesheetExtensionIndex)
+{
+    if (cuesheetExtensionIndex) {
+        *cuesheetExtensionIndex = -1;
+    }
+    for (size_t i = 0; i < sizeof(music_file_extensions) / sizeof(*music_file_extensions); ++i) {
+        if (hasExtension(path, music_file_extensions[i])) {
+            return LibraryFileMusic;
+        }
+    }
+    for (size_t i = 0; i < sizeof(cuesheet_file_extensions) / sizeof(*cuesheet_file_extensions); ++i) {
+        if (hasExtension(path, cuesheet_file_extensions[i])) {
+            if (cuesheetExtensionIndex) {
+                *cuesheetExtensionIndex = static_cast<int>(i);
+            }
+            return LibraryFileCuesheet;
+        }
+    }
+    return LibraryFileOther;
+}
+
+int MusicLibrary::append(const QString &type, const QString &path, bool guest)
+{
+    int index = entries.size();
+
+    LibraryEntry entry;
+    QHash<QString, QVector<int> >::iterator typeIndexes = byType.find(type);
+    if (typeIndexes == byType.end()) {
+        typeIndexes = byType.insert(type, QVector<int>());
+    }
+    entry.type = typeIndexes.key();  // implicitly shared, rather than one copy per file
+    entry.path = path;
+    entry.baseName = QFileInfo(path).completeBaseName();
+    entry.kind = kindForPath(path, &entry.cuesheetExtensionIndex);
+    entry.guest = guest;
+
+    QHash<QString, LibraryEntry>::const_iterator previous = previousEntries.constFind(path);
+    if (previous != previousEntries.constEnd()) {
+        entry.label = previous.value().label;
+        entry.labelnum = previous.value().labelnum;
+        entry.labelnum_extra = previous.value().labelnum_extra;
+        entry.title = previous.value().title;
+        entry.shortTitle = previous.value().shortTitle;
+        entry.parsed = true;
+    }
+
+    entries.append(entry);
+    typeIndexes.value().append(index);
+    byKind[entry.kind].append(index);
+    byPath.insert(path, index);
+
+    return index;
+}
+
+QStringList MusicLibrary::paths(LibraryFileKind kind) const
+{
+    QStringList result;
+    for (int i : byKind[kind]) {
+        result.append(entries.at(i).path);
+    }
+    return result;
+}
@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef LIBRARYENTRY_H_INCLUDED
+#define LIBRARYENTRY_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// The file types that findMusic picks up, without the dot (also the order of
+//   LibraryEntry::cuesheetExtensionIndex).
+// NOTE: must use Qt::CaseInsensitive compares for these
+static const char * const music_file_extensions[] = { "mp3", "wav", "m4a" };
+static const char * const cuesheet_file_extensions[] = { "htm", "html", "txt" };
+
+enum LibraryFileKind {
+    LibraryFileMusic = 0,   // mp3, wav, m4a
+    LibraryFileCuesheet,    // htm, html, txt (also dance programs and sd sequences, see type)
+    LibraryFileOther,
+    LibraryFileKindCount
+};
+
+// One file found under the music root (or guest root) by findMusic.
+class LibraryEntry
+{
+public:
+    LibraryEntry() : kind(LibraryFileOther), cuesheetExtensionIndex(-1), guest(false), parsed(false) {}
+
+    QString type;       // first subfolder under the root, e.g. "patter" (shared between entries of the same type)
+    QString path;       // full path, as found (before following aliases)
+    QString baseName;   // completeBaseName(), e.g. "RIV 307 - Going to Ceili (Patter)"
+    LibraryFileKind kind;
+    int cuesheetExtensionIndex;  // htm = 0, html = 1, txt = 2, otherwise -1
+
+    bool guest;
+
+    // from MainWindow::breakFilenameIntoParts(baseName), music and cuesheets only
+    bool parsed;        // false until these have been filled in
+    QString label;
+    QString labelnum;
+    QString labelnum_extra;
+    QString title;
+    QString shortTitle;
+};
+
+// All of the files that findMusic found, in one contiguous vector, with indexes by kind and
+//   by type, so that each consumer only looks at the entries it's interested in.
+class MusicLibrary
+{
+public:
+    MusicLibrary();
+
+    void clear();
+    void beginRescan();  // like clear(), but append() reuses the parsed names of files it saw last time
+    void endRescan();
+    int append(const QString &type, const QString &path, bool guest = false);  // returns the index
+
+    int size() const { return entries.size(); }
+    const LibraryEntry &at(int i) const { return entries.at(i); }
+    LibraryEntry &operator[](int i) { return entries[i]; }
+
+    const QVector<int> &indexesOfKind(LibraryFileKind kind) const { return byKind[kind]; }
+    QVector<int> indexesOfType(const QString &type) const { return byType.value(type); }
+    bool contains(const QString &path) const { return byPath.contains(path); }
+    int indexOfPath(const QString &path) const { return byPath.value(path, -1); }
+
+    QStringList paths(LibraryFileKind kind) const;
+
+    static LibraryFileKind kindForPath(const QString &path, int *cuesheetExtensionIndex = nullptr);
+
+private:
+    QVector<LibraryEntry> entries;
+    QVector<int> byKind[LibraryFileKindCount];
+    QHash<QString, QVector<int> > byType;
+    QHash<QString, int> byPath;
+    QHash<QString, LibraryEntry> previousEntries;  // only between beginRescan() and endRescan()
+};
+
+#endif /* ifndef LIBRARYENTRY_H_INCLUDED */
@@ -0,0 +1,283 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "loopengine.h"
+#include "bass_fx.h"
+#include <QDebug>
+#include <algorithm>
+#include <math.h>
+
+const double LoopEngine::kCrossfadeSeconds = 0.010;
+
+static const double kPi = 3.14159265358979323846;
+
+// ------------------------------------------------------------------
+LoopEngine::LoopEngine() :
+    source(0),
+    helper(0),
+    channels(2),
+    freq(44100),
+    crossfadeFrames(0),
+    jumpSync(0),
+    crossfadeDSP(0),
+    to_bytes(0),
+    jumpsLeft(-1),
+    tailFrames(0),
+    fadePos(0),
+    fadeFrames(0)
+{
+}
+
+LoopEngine::~LoopEngine()
+{
+    detach();
+}
+
+// ------------------------------------------------------------------
+void LoopEngine::attach(HSTREAM tempoStream, const char *path)
+{
+    detach();
+
+    source = BASS_FX_TempoGetSource(tempoStream);
+    filepath = path;
+
+    BASS_CHANNELINFO info;
+    if (source == 0 || !BASS_ChannelGetInfo(source, &info) || !(info.flags & BASS_SAMPLE_FLOAT)) {
+        qDebug() << "LoopEngine: can't loop " << path;
+        source = 0;
+        return;
+    }
+    channels = static_cast<int>(info.chans);
+    freq = info.freq;
+    crossfadeFrames = static_cast<int>(kCrossfadeSeconds * freq);
+
+    // allocated once per song, so that the decoder thread never allocates
+    tail.assign(static_cast<size_t>(crossfadeFrames * channels), 0.0f);
+    fading.assign(tail.size(), 0.0f);
+    tailFrames = 0;
+    fadePos = fadeFrames = 0;
+
+    // sees the decoded audio before the tempo stream does, including the audio right after a jump
+    crossfadeDSP = BASS_ChannelSetDSP(source, crossfadeDSPProc, this, 0);
+}
+
+void LoopEngine::detach()
+{
+    // (if the stream has already been freed, the sync and the DSP went with it, and these just fail)
+    clear();
+    if (source != 0) {
+        BASS_ChannelRemoveDSP(source, crossfadeDSP);
+    }
+    crossfadeDSP = 0;
+    source = 0;
+    if (helper != 0) {
+        BASS_StreamFree(helper);
+        helper = 0;
+    }
+}
+
+// ------------------------------------------------------------------
+bool LoopEngine::set(double from_sec, double to_sec, int repeats)
+{
+    clear();
+    if (source == 0 || from_sec <= to_sec || to_sec < 0.0 || repeats == 0) {
+        return false;
+    }
+
+    QWORD from = BASS_ChannelSeconds2Bytes(source, from_sec);
+    QWORD to = BASS_ChannelSeconds2Bytes(source, to_sec);
+
+    if (openHelper()) {
+        QMutexLocker locker(&tailMutex);
+        tailFrames = decode(from, tail.data(), crossfadeFrames);
+    }
+
+    to_bytes = to;
+    jumpsLeft = repeats;
+    jumpSync = BASS_ChannelSetSync(source, BASS_SYNC_POS | BASS_SYNC_MIXTIME, from, jumpSyncProc, this);
+    return (jumpSync != 0);
+}
+
+void LoopEngine::clear()
+{
+    if (jumpSync != 0) {
+        BASS_ChannelRemoveSync(source, jumpSync);
+        jumpSync = 0;
+    }
+}
+
+// ------------------------------------------------------------------
+// decoder thread
+void CALLBACK LoopEngine::jumpSyncProc(HSYNC handle, DWORD channel, DWORD data, void *user)
+{
+    Q_UNUSED(handle)
+    Q_UNUSED(data)
+    LoopEngine *loop = static_cast<LoopEngine *>(user);
+
+    int jumps = loop->jumpsLeft;
+    if (jumps == 0) {
+        return;  // done repeating, so play on through to the end
+    }
+    if (jumps > 0) {
+        loop->jumpsLeft = jumps - 1;
+    }
+
+    BASS_ChannelSetPosition(channel, loop->to_bytes, BASS_POS_BYTE);
+
+    // if the UI thread is changing the loop right now, just jump without the crossfade
+    loop->fadePos = loop->fadeFrames = 0;
+    if (loop->tailMutex.tryLock()) {
+        std::copy(loop->tail.begin(), loop->tail.begin() + loop->tailFrames * loop->channels, loop->fading.begin());
+        loop->fadeFrames = loop->tailFrames;
+        loop->tailMutex.unlock();
+    }
+}
+
+void CALLBACK LoopEngine::crossfadeDSPProc(HDSP handle, DWORD channel, void *buffer, DWORD length, void *user)
+{
+    Q_UNUSED(handle)
+    Q_UNUSED(channel)
+    LoopEngine *loop = static_cast<LoopEngine *>(user);
+    if (loop->fadePos >= loop->fadeFrames) {
+        return;  // not crossfading (almost always)
+    }
+
+    float *d = static_cast<float *>(buffer);
+    const int ch = loop->channels;
+    int frames = static_cast<int>(length / (sizeof(float) * ch));
+    int n = (loop->fadeFrames - loop->fadePos < frames ? loop->fadeFrames - loop->fadePos : frames);
+
+    const float *old = loop->fading.data() + loop->fadePos * ch;
+    for (int f = 0; f < n; f++) {
+        double theta = (kPi / 2.0) * (loop->fadePos + f + 0.5) / loop->crossfadeFrames;
+        float fadeIn = static_cast<float>(sin(theta));    // sin^2 + cos^2 == 1, i.e. equal power
+        float fadeOut = static_cast<float>(cos(theta));
+        for (int c = 0; c < ch; c++) {
+            d[f * ch + c] = d[f * ch + c] * fadeIn + old[f * ch + c] * fadeOut;
+        }
+    }
+    loop->fadePos += n;
+}
+
+// ------------------------------------------------------------------
+bool LoopEngine::openHelper()
+{
+    if (helper == 0 && !filepath.empty()) {
+        // PRESCAN, so that seeking is exact (the same as the main decoder)
+        helper = BASS_StreamCreateFile(false, filepath.c_str(), 0, 0,
+                                       BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT | BASS_STREAM_PRESCAN);
+        if (helper == 0) {
+            qDebug() << "ERROR " << BASS_ErrorGetCode() << " in LoopEngine::openHelper()";
+        }
+    }
+    return (helper != 0);
+}
+
+// returns the number of frames decoded, and zero fills the rest
+int LoopEngine::decode(QWORD position_bytes, float *out, int frames)
+{
+    int got = 0;
+    if (BASS_ChannelSetPosition(helper, position_bytes, BASS_POS_BYTE)) {
+        while (got < frames) {
+            DWORD bytes = BASS_ChannelGetData(helper, out + got * channels,
+                                              static_cast<DWORD>((frames - got) * channels * sizeof(float)) | BASS_DATA_FLOAT);
+            if (bytes == static_cast<DWORD>(-1) || bytes == 0) {
+                break;  // end of the file
+            }
+            got += static_cast<int>(bytes / (channels * sizeof(float)));
+        }
+    }
+    std::fill(out + got * channels, out + frames * channels, 0.0f);
+    return got;
+}
+
+// rise in energy per hop (i.e. where the beats are)
+void LoopEngine::onsetEnvelope(double start_sec, double length_sec, double hop_sec, std::vector<float> *envelope)
+{
+    int hopFrames = static_cast<int>(hop_sec * freq);
+    int hops = static_cast<int>(length_sec / hop_sec);
+    std::vector<float> audio(static_cast<size_t>(hops * hopFrames * channels));
+    decode(BASS_ChannelSeconds2Bytes(helper, start_sec > 0.0 ? start_sec : 0.0), audio.data(), hops * hopFrames);
+
+    envelope->assign(static_cast<size_t>(hops), 0.0f);
+    float previous = 0.0f;
+    for (int h = 0; h < hops; h++) {
+        float energy = 0.0f;
+        const float *d = audio.data() + h * hopFrames * channels;
+        for (int i = 0; i < hopFrames * channels; i++) {
+            energy += d[i] * d[i];
+        }
+        (*envelope)[h] = (energy > previous ? energy - previous : 0.0f);
+        previous = energy;
+    }
+}
+
+// ------------------------------------------------------------------
+double LoopEngine::beatAlignedFrom(double from_sec, double to_sec, double bpm)
+{
+    if (bpm <= 0.0 || from_sec <= to_sec || source == 0 || !openHelper()) {
+        return from_sec;
+    }
+
+    const double beat_sec = 60.0 / bpm;
+    double beats = floor((from_sec - to_sec) / beat_sec + 0.5);
+    if (beats < 1.0) {
+        return from_sec;
+    }
+    double center_sec = to_sec + beats * beat_sec;
+
+    // what will be heard right after the jump, vs. what would have been heard at each candidate
+    //   "from" within half a beat of the center (and of from_sec: the center is already up to half
+    //   a beat away from it, so the two half beats would add up to a whole one)
+    const double hop_sec = 0.005;
+    const double window_sec = 4.0;
+    std::vector<float> after, candidates;
+    onsetEnvelope(to_sec, window_sec, hop_sec, &after);
+    onsetEnvelope(center_sec - beat_sec / 2.0, window_sec + beat_sec, hop_sec, &candidates);
+
+    int lags = static_cast<int>(candidates.size()) - static_cast<int>(after.size());
+    int bestLag = lags / 2;  // i.e. center_sec
+    double bestScore = 0.0;
+    for (int lag = 0; lag < lags; lag++) {
+        if (fabs(center_sec - beat_sec / 2.0 + lag * hop_sec - from_sec) > beat_sec / 2.0) {
+            continue;
+        }
+        double score = 0.0;
+        for (size_t i = 0; i < after.size(); i++) {
+            score += static_cast<double>(after[i]) * candidates[lag + i];
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    double aligned_sec = center_sec - beat_sec / 2.0 + bestLag * hop_sec;
+    double length_sec = BASS_ChannelBytes2Seconds(helper, BASS_ChannelGetLength(helper, BASS_POS_BYTE));
+    if (aligned_sec + kCrossfadeSeconds >= length_sec) {
+        return from_sec;  // too close to the end of the song
+    }
+    return aligned_sec;
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef LOOPENGINE_H_INCLUDED
+#define LOOPENGINE_H_INCLUDED
+
+#include "bass.h"
+#include <QMutex>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Seamless looping for the music stream (e.g. patter).
+//
+// The jump happens on the decoder (the source of the tempo stream), in a mixtime sync, so it
+//   is sample accurate, and it happens before the tempo/pitch processing.  So the tempo and
+//   pitch FX just see one continuous stream, and the loop points are in the song's own
+//   timeline, whatever the tempo is.
+//
+// To avoid the click at the jump, the first few ms after the jump are an equal-power crossfade
+//   from the audio that would have followed the "from" point, to the audio at the "to" point.
+//   That audio is decoded ahead of time (by a second decoder on the same file) when the loop is set.
+class LoopEngine
+{
+public:
+    static const double kCrossfadeSeconds;
+
+    LoopEngine();
+    ~LoopEngine();
+
+    void attach(HSTREAM tempoStream, const char *filepath);  // call once per new stream
+    void detach();  // (the stream can go on playing without the loop, e.g. while it crossfades out)
+
+    // when playback gets to from_sec, jump back to to_sec (at most repeats times, or forever if -1)
+    bool set(double from_sec, double to_sec, int repeats = -1);
+    void clear();
+
+    // Moves from_sec (by at most half a beat) so that the loop is a whole number of beats long,
+    //   and the beats right after the jump line up with the ones that would have been there.
+    double beatAlignedFrom(double from_sec, double to_sec, double bpm);
+
+private:
+    static void CALLBACK jumpSyncProc(HSYNC handle, DWORD channel, DWORD data, void *user);
+    static void CALLBACK crossfadeDSPProc(HDSP handle, DWORD channel, void *buffer, DWORD length, void *user);
+
+    bool openHelper();
+    int decode(QWORD position_bytes, float *out, int frames);  // with the helper
+    void onsetEnvelope(double start_sec, double length_sec, double hop_sec, std::vector<float> *envelope);
+
+    HSTREAM source;        // the decoder underneath the tempo stream
+    HSTREAM helper;        // our own decoder on the same file (opened when first needed)
+    std::string filepath;
+    int channels;
+    DWORD freq;
+    int crossfadeFrames;
+
+    HSYNC jumpSync;
+    HDSP crossfadeDSP;
+    std::atomic<unsigned long long> to_bytes;
+    std::atomic<int> jumpsLeft;  // -1 == forever
+
+    QMutex tailMutex;         // protects tail (the decoder thread only ever tries it)
+    std::vector<float> tail;  // the crossfadeFrames right after the "from" point
+    int tailFrames;
+
+    // decoder thread only
+    std::vector<float> fading;
+    int fadePos;
+    int fadeFrames;
+};
+
+#endif /* ifndef LOOPENGINE_H_INCLUDED */
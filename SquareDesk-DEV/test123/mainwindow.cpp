@@ -44,6 +44,7 @@
 #include <QTextDocument>
 #include <QTextDocumentFragment>
 #include <QThread>
+#include <QtConcurrent>
 #include <QStandardItemModel>
 #include <QStandardItem>
 #include <QWidget>
@@ -63,7 +64,7 @@
 #include "songhistoryexportdialog.h"
 #include "calllistcheckbox.h"
 #include "sessioninfo.h"
-#include "songtitlelabel.h"
+#include "songtitledelegate.h"
 #include "tablewidgettimingitem.h"
 #include "danceprograms.h"
 #include "startupwizard.h"
@@ -204,8 +205,7 @@ using namespace TagLib;
 
 // GLOBALS:
 static bass_audio cBass;
-static const char *music_file_extensions[] = { "mp3", "wav", "m4a" };     // NOTE: must use Qt::CaseInsensitive compares for these
-static const char *cuesheet_file_extensions[] = { "htm", "html", "txt" }; // NOTE: must use Qt::CaseInsensitive compares for these
+static const double kNextSongCrossfade_sec = 3.0;  // Next Playlist Item, when it autostarts the next song
 static QString title_tags_prefix("&nbsp;<span style=\"background-color:%1; color: %2;\"> ");
 static QString title_tags_suffix(" </span>");
 static QRegularExpression title_tags_remover("(\\&nbsp\\;)*\\<\\/?span( .*?)?>");
@@ -537,10 +537,32 @@ MainWindow::MainWindow(QWidget *parent) :
 
     ui->songTable->clearSelection();
     ui->songTable->clearFocus();
+    ui->songTable->setItemDelegateForColumn(kTitleCol, new SongTitleDelegate(ui->songTable));  // title + tags, without a QLabel per row
+
+    // the search index is by row, so it has to be rebuilt when the rows change
+    QAbstractItemModel *songTableModel = ui->songTable->model();
+    connect(songTableModel, &QAbstractItemModel::rowsInserted, this, &MainWindow::songTableRowsChanged);
+    connect(songTableModel, &QAbstractItemModel::rowsRemoved, this, &MainWindow::songTableRowsChanged);
+    connect(songTableModel, &QAbstractItemModel::layoutChanged, this, &MainWindow::songTableRowsChanged);
+    connect(songTableModel, &QAbstractItemModel::modelReset, this, &MainWindow::songTableRowsChanged);
+    connect(songTableModel, &QAbstractItemModel::dataChanged, this, &MainWindow::songTableDataChanged);
 
     //Create Bass audio system
     cBass.Init();
 
+    // songs on slow media (USB sticks, guest volumes, network shares) can be read into memory before they play
+    //   (off by default, until there is a preference for it)
+    cBass.SetPreloadMode(static_cast<SongPreloader::Mode>(prefsManager.GetpreloadSongsMode()),
+                         static_cast<qint64>(prefsManager.GetpreloadSongsBudgetMB()) * 1024 * 1024);
+
+    // BPM and start/end of song detection runs in the background
+    connect(&songAnalyzer, &SongAnalyzer::analysisReady,
+            this, &MainWindow::songAnalysisReady);
+
+    // offline rendering of the playlist runs in the background too
+    connect(&renderWatcher, &QFutureWatcher<QList<RenderResult> >::finished,
+            this, &MainWindow::renderPlaylistFinished);
+
     //Set UI update
     cBass.SetVolume(100);
     currentVolume = 100;
@@ -550,7 +572,8 @@ MainWindow::MainWindow(QWidget *parent) :
     // VU Meter -----
     vuMeterTimer = new QTimer(this);
     connect(vuMeterTimer, SIGNAL(timeout()), this, SLOT(on_vuMeterTimerTick()));
-    vuMeterTimer->start(50);           // adjust from GUI with timer->setInterval(newValue)
+    vuMeterTimer->start(16);           // ~60/sec, display rate (adjust from GUI with timer->setInterval(newValue))
+    vuMeterIdleTicks = 0;
 
     vuMeter = new LevelMeter(this);
     ui->gridLayout_2->addWidget(vuMeter, 1,5);  // add it to the layout in the right spot
@@ -571,8 +594,6 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->gridLayout_2->setAlignment(analogClock, Qt::AlignHCenter);  // center the clock horizontally
 
     // where is the root directory where all the music is stored?
-    pathStack = new QList<QString>();
-
     musicRootPath = prefsManager.GetmusicPath();
     guestRootPath = ""; // initially, no guest music
     guestVolume = "";   // and no guest volume present
@@ -587,29 +608,21 @@ MainWindow::MainWindow(QWidget *parent) :
 
     t.elapsed(__LINE__);
 
+    // ---------------------------------------
+    // let's watch for changes in the musicDir (the directories come from findMusic's
+    //   directory index, see updateMusicRootWatcher()).  Changes come in bursts
+    //   (e.g. copying an album), so wait for things to settle down before rescanning.
+    musicRootModifiedTimer = new QTimer(this);
+    musicRootModifiedTimer->setSingleShot(true);
+    musicRootModifiedTimer->setInterval(500);
+    connect(musicRootModifiedTimer, SIGNAL(timeout()), this, SLOT(musicRootModified()));
+    QObject::connect(&musicRootWatcher, SIGNAL(directoryChanged(QString)), musicRootModifiedTimer, SLOT(start()));
+
 #define DISABLEFILEWATCHER 1
 
 #ifndef DISABLEFILEWATCHER
     PerfTimer t2("filewatcher init", __LINE__);
 
-    // ---------------------------------------
-    // let's watch for changes in the musicDir
-    QDirIterator it(musicRootPath, QDir::Dirs | QDir::NoSymLinks | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-    QRegExp ignoreTheseDirs("/(reference|choreography|notes|playlists|sd|soundfx|lyrics)");
-    while (it.hasNext()) {
-        QString aPath = it.next();
-        if (ignoreTheseDirs.indexIn(aPath) == -1) {
-            musicRootWatcher.addPath(aPath); // watch for add/deletes to musicDir and interesting subdirs
-//            qDebug() << "adding to musicRootWatcher: " << aPath;
-        }
-        t.elapsed(__LINE__);
-    }
-
-    t.elapsed(__LINE__);
-
-    musicRootWatcher.addPath(musicRootPath);  // let's not forget the musicDir itself
-    QObject::connect(&musicRootWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(musicRootModified(QString)));
-
     // make sure that the "downloaded" directory exists, so that when we sync up with the Cloud,
     //   it will cause a rescan of the songTable and dropdown
 
@@ -1152,8 +1165,6 @@ MainWindow::MainWindow(QWidget *parent) :
         ui->action20_seconds->setChecked(true);
     }
 
-    lastSongTableRowSelected = -1;  // meaning "no selection"
-
     ui->pushButtonCueSheetEditSave->hide();   // the two save buttons are now invisible
     ui->pushButtonCueSheetEditSaveAs->hide();
     ui->pushButtonEditLyrics->show();  // and the "unlock for editing" button shows up!
@@ -1162,18 +1173,41 @@ MainWindow::MainWindow(QWidget *parent) :
 
 }
 
-void MainWindow::musicRootModified(QString s)
+void MainWindow::musicRootModified()
 {
-    Q_UNUSED(s);
     Qt::SortOrder sortOrder(ui->songTable->horizontalHeader()->sortIndicatorOrder());
     int sortSection(ui->songTable->horizontalHeader()->sortIndicatorSection());
     // reload the musicTable.  Note that it will switch to default sort order.
     //   TODO: At some point, this probably should save the sort order, and then restore it.
-    findMusic(musicRootPath,"","main", true);  // get the filenames from the user's directories
+    // The directory index makes this incremental: only the directories that changed are listed again,
+    //   and the database is already open.
+    findMusic(musicRootPath, guestRootPath, guestMode, false);  // get the filenames from the user's directories
     loadMusicList(); // and filter them into the songTable
     ui->songTable->horizontalHeader()->setSortIndicator(sortSection, sortOrder);
 }
 
+// watch every directory in the music directory index, except the ones that don't hold music
+void MainWindow::updateMusicRootWatcher()
+{
+    // (.squaredesk holds the database and the directory index, which change on every rescan)
+    QRegExp ignoreTheseDirs("/(reference|choreography|notes|playlists|sd|soundfx|lyrics|\\.squaredesk)");
+
+    QStringList watchedDirs = musicRootWatcher.directories();
+    if (!watchedDirs.isEmpty()) {
+        musicRootWatcher.removePaths(watchedDirs);
+    }
+
+    QStringList dirs;
+    for (const QString &aPath : musicDirectoryIndex.directories()) {
+        if (aPath == musicRootPath || ignoreTheseDirs.indexIn(aPath.mid(musicRootPath.length())) == -1) {
+            dirs.append(aPath);  // watch for add/deletes to musicDir and interesting subdirs
+        }
+    }
+    if (!dirs.isEmpty()) {
+        musicRootWatcher.addPaths(dirs);
+    }
+}
+
 void MainWindow::changeApplicationState(Qt::ApplicationState state)
 {
     currentApplicationState = state;
@@ -1805,20 +1839,6 @@ void MainWindow::on_pushButtonCueSheetEditLyrics_clicked(bool checked)
 //    showHTML(__FUNCTION__);
 }
 
-static bool isFileInPathStack(QList<QString> *pathStack, const QString &checkFilename)
-{
-    QListIterator<QString> iter(*pathStack);
-    while (iter.hasNext()) {
-        QString s = iter.next();
-        QStringList sl1 = s.split("#!#");
-        QString type = sl1[0];  // the type (of original pathname, before following aliases)
-        QString filename = sl1[1];  // everything else
-        if (filename == checkFilename)
-            return true;
-    }
-    return false;
-}
-
 // This function is called to write out the tidied/semantically-processed HTML to a file.
 // If SAVE or SAVE AS..., then the file is read in again from disk, in case there are round-trip problems.
 //
@@ -1861,13 +1881,14 @@ void MainWindow::writeCuesheet(QString filename)
             stream.flush();
         }
 
-        if (!isFileInPathStack(pathStack, filename))
+        if (!musicLibrary.contains(filename))
         {
             QFileInfo fi(filename);
             QStringList section = fi.path().split("/");
             QString type = section[section.length()-1];  // must be the last item in the path
-//            qDebug() << "writeCuesheet() adding " + type + "#!#" + filename + " to pathStack";
-            pathStack->append(type + "#!#" + filename);
+//            qDebug() << "writeCuesheet() adding " + type + ":" + filename + " to musicLibrary";
+            addToMusicLibrary(type, filename, false);
+            cuesheetMatchIndex.add(musicLibrary.at(musicLibrary.indexOfPath(filename)));
         }
     }
 #else
@@ -2431,6 +2452,10 @@ void MainWindow::on_actionShow_All_Ages_triggered(bool checked)
 // ----------------------------------------------------------------------
 MainWindow::~MainWindow()
 {
+    // the renders use BASS, so they have to stop before it does
+    offlineRenderer.cancel();
+    renderWatcher.waitForFinished();
+
     // Just before the app quits, save the current playlist state in "current.m3u", and it will be reloaded
     //   when the app starts up again.
     // Save the current playlist state to ".squaredesk/current.m3u".  Tempo/pitch are NOT saved here.
@@ -2507,8 +2532,25 @@ void MainWindow::on_loopButton_toggled(bool checked)
 //        qDebug() << "songLength: " << songLength << ", Intro: " << ui->seekBar->GetIntro();
 
 //        cBass.SetLoop(songLength * 0.9, songLength * 0.1); // FIX: use parameters in the MP3 file
-        cBass.SetLoop(songLength * static_cast<double>(ui->seekBar->GetOutro()),
-                      songLength * static_cast<double>(ui->seekBar->GetIntro()));
+        double outro_sec = cBass.SetLoop(songLength * static_cast<double>(ui->seekBar->GetOutro()),
+                                         songLength * static_cast<double>(ui->seekBar->GetIntro()));
+
+        // the end of the loop may have been moved a little, so that the beats line up across
+        //   the jump, so put the marker where the jump really is
+        if (songLength > 0.0) {
+            double outro = outro_sec / songLength;
+            if (outro != ui->seekBar->GetOutro()) {
+                ui->seekBarCuesheet->SetOutro(outro);
+                ui->seekBar->SetOutro(outro);
+                ui->seekBarCuesheet->update();
+                ui->seekBar->update();
+
+                // and in the time field, so that it agrees with the marker (without moving the loop again)
+                ui->dateTimeEditOutroTime->blockSignals(true);
+                ui->dateTimeEditOutroTime->setTime(QTime(0,0,0,0).addMSecs(static_cast<int>(1000.0*outro_sec+0.5))); // milliseconds
+                ui->dateTimeEditOutroTime->blockSignals(false);
+            }
+        }
     }
     else {
         ui->actionLoop->setChecked(false);
@@ -3510,11 +3552,18 @@ void MainWindow::on_UIUpdateTimerTick(void)
 // ----------------------------------------------------------------------
 void MainWindow::on_vuMeterTimerTick(void)
 {
+    // true RMS and peak, measured by the audio thread as the music went through the DSP
+    //   (before the volume slider, which is applied after that)
     double currentVolumeSlider = ui->volumeSlider->value();
-    int level = cBass.StreamGetVuMeter();
-    double levelF = (currentVolumeSlider/100.0)*level/32768.0;
-    // TODO: iff music is playing.
-    vuMeter->levelChanged(levelF/2.0,levelF,256);  // 10X/sec, update the vuMeter
+    MeterBlock levels;
+    if (cBass.StreamReadMeter(&levels)) {
+        double volume = currentVolumeSlider/100.0;
+        vuMeter->levelChanged(volume*levels.rms, volume*levels.peak, levels.frames);
+        vuMeterIdleTicks = 0;
+    } else if (++vuMeterIdleTicks > 6) {
+        // nothing new for ~100ms (stopped, paused, or no song), so let the meter fall back to zero
+        vuMeter->levelChanged(0.0, 0.0, 256);
+    }
 }
 
 // --------------
@@ -3530,6 +3579,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
         on_actionAutostart_playback_triggered();  // write AUTOPLAY setting back
         event->accept();  // OK to close, if user said "OK" or "SAVE"
         saveCurrentSongSettings();
+        songAnalyzer.cancelBackgroundWork();  // don't wait for the whole library to be analyzed
 
         // as per http://doc.qt.io/qt-5.7/restoring-geometry.html
         prefsManager.MySettings.setValue("lastCuesheetSavePath", lastCuesheetSavePath);
@@ -4176,93 +4226,6 @@ static bool CompareCuesheetWithRanking(CuesheetWithRanking *a, CuesheetWithRanki
     return a->score > b->score;
 }
 
-// -----------------------------------------------------------------
-QStringList splitIntoWords(const QString &str)
-{
-    static QRegExp regexNotAlnum(QRegExp("\\W+"));
-
-    QStringList words = str.split(regexNotAlnum);
-
-    static QRegularExpression LetterNumber("[A-Z][0-9]|[0-9][A-Z]"); // do we need to split?  Most of the time, no.
-    QRegularExpressionMatch quickmatch(LetterNumber.match(str));
-
-    if (quickmatch.hasMatch()) {
-        static QRegularExpression regexLettersAndNumbers("^([A-Z]+)([0-9].*)$");
-        static QRegularExpression regexNumbersAndLetters("^([0-9]+)([A-Z].*)$");
-//        qDebug() << "quickmatch!";
-        // we gotta split it one word at a time
-//        words = str.split(regexNotAlnum);
-        for (int i = 0; i < words.length(); ++i)
-        {
-            bool splitFurther = true;
-
-            while (splitFurther)
-            {
-                splitFurther = false;
-                QRegularExpressionMatch match(regexLettersAndNumbers.match(words[i]));
-                if (match.hasMatch())
-                {
-                    words.append(match.captured(1));
-                    words[i] = match.captured(2);
-                    splitFurther = true;
-                }
-                match = regexNumbersAndLetters.match(words[i]);
-                if (match.hasMatch())
-                {
-                    splitFurther = true;
-                    words.append(match.captured(1));
-                    words[i] = match.captured(2);
-                }
-            }
-        }
-    }
-    // else no splitting needed (e.g. it's already split, as is the case for most cuesheets)
-    //   so we skip the per-word splitting, and go right to sorting
-    words.sort(Qt::CaseInsensitive);
-    return words;
-}
-
-int compareSortedWordListsForRelevance(const QStringList &l1, const QStringList l2)
-{
-    int i1 = 0, i2 = 0;
-    int score = 0;
-
-    while (i1 < l1.length() &&  i2 < l2.length())
-    {
-        int comp = l1[i1].compare(l2[i2], Qt::CaseInsensitive);
-
-        if (comp == 0)
-        {
-            ++score;
-            ++i1;
-            ++i2;
-        }
-        else if (comp < 0)
-        {
-            ++i1;
-        }
-        else
-        {
-            ++i2;
-        }
-    }
-
-    if (l1.length() >= 2 && l2.length() >= 2 &&
-        (
-            (score > ((l1.length() + l2.length()) / 4))
-            || (score >= l1.length())                       // all of l1 words matched something in l2
-            || (score >= l2.length())                       // all of l2 words matched something in l1
-            || score >= 4)
-        )
-    {
-        QString s1 = l1.join("-");
-        QString s2 = l2.join("-");
-        return score * 500 + 100 * (abs(l1.length()) - l2.length());
-    }
-    else
-        return 0;
-}
-
 // TODO: the match needs to be a little fuzzier, since RR103B - Rocky Top.mp3 needs to match RR103 - Rocky Top.html
 void MainWindow::findPossibleCuesheets(const QString &MP3Filename, QStringList &possibleCuesheets)
 {
@@ -4288,60 +4251,19 @@ void MainWindow::findPossibleCuesheets(const QString &MP3Filename, QStringList &
     breakFilenameIntoParts(mp3CompleteBaseName, mp3Label, mp3Labelnum, mp3Labelnum_extra, mp3Title, mp3ShortTitle);
     QList<CuesheetWithRanking *> possibleRankings;
 
-    QStringList mp3Words = splitIntoWords(mp3CompleteBaseName);
-    mp3Labelnum_short = mp3Labelnum;
-    while (mp3Labelnum_short.length() > 0 && mp3Labelnum_short[0] == '0')
-    {
-        mp3Labelnum_short.remove(0,1);
-    }
-
-//    QList<QString> extensions;
-//    QString dot(".");
-//    for (size_t i = 0; i < sizeof(cuesheet_file_extensions) / sizeof(*cuesheet_file_extensions); ++i)
-//    {
-//        extensions.append(dot + cuesheet_file_extensions[i]);
-//    }
+    CuesheetMatchKeys mp3Keys = CuesheetMatchKeys::fromParts(mp3CompleteBaseName, mp3Label, mp3Labelnum, mp3Title, mp3ShortTitle);
+    const QStringList &mp3Words = mp3Keys.words;
+    mp3Labelnum_short = mp3Keys.labelnum_short;
 
     t.elapsed(__LINE__);
 
-    QListIterator<QString> iter(*pathStack);
-    while (iter.hasNext()) {
-
-        QString s = iter.next();
-
-//        // Is this a file extension we recognize as a cuesheet file?
-//        QListIterator<QString> extensionIterator(extensions);
-//        bool foundExtension = false;
-//        while (extensionIterator.hasNext())
-//        {
-//            extensionIndex++;
-//            QString extension(extensionIterator.next());
-//            if (s.endsWith(extension))
-//            {
-//                foundExtension = true;
-//                break;
-//            }
-//        }
-
-//        bool foundExtension0 = s.endsWith("htm");
-//        bool foundExtension1 = s.endsWith("html");
-//        bool foundExtension2 = s.endsWith("txt");
-
-        int extensionIndex = 0;
+    // only the cuesheets that share a name, title, label + number, or word with the MP3
+    for (int slot : cuesheetMatchIndex.candidates(mp3Keys)) {
+        const CuesheetMatchKeys &cuesheet = cuesheetMatchIndex.at(slot);
 
-        if (s.endsWith("htm", Qt::CaseInsensitive)) {
-            // nothing
-        } else if (s.endsWith("html", Qt::CaseInsensitive)) {
-            extensionIndex = 1;
-        } else if (s.endsWith("txt", Qt::CaseInsensitive)) {
-            extensionIndex = 2;
-        } else {
-            continue;
-        }
-
-        QStringList sl1 = s.split("#!#");
-        QString type = sl1[0];  // the type (of original pathname, before following aliases)
-        QString filename = sl1[1];  // everything else
+        int extensionIndex = cuesheet.extensionIndex;  // htm = 0, html = 1, txt = 2
+        const QString &type = cuesheet.type;  // the type (of original pathname, before following aliases)
+        const QString &filename = cuesheet.path;
 
 //        qDebug() << "possibleCuesheets(): " << fileTypeIsPatter << filename << filepath2SongType(filename) << type;
         if (fileTypeIsPatter && (type=="lyrics")) {
@@ -4354,30 +4276,14 @@ void MainWindow::findPossibleCuesheets(const QString &MP3Filename, QStringList &
 //            continue;
 //        }
 
-        QFileInfo fi(filename);
-//        QString fi2 = fi.canonicalPath();
-
-//        if (fi2 == musicRootPath && type.right(1) != "*") {
-//            // e.g. "/Users/mpogue/__squareDanceMusic/C 117 - Bad Puppy (Patter).mp3" --> NO TYPE PRESENT and NOT a guest song
-//            type = "";
-//        }
+        const QString &label = cuesheet.label;
+        const QString &labelnum = cuesheet.labelnum;
+        const QString &labelnum_short = cuesheet.labelnum_short;
+        const QString &title = cuesheet.title;
+        const QString &shortTitle = cuesheet.shortTitle;
 
-        QString label = "";
-        QString labelnum = "";
-        QString title = "";
-        QString labelnum_extra;
-        QString shortTitle = "";
-
-
-        QString completeBaseName = fi.completeBaseName(); // e.g. "/Users/mpogue/__squareDanceMusic/patter/RIV 307 - Going to Ceili (Patter).mp3" --> "RIV 307 - Going to Ceili (Patter)"
-        breakFilenameIntoParts(completeBaseName, label, labelnum, labelnum_extra, title, shortTitle);
-        QStringList words = splitIntoWords(completeBaseName);
-
-        QString labelnum_short = labelnum;
-        while (labelnum_short.length() > 0 && labelnum_short[0] == '0')
-        {
-            labelnum_short.remove(0,1);
-        }
+        const QString &completeBaseName = cuesheet.completeBaseName; // e.g. "/Users/mpogue/__squareDanceMusic/patter/RIV 307 - Going to Ceili (Patter).mp3" --> "RIV 307 - Going to Ceili (Patter)"
+        const QStringList &words = cuesheet.words;
 
 //        qDebug() << "Comparing: " << completeBaseName << " to " << mp3CompleteBaseName;
 //        qDebug() << "           " << title << " to " << mp3Title;
@@ -4402,9 +4308,10 @@ void MainWindow::findPossibleCuesheets(const QString &MP3Filename, QStringList &
             )
         {
 
+            QFileInfo fi(filename);  // only for the ones that are minimally included
             score = extensionIndex
                 + (mp3CanonicalPath.compare(fi.canonicalPath(), Qt::CaseInsensitive) == 0 ? 10000 : 0)
-                + (mp3CompleteBaseName.compare(fi.completeBaseName(), Qt::CaseInsensitive) == 0 ? 1000 : 0)
+                + (mp3CompleteBaseName.compare(completeBaseName, Qt::CaseInsensitive) == 0 ? 1000 : 0)
                 + (title.compare(mp3Title, Qt::CaseInsensitive) == 0 ? 100 : 0)
                 + (shortTitle.compare(mp3ShortTitle, Qt::CaseInsensitive) == 0 ? 50 : 0)
                 + (labelnum.compare(mp3Labelnum, Qt::CaseInsensitive) == 0 ? 10 : 0)
@@ -4425,7 +4332,7 @@ void MainWindow::findPossibleCuesheets(const QString &MP3Filename, QStringList &
             cswr->score = score;
             possibleRankings.append(cswr);
         }
-    } /* end of looping through all files we know about */
+    } /* end of looping through the candidate cuesheets */
 
     t.elapsed(__LINE__);
 
@@ -4576,6 +4483,148 @@ double MainWindow::getID3BPM(QString MP3FileName) {
     return(theBPM);
 }
 
+// returns the base BPM of the song that is being loaded
+int MainWindow::songBPMForCurrentSong(double detectedBPM, double songBPM_ID3, const QString &songType, const QString &songLabel)
+{
+    int songBPM = static_cast<int>(round(detectedBPM));  // libbass's idea of the BPM
+
+    bool isPatter = songTypeNamesForPatter.contains(songType);
+
+    bool isRiverboat = songLabel.startsWith(QString("riv"), Qt::CaseInsensitive);
+
+    if (isRiverboat && isPatter) {
+        // All Riverboat patter records are recorded at 126BPM, according to the publisher.
+        // This can always be overridden using TBPM in the ID3 tag inside a specific patter song, if needed.
+        //        qDebug() << "Riverboat patter detected!";
+        songBPM = 126;
+    }
+
+    // If the MP3 file has an embedded TBPM frame in the ID3 tag, then it overrides the libbass auto-detect of BPM
+    //   (songBPM_ID3 is 0.0, if not found or not understandable)
+    if (songBPM_ID3 != 0.0) {
+        songBPM = static_cast<int>(songBPM_ID3);
+    }
+
+    return songBPM;
+}
+
+// sets up the tempo slider for either BPM or % mode, depending on whether we know the song's BPM
+void MainWindow::setupTempoSlider(int songBPM, const QString &songType)
+{
+    PerfTimer t("setupTempoSlider", __LINE__);
+
+    baseBPM = songBPM;  // remember the base-level BPM of this song, for when the Tempo slider changes later
+
+    // Intentionally compare against a narrower range here than BPM detection, because BPM detection
+    //   returns a number at the limits, when it's actually out of range.
+    // Also, turn off BPM for xtras (they are all over the place, including round dance cues, which have no BPM at all).
+    //
+    // TODO: make the types for turning off BPM detection a preference
+    if ((songBPM>=125-15) && (songBPM<=125+15) && songType != "xtras") {
+        tempoIsBPM = true;
+        ui->currentTempoLabel->setText(QString::number(songBPM) + " BPM (100%)"); // initial load always at 100%
+        t.elapsed(__LINE__);
+
+        ui->tempoSlider->setMinimum(songBPM-15);
+        ui->tempoSlider->setMaximum(songBPM+15);
+
+        t.elapsed(__LINE__);
+        bool tryToSetInitialBPM = prefsManager.GettryToSetInitialBPM();
+        int initialBPM = prefsManager.GetinitialBPM();
+        t.elapsed(__LINE__);
+        if (tryToSetInitialBPM) {
+            // if the user wants us to try to hit a particular BPM target, use that value
+            ui->tempoSlider->setValue(initialBPM);
+            ui->tempoSlider->valueChanged(initialBPM);  // fixes bug where second song with same BPM doesn't update songtable::tempo
+            t.elapsed(__LINE__);
+        } else {
+            // otherwise, if the user wants us to start with the slider at the regular detected BPM
+            //   NOTE: this can be overridden by the "saveSongPreferencesInConfig" preference, in which case
+            //     all saved tempo preferences will always win.
+            ui->tempoSlider->setValue(songBPM);
+            ui->tempoSlider->valueChanged(songBPM);  // fixes bug where second song with same BPM doesn't update songtable::tempo
+            t.elapsed(__LINE__);
+        }
+
+        ui->tempoSlider->SetOrigin(songBPM);    // when double-clicked, goes here
+        ui->tempoSlider->setEnabled(true);
+        t.elapsed(__LINE__);
+//        statusBar()->showMessage(QString("Song length: ") + position2String(length_sec) +
+//                                 ", base tempo: " + QString::number(songBPM) + " BPM");
+        t.elapsed(__LINE__);
+    }
+    else {
+        tempoIsBPM = false;
+        // if we can't figure out a BPM, then use percent as a fallback (centered: 100%, range: +/-20%)
+        t.elapsed(__LINE__);
+        ui->currentTempoLabel->setText("100%");
+        t.elapsed(__LINE__);
+        ui->tempoSlider->setMinimum(100-20);        // allow +/-20%
+        t.elapsed(__LINE__);
+        ui->tempoSlider->setMaximum(100+20);
+        t.elapsed(__LINE__);
+        ui->tempoSlider->setValue(100);
+        t.elapsed(__LINE__);
+        ui->tempoSlider->valueChanged(100);  // fixes bug where second song with same 100% doesn't update songtable::tempo
+        t.elapsed(__LINE__);
+        ui->tempoSlider->SetOrigin(100);  // when double-clicked, goes here
+        t.elapsed(__LINE__);
+        ui->tempoSlider->setEnabled(true);
+        t.elapsed(__LINE__);
+//        statusBar()->showMessage(QString("Song length: ") + position2String(length_sec) +
+//                                 ", base tempo: 100%");
+        t.elapsed(__LINE__);
+    }
+}
+
+// called on the UI thread, when a SongAnalyzer job finishes
+void MainWindow::songAnalysisReady(const SongAnalysis &analysis)
+{
+    // persist it, so that the next load of this song (or rescan of the library) doesn't need to decode
+    //   anything (or, if it can't be decoded, doesn't try again until the file changes)
+    songSettings.saveAnalysis(analysis);
+
+    if (!analysis.valid || analysis.filenameWithPath != currentMP3filenameWithPath || !songLoaded) {
+        return;  // background analysis of some other song
+    }
+
+    // this is the song that is loaded right now, so do what loadMP3File() would have done, if the
+    //   analysis had been cached already (but don't override anything that was saved for this song)
+    cBass.Stream_BPM = analysis.bpm;
+    setSeekBarWaveforms(analysis);
+
+    SongSetting settings;
+    bool haveSettings = songSettings.loadSettings(currentMP3filenameWithPath, settings);
+
+    // if we were in % mode only because we didn't know the BPM yet, then switch over to BPM mode now
+    if (!tempoIsBPM && !(haveSettings && settings.isSetTempo())) {
+        int songBPM = songBPMForCurrentSong(analysis.bpm, analysis.id3BPM, currentSongType, currentSongLabel);
+        RecursionGuard recursion_guard(loadingSong);
+        setupTempoSlider(songBPM, currentSongType);
+    }
+
+    // the default intro/outro depend on where the music starts and ends (and on the BPM)
+    if (analysis.songEnd_sec > analysis.songStart_sec &&
+        !(haveSettings && (settings.isSetIntroPos() || settings.isSetOutroPos()))) {
+        ui->seekBarCuesheet->SetDefaultIntroOutroPositions(tempoIsBPM, baseBPM, analysis.songStart_sec, analysis.songEnd_sec, cBass.FileLength);
+        ui->seekBar->SetDefaultIntroOutroPositions(tempoIsBPM, baseBPM, analysis.songStart_sec, analysis.songEnd_sec, cBass.FileLength);
+        if (ui->actionLoop->isChecked()) {
+            on_loopButton_toggled(true);  // move the loop to the new points
+        }
+        ui->seekBarCuesheet->update();
+        ui->seekBar->update();
+    }
+}
+
+// the waveform in both seek bars comes from the analysis cache (no decoding)
+void MainWindow::setSeekBarWaveforms(const SongAnalysis &analysis)
+{
+    WaveformOverview overview = WaveformOverview::fromBlob(analysis.waveform);  // empty, if not analyzed yet
+    double length_sec = (analysis.songLength_sec > 0.0 ? analysis.songLength_sec : cBass.FileLength);
+    ui->seekBar->SetWaveform(overview, length_sec);
+    ui->seekBarCuesheet->SetWaveform(overview, length_sec);
+}
+
 void MainWindow::reloadCurrentMP3File() {
     // if there is a song loaded, reload it (to pick up, e.g. new cuesheets)
     if ((currentMP3filenameWithPath != "")&&(currentSongTitle != "")&&(currentSongType != "")) {
@@ -4652,6 +4701,35 @@ void MainWindow::loadMP3File(QString MP3FileName, QString songTitle, QString son
 
     t.elapsed(__LINE__);
 
+    // BPM and the start/end of the music come from the background analysis, which is
+    //   persisted in the analysis cache.  If this song hasn't been analyzed yet (or it changed
+    //   on disk), ask for it now (at high priority), and pick up the results in songAnalysisReady().
+    double musicStart_sec = startOfSong_sec;
+    double musicEnd_sec = endOfSong_sec;
+    double songBPM_ID3 = 0.0;
+    SongAnalysis analysis;
+    bool analyzed = songAnalyzer.lookup(songSettings, currentMP3filenameWithPath, analysis, true);  // (with the waveform)
+    if (analyzed && analysis.valid) {
+        cBass.Stream_BPM = analysis.bpm;
+        songBPM_ID3 = analysis.id3BPM;
+        if (analysis.songEnd_sec > analysis.songStart_sec) {
+            musicStart_sec = analysis.songStart_sec;
+            musicEnd_sec = analysis.songEnd_sec;
+        }
+#ifdef REMOVESILENCE
+        startOfSong_sec = musicStart_sec;
+        endOfSong_sec = musicEnd_sec;
+#endif
+    } else {
+        songBPM_ID3 = getID3BPM(MP3FileName);  // don't wait for the analysis for this one
+        if (!analyzed) {
+            songAnalyzer.enqueue(currentMP3filenameWithPath, SongAnalyzer::kPriorityNowPlaying);
+        }
+    }
+    setSeekBarWaveforms(analysis);
+
+    t.elapsed(__LINE__);
+
     // OK, by this time we always have an introOutro
     //   if DB had one, we didn't scan, and just used that one
     //   if DB did not have one, we scanned
@@ -4667,93 +4745,14 @@ void MainWindow::loadMP3File(QString MP3FileName, QString songTitle, QString son
     this->setWindowTitle(fn + QString(" - SquareDesk MP3 Player/Editor"));
 
     int length_sec = static_cast<int>(cBass.FileLength);
-    int songBPM = static_cast<int>(round(cBass.Stream_BPM));  // libbass's idea of the BPM
+    int songBPM = songBPMForCurrentSong(cBass.Stream_BPM, songBPM_ID3, songType, songLabel);
 
     bool isSingingCall = songTypeNamesForSinging.contains(songType) ||
                          songTypeNamesForCalled.contains(songType);
 
-    bool isPatter = songTypeNamesForPatter.contains(songType);
-
-    bool isRiverboat = songLabel.startsWith(QString("riv"), Qt::CaseInsensitive);
-
-    if (isRiverboat && isPatter) {
-        // All Riverboat patter records are recorded at 126BPM, according to the publisher.
-        // This can always be overridden using TBPM in the ID3 tag inside a specific patter song, if needed.
-        //        qDebug() << "Riverboat patter detected!";
-        songBPM = 126;
-    }
-
-    // If the MP3 file has an embedded TBPM frame in the ID3 tag, then it overrides the libbass auto-detect of BPM
-    double songBPM_ID3 = getID3BPM(MP3FileName);  // returns 0.0, if not found or not understandable
-
-    if (songBPM_ID3 != 0.0) {
-        songBPM = static_cast<int>(songBPM_ID3);
-    }
-
-    baseBPM = songBPM;  // remember the base-level BPM of this song, for when the Tempo slider changes later
-
     t.elapsed(__LINE__);
 
-    // Intentionally compare against a narrower range here than BPM detection, because BPM detection
-    //   returns a number at the limits, when it's actually out of range.
-    // Also, turn off BPM for xtras (they are all over the place, including round dance cues, which have no BPM at all).
-    //
-    // TODO: make the types for turning off BPM detection a preference
-    if ((songBPM>=125-15) && (songBPM<=125+15) && songType != "xtras") {
-        tempoIsBPM = true;
-        ui->currentTempoLabel->setText(QString::number(songBPM) + " BPM (100%)"); // initial load always at 100%
-        t.elapsed(__LINE__);
-
-        ui->tempoSlider->setMinimum(songBPM-15);
-        ui->tempoSlider->setMaximum(songBPM+15);
-
-        t.elapsed(__LINE__);
-        bool tryToSetInitialBPM = prefsManager.GettryToSetInitialBPM();
-        int initialBPM = prefsManager.GetinitialBPM();
-        t.elapsed(__LINE__);
-        if (tryToSetInitialBPM) {
-            // if the user wants us to try to hit a particular BPM target, use that value
-            ui->tempoSlider->setValue(initialBPM);
-            ui->tempoSlider->valueChanged(initialBPM);  // fixes bug where second song with same BPM doesn't update songtable::tempo
-            t.elapsed(__LINE__);
-        } else {
-            // otherwise, if the user wants us to start with the slider at the regular detected BPM
-            //   NOTE: this can be overridden by the "saveSongPreferencesInConfig" preference, in which case
-            //     all saved tempo preferences will always win.
-            ui->tempoSlider->setValue(songBPM);
-            ui->tempoSlider->valueChanged(songBPM);  // fixes bug where second song with same BPM doesn't update songtable::tempo
-            t.elapsed(__LINE__);
-        }
-
-        ui->tempoSlider->SetOrigin(songBPM);    // when double-clicked, goes here
-        ui->tempoSlider->setEnabled(true);
-        t.elapsed(__LINE__);
-//        statusBar()->showMessage(QString("Song length: ") + position2String(length_sec) +
-//                                 ", base tempo: " + QString::number(songBPM) + " BPM");
-        t.elapsed(__LINE__);
-    }
-    else {
-        tempoIsBPM = false;
-        // if we can't figure out a BPM, then use percent as a fallback (centered: 100%, range: +/-20%)
-        t.elapsed(__LINE__);
-        ui->currentTempoLabel->setText("100%");
-        t.elapsed(__LINE__);
-        ui->tempoSlider->setMinimum(100-20);        // allow +/-20%
-        t.elapsed(__LINE__);
-        ui->tempoSlider->setMaximum(100+20);
-        t.elapsed(__LINE__);
-        ui->tempoSlider->setValue(100);
-        t.elapsed(__LINE__);
-        ui->tempoSlider->valueChanged(100);  // fixes bug where second song with same 100% doesn't update songtable::tempo
-        t.elapsed(__LINE__);
-        ui->tempoSlider->SetOrigin(100);  // when double-clicked, goes here
-        t.elapsed(__LINE__);
-        ui->tempoSlider->setEnabled(true);
-        t.elapsed(__LINE__);
-//        statusBar()->showMessage(QString("Song length: ") + position2String(length_sec) +
-//                                 ", base tempo: 100%");
-        t.elapsed(__LINE__);
-    }
+    setupTempoSlider(songBPM, songType);
 
     t.elapsed(__LINE__);
 
@@ -4811,8 +4810,8 @@ void MainWindow::loadMP3File(QString MP3FileName, QString songTitle, QString son
     ui->dateTimeEditIntroTime->setTimeRange(QTime(0,0,0,0), QTime(0,0,0,0).addMSecs(static_cast<int>(1000.0*length_sec+0.5)));
     ui->dateTimeEditOutroTime->setTimeRange(QTime(0,0,0,0), QTime(0,0,0,0).addMSecs(static_cast<int>(1000.0*length_sec+0.5)));
 
-    ui->seekBarCuesheet->SetDefaultIntroOutroPositions(tempoIsBPM, cBass.Stream_BPM, startOfSong_sec, endOfSong_sec, cBass.FileLength);
-    ui->seekBar->SetDefaultIntroOutroPositions(tempoIsBPM, cBass.Stream_BPM, startOfSong_sec, endOfSong_sec, cBass.FileLength);
+    ui->seekBarCuesheet->SetDefaultIntroOutroPositions(tempoIsBPM, baseBPM, musicStart_sec, musicEnd_sec, cBass.FileLength);
+    ui->seekBar->SetDefaultIntroOutroPositions(tempoIsBPM, baseBPM, musicStart_sec, musicEnd_sec, cBass.FileLength);
 
     ui->dateTimeEditIntroTime->setEnabled(true);
     ui->dateTimeEditOutroTime->setEnabled(true);
@@ -4857,6 +4856,8 @@ void MainWindow::loadMP3File(QString MP3FileName, QString songTitle, QString son
     cBass.StreamSetPosition(startOfSong_sec);  // last thing we do is move the stream position to 1 sec before start of music
 
     songLoaded = true;  // now seekBar can be updated
+
+    prefetchNextPlaylistItem();  // get a head start on the next one
 }
 
 void MainWindow::on_actionOpen_MP3_file_triggered()
@@ -4890,12 +4891,10 @@ void MainWindow::on_actionOpen_MP3_file_triggered()
 }
 
 
-// this function stores the absolute paths of each file in a QVector
-void findFilesRecursively(QDir rootDir, QList<QString> *pathStack, QString suffix, Ui::MainWindow *ui, QMap<int, QString> *soundFXarray, QMap<int, QString> *soundFXname)
+// this function adds each file (found under rootDir) to the musicLibrary
+void MainWindow::addFilesToMusicLibrary(QDir rootDir, const QStringList &files, QString suffix, QMap<int, QString> *soundFXarray, QMap<int, QString> *soundFXname)
 {
-    QDirIterator it(rootDir, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
-    while(it.hasNext()) {
-        QString s1 = it.next();
+    for (const QString &s1 : files) {
         QString resolvedFilePath=s1;
 
         QFileInfo fi(s1);
@@ -4914,11 +4913,10 @@ void findFilesRecursively(QDir rootDir, QList<QString> *pathStack, QString suffi
 //                                                              // of where the alias is, not where the file is, and append "*" or not
 //        qDebug() << "FFR: " << fi.path() << rootDir.path() << type << newType;
         if (section[section.length()-1] != "soundfx") {
-//            qDebug() << "findFilesRecursively() adding " + type + "#!#" + resolvedFilePath + " to pathStack";
-//            pathStack->append(type + "#!#" + resolvedFilePath);
+//            qDebug() << "findFilesRecursively() adding " + type + ":" + resolvedFilePath + " to musicLibrary";
 
-            // add to the pathStack iff it's not a sound FX .mp3 file (those are internal)
-            pathStack->append(newType + "#!#" + resolvedFilePath);
+            // add to the musicLibrary iff it's not a sound FX .mp3 file (those are internal)
+            addToMusicLibrary(newType, resolvedFilePath, suffix == "*");
         } else {
             if (suffix != "*") {
                 // if it IS a sound FX file (and not GUEST MODE), then let's squirrel away the paths so we can play them later
@@ -4950,6 +4948,46 @@ void findFilesRecursively(QDir rootDir, QList<QString> *pathStack, QString suffi
     }
 }
 
+// full walk, for directories that don't have a MusicDirectoryIndex (e.g. guest music)
+static QStringList findFilesRecursively(QDir rootDir)
+{
+    QStringList files;
+    QDirIterator it(rootDir, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while(it.hasNext()) {
+        files.append(it.next());
+    }
+    return files;
+}
+
+// adds one file to the musicLibrary, breaking its name into label/number/title once,
+//   here, rather than every time somebody looks at it
+void MainWindow::addToMusicLibrary(const QString &type, const QString &path, bool guest)
+{
+    int i = musicLibrary.append(type, path, guest);
+    LibraryEntry &entry = musicLibrary[i];
+    if (entry.kind != LibraryFileOther && !entry.parsed) {
+        breakFilenameIntoParts(entry.baseName, entry.label, entry.labelnum, entry.labelnum_extra,
+                               entry.title, entry.shortTitle);
+        entry.parsed = true;
+    }
+}
+
+// when the song filename format changes, all of the names have to be broken apart again
+void MainWindow::reparseMusicLibrary()
+{
+    for (int i = 0; i < musicLibrary.size(); i++) {
+        LibraryEntry &entry = musicLibrary[i];
+        if (entry.kind != LibraryFileOther) {
+            entry.label = entry.labelnum = entry.labelnum_extra = entry.title = entry.shortTitle = "";
+            breakFilenameIntoParts(entry.baseName, entry.label, entry.labelnum, entry.labelnum_extra,
+                                   entry.title, entry.shortTitle);
+            entry.parsed = true;
+        }
+    }
+    cuesheetMatchIndex.clear();
+    cuesheetMatchIndex.update(musicLibrary);
+}
+
 void MainWindow::checkLockFile() {
 //    qDebug() << "checkLockFile()";
     QString musicRootPath = prefsManager.GetmusicPath();
@@ -5018,13 +5056,9 @@ void MainWindow::findMusic(QString mainRootDir, QString guestRootDir, QString mo
     {
         songSettings.openDatabase(databaseDir, mainRootDir, guestRootDir, false);
     }
-    // always gets rid of the old pathstack...
-    if (pathStack) {
-        delete pathStack;
-    }
-
-    // make a new one
-    pathStack = new QList<QString>();
+    // always starts over with an empty musicLibrary (but files that are still there
+    //   don't have to have their names broken apart again)...
+    musicLibrary.beginRescan();
 
     // mode == "main": look only in the main directory (e.g. there isn't a guest directory)
     // mode == "guest": look only in the guest directory (e.g. guest overrides main)
@@ -5047,7 +5081,14 @@ void MainWindow::findMusic(QString mainRootDir, QString guestRootDir, QString mo
 
         rootDir1.setNameFilters(qsl);
 
-        findFilesRecursively(rootDir1, pathStack, "", ui, &soundFXfilenames, &soundFXname);  // appends to the pathstack
+        // only the directories that changed since last time are listed again
+        int relisted = musicDirectoryIndex.update(mainRootDir, qsl, databaseDir + "/directoryIndex.dat");
+        t.elapsed(__LINE__);
+        addFilesToMusicLibrary(rootDir1, musicDirectoryIndex.files(), "", &soundFXfilenames, &soundFXname);  // appends to the musicLibrary
+
+        if (relisted > 0 || musicRootWatcher.directories().isEmpty()) {
+            updateMusicRootWatcher();
+        }
     }
 
     if (guestRootDir != "" && (mode == "guest" || mode == "both")) {
@@ -5061,8 +5102,16 @@ void MainWindow::findMusic(QString mainRootDir, QString guestRootDir, QString mo
         qsl.append("*.wav");                //          or WAV files
         rootDir2.setNameFilters(qsl);
 
-        findFilesRecursively(rootDir2, pathStack, "*", ui, &soundFXfilenames, &soundFXname);  // appends to the pathstack, "*" for "Guest"
+        addFilesToMusicLibrary(rootDir2, findFilesRecursively(rootDir2), "*", &soundFXfilenames, &soundFXname);  // appends to the musicLibrary, "*" for "Guest"
     }
+    musicLibrary.endRescan();
+
+    // only the cuesheets that were added or removed are (re)indexed
+    cuesheetMatchIndex.update(musicLibrary);
+    t.elapsed(__LINE__);
+
+    preloadSoundFX();  // soundFXfilenames might have changed
+    t.elapsed(__LINE__);
 }
 
 void addStringToLastRowOfSongTable(QColor &textCol, MyTableWidget *songTable,
@@ -5084,7 +5133,7 @@ void addStringToLastRowOfSongTable(QColor &textCol, MyTableWidget *songTable,
 
 static QString getTitleColText(MyTableWidget *songTable,int row)
 {
-    return dynamic_cast<QLabel*>(songTable->cellWidget(row,kTitleCol))->text();
+    return songTable->item(row,kTitleCol)->data(kTitlePlusTagsRole).toString();
 }
 
 static QString getTitleColTitle(MyTableWidget *songTable,int row)
@@ -5099,97 +5148,95 @@ static QString getTitleColTitle(MyTableWidget *songTable,int row)
 }
 
 
-bool filterContains(QString str, const QStringList &list)
+// what the search boxes look at: no apostrophes (to make "it's" and "its" equivalent), and the
+//   tag markup replaced by a space. *tagsStart = where the tags start (or -1 if there aren't any)
+static QString normalizeForSearch(QString str, int *tagsStart)
 {
-    if (list.isEmpty())
-        return true;
-    // Make "it's" and "its" equivalent.
     str.replace("'","");
 
-    int title_end = str.indexOf(title_tags_remover);
+    *tagsStart = str.indexOf(title_tags_remover);
     str.replace(title_tags_remover, " ");
-    int index = 0;
+    return str;
+}
 
-    if (title_end < 0) title_end = str.length();
-                
-    for (auto t : list)
-    {
-        QString filterWord(t);
-        bool tagsOnly(false);
-        bool exclude(false);
+// rebuilds the search index from the songTable, only when the rows have changed since last time
+void MainWindow::updateSongSearchIndex()
+{
+    if (!songSearchIndex.isEmpty() || ui->songTable->rowCount() == 0) {
+        return;
+    }
 
-        while (filterWord.length() > 0 &&
-               ('#' == filterWord[0] ||
-                '-' == filterWord[0]))
-        {
-            tagsOnly = ('#' == filterWord[0]);
-            exclude = ('-' == filterWord[0]);
-            filterWord.remove(0,1);
-        }
-        if (filterWord.length() == 0)
-            continue;
+    PerfTimer t("updateSongSearchIndex", __LINE__);
+    songSearchIndex.reserve(ui->songTable->rowCount());
+    for (int i=0; i<ui->songTable->rowCount(); i++) {
+        int tagsStart;
+        QString songLabel = normalizeForSearch(ui->songTable->item(i,kLabelCol)->text(), &tagsStart);
+        songSearchIndex.append(SongSearchIndex::LabelField, songLabel, tagsStart);
+        QString songType = normalizeForSearch(ui->songTable->item(i,kTypeCol)->text(), &tagsStart);
+        songSearchIndex.append(SongSearchIndex::TypeField, songType, tagsStart);
+        QString songTitle = normalizeForSearch(getTitleColText(ui->songTable, i), &tagsStart);
+        songSearchIndex.append(SongSearchIndex::TitleField, songTitle, tagsStart);
+    }
+}
 
-        // Keywords can get matched in any order
-        if (index > title_end)
-            index = title_end;
-        int i = str.indexOf(filterWord,
-                            tagsOnly ? title_end : (exclude ? 0 : index),
-                            Qt::CaseInsensitive);
-        if (i < 0)
-        {
-            if (!exclude)
-                return false;
-        }
-        else
-        {
-            if (exclude)
-                return false;
+// the rows were added/removed/sorted, so the search index and the path -> row hashes are out of date
+void MainWindow::songTableRowsChanged()
+{
+    songSearchIndex.clear();
+    songTableRowByPath.clear();
+    songTableRowByFilename.clear();
+}
+
+void MainWindow::songTableDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (kPathCol >= topLeft.column() && kPathCol <= bottomRight.column()) {
+        songTableRowByPath.clear();
+        songTableRowByFilename.clear();
+    }
+    if (songSearchIndex.isEmpty()) {
+        return;
+    }
+    for (int column : { kTypeCol, kLabelCol, kTitleCol }) {
+        if (column >= topLeft.column() && column <= bottomRight.column()) {
+            songSearchIndex.clear();  // e.g. tags were edited
+            return;
         }
-        if (!tagsOnly && !exclude)
-            index = i + t.length();
     }
-    return true;
 }
 
 // --------------------------------------------------------------------------------
 void MainWindow::filterMusic()
 {
-    QRegExp rx("(\\ |\\,|\\.|\\:|\\t\\')"); //RegEx for ' ' or ',' or '.' or ':' or '\t', includes ' to handle the "it's" case.
+    PerfTimer t("filterMusic", __LINE__);
 
-    QStringList label = ui->labelSearch->text().split(rx);
-    QStringList type = ui->typeSearch->text().split(rx);
-    QStringList title = ui->titleSearch->text().split(rx);
+    updateSongSearchIndex();
+    const QVector<bool> &visible = songSearchIndex.filter(ui->labelSearch->text(),
+                                                          ui->typeSearch->text(),
+                                                          ui->titleSearch->text());
+    t.elapsed(__LINE__);
 
     ui->songTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);  // DO NOT SET height of rows (for now)
-
-    ui->songTable->setSortingEnabled(false);
+    ui->songTable->setUpdatesEnabled(false);  // one repaint at the end, rather than one per row
 
 // SONGTABLEREFACTOR
     int initialRowCount = ui->songTable->rowCount();
     int rowsVisible = initialRowCount;
     int firstVisibleRow = -1;
-    for (int i=0; i<ui->songTable->rowCount(); i++) {
-        QString songTitle = getTitleColText(ui->songTable, i);
-        QString songType = ui->songTable->item(i,kTypeCol)->text();
-        QString songLabel = ui->songTable->item(i,kLabelCol)->text();
+    for (int i=0; i<initialRowCount; i++) {
+        bool show = (i < visible.size() ? visible[i] : true);
 
-        bool show = true;
-
-        if (!filterContains(songLabel,label)
-            || !filterContains(songType, type)
-            || !filterContains(songTitle, title))
-        {
-            show = false;
+        if (ui->songTable->isRowHidden(i) == show) {
+            ui->songTable->setRowHidden(i, !show);  // only the rows that changed
         }
-        ui->songTable->setRowHidden(i, !show);
         rowsVisible -= (show ? 0 : 1); // decrement row count, if hidden
         if (show && firstVisibleRow == -1) {
             firstVisibleRow = i;
         }
     }
-    ui->songTable->setSortingEnabled(true);
+    ui->songTable->setUpdatesEnabled(true);
+    t.elapsed(__LINE__);
 
-//    qDebug() << "rowsVisible: " << rowsVisible << ", initialRowCount: " << initialRowCount << ", firstVisibleRow: " << firstVisibleRow;
+//    qDebug() << "rowsVisible: " << rowsVisible << ", initialRowCount: " << initialRowCount << ", firstVisibleRow: " << firstVisibleRow << ", incremental: " << songSearchIndex.lastFilterWasIncremental();
     if (rowsVisible > 0 && rowsVisible != initialRowCount && firstVisibleRow != -1) {
         ui->songTable->selectRow(firstVisibleRow);
     } else {
@@ -5221,13 +5268,6 @@ QString MainWindow::FormatTitlePlusTags(const QString &title, bool setTags, cons
     return titlePlusTags;
 }
 
-void setSongTableFont(QTableWidget *songTable, const QFont &currentFont)
-{
-    for (int row = 0; row < songTable->rowCount(); ++row)
-        dynamic_cast<QLabel*>(songTable->cellWidget(row,kTitleCol))->setFont(currentFont);
-}
-
-
 // --------------------------------------------------------------------------------
 void MainWindow::loadMusicList()
 {
@@ -5236,11 +5276,10 @@ void MainWindow::loadMusicList()
 
     // Need to remember the PL# mapping here, and reapply it after the filter
     // left = path, right = number string
-    QMap<QString, QString> path2playlistNum;
+    QHash<QString, QString> path2playlistNum;
 
 // SONGTABLEREFACTOR
     // Iterate over the songTable, saving the mapping in "path2playlistNum"
-    // TODO: optimization: save this once, rather than recreating each time.
     for (int i=0; i<ui->songTable->rowCount(); i++) {
         QTableWidgetItem *theItem = ui->songTable->item(i,kNumberCol);
         QString playlistIndex = theItem->text();  // this is the playlist #
@@ -5261,60 +5300,37 @@ void MainWindow::loadMusicList()
     ui->songTable->horizontalHeader()->setDefaultAlignment(Qt::AlignLeft);
     ui->songTable->horizontalHeader()->setVisible(true);
 
-    QListIterator<QString> iter(*pathStack);
     QColor textCol = QColor::fromRgbF(0.0/255.0, 0.0/255.0, 0.0/255.0);  // defaults to Black
-    QList<QString> extensions;
-    QString dot(".");
-    for (size_t i = 0; i < sizeof(music_file_extensions) / sizeof(*music_file_extensions); ++i)
-    {
-        extensions.append(dot + music_file_extensions[i]);
-    }
     bool show_all_ages = ui->actionShow_All_Ages->isChecked();
+    QStringList musicPaths;  // checked against the analysis cache, all at once, after the loop
 
-    while (iter.hasNext()) {
-        QString s = iter.next();
+    // one pass over the songs table (settings + ages), rather than 2-3 queries per song
+    QHash<QString,SongSetting> allSettings;
+    QHash<QString,QString> allAges;
+    songSettings.loadAllSettings(allSettings, allAges, show_all_ages);
+    t.elapsed(__LINE__);
 
-        QListIterator<QString> extensionIterator(extensions);
-        bool foundExtension = false;
-        while (extensionIterator.hasNext())
-        {
-            QString extension(extensionIterator.next());
-            if (s.endsWith(extension, Qt::CaseInsensitive))
-            {
-                foundExtension = true;
-            }
-        }
-        if (!foundExtension) {
-            continue;
-        }
+    for (int i : musicLibrary.indexesOfKind(LibraryFileMusic)) {
+        const LibraryEntry &entry = musicLibrary.at(i);
 
-        QStringList sl1 = s.split("#!#");
-        QString type = sl1[0];  // the type (of original pathname, before following aliases)
-        s = sl1[1];  // everything else
-        QString origPath = s;  // for when we double click it later on...
+        QString type = entry.type;  // the type (of original pathname, before following aliases)
+        const QString &origPath = entry.path;  // for when we double click it later on...
 
         // double check that type is non-music type (see Issue #298)
         if (type == "reference" || type == "soundfx" || type == "sd") {
             continue;
         }
 
-        QFileInfo fi(s);
+        QFileInfo fi(origPath);
 
-        if (fi.canonicalPath() == musicRootPath && type.right(1) != "*") {
+        if (type.right(1) != "*" && fi.canonicalPath() == musicRootPath) {
             // e.g. "/Users/mpogue/__squareDanceMusic/C 117 - Bad Puppy (Patter).mp3" --> NO TYPE PRESENT and NOT a guest song
             type = "";
         }
 
-        QStringList section = fi.canonicalPath().split("/");
-        QString label = "";
-        QString labelnum = "";
-        QString labelnum_extra = "";
-        QString title = "";
-        QString shortTitle = "";
-
-        s = fi.completeBaseName(); // e.g. "/Users/mpogue/__squareDanceMusic/patter/RIV 307 - Going to Ceili (Patter).mp3" --> "RIV 307 - Going to Ceili (Patter)"
-        breakFilenameIntoParts(s, label, labelnum, labelnum_extra, title, shortTitle);
-        labelnum += labelnum_extra;
+        const QString &label = entry.label;
+        QString labelnum = entry.labelnum + entry.labelnum_extra;
+        const QString &title = entry.title;
 
         ui->songTable->setRowCount(ui->songTable->rowCount()+1);  // make one more row for this line
 
@@ -5340,8 +5356,9 @@ void MainWindow::loadMusicList()
 
         // look up origPath in the path2playlistNum map, and reset the s2 text to the user's playlist # setting (if any)
         QString s2("");
-        if (path2playlistNum.contains(origPath)) {
-            s2 = path2playlistNum[origPath];
+        QHash<QString, QString>::const_iterator playlistNum = path2playlistNum.constFind(origPath);
+        if (playlistNum != path2playlistNum.constEnd()) {
+            s2 = playlistNum.value();
         }
         TableNumberItem *newTableItem4 = new TableNumberItem(s2);
 
@@ -5353,26 +5370,20 @@ void MainWindow::loadMusicList()
         addStringToLastRowOfSongTable(textCol, ui->songTable, label + " " + labelnum, kLabelCol );
 //        addStringToLastRowOfSongTable(textCol, ui->songTable, title, kTitleCol);
        
-        InvisibleTableWidgetItem *titleItem(new InvisibleTableWidgetItem(title));
-        ui->songTable->setItem(ui->songTable->rowCount()-1, kTitleCol, titleItem);
-        SongSetting settings;
-        songSettings.loadSettings(origPath,
-                                  settings);
+        InvisibleTableWidgetItem *titleItem(new InvisibleTableWidgetItem(title));  // sorts by title, painted by SongTitleDelegate
+        titleItem->setTextColor(textCol);
+        QString origPathNormalized = songSettings.removeRootDirs(origPath);
+        SongSetting settings = allSettings.value(origPathNormalized);
         if (settings.isSetTags())
             songSettings.addTags(settings.getTags());
+        musicPaths.append(origPath);
         
-        QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags()));
-        SongTitleLabel *titleLabel = new SongTitleLabel(this);
-        QString songNameStyleSheet("QLabel { color : %1; }");
-        titleLabel->setStyleSheet(songNameStyleSheet.arg(textCol.name()));
-        titleLabel->setTextFormat(Qt::RichText);
-        titleLabel->setText(titlePlusTags);
-        titleLabel->textColor = textCol.name();  // remember the text color, so we can restore it when deselected
-
-        ui->songTable->setCellWidget(ui->songTable->rowCount()-1, kTitleCol, titleLabel);
+        titleItem->setData(kTitlePlusTagsRole, FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags()));
+        ui->songTable->setItem(ui->songTable->rowCount()-1, kTitleCol, titleItem);
         
-        QString ageString = songSettings.getSongAge(fi.completeBaseName(), origPath,
-                                                    show_all_ages);
+        // same lookup order as SongSettings::getSongAge(): by path, then by bare filename
+        QString ageString = allAges.value(origPathNormalized,
+                                          allAges.value(entry.baseName));
 
         QString ageAsIntString = ageToIntString(ageString);
 
@@ -5406,12 +5417,19 @@ void MainWindow::loadMusicList()
         QString labelPlusNumber = label + " " + labelnum;
     }
 
-    QFont currentFont = ui->songTable->font();
-    setSongTableFont(ui->songTable, currentFont);
     filterMusic();
 
     sortByDefaultSortOrder();
     stopLongSongTableOperation("loadMusicList");  // for performance, sorting on again and show
+    t.elapsed(__LINE__);
+
+    // analyze any songs that we haven't seen before (or that changed), in the background
+    bool checkedAnalyses = prefsManager.GetbackgroundSongAnalysis();
+    if (checkedAnalyses) {
+        songAnalyzer.resetCacheCounters();
+        songAnalyzer.enqueueAll(songAnalyzer.filesToAnalyze(songSettings, musicPaths));
+        t.elapsed(__LINE__);
+    }
 
     QString msg1;
     if (guestMode == "main") {
@@ -5421,6 +5439,10 @@ void MainWindow::loadMusicList()
     } else if (guestMode == "both") {
         msg1 = QString::number(ui->songTable->rowCount()) + QString(" total audio files found.");
     }
+    if (checkedAnalyses && songAnalyzer.cacheMisses() > 0) {
+        msg1 += QString(" ") + QString::number(songAnalyzer.cacheHits()) + QString(" already analyzed, ") +
+                QString::number(songAnalyzer.cacheMisses()) + QString(" to analyze.");
+    }
     ui->statusBar->showMessage(msg1);
 }
 
@@ -5664,22 +5686,17 @@ void MainWindow::loadChoreographyList()
 #ifdef EXPERIMENTAL_CHOREOGRAPHY_MANAGEMENT
     ui->listWidgetChoreographyFiles->clear();
 
-    QListIterator<QString> iter(*pathStack);
+    for (int i : musicLibrary.indexesOfKind(LibraryFileCuesheet)) {
+        const LibraryEntry &entry = musicLibrary.at(i);
+        const QString &origPath = entry.path;
 
-    while (iter.hasNext()) {
-        QString s = iter.next();
-
-        if (s.endsWith(".txt", Qt::CaseInsensitive)
-            && (s.contains("sequence", Qt::CaseInsensitive)
-                || s.contains("singer", Qt::CaseInsensitive)))
+        if (origPath.endsWith(".txt", Qt::CaseInsensitive)
+            && (origPath.contains("sequence", Qt::CaseInsensitive)
+                || origPath.contains("singer", Qt::CaseInsensitive)
+                || entry.type.contains("sequence", Qt::CaseInsensitive)
+                || entry.type.contains("singer", Qt::CaseInsensitive)))
         {
-            QStringList sl1 = s.split("#!#");
-            QString type = sl1[0];  // the type (of original pathname, before following aliases)
-            QString origPath = sl1[1];  // everything else
-
-            QFileInfo fi(origPath);
-//            QStringList section = fi.canonicalPath().split("/");
-            QString name = fi.completeBaseName();
+            QString name = entry.baseName;
             QListWidgetItem *item = new QListWidgetItem(name);
             item->setData(1,origPath);
             item->setCheckState(Qt::Unchecked);
@@ -5712,21 +5729,17 @@ static void addToProgramsAndWriteTextFile(QStringList &programs, QDir outputDir,
 void MainWindow::loadDanceProgramList(QString lastDanceProgram)
 {
     ui->comboBoxCallListProgram->clear();
-    QListIterator<QString> iter(*pathStack);
     QStringList programs;
 
-    // FIX: This should be changed to look only in <rootDir>/reference, rather than looking
-    //   at all pathnames in the <rootDir>.  It will be much faster.
-    while (iter.hasNext()) {
-        QString s = iter.next();
+    // only look at the files in <rootDir>/reference
+    QRegExp danceProgramRegex("reference/0[0-9][0-9]\\.[a-zA-Z0-9' ]+\\.txt$", Qt::CaseInsensitive);
+    for (int i : musicLibrary.indexesOfType("reference")) {
+        const QString &origPath = musicLibrary.at(i).path;
 
         // Dance Program file names must begin with 0 then exactly 2 numbers followed by a dot, followed by the dance program name, dot text.
-        if (QRegExp("reference/0[0-9][0-9]\\.[a-zA-Z0-9' ]+\\.txt$", Qt::CaseInsensitive).indexIn(s) != -1)  // matches the Dance Program files in /reference
+        if (danceProgramRegex.indexIn(origPath) != -1)  // matches the Dance Program files in /reference
         {
-            //qDebug() << "Dance Program Match:" << s;
-            QStringList sl1 = s.split("#!#");
-            QString type = sl1[0];  // the type (of original pathname, before following aliases)
-            QString origPath = sl1[1];  // everything else
+            //qDebug() << "Dance Program Match:" << origPath;
             QFileInfo fi(origPath);
             if (fi.dir().canonicalPath().endsWith("/reference", Qt::CaseInsensitive))
             {
@@ -5794,23 +5807,6 @@ void MainWindow::on_titleSearch_textChanged()
 }
 
 
-void MainWindow::titleLabelDoubleClicked(QMouseEvent * /* event */)
-{
-    QItemSelectionModel *selectionModel = ui->songTable->selectionModel();
-    QModelIndexList selected = selectionModel->selectedRows();
-    int row = -1;
-    if (selected.count() == 1) {
-        // exactly 1 row was selected (good)
-        QModelIndex index = selected.at(0);
-        row = index.row();
-        on_songTable_itemDoubleClicked(ui->songTable->item(row,kPathCol));
-    }
-    else {
-        // more than 1 row or no rows at all selected (BAD)
-    }
-    
-}
-
 void MainWindow::on_songTable_itemDoubleClicked(QTableWidgetItem *item)
 {
     PerfTimer t("on_songTable_itemDoubleClicked", __LINE__);
@@ -5903,7 +5899,7 @@ void MainWindow::on_actionImport_triggered()
     RecursionGuard keypress_guard(trapKeypresses);
     if (dialogCode == QDialog::Accepted)
     {
-        importDialog->importSongs(songSettings, pathStack);
+        importDialog->importSongs(songSettings, musicLibrary.paths(LibraryFileMusic));
         loadMusicList();
     }
     delete importDialog;
@@ -5956,7 +5952,7 @@ void MainWindow::on_actionExport_triggered()
                 outputFields[5] = ExportDataVolume;
                 outputFields[6] = ExportDataCuesheetPath;
 
-                exportSongList(stream, songSettings, pathStack,
+                exportSongList(stream, songSettings, musicLibrary.paths(LibraryFileMusic),
                                outputFieldCount, outputFields,
                                separator,
                                true, false);
@@ -5970,7 +5966,7 @@ void MainWindow::on_actionExport_triggered()
         RecursionGuard keypress_guard(trapKeypresses);
         if (dialogCode == QDialog::Accepted)
         {
-            exportDialog->exportSongs(songSettings, pathStack);
+            exportDialog->exportSongs(songSettings, musicLibrary.paths(LibraryFileMusic));
         }
         delete exportDialog;
         exportDialog = nullptr;
@@ -6167,7 +6163,11 @@ void MainWindow::on_actionPreferences_triggered()
             value = prefsManager.GetToggleSingingPatterSequence();
             songTypeToggleList = value.toLower().split(';', QString::KeepEmptyParts);
         }
-        songFilenameFormat = static_cast<enum SongFilenameMatchingType>(prefsManager.GetSongFilenameFormat());
+        enum SongFilenameMatchingType newSongFilenameFormat = static_cast<enum SongFilenameMatchingType>(prefsManager.GetSongFilenameFormat());
+        if (newSongFilenameFormat != songFilenameFormat) {
+            songFilenameFormat = newSongFilenameFormat;
+            reparseMusicLibrary();
+        }
 
         if (prefDialog->songTableReloadNeeded) {
             loadMusicList();
@@ -6255,8 +6255,38 @@ QStringList MainWindow::parseCSV(const QString &string)
     return fields;
 }
 
+// the songTable row for this path, or -1 if it's not there.  If the file isn't where the playlist
+//   says it is, but exactly one song in the songTable has the same filename (e.g. the file was moved
+//   to another folder), that's the one, and *moved is set.
+int MainWindow::songTableRowForPath(const QString &path, bool *moved)
+{
+    if (songTableRowByPath.isEmpty() && ui->songTable->rowCount() > 0) {
+        // built again after the rows change (see songTableRowsChanged())
+        songTableRowByPath.reserve(ui->songTable->rowCount());
+        songTableRowByFilename.reserve(ui->songTable->rowCount());
+        for (int i = 0; i < ui->songTable->rowCount(); i++) {
+            QString pathToMP3 = ui->songTable->item(i,kPathCol)->data(Qt::UserRole).toString();
+            if (!songTableRowByPath.contains(pathToMP3)) {
+                songTableRowByPath.insert(pathToMP3, i);  // first one wins, same as the old linear search
+            }
+            QString filename = pathToMP3.section('/', -1).toLower();
+            songTableRowByFilename.insert(filename, songTableRowByFilename.contains(filename) ? -1 : i);  // -1 = more than one
+        }
+    }
+
+    *moved = false;
+    int row = songTableRowByPath.value(path, -1);
+    if (row < 0) {
+        QString filename = QString(path).replace('\\', '/').section('/', -1).toLower();
+        row = songTableRowByFilename.value(filename, -1);
+        *moved = (row >= 0);
+    }
+    return row;
+}
+
 // returns first song error, and also updates the songCount as it goes (2 return values)
-QString MainWindow::loadPlaylistFromFile(QString PlaylistFileName, int &songCount) {
+//   if movedSongCount is given, it gets the number of songs that were found by filename only (moved?)
+QString MainWindow::loadPlaylistFromFile(QString PlaylistFileName, int &songCount, int *movedSongCount) {
 
 //    qDebug() << "loadPlaylist: " << PlaylistFileName;
     addFilenameToRecentPlaylist(PlaylistFileName);  // remember it in the Recent list
@@ -6266,6 +6296,13 @@ QString MainWindow::loadPlaylistFromFile(QString PlaylistFileName, int &songCoun
     QFile inputFile(PlaylistFileName);
     if (inputFile.open(QIODevice::ReadOnly)) { // defaults to Text mode
 
+        // all of the changes to the songTable are made with sorting off (so the rows stay put),
+        //   and it gets sorted again once, at the end
+        bool wasSortingEnabled = ui->songTable->isSortingEnabled();
+        ui->songTable->setSortingEnabled(false);
+        ui->songTable->setUpdatesEnabled(false);
+        int movedSongs = 0;
+
         // first, clear all the playlist numbers that are there now.
         for (int i = 0; i < ui->songTable->rowCount(); i++) {
             QTableWidgetItem *theItem = ui->songTable->item(i,kNumberCol);
@@ -6296,25 +6333,20 @@ QString MainWindow::loadPlaylistFromFile(QString PlaylistFileName, int &songCoun
 
                     QStringList list1 = parseCSV(line);  // This is more robust than split(). Handles commas inside double quotes, double double quotes, etc.
 
-                    bool match = false;
-                    // exit the loop early, if we find a match
-                    for (int i = 0; (i < ui->songTable->rowCount())&&(!match); i++) {
-
-                        QString pathToMP3 = ui->songTable->item(i,kPathCol)->data(Qt::UserRole).toString();
-
-                        if (list1[0] == pathToMP3) { // FIX: this is fragile, if songs are moved around, since absolute paths are used.
+                    bool moved = false;
+                    int i = songTableRowForPath(list1[0], &moved);
+                    bool match = (i >= 0);
+                    if (match) {
+                        QTableWidgetItem *theItem = ui->songTable->item(i,kNumberCol);
+                        theItem->setText(QString::number(songCount));
 
-                            QTableWidgetItem *theItem = ui->songTable->item(i,kNumberCol);
-                            theItem->setText(QString::number(songCount));
+                        QTableWidgetItem *theItem2 = ui->songTable->item(i,kPitchCol);
+                        theItem2->setText(list1[1].trimmed());
 
-                            QTableWidgetItem *theItem2 = ui->songTable->item(i,kPitchCol);
-                            theItem2->setText(list1[1].trimmed());
+                        QTableWidgetItem *theItem3 = ui->songTable->item(i,kTempoCol);
+                        theItem3->setText(list1[2].trimmed());
 
-                            QTableWidgetItem *theItem3 = ui->songTable->item(i,kTempoCol);
-                            theItem3->setText(list1[2].trimmed());
-
-                            match = true;
-                        }
+                        movedSongs += (moved ? 1 : 0);
                     }
                     // if we had no match, remember the first non-matching song path
                     if (!match && firstBadSongLine == "") {
@@ -6349,17 +6381,14 @@ QString MainWindow::loadPlaylistFromFile(QString PlaylistFileName, int &songCoun
                 else {
                     songCount++;  // it's a real song path
 
-                    bool match = false;
-                    // exit the loop early, if we find a match
-                    for (int i = 0; (i < ui->songTable->rowCount())&&(!match); i++) {
-                        QString pathToMP3 = ui->songTable->item(i,kPathCol)->data(Qt::UserRole).toString();
-//                        qDebug() << "pathToMP3:" << pathToMP3;
-                        if (line == pathToMP3) { // FIX: this is fragile, if songs are moved around
-                            QTableWidgetItem *theItem = ui->songTable->item(i,kNumberCol);
-                            theItem->setText(QString::number(songCount));
+                    bool moved = false;
+                    int i = songTableRowForPath(line, &moved);
+                    bool match = (i >= 0);
+                    if (match) {
+                        QTableWidgetItem *theItem = ui->songTable->item(i,kNumberCol);
+                        theItem->setText(QString::number(songCount));
 
-                            match = true;
-                        }
+                        movedSongs += (moved ? 1 : 0);
                     }
                     // if we had no match, remember the first non-matching song path
                     if (!match && firstBadSongLine == "") {
@@ -6374,6 +6403,13 @@ QString MainWindow::loadPlaylistFromFile(QString PlaylistFileName, int &songCoun
 
         } // else M3U file
 
+        ui->songTable->setUpdatesEnabled(true);
+        ui->songTable->setSortingEnabled(wasSortingEnabled);
+
+        if (movedSongCount) {
+            *movedSongCount = movedSongs;
+        }
+
         inputFile.close();
         linesInCurrentPlaylist += songCount; // when non-zero, this enables saving of the current playlist
 //        qDebug() << "linesInCurrentPlaylist:" << linesInCurrentPlaylist;
@@ -6402,8 +6438,9 @@ void MainWindow::finishLoadingPlaylist(QString PlaylistFileName) {
     // --------
     QString firstBadSongLine = "";
     int songCount = 0;
+    int movedSongCount = 0;
 
-    firstBadSongLine = loadPlaylistFromFile(PlaylistFileName, songCount);
+    firstBadSongLine = loadPlaylistFromFile(PlaylistFileName, songCount, &movedSongCount);
 
     // simplify path, for the error message case
     firstBadSongLine = firstBadSongLine.split(",")[0].replace("\"", "").replace(musicRootPath, "");
@@ -6421,6 +6458,10 @@ void MainWindow::finishLoadingPlaylist(QString PlaylistFileName) {
     stopLongSongTableOperation("finishLoadingPlaylist"); // for performance measurements, sorting on again and show
 
     QString msg1 = QString("Loaded playlist with ") + QString::number(songCount) + QString(" items.");
+    if (movedSongCount > 0) {
+        // tell the user, so they can save the playlist again with the new locations
+        msg1 += QString(" ") + QString::number(movedSongCount) + QString(" were found in a different folder.");
+    }
     if (firstBadSongLine != "") {
         // if there was a non-matching path, tell the user what the first one of those was
         msg1 = QString("ERROR: could not find '...") + firstBadSongLine + QString("'");
@@ -6627,26 +6668,8 @@ void MainWindow::on_actionSave_Playlist_triggered()  // NOTE: this is really mis
     ui->actionSave->setText(QString("Save Playlist") + " '" + basefilename + "'"); // and now it has a name
 }
 
-void MainWindow::on_actionNext_Playlist_Item_triggered()
+int MainWindow::nextVisibleSongTableRow(int row)
 {
-    // This code is similar to the row double clicked code...
-    on_stopButton_clicked();  // if we're going to the next file in the playlist, stop current playback
-    saveCurrentSongSettings();
-
-    // figure out which row is currently selected
-    QItemSelectionModel *selectionModel = ui->songTable->selectionModel();
-    QModelIndexList selected = selectionModel->selectedRows();
-    int row = -1;
-    if (selected.count() == 1) {
-        // exactly 1 row was selected (good)
-        QModelIndex index = selected.at(0);
-        row = index.row();
-    }
-    else {
-        // more than 1 row or no rows at all selected (BAD)
-        return;
-    }
-
     int maxRow = ui->songTable->rowCount() - 1;
 
     // which is the next VISIBLE row?
@@ -6663,6 +6686,71 @@ void MainWindow::on_actionNext_Playlist_Item_triggered()
         //   hilarity will ensue.
         row = lastVisibleRow;
     }
+    return(row);
+}
+
+// Opens the song that on_actionNext_Playlist_Item_triggered() would load, on a worker thread,
+//   and makes sure that its analysis is in the cache (or on its way).  loadMP3File() then picks
+//   up the already-open stream, so advancing doesn't have to wait for the file (e.g. on a USB stick).
+//   Pitch, tempo and EQ are applied by loadMP3File() as usual; they're just attributes on the stream.
+void MainWindow::prefetchNextPlaylistItem()
+{
+    QModelIndexList selected = ui->songTable->selectionModel()->selectedRows();
+    if (selected.count() != 1) {
+        return;  // same rule as on_actionNext_Playlist_Item_triggered()
+    }
+
+    int row = selected.at(0).row();
+    int nextRow = nextVisibleSongTableRow(row);
+    if (nextRow == row) {
+        return;  // at the end of the list
+    }
+
+    QString pathToMP3 = ui->songTable->item(nextRow,kPathCol)->data(Qt::UserRole).toString();
+    if (pathToMP3.isEmpty()) {
+        return;
+    }
+
+    SongAnalysis analysis;
+    if (!songAnalyzer.lookup(songSettings, pathToMP3, analysis)) {
+        songAnalyzer.enqueue(pathToMP3, SongAnalyzer::kPriorityNextSong);
+    }
+
+    QString resolvedFilePath = QFileInfo(pathToMP3).symLinkTarget();  // same as loadMP3File()
+    if (resolvedFilePath != "") {
+        pathToMP3 = resolvedFilePath;
+    }
+    cBass.PrefetchStream(pathToMP3.toStdString().c_str());
+}
+
+void MainWindow::on_actionNext_Playlist_Item_triggered()
+{
+    // This code is similar to the row double clicked code...
+
+    // figure out which row is currently selected
+    QItemSelectionModel *selectionModel = ui->songTable->selectionModel();
+    QModelIndexList selected = selectionModel->selectedRows();
+    int row = -1;
+    if (selected.count() == 1) {
+        // exactly 1 row was selected (good)
+        QModelIndex index = selected.at(0);
+        row = index.row();
+    }
+
+    if (row >= 0 && ui->actionAutostart_playback->isChecked()) {
+        // the next song is going to start right away, so crossfade into it (this does nothing, if not playing)
+        //   NOTE: only once we know there IS a next song, because this lets go of the current one
+        cBass.StartCrossfade(kNextSongCrossfade_sec);
+    }
+    on_stopButton_clicked();  // if we're going to the next file in the playlist, stop current playback
+    saveCurrentSongSettings();
+
+    if (row < 0) {
+        // more than 1 row or no rows at all selected (BAD)
+        return;
+    }
+
+    row = nextVisibleSongTableRow(row);
     ui->songTable->selectRow(row); // select new row!
 
     // load all the UI fields, as if we double-clicked on the new row
@@ -6800,23 +6888,6 @@ void MainWindow::on_songTable_itemSelectionChanged()
 
 //    qDebug() << "Row " << selectedRow << " is selected now.";
 
-    if (selectedRow != -1) {
-        // we've clicked on a real row, which now needs its Title text to be highlighted
-
-        // first: let's un-highlight the previous SongTitleLabel back to its original color
-        if (lastSongTableRowSelected != -1) {
-            QString origColor = dynamic_cast<const SongTitleLabel*>(ui->songTable->cellWidget(lastSongTableRowSelected, kTitleCol))->textColor;
-            QString origColorStyleSheet("QLabel { color : %1; }");
-            ui->songTable->cellWidget(lastSongTableRowSelected, kTitleCol)->setStyleSheet(origColorStyleSheet.arg(origColor));
-        }
-
-        // second: let's highlight the current selected row's Title
-        QString songNameStyleSheet("QLabel { color : white; }");  // TODO: does this need to be fished out of some platform-specific QPalette somewhere?
-        ui->songTable->cellWidget(selectedRow, kTitleCol)->setStyleSheet(songNameStyleSheet);
-
-        lastSongTableRowSelected = selectedRow;  // remember that THIS row is now highlighted
-    }
-
     // turn them all OFF
     ui->actionAt_TOP->setEnabled(false);
     ui->actionAt_BOTTOM->setEnabled(false);
@@ -7149,6 +7220,118 @@ void MainWindow::PlaylistItemRemove() {
     on_songTable_itemSelectionChanged();  // reevaluate which menu items are enabled
 }
 
+// ------------------------------------------------------------------
+// the stored settings for a song, the way that loadSettingsForSong() and the sliders would apply them
+RenderSettings MainWindow::renderSettingsForSong(const QString &filepath, const QString &songType, const QString &songLabel)
+{
+    RenderSettings render;
+    render.mono = ui->actionForce_Mono_Aahz_mode->isChecked();
+    render.loop = songTypeNamesForPatter.contains(songType);  // the default, as in loadSettingsForSong()
+    render.loopUntil_sec = 60.0 * prefsManager.GettipLengthTimerLength();  // i.e. long enough for a whole patter tip
+
+    SongAnalysis analysis;
+    int baseBPM = 0;
+    if (songAnalyzer.lookup(songSettings, filepath, analysis) && analysis.valid) {
+        render.bpm = analysis.bpm;
+        baseBPM = songBPMForCurrentSong(analysis.bpm, analysis.id3BPM, songType, songLabel);
+    }
+
+    SongSetting settings;
+    if (songSettings.loadSettings(filepath, settings)) {
+        if (settings.isSetPitch()) { render.pitch = settings.getPitch(); }
+        if (settings.isSetTempo() && settings.getTempo() > 0) {
+            // same as on_tempoSlider_valueChanged()
+            if (settings.isSetTempoIsPercent() && settings.getTempoIsPercent()) {
+                render.tempo = settings.getTempo();
+            } else if (baseBPM > 0) {
+                render.tempo = static_cast<int>(round(100.0*settings.getTempo()/baseBPM));
+            }
+        }
+        if (settings.isSetBass()) { render.eq_dB[0] = settings.getBass(); }
+        if (settings.isSetMidrange()) { render.eq_dB[1] = settings.getMidrange(); }
+        if (settings.isSetTreble()) { render.eq_dB[2] = settings.getTreble(); }
+        if (settings.isSetMix()) { render.pan = settings.getMix()/100.0; }
+        if (settings.isSetIntroPos()) { render.introPos = settings.getIntroPos(); }
+        if (settings.isSetOutroPos()) { render.outroPos = settings.getOutroPos(); }
+        render.introOutroIsTimeBased = settings.isSetIntroOutroIsTimeBased() && settings.getIntroOutroIsTimeBased();
+        if (settings.isSetLoop() && settings.getLoop() != 0) {
+            render.loop = (settings.getLoop() == 1);
+        }
+    }
+    if (render.outroPos <= render.introPos) {
+        render.loop = false;  // no loop points set for this song
+    }
+    return render;
+}
+
+// Saves every song on the playlist to a folder, as FLAC files with the pitch, tempo, EQ, mix and
+//   loop settings already applied (e.g. for practice, or for a flash drive of dance-ready songs).
+//   Runs in the background, one song per core, much faster than real time.
+void MainWindow::renderPlaylist()
+{
+    if (renderWatcher.isRunning()) {
+        ui->statusBar->showMessage("Still saving the last playlist...");
+        return;
+    }
+
+    QString folder = QFileDialog::getExistingDirectory(this, tr("Save Playlist Songs To"), QDir::homePath());
+    if (folder.isEmpty()) {
+        return;
+    }
+
+    QMap<int, int> rowForNumber;  // playlist order
+    for (int i=0; i<ui->songTable->rowCount(); i++) {
+        QString numberText = ui->songTable->item(i, kNumberCol)->text();
+        if (numberText != "") {
+            rowForNumber.insert(numberText.toInt(), i);
+        }
+    }
+
+    QList<RenderJob> jobs;
+    for (auto it = rowForNumber.cbegin(); it != rowForNumber.cend(); ++it) {
+        int row = it.value();
+        QString pathToMP3 = ui->songTable->item(row, kPathCol)->data(Qt::UserRole).toString();
+
+        RenderJob job;
+        job.source = pathToMP3;
+        job.destination = QDir(folder).filePath(QString("%1 - %2.flac")
+                                                .arg(it.key(), 2, 10, QChar('0'))
+                                                .arg(QFileInfo(pathToMP3).completeBaseName()));
+        job.settings = renderSettingsForSong(pathToMP3,
+                                             ui->songTable->item(row, kTypeCol)->text(),
+                                             ui->songTable->item(row, kLabelCol)->text());
+        jobs.append(job);
+    }
+    if (jobs.isEmpty()) {
+        return;
+    }
+
+    ui->statusBar->showMessage(QString("Saving %1 songs to %2...").arg(jobs.size()).arg(folder));
+    renderTimer.start();
+    renderWatcher.setFuture(offlineRenderer.start(jobs));
+}
+
+void MainWindow::renderPlaylistFinished()
+{
+    QList<RenderResult> results = renderWatcher.result();
+
+    int saved = 0;
+    double audio_sec = 0.0;
+    for (const RenderResult &result : results) {
+        if (result.ok) {
+            saved++;
+            audio_sec += result.audio_sec;
+        }
+    }
+    double elapsed_sec = renderTimer.elapsed() / 1000.0;
+
+    QString msg = QString("Saved %1 of %2 songs (%3 minutes of music in %4 seconds, %5x realtime).")
+            .arg(saved).arg(results.size())
+            .arg(audio_sec / 60.0, 0, 'f', 1).arg(elapsed_sec, 0, 'f', 1)
+            .arg(elapsed_sec > 0.0 ? audio_sec / elapsed_sec : 0.0, 0, 'f', 0);
+    ui->statusBar->showMessage(msg);
+}
+
 
 void MainWindow::on_songTable_customContextMenuRequested(const QPoint &pos)
 {
@@ -7208,6 +7391,10 @@ void MainWindow::on_songTable_customContextMenuRequested(const QPoint &pos)
                 menu.addSeparator();
                 menu.addAction ( "Remove from playlist" , this , SLOT (PlaylistItemRemove()) );
             }
+            if (playlistItemCount > 0) {
+                menu.addSeparator();
+                menu.addAction ( "Save playlist songs to folder..." , this , SLOT (renderPlaylist()) );
+            }
         }
         menu.addSeparator();
 
@@ -7297,7 +7484,7 @@ void MainWindow::changeTagOnCurrentSongSelection(QString tag, bool add)
         songSettings.saveSettings(pathToMP3, settings);
         QString title = getTitleColTitle(ui->songTable, row);
         QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags()));
-        dynamic_cast<QLabel*>(ui->songTable->cellWidget(row,kTitleCol))->setText(titlePlusTags);
+        ui->songTable->item(row,kTitleCol)->setData(kTitlePlusTagsRole, titlePlusTags);
     }
 }
 
@@ -7327,7 +7514,7 @@ void MainWindow::editTags()
             songSettings.addTags(newtags);
 
             QString titlePlusTags(FormatTitlePlusTags(title, settings.isSetTags(), settings.getTags()));
-            dynamic_cast<QLabel*>(ui->songTable->cellWidget(row,kTitleCol))->setText(titlePlusTags);
+            ui->songTable->item(row,kTitleCol)->setData(kTitlePlusTagsRole, titlePlusTags);
         }
     }
     else {
@@ -8369,11 +8556,19 @@ void MainWindow::playSFX(QString which) {
         soundEffectFile = musicRootPath + "/soundfx/" + which + ".mp3";
     }
 
-    if(QFileInfo(soundEffectFile).exists()) {
-        // play sound FX only if file exists...
-        cBass.PlayOrStopSoundEffect(which.toInt(),
-                                    soundEffectFile.toLocal8Bit().constData());  // convert to C string; defaults to volume 100%
+    // already decoded in memory by preloadSoundFX() (if it exists), so this doesn't touch the disk
+    cBass.PlayOrStopSoundEffect(which.toInt(), soundEffectFile);  // defaults to volume 100%
+}
+
+// decode all of the sound effects now, so that there's no delay when they're triggered during a dance
+void MainWindow::preloadSoundFX() {
+    QStringList soundEffectFiles = soundFXfilenames.values();
+    QStringList namedEffects;
+    namedEffects << "thirty_second_warning" << "long_tip" << "break_over";
+    for (const QString &name : namedEffects) {
+        soundEffectFiles.append(musicRootPath + "/soundfx/" + name + ".mp3");  // same as playSFX()
     }
+    cBass.PreloadSoundEffects(soundEffectFiles);
 }
 
 void MainWindow::on_actionClear_Recent_List_triggered()
@@ -9049,8 +9244,6 @@ void MainWindow::usePersistentFontSize() {
 
     t.elapsed(__LINE__);
 
-    setSongTableFont(ui->songTable, currentFont);
-    t.elapsed(__LINE__);
 
     adjustFontSizes();  // use that font size to scale everything else (relative)
     t.elapsed(__LINE__);
@@ -9085,7 +9278,6 @@ void MainWindow::zoomInOut(int increment) {
 
     ui->songTable->setStyleSheet(QString("QTableWidget::item:selected{ color: #FFFFFF; background-color: #4C82FC } QHeaderView::section { font-size: %1pt; }").arg(platformPS));
 
-    setSongTableFont(ui->songTable, currentFont);
     adjustFontSizes();
 //    qDebug() << "currentMacPointSize:" << newPointSize << ", totalZoom:" << totalZoom;
 }
@@ -9114,7 +9306,6 @@ void MainWindow::on_actionReset_triggered()
     totalZoom = 0;
 
     persistNewFontSize(currentMacPointSize);
-    setSongTableFont(ui->songTable, currentFont);
     adjustFontSizes();
 //    qDebug() << "currentMacPointSize:" << currentMacPointSize << ", totalZoom:" << totalZoom;
 }
@@ -9854,86 +10045,121 @@ void MainWindow::fetchListOfCuesheetsFromCloud() {
     progressTimer->start(1000);  // once per second to 33%
 }
 
-bool MainWindow::fuzzyMatchFilenameToCuesheetname(QString s1, QString s2) {
-//    qDebug() << "trying to match: " << s1 << "," << s2;
+// breaks apart a music or cuesheet filename (no path needed) into the parts that the cuesheet matcher compares
+CuesheetMatchKeys MainWindow::cuesheetMatchKeysForFilename(const QString &filename)
+{
+    QString completeBaseName = QFileInfo(filename).completeBaseName(); // e.g. "/Users/mpogue/__squareDanceMusic/patter/RIV 307 - Going to Ceili (Patter).mp3" --> "RIV 307 - Going to Ceili (Patter)"
+    QString label = "";
+    QString labelnum = "";
+    QString labelnum_extra = "";
+    QString title = "";
+    QString shortTitle = "";
+    breakFilenameIntoParts(completeBaseName, label, labelnum, labelnum_extra, title, shortTitle);
 
-// **** EXACT MATCH OF COMPLETE BASENAME (just for testing)
-//    QFileInfo fi1(s1);
-//    QFileInfo fi2(s2);
+    CuesheetMatchKeys keys = CuesheetMatchKeys::fromParts(completeBaseName, label, labelnum, title, shortTitle);
+    keys.path = filename;
+    return keys;
+}
 
-//    bool match = fi1.completeBaseName() == fi2.completeBaseName();
-//    if (match) {
-//        qDebug() << "fuzzy match: " << s1 << "," << s2;
-//    }
+bool MainWindow::fuzzyMatchFilenameToCuesheetname(QString s1, QString s2) {
+//    qDebug() << "trying to match: " << s1 << "," << s2;
 
-//    return(match);
+    // OUR FUZZY MATCHING (same as findPossibleCuesheets):
+    //   minimum criteria (we will accept as a match, without looking at sorted words), or
+    //   fuzzy match, using the sorted words in the titles
+    return CuesheetMatchKeys::matches(cuesheetMatchKeysForFilename(s1), cuesheetMatchKeysForFilename(s2));
+}
 
-// **** OUR FUZZY MATCHING (same as findPossibleCuesheets)
+// Runs map() over sequence on the thread pool, but keeps the UI (and the progress dialog's Cancel button)
+//   alive until it is done.  Cancel sets canceled, which map() checks before doing any work.
+template <typename Sequence, typename MapFunctor>
+static void mapWhileShowingProgress(QProgressDialog *progressDialog, QAtomicInt &canceled,
+                                    Sequence &sequence, MapFunctor map)
+{
+    if (canceled.loadAcquire() != 0) {
+        return;
+    }
+    QFutureWatcher<void> watcher;
+    QEventLoop loop;
+    QObject::connect(&watcher, &QFutureWatcher<void>::finished, &loop, &QEventLoop::quit);
+    QMetaObject::Connection cancelConnection =
+        QObject::connect(progressDialog, &QProgressDialog::canceled, [&canceled]() { canceled.storeRelease(1); });
+    watcher.setFuture(QtConcurrent::map(sequence, map));
+    if (!watcher.isFinished()) {
+        loop.exec();
+    }
+    QObject::disconnect(cancelConnection);
+    if (progressDialog->wasCanceled()) {
+        canceled.storeRelease(1);
+    }
+}
 
-    // SPLIT APART THE MUSIC FILENAME --------
-    QFileInfo mp3FileInfo(s1);
-    QString mp3CanonicalPath = mp3FileInfo.canonicalPath();
-    QString mp3CompleteBaseName = mp3FileInfo.completeBaseName();
-    QString mp3Label = "";
-    QString mp3Labelnum = "";
-    QString mp3Labelnum_short = "";
-    QString mp3Labelnum_extra = "";
-    QString mp3Title = "";
-    QString mp3ShortTitle = "";
-    breakFilenameIntoParts(mp3CompleteBaseName, mp3Label, mp3Labelnum, mp3Labelnum_extra, mp3Title, mp3ShortTitle);
-    QList<CuesheetWithRanking *> possibleRankings;
+// Same answer as calling fuzzyMatchFilenameToCuesheetname() for every (music, cuesheet) pair, and keeping
+//   each cuesheet that matches at least one music file, in the original cuesheet order.
+//   Each name is broken apart just once, the cuesheets are indexed, and each music file only looks at
+//   the cuesheets that could match it (on all cores).  Returns an empty list if the progress dialog is canceled.
+QList<QString> MainWindow::findCuesheetsMatchingMusic(const QList<QString> &cuesheets, const QList<QString> &musicFiles)
+{
+    PerfTimer t("findCuesheetsMatchingMusic", __LINE__);
 
-    QStringList mp3Words = splitIntoWords(mp3CompleteBaseName);
-    mp3Labelnum_short = mp3Labelnum;
-    while (mp3Labelnum_short.length() > 0 && mp3Labelnum_short[0] == '0')
-    {
-        mp3Labelnum_short.remove(0,1);
+    QVector<CuesheetMatchKeys> cuesheetKeys(cuesheets.length());
+    QVector<CuesheetMatchKeys> musicKeys(musicFiles.length());
+    for (int i = 0; i < cuesheets.length(); i++) {
+        cuesheetKeys[i].path = cuesheets[i];
+    }
+    for (int i = 0; i < musicFiles.length(); i++) {
+        musicKeys[i].path = musicFiles[i];
     }
+    QAtomicInt canceled(progressDialog->wasCanceled() ? 1 : 0);
+    auto breakApart = [this, &canceled](CuesheetMatchKeys &keys) {
+        if (canceled.loadAcquire() == 0) {
+            keys = cuesheetMatchKeysForFilename(keys.path);
+        }
+    };
+    mapWhileShowingProgress(progressDialog, canceled, cuesheetKeys, breakApart);
+    mapWhileShowingProgress(progressDialog, canceled, musicKeys, breakApart);
+    if (canceled.loadAcquire() != 0) {
+        return QList<QString>();
+    }
+    t.elapsed(__LINE__);
 
-    // SPLIT APART THE CUESHEET FILENAME --------
-    QFileInfo fi(s2);
-    QString label = "";
-    QString labelnum = "";
-    QString title = "";
-    QString labelnum_extra;
-    QString shortTitle = "";
+    // the same cuesheet name can be in the list more than once, it's indexed once
+    CuesheetMatchIndex index;
+    for (const CuesheetMatchKeys &keys : cuesheetKeys) {
+        index.add(keys);
+    }
+    QVector<QAtomicInt> matched(index.size());  // by slot
+    t.elapsed(__LINE__);
 
-    QString completeBaseName = fi.completeBaseName(); // e.g. "/Users/mpogue/__squareDanceMusic/patter/RIV 307 - Going to Ceili (Patter).mp3" --> "RIV 307 - Going to Ceili (Patter)"
-    breakFilenameIntoParts(completeBaseName, label, labelnum, labelnum_extra, title, shortTitle);
-    QStringList words = splitIntoWords(completeBaseName);
-    QString labelnum_short = labelnum;
-    while (labelnum_short.length() > 0 && labelnum_short[0] == '0')
-    {
-        labelnum_short.remove(0,1);
+    mapWhileShowingProgress(progressDialog, canceled, musicKeys, [&index, &matched, &canceled](const CuesheetMatchKeys &song) {
+        if (canceled.loadAcquire() != 0) {
+            return;
+        }
+        for (int slot : index.candidates(song)) {
+            if (matched[slot].loadAcquire() == 0 && CuesheetMatchKeys::matches(song, index.at(slot))) {
+                matched[slot].storeRelease(1);
+            }
+        }
+    });
+    if (canceled.loadAcquire() != 0) {
+        return QList<QString>();
     }
+    t.elapsed(__LINE__);
 
-    // NOW SCORE IT ----------------------------
-    int score = 0;
-//    qDebug() << "label: " << label;
-    if (completeBaseName.compare(mp3CompleteBaseName, Qt::CaseInsensitive) == 0         // exact match: entire filename
-        || title.compare(mp3Title, Qt::CaseInsensitive) == 0                            // exact match: title (without label/labelNum)
-        || (shortTitle.length() > 0                                                     // exact match: shortTitle
-            && shortTitle.compare(mp3ShortTitle, Qt::CaseInsensitive) == 0)
-        || (labelnum_short.length() > 0 && label.length() > 0                           // exact match: shortLabel + shortLabelNumber
-            &&  labelnum_short.compare(mp3Labelnum_short, Qt::CaseInsensitive) == 0
-            && label.compare(mp3Label, Qt::CaseInsensitive) == 0
-            )
-        || (labelnum.length() > 0 && label.length() > 0
-            && mp3Title.length() > 0
-            && mp3Title.compare(label + "-" + labelnum, Qt::CaseInsensitive) == 0)
-        )
-    {
-        // Minimum criteria (we will accept as a match, without looking at sorted words):
-//        qDebug() << "fuzzy match (meets minimum criteria): " << s1 << "," << s2;
-        return(true);
-    } else if ((score = compareSortedWordListsForRelevance(mp3Words, words)) > 0)
-    {
-        // fuzzy match, using the sorted words in the titles
-//        qDebug() << "fuzzy match (meets sorted words criteria): " << s1 << "," << s2;
-        return(true);
+    QSet<QString> matchedNames;
+    for (int slot = 0; slot < matched.size(); slot++) {
+        if (matched[slot].loadAcquire() != 0) {
+            matchedNames.insert(index.at(slot).path);
+        }
     }
 
-    return(false);
+    QList<QString> result;
+    for (const QString &cuesheet : cuesheets) {
+        if (matchedNames.contains(cuesheet)) {
+            result.append(cuesheet);
+        }
+    }
+    return result;
 }
 
 void MainWindow::cuesheetListDownloadEnd() {
@@ -9963,40 +10189,16 @@ void MainWindow::cuesheetListDownloadEnd() {
 //    qDebug() << "***** Here's the list of musicFiles:" << musicFiles;
 //    qDebug() << "***** Here's the list of cuesheets:" << cuesheetsInCloud;
 
-    double numCuesheets = cuesheetsInCloud.length();
-    double numChecked = 0;
+    progressDialog->setLabelText("Matching your music with " +
+                                 QString::number(static_cast<unsigned int>(cuesheetsInCloud.length())) +
+                                 " cuesheets...");
+    qApp->processEvents();  // allow the progress bar to move
 
     // match up the music filenames against the cuesheets that the Cloud has
-    QList<QString> maybeFilesToDownload;
-
-    QList<QString>::iterator i;
-    QList<QString>::iterator j;
-    for (j = cuesheetsInCloud.begin(); j != cuesheetsInCloud.end(); ++j) {
-        // should we download this Cloud cuesheet file?
-
-        if ( static_cast<unsigned int>(numChecked) % 50 == 0 ) {
-            progressDialog->setLabelText("Found matching cuesheets: " +
-                                         QString::number(static_cast<unsigned int>(maybeFilesToDownload.length())) +
-                                         " out of " + QString::number(static_cast<unsigned int>(numChecked)) +
-                                         "\n" + (maybeFilesToDownload.length() > 0 ? maybeFilesToDownload.last() : "")
-                                         );
-            progressDialog->setValue(static_cast<int>(33 + 33.0*(numChecked/numCuesheets)));
-            qApp->processEvents();  // allow the progress bar to move every 100 checks
-            if (progressDialog->wasCanceled()) {
-                return;
-            }
-        }
-
-        numChecked++;
-
-        for (i = musicFiles.begin(); i != musicFiles.end(); ++i) {
-            if (fuzzyMatchFilenameToCuesheetname(*i, *j)) {
-                // yes, let's download it, if we don't have it already.
-                maybeFilesToDownload.append(*j);
-//                qDebug() << "Will maybe download: " << *j;
-                break;  // once we've decided to download this file, go on and look at the NEXT cuesheet
-            }
-        }
+    //   (should we download this Cloud cuesheet file?)
+    QList<QString> maybeFilesToDownload = findCuesheetsMatchingMusic(cuesheetsInCloud, musicFiles);
+    if (progressDialog->wasCanceled()) {
+        return;
     }
 
     progressDialog->setValue(66);
@@ -10103,21 +10305,14 @@ QList<QString> MainWindow::getListOfMusicFiles()
 {
     QList<QString> list;
 
-    QListIterator<QString> iter(*pathStack);
-    while (iter.hasNext()) {
-        QString s = iter.next();
-        QStringList sl1 = s.split("#!#");
-        QString type = sl1[0];      // the type (of original pathname, before following aliases)
-        QString filename = sl1[1];  // everything else
-
-        // TODO: should we allow "patter" to match cuesheets?
-        if ((type == "singing" || type == "vocals") && (filename.endsWith("mp3", Qt::CaseInsensitive) ||
-                                                        filename.endsWith("m4a", Qt::CaseInsensitive) ||
-                                                        filename.endsWith("wav", Qt::CaseInsensitive))) {
-            QFileInfo fi(filename);
-            QString justFilename = fi.fileName();
+    // TODO: should we allow "patter" to match cuesheets?
+    QVector<int> indexes = musicLibrary.indexesOfType("singing") + musicLibrary.indexesOfType("vocals");
+    for (int i : indexes) {
+        const LibraryEntry &entry = musicLibrary.at(i);
+        if (entry.kind == LibraryFileMusic) {
+            QString justFilename = QFileInfo(entry.path).fileName();
             list.append(justFilename);
-//            qDebug() << "music that might have a cuesheet: " << type << ":" << justFilename;
+//            qDebug() << "music that might have a cuesheet: " << entry.type << ":" << justFilename;
         }
     }
 
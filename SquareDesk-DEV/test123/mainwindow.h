@@ -64,6 +64,8 @@
 #include <QGraphicsScene>
 #include <QGraphicsItemGroup>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 
 #include "common_enums.h"
 #include "sdhighlighter.h"
@@ -78,6 +80,12 @@
 #include "console.h"
 #include "renderarea.h"
 #include "songsettings.h"
+#include "songanalyzer.h"
+#include "offlinerenderer.h"
+#include "musicdirectoryindex.h"
+#include "libraryentry.h"
+#include "cuesheetmatchindex.h"
+#include "songsearchindex.h"
 
 #if defined(Q_OS_MAC)
 #include "macUtils.h"
@@ -241,6 +249,7 @@ protected:
     void airplaneMode(bool turnItOn);
 
 private slots:
+    void songAnalysisReady(const SongAnalysis &analysis);
     void sdActionTriggered(QAction * action);  // checker style
     void sdAction2Triggered(QAction * action); // SD level
 
@@ -351,6 +360,8 @@ private slots:
 
     void columnHeaderResized(int logicalIndex, int oldSize, int newSize);
     void columnHeaderSorted(int logicalIndex, Qt::SortOrder order);
+    void songTableRowsChanged();
+    void songTableDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
 
     void on_warningLabel_clicked();
     void on_warningLabelCuesheet_clicked();
@@ -378,6 +389,8 @@ private slots:
     void PlaylistItemMoveUp();          // moves up one position (must already be on the list)
     void PlaylistItemMoveDown();        // moves down one position (must already be on the list)
     void PlaylistItemRemove();      // removes item from the playlist (must already be on the list)
+    void renderPlaylist();          // saves the playlist songs to files, with their pitch/tempo/EQ/loop settings
+    void renderPlaylistFinished();
 
     void on_actionAt_TOP_triggered();
 
@@ -410,7 +423,7 @@ private slots:
     void makeProgress();
     void cancelProgress();
 
-    void musicRootModified(QString s);
+    void musicRootModified();
     void maybeLyricsChanged();
 
     // END SLOTS -----------
@@ -542,14 +555,12 @@ public:
     void do_sd_double_click_call_completion(QListWidgetItem *item);
     void highlight_sd_replaceables();
     void populateMenuSessionOptions();
-    void titleLabelDoubleClicked(QMouseEvent * /* event */);
     void sdSequenceCallLabelDoubleClicked(QMouseEvent * /* event */);
     void submit_lineEditSDInput_contents_to_sd();
 private:
 
     bool flashCallsVisible;
 
-    int lastSongTableRowSelected;
 
     // Lyrics editor -------
     enum charsType { TitleChars=1, LabelChars=96, ArtistChars=255, HeaderChars=2, LyricsChars=3, NoneChars=0}; // matches blue component of CSS definition
@@ -575,7 +586,9 @@ private:
     void fetchListOfCuesheetsFromCloud();
     QList<QString> getListOfCuesheets();
     QList<QString> getListOfMusicFiles();
+    CuesheetMatchKeys cuesheetMatchKeysForFilename(const QString &filename);
     bool fuzzyMatchFilenameToCuesheetname(QString s1, QString s2);
+    QList<QString> findCuesheetsMatchingMusic(const QList<QString> &cuesheets, const QList<QString> &musicFiles);
     void downloadCuesheetFileIfNeeded(QString cuesheetFilename);
 
     int linesInCurrentPlaylist;      // 0 if no playlist loaded (not likely, because of current.m3u)
@@ -602,6 +615,13 @@ private:
     enum SongFilenameMatchingType songFilenameFormat;
 
     QFileSystemWatcher musicRootWatcher;  // watch for add/deletes in musicRootPath
+    QTimer *musicRootModifiedTimer;       // coalesces musicRootWatcher notifications
+    MusicDirectoryIndex musicDirectoryIndex;  // so that findMusic only lists directories that changed
+    void updateMusicRootWatcher();
+    void addFilesToMusicLibrary(QDir rootDir, const QStringList &files, QString suffix, QMap<int, QString> *soundFXarray, QMap<int, QString> *soundFXname);
+    void addToMusicLibrary(const QString &type, const QString &path, bool guest);
+    void reparseMusicLibrary();
+    CuesheetMatchIndex cuesheetMatchIndex;  // the cuesheets in musicLibrary, by name/title/label/word
     QFileSystemWatcher lyricsWatcher;     // watch for add/deletes in musicRootPath/lyrics
 
     bool showTimersTab;         // EXPERIMENTAL TIMERS STUFF
@@ -652,6 +672,12 @@ private:
 
     void reloadCurrentMP3File();
     void loadMP3File(QString filepath, QString songTitle, QString songType, QString songLabel);
+    void setSeekBarWaveforms(const SongAnalysis &analysis);
+    int nextVisibleSongTableRow(int row);  // the row that the next playlist item button would go to
+    void prefetchNextPlaylistItem();       // open the next song in the background, so that advancing is instant
+    RenderSettings renderSettingsForSong(const QString &filepath, const QString &songType, const QString &songLabel);
+    int songBPMForCurrentSong(double detectedBPM, double songBPM_ID3, const QString &songType, const QString &songLabel);
+    void setupTempoSlider(int songBPM, const QString &songType);
     void maybeLoadCSSfileIntoTextBrowser();
     void loadCuesheet(const QString &cuesheetFilename);
     void loadCuesheets(const QString &MP3FileName, const QString preferredCuesheet = QString());
@@ -659,8 +685,10 @@ private:
     bool breakFilenameIntoParts(const QString &s, QString &label, QString &labelnum, QString &labenum_extra,
                                 QString &title, QString &shortTitle );
 
-    void findMusic(QString mainRootDir, QString guestRootDir, QString mode, bool refreshDatabase);    // get the filenames into pathStack
+    void findMusic(QString mainRootDir, QString guestRootDir, QString mode, bool refreshDatabase);    // get the filenames into musicLibrary
     void filterMusic();  // filter them into the songTable
+    void updateSongSearchIndex();
+    SongSearchIndex songSearchIndex;  // what filterMusic() searches, by songTable row
     void loadMusicList();  // filter them into the songTable
     QString FormatTitlePlusTags(const QString &title, bool setTags, const QString &strtags);
     void changeTagOnCurrentSongSelection(QString tag, bool add);
@@ -685,7 +713,10 @@ private:
 
     // Playlist stuff ----------
     void savePlaylistAgain();  // saves with the same name we used last time (if there was a last time)
-    QString loadPlaylistFromFile(QString PlaylistFileName, int &songCount); // returns error song string and songCount
+    QString loadPlaylistFromFile(QString PlaylistFileName, int &songCount, int *movedSongCount = nullptr); // returns error song string and songCount
+    int songTableRowForPath(const QString &path, bool *moved);  // -1 if not found
+    QHash<QString, int> songTableRowByPath;      // built on demand, cleared when the rows change
+    QHash<QString, int> songTableRowByFilename;  // lowercase filename only, -1 if more than one row has it
     void finishLoadingPlaylist(QString PlaylistFileName);
 
     void saveCurrentPlaylistToFile(QString PlaylistFileName);
@@ -701,7 +732,7 @@ private:
 
     QString txtToHTMLlyrics(QString text, QString filePathname);
 
-    QList<QString> *pathStack;
+    MusicLibrary musicLibrary;  // everything findMusic found, by kind and by type
 
     // Experimental Timer stuff ----------
     QTimer *timerCountUp;
@@ -737,6 +768,12 @@ private:
     QTimer *vuMeterTimer;
 
     LevelMeter *vuMeter;
+    int vuMeterIdleTicks;  // ticks in a row with no new levels from the audio thread
+
+    // offline rendering of the playlist (see renderPlaylist())
+    OfflineRenderer offlineRenderer;
+    QFutureWatcher<QList<RenderResult> > renderWatcher;
+    QElapsedTimer renderTimer;
 
     AnalogClock *analogClock;
 
@@ -777,6 +814,7 @@ private:
     bool voiceInputEnabled;
 
     SongSettings songSettings;
+    SongAnalyzer songAnalyzer;
     PreferencesManager prefsManager;
 
     bool firstTimeSongIsPlayed;
@@ -810,6 +848,7 @@ private:
     QMap<int, QString> soundFXfilenames;    // e.g. "9.foo.mp3" --> [9,"9.foo.mp3"]
     QMap<int, QString> soundFXname;         // e.g. "9.foo.mp3" --> [9,"foo"]
     void maybeInstallSoundFX();
+    void preloadSoundFX();
     void maybeInstallReferencefiles();
 
     int totalZoom;  // total zoom for Lyrics pane, so it can be undone with a Reset Zoom
@@ -0,0 +1,146 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "meterfeed.h"
+#include <chrono>
+#include <math.h>
+
+static long long now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ------------------------------------------------------------------
+MeterFeed::MeterFeed() :
+    pausedAt_us(0),
+    pausedTotal_us(0),
+    flushRequested(false),
+    bufferedUntil_us(0)
+{
+}
+
+// real time, minus the time spent paused
+long long MeterFeed::clock_us() const
+{
+    long long pausedAt = pausedAt_us;
+    return (pausedAt != 0 ? pausedAt : now_us()) - pausedTotal_us;
+}
+
+// ------------------------------------------------------------------
+// BASS calls the DSP once per update period (~100ms), or a whole playback buffer at once
+//   right after a flush.  Either way, this audio goes into the playback buffer after everything
+//   that was published before it, and nothing is ever older than right now.
+void MeterFeed::publish(const float *buffer, int frames, int channels, float sampleRate)
+{
+    if (frames <= 0 || channels <= 0 || sampleRate <= 0.0f) {
+        return;
+    }
+
+    long long now = clock_us();
+    if (flushRequested.exchange(false) || bufferedUntil_us < now) {
+        bufferedUntil_us = now;  // the playback buffer is empty (or ran dry)
+    }
+
+    int blockFrames = static_cast<int>(sampleRate) / kBlocksPerSecond;
+    if (blockFrames < 1) {
+        blockFrames = 1;
+    }
+    const double us_per_frame = 1000000.0 / sampleRate;
+
+    for (int start = 0; start < frames; start += blockFrames) {
+        int n = (frames - start < blockFrames ? frames - start : blockFrames);
+        const float *d = buffer + start * channels;
+
+        float sumOfSquares = 0.0f;
+        float peak = 0.0f;
+        for (int i = 0; i < n * channels; i++) {
+            float x = d[i];
+            sumOfSquares += x * x;
+            float a = fabsf(x);
+            peak = (a > peak ? a : peak);
+        }
+
+        MeterBlock block;
+        block.rms = sqrtf(sumOfSquares / (n * channels));
+        block.peak = peak;
+        block.frames = n;
+        block.due_us = bufferedUntil_us;
+        ring.push(block);  // if the UI isn't reading (e.g. minimized), just drop it
+
+        bufferedUntil_us += static_cast<long long>(n * us_per_frame);
+    }
+}
+
+// ------------------------------------------------------------------
+bool MeterFeed::read(MeterBlock *levels)
+{
+    long long now = clock_us();
+
+    double sumOfSquares = 0.0;
+    int frames = 0;
+    float peak = 0.0f;
+    long long due = 0;
+
+    const MeterBlock *block;
+    while ((block = ring.front()) != nullptr && block->due_us <= now) {
+        sumOfSquares += static_cast<double>(block->rms) * block->rms * block->frames;
+        frames += block->frames;
+        peak = (block->peak > peak ? block->peak : peak);
+        due = block->due_us;
+        ring.pop();
+    }
+
+    if (frames == 0) {
+        return false;
+    }
+
+    levels->rms = static_cast<float>(sqrt(sumOfSquares / frames));
+    levels->peak = peak;
+    levels->frames = frames;
+    levels->due_us = due;
+    return true;
+}
+
+void MeterFeed::flush()
+{
+    ring.clear();
+    flushRequested = true;
+}
+
+void MeterFeed::pause()
+{
+    long long expected = 0;
+    pausedAt_us.compare_exchange_strong(expected, now_us());
+}
+
+void MeterFeed::resume()
+{
+    long long pausedAt = pausedAt_us;
+    if (pausedAt != 0) {
+        pausedTotal_us += now_us() - pausedAt;  // (before restarting the clock, so it never jumps ahead)
+        pausedAt_us = 0;
+    }
+}
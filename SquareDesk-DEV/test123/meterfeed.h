@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef METERFEED_H_INCLUDED
+#define METERFEED_H_INCLUDED
+
+#include <atomic>
+
+// A fixed size, lock-free ring for exactly one producer thread and one consumer thread.
+//   push() never blocks (if the ring is full, the item is dropped), so it's safe on the audio thread.
+template <typename T, int Capacity>
+class SpscRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    // -- producer --
+    bool push(const T &item)
+    {
+        unsigned int h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity) {
+            return false;  // full
+        }
+        items[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // -- consumer --
+    const T *front() const  // nullptr if empty
+    {
+        unsigned int t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &items[t & (Capacity - 1)];
+    }
+    void pop()
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    void clear()
+    {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    T items[Capacity];
+    std::atomic<unsigned int> head;  // written by the producer only
+    std::atomic<unsigned int> tail;  // written by the consumer only
+};
+
+// Levels of one short block of audio, as it left the DSP chain (linear, 1.0 = full scale).
+//   Spectrum or loudness data can be added here later.
+class MeterBlock
+{
+public:
+    float rms;
+    float peak;
+    int frames;
+    long long due_us;  // when this block will actually be heard, on the MeterFeed clock
+};
+
+// Metering for the music stream: the audio thread measures every block it processes, and
+//   publishes the results; the UI reads them whenever it repaints, without ever calling into
+//   the audio engine.
+//
+// BASS processes audio well ahead of the speakers (the playback buffer), so each block is
+//   stamped with when it will be heard, and read() only returns the blocks that are due.
+//   The clock stops while the stream is paused, so the blocks still in the playback buffer
+//   stay in sync when it resumes.
+class MeterFeed
+{
+public:
+    static const int kBlocksPerSecond = 100;  // i.e. 10ms blocks
+
+    MeterFeed();
+
+    // -- audio thread (the DSP callback) --
+    void publish(const float *buffer, int frames, int channels, float sampleRate);
+
+    // -- UI thread --
+    bool read(MeterBlock *levels);  // all of the blocks that are due, combined; false if there are none
+    void flush();                   // the playback buffer was thrown away (new song, seek, stop)
+    void pause();
+    void resume();
+
+private:
+    long long clock_us() const;
+
+    SpscRing<MeterBlock, 256> ring;  // a few seconds worth, much more than the playback buffer
+
+    std::atomic<long long> pausedAt_us;     // real time when the clock stopped, 0 = running
+    std::atomic<long long> pausedTotal_us;  // how long the clock has been stopped, in total
+    std::atomic<bool> flushRequested;
+
+    // audio thread only
+    long long bufferedUntil_us;  // when the audio published so far will be done playing
+};
+
+#endif /* ifndef METERFEED_H_INCLUDED */
@@ -0,0 +1,217 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "musicdirectoryindex.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QSet>
+#include <QStack>
+
+static const quint32 kIndexMagic = 0x53444449;  // "SDDI"
+static const qint32 kIndexVersion = 1;
+
+// FAT (e.g. USB sticks) only has 2 second resolution on mtimes, so a directory that was
+//   changed again right after we listed it might still have the same mtime.  Don't trust
+//   the mtime of a directory that was listed within this long of its last change.
+static const qint64 kMTimeResolution_ms = 2000;
+
+MusicDirectoryIndex::MusicDirectoryIndex()
+    : root(), skippedDir(), filters(), dirs(), dirOrder()
+{
+}
+
+void MusicDirectoryIndex::clear()
+{
+    root.clear();
+    filters.clear();
+    dirs.clear();
+    dirOrder.clear();
+}
+
+bool MusicDirectoryIndex::isCurrent(const DirectoryEntry &entry, qint64 modified)
+{
+    return entry.modified == modified && entry.listedAt - modified > kMTimeResolution_ms;
+}
+
+MusicDirectoryIndex::DirectoryEntry MusicDirectoryIndex::listDirectory(const QString &dirPath, qint64 modified) const
+{
+    DirectoryEntry entry;
+    entry.modified = modified;
+    entry.listedAt = QDateTime::currentMSecsSinceEpoch();
+
+    QDir dir(dirPath);
+    entry.files = dir.entryList(filters, QDir::Files, QDir::NoSort);  // follows symlinks, like QDirIterator::FollowSymlinks
+    entry.subdirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::NoSort);
+    for (int i = entry.subdirs.size() - 1; i >= 0; i--) {
+        if (dirPath + "/" + entry.subdirs[i] == skippedDir) {
+            entry.subdirs.removeAt(i);
+        }
+    }
+    return entry;
+}
+
+int MusicDirectoryIndex::update(const QString &rootDir, const QStringList &nameFilters, const QString &indexFilename)
+{
+    if (rootDir != root) {
+        clear();
+        load(indexFilename);
+        if (rootDir != root) {
+            dirs.clear();  // index for some other music directory
+            root = rootDir;
+        }
+    }
+    if (nameFilters != filters) {
+        dirs.clear();  // e.g. new file types, so everything has to be listed again
+        filters = nameFilters;
+    }
+    skippedDir = indexFilename.left(indexFilename.lastIndexOf('/'));  // spelled the way the paths below are
+
+    QHash<QString, DirectoryEntry> updated;
+    QStringList updatedOrder;
+    QSet<QString> visited;  // canonical paths, so that symlink loops terminate
+    QStack<QString> toVisit;
+    toVisit.push(root);
+
+    int relisted = 0;
+    while (!toVisit.isEmpty()) {
+        QString dirPath = toVisit.pop();
+        if (dirPath == skippedDir) {
+            continue;  // (an index saved before it was skipped might still list it)
+        }
+        QFileInfo fi(dirPath);
+        if (!fi.isDir()) {
+            continue;  // deleted since the last time
+        }
+        QString canonicalPath = fi.canonicalFilePath();
+        if (visited.contains(canonicalPath)) {
+            continue;
+        }
+        visited.insert(canonicalPath);
+
+        qint64 modified = fi.lastModified().toMSecsSinceEpoch();
+        QHash<QString, DirectoryEntry>::const_iterator cached = dirs.constFind(dirPath);
+        DirectoryEntry entry;
+        if (cached != dirs.constEnd() && isCurrent(cached.value(), modified)) {
+            entry = cached.value();
+        } else {
+            entry = listDirectory(dirPath, modified);
+            relisted++;
+        }
+
+        for (int i = entry.subdirs.size() - 1; i >= 0; i--) {
+            toVisit.push(dirPath + "/" + entry.subdirs[i]);  // reversed, so that they come off the stack in order
+        }
+        updated.insert(dirPath, entry);
+        updatedOrder.append(dirPath);
+    }
+
+    bool changed = (relisted > 0 || updated.size() != dirs.size());  // listed again, or deleted
+    dirs.swap(updated);
+    dirOrder.swap(updatedOrder);
+    if (changed) {
+        save(indexFilename);
+    }
+
+    return relisted;
+}
+
+QStringList MusicDirectoryIndex::files() const
+{
+    QStringList result;
+    for (const QString &dirPath : dirOrder) {
+        const DirectoryEntry &entry = dirs[dirPath];
+        for (const QString &name : entry.files) {
+            result.append(dirPath + "/" + name);
+        }
+    }
+    return result;
+}
+
+QStringList MusicDirectoryIndex::directories() const
+{
+    return dirOrder;
+}
+
+// ------------------------------------------------------------------
+bool MusicDirectoryIndex::load(const QString &indexFilename)
+{
+    QFile file(indexFilename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;  // not there yet, that's OK
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic;
+    qint32 version;
+    in >> magic >> version;
+    if (magic != kIndexMagic || version != kIndexVersion) {
+        qDebug() << "MusicDirectoryIndex: ignoring old index" << indexFilename;
+        return false;
+    }
+
+    qint32 count;
+    in >> root >> filters >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        QString dirPath;
+        DirectoryEntry entry;
+        in >> dirPath >> entry.modified >> entry.listedAt >> entry.files >> entry.subdirs;
+        dirs.insert(dirPath, entry);
+        dirOrder.append(dirPath);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "MusicDirectoryIndex: corrupt index" << indexFilename;
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool MusicDirectoryIndex::save(const QString &indexFilename) const
+{
+    QSaveFile file(indexFilename);  // all or nothing, so a crash can't leave a truncated index
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "MusicDirectoryIndex: could not write" << indexFilename;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << kIndexMagic << kIndexVersion;
+    out << root << filters << static_cast<qint32>(dirOrder.size());
+    for (const QString &dirPath : dirOrder) {
+        const DirectoryEntry &entry = dirs[dirPath];
+        out << dirPath << entry.modified << entry.listedAt << entry.files << entry.subdirs;
+    }
+    return file.commit();
+}
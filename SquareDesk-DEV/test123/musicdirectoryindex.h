@@ -0,0 +1,80 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef MUSICDIRECTORYINDEX_H_INCLUDED
+#define MUSICDIRECTORYINDEX_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+// A persisted index of the files under the music root directory, so that a refresh
+//   doesn't need to walk the whole tree.  Each directory's mtime is remembered, and a
+//   directory is only listed again if its mtime changed (adding, removing or renaming a
+//   file or subdirectory changes the mtime of the directory it's in).  Directories that
+//   didn't change just cost a stat().
+//
+// The index is stored in <musicRoot>/.squaredesk (see MainWindow::findMusic).  The directory
+//   that holds the index is never listed, even where it isn't hidden (e.g. on Windows), since
+//   it changes every time the index (or the database next to it) is saved.
+class MusicDirectoryIndex
+{
+public:
+    MusicDirectoryIndex();
+
+    // Brings the index up to date, loading it from indexFilename first if the root
+    //   changed (or on the first call), and saving it back if anything changed.
+    //   Returns the number of directories that had to be listed again.
+    int update(const QString &rootDir, const QStringList &nameFilters, const QString &indexFilename);
+
+    void clear();
+
+    QStringList files() const;        // full paths of all matching files, in directory order
+    QStringList directories() const;  // full paths of all directories (including the root)
+
+private:
+    class DirectoryEntry
+    {
+    public:
+        DirectoryEntry() : modified(0), listedAt(0) {}
+        qint64 modified;     // msecs since epoch
+        qint64 listedAt;     // when we last listed it (see isCurrent)
+        QStringList files;   // names only, matching the name filters
+        QStringList subdirs; // names only
+    };
+
+    bool load(const QString &indexFilename);
+    bool save(const QString &indexFilename) const;
+    DirectoryEntry listDirectory(const QString &dirPath, qint64 modified) const;
+    static bool isCurrent(const DirectoryEntry &entry, qint64 modified);
+
+    QString root;
+    QString skippedDir;  // the directory that holds the index file
+    QStringList filters;
+    QHash<QString, DirectoryEntry> dirs;  // keyed by full path
+    QStringList dirOrder;                 // depth first, root first
+};
+
+#endif /* ifndef MUSICDIRECTORYINDEX_H_INCLUDED */
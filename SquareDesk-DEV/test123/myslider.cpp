@@ -34,6 +34,7 @@ MySlider::MySlider(QWidget *parent) : QSlider(parent)
     singingCall = false;
     SetDefaultIntroOutroPositions(false, 0.0, 0.0, 0.0, 0.0);  // bare minimum init
     origin = 0;
+    waveformLength_sec = 0.0;
 
     // install the wheel/scroll eater for ALL MySlider's
     this->installEventFilter(this);  // eventFilter() is called, where wheel/touchpad scroll events are eaten
@@ -102,6 +103,19 @@ void MySlider::SetDefaultIntroOutroPositions(bool tempoIsBPM, double estimatedBP
     }
 }
 
+void MySlider::SetWaveform(const WaveformOverview &overview, double songLength_sec)
+{
+    waveform = overview;
+    waveformLength_sec = songLength_sec;
+    waveformColumns.clear();
+    update();
+}
+
+void MySlider::ClearWaveform()
+{
+    SetWaveform(WaveformOverview(), 0.0);
+}
+
 void MySlider::SetLoop(bool b)
 {
     drawLoopPoints = b;
@@ -159,6 +173,24 @@ void MySlider::paintEvent(QPaintEvent *e)
     int height = this->height();
     int width = this->width() - 2 * offset;
 
+    if (!waveform.isEmpty() && width > 0 && waveformColumns.size() != width) {
+        waveformColumns = waveform.columns(0.0, waveformLength_sec, width);  // empty, if the length isn't known yet
+    }
+    if (width > 0 && waveformColumns.size() == width) {
+        // one min/max line (and a darker RMS line) per pixel, from the precomputed overview
+        int middle = height/2;
+        double halfHeight = (height - 6)/2.0;
+        QColor peakColor(0, 0, 0, 40);
+        QColor rmsColor(0, 0, 0, 70);
+        for (int x = 0; x < width; x++) {
+            const WaveformOverview::Column &c = waveformColumns[x];
+            painter.setPen(peakColor);
+            painter.drawLine(QLineF(x + offset, middle - c.max * halfHeight, x + offset, middle - c.min * halfHeight));
+            painter.setPen(rmsColor);
+            painter.drawLine(QLineF(x + offset, middle - c.rms * halfHeight, x + offset, middle + c.rms * halfHeight));
+        }
+    }
+
     if (drawLoopPoints) {
         QPen pen;  //   = (QApplication::palette().dark().color());
         pen.setColor(Qt::blue);
@@ -29,6 +29,7 @@
 #include <QSlider>
 #include <QPainter>
 #include <QPen>
+#include "waveformoverview.h"
 
 // ---------------------------------------------
 class MySlider : public QSlider
@@ -45,6 +46,8 @@ public:
     double GetOutro() const;
     void SetDefaultIntroOutroPositions(bool tempoIsBPM, double estimatedBPM,
                                        double songStart_sec, double songEnd_sec, double songLength_sec);
+    void SetWaveform(const WaveformOverview &overview, double songLength_sec);  // drawn behind everything else
+    void ClearWaveform();
 
     bool eventFilter(QObject *obj, QEvent *event);
 
@@ -59,6 +62,10 @@ private:
     double outroPosition;
     int origin;  // reset to this point when double-clicked
 
+    WaveformOverview waveform;
+    double waveformLength_sec;
+    QVector<WaveformOverview::Column> waveformColumns;  // for the current width (recomputed on resize)
+
 };
 
 #endif // MYSLIDER_H
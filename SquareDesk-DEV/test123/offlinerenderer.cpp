@@ -0,0 +1,261 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "offlinerenderer.h"
+#include "audiofilewriter.h"
+#include "bass.h"
+#include "bass_fx.h"
+#include "loopengine.h"
+#include "streamdsp.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QtConcurrent>
+#include <math.h>
+#include <memory>
+#include <vector>
+
+// ------------------------------------------------------------------
+RenderSettings::RenderSettings() :
+    pitch(0),
+    tempo(100),
+    pan(0.0),
+    mono(false),
+    loop(false),
+    introPos(0.0),
+    outroPos(0.0),
+    introOutroIsTimeBased(false),
+    loopUntil_sec(0.0),
+    bpm(0.0)
+{
+    eq_dB[0] = eq_dB[1] = eq_dB[2] = 0.0;
+}
+
+// ------------------------------------------------------------------
+class RenderTask : public QRunnable
+{
+public:
+    RenderTask(const RenderJob &job, RenderResult *result, const QAtomicInt *canceled, QSemaphore *done)
+        : job(job), result(result), canceled(canceled), done(done)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        *result = OfflineRenderer::render(job, canceled);
+        done->release();
+    }
+
+private:
+    RenderJob job;
+    RenderResult *result;
+    const QAtomicInt *canceled;
+    QSemaphore *done;
+};
+
+// ------------------------------------------------------------------
+OfflineRenderer::OfflineRenderer()
+    : pool(), coordinator(), canceled(0)
+{
+    // leave one core for the UI and the audio engine
+    int threads = QThread::idealThreadCount() - 1;
+    pool.setMaxThreadCount(threads < 1 ? 1 : threads);
+    coordinator.setMaxThreadCount(1);
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    cancel();
+    waitForDone();
+}
+
+void OfflineRenderer::cancel()
+{
+    canceled.storeRelease(1);
+}
+
+void OfflineRenderer::waitForDone()
+{
+    coordinator.waitForDone();
+    pool.waitForDone();
+}
+
+// ------------------------------------------------------------------
+RenderResult OfflineRenderer::render(const RenderJob &job, const QAtomicInt *canceled)
+{
+    RenderResult result;
+    if (canceled != nullptr && canceled->loadAcquire()) {
+        result.error = "canceled";
+        return result;
+    }
+    QElapsedTimer timer;
+    timer.start();
+
+    const RenderSettings &s = job.settings;
+    std::string source = job.source.toStdString();
+
+    // the same decoder as bass_audio::OpenStream(), and the tempo stream on top of it is decode-only too
+    HSTREAM decodeStream = BASS_StreamCreateFile(false, source.c_str(), 0, 0, BASS_SAMPLE_FLOAT|BASS_STREAM_DECODE|BASS_STREAM_PRESCAN);
+    if (decodeStream == 0) {
+        result.error = QString("can't open (error %1)").arg(BASS_ErrorGetCode());
+        return result;
+    }
+    HSTREAM stream = BASS_FX_TempoCreate(decodeStream, BASS_STREAM_DECODE|BASS_FX_FREESOURCE);
+    if (stream == 0) {
+        result.error = QString("can't change the tempo (error %1)").arg(BASS_ErrorGetCode());
+        BASS_StreamFree(decodeStream);
+        return result;
+    }
+    BASS_ChannelSetAttribute(stream, BASS_ATTRIB_TEMPO, static_cast<float>(s.tempo - 100));
+    BASS_ChannelSetAttribute(stream, BASS_ATTRIB_TEMPO_PITCH, static_cast<float>(s.pitch));
+
+    BASS_CHANNELINFO info;
+    BASS_ChannelGetInfo(stream, &info);
+    const int channels = static_cast<int>(info.chans);
+
+    LoopEngine loop;
+    if (s.loop) {
+        loop.attach(stream, source.c_str());
+        double length_sec = BASS_ChannelBytes2Seconds(decodeStream, BASS_ChannelGetLength(decodeStream, BASS_POS_BYTE));
+        double to_sec = (s.introOutroIsTimeBased ? s.introPos : s.introPos * length_sec);
+        double from_sec = (s.introOutroIsTimeBased ? s.outroPos : s.outroPos * length_sec);
+        if (s.bpm > 0.0) {
+            from_sec = loop.beatAlignedFrom(from_sec, to_sec, s.bpm);  // same as bass_audio::SetLoop()
+        }
+        if (from_sec > to_sec && s.loopUntil_sec > length_sec) {
+            int repeats = static_cast<int>(ceil((s.loopUntil_sec - length_sec) / (from_sec - to_sec)));
+            loop.set(from_sec, to_sec, repeats);
+        }
+    }
+
+    StreamDSP dsp;
+    dsp.setSampleRate(static_cast<float>(info.freq));
+    dsp.setChannels(channels);
+    dsp.setPan(static_cast<float>(s.pan));
+    dsp.setMono(s.mono);
+    for (int band = 0; band < 3; band++) {
+        dsp.setEqGain(band, static_cast<float>(s.eq_dB[band]));
+    }
+    dsp.setGain(1.0f, 0.0f);
+
+    std::unique_ptr<AudioFileWriter> writer(AudioFileWriter::create(job.destination.toStdString()));
+    if (!writer->open(job.destination.toStdString(), static_cast<int>(info.freq), channels)) {
+        result.error = "can't write " + job.destination;
+        BASS_StreamFree(stream);
+        return result;
+    }
+
+    // as fast as BASS will decode it
+    const int kChunkFrames = 16384;
+    std::vector<float> buffer(static_cast<size_t>(kChunkFrames * channels));
+    quint64 frames = 0;
+    result.ok = true;
+    for (;;) {
+        if (canceled != nullptr && canceled->loadAcquire()) {
+            result.error = "canceled";
+            result.ok = false;
+            break;
+        }
+        DWORD got = BASS_ChannelGetData(stream, buffer.data(),
+                                        static_cast<DWORD>(buffer.size() * sizeof(float)) | BASS_DATA_FLOAT);
+        if (got == static_cast<DWORD>(-1) || got == 0) {
+            if (BASS_ErrorGetCode() != BASS_ERROR_ENDED) {
+                result.error = QString("decoding stopped (error %1)").arg(BASS_ErrorGetCode());
+                result.ok = false;
+            }
+            break;
+        }
+        int n = static_cast<int>(got / (sizeof(float) * channels));
+        dsp.process(buffer.data(), n);
+        if (!writer->write(buffer.data(), n)) {
+            result.error = "can't write " + job.destination;
+            result.ok = false;
+            break;
+        }
+        frames += static_cast<quint64>(n);
+    }
+    result.ok = writer->close() && result.ok;
+
+    loop.detach();
+    BASS_StreamFree(stream);  // and the decoder, because of BASS_FX_FREESOURCE
+
+    if (!result.ok) {
+        QFile::remove(job.destination);  // don't leave half a song around
+    }
+    result.audio_sec = static_cast<double>(frames) / info.freq;
+    result.elapsed_sec = timer.nsecsElapsed() / 1.0e9;
+    return result;
+}
+
+// ------------------------------------------------------------------
+QList<RenderResult> OfflineRenderer::renderAll(const QList<RenderJob> &jobs, double *xRealtime)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // every task runs (the ones that start after a cancel() return right away), so this always
+    //   gets all of its releases
+    std::vector<RenderResult> rendered(static_cast<size_t>(jobs.size()));
+    QSemaphore done;
+    for (int i = 0; i < jobs.size(); i++) {
+        pool.start(new RenderTask(jobs[i], &rendered[static_cast<size_t>(i)], &canceled, &done));
+    }
+    done.acquire(jobs.size());
+    QList<RenderResult> results;
+    for (const RenderResult &result : rendered) {
+        results.append(result);
+    }
+
+    double audio_sec = 0.0;
+    for (int i = 0; i < results.size(); i++) {
+        audio_sec += results[i].audio_sec;
+        if (results[i].ok) {
+            qDebug() << "OfflineRenderer:" << jobs[i].destination << ":" << results[i].audio_sec << "sec of audio in"
+                     << results[i].elapsed_sec << "sec =" << results[i].xRealtime() << "x realtime";
+        } else {
+            qDebug() << "ERROR: OfflineRenderer:" << jobs[i].source << ":" << results[i].error;
+        }
+    }
+    double elapsed_sec = timer.nsecsElapsed() / 1.0e9;
+    double x = (elapsed_sec > 0.0 ? audio_sec / elapsed_sec : 0.0);
+    qDebug() << "OfflineRenderer:" << jobs.size() << "songs," << audio_sec << "sec of audio in" << elapsed_sec
+             << "sec =" << x << "x realtime, on" << pool.maxThreadCount() << "threads";
+    if (xRealtime != nullptr) {
+        *xRealtime = x;
+    }
+    return results;
+}
+
+QFuture<QList<RenderResult> > OfflineRenderer::start(const QList<RenderJob> &jobs)
+{
+    canceled.storeRelease(0);
+    return QtConcurrent::run(&coordinator, [this, jobs] {
+        return renderAll(jobs);
+    });
+}
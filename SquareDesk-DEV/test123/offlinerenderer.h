@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef OFFLINERENDERER_H_INCLUDED
+#define OFFLINERENDERER_H_INCLUDED
+
+#include <QList>
+#include <QString>
+#include <QFuture>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+// What to do to the song on the way to the file (the same things that the live playback does).
+struct RenderSettings
+{
+    RenderSettings();
+
+    int pitch;                    // semitones, as for bass_audio::SetPitch()
+    int tempo;                    // percent (100 = as recorded), as for bass_audio::SetTempo()
+    double eq_dB[3];              // bass, midrange, treble: -15 .. 15
+    double pan;                   // -1.0 = all L, 0.0 = center, 1.0 = all R
+    bool mono;
+
+    // loop from the outro point back to the intro point (e.g. patter), until the rendered
+    //   song is at least loopUntil_sec long (in the song's own time, i.e. before the tempo change)
+    bool loop;
+    double introPos, outroPos;    // fractions of the length, or seconds, as in SongSetting...
+    bool introOutroIsTimeBased;   // ...depending on this
+    double loopUntil_sec;
+    double bpm;                   // to line up the loop with the beats; 0.0 if not known
+};
+
+struct RenderJob
+{
+    QString source;
+    QString destination;          // ".flac" or ".wav"
+    RenderSettings settings;
+};
+
+struct RenderResult
+{
+    RenderResult() : ok(false), audio_sec(0.0), elapsed_sec(0.0) {}
+
+    double xRealtime() const { return (elapsed_sec > 0.0 ? audio_sec / elapsed_sec : 0.0); }
+
+    bool ok;
+    QString error;
+    double audio_sec;             // length of the rendered file
+    double elapsed_sec;
+};
+
+// Renders songs to files with their pitch, tempo, EQ, pan and loop settings, as fast as the
+//   CPU will go (i.e. not in real time).
+//
+// Uses a BASS decode-only version of the chain that bass_audio::StreamCreate() sets up for
+//   playback (decoder -> LoopEngine -> tempo/pitch -> StreamDSP), so it doesn't need (or touch)
+//   the output device or the song that is playing.  BASS must already be initialized, and must
+//   stay initialized until waitForDone() returns.
+//
+// The renders run on a thread pool of their own (one core is left for the UI and the audio
+//   engine), so they don't hold up the global pool, which PrefetchStream uses.
+class OfflineRenderer
+{
+public:
+    OfflineRenderer();
+    ~OfflineRenderer();  // cancels, and waits for the songs in progress to stop
+
+    // any thread; stops early (and deletes the partial file) if *canceled becomes nonzero
+    static RenderResult render(const RenderJob &job, const QAtomicInt *canceled = nullptr);
+
+    // one job per thread at a time; the results are in the same order as the jobs
+    QList<RenderResult> renderAll(const QList<RenderJob> &jobs, double *xRealtime = nullptr);
+
+    // renderAll() in the background
+    QFuture<QList<RenderResult> > start(const QList<RenderJob> &jobs);
+
+    // the songs in progress stop, and the ones that haven't started are skipped ("canceled")
+    void cancel();
+    void waitForDone();
+
+private:
+    OfflineRenderer(const OfflineRenderer &);
+    OfflineRenderer &operator=(const OfflineRenderer &);
+
+    QThreadPool pool;         // the renders
+    QThreadPool coordinator;  // start()'s renderAll(), which just waits for them
+    QAtomicInt canceled;
+};
+
+#endif /* ifndef OFFLINERENDERER_H_INCLUDED */
@@ -88,6 +88,9 @@ CONFIG_ATTRIBUTE_BOOLEAN(useTimeRemainingCheckbox,useTimeRemaining, false)
 
 CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(autostartplayback, false);
 CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(forcemono, false);
+CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(backgroundSongAnalysis, true);
+CONFIG_ATTRIBUTE_INT_NO_PREFS(preloadSongsMode, 0);       // SongPreloader::Mode: 0 = never, 1 = songs on other volumes, 2 = always (no UI for this yet)
+CONFIG_ATTRIBUTE_INT_NO_PREFS(preloadSongsBudgetMB, 128);
 CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(startplaybackoncountdowntimer, false)
 CONFIG_ATTRIBUTE_BOOLEAN_NO_PREFS(startcountuptimeronplay, false)
 CONFIG_ATTRIBUTE_STRING_NO_PREFS(default_dir, QDir::homePath())
@@ -184,6 +184,7 @@ bool SDThread::on_user_input(QString str)
 {
     QByteArray inUtf8 = str.simplified().toUtf8();
     const char *data = inUtf8.constData();
+    engine_context::scope bind(*engine);   // the matcher state lives in our engine, not this thread's
     return iofull->add_string_input(data);
 }
 
@@ -212,7 +213,7 @@ bool SquareDesk_iofull::add_string_input(const char *s)
         qWarning() << "Unknown input state: " << currentInputState;
     case SDThread::InputStateNormal:
         int len = strlen(s);
-             matcher_class &matcher = *gg77->matcher_p;
+             matcher_class &matcher = *current_engine->m_gg77->matcher_p;
 
         if (s[len - 1] == '!'
             || s[len - 1] == '?')
@@ -293,8 +294,8 @@ void SquareDesk_iofull::wait_for_input()
 void SquareDesk_iofull::EnterMessageLoop()
 {
 
-    gg77->matcher_p->m_active_result.valid = false;
-    gg77->matcher_p->erase_matcher_input();
+    current_engine->m_gg77->matcher_p->m_active_result.valid = false;
+    current_engine->m_gg77->matcher_p->erase_matcher_input();
     WaitingForCommand = true;
     wait_for_input();
     if (WaitingForCommand)
@@ -469,9 +470,9 @@ void SquareDesk_iofull::ShowListBox(int nWhichOne) {
             short int *item;
             int menu_length;
 
-            index_list *list_to_use = allowing_all_concepts ?
-                &gg77->matcher_p->m_concept_list :
-                &gg77->matcher_p->m_level_concept_list;
+            index_list *list_to_use = current_engine->m_allowing_all_concepts ?
+                &current_engine->m_gg77->matcher_p->m_concept_list :
+                &current_engine->m_gg77->matcher_p->m_level_concept_list;
             item = list_to_use->the_list;
             menu_length = list_to_use->the_list_size;
 
@@ -501,7 +502,7 @@ void SquareDesk_iofull::ShowListBox(int nWhichOne) {
 uims_reply_thing SquareDesk_iofull::get_resolve_command()
 {
 //    qWarning() << "SquareDesk_iofull::get_resolve_command();";
-    matcher_class &matcher = *gg77->matcher_p;
+    matcher_class &matcher = *current_engine->m_gg77->matcher_p;
     UpdateStatusBar(szResolveWndTitle);
 
     nLastOne = ui_undefined;
@@ -628,7 +629,7 @@ void SquareDesk_iofull::create_menu(call_list_kind /* cl */)
 
 selector_kind SquareDesk_iofull::do_selector_popup(matcher_class &/* matcher */)
 {
-    matcher_class &matcher = *gg77->matcher_p;
+    matcher_class &matcher = *current_engine->m_gg77->matcher_p;
     match_result saved_match = matcher.m_final_result;
    // We add 1 to the menu position to get the actual selector enum; the enum effectively starts at 1.
    // Item zero in the enum is selector_uninitialized, which we return if the user cancelled.
@@ -647,11 +648,11 @@ direction_kind SquareDesk_iofull::do_direction_popup(matcher_class &/* matcher *
 
 int SquareDesk_iofull::do_circcer_popup()
 {
-    matcher_class &matcher = *gg77->matcher_p;
+    matcher_class &matcher = *current_engine->m_gg77->matcher_p;
     uint32 retval = 0;
 
-    if (interactivity == interactivity_verify) {
-        retval = verify_options.circcer;
+    if (current_engine->m_interactivity == interactivity_verify) {
+        retval = current_engine->m_verify_options.circcer;
         if (retval == 0) retval = 1;
     }
     else if (!matcher.m_final_result.valid || (matcher.m_final_result.match.call_conc_options.circcer == 0)) {
@@ -747,17 +748,17 @@ uint32 SquareDesk_iofull::get_one_number(matcher_class &/* matcher */)
 
 uims_reply_thing SquareDesk_iofull::get_call_command()
 {
-    matcher_class &matcher = *gg77->matcher_p;
+    matcher_class &matcher = *current_engine->m_gg77->matcher_p;
 startover:
-    if (allowing_modifications)
-        parse_state.call_list_to_use = call_list_any;
+    if (current_engine->m_allowing_modifications)
+        current_engine->m_parse_state.call_list_to_use = call_list_any;
 
 //    SetTitle();
     nLastOne = ui_undefined;    /* Make sure we get a new menu,
                                    in case concept levels were toggled. */
     MenuKind = ui_call_select;
     // ZZZZZ show call list menu
-    ShowListBox(parse_state.call_list_to_use);
+    ShowListBox(current_engine->m_parse_state.call_list_to_use);
     EnterMessageLoop();
 
     int index = matcher.m_final_result.match.index;
@@ -775,17 +776,17 @@ startover:
     }
     else {
         // Reject off-level concept accelerator key presses.
-        if (!allowing_all_concepts && matcher.m_final_result.match.kind == ui_concept_select &&
+        if (!current_engine->m_allowing_all_concepts && matcher.m_final_result.match.kind == ui_concept_select &&
             get_concept_level(matcher.m_final_result.match.concept_ptr) > calling_level)
             goto startover;
 
         call_conc_option_state save_stuff = matcher.m_final_result.match.call_conc_options;
-        there_is_a_call = false;
+        current_engine->m_there_is_a_call = false;
         uims_reply_kind my_reply = matcher.m_final_result.match.kind;
         bool retval = deposit_call_tree(&matcher.m_final_result.match, (parse_block *) 0, 2);
         matcher.m_final_result.match.call_conc_options = save_stuff;
-        if (there_is_a_call) {
-            parse_state.topcallflags1 = the_topcallflags;
+        if (current_engine->m_there_is_a_call) {
+            current_engine->m_parse_state.topcallflags1 = current_engine->m_the_topcallflags;
             my_reply = ui_call_select;
         }
 
@@ -821,7 +822,7 @@ void SquareDesk_iofull::bad_argument(Cstring /* s1 */, Cstring /* s2 */, Cstring
 
 void SquareDesk_iofull::final_initialize()
 {
-    ui_options.use_escapes_for_drawing_people = 0;
+    current_engine->m_ui_options.use_escapes_for_drawing_people = 0;
 
 //    qWarning() << "SquareDesk_iofull::final_initialize();";
 }
@@ -893,13 +894,13 @@ bool SquareDesk_iofull::do_popup(int nWhichOne)
    EnterMessageLoop();
 //   MenuKind = SavedMenuKind;
    // A value of -1 means that the user hit the "cancel" button.
-   return (gg77->matcher_p->m_final_result.match.index >= 0);
+   return (current_engine->m_gg77->matcher_p->m_final_result.match.index >= 0);
 }
 
 
 uims_reply_thing SquareDesk_iofull::get_startup_command()
 {
-    matcher_class &matcher = *gg77->matcher_p;
+    matcher_class &matcher = *current_engine->m_gg77->matcher_p;
     nLastOne = ui_undefined;
     MenuKind = ui_start_select;
 
@@ -948,7 +949,8 @@ SDThread::SDThread(MainWindow *mw)
       waitCondSDAwaitingInput(),
       mutexSDAwaitingInput(),
       mutexThreadRunning(),
-      abort(false)
+      abort(false),
+      engine(new engine_context)
 {
     // We should expand these elsewhere for autocomplete stuff
 
@@ -1054,6 +1056,7 @@ SDThread::~SDThread()
         qWarning() << "Thread unable to stop, calling terminate";
         terminate();
     }
+    delete engine;
 }
 
 void SDThread::run()
@@ -1087,7 +1090,7 @@ void SDThread::run()
                     const_cast<char *>("-bend_line_home_getouts"),
                     NULL};
 
-    sdmain(sizeof(argv) / sizeof(*argv) - 1, argv, ggg);  // note: manually set argc to match number of argv arguments...
+    sdmain(sizeof(argv) / sizeof(*argv) - 1, argv, ggg, *engine);  // note: manually set argc to match number of argv arguments...
 }
 
 void SDThread::unlock()
@@ -45,6 +45,7 @@ class QListWidget;
 
 class SquareDesk_iofull;
 class MainWindow;
+class engine_context;
 
 const int kSDCallTypeConcepts = (1 << 8);
 const int kSDCallTypeCommands = (1 << 9);
@@ -103,6 +104,7 @@ private:
     QMutex mutexThreadRunning;
     bool abort;
     SquareDesk_iofull *iofull;    
+    engine_context *engine;     // this thread's sd session; the main thread binds it too when it calls in
 
 };
 
@@ -0,0 +1,321 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songanalyzer.h"
+#include "songsettings.h"
+#include "bass_audio.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <taglib/mpegfile.h>
+#include <taglib/id3v2tag.h>
+#include <taglib/id3v2frame.h>
+
+#include <vector>
+
+using namespace TagLib;
+
+// ------------------------------------------------------------------
+class SongAnalysisJob : public QRunnable
+{
+public:
+    SongAnalysisJob(SongAnalyzer *analyzer, const QString &filenameWithPath)
+        : analyzer(analyzer), filenameWithPath(filenameWithPath)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        analyzer->jobFinished(SongAnalyzer::analyze(filenameWithPath));
+    }
+
+private:
+    SongAnalyzer *analyzer;
+    QString filenameWithPath;
+};
+
+// ------------------------------------------------------------------
+SongAnalyzer::SongAnalyzer(QObject *parent)
+    : QObject(parent), pool(), pendingMutex(), pending(), hits(0), misses(0)
+{
+    qRegisterMetaType<SongAnalysis>("SongAnalysis");
+
+    // leave one core for the UI and one for the audio engine
+    int threads = QThread::idealThreadCount() - 2;
+    pool.setMaxThreadCount(threads < 1 ? 1 : threads);
+}
+
+SongAnalyzer::~SongAnalyzer()
+{
+    cancelBackgroundWork();
+    pool.waitForDone();
+}
+
+void SongAnalyzer::enqueue(const QString &filenameWithPath, int priority)
+{
+    {
+        QMutexLocker locker(&pendingMutex);
+        if (pending.contains(filenameWithPath)) {
+            return;  // already queued or running
+        }
+        pending.insert(filenameWithPath);
+    }
+    pool.start(new SongAnalysisJob(this, filenameWithPath), priority);
+}
+
+void SongAnalyzer::enqueueAll(const QStringList &filenamesWithPath)
+{
+    for (const QString &filenameWithPath : filenamesWithPath) {
+        enqueue(filenameWithPath, kPriorityBackground);
+    }
+}
+
+void SongAnalyzer::cancelBackgroundWork()
+{
+    pool.clear();  // removes (and deletes) the jobs that have not started yet
+
+    QMutexLocker locker(&pendingMutex);
+    pending.clear();  // jobs that are already running will still report back
+}
+
+bool SongAnalyzer::isPending(const QString &filenameWithPath)
+{
+    QMutexLocker locker(&pendingMutex);
+    return pending.contains(filenameWithPath);
+}
+
+void SongAnalyzer::waitForDone()
+{
+    pool.waitForDone();
+}
+
+// called on a worker thread
+void SongAnalyzer::jobFinished(const SongAnalysis &analysis)
+{
+    {
+        QMutexLocker locker(&pendingMutex);
+        pending.remove(analysis.filenameWithPath);
+    }
+    emit analysisReady(analysis);  // queued over to the receiver's thread
+}
+
+// ------------------------------------------------------------------
+// Same as MainWindow::getID3BPM(), but doesn't create a tag if there isn't one (and doesn't leak).
+static double readID3BPM(const QString &filenameWithPath)
+{
+    MPEG::File mp3file(filenameWithPath.toStdString().c_str());
+    ID3v2::Tag *id3v2tag = mp3file.isValid() ? mp3file.ID3v2Tag(false) : nullptr;
+    if (!id3v2tag) {
+        return 0.0;
+    }
+
+    double theBPM = 0.0;
+    const ID3v2::FrameList &frames = id3v2tag->frameListMap()["TBPM"];
+    if (!frames.isEmpty()) {
+        QString BPM(frames.front()->toString().toCString());
+        theBPM = BPM.toDouble();
+    }
+    return theBPM;
+}
+
+// A fast fingerprint of the contents: size + first and last 64KB, so that a file that
+//   was just touched (or copied to a new drive) doesn't have to be decoded again.
+QByteArray SongAnalyzer::contentHash(const QString &filenameWithPath)
+{
+    const qint64 kChunkSize = 64 * 1024;
+
+    QFile f(filenameWithPath);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    qint64 size = f.size();
+    hash.addData(QByteArray::number(size));
+    hash.addData(f.read(kChunkSize));
+    if (size > 2 * kChunkSize) {
+        f.seek(size - kChunkSize);
+        hash.addData(f.read(kChunkSize));
+    }
+    return hash.result().toHex();
+}
+
+// ------------------------------------------------------------------
+SongAnalysis SongAnalyzer::analyze(const QString &filenameWithPath)
+{
+    SongAnalysis analysis;
+    analysis.filenameWithPath = filenameWithPath;
+
+    // resolve aliases, same as loadMP3File does
+    QString resolvedFilePath = QFileInfo(filenameWithPath).symLinkTarget();
+    if (resolvedFilePath.isEmpty()) {
+        resolvedFilePath = filenameWithPath;
+    }
+
+    QFileInfo fi(resolvedFilePath);
+    analysis.fileSize = fi.size();
+    analysis.fileModified = fi.lastModified().toMSecsSinceEpoch();
+    analysis.contentHash = contentHash(resolvedFilePath);
+
+    std::vector<float> peaks;
+    std::vector<float> rms;
+    WaveformOverview waveform;
+    analysis.valid = bass_audio::AnalyzeSong(resolvedFilePath.toStdString().c_str(),
+                                             &analysis.bpm,
+                                             &analysis.songStart_sec,
+                                             &analysis.songEnd_sec,
+                                             &analysis.songLength_sec,
+                                             &analysis.loudness_dB,
+                                             &peaks, &rms, &waveform);
+    analysis.peakEnvelope = QVector<float>::fromStdVector(peaks);
+    analysis.rmsEnvelope = QVector<float>::fromStdVector(rms);
+    analysis.waveform = waveform.toBlob();
+
+    if (analysis.valid && fi.suffix().compare("mp3", Qt::CaseInsensitive) == 0) {
+        analysis.id3BPM = readID3BPM(resolvedFilePath);
+    }
+
+    return analysis;
+}
+
+// ------------------------------------------------------------------
+// true, if the cached analysis is still good for the file as it is on disk right now
+//   (if just the mtime changed, cached.fileModified is updated and *modifiedChanged is set)
+//   Doesn't touch the database, so this is OK on any thread.
+bool SongAnalyzer::fingerprintMatches(SongAnalysis &cached, const QString &filenameWithPath, bool *modifiedChanged)
+{
+    *modifiedChanged = false;
+    if (cached.version != SONGANALYSIS_VERSION) {
+        return false;
+    }
+
+    QString resolvedFilePath = QFileInfo(filenameWithPath).symLinkTarget();
+    if (resolvedFilePath.isEmpty()) {
+        resolvedFilePath = filenameWithPath;
+    }
+    QFileInfo fi(resolvedFilePath);
+    if (!fi.exists() || fi.size() != cached.fileSize) {
+        return false;
+    }
+
+    qint64 modified = fi.lastModified().toMSecsSinceEpoch();
+    if (modified == cached.fileModified) {
+        return true;
+    }
+
+    // the mtime changed, but the contents might not have (e.g. touched, or copied)
+    if (cached.contentHash.isEmpty() || contentHash(resolvedFilePath) != cached.contentHash) {
+        return false;
+    }
+    cached.fileModified = modified;
+    *modifiedChanged = true;
+    return true;
+}
+
+bool SongAnalyzer::isCurrent(SongSettings &songSettings, SongAnalysis &cached, const QString &filenameWithPath)
+{
+    bool modifiedChanged = false;
+    bool current = fingerprintMatches(cached, filenameWithPath, &modifiedChanged);
+    if (modifiedChanged) {
+        songSettings.updateAnalysisModified(filenameWithPath, cached.fileModified);  // so we don't hash it again next time
+    }
+    if (current) {
+        hits.ref();
+    } else {
+        misses.ref();
+    }
+    return current;
+}
+
+namespace {
+class CachedAnalysisCheck
+{
+public:
+    QString filenameWithPath;
+    SongAnalysis cached;
+    bool current;
+    bool modifiedChanged;
+};
+}
+
+QStringList SongAnalyzer::filesToAnalyze(SongSettings &songSettings, const QStringList &filenamesWithPath)
+{
+    QHash<QString,SongAnalysis> analyses;
+    songSettings.getAnalyses(analyses);
+
+    QStringList toAnalyze;
+    QVector<CachedAnalysisCheck> checks;
+    checks.reserve(filenamesWithPath.size());
+    for (const QString &filenameWithPath : filenamesWithPath) {
+        QHash<QString,SongAnalysis>::const_iterator analysis = analyses.constFind(songSettings.removeRootDirs(filenameWithPath));
+        if (analysis == analyses.constEnd()) {
+            misses.ref();
+            toAnalyze.append(filenameWithPath);  // never analyzed
+            continue;
+        }
+        CachedAnalysisCheck check;
+        check.filenameWithPath = filenameWithPath;
+        check.cached = analysis.value();
+        check.current = false;
+        check.modifiedChanged = false;
+        checks.append(check);
+    }
+
+    QtConcurrent::blockingMap(checks, [](CachedAnalysisCheck &check) {
+        check.current = fingerprintMatches(check.cached, check.filenameWithPath, &check.modifiedChanged);
+    });
+
+    for (const CachedAnalysisCheck &check : checks) {
+        if (check.modifiedChanged) {
+            songSettings.updateAnalysisModified(check.filenameWithPath, check.cached.fileModified);
+        }
+        if (check.current) {
+            hits.ref();
+        } else {
+            misses.ref();
+            toAnalyze.append(check.filenameWithPath);  // changed since then
+        }
+    }
+    return toAnalyze;
+}
+
+bool SongAnalyzer::lookup(SongSettings &songSettings, const QString &filenameWithPath, SongAnalysis &analysis,
+                          bool includeEnvelopes)
+{
+    if (!songSettings.loadAnalysis(filenameWithPath, analysis, includeEnvelopes)) {
+        misses.ref();
+        return false;
+    }
+    return isCurrent(songSettings, analysis, filenameWithPath);
+}
@@ -0,0 +1,153 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGANALYZER_H_INCLUDED
+#define SONGANALYZER_H_INCLUDED
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+#include <QMetaType>
+#include <QByteArray>
+#include <QVector>
+#include <QAtomicInt>
+
+class SongSettings;
+
+// Bump this whenever analyze() changes in a way that changes its results, so that
+//   everything in the analysis cache gets recomputed.
+#define SONGANALYSIS_VERSION 2
+
+// Results of a single decode pass over a song.  All times are in seconds.
+class SongAnalysis
+{
+public:
+    SongAnalysis() :
+        filenameWithPath(),
+        valid(false),
+        version(SONGANALYSIS_VERSION),
+        fileSize(0),
+        fileModified(0),
+        contentHash(),
+        bpm(0.0),
+        id3BPM(0.0),
+        songStart_sec(0.0),
+        songEnd_sec(0.0),
+        songLength_sec(0.0),
+        loudness_dB(0.0),
+        peakEnvelope(),
+        rmsEnvelope(),
+        waveform()
+    {}
+
+    QString filenameWithPath;
+    bool valid;             // false, if the file could not be decoded
+
+    // fingerprint of the file that was analyzed
+    int version;            // SONGANALYSIS_VERSION at the time of the analysis
+    qint64 fileSize;
+    qint64 fileModified;    // msecs since epoch
+    QByteArray contentHash; // see SongAnalyzer::contentHash()
+
+    double bpm;             // 0.0 if not detectable
+    double id3BPM;          // TBPM frame from the ID3 tag, 0.0 if none
+    double songStart_sec;   // end of the leading silence
+    double songEnd_sec;     // start of the trailing silence
+    double songLength_sec;
+    double loudness_dB;     // RMS loudness of the non-silent part of the song (dBFS)
+
+    QVector<float> peakEnvelope;  // one per 100ms block, 0.0 - 1.0
+    QVector<float> rmsEnvelope;
+    QByteArray waveform;          // WaveformOverview::toBlob(), a few KB
+};
+
+Q_DECLARE_METATYPE(SongAnalysis)
+
+// Runs song analysis (BPM, intro/outro silence, loudness) on a pool of worker
+//   threads, so that loading a song never waits for a decode.  Results come back
+//   via the analysisReady() signal, which is delivered on the thread that owns
+//   the SongAnalyzer (i.e. the UI thread).
+class SongAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SongAnalyzer(QObject *parent = nullptr);
+    ~SongAnalyzer() override;
+
+    // priorities for enqueue()
+    enum { kPriorityBackground = 0, kPriorityNextSong = 5, kPriorityNowPlaying = 10 };
+
+    void enqueue(const QString &filenameWithPath, int priority = kPriorityNowPlaying);
+    void enqueueAll(const QStringList &filenamesWithPath);  // background pre-analysis of the library
+    void cancelBackgroundWork();                            // drop anything not yet started
+    bool isPending(const QString &filenameWithPath);
+    void waitForDone();
+
+    // does the actual work, on the calling thread
+    static SongAnalysis analyze(const QString &filenameWithPath);
+
+    // Analysis cache: results are persisted by SongSettings, keyed by the path, and are
+    //   only used if the size, mtime (or if the mtime changed, the content hash) and the
+    //   version still match.  Files that can't be decoded are cached too (!valid), so that they
+    //   aren't tried again on every scan, until they change.  Must be called on the thread that
+    //   owns the database.
+    bool lookup(SongSettings &songSettings, const QString &filenameWithPath, SongAnalysis &analysis,
+                bool includeEnvelopes = false);
+    bool isCurrent(SongSettings &songSettings, SongAnalysis &cached, const QString &filenameWithPath);
+
+    // isCurrent() for a whole library at once: the stat()s (and the content hashes, for files whose
+    //   mtime changed) run on all cores, and only the database work is done on the calling thread.
+    //   Returns the files that have no cached analysis, or whose cached analysis is out of date
+    //   (a file that couldn't be decoded, and hasn't changed since, is a hit).
+    QStringList filesToAnalyze(SongSettings &songSettings, const QStringList &filenamesWithPath);
+
+    static QByteArray contentHash(const QString &filenameWithPath);
+
+    // counted by lookup(), isCurrent() and filesToAnalyze(), e.g. a rescan of an unchanged library should be all hits
+    int cacheHits() const { return hits.load(); }
+    int cacheMisses() const { return misses.load(); }
+    void resetCacheCounters() { hits.store(0); misses.store(0); }
+
+signals:
+    void analysisReady(const SongAnalysis &analysis);
+
+private:
+    friend class SongAnalysisJob;
+    void jobFinished(const SongAnalysis &analysis);
+    static bool fingerprintMatches(SongAnalysis &cached, const QString &filenameWithPath, bool *modifiedChanged);
+
+    QThreadPool pool;
+    QMutex pendingMutex;
+    QSet<QString> pending;  // queued or running, so we never analyze the same file twice at once
+
+    QAtomicInt hits;
+    QAtomicInt misses;
+};
+
+#endif /* ifndef SONGANALYZER_H_INCLUDED */
@@ -57,7 +57,7 @@ private:
     Ui::SongHistoryExportDialog *ui;
 };
 
-void exportSongList(QTextStream &stream, SongSettings &settings, QList<QString> *musicFilenames,
+void exportSongList(QTextStream &stream, SongSettings &settings, const QStringList &musicFilenames,
                     int outputFieldCount, enum ColumnExportData outputFields[],
                     char separator,
                     bool includeHeaderNames,
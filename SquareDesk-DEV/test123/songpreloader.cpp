@@ -0,0 +1,177 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songpreloader.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <stdlib.h>
+
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+#include <sys/mman.h>
+#endif
+
+static const qint64 kReadChunk_bytes = 4 * 1024 * 1024;
+
+// ------------------------------------------------------------------
+SongPreloader::SongPreloader() :
+    mode(kNever),
+    budget_bytes(kDefaultBudget_bytes),
+    used_bytes(0),
+    localRoots()
+{
+    // on macOS 10.15 and later, the OS is on a read-only volume of its own, and the home folder
+    //   (and everything else the user has) is on the Data volume, so that one counts as local too
+    localRoots.insert(QStorageInfo::root().rootPath());
+    localRoots.insert(QStorageInfo(QDir::homePath()).rootPath());
+}
+
+void SongPreloader::setMode(Mode newMode)
+{
+    QMutexLocker locker(&mutex);
+    mode = newMode;
+}
+
+void SongPreloader::setBudget(qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    budget_bytes = bytes;  // songs already loaded stay loaded
+}
+
+qint64 SongPreloader::bytesUsed() const
+{
+    QMutexLocker locker(&mutex);
+    return used_bytes;
+}
+
+// ------------------------------------------------------------------
+HSTREAM SongPreloader::createStream(const char *filepath, DWORD flags)
+{
+    QString path = QString::fromUtf8(filepath);
+    if (shouldPreload(path)) {
+        qint64 bytes = QFileInfo(path).size();
+        bool reserved = false;
+        {
+            QMutexLocker locker(&mutex);
+            if (bytes > 0 && used_bytes + bytes <= budget_bytes) {
+                used_bytes += bytes;  // reserve it now, and read it without holding the lock
+                reserved = true;
+            }
+        }
+
+        if (!reserved) {
+            qDebug() << "SongPreloader: no room for" << path << ", so streaming it from disk";
+        } else {
+            Buffer *buffer = read(path, bytes);
+            if (buffer != nullptr) {
+                HSTREAM stream = BASS_StreamCreateFile(TRUE, buffer->data, 0, static_cast<QWORD>(bytes), flags);
+                if (stream != 0 && BASS_ChannelSetSync(stream, BASS_SYNC_FREE, 0, freeSyncProc, buffer) != 0) {
+                    return stream;
+                }
+                BASS_StreamFree(stream);
+                release(buffer);  // (and the reservation)
+            } else {
+                QMutexLocker locker(&mutex);
+                used_bytes -= bytes;
+            }
+        }
+    }
+
+    return BASS_StreamCreateFile(FALSE, filepath, 0, 0, flags);
+}
+
+bool SongPreloader::shouldPreload(const QString &path) const
+{
+    Mode currentMode;
+    {
+        QMutexLocker locker(&mutex);
+        currentMode = mode;
+    }
+    switch (currentMode) {
+        case kAlways:       return true;
+        case kOtherVolumes: return !localRoots.contains(QStorageInfo(path).rootPath());
+        default:            return false;
+    }
+}
+
+// the whole file, in big sequential reads
+SongPreloader::Buffer *SongPreloader::read(const QString &path, qint64 bytes)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    char *data = static_cast<char *>(malloc(static_cast<size_t>(bytes)));
+    if (data == nullptr) {
+        return nullptr;
+    }
+    qint64 done = 0;
+    while (done < bytes) {
+        qint64 got = file.read(data + done, qMin(kReadChunk_bytes, bytes - done));
+        if (got <= 0) {
+            qDebug() << "SongPreloader: can't read" << path;
+            free(data);
+            return nullptr;
+        }
+        done += got;
+    }
+
+    Buffer *buffer = new Buffer();
+    buffer->owner = this;
+    buffer->data = data;
+    buffer->bytes = bytes;
+    buffer->locked = false;
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    buffer->locked = (mlock(data, static_cast<size_t>(bytes)) == 0);  // OK if not (e.g. over RLIMIT_MEMLOCK)
+#endif
+    return buffer;
+}
+
+void SongPreloader::release(Buffer *buffer)
+{
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    if (buffer->locked) {
+        munlock(buffer->data, static_cast<size_t>(buffer->bytes));
+    }
+#endif
+    free(buffer->data);
+    {
+        QMutexLocker locker(&mutex);
+        used_bytes -= buffer->bytes;
+    }
+    delete buffer;
+}
+
+// when BASS frees the stream (on whatever thread that is)
+void CALLBACK SongPreloader::freeSyncProc(HSYNC handle, DWORD channel, DWORD data, void *user)
+{
+    Q_UNUSED(handle)
+    Q_UNUSED(channel)
+    Q_UNUSED(data)
+    Buffer *buffer = static_cast<Buffer *>(user);
+    buffer->owner->release(buffer);
+}
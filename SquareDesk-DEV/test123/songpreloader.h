@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGPRELOADER_H_INCLUDED
+#define SONGPRELOADER_H_INCLUDED
+
+#include "bass.h"
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+// Opens songs from memory instead of from disk, for slow media (USB sticks, guest volumes,
+//   network shares).
+//
+// BASS normally reads the file a bit at a time, as it plays, so if the drive stalls (it spins
+//   down, or another program is using it), playback stalls too.  A preloaded song is read
+//   completely when it's opened, in big sequential reads, into a buffer that is locked in RAM
+//   where the OS allows it, and the stream plays from there, so once it's open, playback never
+//   waits for the disk.  The buffer is freed when BASS frees the stream.
+//
+// All of the preloaded songs together are kept under a memory budget (usually that's the one
+//   that is playing, plus the next one, see bass_audio::PrefetchStream()).  A song that doesn't
+//   fit is just streamed from disk as before.
+class SongPreloader
+{
+public:
+    enum Mode {
+        kNever = 0,
+        kOtherVolumes = 1,  // songs that aren't on the OS or home folder volume (i.e. the likely slow ones)
+        kAlways = 2
+    };
+    static const qint64 kDefaultBudget_bytes = 128 * 1024 * 1024;
+
+    SongPreloader();
+
+    void setMode(Mode mode);
+    void setBudget(qint64 bytes);
+
+    // BASS_StreamCreateFile(), from memory if the mode says so and the file fits, otherwise from disk
+    HSTREAM createStream(const char *filepath, DWORD flags);  // thread-safe
+
+    qint64 bytesUsed() const;
+
+private:
+    class Buffer
+    {
+    public:
+        SongPreloader *owner;
+        char *data;
+        qint64 bytes;
+        bool locked;  // in RAM
+    };
+
+    bool shouldPreload(const QString &path) const;
+    Buffer *read(const QString &path, qint64 bytes);
+    void release(Buffer *buffer);
+    static void CALLBACK freeSyncProc(HSYNC handle, DWORD channel, DWORD data, void *user);
+
+    mutable QMutex mutex;  // protects everything below
+    Mode mode;
+    qint64 budget_bytes;
+    qint64 used_bytes;
+    QSet<QString> localRoots;  // roots of the volumes that the OS and the home folder are on
+};
+
+#endif /* ifndef SONGPRELOADER_H_INCLUDED */
@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songsearchindex.h"
+
+#include <QRegExp>
+#include <QStringRef>
+
+// ------------------------------------------------------------------------------------------
+SongSearchTerms::SongSearchTerms(const QString &searchText)
+{
+    static QRegExp rx("(\\ |\\,|\\.|\\:|\\t\\')"); //RegEx for ' ' or ',' or '.' or ':' or '\t', includes ' to handle the "it's" case.
+
+    for (const QString &t : searchText.split(rx))
+    {
+        QString filterWord(t);
+        bool tagsOnly(false);
+        bool exclude(false);
+
+        while (filterWord.length() > 0 &&
+               ('#' == filterWord[0] ||
+                '-' == filterWord[0]))
+        {
+            tagsOnly = ('#' == filterWord[0]);
+            exclude = ('-' == filterWord[0]);
+            filterWord.remove(0,1);
+        }
+        if (filterWord.length() == 0)
+            continue;
+
+        Term term;
+        term.word = filterWord.toCaseFolded();
+        term.length = t.length();
+        term.tagsOnly = tagsOnly;
+        term.exclude = exclude;
+        terms.append(term);
+    }
+}
+
+// ------------------------------------------------------------------------------------------
+SongSearchIndex::SongSearchIndex() :
+    rows(0),
+    filtered(false),
+    incremental(false)
+{
+    clear();
+}
+
+void SongSearchIndex::clear()
+{
+    rows = 0;
+    for (int field = 0; field < FieldCount; field++) {
+        buffer[field].clear();
+        start[field].clear();
+        start[field].append(0);
+        tagsStart[field].clear();
+        previousText[field].clear();
+    }
+    filtered = false;
+    incremental = false;
+    visible.clear();
+}
+
+void SongSearchIndex::reserve(int rowCount)
+{
+    for (int field = 0; field < FieldCount; field++) {
+        buffer[field].reserve(rowCount * 24);
+        start[field].reserve(rowCount + 1);
+        tagsStart[field].reserve(rowCount);
+    }
+}
+
+void SongSearchIndex::append(Field field, const QString &normalizedText, int tags)
+{
+    QString folded(normalizedText.toCaseFolded());
+    buffer[field].append(folded);
+    start[field].append(buffer[field].length());
+    tagsStart[field].append(tags < 0 ? folded.length() : tags);
+    rows = start[TitleField].size() - 1;
+    filtered = false;
+}
+
+// every word has to be there (or not, for "-word"), in the order typed, except that a word can
+//   always be found in the tags. "#word" only looks in the tags.
+bool SongSearchIndex::matches(Field field, int row, const SongSearchTerms &search) const
+{
+    if (search.isEmpty())
+        return true;
+
+    int rowStart = start[field][row];
+    QStringRef str(&buffer[field], rowStart, start[field][row + 1] - rowStart);
+    int title_end = tagsStart[field][row];
+    int index = 0;
+
+    for (const SongSearchTerms::Term &t : search.terms)
+    {
+        // Keywords can get matched in any order
+        if (index > title_end)
+            index = title_end;
+        int i = str.indexOf(t.word,
+                            t.tagsOnly ? title_end : (t.exclude ? 0 : index),
+                            Qt::CaseSensitive);  // both sides are already case folded
+        if (i < 0)
+        {
+            if (!t.exclude)
+                return false;
+        }
+        else
+        {
+            if (t.exclude)
+                return false;
+        }
+        if (!t.tagsOnly && !t.exclude)
+            index = i + t.length;
+    }
+    return true;
+}
+
+// true if every row that matches text also matched previousText
+bool SongSearchIndex::narrows(const QString &previousText, const QString &text)
+{
+    return text.startsWith(previousText) && !text.contains('-');
+}
+
+const QVector<bool> &SongSearchIndex::filter(const QString &labelText, const QString &typeText, const QString &titleText)
+{
+    const QString text[FieldCount] = { labelText, typeText, titleText };
+
+    incremental = filtered && visible.size() == rows;
+    for (int field = 0; field < FieldCount; field++) {
+        incremental = incremental && narrows(previousText[field], text[field]);
+    }
+
+    const SongSearchTerms search[FieldCount] = {
+        SongSearchTerms(labelText), SongSearchTerms(typeText), SongSearchTerms(titleText)
+    };
+
+    if (!incremental) {
+        visible.fill(true, rows);
+    }
+    for (int row = 0; row < rows; row++) {
+        if (visible[row]) {
+            visible[row] = matches(LabelField, row, search[LabelField])
+                && matches(TypeField, row, search[TypeField])
+                && matches(TitleField, row, search[TitleField]);
+        }
+    }
+
+    for (int field = 0; field < FieldCount; field++) {
+        previousText[field] = text[field];
+    }
+    filtered = true;
+    return visible;
+}
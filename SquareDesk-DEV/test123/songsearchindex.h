@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGSEARCHINDEX_H_INCLUDED
+#define SONGSEARCHINDEX_H_INCLUDED
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// The words typed into one of the search boxes, parsed once per keystroke.
+class SongSearchTerms
+{
+public:
+    SongSearchTerms(const QString &searchText);
+
+    bool isEmpty() const { return terms.isEmpty(); }
+
+    class Term
+    {
+    public:
+        QString word;     // case folded, without the leading '#' / '-'
+        int length;       // length as typed (the next word has to be after this one)
+        bool tagsOnly;    // "#word": only look in the tags
+        bool exclude;     // "-word": must NOT be there
+    };
+    QVector<Term> terms;
+};
+
+// What filterMusic() searches: the label, type and title (+ tags) of every row of the songTable,
+//   already normalized (case folded, no apostrophes, tag markup replaced by a space), each column
+//   in one contiguous buffer.
+//
+// If the search text only got longer since the last filter (and there are no exclusions), only the
+//   rows that were visible last time can still match, so only those are checked again.
+class SongSearchIndex
+{
+public:
+    enum Field {
+        LabelField = 0,
+        TypeField,
+        TitleField,
+        FieldCount
+    };
+
+    SongSearchIndex();
+
+    void clear();   // call this whenever the rows (or their label/type/title) change
+    bool isEmpty() const { return rows == 0; }
+    void reserve(int rowCount);
+
+    // one call per field per row, in order. tags = where the tags start (or -1 for none)
+    void append(Field field, const QString &normalizedText, int tags);
+
+    // returns true for each row that matches all three search boxes
+    const QVector<bool> &filter(const QString &labelText, const QString &typeText, const QString &titleText);
+    bool lastFilterWasIncremental() const { return incremental; }
+
+private:
+    bool matches(Field field, int row, const SongSearchTerms &search) const;
+    static bool narrows(const QString &previousText, const QString &text);
+
+    int rows;
+    QString buffer[FieldCount];
+    QVector<int> start[FieldCount];      // rows + 1 entries, so that row i is [start[i], start[i+1])
+    QVector<int> tagsStart[FieldCount];  // relative to start[i], == length if no tags
+
+    bool filtered;
+    bool incremental;
+    QString previousText[FieldCount];
+    QVector<bool> visible;
+};
+
+#endif /* ifndef SONGSEARCHINDEX_H_INCLUDED */
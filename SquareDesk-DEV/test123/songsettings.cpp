@@ -31,6 +31,7 @@
 #include <map>
 
 #include "songsettings.h"
+#include "songanalyzer.h"
 #include "sessioninfo.h"
 #include "default_colors.h"
 using namespace std;
@@ -263,6 +264,30 @@ RowDefinition tag_colors_rows[] =
 
 TableDefinition tag_colors_table("tag_colors", tag_colors_rows);
 
+// Results of SongAnalyzer, one row per file.  A row is only used if the version and the
+//   fingerprint (size, mtime or content hash) still match the file on disk.
+RowDefinition analysis_cache_rows[] =
+{
+    RowDefinition("filename", "TEXT PRIMARY KEY"),  // same normalization as songs.filename
+    RowDefinition("version", "INT"),                // SONGANALYSIS_VERSION
+    RowDefinition("fileSize", "INT"),
+    RowDefinition("fileModified", "INT"),           // msecs since epoch
+    RowDefinition("contentHash", "TEXT"),
+    RowDefinition("bpm", "float"),                  // 0.0 = not detectable
+    RowDefinition("id3BPM", "float"),               // 0.0 = no TBPM frame
+    RowDefinition("songStart", "float"),            // seconds, end of leading silence
+    RowDefinition("songEnd", "float"),              // seconds, start of trailing silence
+    RowDefinition("songLength", "float"),
+    RowDefinition("loudness", "float"),             // dBFS
+    RowDefinition("peakEnvelope", "BLOB"),          // float per 100ms
+    RowDefinition("rmsEnvelope", "BLOB"),
+    RowDefinition("waveform", "BLOB"),             // WaveformOverview::toBlob()
+    RowDefinition("valid", "INT"),                  // 0 = can't be decoded, NULL (older rows) = 1
+    RowDefinition(NULL, NULL),
+};
+
+TableDefinition analysis_cache_table("analysis_cache", analysis_cache_rows);
+
 IndexDefinition index_definitions[] = {
     IndexDefinition("songs_songname", "songs(songname)"),
     IndexDefinition("songs_name_idx","songs(name)"),
@@ -375,6 +400,7 @@ void SongSettings::openDatabase(const QString& path,
     ensureSchema(&song_plays_table);
     ensureSchema(&call_taught_on_table);
     ensureSchema(&tag_colors_table);
+    ensureSchema(&analysis_cache_table);
     
     for (size_t i = 0; i < sizeof(index_definitions) / sizeof(*index_definitions); ++i)
     {
@@ -1006,6 +1032,38 @@ bool SongSettings::loadSettings(const QString &filenameWithPath,
     return foundResults;
 }
 
+// All of the songs table at once, plus the age of each song (from song_plays), in a
+//   single query.  Both hashes are keyed by songs.filename (i.e. the normalized path,
+//   or just the filename for songs that were saved before paths were normalized).
+void SongSettings::loadAllSettings(QHash<QString,SongSetting> &settings,
+                                   QHash<QString,QString> &ages,
+                                   bool show_all_sessions)
+{
+    QString sql("SELECT filename, pitch, tempo, introPos, outroPos, volume, last_cuesheet,tempoIsPercent,songLength,introOutroIsTimeBased, treble, bass, midrange, mix, loop, tags, ages.age "
+                "FROM songs LEFT JOIN (SELECT song_rowid, julianday('now') - julianday(max(played_on)) AS age FROM song_plays");
+    if (!show_all_sessions)
+        sql += " WHERE session_rowid = :session_rowid";
+    sql += " GROUP BY song_rowid) AS ages ON ages.song_rowid = songs.rowid";
+
+    QSqlQuery q(m_db);
+    q.setForwardOnly(true);
+    q.prepare(sql);
+    q.bindValue(":session_rowid", current_session_id);
+    exec("loadAllSettings", q);
+
+    while (q.next())
+    {
+        QString filename = q.value(0).toString();
+        SongSetting setting;
+        setSongSettingFromSQLQuery(q, setting);
+        settings.insert(filename, setting);
+        if (!q.value(16).isNull())
+        {
+            ages.insert(filename, q.value(16).toString());  // leave it as a float string
+        }
+    }
+}
+
 void SongSettings::closeDatabase()
 {
     if (databaseOpened)
@@ -1101,3 +1159,107 @@ void SongSettings::setSessionInfo(const QList<SessionInfo> &sessions)
         exec("SessionInfo COMMIT", q);
     }
 }
+
+
+static QByteArray envelopeToBlob(const QVector<float> &envelope)
+{
+    return QByteArray(reinterpret_cast<const char *>(envelope.constData()),
+                      envelope.size() * static_cast<int>(sizeof(float)));
+}
+
+static QVector<float> envelopeFromBlob(const QByteArray &blob)
+{
+    QVector<float> envelope(blob.size() / static_cast<int>(sizeof(float)));
+    memcpy(envelope.data(), blob.constData(), static_cast<size_t>(envelope.size()) * sizeof(float));
+    return envelope;
+}
+
+static void setSongAnalysisFromSQLQuery(QSqlQuery &q, SongAnalysis &analysis)
+{
+    analysis.valid = q.value(11).isNull() || q.value(11).toInt() != 0;
+    analysis.version = q.value(1).toInt();
+    analysis.fileSize = q.value(2).toLongLong();
+    analysis.fileModified = q.value(3).toLongLong();
+    analysis.contentHash = q.value(4).toByteArray();
+    analysis.bpm = q.value(5).toDouble();
+    analysis.id3BPM = q.value(6).toDouble();
+    analysis.songStart_sec = q.value(7).toDouble();
+    analysis.songEnd_sec = q.value(8).toDouble();
+    analysis.songLength_sec = q.value(9).toDouble();
+    analysis.loudness_dB = q.value(10).toDouble();
+}
+
+static const char analysisBaseSql[] = "SELECT filename, version, fileSize, fileModified, contentHash, bpm, id3BPM, songStart, songEnd, songLength, loudness, valid";
+
+bool SongSettings::loadAnalysis(const QString &filenameWithPath,
+                                SongAnalysis &analysis,
+                                bool includeEnvelopes)
+{
+    QString sql(analysisBaseSql);
+    if (includeEnvelopes)
+        sql += ", peakEnvelope, rmsEnvelope, waveform";
+    sql += " FROM analysis_cache WHERE filename=:filename";
+
+    QSqlQuery q(m_db);
+    q.prepare(sql);
+    q.bindValue(":filename", removeRootDirs(filenameWithPath));
+    exec("loadAnalysis", q);
+    if (q.next())
+    {
+        analysis.filenameWithPath = filenameWithPath;
+        setSongAnalysisFromSQLQuery(q, analysis);
+        if (includeEnvelopes)
+        {
+            analysis.peakEnvelope = envelopeFromBlob(q.value(12).toByteArray());
+            analysis.rmsEnvelope = envelopeFromBlob(q.value(13).toByteArray());
+            analysis.waveform = q.value(14).toByteArray();
+        }
+        return true;
+    }
+    return false;
+}
+
+// everything in the cache (without the envelopes), keyed by normalized filename
+void SongSettings::getAnalyses(QHash<QString,SongAnalysis> &analyses)
+{
+    QSqlQuery q(m_db);
+    exec("getAnalyses", q, QString(analysisBaseSql) + " FROM analysis_cache");
+    while (q.next())
+    {
+        SongAnalysis analysis;
+        setSongAnalysisFromSQLQuery(q, analysis);
+        analyses[q.value(0).toString()] = analysis;
+    }
+}
+
+void SongSettings::saveAnalysis(const SongAnalysis &analysis)
+{
+    QSqlQuery q(m_db);
+    q.prepare("INSERT OR REPLACE INTO analysis_cache(filename, version, fileSize, fileModified, contentHash, bpm, id3BPM, songStart, songEnd, songLength, loudness, peakEnvelope, rmsEnvelope, waveform, valid) "
+              "VALUES (:filename, :version, :fileSize, :fileModified, :contentHash, :bpm, :id3BPM, :songStart, :songEnd, :songLength, :loudness, :peakEnvelope, :rmsEnvelope, :waveform, :valid)");
+    q.bindValue(":filename", removeRootDirs(analysis.filenameWithPath));
+    q.bindValue(":version", analysis.version);
+    q.bindValue(":fileSize", analysis.fileSize);
+    q.bindValue(":fileModified", analysis.fileModified);
+    q.bindValue(":contentHash", QString::fromLatin1(analysis.contentHash));
+    q.bindValue(":bpm", analysis.bpm);
+    q.bindValue(":id3BPM", analysis.id3BPM);
+    q.bindValue(":songStart", analysis.songStart_sec);
+    q.bindValue(":songEnd", analysis.songEnd_sec);
+    q.bindValue(":songLength", analysis.songLength_sec);
+    q.bindValue(":loudness", analysis.loudness_dB);
+    q.bindValue(":peakEnvelope", envelopeToBlob(analysis.peakEnvelope));
+    q.bindValue(":rmsEnvelope", envelopeToBlob(analysis.rmsEnvelope));
+    q.bindValue(":waveform", analysis.waveform);
+    q.bindValue(":valid", analysis.valid ? 1 : 0);
+    exec("saveAnalysis", q);
+}
+
+void SongSettings::updateAnalysisModified(const QString &filenameWithPath, qint64 fileModified)
+{
+    QSqlQuery q(m_db);
+    q.prepare("UPDATE analysis_cache SET fileModified=:fileModified WHERE filename=:filename");
+    q.bindValue(":fileModified", fileModified);
+    q.bindValue(":filename", removeRootDirs(filenameWithPath));
+    exec("updateAnalysisModified", q);
+}
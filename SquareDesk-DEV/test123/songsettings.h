@@ -30,6 +30,7 @@
 #include <vector>
 
 class SessionInfo;
+class SongAnalysis;
 
 class SongPlayEvent {
 public:
@@ -77,6 +78,17 @@ public:
                       const SongSetting &settings);
     bool loadSettings(const QString &filenameWithPath,
                       SongSetting &settings);
+    void loadAllSettings(QHash<QString,SongSetting> &settings,
+                         QHash<QString,QString> &ages,
+                         bool show_all_sessions);
+
+    // analysis cache, see SongAnalyzer
+    bool loadAnalysis(const QString &filenameWithPath,
+                      SongAnalysis &analysis,
+                      bool includeEnvelopes = false);
+    void getAnalyses(QHash<QString,SongAnalysis> &analyses);
+    void saveAnalysis(const SongAnalysis &analysis);
+    void updateAnalysisModified(const QString &filenameWithPath, qint64 fileModified);
 
     void setCurrentSession(int id) { current_session_id = id; }
     int getCurrentSession() { return current_session_id; }
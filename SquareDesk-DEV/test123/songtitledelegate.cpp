@@ -0,0 +1,81 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "songtitledelegate.h"
+
+#include <QApplication>
+#include <QPainter>
+#include <QAbstractTextDocumentLayout>
+
+SongTitleDelegate::SongTitleDelegate(QObject *parent)
+    : QStyledItemDelegate(parent), doc()
+{
+    doc.setDocumentMargin(0.0);
+    doc.setUndoRedoEnabled(false);
+}
+
+void SongTitleDelegate::layout(const QStyleOptionViewItem &option, const QModelIndex &index, const QColor &textColor) const
+{
+    doc.setDefaultFont(option.font);
+    doc.setDefaultStyleSheet(QString("body { color: %1; }").arg(textColor.name()));
+    doc.setHtml("<body>" + index.data(kTitlePlusTagsRole).toString() + "</body>");
+}
+
+void SongTitleDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt(option);
+    initStyleOption(&opt, index);
+
+    // background, selection and focus rect, but no text
+    opt.text = QString();
+    const QWidget *widget = opt.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    // selected rows are white (see the songTable's stylesheet), otherwise the color for this type of song
+    QColor textColor = (opt.state & QStyle::State_Selected) ?
+                QColor(Qt::white) :
+                index.data(Qt::ForegroundRole).value<QBrush>().color();
+    layout(opt, index, textColor);
+
+    QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget);
+    int yOffset = (textRect.height() - static_cast<int>(doc.size().height())) / 2;  // center vertically
+
+    painter->save();
+    painter->setClipRect(textRect);
+    painter->translate(textRect.left(), textRect.top() + yOffset);
+    doc.drawContents(painter);
+    painter->restore();
+}
+
+QSize SongTitleDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt(option);
+    initStyleOption(&opt, index);
+
+    // The Title column stretches, and titles are a single line, so the row height only depends
+    //   on the font.  Don't lay out the HTML here: the vertical header asks about every row.
+    return QSize(40 * opt.fontMetrics.averageCharWidth(), opt.fontMetrics.height() + 4);
+}
@@ -0,0 +1,53 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SONGTITLEDELEGATE_H_INCLUDED
+#define SONGTITLEDELEGATE_H_INCLUDED
+
+#include <QStyledItemDelegate>
+#include <QTextDocument>
+
+// The songTable's Title column holds the plain title as its sort key, and the title
+//   plus colored tags (HTML, see MainWindow::FormatTitlePlusTags) in kTitlePlusTagsRole.
+//   This delegate paints the HTML directly, so that there is no per-row QLabel.
+#define kTitlePlusTagsRole (Qt::UserRole)
+
+class SongTitleDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit SongTitleDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    void layout(const QStyleOptionViewItem &option, const QModelIndex &index, const QColor &textColor) const;
+
+    mutable QTextDocument doc;  // reused for every paint, only visible rows are ever laid out
+};
+
+#endif /* ifndef SONGTITLEDELEGATE_H_INCLUDED */
@@ -1,7 +0,0 @@
-#include "mainwindow.h"
-#include "songtitlelabel.h"
-
-void SongTitleLabel::mouseDoubleClickEvent(QMouseEvent *e)
-{
-    mw->titleLabelDoubleClicked(e);
-}
@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "soundfxcache.h"
+#include <QDebug>
+#include <QFileInfo>
+
+// ------------------------------------------------------------------
+SoundFXCache::SoundFXCache(qint64 budget) :
+    budget_bytes(budget),
+    used_bytes(0),
+    useCounter(0)
+{
+}
+
+SoundFXCache::~SoundFXCache()
+{
+    clear();
+}
+
+// ------------------------------------------------------------------
+SoundFXCache::FileStamp SoundFXCache::FileStamp::of(const QString &filename)
+{
+    QFileInfo info(filename);
+    FileStamp stamp;
+    stamp.size = info.exists() ? info.size() : -1;
+    stamp.modified = info.lastModified();
+    return(stamp);
+}
+
+// ------------------------------------------------------------------
+bool SoundFXCache::preload(const QString &filename)
+{
+    return(load(filename, true) != nullptr);
+}
+
+SoundFXCache::Entry *SoundFXCache::load(const QString &filename, bool checkIfChanged)
+{
+    QHash<QString, Entry>::iterator it = entries.find(filename);
+    if (it != entries.end() && !checkIfChanged) {
+        return(&it.value());
+    }
+
+    FileStamp stamp = FileStamp::of(filename);
+    if (it != entries.end()) {
+        if (it.value().stamp == stamp) {
+            return(&it.value());
+        }
+        remove(it);  // replaced since it was cached
+    }
+    if (stamp.size < 0) {
+        return(nullptr);  // a missing file is OK, it's just not there
+    }
+
+    QHash<QString, FileStamp>::iterator no = rejected.find(filename);
+    if (no != rejected.end()) {
+        if (no.value() == stamp) {
+            return(nullptr);  // same file as last time, so don't bother decoding it again
+        }
+        rejected.erase(no);
+    }
+
+    // BASS_SAMPLE_OVER_POS: if all voices are busy, the one that's furthest along is restarted
+    HSAMPLE sample = BASS_SampleLoad(false, filename.toLocal8Bit().constData(), 0, 0,
+                                     kVoicesPerSample, BASS_SAMPLE_OVER_POS);
+    if (sample == 0) {
+        if (BASS_ErrorGetCode() != BASS_ERROR_FILEOPEN) {  // a missing file is OK, it's just not there
+            qDebug() << "ERROR " << BASS_ErrorGetCode() << " loading sound effect " << filename;
+            rejected.insert(filename, stamp);
+        }
+        return(nullptr);
+    }
+
+    BASS_SAMPLE info;
+    BASS_SampleGetInfo(sample, &info);
+    qint64 bytes = static_cast<qint64>(info.length);
+    if (bytes > budget_bytes) {
+        rejected.insert(filename, stamp);  // will never fit
+    }
+    if (!makeRoomFor(bytes)) {
+        BASS_SampleFree(sample);
+        return(nullptr);
+    }
+
+    Entry entry;
+    entry.stamp = stamp;
+    entry.sample = sample;
+    entry.bytes = bytes;
+    entry.length_sec = 0.0;
+    if (info.freq > 0 && info.chans > 0) {
+        int bytesPerSample = (info.flags & BASS_SAMPLE_FLOAT) ? 4 : ((info.flags & BASS_SAMPLE_8BITS) ? 1 : 2);
+        entry.length_sec = static_cast<double>(bytes) / (info.freq * info.chans * bytesPerSample);
+    }
+    entry.lastUsed = ++useCounter;
+    used_bytes += bytes;
+
+    return(&entries.insert(filename, entry).value());
+}
+
+void SoundFXCache::remove(QHash<QString, Entry>::iterator it)
+{
+    BASS_SampleFree(it.value().sample);
+    used_bytes -= it.value().bytes;
+    entries.erase(it);
+}
+
+// drops the least recently used samples (that aren't playing) until there is room
+bool SoundFXCache::makeRoomFor(qint64 bytes)
+{
+    if (bytes > budget_bytes) {
+        return(false);
+    }
+
+    while (used_bytes + bytes > budget_bytes) {
+        QHash<QString, Entry>::iterator oldest = entries.end();
+        for (QHash<QString, Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+            HCHANNEL channels[kVoicesPerSample];
+            DWORD voices = BASS_SampleGetChannels(it.value().sample, channels);
+            bool playing = (voices != static_cast<DWORD>(-1) && voices > 0);
+            if (!playing && (oldest == entries.end() || it.value().lastUsed < oldest.value().lastUsed)) {
+                oldest = it;
+            }
+        }
+        if (oldest == entries.end()) {
+            return(false);  // everything that's left is playing
+        }
+        remove(oldest);
+    }
+    return(true);
+}
+
+// ------------------------------------------------------------------
+HCHANNEL SoundFXCache::play(const QString &filename, float volume, double *length_sec)
+{
+    Entry *entry = load(filename, false);
+    if (entry == nullptr) {
+        return(0);
+    }
+    entry->lastUsed = ++useCounter;
+
+    HCHANNEL channel = BASS_SampleGetChannel(entry->sample, false);
+    if (channel == 0) {
+        return(0);
+    }
+    BASS_ChannelSetAttribute(channel, BASS_ATTRIB_VOL, volume);
+    BASS_ChannelPlay(channel, true);
+
+    if (length_sec != nullptr) {
+        *length_sec = entry->length_sec;
+    }
+    return(channel);
+}
+
+void SoundFXCache::stopAll()
+{
+    for (QHash<QString, Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+        BASS_SampleStop(it.value().sample);
+    }
+}
+
+void SoundFXCache::clear()
+{
+    for (QHash<QString, Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+        BASS_SampleFree(it.value().sample);
+    }
+    entries.clear();
+    rejected.clear();
+    used_bytes = 0;
+}
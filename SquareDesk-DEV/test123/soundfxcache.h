@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SOUNDFXCACHE_H_INCLUDED
+#define SOUNDFXCACHE_H_INCLUDED
+
+#include "bass.h"
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+
+// Sound effects (the tip timer warnings, and the user's 1..8 SFX keys), decoded once into
+//   memory as BASS samples, so that triggering one never touches the disk.  Each sample can
+//   play on several voices at once (e.g. a warning on top of a user SFX), and pressing it again
+//   while all of its voices are busy restarts the one that has played the longest.
+//
+// The decoded samples are kept under a memory budget; when a new one doesn't fit, the least
+//   recently played ones (that aren't playing right now) are dropped.  A sample that is bigger
+//   than the whole budget is not cached at all (the caller can stream it from disk instead).
+//   Neither is one that BASS can't decode.  Both are remembered (by size and modification time),
+//   so that they aren't decoded again on every play, just to be thrown away.
+//
+// preload() notices a file that was replaced since it was cached, and loads it again; play()
+//   doesn't look at the disk for a file that's already cached.
+//
+// UI thread only.
+class SoundFXCache
+{
+public:
+    static const qint64 kDefaultBudget_bytes = 32 * 1024 * 1024;
+    static const int kVoicesPerSample = 4;
+
+    explicit SoundFXCache(qint64 budget_bytes = kDefaultBudget_bytes);
+    ~SoundFXCache();
+
+    bool preload(const QString &filename);  // returns false if it can't be loaded, or doesn't fit
+    bool contains(const QString &filename) const { return entries.contains(filename); }
+
+    // starts a new voice, and returns its channel (0 = not cached and couldn't be loaded)
+    HCHANNEL play(const QString &filename, float volume, double *length_sec);
+    void stopAll();
+    void clear();   // frees all of the samples (call before BASS_Free)
+
+    qint64 bytesUsed() const { return used_bytes; }
+
+private:
+    class FileStamp
+    {
+    public:
+        static FileStamp of(const QString &filename);
+        bool operator==(const FileStamp &other) const { return size == other.size && modified == other.modified; }
+        bool operator!=(const FileStamp &other) const { return !(*this == other); }
+
+        qint64 size;
+        QDateTime modified;
+    };
+
+    class Entry
+    {
+    public:
+        FileStamp stamp;
+        HSAMPLE sample;
+        qint64 bytes;
+        double length_sec;
+        quint64 lastUsed;
+    };
+
+    Entry *load(const QString &filename, bool checkIfChanged);
+    void remove(QHash<QString, Entry>::iterator it);
+    bool makeRoomFor(qint64 bytes);
+
+    QHash<QString, Entry> entries;  // filename -> sample
+    QHash<QString, FileStamp> rejected;  // filename -> the file that was too big, or couldn't be decoded
+    qint64 budget_bytes;
+    qint64 used_bytes;
+    quint64 useCounter;
+};
+
+#endif /* ifndef SOUNDFXCACHE_H_INCLUDED */
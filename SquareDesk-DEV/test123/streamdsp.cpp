@@ -0,0 +1,502 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "streamdsp.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STREAMDSP_SSE2
+#include <emmintrin.h>
+#endif
+
+// EQ bands: same centers and bandwidth as the BASS_FX peaking EQ that this replaces
+static const float kEqCenter_Hz[StreamDSP::kBands] = { 125.0f, 1000.0f, 8000.0f };
+static const float kEqBandwidth_octaves = 2.5f;
+static const double kPi = 3.14159265358979323846;
+
+// soft limiter: transparent below the threshold, then approaches full scale asymptotically
+static const float kLimiterThreshold = 0.891251f;  // -1 dBFS
+static const float kLimiterKnee = 1.0f - kLimiterThreshold;
+
+static inline float softLimit(float x)
+{
+    float a = fabsf(x);
+    if (a <= kLimiterThreshold) {
+        return x;
+    }
+    float u = (a - kLimiterThreshold) / kLimiterKnee;
+    float y = kLimiterThreshold + kLimiterKnee * u / (1.0f + u);
+    return (x < 0.0f ? -y : y);
+}
+
+// ------------------------------------------------------------------
+StreamDSP::StreamDSP() :
+    sampleRate(44100.0f),
+    channels(2),
+    pan(0.0f),
+    mono(false),
+    targetGain(1.0f),
+    gainRampSeconds(0.02f),
+    limiter(true),
+    resetRequested(true),
+    currentSampleRate(0.0f),
+    kL(0.0f), kR(0.0f),
+    gain(1.0f), gainStep(0.0f), gainTarget(1.0f),
+    gainRampFrames(0)
+{
+    for (int band = 0; band < kBands; band++) {
+        eqGain_dB[band] = 0.0f;
+        currentEqGain_dB[band] = 0.0f;
+        eqActive[band] = false;
+        computeEqCoefficients(band, 0.0f);
+    }
+    memset(z1, 0, sizeof(z1));
+    memset(z2, 0, sizeof(z2));
+}
+
+StreamDSP &StreamDSP::operator=(const StreamDSP &other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    sampleRate = other.sampleRate.load();
+    channels = other.channels.load();
+    pan = other.pan.load();
+    mono = other.mono.load();
+    for (int band = 0; band < kBands; band++) {
+        eqGain_dB[band] = other.eqGain_dB[band].load();
+    }
+    targetGain = other.targetGain.load();
+    gainRampSeconds = other.gainRampSeconds.load();
+    limiter = other.limiter.load();
+    resetRequested = other.resetRequested.load();
+
+    currentSampleRate = other.currentSampleRate;
+    memcpy(currentEqGain_dB, other.currentEqGain_dB, sizeof(currentEqGain_dB));
+    memcpy(eq, other.eq, sizeof(eq));
+    memcpy(eqActive, other.eqActive, sizeof(eqActive));
+    memcpy(z1, other.z1, sizeof(z1));
+    memcpy(z2, other.z2, sizeof(z2));
+    kL = other.kL;
+    kR = other.kR;
+    gain = other.gain;
+    gainStep = other.gainStep;
+    gainTarget = other.gainTarget;
+    gainRampFrames = other.gainRampFrames;
+    return *this;
+}
+
+void StreamDSP::setSampleRate(float hz)
+{
+    if (hz > 0.0f) {
+        sampleRate = hz;
+    }
+}
+
+void StreamDSP::setChannels(int n)
+{
+    channels = n;
+}
+
+void StreamDSP::setPan(float newPan)
+{
+    pan = newPan;
+}
+
+void StreamDSP::setMono(bool on)
+{
+    mono = on;
+}
+
+void StreamDSP::setEqGain(int band, float gain_dB)
+{
+    if (band >= 0 && band < kBands) {
+        eqGain_dB[band] = gain_dB;
+    }
+}
+
+void StreamDSP::setGain(float newGain, float rampSeconds)
+{
+    gainRampSeconds = rampSeconds;
+    targetGain = newGain;
+}
+
+void StreamDSP::setLimiter(bool on)
+{
+    limiter = on;
+}
+
+void StreamDSP::reset()
+{
+    resetRequested = true;
+}
+
+// ------------------------------------------------------------------
+// RBJ Audio EQ Cookbook peaking EQ, bandwidth in octaves (as BASS_BFX_PEAKEQ with fQ = 0)
+void StreamDSP::computeEqCoefficients(int band, float gain_dB)
+{
+    double fs = (currentSampleRate > 0.0f ? currentSampleRate : 44100.0);
+    double A = pow(10.0, gain_dB / 40.0);
+    double w0 = 2.0 * kPi * kEqCenter_Hz[band] / fs;
+    if (w0 >= kPi) {
+        w0 = kPi * 0.99;  // treble band at very low sample rates
+    }
+    double alpha = sin(w0) * sinh(log(2.0) / 2.0 * kEqBandwidth_octaves * w0 / sin(w0));
+    double a0 = 1.0 + alpha / A;
+
+    eq[band].b0 = static_cast<float>((1.0 + alpha * A) / a0);
+    eq[band].b1 = static_cast<float>((-2.0 * cos(w0)) / a0);
+    eq[band].b2 = static_cast<float>((1.0 - alpha * A) / a0);
+    eq[band].a1 = static_cast<float>((-2.0 * cos(w0)) / a0);
+    eq[band].a2 = static_cast<float>((1.0 - alpha / A) / a0);
+
+    // clear the history whenever a band turns on OR off: process() runs a band that is off as
+    //   identity, which still adds in its state, so that has to be zero (as it is for processScalar(),
+    //   which skips the band altogether)
+    bool wasActive = eqActive[band];
+    eqActive[band] = (gain_dB != 0.0f);
+    if (eqActive[band] != wasActive) {
+        z1[band][0] = z1[band][1] = z2[band][0] = z2[band][1] = 0.0f;
+    }
+}
+
+bool StreamDSP::prepare()
+{
+    if (resetRequested.exchange(false)) {
+        memset(z1, 0, sizeof(z1));
+        memset(z2, 0, sizeof(z2));
+        gain = gainTarget = targetGain;
+        gainRampFrames = 0;
+    }
+
+    float rate = sampleRate;
+    bool rateChanged = (rate != currentSampleRate);
+    currentSampleRate = rate;
+
+    bool anyEq = false;
+    for (int band = 0; band < kBands; band++) {
+        float g = eqGain_dB[band];
+        if (rateChanged || g != currentEqGain_dB[band]) {
+            currentEqGain_dB[band] = g;
+            computeEqCoefficients(band, g);
+        }
+        anyEq = anyEq || eqActive[band];
+    }
+
+    const float PI_OVER_2 = 3.14159265f/2.0f;
+    float theta = PI_OVER_2 * (pan + 1.0f)/2.0f;  // convert to 0-PI/2
+    kL = cosf(theta);
+    kR = sinf(theta);
+
+    float target = targetGain;
+    if (target != gainTarget) {
+        gainTarget = target;
+        gainRampFrames = static_cast<int>(gainRampSeconds * currentSampleRate);
+        if (gainRampFrames < 1) {
+            gainRampFrames = 1;
+        }
+        gainStep = (gainTarget - gain) / gainRampFrames;
+    }
+
+    return anyEq;
+}
+
+// ------------------------------------------------------------------
+void StreamDSP::processScalar(float *d, int frames)
+{
+    bool anyEq = prepare();
+    bool forceMono = mono;
+    bool limit = limiter;
+    int n = channels;
+
+    if (n != 2) {
+        // mono files get EQ (on the one channel), gain and limiter; anything else just gain and limiter
+        for (int f = 0; f < frames; f++) {
+            if (gainRampFrames > 0) {
+                gain = (--gainRampFrames == 0 ? gainTarget : gain + gainStep);
+            }
+            for (int c = 0; c < n; c++) {
+                float x = d[f*n + c];
+                if (n == 1 && anyEq) {
+                    for (int b = 0; b < kBands; b++) {
+                        if (eqActive[b]) {
+                            float y = eq[b].b0 * x + z1[b][0];
+                            z1[b][0] = eq[b].b1 * x - eq[b].a1 * y + z2[b][0];
+                            z2[b][0] = eq[b].b2 * x - eq[b].a2 * y;
+                            x = y;
+                        }
+                    }
+                }
+                x *= gain;
+                d[f*n + c] = (limit ? softLimit(x) : x);
+            }
+        }
+        return;
+    }
+
+    for (int f = 0; f < frames; f++, d += 2) {
+        float L = kL * d[0];
+        float R = kR * d[1];             // constant power pan
+        if (forceMono) {
+            L = R = (L + R)/2.0f;        // mix down to mono for BOTH output channels
+        }
+        if (anyEq) {
+            for (int b = 0; b < kBands; b++) {
+                if (eqActive[b]) {
+                    const Biquad &q = eq[b];
+                    float yL = q.b0 * L + z1[b][0];
+                    z1[b][0] = q.b1 * L - q.a1 * yL + z2[b][0];
+                    z2[b][0] = q.b2 * L - q.a2 * yL;
+                    float yR = q.b0 * R + z1[b][1];
+                    z1[b][1] = q.b1 * R - q.a1 * yR + z2[b][1];
+                    z2[b][1] = q.b2 * R - q.a2 * yR;
+                    L = yL;
+                    R = yR;
+                }
+            }
+        }
+        if (gainRampFrames > 0) {
+            gain = (--gainRampFrames == 0 ? gainTarget : gain + gainStep);
+        }
+        L *= gain;
+        R *= gain;
+        if (limit) {
+            L = softLimit(L);
+            R = softLimit(R);
+        }
+        d[0] = L;
+        d[1] = R;
+    }
+}
+
+#ifdef STREAMDSP_SSE2
+static inline __m128 softLimit4(__m128 x)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 threshold = _mm_set1_ps(kLimiterThreshold);
+    const __m128 knee = _mm_set1_ps(kLimiterKnee);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    __m128 a = _mm_andnot_ps(signMask, x);
+    if (_mm_movemask_ps(_mm_cmpgt_ps(a, threshold)) == 0) {
+        return x;  // nothing to do (almost always)
+    }
+    __m128 sign = _mm_and_ps(x, signMask);
+    __m128 u = _mm_div_ps(_mm_max_ps(_mm_sub_ps(a, threshold), _mm_setzero_ps()), knee);  // divide, as softLimit() does
+    __m128 y = _mm_add_ps(_mm_min_ps(a, threshold),
+                          _mm_div_ps(_mm_mul_ps(knee, u), _mm_add_ps(one, u)));
+    return _mm_or_ps(y, sign);
+}
+
+static inline __m128 load2(const float *p)
+{
+    return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p)));
+}
+
+static inline void store2(float *p, __m128 v)
+{
+    _mm_store_sd(reinterpret_cast<double *>(p), _mm_castps_pd(v));
+}
+#endif
+
+void StreamDSP::process(float *d, int frames)
+{
+#ifdef STREAMDSP_SSE2
+    if (channels != 2) {
+        processScalar(d, frames);
+        return;
+    }
+
+    bool anyEq = prepare();
+    bool forceMono = mono;
+    bool limit = limiter;
+
+    const __m128 panK = _mm_setr_ps(kL, kR, kL, kR);
+    const __m128 half = _mm_set1_ps(0.5f);
+    int f = 0;
+
+    if (!anyEq) {
+        // flat EQ (the usual case): 2 frames (4 floats) at a time
+        //   (locals, so that the compiler doesn't have to assume that d aliases them)
+        float g = gain;
+        int rampFrames = gainRampFrames;
+        const float step = gainStep;
+        const float target = gainTarget;
+        if (rampFrames == 0 && !forceMono) {
+            // steady gain, stereo: 4 frames at a time
+            //   (pan, then gain, as two multiplies: folding them into one would round differently
+            //   from processScalar())
+            const __m128 gains = _mm_set1_ps(g);
+            const __m128 signMask = _mm_set1_ps(-0.0f);
+            const __m128 threshold = _mm_set1_ps(kLimiterThreshold);
+            for (; f + 4 <= frames; f += 4, d += 8) {
+                __m128 x0 = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(d), panK), gains);
+                __m128 x1 = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(d + 4), panK), gains);
+                if (limit && _mm_movemask_ps(_mm_or_ps(_mm_cmpgt_ps(_mm_andnot_ps(signMask, x0), threshold),
+                                                       _mm_cmpgt_ps(_mm_andnot_ps(signMask, x1), threshold))) != 0) {
+                    x0 = softLimit4(x0);
+                    x1 = softLimit4(x1);
+                }
+                _mm_storeu_ps(d, x0);
+                _mm_storeu_ps(d + 4, x1);
+            }
+        }
+        for (; f + 2 <= frames; f += 2, d += 4) {
+            __m128 x = _mm_mul_ps(_mm_loadu_ps(d), panK);  // constant power pan
+            if (forceMono) {
+                // (L+R)/2 in both channels: [L0+R0, R0+L0, L1+R1, R1+L1]
+                x = _mm_mul_ps(_mm_add_ps(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(2,3,0,1))), half);
+            }
+            __m128 gains;
+            if (rampFrames > 0) {
+                float g0 = (--rampFrames == 0 ? target : g + step);
+                float g1 = (rampFrames == 0 ? g0 : (--rampFrames == 0 ? target : g0 + step));
+                gains = _mm_setr_ps(g0, g0, g1, g1);
+                g = g1;
+            } else {
+                gains = _mm_set1_ps(g);
+            }
+            x = _mm_mul_ps(x, gains);
+            if (limit) {
+                x = softLimit4(x);
+            }
+            _mm_storeu_ps(d, x);
+        }
+        gain = g;
+        gainRampFrames = rampFrames;
+    } else {
+        // EQ: each biquad depends on its own previous output, so the 3 bands are run as a pipeline,
+        //   one frame apart: at step f, band 0 (lanes 0,1 of v01) works on frame f, band 1 (lanes 2,3
+        //   of v01) on frame f-1, and band 2 (v2) on frame f-2.  That way the three biquads don't
+        //   wait on each other.  Bands that are off run as identity (b0 = 1, everything else 0).
+        __m128 b0_01, b1_01, b2_01, a1_01, a2_01;
+        __m128 b0_2, b1_2, b2_2, a1_2, a2_2;
+        float c[kBands][5];
+        for (int b = 0; b < kBands; b++) {
+            bool on = eqActive[b];
+            c[b][0] = (on ? eq[b].b0 : 1.0f);
+            c[b][1] = (on ? eq[b].b1 : 0.0f);
+            c[b][2] = (on ? eq[b].b2 : 0.0f);
+            c[b][3] = (on ? eq[b].a1 : 0.0f);
+            c[b][4] = (on ? eq[b].a2 : 0.0f);
+        }
+        b0_01 = _mm_setr_ps(c[0][0], c[0][0], c[1][0], c[1][0]);
+        b1_01 = _mm_setr_ps(c[0][1], c[0][1], c[1][1], c[1][1]);
+        b2_01 = _mm_setr_ps(c[0][2], c[0][2], c[1][2], c[1][2]);
+        a1_01 = _mm_setr_ps(c[0][3], c[0][3], c[1][3], c[1][3]);
+        a2_01 = _mm_setr_ps(c[0][4], c[0][4], c[1][4], c[1][4]);
+        b0_2 = _mm_set1_ps(c[2][0]);
+        b1_2 = _mm_set1_ps(c[2][1]);
+        b2_2 = _mm_set1_ps(c[2][2]);
+        a1_2 = _mm_set1_ps(c[2][3]);
+        a2_2 = _mm_set1_ps(c[2][4]);
+
+        __m128 s1_01 = _mm_loadu_ps(&z1[0][0]);  // [band0 L, band0 R, band1 L, band1 R]
+        __m128 s2_01 = _mm_loadu_ps(&z2[0][0]);
+        __m128 s1_2 = load2(z1[2]);
+        __m128 s2_2 = load2(z2[2]);
+
+        const __m128 lowLanes = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, 0, 0));
+        __m128 y01 = _mm_setzero_ps();
+        float *out = d;
+
+        for (int step = 0; step < frames + 2; step++) {
+            __m128 in = _mm_setzero_ps();
+            if (step < frames) {
+                in = _mm_mul_ps(load2(d + 2*step), panK);  // constant power pan
+                if (forceMono) {
+                    in = _mm_mul_ps(_mm_add_ps(in, _mm_shuffle_ps(in, in, _MM_SHUFFLE(2,3,0,1))), half);
+                }
+            }
+            __m128 x01 = _mm_movelh_ps(in, y01);   // [frame f, band 0 output for frame f-1]
+            __m128 x2 = _mm_movehl_ps(y01, y01);   // band 1 output for frame f-2
+
+            __m128 old1_01 = s1_01, old2_01 = s2_01, old1_2 = s1_2, old2_2 = s2_2;
+
+            y01 = _mm_add_ps(_mm_mul_ps(b0_01, x01), s1_01);
+            s1_01 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1_01, x01), _mm_mul_ps(a1_01, y01)), s2_01);
+            s2_01 = _mm_sub_ps(_mm_mul_ps(b2_01, x01), _mm_mul_ps(a2_01, y01));
+
+            __m128 y2 = _mm_add_ps(_mm_mul_ps(b0_2, x2), s1_2);
+            s1_2 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1_2, x2), _mm_mul_ps(a1_2, y2)), s2_2);
+            s2_2 = _mm_sub_ps(_mm_mul_ps(b2_2, x2), _mm_mul_ps(a2_2, y2));
+
+            if (step < 2 || step >= frames) {
+                // filling/draining the pipeline: a band only moves on when it has a real frame
+                bool band0 = (step < frames);
+                bool band1 = (step >= 1 && step <= frames);
+                bool band2 = (step >= 2);
+                __m128 keep01 = _mm_or_ps(band0 ? _mm_setzero_ps() : lowLanes,
+                                          band1 ? _mm_setzero_ps() : _mm_andnot_ps(lowLanes, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+                s1_01 = _mm_or_ps(_mm_and_ps(keep01, old1_01), _mm_andnot_ps(keep01, s1_01));
+                s2_01 = _mm_or_ps(_mm_and_ps(keep01, old2_01), _mm_andnot_ps(keep01, s2_01));
+                if (!band2) {
+                    s1_2 = old1_2;
+                    s2_2 = old2_2;
+                    continue;  // no output yet
+                }
+            }
+
+            // frame (step - 2) is done
+            if (gainRampFrames > 0) {
+                gain = (--gainRampFrames == 0 ? gainTarget : gain + gainStep);
+            }
+            __m128 y = _mm_mul_ps(y2, _mm_set1_ps(gain));
+            if (limit) {
+                y = softLimit4(y);
+            }
+            store2(out, y);
+            out += 2;
+        }
+
+        _mm_storeu_ps(&z1[0][0], s1_01);
+        _mm_storeu_ps(&z2[0][0], s2_01);
+        store2(z1[2], s1_2);
+        store2(z2[2], s2_2);
+        f = frames;
+    }
+
+    // odd frame at the end (flat EQ case only): finish with the scalar code, parameters already picked up
+    for (; f < frames; f++, d += 2) {
+        float L = kL * d[0];
+        float R = kR * d[1];
+        if (forceMono) {
+            L = R = (L + R)/2.0f;
+        }
+        if (gainRampFrames > 0) {
+            gain = (--gainRampFrames == 0 ? gainTarget : gain + gainStep);
+        }
+        L *= gain;
+        R *= gain;
+        d[0] = (limit ? softLimit(L) : L);
+        d[1] = (limit ? softLimit(R) : R);
+    }
+#else
+    processScalar(d, frames);
+#endif
+}
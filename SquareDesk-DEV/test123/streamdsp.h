@@ -0,0 +1,99 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef STREAMDSP_H_INCLUDED
+#define STREAMDSP_H_INCLUDED
+
+#include <atomic>
+
+// All of the per-sample processing for one playback stream, fused into one pass over each buffer:
+//   pan (constant power) -> optional mono mix-down -> 3-band peaking EQ (bass/mid/treble)
+//   -> gain (with a short ramp, e.g. for ducking) -> soft limiter
+//
+// The parameters can be set from any thread (usually the UI thread).  process() is only called
+//   from the audio thread (BASS DSP callback), and picks up the new parameters at the start of
+//   the next buffer.  No locks, no allocation.
+//
+// Plain C++ (no Qt, no BASS), so that benchmarks/streamdspbench can build it by itself.
+class StreamDSP
+{
+public:
+    StreamDSP();
+
+    // copies the parameters AND the filter/gain state, so that the copy carries on exactly where
+    //   the original left off (e.g. for the outgoing song in a crossfade).  Only safe when neither
+    //   one is being processed on the audio thread at the time.
+    StreamDSP &operator=(const StreamDSP &other);
+
+    // -- any thread --
+    void setSampleRate(float hz);
+    void setChannels(int channels);           // 2 = interleaved stereo, 1 = mono
+    int  channelCount() const { return channels; }
+    void setPan(float pan);                   // -1.0 = all L, 0.0 = center, 1.0 = all R
+    void setMono(bool on);                    // FORCE MONO mode
+    void setEqGain(int band, float gain_dB);  // band 0 = Bass, 1 = Mid, 2 = Treble; -15 .. 15 dB
+    void setGain(float gain, float rampSeconds = 0.02f);  // 1.0 = unity, ramped to avoid clicks
+    void setLimiter(bool on);                 // soft limiter above -1 dBFS
+    void reset();                             // forget the filter history (e.g. new song)
+
+    // -- audio thread only --
+    void process(float *buffer, int frames);          // SSE2 if available, otherwise processScalar()
+    void processScalar(float *buffer, int frames);    // reference implementation
+
+    static const int kBands = 3;
+
+private:
+    class Biquad
+    {
+    public:
+        float b0, b1, b2, a1, a2;  // normalized (a0 == 1)
+    };
+
+    bool prepare();  // picks up the new parameters, returns true if any EQ band is active
+    void computeEqCoefficients(int band, float gain_dB);
+
+    // set by any thread
+    std::atomic<float> sampleRate;
+    std::atomic<int>   channels;
+    std::atomic<float> pan;
+    std::atomic<bool>  mono;
+    std::atomic<float> eqGain_dB[kBands];
+    std::atomic<float> targetGain;
+    std::atomic<float> gainRampSeconds;
+    std::atomic<bool>  limiter;
+    std::atomic<bool>  resetRequested;
+
+    // audio thread only
+    float currentSampleRate;
+    float currentEqGain_dB[kBands];
+    Biquad eq[kBands];
+    bool eqActive[kBands];
+    float z1[kBands][2], z2[kBands][2];  // transposed direct form II state, per band, per channel (L, R)
+    float kL, kR;                         // pan gains
+    float gain, gainStep, gainTarget;
+    int gainRampFrames;
+};
+
+#endif /* ifndef STREAMDSP_H_INCLUDED */
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui sql network printsupport svg
+QT       += core gui sql network printsupport svg concurrent
 
 macx {
     QT += webenginewidgets
@@ -44,15 +44,29 @@ SOURCES += main.cpp\
     tablenumberitem.cpp \
     myslider.cpp \
     levelmeter.cpp \
+    gainenvelope.cpp \
+    loopengine.cpp \
+    songpreloader.cpp \
+    offlinerenderer.cpp \
+    audiofilewriter.cpp \
+    meterfeed.cpp \
     analogclock.cpp \
     prefsmanager.cpp \
     clickablelabel.cpp \
     songsettings.cpp \
+    songanalyzer.cpp \
+    musicdirectoryindex.cpp \
+    libraryentry.cpp \
+    cuesheetmatchindex.cpp \
+    songsearchindex.cpp \
+    soundfxcache.cpp \
+    streamdsp.cpp \
     typetracker.cpp \
     console.cpp \
     renderarea.cpp \
     sdhighlighter.cpp \
     utility.cpp \
+    waveformoverview.cpp \
     danceprograms.cpp \
     startupwizard.cpp \
     keybindings.cpp \
@@ -61,7 +75,7 @@ SOURCES += main.cpp\
     downloadmanager.cpp \
     sdinterface.cpp \
     mainwindow_sd.cpp \
-    songtitlelabel.cpp \
+    songtitledelegate.cpp \
     sdsequencecalllabel.cpp \
     perftimer.cpp \
     tablewidgettimingitem.cpp \
@@ -88,9 +102,16 @@ HEADERS  += mainwindow.h \
     songhistoryexportdialog.h \
     preferencesdialog.h \
     utility.h \
+    waveformoverview.h \
     mytablewidget.h \
     tablenumberitem.h \
     levelmeter.h \
+    gainenvelope.h \
+    loopengine.h \
+    songpreloader.h \
+    offlinerenderer.h \
+    audiofilewriter.h \
+    meterfeed.h \
     analogclock.h \
     common_enums.h \
     prefs_options.h \
@@ -106,13 +127,20 @@ HEADERS  += mainwindow.h \
     danceprograms.h \
     startupwizard.h \
     songsettings.h \
+    songanalyzer.h \
+    musicdirectoryindex.h \
+    libraryentry.h \
+    cuesheetmatchindex.h \
+    songsearchindex.h \
+    soundfxcache.h \
+    streamdsp.h \
     platform.h \
     keybindings.h \
     calllistcheckbox.h \
     sdlineedit.h \
     downloadmanager.h \
     sdinterface.h \
-    songtitlelabel.h \
+    songtitledelegate.h \
     sdsequencecalllabel.h \
     perftimer.h \
     tablewidgettimingitem.h \
@@ -181,12 +209,15 @@ win32:CONFIG(debug, debug|release): {
     copydata.commands = xcopy /q /y $$shell_path($$PWD/windll/*.dll) $$shell_path($$OUT_PWD\debug)
     copydata3.commands = xcopy /q /y $$shell_path($$PWD/allcalls.csv) $$shell_path($$OUT_PWD\debug)
     copydata30.commands = xcopy /q /y $$shell_path($$PWD/sd_calls.dat) $$shell_path($$OUT_PWD\debug)
-    first.depends = $(first) copydata copydata3 copydata30
+    # the getout tables are optional (see "getouts" in the sdlib makefiles), so only copy them if they're there
+    copydata31.commands = if exist $$shell_path($$PWD/sd_getouts_*.dat) xcopy /q /y $$shell_path($$PWD/sd_getouts_*.dat) $$shell_path($$OUT_PWD\debug)
+    first.depends = $(first) copydata copydata3 copydata30 copydata31
     export(first.depends)
     export(copydata.commands)
     export(copydata3.commands)
     export(copydata30.commands)
-    QMAKE_EXTRA_TARGETS += first copydata copydata3 copydata30
+    export(copydata31.commands)
+    QMAKE_EXTRA_TARGETS += first copydata copydata3 copydata30 copydata31
 
     # LYRICS AND PATTER TEMPLATES --------------------------------------------
     # Copy the lyrics.template.html and patter.template.html files to the right place
@@ -205,12 +236,15 @@ win32:CONFIG(release, debug|release): {
     copydata.commands = xcopy /q /y $$shell_path($$PWD/windll/*.dll) $$shell_path($$OUT_PWD\release)
     copydata3.commands = xcopy /q /y $$shell_path($$PWD/allcalls.csv) $$shell_path($$OUT_PWD\release)
     copydata30.commands = xcopy /q /y $$shell_path($$PWD/sd_calls.dat) $$shell_path($$OUT_PWD\release)
-    first.depends = $(first) copydata copydata3 copydata30
+    # the getout tables are optional (see "getouts" in the sdlib makefiles), so only copy them if they're there
+    copydata31.commands = if exist $$shell_path($$PWD/sd_getouts_*.dat) xcopy /q /y $$shell_path($$PWD/sd_getouts_*.dat) $$shell_path($$OUT_PWD\release)
+    first.depends = $(first) copydata copydata3 copydata30 copydata31
     export(first.depends)
     export(copydata.commands)
     export(copydata3.commands)
     export(copydata30.commands)
-    QMAKE_EXTRA_TARGETS += first copydata copydata3 copydata30
+    export(copydata31.commands)
+    QMAKE_EXTRA_TARGETS += first copydata copydata3 copydata30 copydata31
 
     # LYRICS AND PATTER TEMPLATES --------------------------------------------
     # Copy the lyrics.template.html and patter.template.html files to the right place
@@ -284,6 +318,8 @@ macx {
     # Also copy the PDF file into the Resources folder, so we can stick it into the Reference folder
     # This way, it's easy for SDP to find the executable for sd, and it's easy for SDP to start up sd.
     copydata1.commands = $(COPY_DIR) $$PWD/sd_calls.dat     $$OUT_PWD/SquareDesk.app/Contents/MacOS
+    # The getout tables are optional (see "getouts" in the sdlib makefiles), so it's OK if there aren't any
+    copydata1a.commands = -$(COPY_DIR) $$PWD/sd_getouts_*.dat $$OUT_PWD/SquareDesk.app/Contents/MacOS
     copydata2.commands = $(COPY_DIR) $$PWD/../sd/sd_doc.pdf $$OUT_PWD/SquareDesk.app/Contents/Resources
     copydata3.commands = $(COPY_DIR) $$PWD/allcalls.csv     $$OUT_PWD/SquareDesk.app/Contents/Resources
 
@@ -310,13 +346,14 @@ macx {
     copydata7.commands = $(COPY_DIR) $$PWD/5365a.dic $$OUT_PWD/SquareDesk.app/Contents/MacOS
     copydata8.commands = $(COPY_DIR) $$PWD/plus.jsgf $$OUT_PWD/SquareDesk.app/Contents/MacOS
 
-    first.depends = $(first) copydata0a copydata0b copydata0c copydata1 copydata2 copydata2b copydata3 copydata4 copydata5 copydata6a copydata6b copydata7 copydata8
+    first.depends = $(first) copydata0a copydata0b copydata0c copydata1 copydata1a copydata2 copydata2b copydata3 copydata4 copydata5 copydata6a copydata6b copydata7 copydata8
 
     #export(first.depends)
     export(copydata0a.commands)
     export(copydata0b.commands)
     export(copydata0c.commands)
     export(copydata1.commands)
+    export(copydata1a.commands)
     export(copydata2.commands)
     export(copydata2b.commands)
     export(copydata3.commands)
@@ -327,7 +364,7 @@ macx {
     export(copydata7.commands)
     export(copydata8.commands)
 
-    QMAKE_EXTRA_TARGETS += first copydata0a copydata0b copydata0c copydata1 copydata2 copydata2b copydata3 copydata4 copydata5 copydata6a copydata6b copydata7 copydata8
+    QMAKE_EXTRA_TARGETS += first copydata0a copydata0b copydata0c copydata1 copydata1a copydata2 copydata2b copydata3 copydata4 copydata5 copydata6a copydata6b copydata7 copydata8
 
     # SOUNDFX STARTER SET --------------------------------------------
     copydata10.commands = $(MKDIR) $$OUT_PWD/SquareDesk.app/Contents/soundfx
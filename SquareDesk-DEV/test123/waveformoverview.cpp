@@ -0,0 +1,190 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#include "waveformoverview.h"
+#include <math.h>
+
+const double WaveformOverview::kBlockSeconds = 0.1;
+
+static const char kBlobFormat = 1;  // first byte of the blob
+
+static qint8 quantizeSigned(float x)
+{
+    float q = floorf(x * 127.0f + 0.5f);
+    return static_cast<qint8>(q > 127.0f ? 127 : (q < -127.0f ? -127 : q));
+}
+
+static quint8 quantizeRMS(float x)
+{
+    float q = floorf(x * 255.0f + 0.5f);
+    return static_cast<quint8>(q > 255.0f ? 255 : (q < 0.0f ? 0 : q));
+}
+
+// ------------------------------------------------------------------
+WaveformOverview::WaveformOverview()
+{
+}
+
+void WaveformOverview::clear()
+{
+    levels.clear();
+}
+
+void WaveformOverview::appendBlock(const float *samples, int count)
+{
+    if (levels.isEmpty()) {
+        levels.resize(1);
+    }
+
+    float lo = 0.0f, hi = 0.0f;
+    double sumSquares = 0.0;
+    for (int i = 0; i < count; i++) {
+        float s = samples[i];
+        lo = (s < lo ? s : lo);
+        hi = (s > hi ? s : hi);
+        sumSquares += static_cast<double>(s) * s;
+    }
+
+    Level &base = levels[0];
+    base.min.append(quantizeSigned(lo));
+    base.max.append(quantizeSigned(hi));
+    base.rms.append(quantizeRMS(count > 0 ? static_cast<float>(sqrt(sumSquares / count)) : 0.0f));
+}
+
+void WaveformOverview::finish()
+{
+    levels.resize(1);
+    if (isEmpty()) {
+        return;
+    }
+
+    while (levels.last().rms.size() > 1) {
+        const Level &fine = levels.last();
+        Level coarse;
+        int n = (fine.rms.size() + 1) / 2;
+        coarse.min.resize(n);
+        coarse.max.resize(n);
+        coarse.rms.resize(n);
+        for (int i = 0; i < n; i++) {
+            int a = 2 * i;
+            int b = (2 * i + 1 < fine.rms.size() ? 2 * i + 1 : a);
+            coarse.min[i] = qMin(fine.min[a], fine.min[b]);
+            coarse.max[i] = qMax(fine.max[a], fine.max[b]);
+            float ra = fine.rms[a] / 255.0f, rb = fine.rms[b] / 255.0f;
+            coarse.rms[i] = quantizeRMS(sqrtf((ra * ra + rb * rb) / 2.0f));
+        }
+        levels.append(coarse);
+    }
+}
+
+// ------------------------------------------------------------------
+QByteArray WaveformOverview::toBlob() const
+{
+    QByteArray blob;
+    if (isEmpty()) {
+        return blob;
+    }
+
+    const Level &base = levels[0];
+    int n = base.rms.size();
+    blob.resize(1 + 3 * n);
+    blob[0] = kBlobFormat;
+    char *d = blob.data() + 1;
+    for (int i = 0; i < n; i++) {
+        *d++ = static_cast<char>(base.min[i]);
+        *d++ = static_cast<char>(base.max[i]);
+        *d++ = static_cast<char>(base.rms[i]);
+    }
+    return blob;
+}
+
+WaveformOverview WaveformOverview::fromBlob(const QByteArray &blob)
+{
+    WaveformOverview overview;
+    if (blob.size() < 1 || blob[0] != kBlobFormat) {
+        return overview;
+    }
+
+    int n = (blob.size() - 1) / 3;
+    overview.levels.resize(1);
+    Level &base = overview.levels[0];
+    base.min.resize(n);
+    base.max.resize(n);
+    base.rms.resize(n);
+    const char *d = blob.constData() + 1;
+    for (int i = 0; i < n; i++) {
+        base.min[i] = static_cast<qint8>(*d++);
+        base.max[i] = static_cast<qint8>(*d++);
+        base.rms[i] = static_cast<quint8>(*d++);
+    }
+    overview.finish();
+    return overview;
+}
+
+// ------------------------------------------------------------------
+QVector<WaveformOverview::Column> WaveformOverview::columns(double start_sec, double end_sec, int pixels) const
+{
+    QVector<Column> result;
+    if (isEmpty() || pixels <= 0 || end_sec <= start_sec) {
+        return result;
+    }
+    result.resize(pixels);
+
+    // the coarsest level that still has at least one block per pixel
+    double blocksPerPixel = (end_sec - start_sec) / kBlockSeconds / pixels;
+    int k = 0;
+    while (k + 1 < levels.size() && (1 << (k + 1)) <= blocksPerPixel) {
+        k++;
+    }
+    const Level &level = levels[k];
+    const double levelBlock_sec = kBlockSeconds * (1 << k);
+    const int n = level.rms.size();
+
+    for (int p = 0; p < pixels; p++) {
+        double t0 = start_sec + (end_sec - start_sec) * p / pixels;
+        double t1 = start_sec + (end_sec - start_sec) * (p + 1) / pixels;
+        int b0 = qMax(0, static_cast<int>(t0 / levelBlock_sec));
+        int b1 = static_cast<int>(ceil(t1 / levelBlock_sec));
+
+        Column &c = result[p];
+        c.min = c.max = c.rms = 0.0f;
+        if (b0 >= n) {
+            continue;  // past the end of the song
+        }
+        b1 = qBound(b0 + 1, b1, n);
+        int lo = 0, hi = 0;
+        float sumSquares = 0.0f;
+        for (int b = b0; b < b1; b++) {
+            lo = qMin(lo, static_cast<int>(level.min[b]));
+            hi = qMax(hi, static_cast<int>(level.max[b]));
+            float r = level.rms[b] / 255.0f;
+            sumSquares += r * r;
+        }
+        c.min = lo / 127.0f;
+        c.max = hi / 127.0f;
+        c.rms = sqrtf(sumSquares / (b1 - b0));
+    }
+    return result;
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** Copyright (C) 2016, 2017, 2018 Mike Pogue, Dan Lyke
+** Contact: mpogue @ zenstarstudio.com
+**
+** This file is part of the SquareDesk application.
+**
+** $SQUAREDESK_BEGIN_LICENSE$
+**
+** Commercial License Usage
+** For commercial licensing terms and conditions, contact the authors via the
+** email address above.
+**
+** GNU General Public License Usage
+** This file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appear in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file.
+**
+** $SQUAREDESK_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef WAVEFORMOVERVIEW_H_INCLUDED
+#define WAVEFORMOVERVIEW_H_INCLUDED
+
+#include <QByteArray>
+#include <QVector>
+
+// A min/max/RMS overview of a whole song, for drawing its waveform (e.g. in the seek bar)
+//   at any zoom level, without decoding the file again.
+//
+// It's built during the analysis decode pass, one 100ms block at a time, and stored in the
+//   analysis cache as 3 bytes per block (a few KB per song).  When it's loaded, a pyramid of
+//   coarser levels (2, 4, 8, ... blocks each) is built, so that drawing N pixels only ever
+//   looks at about N blocks.
+class WaveformOverview
+{
+public:
+    static const double kBlockSeconds;  // the same blocks as the analysis envelopes
+
+    class Column
+    {
+    public:
+        float min;  // -1.0 .. 1.0
+        float max;
+        float rms;  //  0.0 .. 1.0
+    };
+
+    WaveformOverview();
+
+    // -- building it --
+    void clear();
+    void appendBlock(const float *samples, int count);  // interleaved, all channels
+    void finish();                                       // builds the pyramid
+
+    // -- storing it --
+    QByteArray toBlob() const;
+    static WaveformOverview fromBlob(const QByteArray &blob);  // empty, if the blob is
+
+    bool isEmpty() const { return levels.isEmpty() || levels[0].rms.isEmpty(); }
+    int blockCount() const { return isEmpty() ? 0 : levels[0].rms.size(); }
+    double length_sec() const { return blockCount() * kBlockSeconds; }
+
+    // one Column for each of the pixels equal slices of start_sec .. end_sec
+    QVector<Column> columns(double start_sec, double end_sec, int pixels) const;
+
+private:
+    class Level
+    {
+    public:
+        QVector<qint8> min;  // * 127
+        QVector<qint8> max;
+        QVector<quint8> rms; // * 255
+    };
+
+    QVector<Level> levels;  // levels[k] has blocks of (1 << k) * kBlockSeconds
+};
+
+#endif /* ifndef WAVEFORMOVERVIEW_H_INCLUDED */